@@ -0,0 +1,158 @@
+/*
+ * Copyright 2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TIME_SYNC_LIB_SYNCHRONIZER_HPP
+#define TIME_SYNC_LIB_SYNCHRONIZER_HPP
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include <ros/ros.h>
+
+#include <time_sync_lib/time_indexed_buffer.hpp>
+
+namespace time_sync
+{
+enum class MatchPolicy
+{
+  NEAREST,     ///< message closest in time to the pivot
+  INTERPOLATE  ///< messages right before and after the pivot
+};
+
+/**
+ * Result of matching one input against a pivot message.
+ *
+ * The messages are type-erased; the user knows the type of each input and
+ * gets them back with get<M>(), before<M>() and after<M>().
+ */
+struct Match
+{
+  boost::shared_ptr<void const> nearest_msg;
+  boost::shared_ptr<void const> before_msg;  ///< latest message at or before the pivot
+  boost::shared_ptr<void const> after_msg;   ///< earliest message after the pivot
+  ros::Time nearest_stamp;
+  double ratio;  ///< weight of after_msg for interpolation, in [0, 1]
+
+  template <class M>
+  boost::shared_ptr<M const> get() const
+  {
+    return boost::static_pointer_cast<M const>(nearest_msg);
+  }
+  template <class M>
+  boost::shared_ptr<M const> before() const
+  {
+    return boost::static_pointer_cast<M const>(before_msg);
+  }
+  template <class M>
+  boost::shared_ptr<M const> after() const
+  {
+    return boost::static_pointer_cast<M const>(after_msg);
+  }
+};
+
+struct Statistics
+{
+  uint64_t matched;                ///< pivots published with a full match
+  uint64_t dropped_pivots;         ///< pivots without a match in tolerance
+  std::vector<uint64_t> dropped;   ///< per input, messages discarded unused
+  double latency_mean;             ///< pivot arrival to match [s, wall time]
+  double latency_max;              ///< [s, wall time]
+  double offset_max;               ///< largest |stamp - pivot stamp| matched [s]
+};
+
+/**
+ * Event-driven N-input time synchronizer.
+ *
+ * Input 0 is the pivot: every pivot message is matched against the other
+ * inputs according to their MatchPolicy. A pivot is decided as soon as
+ * every other input has a message at or after its stamp, or, failing
+ * that, once a pivot newer by more than max_delay has arrived. All work
+ * happens in add(), there are no threads or timers.
+ */
+class Synchronizer
+{
+public:
+  typedef boost::function<void(const std::vector<Match>&)> Callback;
+
+  /**
+   * @param inputs number of inputs, including the pivot
+   * @param max_interval largest accepted stamp difference to the pivot
+   * @param max_delay how long (in message time) to wait for late inputs
+   * @param capacity messages buffered per input
+   */
+  Synchronizer(size_t inputs, const ros::Duration& max_interval, const ros::Duration& max_delay,
+               size_t capacity = 32);
+
+  void setPolicy(size_t input, MatchPolicy policy);
+  void registerCallback(const Callback& callback);
+
+  /// Add a message; may invoke the callback for every pivot it completes.
+  void add(size_t input, const ros::Time& stamp, const boost::shared_ptr<void const>& msg);
+
+  template <class M>
+  void addMessage(size_t input, const boost::shared_ptr<M const>& msg)
+  {
+    add(input, msg->header.stamp, msg);
+  }
+
+  /// Subscribe @a topic as @a input on @a nh.
+  template <class M>
+  void subscribe(ros::NodeHandle& nh, const std::string& topic, size_t input, uint32_t queue_size = 10)
+  {
+    boost::function<void(const boost::shared_ptr<M const>&)> callback =
+        boost::bind(&Synchronizer::addMessage<M>, this, input, _1);
+    subscribers_.push_back(nh.subscribe<M>(topic, queue_size, callback));
+  }
+
+  Statistics getStatistics() const;
+  void resetStatistics();
+
+private:
+  struct Pivot
+  {
+    ros::Time stamp;
+    boost::shared_ptr<void const> msg;
+    ros::WallTime arrival;
+  };
+
+  bool decidable(const Pivot& pivot) const;
+  bool match(const Pivot& pivot, std::vector<Match>& matches);
+  void prune(const ros::Time& oldest);
+
+  size_t inputs_;
+  ros::Duration max_interval_;
+  ros::Duration max_delay_;
+  size_t capacity_;
+  std::vector<MatchPolicy> policies_;
+  std::vector<TimeIndexedBuffer> buffers_;
+  std::deque<Pivot> pivots_;
+  Callback callback_;
+  std::vector<ros::Subscriber> subscribers_;
+
+  mutable std::mutex mutex_;
+  Statistics statistics_;
+  double latency_sum_;
+};
+
+}  // namespace time_sync
+
+#endif  // TIME_SYNC_LIB_SYNCHRONIZER_HPP
@@ -0,0 +1,89 @@
+/*
+ * Copyright 2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TIME_SYNC_LIB_TIME_INDEXED_BUFFER_HPP
+#define TIME_SYNC_LIB_TIME_INDEXED_BUFFER_HPP
+
+#include <cstddef>
+#include <deque>
+
+#include <boost/shared_ptr.hpp>
+#include <ros/time.h>
+
+namespace time_sync
+{
+/// A buffered message. Only the shared pointer is stored, never a copy.
+struct Entry
+{
+  ros::Time stamp;
+  boost::shared_ptr<void const> msg;
+  bool used;
+};
+
+/**
+ * Messages of one input, sorted by stamp.
+ *
+ * Lookups are binary searches on the stamp. Messages normally arrive in
+ * order and are appended in O(1); late messages are inserted in place.
+ */
+class TimeIndexedBuffer
+{
+public:
+  explicit TimeIndexedBuffer(size_t capacity = 32);
+
+  /// @return number of messages evicted before they were ever used
+  size_t insert(const ros::Time& stamp, const boost::shared_ptr<void const>& msg);
+
+  /// @return index of the latest message with stamp <= t, or -1
+  int floor(const ros::Time& t) const;
+
+  /// Remove all messages older than the latest one with stamp <= t.
+  /// @return number of removed messages that were never used
+  size_t pruneBefore(const ros::Time& t);
+
+  void clear()
+  {
+    entries_.clear();
+  }
+  bool empty() const
+  {
+    return entries_.empty();
+  }
+  size_t size() const
+  {
+    return entries_.size();
+  }
+  Entry& at(size_t i)
+  {
+    return entries_[i];
+  }
+  const Entry& at(size_t i) const
+  {
+    return entries_[i];
+  }
+  const Entry& newest() const
+  {
+    return entries_.back();
+  }
+
+private:
+  std::deque<Entry> entries_;
+  size_t capacity_;
+};
+
+}  // namespace time_sync
+
+#endif  // TIME_SYNC_LIB_TIME_INDEXED_BUFFER_HPP
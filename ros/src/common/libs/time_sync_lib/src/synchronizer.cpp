@@ -0,0 +1,219 @@
+/*
+ * Copyright 2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include <time_sync_lib/synchronizer.hpp>
+
+namespace time_sync
+{
+Synchronizer::Synchronizer(size_t inputs, const ros::Duration& max_interval, const ros::Duration& max_delay,
+                           size_t capacity)
+  : inputs_(inputs)
+  , max_interval_(max_interval)
+  , max_delay_(max_delay)
+  , capacity_(capacity)
+  , policies_(inputs, MatchPolicy::NEAREST)
+  , buffers_(inputs, TimeIndexedBuffer(capacity))
+{
+  resetStatistics();
+}
+
+void Synchronizer::setPolicy(size_t input, MatchPolicy policy)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  policies_.at(input) = policy;
+}
+
+void Synchronizer::registerCallback(const Callback& callback)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  callback_ = callback;
+}
+
+void Synchronizer::add(size_t input, const ros::Time& stamp, const boost::shared_ptr<void const>& msg)
+{
+  std::vector<std::vector<Match> > ready;
+  Callback callback;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (input == 0)
+    {
+      Pivot pivot;
+      pivot.stamp = stamp;
+      pivot.msg = msg;
+      pivot.arrival = ros::WallTime::now();
+      pivots_.push_back(pivot);
+      if (pivots_.size() > capacity_)
+      {
+        pivots_.pop_front();
+        ++statistics_.dropped_pivots;
+        ++statistics_.dropped[0];
+      }
+    }
+    else
+    {
+      statistics_.dropped[input] += buffers_.at(input).insert(stamp, msg);
+    }
+
+    // decide pivots in order, as far as the buffered messages allow
+    while (!pivots_.empty() && decidable(pivots_.front()))
+    {
+      std::vector<Match> matches;
+      if (match(pivots_.front(), matches))
+      {
+        double latency = (ros::WallTime::now() - pivots_.front().arrival).toSec();
+        ++statistics_.matched;
+        latency_sum_ += latency;
+        statistics_.latency_mean = latency_sum_ / statistics_.matched;
+        statistics_.latency_max = std::max(statistics_.latency_max, latency);
+        ready.push_back(matches);
+      }
+      else
+      {
+        ++statistics_.dropped_pivots;
+        ++statistics_.dropped[0];
+      }
+      ros::Time decided = pivots_.front().stamp;
+      pivots_.pop_front();
+      prune(pivots_.empty() ? decided : pivots_.front().stamp);
+    }
+    callback = callback_;
+  }
+
+  if (callback)
+  {
+    for (size_t i = 0; i < ready.size(); ++i)
+    {
+      callback(ready[i]);
+    }
+  }
+}
+
+bool Synchronizer::decidable(const Pivot& pivot) const
+{
+  // stop waiting for late inputs once the pivot is too old
+  if (pivots_.back().stamp - pivot.stamp > max_delay_)
+  {
+    return true;
+  }
+
+  // messages of one input arrive in order, so nothing closer than a
+  // message at or after the pivot can still come
+  for (size_t i = 1; i < inputs_; ++i)
+  {
+    if (buffers_[i].empty() || buffers_[i].newest().stamp < pivot.stamp)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool Synchronizer::match(const Pivot& pivot, std::vector<Match>& matches)
+{
+  matches.resize(inputs_);
+
+  Match& self = matches[0];
+  self.nearest_msg = pivot.msg;
+  self.before_msg = pivot.msg;
+  self.after_msg.reset();
+  self.nearest_stamp = pivot.stamp;
+  self.ratio = 0.0;
+
+  std::vector<int> nearest(inputs_, -1);
+  std::vector<int> interpolated(inputs_, -1);
+  for (size_t i = 1; i < inputs_; ++i)
+  {
+    const TimeIndexedBuffer& buffer = buffers_[i];
+    int before = buffer.floor(pivot.stamp);
+    int after = (before + 1 < static_cast<int>(buffer.size())) ? before + 1 : -1;
+    if (before >= 0 && buffer.at(before).stamp == pivot.stamp)
+    {
+      after = -1;  // exact match
+    }
+
+    Match& m = matches[i];
+    m.before_msg = (before >= 0) ? buffer.at(before).msg : boost::shared_ptr<void const>();
+    m.after_msg = (after >= 0) ? buffer.at(after).msg : boost::shared_ptr<void const>();
+    m.ratio = 0.0;
+
+    double before_offset = (before >= 0) ? (pivot.stamp - buffer.at(before).stamp).toSec() : INFINITY;
+    double after_offset = (after >= 0) ? (buffer.at(after).stamp - pivot.stamp).toSec() : INFINITY;
+    nearest[i] = (before_offset <= after_offset) ? before : after;
+    double offset = std::min(before_offset, after_offset);
+
+    if (policies_[i] == MatchPolicy::INTERPOLATE && after >= 0)
+    {
+      if (before < 0 || std::max(before_offset, after_offset) > max_interval_.toSec())
+      {
+        return false;
+      }
+      m.ratio = before_offset / (before_offset + after_offset);
+      interpolated[i] = (nearest[i] == before) ? after : before;
+    }
+    if (nearest[i] < 0 || offset > max_interval_.toSec())
+    {
+      return false;
+    }
+
+    m.nearest_msg = buffer.at(nearest[i]).msg;
+    m.nearest_stamp = buffer.at(nearest[i]).stamp;
+    statistics_.offset_max = std::max(statistics_.offset_max, offset);
+  }
+
+  for (size_t i = 1; i < inputs_; ++i)
+  {
+    buffers_[i].at(nearest[i]).used = true;
+    if (interpolated[i] >= 0)
+    {
+      buffers_[i].at(interpolated[i]).used = true;
+    }
+  }
+  return true;
+}
+
+void Synchronizer::prune(const ros::Time& oldest)
+{
+  // keep what the oldest undecided pivot may still need
+  ros::Time bound = (oldest.toSec() > max_interval_.toSec()) ? oldest - max_interval_ : ros::Time(0);
+  for (size_t i = 1; i < inputs_; ++i)
+  {
+    statistics_.dropped[i] += buffers_[i].pruneBefore(bound);
+  }
+}
+
+Statistics Synchronizer::getStatistics() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return statistics_;
+}
+
+void Synchronizer::resetStatistics()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  statistics_.matched = 0;
+  statistics_.dropped_pivots = 0;
+  statistics_.dropped.assign(inputs_, 0);
+  statistics_.latency_mean = 0.0;
+  statistics_.latency_max = 0.0;
+  statistics_.offset_max = 0.0;
+  latency_sum_ = 0.0;
+}
+
+}  // namespace time_sync
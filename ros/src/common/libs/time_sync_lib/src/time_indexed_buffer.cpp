@@ -0,0 +1,84 @@
+/*
+ * Copyright 2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+
+#include <time_sync_lib/time_indexed_buffer.hpp>
+
+namespace time_sync
+{
+namespace
+{
+bool stampLess(const ros::Time& t, const Entry& entry)
+{
+  return t < entry.stamp;
+}
+}  // namespace
+
+TimeIndexedBuffer::TimeIndexedBuffer(size_t capacity) : capacity_(capacity)
+{
+}
+
+size_t TimeIndexedBuffer::insert(const ros::Time& stamp, const boost::shared_ptr<void const>& msg)
+{
+  Entry entry;
+  entry.stamp = stamp;
+  entry.msg = msg;
+  entry.used = false;
+
+  if (entries_.empty() || entries_.back().stamp <= stamp)
+  {
+    entries_.push_back(entry);
+  }
+  else
+  {
+    entries_.insert(std::upper_bound(entries_.begin(), entries_.end(), stamp, stampLess), entry);
+  }
+
+  size_t evicted = 0;
+  while (entries_.size() > capacity_)
+  {
+    if (!entries_.front().used)
+    {
+      ++evicted;
+    }
+    entries_.pop_front();
+  }
+  return evicted;
+}
+
+int TimeIndexedBuffer::floor(const ros::Time& t) const
+{
+  std::deque<Entry>::const_iterator it = std::upper_bound(entries_.begin(), entries_.end(), t, stampLess);
+  return static_cast<int>(it - entries_.begin()) - 1;
+}
+
+size_t TimeIndexedBuffer::pruneBefore(const ros::Time& t)
+{
+  int index = floor(t);
+  size_t unused = 0;
+  for (int i = 0; i < index; ++i)
+  {
+    if (!entries_.front().used)
+    {
+      ++unused;
+    }
+    entries_.pop_front();
+  }
+  return unused;
+}
+
+}  // namespace time_sync
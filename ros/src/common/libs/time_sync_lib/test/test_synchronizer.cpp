@@ -0,0 +1,201 @@
+/*
+ * Copyright 2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include <boost/make_shared.hpp>
+
+#include <time_sync_lib/synchronizer.hpp>
+
+namespace
+{
+/// Stores every match set published by a Synchronizer.
+struct Recorder
+{
+  std::vector<std::vector<time_sync::Match> > published;
+
+  void callback(const std::vector<time_sync::Match>& matches)
+  {
+    published.push_back(matches);
+  }
+};
+
+/// Messages are their own stamp, so a test can tell which one was matched.
+void add(time_sync::Synchronizer& sync, size_t input, double stamp)
+{
+  sync.add(input, ros::Time(stamp), boost::make_shared<double const>(stamp));
+}
+
+time_sync::Synchronizer* makeSynchronizer(Recorder& recorder, double max_interval, double max_delay,
+                                          size_t capacity = 32)
+{
+  time_sync::Synchronizer* sync =
+      new time_sync::Synchronizer(2, ros::Duration(max_interval), ros::Duration(max_delay), capacity);
+  sync->registerCallback(boost::bind(&Recorder::callback, &recorder, _1));
+  return sync;
+}
+}  // namespace
+
+// the closest message within max_interval is matched as soon as a later one arrives
+TEST(Synchronizer, matchesInWindow)
+{
+  Recorder recorder;
+  boost::shared_ptr<time_sync::Synchronizer> sync(makeSynchronizer(recorder, 0.05, 0.2));
+
+  add(*sync, 1, 0.98);
+  add(*sync, 0, 1.0);
+  EXPECT_TRUE(recorder.published.empty());  // a closer message may still come
+  add(*sync, 1, 1.01);
+
+  ASSERT_EQ(1u, recorder.published.size());
+  const std::vector<time_sync::Match>& matches = recorder.published[0];
+  ASSERT_EQ(2u, matches.size());
+  EXPECT_DOUBLE_EQ(1.0, *matches[0].get<double>());
+  EXPECT_DOUBLE_EQ(1.01, *matches[1].get<double>());
+  EXPECT_DOUBLE_EQ(1.01, matches[1].nearest_stamp.toSec());
+
+  time_sync::Statistics stats = sync->getStatistics();
+  EXPECT_EQ(1u, stats.matched);
+  EXPECT_EQ(0u, stats.dropped_pivots);
+  EXPECT_NEAR(0.01, stats.offset_max, 1e-6);
+}
+
+// an exact stamp is matched without waiting for a later message
+TEST(Synchronizer, matchesExactStamp)
+{
+  Recorder recorder;
+  boost::shared_ptr<time_sync::Synchronizer> sync(makeSynchronizer(recorder, 0.05, 0.2));
+
+  add(*sync, 0, 1.0);
+  add(*sync, 1, 1.0);
+
+  ASSERT_EQ(1u, recorder.published.size());
+  EXPECT_DOUBLE_EQ(1.0, *recorder.published[0][1].get<double>());
+  EXPECT_FALSE(recorder.published[0][1].after_msg);
+}
+
+// a pivot without a message within max_interval is dropped, not matched to the nearest one
+TEST(Synchronizer, dropsOutOfWindow)
+{
+  Recorder recorder;
+  boost::shared_ptr<time_sync::Synchronizer> sync(makeSynchronizer(recorder, 0.05, 0.2));
+
+  add(*sync, 1, 0.9);
+  add(*sync, 0, 1.0);
+  add(*sync, 1, 1.1);
+
+  EXPECT_TRUE(recorder.published.empty());
+  time_sync::Statistics stats = sync->getStatistics();
+  EXPECT_EQ(0u, stats.matched);
+  EXPECT_EQ(1u, stats.dropped_pivots);
+  EXPECT_EQ(1u, stats.dropped[0]);
+
+  // the next pivot still finds its message
+  add(*sync, 0, 1.12);
+  add(*sync, 1, 1.2);
+  ASSERT_EQ(1u, recorder.published.size());
+  EXPECT_DOUBLE_EQ(1.1, *recorder.published[0][1].get<double>());
+}
+
+// a pivot is given up on once a newer pivot is more than max_delay ahead
+TEST(Synchronizer, dropsPivotAfterMaxDelay)
+{
+  Recorder recorder;
+  boost::shared_ptr<time_sync::Synchronizer> sync(makeSynchronizer(recorder, 0.05, 0.2));
+
+  add(*sync, 0, 1.0);
+  add(*sync, 0, 1.1);
+  add(*sync, 0, 1.2);
+  EXPECT_EQ(0u, sync->getStatistics().dropped_pivots);
+  add(*sync, 0, 1.3);
+
+  EXPECT_TRUE(recorder.published.empty());
+  EXPECT_EQ(1u, sync->getStatistics().dropped_pivots);
+}
+
+// over capacity, the oldest pivots and messages are evicted and counted as dropped
+TEST(Synchronizer, dropsOldestOverCapacity)
+{
+  Recorder recorder;
+  boost::shared_ptr<time_sync::Synchronizer> sync(makeSynchronizer(recorder, 0.05, 10.0, 3));
+
+  for (int i = 0; i < 5; ++i)
+  {
+    add(*sync, 0, 1.0 + 0.1 * i);
+  }
+  time_sync::Statistics stats = sync->getStatistics();
+  EXPECT_EQ(2u, stats.dropped_pivots);
+  EXPECT_EQ(2u, stats.dropped[0]);
+
+  // pivots 1.2, 1.3 and 1.4 are left, the evicted 1.0 and 1.1 are never published
+  add(*sync, 1, 1.4);
+  ASSERT_EQ(1u, recorder.published.size());
+  EXPECT_DOUBLE_EQ(1.4, *recorder.published[0][0].get<double>());
+  stats = sync->getStatistics();
+  EXPECT_EQ(1u, stats.matched);
+  EXPECT_EQ(4u, stats.dropped_pivots);
+}
+
+TEST(Synchronizer, dropsOldestMessagesOverCapacity)
+{
+  Recorder recorder;
+  boost::shared_ptr<time_sync::Synchronizer> sync(makeSynchronizer(recorder, 0.05, 10.0, 3));
+
+  for (int i = 0; i < 5; ++i)
+  {
+    add(*sync, 1, 1.0 + 0.1 * i);
+  }
+  EXPECT_EQ(2u, sync->getStatistics().dropped[1]);
+
+  // 1.0 would have been the match, but only 1.2, 1.3 and 1.4 are left
+  add(*sync, 0, 1.0);
+  EXPECT_TRUE(recorder.published.empty());
+  add(*sync, 0, 1.3);
+  ASSERT_EQ(1u, recorder.published.size());
+  EXPECT_DOUBLE_EQ(1.3, *recorder.published[0][1].get<double>());
+}
+
+// INTERPOLATE returns the messages around the pivot and the weight of the later one
+TEST(Synchronizer, interpolatesAroundPivot)
+{
+  Recorder recorder;
+  boost::shared_ptr<time_sync::Synchronizer> sync(makeSynchronizer(recorder, 0.05, 0.2));
+  sync->setPolicy(1, time_sync::MatchPolicy::INTERPOLATE);
+
+  add(*sync, 1, 0.96);
+  add(*sync, 0, 1.0);
+  add(*sync, 1, 1.04);
+
+  ASSERT_EQ(1u, recorder.published.size());
+  const time_sync::Match& match = recorder.published[0][1];
+  EXPECT_DOUBLE_EQ(0.96, *match.before<double>());
+  EXPECT_DOUBLE_EQ(1.04, *match.after<double>());
+  EXPECT_NEAR(0.5, match.ratio, 1e-6);
+
+  // one of both sides out of the window drops the pivot
+  add(*sync, 0, 1.1);
+  add(*sync, 1, 1.2);
+  EXPECT_EQ(1u, recorder.published.size());
+  EXPECT_EQ(1u, sync->getStatistics().dropped_pivots);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -27,7 +27,6 @@
 
 #include <string>
 #include <vector>
-#include <unordered_map>
 #include <chrono>
 
 #include <ros/ros.h>
@@ -57,17 +56,6 @@
 
 #include <Eigen/Eigen>
 
-namespace std {
-	template <>
-	class hash< cv::Point >{
-	public :
-		size_t operator()(const cv::Point &pixel_cloud ) const
-		{
-			return hash<std::string>()( std::to_string(pixel_cloud.x) + "|" + std::to_string(pixel_cloud.y) );
-		}
-	};
-};
-
 class ROSPixelCloudFusionApp
 {
 	ros::NodeHandle                     node_handle_;
@@ -91,6 +79,10 @@ class ROSPixelCloudFusionApp
 	float                               fx_, fy_, cx_, cy_;
 	pcl::PointCloud<pcl::PointXYZRGB>   colored_cloud_;
 
+	std::vector<int>                    projected_pixels_;  // row-major pixel of each point, -1 outside the image
+	std::vector<float>                  projected_depths_;
+	cv::Mat                             projection_index_;  // CV_32SC1, closest point of each pixel or -1
+
 	typedef
 	message_filters::sync_policies::ApproximateTime<sensor_msgs::PointCloud2, sensor_msgs::Image> SyncPolicyT;
 
@@ -71,53 +71,92 @@ void ROSPixelCloudFusionApp::CloudCallback(const sensor_msgs::PointCloud2::Const
 	}
 
 	pcl::PointCloud<pcl::PointXYZ>::Ptr in_cloud(new pcl::PointCloud<pcl::PointXYZ>);
-	pcl::PointCloud<pcl::PointXYZRGB>::Ptr out_cloud(new pcl::PointCloud<pcl::PointXYZRGB>);
 	pcl::fromROSMsg(*in_cloud_msg, *in_cloud);
-	std::unordered_map<cv::Point, pcl::PointXYZ> projection_map;
+	const int points_num = in_cloud->points.size();
 
-	std::vector<pcl::PointXYZ> cam_cloud(in_cloud->points.size());
-	for (size_t i = 0; i < in_cloud->points.size(); i++)
+	// camera-lidar transform as a plain matrix, so the projection loop below has no tf calls
+	// and can be vectorized
+	float rotation[3][3], translation[3];
+	const tf::Matrix3x3 &basis = camera_lidar_tf_.getBasis();
+	const tf::Vector3 &origin = camera_lidar_tf_.getOrigin();
+	for (int row = 0; row < 3; row++)
 	{
-		cam_cloud[i] = TransformPoint(in_cloud->points[i], camera_lidar_tf_);
-		int u = int(cam_cloud[i].x * fx_ / cam_cloud[i].z + cx_);
-		int v = int(cam_cloud[i].y * fy_ / cam_cloud[i].z + cy_);
-		if ((u >= 0) && (u < image_size_.width)
-			&& (v >= 0) && (v < image_size_.height)
-			&& cam_cloud[i].z > 0
-				)
+		for (int col = 0; col < 3; col++)
 		{
-			projection_map.insert(std::pair<cv::Point, pcl::PointXYZ>(cv::Point(u, v), in_cloud->points[i]));
+			rotation[row][col] = basis[row][col];
 		}
+		translation[row] = origin[row];
 	}
 
-	out_cloud->points.clear();
+	projected_pixels_.resize(points_num);
+	projected_depths_.resize(points_num);
+	const int image_width = image_size_.width;
+	const int image_height = image_size_.height;
+#pragma omp parallel for
+	for (int i = 0; i < points_num; i++)
+	{
+		const pcl::PointXYZ &point = in_cloud->points[i];
+		float x = rotation[0][0] * point.x + rotation[0][1] * point.y + rotation[0][2] * point.z + translation[0];
+		float y = rotation[1][0] * point.x + rotation[1][1] * point.y + rotation[1][2] * point.z + translation[1];
+		float z = rotation[2][0] * point.x + rotation[2][1] * point.y + rotation[2][2] * point.z + translation[2];
+		projected_pixels_[i] = -1;
+		projected_depths_[i] = z;
+		// points behind the camera are rejected before projecting, and the pixel coordinates are
+		// bounded before the integer conversion, which would overflow for points near the camera plane
+		if (!(z > 0))
+			continue;
+		float u = x * fx_ / z + cx_;
+		float v = y * fy_ / z + cy_;
+		if (u >= 0 && u < image_width && v >= 0 && v < image_height)
+		{
+			projected_pixels_[i] = int(v) * image_width + int(u);
+		}
+	}
 
-#pragma omp for
-	for (int row = 0; row < image_size_.height; row++)
+	// z-buffer: every pixel keeps the index of the closest point projected on it
+	if (projection_index_.size() != image_size_)
 	{
-		for (int col = 0; col < image_size_.width; col++)
+		projection_index_.create(image_size_, CV_32SC1);
+	}
+	projection_index_.setTo(cv::Scalar(-1));
+	int *pixel_points = projection_index_.ptr<int>();
+	for (int i = 0; i < points_num; i++)
+	{
+		const int pixel = projected_pixels_[i];
+		if (pixel < 0)
+			continue;
+		const int current = pixel_points[pixel];
+		if (current < 0 || projected_depths_[i] < projected_depths_[current])
 		{
-			std::unordered_map<cv::Point, pcl::PointXYZ>::const_iterator iterator_3d_2d;
-			pcl::PointXYZ corresponding_3d_point;
-			pcl::PointXYZRGB colored_3d_point;
-			iterator_3d_2d = projection_map.find(cv::Point(col, row));
-			if (iterator_3d_2d != projection_map.end())
-			{
-				corresponding_3d_point = iterator_3d_2d->second;
-				cv::Vec3b rgb_pixel = current_frame_.at<cv::Vec3b>(row, col);
-				colored_3d_point.x = corresponding_3d_point.x;
-				colored_3d_point.y = corresponding_3d_point.y;
-				colored_3d_point.z = corresponding_3d_point.z;
-				colored_3d_point.r = rgb_pixel[2];
-				colored_3d_point.g = rgb_pixel[1];
-				colored_3d_point.b = rgb_pixel[0];
-				out_cloud->points.push_back(colored_3d_point);
-			}
+			pixel_points[pixel] = i;
 		}
 	}
+
+	// colorize only the points that won their pixel, the image itself is not scanned
+	colored_cloud_.points.clear();
+	for (int i = 0; i < points_num; i++)
+	{
+		const int pixel = projected_pixels_[i];
+		if (pixel < 0 || pixel_points[pixel] != i)
+			continue;
+		const pcl::PointXYZ &point = in_cloud->points[i];
+		const cv::Vec3b &rgb_pixel = current_frame_.at<cv::Vec3b>(pixel / image_width, pixel % image_width);
+		pcl::PointXYZRGB colored_3d_point;
+		colored_3d_point.x = point.x;
+		colored_3d_point.y = point.y;
+		colored_3d_point.z = point.z;
+		colored_3d_point.r = rgb_pixel[2];
+		colored_3d_point.g = rgb_pixel[1];
+		colored_3d_point.b = rgb_pixel[0];
+		colored_cloud_.points.push_back(colored_3d_point);
+	}
+	colored_cloud_.width = colored_cloud_.points.size();
+	colored_cloud_.height = 1;
+	colored_cloud_.is_dense = true;
+
 	// Publish PC
 	sensor_msgs::PointCloud2 cloud_msg;
-	pcl::toROSMsg(*out_cloud, cloud_msg);
+	pcl::toROSMsg(colored_cloud_, cloud_msg);
 	cloud_msg.header = in_cloud_msg->header;
 	publisher_fused_cloud_.publish(cloud_msg);
 }
@@ -40,9 +40,7 @@
 
 #include <jsk_recognition_utils/geo/cube.h>
 
-#include <message_filters/subscriber.h>
-#include <message_filters/synchronizer.h>
-#include <message_filters/sync_policies/approximate_time.h>
+#include <time_sync_lib/synchronizer.hpp>
 
 #include <opencv2/highgui/highgui.hpp>
 #include <opencv2/imgproc/imgproc.hpp>
@@ -64,9 +62,6 @@ class ROSRangeVisionFusionApp
   ros::Subscriber detections_vision_subscriber_;
   ros::Subscriber detections_range_subscriber_;
 
-  message_filters::Subscriber<autoware_msgs::DetectedObjectArray>
-    *vision_filter_subscriber_, *range_filter_subscriber_;
-
   tf::TransformListener *transform_listener_;
   tf::StampedTransform camera_lidar_tf_;
 
@@ -97,15 +92,10 @@ class ROSRangeVisionFusionApp
 
   size_t empty_frames_;
 
-  typedef
-  message_filters::sync_policies::ApproximateTime<autoware_msgs::DetectedObjectArray,
-    autoware_msgs::DetectedObjectArray> SyncPolicyT;
-
   ros::Subscriber vision_objects_subscriber_;
   ros::Subscriber range_objects_subscriber_;
 
-  message_filters::Synchronizer<SyncPolicyT>
-    *detections_synchronizer_;
+  boost::shared_ptr<time_sync::Synchronizer> detections_synchronizer_;
 
   void CheckMinimumDimensions(autoware_msgs::DetectedObject &in_out_object);
 
@@ -116,6 +106,8 @@ class ROSRangeVisionFusionApp
   void SyncedDetectionsCallback(const autoware_msgs::DetectedObjectArray::ConstPtr &in_vision_detections,
                                 const autoware_msgs::DetectedObjectArray::ConstPtr &in_range_detections);
 
+  void MatchedDetectionsCallback(const std::vector<time_sync::Match> &in_matches);
+
   autoware_msgs::DetectedObjectArray
   FuseRangeVisionDetections(const autoware_msgs::DetectedObjectArray::ConstPtr &in_vision_detections,
                             const autoware_msgs::DetectedObjectArray::ConstPtr &in_range_detections);
@@ -124,7 +116,8 @@ class ROSRangeVisionFusionApp
 
   cv::Point2i ProjectPoint(const cv::Point3f &in_point);
 
-  cv::Rect ProjectDetectionToRect(const autoware_msgs::DetectedObject &in_detection);
+  cv::Rect ProjectDetectionToRect(const autoware_msgs::DetectedObject &in_detection,
+                                  const Eigen::Affine3f &in_range_vision_tf);
 
   bool IsObjectInImage(const autoware_msgs::DetectedObject &in_detection);
 
@@ -22,6 +22,11 @@
 
 #include "range_vision_fusion/range_vision_fusion.h"
 
+#include <vision_beyond_track/hungarian.h>
+
+// side in pixels of the cells used to find the projected range detections under a vision detection
+static const int IMAGE_GRID_CELL_SIZE = 64;
+
 cv::Point3f
 ROSRangeVisionFusionApp::TransformPoint(const geometry_msgs::Point &in_point, const tf::StampedTransform &in_transform)
 {
@@ -82,7 +87,8 @@ ROSRangeVisionFusionApp::IsObjectInImage(const autoware_msgs::DetectedObject &in
          && (image_space_point.z > 0);
 }
 
-cv::Rect ROSRangeVisionFusionApp::ProjectDetectionToRect(const autoware_msgs::DetectedObject &in_detection)
+cv::Rect ROSRangeVisionFusionApp::ProjectDetectionToRect(const autoware_msgs::DetectedObject &in_detection,
+                                                         const Eigen::Affine3f &in_range_vision_tf)
 {
   cv::Rect projected_box;
 
@@ -104,9 +110,7 @@ cv::Rect ROSRangeVisionFusionApp::ProjectDetectionToRect(const autoware_msgs::De
 
   jsk_recognition_utils::Cube cube(pos, rot, dims);
 
-  Eigen::Affine3f range_vision_tf;
-  tf::transformTFToEigen(camera_lidar_tf_, range_vision_tf);
-  jsk_recognition_utils::Vertices vertices = cube.transformVertices(range_vision_tf);
+  jsk_recognition_utils::Vertices vertices = cube.transformVertices(in_range_vision_tf);
 
   std::vector<cv::Point> polygon;
   for (auto &vertex : vertices)
@@ -338,77 +342,140 @@ ROSRangeVisionFusionApp::FuseRangeVisionDetections(
   autoware_msgs::DetectedObjectArray fused_objects;
   fused_objects.header = in_range_detections->header;
 
-  std::vector<std::vector<size_t> > vision_range_assignments(in_vision_detections->objects.size());
-  std::vector<bool> used_vision_detections(in_vision_detections->objects.size(), false);
-  std::vector<long> vision_range_closest(in_vision_detections->objects.size());
+  const size_t vision_num = in_vision_detections->objects.size();
+  const size_t range_num = range_in_cv.objects.size();
+  const cv::Rect image_rect(0, 0, image_size_.width, image_size_.height);
 
-  for (size_t i = 0; i < in_vision_detections->objects.size(); i++)
+  // project every range detection once, and register it in the cells of the image it covers
+  Eigen::Affine3f range_vision_tf;
+  tf::transformTFToEigen(camera_lidar_tf_, range_vision_tf);
+  const int grid_width = (image_size_.width + IMAGE_GRID_CELL_SIZE - 1) / IMAGE_GRID_CELL_SIZE;
+  const int grid_height = (image_size_.height + IMAGE_GRID_CELL_SIZE - 1) / IMAGE_GRID_CELL_SIZE;
+  std::vector<std::vector<size_t> > image_grid(grid_width * grid_height);
+  std::vector<cv::Rect> range_rects(range_num);
+  for (size_t j = 0; j < range_num; j++)
+  {
+    range_rects[j] = ProjectDetectionToRect(range_in_cv.objects[j], range_vision_tf);
+    cv::Rect visible_rect = range_rects[j] & image_rect;
+    if (visible_rect.area() <= 0)
+      continue;
+    for (int row = visible_rect.y / IMAGE_GRID_CELL_SIZE;
+         row <= (visible_rect.br().y - 1) / IMAGE_GRID_CELL_SIZE; row++)
+    {
+      for (int col = visible_rect.x / IMAGE_GRID_CELL_SIZE;
+           col <= (visible_rect.br().x - 1) / IMAGE_GRID_CELL_SIZE; col++)
+      {
+        image_grid[row * grid_width + col].push_back(j);
+      }
+    }
+  }
+
+  // candidate pairs, the range detections that overlap enough with each vision detection
+  std::vector<std::vector<std::pair<size_t, double> > > vision_range_candidates(vision_num);
+  std::vector<long> range_checked(range_num, -1);
+  std::vector<int> range_columns(range_num, -1);
+  std::vector<size_t> candidate_ranges;
+  std::vector<size_t> candidate_visions;
+  for (size_t i = 0; i < vision_num; i++)
   {
-    auto vision_object = in_vision_detections->objects[i];
+    const autoware_msgs::DetectedObject &vision_object = in_vision_detections->objects[i];
 
     cv::Rect vision_rect(vision_object.x, vision_object.y,
                          vision_object.width, vision_object.height);
     int vision_rect_area = vision_rect.area();
-    long closest_index = -1;
-    double closest_distance = std::numeric_limits<double>::max();
+    cv::Rect visible_rect = vision_rect & image_rect;
+    if (visible_rect.area() <= 0)
+      continue;
 
-    for (size_t j = 0; j < range_in_cv.objects.size(); j++)
+    for (int row = visible_rect.y / IMAGE_GRID_CELL_SIZE;
+         row <= (visible_rect.br().y - 1) / IMAGE_GRID_CELL_SIZE; row++)
     {
-      double current_distance = GetDistanceToObject(range_in_cv.objects[j]);
-
-      cv::Rect range_rect = ProjectDetectionToRect(range_in_cv.objects[j]);
-      int range_rect_area = range_rect.area();
-
-      cv::Rect overlap = range_rect & vision_rect;
-      if ((overlap.area() > range_rect_area * overlap_threshold_)
-          || (overlap.area() > vision_rect_area * overlap_threshold_)
-        )
+      for (int col = visible_rect.x / IMAGE_GRID_CELL_SIZE;
+           col <= (visible_rect.br().x - 1) / IMAGE_GRID_CELL_SIZE; col++)
       {
-        vision_range_assignments[i].push_back(j);
-        range_in_cv.objects[j].score = vision_object.score;
-        range_in_cv.objects[j].label = vision_object.label;
-        range_in_cv.objects[j].color = vision_object.color;
-        range_in_cv.objects[j].image_frame = vision_object.image_frame;
-        range_in_cv.objects[j].x = vision_object.x;
-        range_in_cv.objects[j].y = vision_object.y;
-        range_in_cv.objects[j].width = vision_object.width;
-        range_in_cv.objects[j].height = vision_object.height;
-        range_in_cv.objects[j].angle = vision_object.angle;
-        range_in_cv.objects[j].id = vision_object.id;
-        CheckMinimumDimensions(range_in_cv.objects[j]);
-        if (vision_object.pose.orientation.x > 0
-            || vision_object.pose.orientation.y > 0
-            || vision_object.pose.orientation.z > 0)
-        {
-          range_in_cv.objects[i].pose.orientation = vision_object.pose.orientation;
-        }
-        if (current_distance < closest_distance)
+        for (auto j : image_grid[row * grid_width + col])
         {
-          closest_index = j;
-          closest_distance = current_distance;
+          // a range detection spanning several cells is only checked once
+          if (range_checked[j] == static_cast<long>(i))
+            continue;
+          range_checked[j] = i;
+
+          int range_rect_area = range_rects[j].area();
+          cv::Rect overlap = range_rects[j] & vision_rect;
+          if ((overlap.area() > range_rect_area * overlap_threshold_)
+              || (overlap.area() > vision_rect_area * overlap_threshold_)
+            )
+          {
+            double iou = static_cast<double>(overlap.area()) / (range_rect_area + vision_rect_area - overlap.area());
+            vision_range_candidates[i].push_back(std::make_pair(j, iou));
+            if (range_columns[j] < 0)
+            {
+              range_columns[j] = candidate_ranges.size();
+              candidate_ranges.push_back(j);
+            }
+          }//end if overlap
         }
-        used_vision_detections[i] = true;
-      }//end if overlap
-    }//end for range_in_cv
-    vision_range_closest[i] = closest_index;
+      }
+    }
+    if (!vision_range_candidates[i].empty())
+      candidate_visions.push_back(i);
   }
 
-  std::vector<bool> used_range_detections(range_in_cv.objects.size(), false);
-  //only assign the closest
-  for (size_t i = 0; i < vision_range_assignments.size(); i++)
+  // each range detection takes the label of at most one vision detection, and vice versa,
+  // so that the sum of the IoU of the matched pairs is maximum
+  std::vector<long> vision_range_assignments(vision_num, -1);
+  if (!candidate_visions.empty())
   {
-    if (!range_in_cv.objects.empty() && vision_range_closest[i] >= 0)
+    // pairs that do not overlap cost as much as no match at all
+    std::vector<std::vector<double> > cost_matrix(candidate_visions.size(),
+                                                  std::vector<double>(candidate_ranges.size(), 1.));
+    for (size_t row = 0; row < candidate_visions.size(); row++)
+    {
+      for (const auto &candidate : vision_range_candidates[candidate_visions[row]])
+      {
+        cost_matrix[row][range_columns[candidate.first]] = 1. - candidate.second;
+      }
+    }
+    std::vector<int> assignment;
+    HungarianAlgorithm hungarian;
+    hungarian.Solve(cost_matrix, assignment);
+
+    for (size_t row = 0; row < candidate_visions.size(); row++)
     {
-      used_range_detections[i] = true;
-      fused_objects.objects.push_back(range_in_cv.objects[vision_range_closest[i]]);
+      if (assignment[row] < 0 || cost_matrix[row][assignment[row]] >= 1.)
+        continue;
+      vision_range_assignments[candidate_visions[row]] = candidate_ranges[assignment[row]];
     }
   }
-  for (size_t i = 0; i < used_vision_detections.size(); i++)
+
+  for (size_t i = 0; i < vision_num; i++)
   {
-    if (!used_vision_detections[i])
+    const autoware_msgs::DetectedObject &vision_object = in_vision_detections->objects[i];
+    if (vision_range_assignments[i] < 0)
     {
-      fused_objects.objects.push_back(in_vision_detections->objects[i]);
+      fused_objects.objects.push_back(vision_object);
+      continue;
     }
+
+    autoware_msgs::DetectedObject range_object = range_in_cv.objects[vision_range_assignments[i]];
+    range_object.score = vision_object.score;
+    range_object.label = vision_object.label;
+    range_object.color = vision_object.color;
+    range_object.image_frame = vision_object.image_frame;
+    range_object.x = vision_object.x;
+    range_object.y = vision_object.y;
+    range_object.width = vision_object.width;
+    range_object.height = vision_object.height;
+    range_object.angle = vision_object.angle;
+    range_object.id = vision_object.id;
+    CheckMinimumDimensions(range_object);
+    if (vision_object.pose.orientation.x > 0
+        || vision_object.pose.orientation.y > 0
+        || vision_object.pose.orientation.z > 0)
+    {
+      range_object.pose.orientation = vision_object.pose.orientation;
+    }
+    fused_objects.objects.push_back(range_object);
   }
   //add also objects outside the image
   for (auto &object: range_out_cv.objects)
@@ -484,6 +551,13 @@ ROSRangeVisionFusionApp::SyncedDetectionsCallback(
 
 }
 
+void
+ROSRangeVisionFusionApp::MatchedDetectionsCallback(const std::vector<time_sync::Match> &in_matches)
+{
+  SyncedDetectionsCallback(in_matches[1].get<autoware_msgs::DetectedObjectArray>(),
+                           in_matches[0].get<autoware_msgs::DetectedObjectArray>());
+}
+
 void
 ROSRangeVisionFusionApp::VisionDetectionsCallback(
   const autoware_msgs::DetectedObjectArray::ConstPtr &in_vision_detections)
@@ -582,6 +656,7 @@ ROSRangeVisionFusionApp::InitializeROSIo(ros::NodeHandle &in_private_handle)
   std::string detected_objects_range, fused_topic_str = "/detection/fusion_tools/objects";
   std::string name_space_str = ros::this_node::getNamespace();
   bool sync_topics = false;
+  double sync_max_interval, sync_max_delay;
 
   ROS_INFO(
     "[%s] This node requires: Registered TF(Lidar-Camera), CameraInfo, Vision and Range Detections being published.",
@@ -613,6 +688,12 @@ ROSRangeVisionFusionApp::InitializeROSIo(ros::NodeHandle &in_private_handle)
   in_private_handle.param<bool>("sync_topics", sync_topics, false);
   ROS_INFO("[%s] sync_topics: %d", __APP_NAME__, sync_topics);
 
+  in_private_handle.param<double>("sync_max_interval", sync_max_interval, 0.1);
+  ROS_INFO("[%s] sync_max_interval: %f", __APP_NAME__, sync_max_interval);
+
+  in_private_handle.param<double>("sync_max_delay", sync_max_delay, 1.0);
+  ROS_INFO("[%s] sync_max_delay: %f", __APP_NAME__, sync_max_delay);
+
   YAML::Node car_dimensions = YAML::Load(min_car_dimensions);
   YAML::Node person_dimensions = YAML::Load(min_person_dimensions);
   YAML::Node truck_dimensions = YAML::Load(min_truck_dimensions);
@@ -667,18 +748,14 @@ ROSRangeVisionFusionApp::InitializeROSIo(ros::NodeHandle &in_private_handle)
   }
   else
   {
-    vision_filter_subscriber_ = new message_filters::Subscriber<autoware_msgs::DetectedObjectArray>(node_handle_,
-                                                                                                    detected_objects_vision,
-                                                                                                    1);
-    range_filter_subscriber_ = new message_filters::Subscriber<autoware_msgs::DetectedObjectArray>(node_handle_,
-                                                                                                   detected_objects_range,
-                                                                                                   1);
-    detections_synchronizer_ =
-      new message_filters::Synchronizer<SyncPolicyT>(SyncPolicyT(10),
-                                                     *vision_filter_subscriber_,
-                                                     *range_filter_subscriber_);
+    // the range detections are the pivot, the vision detections are matched to them by stamp
+    detections_synchronizer_.reset(new time_sync::Synchronizer(2, ros::Duration(sync_max_interval),
+                                                               ros::Duration(sync_max_delay)));
     detections_synchronizer_->registerCallback(
-      boost::bind(&ROSRangeVisionFusionApp::SyncedDetectionsCallback, this, _1, _2));
+      boost::bind(&ROSRangeVisionFusionApp::MatchedDetectionsCallback, this, _1));
+    detections_synchronizer_->subscribe<autoware_msgs::DetectedObjectArray>(node_handle_, detected_objects_range, 0, 1);
+    detections_synchronizer_->subscribe<autoware_msgs::DetectedObjectArray>(node_handle_, detected_objects_vision, 1,
+                                                                            1);
   }
 
   publisher_fused_objects_ = node_handle_.advertise<autoware_msgs::DetectedObjectArray>(fused_topic_str, 1);
@@ -54,9 +54,16 @@
 #include <cmath>
 #include <chrono>
 
+#include <boost/make_shared.hpp>
+
 class Cluster
 {
   pcl::PointCloud<pcl::PointXYZRGB>::Ptr pointcloud_;
+  pcl::PointCloud<pcl::PointXYZ>::Ptr origin_cloud_ptr_;
+  std::vector<int> origin_indices_;
+  std_msgs::Header ros_header_;
+  bool estimate_pose_;
+  bool features_computed_;
   pcl::PointXYZ min_point_;
   pcl::PointXYZ max_point_;
   pcl::PointXYZ average_point_;
@@ -91,14 +98,24 @@ public:
                 const std::vector<int>& in_cluster_indices, std_msgs::Header in_ros_header, int in_id, int in_r,
                 int in_g, int in_b, std::string in_label, bool in_estimate_pose);
 
+  /* \brief Computes the BoundingBox, the convex hull, the pose and the Eigen decomposition of the Cluster.
+   * SetCloud only computes the min, max and centroid points, the rest is computed by this method, either
+   * explicitly (e.g. in parallel for a batch of clusters) or on the first call to a getter that needs it.
+   * */
+  void ComputeFeatures();
+
   /* \brief Returns the autoware_msgs::CloudCluster message associated to this Cluster */
   void ToROSMessage(std_msgs::Header in_ros_header, autoware_msgs::CloudCluster& out_cluster_message);
 
   Cluster();
   virtual ~Cluster();
 
-  /* \brief Returns the pointer to the PointCloud containing the points in this Cluster */
+  /* \brief Returns the pointer to the PointCloud containing the points in this Cluster, created on the first call */
   pcl::PointCloud<pcl::PointXYZRGB>::Ptr GetCloud();
+  /* \brief Returns the PointCloud this Cluster was created from */
+  pcl::PointCloud<pcl::PointXYZ>::Ptr GetOriginCloud();
+  /* \brief Returns the indices of the points of this Cluster in the origin PointCloud */
+  const std::vector<int>& GetOriginIndices();
   /* \brief Returns the minimum point in the cluster */
   pcl::PointXYZ GetMinPoint();
   /* \brief Returns the maximum point in the cluster*/
@@ -0,0 +1,44 @@
+#ifndef EUCLIDEAN_CLUSTERING_H_
+#define EUCLIDEAN_CLUSTERING_H_
+
+#include <vector>
+
+#include <pcl/point_types.h>
+#include <pcl/point_cloud.h>
+#include <pcl/PointIndices.h>
+
+/* Clustering steps of lidar_euclidean_cluster_detect that only need the points,
+ * kept out of the node so they can be linked by other packages (benchmarks). All
+ * clusters are returned as point indices of in_cloud_ptr, on the xy plane. */
+
+/* Euclidean clustering of the flattened cloud with a kd-tree. */
+std::vector<pcl::PointIndices> extractEuclideanClusters(const pcl::PointCloud<pcl::PointXYZ>::Ptr in_cloud_ptr,
+                                                        double in_max_cluster_distance, int in_cluster_size_min,
+                                                        int in_cluster_size_max);
+
+/* Runs the grid clustering on the given points of in_cloud_ptr (all of them if
+ * in_indices is empty). */
+std::vector<std::vector<int> > extractGridClusters(const pcl::PointCloud<pcl::PointXYZ>::Ptr in_cloud_ptr,
+                                                   const std::vector<int> &in_indices, double in_max_cluster_distance,
+                                                   int in_cluster_size_min, int in_cluster_size_max);
+
+// elapsed time of each step of extractRangeBandClusters [ms]
+struct RangeBandClusteringTime
+{
+  double split;
+  double cluster;
+  double stitch;
+};
+
+/* Clusters the cloud with a tolerance that depends on the distance to the sensor.
+ * Points are assigned to range bands (in_ranges, in_distances has one more entry) by
+ * index, the bands are clustered concurrently on a single flat copy of the cloud,
+ * with the grid clustering if in_use_grid, then clusters split by a band boundary
+ * are joined if they have points closer than the smaller of both tolerances across it. */
+std::vector<std::vector<int> > extractRangeBandClusters(const pcl::PointCloud<pcl::PointXYZ>::Ptr in_cloud_ptr,
+                                                        const std::vector<double> &in_ranges,
+                                                        const std::vector<double> &in_distances,
+                                                        int in_cluster_size_min, int in_cluster_size_max,
+                                                        bool in_use_grid, RangeBandClusteringTime *out_time = NULL);
+
+#endif
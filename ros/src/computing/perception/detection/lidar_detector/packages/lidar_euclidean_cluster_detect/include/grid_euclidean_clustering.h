@@ -0,0 +1,56 @@
+#ifndef GRID_EUCLIDEAN_H_
+#define GRID_EUCLIDEAN_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/* Euclidean clustering on the CPU, on the xy plane.
+ * Points are hashed into square cells small enough for all points in a cell to be
+ * connected, so only whole cells are labelled. Neighbouring cells are joined in
+ * parallel with a lock-free union-find when any of their points are within the
+ * threshold. The clusters are the same as those of a Euclidean clustering with the
+ * same threshold. */
+class GridEuclideanCluster
+{
+public:
+  typedef struct
+  {
+    int index_value;
+    std::vector<int> points_in_cluster;
+  } GClusterIndex;
+
+  GridEuclideanCluster();
+
+  void setInputPoints(const float* x, const float* y, int size);
+  void setThreshold(double threshold);
+  void setMinClusterPts(int min_cluster_pts);
+  void setMaxClusterPts(int max_cluster_pts);
+  void extractClusters();
+  std::vector<GClusterIndex> getOutput();
+
+  ~GridEuclideanCluster();
+
+private:
+  const float *x_, *y_;
+  int size_;
+  double threshold_;
+  int min_cluster_pts_;
+  int max_cluster_pts_;
+
+  // points sorted by cell, cell i holds points_[cell_start_[i]] .. points_[cell_start_[i + 1] - 1]
+  std::vector<std::pair<int64_t, int> > points_;
+  std::vector<int> cell_start_;
+  std::vector<int64_t> cell_keys_;
+  std::unique_ptr<std::atomic<int>[]> cell_parents_;
+  int cell_parents_size_;
+
+  std::vector<GClusterIndex> clusters_;
+
+  int findCell(int cell);
+  void joinCells(int cell_a, int cell_b);
+  bool cellsConnected(int cell_a, int cell_b, float squared_threshold);
+};
+
+#endif
@@ -10,23 +10,59 @@
 Cluster::Cluster()
 {
   valid_cluster_ = true;
+  estimate_pose_ = false;
+  features_computed_ = false;
+  orientation_angle_ = 0;
 }
 
 geometry_msgs::PolygonStamped Cluster::GetPolygon()
 {
+  ComputeFeatures();
   return polygon_;
 }
 
 jsk_recognition_msgs::BoundingBox Cluster::GetBoundingBox()
 {
+  ComputeFeatures();
   return bounding_box_;
 }
 
 pcl::PointCloud<pcl::PointXYZRGB>::Ptr Cluster::GetCloud()
 {
+  if (!pointcloud_)
+  {
+    // colored copy of the points, only for the clusters that are published
+    pcl::PointCloud<pcl::PointXYZRGB>::Ptr current_cluster(new pcl::PointCloud<pcl::PointXYZRGB>);
+    current_cluster->points.resize(origin_indices_.size());
+    for (size_t i = 0; i < origin_indices_.size(); i++)
+    {
+      const pcl::PointXYZ& origin_point = origin_cloud_ptr_->points[origin_indices_[i]];
+      pcl::PointXYZRGB& p = current_cluster->points[i];
+      p.x = origin_point.x;
+      p.y = origin_point.y;
+      p.z = origin_point.z;
+      p.r = r_;
+      p.g = g_;
+      p.b = b_;
+    }
+    current_cluster->width = current_cluster->points.size();
+    current_cluster->height = 1;
+    current_cluster->is_dense = true;
+    pointcloud_ = current_cluster;
+  }
   return pointcloud_;
 }
 
+pcl::PointCloud<pcl::PointXYZ>::Ptr Cluster::GetOriginCloud()
+{
+  return origin_cloud_ptr_;
+}
+
+const std::vector<int>& Cluster::GetOriginIndices()
+{
+  return origin_indices_;
+}
+
 pcl::PointXYZ Cluster::GetMinPoint()
 {
   return min_point_;
@@ -49,16 +85,19 @@ pcl::PointXYZ Cluster::GetAveragePoint()
 
 double Cluster::GetOrientationAngle()
 {
+  ComputeFeatures();
   return orientation_angle_;
 }
 
 Eigen::Matrix3f Cluster::GetEigenVectors()
 {
+  ComputeFeatures();
   return eigen_vectors_;
 }
 
 Eigen::Vector3f Cluster::GetEigenValues()
 {
+  ComputeFeatures();
   return eigen_values_;
 }
 
@@ -128,9 +167,15 @@ void Cluster::SetCloud(const pcl::PointCloud<pcl::PointXYZ>::Ptr in_origin_cloud
   r_ = in_r;
   g_ = in_g;
   b_ = in_b;
-  // extract pointcloud using the indices
+  // the cluster is a view on the origin cloud, the points are not copied
+  origin_cloud_ptr_ = in_origin_cloud_ptr;
+  origin_indices_ = in_cluster_indices;
+  ros_header_ = in_ros_header;
+  estimate_pose_ = in_estimate_pose;
+  pointcloud_.reset();
+  features_computed_ = false;
+
   // calculate min and max points
-  pcl::PointCloud<pcl::PointXYZRGB>::Ptr current_cluster(new pcl::PointCloud<pcl::PointXYZRGB>);
   float min_x = std::numeric_limits<float>::max();
   float max_x = -std::numeric_limits<float>::max();
   float min_y = std::numeric_limits<float>::max();
@@ -141,22 +186,11 @@ void Cluster::SetCloud(const pcl::PointCloud<pcl::PointXYZ>::Ptr in_origin_cloud
 
   for (auto pit = in_cluster_indices.begin(); pit != in_cluster_indices.end(); ++pit)
   {
-    // fill new colored cluster point by point
-    pcl::PointXYZRGB p;
-    p.x = in_origin_cloud_ptr->points[*pit].x;
-    p.y = in_origin_cloud_ptr->points[*pit].y;
-    p.z = in_origin_cloud_ptr->points[*pit].z;
-    p.r = in_r;
-    p.g = in_g;
-    p.b = in_b;
+    const pcl::PointXYZ& p = in_origin_cloud_ptr->points[*pit];
 
     average_x += p.x;
     average_y += p.y;
     average_z += p.z;
-    centroid_.x += p.x;
-    centroid_.y += p.y;
-    centroid_.z += p.z;
-    current_cluster->points.push_back(p);
 
     if (p.x < min_x)
       min_x = p.x;
@@ -182,10 +216,6 @@ void Cluster::SetCloud(const pcl::PointCloud<pcl::PointXYZ>::Ptr in_origin_cloud
   // calculate centroid, average
   if (in_cluster_indices.size() > 0)
   {
-    centroid_.x /= in_cluster_indices.size();
-    centroid_.y /= in_cluster_indices.size();
-    centroid_.z /= in_cluster_indices.size();
-
     average_x /= in_cluster_indices.size();
     average_y /= in_cluster_indices.size();
     average_z /= in_cluster_indices.size();
@@ -194,13 +224,23 @@ void Cluster::SetCloud(const pcl::PointCloud<pcl::PointXYZ>::Ptr in_origin_cloud
   average_point_.x = average_x;
   average_point_.y = average_y;
   average_point_.z = average_z;
+  centroid_ = average_point_;
 
   // calculate bounding box
   length_ = max_point_.x - min_point_.x;
   width_ = max_point_.y - min_point_.y;
   height_ = max_point_.z - min_point_.z;
 
-  bounding_box_.header = in_ros_header;
+  valid_cluster_ = true;
+}
+
+void Cluster::ComputeFeatures()
+{
+  if (features_computed_)
+    return;
+  features_computed_ = true;
+
+  bounding_box_.header = ros_header_;
 
   bounding_box_.pose.position.x = min_point_.x + length_ / 2;
   bounding_box_.pose.position.y = min_point_.y + width_ / 2;
@@ -214,19 +254,18 @@ void Cluster::SetCloud(const pcl::PointCloud<pcl::PointXYZ>::Ptr in_origin_cloud
   double rz = 0;
 
   {
-    std::vector<cv::Point2f> points;
-    for (unsigned int i = 0; i < current_cluster->points.size(); i++)
+    std::vector<cv::Point2f> points(origin_indices_.size());
+    for (unsigned int i = 0; i < origin_indices_.size(); i++)
     {
-      cv::Point2f pt;
-      pt.x = current_cluster->points[i].x;
-      pt.y = current_cluster->points[i].y;
-      points.push_back(pt);
+      points[i].x = origin_cloud_ptr_->points[origin_indices_[i]].x;
+      points[i].y = origin_cloud_ptr_->points[origin_indices_[i]].y;
     }
 
     std::vector<cv::Point2f> hull;
     cv::convexHull(points, hull);
 
-    polygon_.header = in_ros_header;
+    polygon_ = geometry_msgs::PolygonStamped();
+    polygon_.header = ros_header_;
     for (size_t i = 0; i < hull.size() + 1; i++)
     {
       geometry_msgs::Point32 point;
@@ -244,7 +283,7 @@ void Cluster::SetCloud(const pcl::PointCloud<pcl::PointXYZ>::Ptr in_origin_cloud
       point.z = max_point_.z;
       polygon_.polygon.points.push_back(point);
     }
-    if (in_estimate_pose)
+    if (estimate_pose_)
     {
       cv::RotatedRect box = minAreaRect(hull);
       rz = box.angle * 3.14 / 180;
@@ -254,30 +293,23 @@ void Cluster::SetCloud(const pcl::PointCloud<pcl::PointXYZ>::Ptr in_origin_cloud
       bounding_box_.dimensions.y = box.size.height;
     }
   }
+  orientation_angle_ = rz;
 
   // set bounding box direction
   tf::Quaternion quat = tf::createQuaternionFromRPY(0.0, 0.0, rz);
   tf::quaternionTFToMsg(quat, bounding_box_.pose.orientation);
 
-  current_cluster->width = current_cluster->points.size();
-  current_cluster->height = 1;
-  current_cluster->is_dense = true;
-
   // Get EigenValues, eigenvectors
-  if (current_cluster->points.size() > 3)
+  eigen_vectors_.setZero();
+  eigen_values_.setZero();
+  if (origin_indices_.size() > 3)
   {
     pcl::PCA<pcl::PointXYZ> current_cluster_pca;
-    pcl::PointCloud<pcl::PointXYZ>::Ptr current_cluster_mono(new pcl::PointCloud<pcl::PointXYZ>);
-
-    pcl::copyPointCloud<pcl::PointXYZRGB, pcl::PointXYZ>(*current_cluster, *current_cluster_mono);
-
-    current_cluster_pca.setInputCloud(current_cluster_mono);
+    current_cluster_pca.setInputCloud(origin_cloud_ptr_);
+    current_cluster_pca.setIndices(boost::make_shared<std::vector<int> >(origin_indices_));
     eigen_vectors_ = current_cluster_pca.getEigenVectors();
     eigen_values_ = current_cluster_pca.getEigenValues();
   }
-
-  valid_cluster_ = true;
-  pointcloud_ = current_cluster;
 }
 
 std::vector<float> Cluster::GetFpfhDescriptor(const unsigned int& in_ompnum_threads,
@@ -285,6 +317,7 @@ std::vector<float> Cluster::GetFpfhDescriptor(const unsigned int& in_ompnum_thre
                                               const double& in_fpfh_search_radius)
 {
   std::vector<float> cluster_fpfh_histogram(33, 0.0);
+  GetCloud();
 
   pcl::search::KdTree<pcl::PointXYZRGB>::Ptr norm_tree(new pcl::search::KdTree<pcl::PointXYZRGB>);
   if (pointcloud_->points.size() > 0)
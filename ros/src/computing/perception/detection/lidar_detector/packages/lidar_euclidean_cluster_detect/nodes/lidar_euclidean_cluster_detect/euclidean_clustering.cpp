@@ -0,0 +1,236 @@
+#include "euclidean_clustering.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include <boost/make_shared.hpp>
+#include <pcl/common/io.h>
+#include <pcl/search/kdtree.h>
+#include <pcl/segmentation/extract_clusters.h>
+
+#include "grid_euclidean_clustering.h"
+
+namespace
+{
+size_t findBandClusterRoot(std::vector<size_t> &in_out_parents, size_t in_index)
+{
+  while (in_out_parents[in_index] != in_index)
+  {
+    in_out_parents[in_index] = in_out_parents[in_out_parents[in_index]];
+    in_index = in_out_parents[in_index];
+  }
+  return in_index;
+}
+
+double elapsedMilliseconds(std::chrono::steady_clock::time_point &in_out_start)
+{
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  double elapsed = std::chrono::duration<double, std::milli>(now - in_out_start).count();
+  in_out_start = now;
+  return elapsed;
+}
+}
+
+std::vector<pcl::PointIndices> extractEuclideanClusters(const pcl::PointCloud<pcl::PointXYZ>::Ptr in_cloud_ptr,
+                                                        double in_max_cluster_distance, int in_cluster_size_min,
+                                                        int in_cluster_size_max)
+{
+  pcl::search::KdTree<pcl::PointXYZ>::Ptr tree(new pcl::search::KdTree<pcl::PointXYZ>);
+
+  // create 2d pc
+  pcl::PointCloud<pcl::PointXYZ>::Ptr cloud_2d(new pcl::PointCloud<pcl::PointXYZ>);
+  pcl::copyPointCloud(*in_cloud_ptr, *cloud_2d);
+  // make it flat
+  for (size_t i = 0; i < cloud_2d->points.size(); i++)
+  {
+    cloud_2d->points[i].z = 0;
+  }
+
+  if (cloud_2d->points.size() > 0)
+    tree->setInputCloud(cloud_2d);
+
+  std::vector<pcl::PointIndices> cluster_indices;
+
+  // perform clustering on 2d cloud
+  pcl::EuclideanClusterExtraction<pcl::PointXYZ> ec;
+  ec.setClusterTolerance(in_max_cluster_distance);  //
+  ec.setMinClusterSize(in_cluster_size_min);
+  ec.setMaxClusterSize(in_cluster_size_max);
+  ec.setSearchMethod(tree);
+  ec.setInputCloud(cloud_2d);
+  ec.extract(cluster_indices);
+
+  return cluster_indices;
+}
+
+std::vector<std::vector<int> > extractGridClusters(const pcl::PointCloud<pcl::PointXYZ>::Ptr in_cloud_ptr,
+                                                   const std::vector<int> &in_indices, double in_max_cluster_distance,
+                                                   int in_cluster_size_min, int in_cluster_size_max)
+{
+  size_t size = in_indices.empty() ? in_cloud_ptr->points.size() : in_indices.size();
+  std::vector<float> tmp_x(size), tmp_y(size);
+  for (size_t i = 0; i < size; i++)
+  {
+    const pcl::PointXYZ &point = in_cloud_ptr->points[in_indices.empty() ? i : in_indices[i]];
+    tmp_x[i] = point.x;
+    tmp_y[i] = point.y;
+  }
+
+  GridEuclideanCluster grid_cluster;
+  grid_cluster.setInputPoints(tmp_x.data(), tmp_y.data(), size);
+  grid_cluster.setThreshold(in_max_cluster_distance);
+  grid_cluster.setMinClusterPts(in_cluster_size_min);
+  grid_cluster.setMaxClusterPts(in_cluster_size_max);
+  grid_cluster.extractClusters();
+  std::vector<GridEuclideanCluster::GClusterIndex> cluster_indices = grid_cluster.getOutput();
+
+  std::vector<std::vector<int> > clusters(cluster_indices.size());
+  for (size_t k = 0; k < cluster_indices.size(); k++)
+  {
+    clusters[k].swap(cluster_indices[k].points_in_cluster);
+    if (!in_indices.empty())
+    {
+      for (size_t i = 0; i < clusters[k].size(); i++)
+      {
+        clusters[k][i] = in_indices[clusters[k][i]];
+      }
+    }
+  }
+  return clusters;
+}
+
+std::vector<std::vector<int> > extractRangeBandClusters(const pcl::PointCloud<pcl::PointXYZ>::Ptr in_cloud_ptr,
+                                                        const std::vector<double> &in_ranges,
+                                                        const std::vector<double> &in_distances,
+                                                        int in_cluster_size_min, int in_cluster_size_max,
+                                                        bool in_use_grid, RangeBandClusteringTime *out_time)
+{
+  std::chrono::steady_clock::time_point stage_start = std::chrono::steady_clock::now();
+  RangeBandClusteringTime time;
+  const size_t bands_num = in_distances.size();
+  const size_t points_num = in_cloud_ptr->points.size();
+
+  // flat copy and band of every point
+  pcl::PointCloud<pcl::PointXYZ>::Ptr cloud_2d(new pcl::PointCloud<pcl::PointXYZ>);
+  cloud_2d->points.resize(points_num);
+  cloud_2d->width = points_num;
+  cloud_2d->height = 1;
+  std::vector<float> point_ranges(points_num);
+  std::vector<pcl::PointIndices> band_indices(bands_num);
+  for (size_t i = 0; i < points_num; i++)
+  {
+    const pcl::PointXYZ &point = in_cloud_ptr->points[i];
+    cloud_2d->points[i].x = point.x;
+    cloud_2d->points[i].y = point.y;
+    cloud_2d->points[i].z = 0;
+    point_ranges[i] = sqrt(point.x * point.x + point.y * point.y);
+    size_t band = std::upper_bound(in_ranges.begin(), in_ranges.end(), point_ranges[i]) - in_ranges.begin();
+    band_indices[band].indices.push_back(i);
+  }
+  time.split = elapsedMilliseconds(stage_start);
+
+  std::vector<std::vector<pcl::PointIndices> > band_clusters(bands_num);
+#pragma omp parallel for schedule(dynamic)
+  for (size_t band = 0; band < bands_num; band++)
+  {
+    if (band_indices[band].indices.empty())
+      continue;
+    if (in_use_grid)
+    {
+      std::vector<std::vector<int> > clusters = extractGridClusters(
+          in_cloud_ptr, band_indices[band].indices, in_distances[band], in_cluster_size_min, in_cluster_size_max);
+      band_clusters[band].resize(clusters.size());
+      for (size_t k = 0; k < clusters.size(); k++)
+      {
+        band_clusters[band][k].indices.swap(clusters[k]);
+      }
+      continue;
+    }
+    pcl::search::KdTree<pcl::PointXYZ>::Ptr tree(new pcl::search::KdTree<pcl::PointXYZ>);
+    pcl::EuclideanClusterExtraction<pcl::PointXYZ> ec;
+    ec.setClusterTolerance(in_distances[band]);
+    ec.setMinClusterSize(in_cluster_size_min);
+    ec.setMaxClusterSize(in_cluster_size_max);
+    ec.setSearchMethod(tree);
+    ec.setInputCloud(cloud_2d);
+    ec.setIndices(boost::make_shared<pcl::PointIndices>(band_indices[band]));
+    ec.extract(band_clusters[band]);
+  }
+  time.cluster = elapsedMilliseconds(stage_start);
+
+  // label every clustered point, clusters numbered band after band
+  std::vector<int> point_labels(points_num, -1);
+  std::vector<const std::vector<int> *> cluster_indices;
+  for (size_t band = 0; band < bands_num; band++)
+  {
+    for (size_t i = 0; i < band_clusters[band].size(); i++)
+    {
+      const std::vector<int> &indices = band_clusters[band][i].indices;
+      for (size_t j = 0; j < indices.size(); j++)
+      {
+        point_labels[indices[j]] = cluster_indices.size();
+      }
+      cluster_indices.push_back(&indices);
+    }
+  }
+
+  // join clusters across each band boundary
+  std::vector<size_t> parents(cluster_indices.size());
+  for (size_t i = 0; i < parents.size(); i++)
+  {
+    parents[i] = i;
+  }
+  for (size_t band = 0; band + 1 < bands_num; band++)
+  {
+    const double tolerance = std::min(in_distances[band], in_distances[band + 1]);
+    const double boundary = in_ranges[band];
+    boost::shared_ptr<std::vector<int> > outer_points(new std::vector<int>);
+    for (size_t i = 0; i < band_indices[band + 1].indices.size(); i++)
+    {
+      int index = band_indices[band + 1].indices[i];
+      if (point_labels[index] >= 0 && point_ranges[index] < boundary + tolerance)
+        outer_points->push_back(index);
+    }
+    if (outer_points->empty())
+      continue;
+
+    pcl::search::KdTree<pcl::PointXYZ> tree;
+    tree.setInputCloud(cloud_2d, outer_points);
+    std::vector<int> neighbors;
+    std::vector<float> distances;
+    for (size_t i = 0; i < band_indices[band].indices.size(); i++)
+    {
+      int index = band_indices[band].indices[i];
+      if (point_labels[index] < 0 || point_ranges[index] < boundary - tolerance)
+        continue;
+      tree.radiusSearch(cloud_2d->points[index], tolerance, neighbors, distances);
+      for (size_t j = 0; j < neighbors.size(); j++)
+      {
+        size_t root_a = findBandClusterRoot(parents, point_labels[index]);
+        size_t root_b = findBandClusterRoot(parents, point_labels[neighbors[j]]);
+        if (root_a != root_b)
+          parents[std::max(root_a, root_b)] = std::min(root_a, root_b);
+      }
+    }
+  }
+
+  std::vector<std::vector<int> > joined_indices;
+  std::vector<int> joined_of_root(cluster_indices.size(), -1);
+  for (size_t i = 0; i < cluster_indices.size(); i++)
+  {
+    size_t root = findBandClusterRoot(parents, i);
+    if (joined_of_root[root] < 0)
+    {
+      joined_of_root[root] = joined_indices.size();
+      joined_indices.push_back(std::vector<int>());
+    }
+    std::vector<int> &joined = joined_indices[joined_of_root[root]];
+    joined.insert(joined.end(), cluster_indices[i]->begin(), cluster_indices[i]->end());
+  }
+  time.stitch = elapsedMilliseconds(stage_start);
+
+  if (out_time != NULL)
+    *out_time = time;
+  return joined_indices;
+}
@@ -0,0 +1,217 @@
+#include "grid_euclidean_clustering.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+int64_t cellKey(int64_t cell_x, int64_t cell_y)
+{
+  return ((cell_x + 0x80000000LL) << 32) | (cell_y + 0x80000000LL);
+}
+
+// Cells within 2 in both directions may hold points closer than the threshold,
+// only half of them are visited so every pair of cells is checked once
+const int NEIGHBOR_OFFSETS[12][2] = { { 0, 1 },  { 0, 2 },  { 1, -2 }, { 1, -1 }, { 1, 0 }, { 1, 1 },
+                                      { 1, 2 },  { 2, -2 }, { 2, -1 }, { 2, 0 },  { 2, 1 }, { 2, 2 } };
+}
+
+GridEuclideanCluster::GridEuclideanCluster()
+  : x_(NULL), y_(NULL), size_(0), threshold_(0), min_cluster_pts_(0), max_cluster_pts_(0), cell_parents_size_(0)
+{
+}
+
+void GridEuclideanCluster::setInputPoints(const float* x, const float* y, int size)
+{
+  x_ = x;
+  y_ = y;
+  size_ = size;
+}
+
+void GridEuclideanCluster::setThreshold(double threshold)
+{
+  threshold_ = threshold;
+}
+
+void GridEuclideanCluster::setMinClusterPts(int min_cluster_pts)
+{
+  min_cluster_pts_ = min_cluster_pts;
+}
+
+void GridEuclideanCluster::setMaxClusterPts(int max_cluster_pts)
+{
+  max_cluster_pts_ = max_cluster_pts;
+}
+
+int GridEuclideanCluster::findCell(int cell)
+{
+  int parent = cell_parents_[cell].load(std::memory_order_relaxed);
+  while (parent != cell)
+  {
+    // path halving, losing the race only skips the shortcut
+    int grandparent = cell_parents_[parent].load(std::memory_order_relaxed);
+    if (grandparent != parent)
+    {
+      cell_parents_[cell].compare_exchange_weak(parent, grandparent, std::memory_order_relaxed);
+    }
+    cell = grandparent;
+    parent = cell_parents_[cell].load(std::memory_order_relaxed);
+  }
+  return cell;
+}
+
+void GridEuclideanCluster::joinCells(int cell_a, int cell_b)
+{
+  for (;;)
+  {
+    cell_a = findCell(cell_a);
+    cell_b = findCell(cell_b);
+    if (cell_a == cell_b)
+    {
+      return;
+    }
+    // always link the larger root under the smaller one
+    if (cell_a < cell_b)
+    {
+      std::swap(cell_a, cell_b);
+    }
+    int expected = cell_a;
+    if (cell_parents_[cell_a].compare_exchange_strong(expected, cell_b))
+    {
+      return;
+    }
+  }
+}
+
+bool GridEuclideanCluster::cellsConnected(int cell_a, int cell_b, float squared_threshold)
+{
+  for (int i = cell_start_[cell_a]; i < cell_start_[cell_a + 1]; i++)
+  {
+    const int point_a = points_[i].second;
+    for (int j = cell_start_[cell_b]; j < cell_start_[cell_b + 1]; j++)
+    {
+      const int point_b = points_[j].second;
+      const float dx = x_[point_a] - x_[point_b];
+      const float dy = y_[point_a] - y_[point_b];
+      if (dx * dx + dy * dy <= squared_threshold)
+      {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+void GridEuclideanCluster::extractClusters()
+{
+  clusters_.clear();
+  if (size_ <= 0 || threshold_ <= 0)
+  {
+    return;
+  }
+
+  // any two points of a cell of this size are within the threshold
+  const double cell_size = threshold_ / std::sqrt(2.0);
+  const float squared_threshold = static_cast<float>(threshold_ * threshold_);
+
+  points_.resize(size_);
+#pragma omp parallel for
+  for (int i = 0; i < size_; i++)
+  {
+    int64_t cell_x = static_cast<int64_t>(std::floor(x_[i] / cell_size));
+    int64_t cell_y = static_cast<int64_t>(std::floor(y_[i] / cell_size));
+    points_[i] = std::make_pair(cellKey(cell_x, cell_y), i);
+  }
+  std::sort(points_.begin(), points_.end());
+
+  cell_start_.clear();
+  cell_keys_.clear();
+  for (int i = 0; i < size_; i++)
+  {
+    if (i == 0 || points_[i].first != points_[i - 1].first)
+    {
+      cell_start_.push_back(i);
+      cell_keys_.push_back(points_[i].first);
+    }
+  }
+  const int cells_num = cell_keys_.size();
+  cell_start_.push_back(size_);
+
+  if (cell_parents_size_ < cells_num)
+  {
+    cell_parents_.reset(new std::atomic<int>[cells_num]);
+    cell_parents_size_ = cells_num;
+  }
+  for (int i = 0; i < cells_num; i++)
+  {
+    cell_parents_[i].store(i, std::memory_order_relaxed);
+  }
+
+#pragma omp parallel for schedule(dynamic, 64)
+  for (int cell = 0; cell < cells_num; cell++)
+  {
+    const int64_t cell_x = (cell_keys_[cell] >> 32) - 0x80000000LL;
+    const int64_t cell_y = (cell_keys_[cell] & 0xFFFFFFFFLL) - 0x80000000LL;
+    for (int k = 0; k < 12; k++)
+    {
+      const int64_t key = cellKey(cell_x + NEIGHBOR_OFFSETS[k][0], cell_y + NEIGHBOR_OFFSETS[k][1]);
+      std::vector<int64_t>::const_iterator found = std::lower_bound(cell_keys_.begin(), cell_keys_.end(), key);
+      if (found == cell_keys_.end() || *found != key)
+      {
+        continue;
+      }
+      const int neighbor = found - cell_keys_.begin();
+      if (findCell(cell) != findCell(neighbor) && cellsConnected(cell, neighbor, squared_threshold))
+      {
+        joinCells(cell, neighbor);
+      }
+    }
+  }
+
+  // clusters are numbered by their first point
+  std::vector<int> cluster_of_cell(cells_num, -1);
+  std::vector<int> point_cells(size_);
+  for (int cell = 0; cell < cells_num; cell++)
+  {
+    for (int i = cell_start_[cell]; i < cell_start_[cell + 1]; i++)
+    {
+      point_cells[points_[i].second] = cell;
+    }
+  }
+  for (int i = 0; i < size_; i++)
+  {
+    const int root = findCell(point_cells[i]);
+    if (cluster_of_cell[root] < 0)
+    {
+      cluster_of_cell[root] = clusters_.size();
+      clusters_.push_back(GClusterIndex());
+      clusters_.back().index_value = root;
+    }
+    clusters_[cluster_of_cell[root]].points_in_cluster.push_back(i);
+  }
+
+  std::vector<GClusterIndex>::iterator last = clusters_.begin();
+  for (std::vector<GClusterIndex>::iterator it = clusters_.begin(); it != clusters_.end(); ++it)
+  {
+    const int points_num = it->points_in_cluster.size();
+    if (points_num >= min_cluster_pts_ && points_num <= max_cluster_pts_)
+    {
+      if (last != it)
+      {
+        last->index_value = it->index_value;
+        last->points_in_cluster.swap(it->points_in_cluster);
+      }
+      ++last;
+    }
+  }
+  clusters_.erase(last, clusters_.end());
+}
+
+std::vector<GridEuclideanCluster::GClusterIndex> GridEuclideanCluster::getOutput()
+{
+  return clusters_;
+}
+
+GridEuclideanCluster::~GridEuclideanCluster()
+{
+}
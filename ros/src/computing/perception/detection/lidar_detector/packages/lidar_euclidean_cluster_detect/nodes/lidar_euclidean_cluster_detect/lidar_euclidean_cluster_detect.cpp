@@ -4,6 +4,9 @@
 #include <sstream>
 #include <limits>
 #include <cmath>
+#include <unordered_map>
+#include <algorithm>
+#include <chrono>
 
 #include <ros/ros.h>
 
@@ -77,6 +80,7 @@
 #endif
 
 #include "cluster.h"
+#include "euclidean_clustering.h"
 
 #ifdef GPU_CLUSTERING
 
@@ -99,6 +103,8 @@ ros::Publisher _pub_grid_map;
 
 ros::Publisher _pub_detected_objects;
 
+ros::Publisher _pub_clustering_time;
+
 ros::ServiceClient _vectormap_server;
 
 std_msgs::Header _velodyne_header;
@@ -139,8 +145,22 @@ static double _cluster_merge_threshold;
 static double _clustering_distance;
 
 static bool _use_gpu;
+static bool _use_grid_clustering;
 static std::chrono::system_clock::time_point _start, _end;
 
+// elapsed time of each clustering stage of the last scan [ms]
+enum ClusteringStage
+{
+  STAGE_SPLIT = 0,
+  STAGE_CLUSTER,
+  STAGE_STITCH,
+  STAGE_MERGE,
+  STAGE_FILTER,
+  STAGE_NUM
+};
+static const char *_clustering_stage_names[STAGE_NUM] = { "split", "cluster", "stitch", "merge", "filter" };
+static float _clustering_stage_time[STAGE_NUM];
+
 std::vector<std::vector<geometry_msgs::Point>> _way_area_points;
 std::vector<cv::Scalar> _colors;
 pcl::PointCloud<pcl::PointXYZ> _sensor_cloud;
@@ -416,35 +436,36 @@ std::vector<ClusterPtr> clusterAndColorGpu(const pcl::PointCloud<pcl::PointXYZ>:
 
 #endif
 
-std::vector<ClusterPtr> clusterAndColor(const pcl::PointCloud<pcl::PointXYZ>::Ptr in_cloud_ptr,
-                                        pcl::PointCloud<pcl::PointXYZRGB>::Ptr out_cloud_ptr,
-                                        autoware_msgs::Centroids &in_out_centroids,
-                                        double in_max_cluster_distance = 0.5)
+std::vector<ClusterPtr> clusterAndColorGrid(const pcl::PointCloud<pcl::PointXYZ>::Ptr in_cloud_ptr,
+                                            pcl::PointCloud<pcl::PointXYZRGB>::Ptr out_cloud_ptr,
+                                            autoware_msgs::Centroids &in_out_centroids,
+                                            double in_max_cluster_distance = 0.5)
 {
-  pcl::search::KdTree<pcl::PointXYZ>::Ptr tree(new pcl::search::KdTree<pcl::PointXYZ>);
+  std::vector<std::vector<int> > cluster_indices =
+      extractGridClusters(in_cloud_ptr, std::vector<int>(), in_max_cluster_distance, _cluster_size_min,
+                          _cluster_size_max);
 
-  // create 2d pc
-  pcl::PointCloud<pcl::PointXYZ>::Ptr cloud_2d(new pcl::PointCloud<pcl::PointXYZ>);
-  pcl::copyPointCloud(*in_cloud_ptr, *cloud_2d);
-  // make it flat
-  for (size_t i = 0; i < cloud_2d->points.size(); i++)
+  std::vector<ClusterPtr> clusters;
+  for (size_t k = 0; k < cluster_indices.size(); k++)
   {
-    cloud_2d->points[i].z = 0;
+    const cv::Scalar &color = _colors[k % _colors.size()];
+    ClusterPtr cluster(new Cluster());
+    cluster->SetCloud(in_cloud_ptr, cluster_indices[k], _velodyne_header, k, (int) color.val[0],
+                      (int) color.val[1], (int) color.val[2], "", _pose_estimation);
+    clusters.push_back(cluster);
   }
 
-  if (cloud_2d->points.size() > 0)
-    tree->setInputCloud(cloud_2d);
-
-  std::vector<pcl::PointIndices> cluster_indices;
+  return clusters;
+}
 
+std::vector<ClusterPtr> clusterAndColor(const pcl::PointCloud<pcl::PointXYZ>::Ptr in_cloud_ptr,
+                                        pcl::PointCloud<pcl::PointXYZRGB>::Ptr out_cloud_ptr,
+                                        autoware_msgs::Centroids &in_out_centroids,
+                                        double in_max_cluster_distance = 0.5)
+{
   // perform clustering on 2d cloud
-  pcl::EuclideanClusterExtraction<pcl::PointXYZ> ec;
-  ec.setClusterTolerance(in_max_cluster_distance);  //
-  ec.setMinClusterSize(_cluster_size_min);
-  ec.setMaxClusterSize(_cluster_size_max);
-  ec.setSearchMethod(tree);
-  ec.setInputCloud(cloud_2d);
-  ec.extract(cluster_indices);
+  std::vector<pcl::PointIndices> cluster_indices =
+      extractEuclideanClusters(in_cloud_ptr, in_max_cluster_distance, _cluster_size_min, _cluster_size_max);
   // use indices on 3d cloud
 
   /////////////////////////////////
@@ -470,85 +491,185 @@ std::vector<ClusterPtr> clusterAndColor(const pcl::PointCloud<pcl::PointXYZ>::Pt
   return clusters;
 }
 
-void checkClusterMerge(size_t in_cluster_id, std::vector<ClusterPtr> &in_clusters,
-                       std::vector<bool> &in_out_visited_clusters, std::vector<size_t> &out_merge_indices,
-                       double in_merge_threshold)
+size_t findMergeRoot(std::vector<size_t> &in_out_parents, size_t in_index)
 {
-  // std::cout << "checkClusterMerge" << std::endl;
-  pcl::PointXYZ point_a = in_clusters[in_cluster_id]->GetCentroid();
-  for (size_t i = 0; i < in_clusters.size(); i++)
+  while (in_out_parents[in_index] != in_index)
   {
-    if (i != in_cluster_id && !in_out_visited_clusters[i])
-    {
-      pcl::PointXYZ point_b = in_clusters[i]->GetCentroid();
-      double distance = sqrt(pow(point_b.x - point_a.x, 2) + pow(point_b.y - point_a.y, 2));
-      if (distance <= in_merge_threshold)
-      {
-        in_out_visited_clusters[i] = true;
-        out_merge_indices.push_back(i);
-        // std::cout << "Merging " << in_cluster_id << " with " << i << " dist:" << distance << std::endl;
-        checkClusterMerge(i, in_clusters, in_out_visited_clusters, out_merge_indices, in_merge_threshold);
-      }
-    }
+    in_out_parents[in_index] = in_out_parents[in_out_parents[in_index]];
+    in_index = in_out_parents[in_index];
   }
+  return in_index;
 }
 
 void mergeClusters(const std::vector<ClusterPtr> &in_clusters, std::vector<ClusterPtr> &out_clusters,
-                   std::vector<size_t> in_merge_indices, const size_t &current_index,
-                   std::vector<bool> &in_out_merged_clusters)
+                   const std::vector<size_t> &in_merge_indices, const size_t &current_index)
 {
   // std::cout << "mergeClusters:" << in_merge_indices.size() << std::endl;
-  pcl::PointCloud<pcl::PointXYZRGB> sum_cloud;
-  pcl::PointCloud<pcl::PointXYZ> mono_cloud;
-  ClusterPtr merged_cluster(new Cluster());
+  pcl::PointCloud<pcl::PointXYZ>::Ptr origin_cloud = in_clusters[in_merge_indices[0]]->GetOriginCloud();
+  bool same_origin = true;
+  size_t points_num = 0;
   for (size_t i = 0; i < in_merge_indices.size(); i++)
   {
-    sum_cloud += *(in_clusters[in_merge_indices[i]]->GetCloud());
-    in_out_merged_clusters[in_merge_indices[i]] = true;
+    const ClusterPtr &cluster = in_clusters[in_merge_indices[i]];
+    points_num += cluster->GetOriginIndices().size();
+    same_origin = same_origin && (cluster->GetOriginCloud() == origin_cloud);
   }
-  std::vector<int> indices(sum_cloud.points.size(), 0);
-  for (size_t i = 0; i < sum_cloud.points.size(); i++)
+  if (points_num == 0)
   {
-    indices[i] = i;
+    return;
   }
 
-  if (sum_cloud.points.size() > 0)
+  // clusters of the same cloud are merged by joining their index lists,
+  // otherwise (multiple thresholds) their points are gathered once
+  std::vector<int> indices;
+  indices.reserve(points_num);
+  pcl::PointCloud<pcl::PointXYZ>::Ptr merged_cloud = origin_cloud;
+  if (!same_origin)
+  {
+    merged_cloud.reset(new pcl::PointCloud<pcl::PointXYZ>);
+    merged_cloud->points.reserve(points_num);
+  }
+  for (size_t i = 0; i < in_merge_indices.size(); i++)
   {
-    pcl::copyPointCloud(sum_cloud, mono_cloud);
-    merged_cluster->SetCloud(mono_cloud.makeShared(), indices, _velodyne_header, current_index,
-                             (int) _colors[current_index].val[0], (int) _colors[current_index].val[1],
-                             (int) _colors[current_index].val[2], "", _pose_estimation);
-    out_clusters.push_back(merged_cluster);
+    const ClusterPtr &cluster = in_clusters[in_merge_indices[i]];
+    const std::vector<int> &cluster_indices = cluster->GetOriginIndices();
+    if (same_origin)
+    {
+      indices.insert(indices.end(), cluster_indices.begin(), cluster_indices.end());
+      continue;
+    }
+    for (size_t j = 0; j < cluster_indices.size(); j++)
+    {
+      indices.push_back(merged_cloud->points.size());
+      merged_cloud->points.push_back(cluster->GetOriginCloud()->points[cluster_indices[j]]);
+    }
   }
+
+  ClusterPtr merged_cluster(new Cluster());
+  merged_cluster->SetCloud(merged_cloud, indices, _velodyne_header, current_index,
+                           (int) _colors[current_index].val[0], (int) _colors[current_index].val[1],
+                           (int) _colors[current_index].val[2], "", _pose_estimation);
+  out_clusters.push_back(merged_cluster);
 }
 
 void checkAllForMerge(std::vector<ClusterPtr> &in_clusters, std::vector<ClusterPtr> &out_clusters,
                       float in_merge_threshold)
 {
   // std::cout << "checkAllForMerge" << std::endl;
-  std::vector<bool> visited_clusters(in_clusters.size(), false);
-  std::vector<bool> merged_clusters(in_clusters.size(), false);
+  // clusters whose centroids are closer than the threshold, directly or
+  // through other clusters, end up in the same set. A hash grid with the
+  // threshold as cell size limits the comparisons to the 3x3 neighbouring cells.
+  const size_t clusters_num = in_clusters.size();
+  const double cell_size = (in_merge_threshold > 0) ? in_merge_threshold : 1.0;
+
+  std::vector<pcl::PointXYZ> centroids(clusters_num);
+  std::vector<std::pair<int, int> > cells(clusters_num);
+  std::unordered_map<int64_t, std::vector<size_t> > grid;
+  for (size_t i = 0; i < clusters_num; i++)
+  {
+    centroids[i] = in_clusters[i]->GetCentroid();
+    cells[i].first = static_cast<int>(std::floor(centroids[i].x / cell_size));
+    cells[i].second = static_cast<int>(std::floor(centroids[i].y / cell_size));
+    grid[(static_cast<int64_t>(cells[i].first) << 32) | static_cast<uint32_t>(cells[i].second)].push_back(i);
+  }
+
+  std::vector<size_t> parents(clusters_num);
+  for (size_t i = 0; i < clusters_num; i++)
+  {
+    parents[i] = i;
+  }
+  for (size_t i = 0; i < clusters_num; i++)
+  {
+    for (int dx = -1; dx <= 1; dx++)
+    {
+      for (int dy = -1; dy <= 1; dy++)
+      {
+        int64_t key = (static_cast<int64_t>(cells[i].first + dx) << 32) |
+                      static_cast<uint32_t>(cells[i].second + dy);
+        auto cell = grid.find(key);
+        if (cell == grid.end())
+          continue;
+        for (size_t k = 0; k < cell->second.size(); k++)
+        {
+          size_t j = cell->second[k];
+          if (j <= i)
+            continue;
+          double distance = sqrt(pow(centroids[j].x - centroids[i].x, 2) + pow(centroids[j].y - centroids[i].y, 2));
+          if (distance <= in_merge_threshold)
+          {
+            size_t root_i = findMergeRoot(parents, i);
+            size_t root_j = findMergeRoot(parents, j);
+            if (root_i != root_j)
+              parents[std::max(root_i, root_j)] = std::min(root_i, root_j);
+          }
+        }
+      }
+    }
+  }
+
+  // sets are listed by their first cluster, members in input order
+  std::vector<std::vector<size_t> > merge_sets;
+  std::vector<int> set_of_root(clusters_num, -1);
+  for (size_t i = 0; i < clusters_num; i++)
+  {
+    size_t root = findMergeRoot(parents, i);
+    if (set_of_root[root] < 0)
+    {
+      set_of_root[root] = merge_sets.size();
+      merge_sets.push_back(std::vector<size_t>());
+    }
+    merge_sets[set_of_root[root]].push_back(i);
+  }
+
   size_t current_index = 0;
-  for (size_t i = 0; i < in_clusters.size(); i++)
+  for (size_t i = 0; i < merge_sets.size(); i++)
   {
-    if (!visited_clusters[i])
+    if (merge_sets[i].size() > 1)
     {
-      visited_clusters[i] = true;
-      std::vector<size_t> merge_indices;
-      checkClusterMerge(i, in_clusters, visited_clusters, merge_indices, in_merge_threshold);
-      mergeClusters(in_clusters, out_clusters, merge_indices, current_index++, merged_clusters);
+      mergeClusters(in_clusters, out_clusters, merge_sets[i], current_index++);
     }
   }
-  for (size_t i = 0; i < in_clusters.size(); i++)
+  for (size_t i = 0; i < merge_sets.size(); i++)
   {
-    // check for clusters not merged, add them to the output
-    if (!merged_clusters[i])
+    // clusters not merged go to the output as they are
+    if (merge_sets[i].size() == 1)
     {
-      out_clusters.push_back(in_clusters[i]);
+      out_clusters.push_back(in_clusters[merge_sets[i][0]]);
     }
   }
+}
 
-  // ClusterPtr cluster(new Cluster());
+double elapsedMilliseconds(std::chrono::steady_clock::time_point &in_out_start)
+{
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  double elapsed = std::chrono::duration<double, std::milli>(now - in_out_start).count();
+  in_out_start = now;
+  return elapsed;
+}
+
+/* Clusters the cloud with a tolerance that depends on the distance to the sensor,
+ * see extractRangeBandClusters. All clusters index into in_cloud_ptr. */
+std::vector<ClusterPtr> clusterByRangeBands(const pcl::PointCloud<pcl::PointXYZ>::Ptr in_cloud_ptr)
+{
+  RangeBandClusteringTime time;
+  std::vector<std::vector<int> > joined_indices =
+      extractRangeBandClusters(in_cloud_ptr, _clustering_ranges, _clustering_distances, _cluster_size_min,
+                               _cluster_size_max, _use_grid_clustering, &time);
+  _clustering_stage_time[STAGE_SPLIT] = time.split;
+  _clustering_stage_time[STAGE_CLUSTER] = time.cluster;
+
+  std::chrono::steady_clock::time_point stage_start = std::chrono::steady_clock::now();
+  std::vector<ClusterPtr> clusters(joined_indices.size());
+  for (size_t k = 0; k < joined_indices.size(); k++)
+  {
+    const cv::Scalar &color = _colors[k % _colors.size()];
+    clusters[k].reset(new Cluster());
+    clusters[k]->SetCloud(in_cloud_ptr, joined_indices[k], _velodyne_header, k, (int) color.val[0],
+                          (int) color.val[1], (int) color.val[2], "", _pose_estimation);
+  }
+  _clustering_stage_time[STAGE_STITCH] = time.stitch + elapsedMilliseconds(stage_start);
+
+  return clusters;
 }
 
 void segmentByDistance(const pcl::PointCloud<pcl::PointXYZ>::Ptr in_cloud_ptr,
@@ -566,6 +687,8 @@ void segmentByDistance(const pcl::PointCloud<pcl::PointXYZ>::Ptr in_cloud_ptr,
   // 4 => >60   d=2.6
 
   std::vector<ClusterPtr> all_clusters;
+  std::fill(_clustering_stage_time, _clustering_stage_time + STAGE_NUM, 0.0f);
+  std::chrono::steady_clock::time_point stage_start = std::chrono::steady_clock::now();
 
   if (!_use_multiple_thres)
   {
@@ -586,86 +709,61 @@ void segmentByDistance(const pcl::PointCloud<pcl::PointXYZ>::Ptr in_cloud_ptr,
       all_clusters = clusterAndColorGpu(cloud_ptr, out_cloud_ptr, in_out_centroids,
                                         _clustering_distance);
     } else
+#endif
+    if (_use_grid_clustering)
+    {
+      all_clusters =
+        clusterAndColorGrid(cloud_ptr, out_cloud_ptr, in_out_centroids, _clustering_distance);
+    } else
     {
       all_clusters =
         clusterAndColor(cloud_ptr, out_cloud_ptr, in_out_centroids, _clustering_distance);
     }
-#else
-    all_clusters =
-        clusterAndColor(cloud_ptr, out_cloud_ptr, in_out_centroids, _clustering_distance);
-#endif
+    _clustering_stage_time[STAGE_CLUSTER] = elapsedMilliseconds(stage_start);
   } else
   {
-    std::vector<pcl::PointCloud<pcl::PointXYZ>::Ptr> cloud_segments_array(5);
-    for (unsigned int i = 0; i < cloud_segments_array.size(); i++)
-    {
-      pcl::PointCloud<pcl::PointXYZ>::Ptr tmp_cloud(new pcl::PointCloud<pcl::PointXYZ>);
-      cloud_segments_array[i] = tmp_cloud;
-    }
-
-    for (unsigned int i = 0; i < in_cloud_ptr->points.size(); i++)
+#ifdef GPU_CLUSTERING
+    if (_use_gpu)
     {
-      pcl::PointXYZ current_point;
-      current_point.x = in_cloud_ptr->points[i].x;
-      current_point.y = in_cloud_ptr->points[i].y;
-      current_point.z = in_cloud_ptr->points[i].z;
-
-      float origin_distance = sqrt(pow(current_point.x, 2) + pow(current_point.y, 2));
-
-      if (origin_distance < _clustering_ranges[0])
-      {
-        cloud_segments_array[0]->points.push_back(current_point);
-      } else if (origin_distance < _clustering_ranges[1])
-      {
-        cloud_segments_array[1]->points.push_back(current_point);
-      } else if (origin_distance < _clustering_ranges[2])
-      {
-        cloud_segments_array[2]->points.push_back(current_point);
-      } else if (origin_distance < _clustering_ranges[3])
+      // the GPU clustering needs each band as a cloud of its own
+      std::vector<pcl::PointCloud<pcl::PointXYZ>::Ptr> cloud_segments_array(_clustering_distances.size());
+      for (unsigned int i = 0; i < cloud_segments_array.size(); i++)
       {
-        cloud_segments_array[3]->points.push_back(current_point);
-      } else
+        cloud_segments_array[i].reset(new pcl::PointCloud<pcl::PointXYZ>);
+      }
+      for (unsigned int i = 0; i < in_cloud_ptr->points.size(); i++)
       {
-        cloud_segments_array[4]->points.push_back(current_point);
+        const pcl::PointXYZ &current_point = in_cloud_ptr->points[i];
+        float origin_distance = sqrt(pow(current_point.x, 2) + pow(current_point.y, 2));
+        size_t band = std::upper_bound(_clustering_ranges.begin(), _clustering_ranges.end(), origin_distance) -
+                      _clustering_ranges.begin();
+        cloud_segments_array[band]->points.push_back(current_point);
       }
-    }
+      _clustering_stage_time[STAGE_SPLIT] = elapsedMilliseconds(stage_start);
 
-    std::vector<ClusterPtr> local_clusters;
-    for (unsigned int i = 0; i < cloud_segments_array.size(); i++)
-    {
-#ifdef GPU_CLUSTERING
-      if (_use_gpu)
-      {
-        local_clusters = clusterAndColorGpu(cloud_segments_array[i], out_cloud_ptr,
-                                            in_out_centroids, _clustering_distances[i]);
-      } else
+      for (unsigned int i = 0; i < cloud_segments_array.size(); i++)
       {
-        local_clusters = clusterAndColor(cloud_segments_array[i], out_cloud_ptr,
-                                         in_out_centroids, _clustering_distances[i]);
+        std::vector<ClusterPtr> local_clusters = clusterAndColorGpu(cloud_segments_array[i], out_cloud_ptr,
+                                                                    in_out_centroids, _clustering_distances[i]);
+        all_clusters.insert(all_clusters.end(), local_clusters.begin(), local_clusters.end());
       }
-#else
-      local_clusters = clusterAndColor(
-          cloud_segments_array[i], out_cloud_ptr, in_out_centroids, _clustering_distances[i]);
+      _clustering_stage_time[STAGE_CLUSTER] = elapsedMilliseconds(stage_start);
+    } else
 #endif
-      all_clusters.insert(all_clusters.end(), local_clusters.begin(), local_clusters.end());
+    {
+      all_clusters = clusterByRangeBands(in_cloud_ptr);
+      stage_start = std::chrono::steady_clock::now();
     }
   }
 
   // Clusters can be merged or checked in here
   //....
   // check for mergable clusters
-  std::vector<ClusterPtr> mid_clusters;
   std::vector<ClusterPtr> final_clusters;
 
   if (all_clusters.size() > 0)
-    checkAllForMerge(all_clusters, mid_clusters, _cluster_merge_threshold);
-  else
-    mid_clusters = all_clusters;
-
-  if (mid_clusters.size() > 0)
-    checkAllForMerge(mid_clusters, final_clusters, _cluster_merge_threshold);
-  else
-    final_clusters = mid_clusters;
+    checkAllForMerge(all_clusters, final_clusters, _cluster_merge_threshold);
+  _clustering_stage_time[STAGE_MERGE] = elapsedMilliseconds(stage_start);
 
   tf::StampedTransform vectormap_transform;
   if (_use_vector_map)
@@ -708,10 +806,20 @@ void segmentByDistance(const pcl::PointCloud<pcl::PointXYZ>::Ptr in_cloud_ptr,
       ROS_INFO("%s layer not contained in the OccupancyGrid", _gridmap_layer.c_str());
     }
   }
+  // compute the features of the surviving clusters in one parallel batch,
+  // clusters merged or discarded before this point never computed them
+#pragma omp parallel for schedule(dynamic)
+  for (int i = 0; i < static_cast<int>(final_clusters.size()); i++)
+  {
+    final_clusters[i]->GetCloud();
+    if (final_clusters[i]->IsValid())
+      final_clusters[i]->ComputeFeatures();
+  }
+
   // Get final PointCloud to be published
   for (unsigned int i = 0; i < final_clusters.size(); i++)
   {
-    *out_cloud_ptr = *out_cloud_ptr + *(final_clusters[i]->GetCloud());
+    *out_cloud_ptr += *(final_clusters[i]->GetCloud());
     pcl::PointXYZ center_point = final_clusters[i]->GetCentroid();
     geometry_msgs::Point centroid;
     centroid.x = center_point.x;
@@ -728,6 +836,21 @@ void segmentByDistance(const pcl::PointCloud<pcl::PointXYZ>::Ptr in_cloud_ptr,
       in_out_clusters.clusters.push_back(cloud_cluster);
     }
   }
+  _clustering_stage_time[STAGE_FILTER] = elapsedMilliseconds(stage_start);
+}
+
+void publishClusteringTime(const ros::Publisher *in_publisher)
+{
+  std_msgs::Float32MultiArray time_msg;
+  time_msg.layout.dim.resize(1);
+  time_msg.layout.dim[0].size = STAGE_NUM;
+  time_msg.layout.dim[0].stride = STAGE_NUM;
+  for (int i = 0; i < STAGE_NUM; i++)
+  {
+    time_msg.layout.dim[0].label += (i == 0 ? "" : ",") + std::string(_clustering_stage_names[i]);
+    time_msg.data.push_back(_clustering_stage_time[i]);
+  }
+  in_publisher->publish(time_msg);
 }
 
 void removeFloor(const pcl::PointCloud<pcl::PointXYZ>::Ptr in_cloud_ptr,
@@ -938,6 +1061,8 @@ void velodyne_callback(const sensor_msgs::PointCloud2ConstPtr &in_sensor_cloud)
 
     publishCloudClusters(&_pub_clusters_message, cloud_clusters, _output_frame, _velodyne_header);
 
+    publishClusteringTime(&_pub_clustering_time);
+
     _using_sensor_cloud = false;
   }
 }
@@ -979,6 +1104,8 @@ int main(int argc, char **argv)
 
   _pub_grid_map = h.advertise<grid_map_msgs::GridMap>("grid_map_wayarea", 1, true);
 
+  _pub_clustering_time = h.advertise<std_msgs::Float32MultiArray>("/detection/lidar_detector/clustering_time", 1);
+
   std::string points_topic, gridmap_topic;
 
   _using_sensor_cloud = false;
@@ -1046,6 +1173,9 @@ int main(int argc, char **argv)
   private_nh.param("use_gpu", _use_gpu, false);
   ROS_INFO("use_gpu: %d", _use_gpu);
 
+  private_nh.param("use_grid_clustering", _use_grid_clustering, false);
+  ROS_INFO("use_grid_clustering: %d", _use_grid_clustering);
+
   private_nh.param("use_multiple_thres", _use_multiple_thres, false);
   ROS_INFO("use_multiple_thres: %d", _use_multiple_thres);
 
@@ -0,0 +1,181 @@
+/*
+ * Copyright 2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * points_preprocessor_benchmark.h
+ *
+ * Runs the ground filters, the space filter, the voxel grid filter and the euclidean clustering on the same labelled
+ * clouds, and reports their latency, memory high-water mark and agreement with the labels.
+ * The results can be saved as a baseline, and later runs fail when they regress beyond a tolerance or when their
+ * latency exceeds the ceilings of the baseline.
+ */
+#ifndef POINTS_PREPROCESSOR_BENCHMARK_H_
+#define POINTS_PREPROCESSOR_BENCHMARK_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <pcl/point_types.h>
+#include <velodyne_pointcloud/point_types.h>
+
+#include "ray_ground_filter.h"
+#include "ring_ground_filter.h"
+#include "space_filter.h"
+
+/*!
+ * A cloud of the corpus, label 0 is ground and label k > 0 is the k-th object of the scene
+ */
+struct LabelledCloud
+{
+  std::string name;
+  pcl::PointCloud<velodyne_pointcloud::PointXYZIR>::Ptr cloud;
+  std::vector<int> labels;
+  bool has_labels;
+};
+
+/*!
+ * Box standing on the ground, in the sensor frame
+ */
+struct SceneBox
+{
+  double x, y;
+  double length, width, height;
+  double yaw;
+};
+
+struct Scene
+{
+  int sensor_model = 64;
+  double sensor_height = 1.8;
+  double ground_slope = 0.;  // degrees, the ground rises along x
+  double range_noise = 0.01; // meters, standard deviation
+  double max_range = 100.;
+  std::vector<SceneBox> boxes;
+};
+
+struct StageResult
+{
+  std::vector<double> latencies_ms;
+  double peak_rss_mb = 0;
+  std::map<std::string, double> accuracy;  // metric name -> value, averaged over the clouds
+  std::map<std::string, int> accuracy_samples;
+};
+
+/*!
+ * Packet captures of a Velodyne, unpacked one revolution after the other
+ */
+struct PcapSource
+{
+  std::string calibration_file;  // calibration of velodyne_pointcloud
+  int packets_per_scan = 348;    // HDL-64E S2.1 at 10 Hz
+  size_t max_scans = 10;
+};
+
+bool ReadScene(const std::string& in_path, Scene& out_scene);
+
+/*!
+ * Casts the beams of an HDL-64 on the ground plane and the boxes of the scene
+ * @param in_scene Scene to scan, the sensor is at the origin
+ * @param in_horizontal_res Number of firings per revolution
+ * @param in_seed Seed of the range noise
+ * @param out_cloud Scanned cloud
+ */
+void ScanScene(const Scene& in_scene, int in_horizontal_res, unsigned int in_seed, LabelledCloud& out_cloud);
+
+/*!
+ * Loads a recorded cloud, with the ground and object labels in an optional "label" field
+ */
+bool LoadPcd(const std::string& in_path, LabelledCloud& out_cloud);
+
+/*!
+ * Loads the recorded revolutions of a packet capture, the clouds have no labels
+ * @param in_path PCAP file of the data packets of the sensor
+ * @param in_source Calibration and number of packets of a revolution
+ * @param out_clouds One cloud per revolution, at most in_source.max_scans
+ */
+bool LoadPcap(const std::string& in_path, const PcapSource& in_source, std::vector<LabelledCloud>& out_clouds);
+
+/*!
+ * Lists the files of the corpus given in corpus.txt
+ */
+std::vector<std::string> ReadCorpus(const std::string& in_dir);
+
+/*!
+ * Loads a scene (.scene), a packet capture (.pcap) or a recorded cloud (.pcd)
+ * @param in_seed Seed of the range noise of the scenes
+ * @return false if the file cannot be read
+ */
+bool LoadClouds(const std::string& in_path, unsigned int in_seed, int in_horizontal_res,
+                const PcapSource& in_pcap_source, std::vector<LabelledCloud>& out_clouds);
+
+class PointsPreprocessorBenchmark
+{
+public:
+  PointsPreprocessorBenchmark(int in_iterations);
+
+  int GetRingHorizontalRes() const
+  {
+    return ring_filter_.horizontal_res_;
+  }
+
+  void Run(const LabelledCloud& in_cloud, std::map<std::string, StageResult>& io_results);
+
+private:
+  int iterations_;
+  RayGroundFilter ray_filter_;
+  GroundFilter ring_filter_;
+  SpaceFilter space_filter_;
+
+  template <typename Function>
+  void Measure(StageResult& io_result, Function in_function);
+
+  void RunRayGroundFilter(const LabelledCloud& in_cloud, StageResult& io_result);
+  void RunRingGroundFilter(const LabelledCloud& in_cloud, StageResult& io_result);
+  void RunSpaceFilter(const LabelledCloud& in_cloud, StageResult& io_result);
+  void RunVoxelGridFilter(const LabelledCloud& in_cloud, StageResult& io_result);
+
+  enum ClusteringMethod
+  {
+    CLUSTERING_KDTREE,
+    CLUSTERING_GRID,
+    CLUSTERING_RANGE_BANDS
+  };
+  void RunEuclideanCluster(const LabelledCloud& in_cloud, ClusteringMethod in_method, StageResult& io_result);
+};
+
+/*!
+ * Flattens the results as "stage metric value" entries, the format of the baseline files
+ */
+std::map<std::string, double> Summarize(const std::map<std::string, StageResult>& in_results);
+
+/*!
+ * Entry of the summary compared with the metric of a baseline entry, latency_p99_ceiling_ms is compared with the
+ * p99 latency
+ */
+std::string GetComparedKey(const std::string& in_stage, const std::string& in_metric);
+
+/*!
+ * Compares the results with the entries of a baseline file, only the metrics listed in the file are compared.
+ * The p50 and p90 latency are compared with a tolerance, the p99 latency with latency_p99_ceiling_ms without one.
+ * @param in_latency_tolerance Allowed relative increase of the p50 and p90 latency
+ * @param in_accuracy_tolerance Allowed decrease of the precision, recall and F1
+ * @param out_regressions Description of each regression
+ * @return false if the baseline cannot be read
+ */
+bool CompareWithBaseline(const std::map<std::string, double>& in_summary, const std::string& in_baseline_path,
+                         double in_latency_tolerance, double in_accuracy_tolerance,
+                         std::vector<std::string>& out_regressions);
+
+#endif  // POINTS_PREPROCESSOR_BENCHMARK_H_
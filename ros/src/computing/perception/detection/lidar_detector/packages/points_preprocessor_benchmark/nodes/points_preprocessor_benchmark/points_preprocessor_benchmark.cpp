@@ -0,0 +1,692 @@
+/*
+ * Copyright 2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * points_preprocessor_benchmark.cpp
+ */
+
+#include "points_preprocessor_benchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+#include <ros/ros.h>
+#include <pcl/common/io.h>
+#include <pcl/io/pcd_io.h>
+#include <velodyne_pointcloud/rawdata.h>
+
+#include "voxel_grid_filter.h"
+#include "euclidean_clustering.h"
+
+/*!
+ * Elevation in degrees of each ring of the HDL-64, ring 63 being the highest one.
+ * These are the angles assumed by the radius table of ring_ground_filter.
+ */
+static double Hdl64Elevation(int in_ring)
+{
+  int row = 63 - in_ring;
+  double depression = (row <= 31) ? (row / 3.0 - 2.0) : (8.83 + 0.5 * (row - 32));
+  return -depression;
+}
+
+bool ReadScene(const std::string& in_path, Scene& out_scene)
+{
+  std::ifstream file(in_path.c_str());
+  if (!file)
+  {
+    return false;
+  }
+  std::string line;
+  while (std::getline(file, line))
+  {
+    line = line.substr(0, line.find('#'));
+    std::istringstream fields(line);
+    std::string key;
+    if (!(fields >> key))
+    {
+      continue;
+    }
+    if (key == "sensor_height")
+      fields >> out_scene.sensor_height;
+    else if (key == "ground_slope")
+      fields >> out_scene.ground_slope;
+    else if (key == "range_noise")
+      fields >> out_scene.range_noise;
+    else if (key == "max_range")
+      fields >> out_scene.max_range;
+    else if (key == "box")
+    {
+      SceneBox box;
+      fields >> box.x >> box.y >> box.length >> box.width >> box.height >> box.yaw;
+      box.yaw *= M_PI / 180.;
+      out_scene.boxes.push_back(box);
+    }
+    else
+    {
+      ROS_WARN("%s: unknown key %s", in_path.c_str(), key.c_str());
+    }
+    if (fields.fail())
+    {
+      ROS_ERROR("%s: malformed line: %s", in_path.c_str(), line.c_str());
+      return false;
+    }
+  }
+  return true;
+}
+
+void ScanScene(const Scene& in_scene, int in_horizontal_res, unsigned int in_seed, LabelledCloud& out_cloud)
+{
+  std::mt19937 generator(in_seed);
+  std::normal_distribution<double> noise(0., in_scene.range_noise);
+  const double slope = std::tan(in_scene.ground_slope * M_PI / 180.);
+
+  out_cloud.cloud.reset(new pcl::PointCloud<velodyne_pointcloud::PointXYZIR>);
+  out_cloud.labels.clear();
+  out_cloud.has_labels = true;
+
+  for (int column = 0; column < in_horizontal_res; column++)
+  {
+    double azimuth = 2. * M_PI * column / in_horizontal_res;
+    for (int ring = 0; ring < in_scene.sensor_model; ring++)
+    {
+      double elevation = Hdl64Elevation(ring) * M_PI / 180.;
+      double dx = std::cos(elevation) * std::cos(azimuth);
+      double dy = std::cos(elevation) * std::sin(azimuth);
+      double dz = std::sin(elevation);
+
+      // ground plane z = -sensor_height + slope * x
+      double range = in_scene.max_range;
+      int label = -1;
+      double denominator = dz - slope * dx;
+      if (denominator < 0)
+      {
+        double t = -in_scene.sensor_height / denominator;
+        if (t < range)
+        {
+          range = t;
+          label = 0;
+        }
+      }
+
+      // slab test in the frame of each box
+      for (size_t b = 0; b < in_scene.boxes.size(); b++)
+      {
+        const SceneBox& box = in_scene.boxes[b];
+        double c = std::cos(box.yaw), s = std::sin(box.yaw);
+        double ox = c * (-box.x) + s * (-box.y);
+        double oy = -s * (-box.x) + c * (-box.y);
+        double oz = in_scene.sensor_height - slope * box.x;  // origin above the base of the box
+        double origin[3] = { ox, oy, oz };
+        double direction[3] = { c * dx + s * dy, -s * dx + c * dy, dz };
+        double low[3] = { -box.length / 2, -box.width / 2, 0. };
+        double high[3] = { box.length / 2, box.width / 2, box.height };
+        double t_near = 0, t_far = range;
+        bool hit = true;
+        for (int axis = 0; axis < 3 && hit; axis++)
+        {
+          if (std::fabs(direction[axis]) < 1e-12)
+          {
+            hit = origin[axis] >= low[axis] && origin[axis] <= high[axis];
+            continue;
+          }
+          double t0 = (low[axis] - origin[axis]) / direction[axis];
+          double t1 = (high[axis] - origin[axis]) / direction[axis];
+          if (t0 > t1)
+            std::swap(t0, t1);
+          t_near = std::max(t_near, t0);
+          t_far = std::min(t_far, t1);
+          hit = t_near <= t_far;
+        }
+        if (hit && t_near > 0 && t_near < range)
+        {
+          range = t_near;
+          label = b + 1;
+        }
+      }
+      if (label < 0)
+      {
+        continue;
+      }
+
+      range += noise(generator);
+      velodyne_pointcloud::PointXYZIR point;
+      point.x = range * dx;
+      point.y = range * dy;
+      point.z = range * dz;
+      point.intensity = label == 0 ? 10.f : 60.f;
+      point.ring = ring;
+      out_cloud.cloud->points.push_back(point);
+      out_cloud.labels.push_back(label);
+    }
+  }
+  out_cloud.cloud->width = out_cloud.cloud->points.size();
+  out_cloud.cloud->height = 1;
+  out_cloud.cloud->is_dense = true;
+}
+
+bool LoadPcd(const std::string& in_path, LabelledCloud& out_cloud)
+{
+  pcl::PCLPointCloud2 blob;
+  if (pcl::io::loadPCDFile(in_path, blob) != 0)
+  {
+    return false;
+  }
+  out_cloud.name = in_path.substr(in_path.find_last_of('/') + 1);
+  out_cloud.cloud.reset(new pcl::PointCloud<velodyne_pointcloud::PointXYZIR>);
+  pcl::fromPCLPointCloud2(blob, *out_cloud.cloud);
+
+  out_cloud.has_labels = false;
+  out_cloud.labels.assign(out_cloud.cloud->points.size(), -1);
+  for (size_t i = 0; i < blob.fields.size(); i++)
+  {
+    if (blob.fields[i].name == "label")
+    {
+      pcl::PointCloud<pcl::PointXYZL> labelled;
+      pcl::fromPCLPointCloud2(blob, labelled);
+      for (size_t j = 0; j < labelled.points.size(); j++)
+      {
+        out_cloud.labels[j] = labelled.points[j].label;
+      }
+      out_cloud.has_labels = true;
+    }
+  }
+  return true;
+}
+
+// size of the Ethernet, IPv4 and UDP headers preceding the payload of a packet
+static const size_t UDP_HEADERS_SIZE = 42;
+
+bool LoadPcap(const std::string& in_path, const PcapSource& in_source, std::vector<LabelledCloud>& out_clouds)
+{
+  std::ifstream file(in_path.c_str(), std::ios::binary);
+  if (!file)
+  {
+    return false;
+  }
+  velodyne_rawdata::RawData raw_data;
+  if (raw_data.setupOffline(in_source.calibration_file, 130.0, 0.9) != 0)
+  {
+    ROS_ERROR("Cannot read calibration %s", in_source.calibration_file.c_str());
+    return false;
+  }
+  raw_data.setParameters(0.9, 130.0, 0.0, 2 * M_PI);
+
+  char global_header[24];
+  file.read(global_header, sizeof(global_header));
+
+  // position packets and other traffic have a different size and are skipped
+  std::string name = in_path.substr(in_path.find_last_of('/') + 1);
+  uint32_t record_header[4];  // ts_sec, ts_usec, incl_len, orig_len
+  std::vector<char> record;
+  velodyne_msgs::VelodynePacket packet;
+  LabelledCloud scan;
+  int packets_num = 0;
+  size_t scans_num = 0;
+  while (scans_num < in_source.max_scans && file.read((char*)record_header, sizeof(record_header)))
+  {
+    record.resize(record_header[2]);
+    if (!file.read(record.data(), record.size()))
+      break;
+    if (record.size() != UDP_HEADERS_SIZE + velodyne_rawdata::PACKET_SIZE)
+      continue;
+    std::copy(record.begin() + UDP_HEADERS_SIZE, record.end(), packet.data.begin());
+
+    if (packets_num == 0)
+      scan.cloud.reset(new pcl::PointCloud<velodyne_pointcloud::PointXYZIR>);
+    raw_data.unpack(packet, *scan.cloud, in_source.packets_per_scan);
+    if (++packets_num < in_source.packets_per_scan)
+      continue;
+
+    scan.name = name + ":" + std::to_string(scans_num++);
+    scan.cloud->width = scan.cloud->points.size();
+    scan.cloud->height = 1;
+    scan.labels.assign(scan.cloud->points.size(), -1);
+    scan.has_labels = false;
+    out_clouds.push_back(scan);
+    packets_num = 0;
+  }
+  return scans_num > 0;
+}
+
+std::vector<std::string> ReadCorpus(const std::string& in_dir)
+{
+  std::vector<std::string> files;
+  std::ifstream index((in_dir + "/corpus.txt").c_str());
+  std::string name;
+  while (index >> name)
+  {
+    files.push_back(in_dir + "/" + name);
+  }
+  return files;
+}
+
+static bool HasExtension(const std::string& in_path, const std::string& in_extension)
+{
+  return in_path.size() > in_extension.size() &&
+         in_path.compare(in_path.size() - in_extension.size(), in_extension.size(), in_extension) == 0;
+}
+
+bool LoadClouds(const std::string& in_path, unsigned int in_seed, int in_horizontal_res,
+                const PcapSource& in_pcap_source, std::vector<LabelledCloud>& out_clouds)
+{
+  if (HasExtension(in_path, ".pcap"))
+  {
+    return LoadPcap(in_path, in_pcap_source, out_clouds);
+  }
+  LabelledCloud cloud;
+  if (HasExtension(in_path, ".scene"))
+  {
+    Scene scene;
+    if (!ReadScene(in_path, scene))
+    {
+      return false;
+    }
+    cloud.name = in_path.substr(in_path.find_last_of('/') + 1);
+    ScanScene(scene, in_horizontal_res, in_seed, cloud);
+  }
+  else if (!LoadPcd(in_path, cloud))
+  {
+    return false;
+  }
+  out_clouds.push_back(cloud);
+  return true;
+}
+
+static double ReadStatusMb(const char* in_key)
+{
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line))
+  {
+    if (line.compare(0, strlen(in_key), in_key) == 0)
+    {
+      return std::atof(line.c_str() + strlen(in_key) + 1) / 1024.;
+    }
+  }
+  return 0;
+}
+
+/*!
+ * Restarts the measurement of the high-water mark of the resident memory, Linux only
+ */
+static void ResetPeakRss()
+{
+  std::ofstream clear_refs("/proc/self/clear_refs");
+  clear_refs << "5";
+}
+
+static void AddAccuracy(StageResult& io_result, const std::string& in_metric, double in_value)
+{
+  io_result.accuracy[in_metric] += in_value;
+  io_result.accuracy_samples[in_metric]++;
+}
+
+/*!
+ * Precision, recall and F1 score of the points classified as ground, only on the points the filter classified
+ */
+static void AddGroundAccuracy(const std::vector<int>& in_labels, const std::vector<int>& in_classified_points,
+                              const std::vector<char>& in_is_ground, StageResult& io_result)
+{
+  size_t true_positives = 0, false_positives = 0, false_negatives = 0;
+  for (size_t i = 0; i < in_classified_points.size(); i++)
+  {
+    int label = in_labels[in_classified_points[i]];
+    if (label < 0)
+      continue;
+    if (in_is_ground[i] && label == 0)
+      true_positives++;
+    else if (in_is_ground[i])
+      false_positives++;
+    else if (label == 0)
+      false_negatives++;
+  }
+  double precision = true_positives + false_positives > 0 ?
+                     double(true_positives) / (true_positives + false_positives) : 1.;
+  double recall = true_positives + false_negatives > 0 ?
+                  double(true_positives) / (true_positives + false_negatives) : 1.;
+  AddAccuracy(io_result, "ground_precision", precision);
+  AddAccuracy(io_result, "ground_recall", recall);
+  AddAccuracy(io_result, "ground_f1", precision + recall > 0 ? 2 * precision * recall / (precision + recall) : 0.);
+}
+
+PointsPreprocessorBenchmark::PointsPreprocessorBenchmark(int in_iterations) : iterations_(in_iterations)
+{
+  // same values as the defaults of the nodes and their launch files
+  ray_filter_.sensor_height_ = 1.8;
+  ray_filter_.general_max_slope_ = 3.0;
+  ray_filter_.local_max_slope_ = 5.0;
+  ray_filter_.radial_divider_angle_ = 0.1;
+  ray_filter_.concentric_divider_distance_ = 0.01;
+  ray_filter_.min_height_threshold_ = 0.05;
+  ray_filter_.clipping_height_ = 0.2;
+  ray_filter_.min_point_distance_ = 1.85;
+  ray_filter_.reclass_distance_threshold_ = 0.2;
+  ray_filter_.radial_dividers_num_ = ceil(360 / ray_filter_.radial_divider_angle_);
+  ray_filter_.colors_.assign(ray_filter_.color_num_, cv::Scalar(0, 0, 0));
+}
+
+void PointsPreprocessorBenchmark::Run(const LabelledCloud& in_cloud, std::map<std::string, StageResult>& io_results)
+{
+  RunRayGroundFilter(in_cloud, io_results["ray_ground_filter"]);
+  RunRingGroundFilter(in_cloud, io_results["ring_ground_filter"]);
+  RunSpaceFilter(in_cloud, io_results["space_filter"]);
+  RunVoxelGridFilter(in_cloud, io_results["voxel_grid_filter"]);
+  RunEuclideanCluster(in_cloud, CLUSTERING_KDTREE, io_results["euclidean_cluster"]);
+  RunEuclideanCluster(in_cloud, CLUSTERING_GRID, io_results["euclidean_cluster_grid"]);
+  RunEuclideanCluster(in_cloud, CLUSTERING_RANGE_BANDS, io_results["euclidean_cluster_range_bands"]);
+}
+
+template <typename Function>
+void PointsPreprocessorBenchmark::Measure(StageResult& io_result, Function in_function)
+{
+  ResetPeakRss();
+  for (int i = 0; i < iterations_; i++)
+  {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    in_function();
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    io_result.latencies_ms.push_back(elapsed.count());
+  }
+  io_result.peak_rss_mb = std::max(io_result.peak_rss_mb, ReadStatusMb("VmHWM:"));
+}
+
+void PointsPreprocessorBenchmark::RunRayGroundFilter(const LabelledCloud& in_cloud, StageResult& io_result)
+{
+  pcl::PointCloud<pcl::PointXYZI>::Ptr input(new pcl::PointCloud<pcl::PointXYZI>);
+  pcl::copyPointCloud(*in_cloud.cloud, *input);
+  pcl::PointCloud<pcl::PointXYZI>::Ptr filtered(new pcl::PointCloud<pcl::PointXYZI>);
+  pcl::PointIndices ground_indices, no_ground_indices;
+
+  Measure(io_result, [&]() {
+    pcl::PointCloud<pcl::PointXYZI>::Ptr clipped(new pcl::PointCloud<pcl::PointXYZI>);
+    ray_filter_.ClipCloud(input, ray_filter_.clipping_height_, clipped);
+    filtered.reset(new pcl::PointCloud<pcl::PointXYZI>);
+    ray_filter_.RemovePointsUpTo(clipped, ray_filter_.min_point_distance_, filtered);
+    ray_filter_.ConvertXYZIToRTZColor(filtered, ray_filter_.radial_ordered_points_, ray_filter_.radial_offsets_);
+    ground_indices.indices.clear();
+    no_ground_indices.indices.clear();
+    ray_filter_.ClassifyPointCloud(ray_filter_.radial_ordered_points_, ray_filter_.radial_offsets_,
+                                   ground_indices, no_ground_indices);
+    pcl::PointCloud<pcl::PointXYZI>::Ptr ground(new pcl::PointCloud<pcl::PointXYZI>);
+    pcl::PointCloud<pcl::PointXYZI>::Ptr no_ground(new pcl::PointCloud<pcl::PointXYZI>);
+    ray_filter_.ExtractPointsIndices(filtered, ground_indices, ground, no_ground);
+  });
+
+  if (!in_cloud.has_labels)
+    return;
+
+  // clipping and distance removal keep the order of the points, replay them on the indices
+  std::vector<int> kept_points;
+  for (size_t i = 0; i < input->points.size(); i++)
+  {
+    const pcl::PointXYZI& point = input->points[i];
+    if (point.z > ray_filter_.clipping_height_)
+      continue;
+    if (sqrt(point.x * point.x + point.y * point.y) < ray_filter_.min_point_distance_)
+      continue;
+    kept_points.push_back(i);
+  }
+  if (kept_points.size() != filtered->points.size())
+  {
+    ROS_WARN("ray_ground_filter: cannot match the filtered points to the labels");
+    return;
+  }
+  std::vector<char> is_ground(kept_points.size(), 0);
+  for (size_t i = 0; i < ground_indices.indices.size(); i++)
+  {
+    is_ground[ground_indices.indices[i]] = 1;
+  }
+  AddGroundAccuracy(in_cloud.labels, kept_points, is_ground, io_result);
+}
+
+void PointsPreprocessorBenchmark::RunRingGroundFilter(const LabelledCloud& in_cloud, StageResult& io_result)
+{
+  pcl::PointIndices ground_indices, groundless_indices;
+  Measure(io_result, [&]() {
+    ground_indices.indices.clear();
+    groundless_indices.indices.clear();
+    ring_filter_.FilterGround(in_cloud.cloud, groundless_indices, ground_indices);
+    pcl::PointCloud<velodyne_pointcloud::PointXYZIR> ground, groundless;
+    pcl::copyPointCloud(*in_cloud.cloud, groundless_indices, groundless);
+    pcl::copyPointCloud(*in_cloud.cloud, ground_indices, ground);
+  });
+
+  if (!in_cloud.has_labels)
+    return;
+
+  std::vector<int> classified_points(ground_indices.indices.begin(), ground_indices.indices.end());
+  classified_points.insert(classified_points.end(), groundless_indices.indices.begin(),
+                           groundless_indices.indices.end());
+  std::vector<char> is_ground(classified_points.size(), 0);
+  std::fill(is_ground.begin(), is_ground.begin() + ground_indices.indices.size(), 1);
+  AddGroundAccuracy(in_cloud.labels, classified_points, is_ground, io_result);
+}
+
+void PointsPreprocessorBenchmark::RunSpaceFilter(const LabelledCloud& in_cloud, StageResult& io_result)
+{
+  pcl::PointCloud<pcl::PointXYZ>::Ptr input(new pcl::PointCloud<pcl::PointXYZ>);
+  pcl::copyPointCloud(*in_cloud.cloud, *input);
+  Measure(io_result, [&]() {
+    pcl::PointCloud<pcl::PointXYZ>::Ptr inlanes(new pcl::PointCloud<pcl::PointXYZ>);
+    pcl::PointCloud<pcl::PointXYZ>::Ptr clipped(new pcl::PointCloud<pcl::PointXYZ>);
+    space_filter_.KeepLanes(input, inlanes, space_filter_.left_distance_, space_filter_.right_distance_);
+    space_filter_.ClipCloud(inlanes, clipped, space_filter_.below_distance_, space_filter_.above_distance_);
+  });
+}
+
+void PointsPreprocessorBenchmark::RunVoxelGridFilter(const LabelledCloud& in_cloud, StageResult& io_result)
+{
+  // voxel_grid_filter (points_downsampler) with its default leaf size
+  const double leaf_size = 2.0;
+  pcl::PointCloud<pcl::PointXYZI>::Ptr input(new pcl::PointCloud<pcl::PointXYZI>);
+  pcl::copyPointCloud(*in_cloud.cloud, *input);
+  size_t output_size = 0;
+  Measure(io_result, [&]() {
+    pcl::PointCloud<pcl::PointXYZI>::Ptr filtered(new pcl::PointCloud<pcl::PointXYZI>);
+    voxelGridFilter(input, leaf_size, filtered);
+    output_size = filtered->points.size();
+  });
+  AddAccuracy(io_result, "output_ratio", input->points.empty() ? 0. : double(output_size) / input->points.size());
+}
+
+void PointsPreprocessorBenchmark::RunEuclideanCluster(const LabelledCloud& in_cloud, ClusteringMethod in_method,
+                                                      StageResult& io_result)
+{
+  // lidar_euclidean_cluster_detect defaults: clip heights, 2D clustering, distances and cluster sizes.
+  // The ground is removed with the labels, so only the clustering is measured.
+  const double clip_min_height = -1.3, clip_max_height = 0.5;
+  const double clustering_distance = 0.75;
+  const int cluster_size_min = 20, cluster_size_max = 100000;
+  const double ranges[] = { 15, 30, 45, 60 };
+  const double distances[] = { 0.5, 1.1, 1.6, 2.1, 2.6 };
+  const std::vector<double> clustering_ranges(ranges, ranges + 4);
+  const std::vector<double> clustering_distances(distances, distances + 5);
+
+  pcl::PointCloud<pcl::PointXYZ>::Ptr input(new pcl::PointCloud<pcl::PointXYZ>);
+  std::vector<int> input_labels;
+  for (size_t i = 0; i < in_cloud.cloud->points.size(); i++)
+  {
+    const velodyne_pointcloud::PointXYZIR& point = in_cloud.cloud->points[i];
+    if (in_cloud.labels[i] == 0 || point.z < clip_min_height || point.z > clip_max_height)
+      continue;
+    input->points.push_back(pcl::PointXYZ(point.x, point.y, 0));
+    input_labels.push_back(in_cloud.labels[i]);
+  }
+  input->width = input->points.size();
+  input->height = 1;
+
+  std::vector<std::vector<int> > clusters;
+  Measure(io_result, [&]() {
+    clusters.clear();
+    if (input->points.empty())
+      return;
+    if (in_method == CLUSTERING_KDTREE)
+    {
+      std::vector<pcl::PointIndices> cluster_indices =
+          extractEuclideanClusters(input, clustering_distance, cluster_size_min, cluster_size_max);
+      clusters.resize(cluster_indices.size());
+      for (size_t c = 0; c < cluster_indices.size(); c++)
+      {
+        clusters[c].swap(cluster_indices[c].indices);
+      }
+    }
+    else if (in_method == CLUSTERING_GRID)
+    {
+      clusters = extractGridClusters(input, std::vector<int>(), clustering_distance, cluster_size_min,
+                                     cluster_size_max);
+    }
+    else
+    {
+      clusters = extractRangeBandClusters(input, clustering_ranges, clustering_distances, cluster_size_min,
+                                          cluster_size_max, false);
+    }
+  });
+
+  if (!in_cloud.has_labels)
+    return;
+
+  // an object is found when a cluster shares at least half of the union of their points
+  std::map<int, size_t> object_sizes;
+  for (size_t i = 0; i < input_labels.size(); i++)
+  {
+    if (input_labels[i] > 0)
+      object_sizes[input_labels[i]]++;
+  }
+  std::map<int, char> found_objects;
+  size_t matched_clusters = 0;
+  for (size_t c = 0; c < clusters.size(); c++)
+  {
+    std::map<int, size_t> shared_points;
+    for (size_t i = 0; i < clusters[c].size(); i++)
+    {
+      shared_points[input_labels[clusters[c][i]]]++;
+    }
+    bool matched = false;
+    for (std::map<int, size_t>::const_iterator it = shared_points.begin(); it != shared_points.end(); ++it)
+    {
+      if (it->first <= 0)
+        continue;
+      double iou = double(it->second) / (object_sizes[it->first] + clusters[c].size() - it->second);
+      if (iou >= 0.5)
+      {
+        found_objects[it->first] = 1;
+        matched = true;
+      }
+    }
+    if (matched)
+      matched_clusters++;
+  }
+  size_t objects_num = 0;
+  for (std::map<int, size_t>::const_iterator it = object_sizes.begin(); it != object_sizes.end(); ++it)
+  {
+    if (it->second >= static_cast<size_t>(cluster_size_min))
+      objects_num++;
+  }
+  double recall = objects_num > 0 ? std::min(1., double(found_objects.size()) / objects_num) : 1.;
+  double precision = clusters.empty() ? 1. : double(matched_clusters) / clusters.size();
+  AddAccuracy(io_result, "object_precision", precision);
+  AddAccuracy(io_result, "object_recall", recall);
+  AddAccuracy(io_result, "object_f1", precision + recall > 0 ? 2 * precision * recall / (precision + recall) : 0.);
+}
+
+static double Percentile(std::vector<double> in_values, double in_percent)
+{
+  if (in_values.empty())
+    return 0;
+  std::sort(in_values.begin(), in_values.end());
+  size_t rank = static_cast<size_t>(std::ceil(in_percent / 100. * in_values.size()));
+  return in_values[std::min(std::max<size_t>(rank, 1), in_values.size()) - 1];
+}
+
+std::map<std::string, double> Summarize(const std::map<std::string, StageResult>& in_results)
+{
+  std::map<std::string, double> summary;
+  for (std::map<std::string, StageResult>::const_iterator stage = in_results.begin(); stage != in_results.end();
+       ++stage)
+  {
+    const StageResult& result = stage->second;
+    summary[stage->first + " latency_p50_ms"] = Percentile(result.latencies_ms, 50);
+    summary[stage->first + " latency_p90_ms"] = Percentile(result.latencies_ms, 90);
+    summary[stage->first + " latency_p99_ms"] = Percentile(result.latencies_ms, 99);
+    summary[stage->first + " peak_rss_mb"] = result.peak_rss_mb;
+    for (std::map<std::string, double>::const_iterator metric = result.accuracy.begin();
+         metric != result.accuracy.end(); ++metric)
+    {
+      summary[stage->first + " " + metric->first] = metric->second / result.accuracy_samples.at(metric->first);
+    }
+  }
+  return summary;
+}
+
+// baseline metric of the absolute latency ceilings, compared with the p99 latency of any machine
+static const std::string LATENCY_CEILING_METRIC = "latency_p99_ceiling_ms";
+
+static bool IsLatencyMetric(const std::string& in_key)
+{
+  return in_key.find(" latency_") != std::string::npos;
+}
+
+static bool IsAccuracyMetric(const std::string& in_key)
+{
+  return in_key.find("_precision") != std::string::npos || in_key.find("_recall") != std::string::npos ||
+         in_key.find("_f1") != std::string::npos;
+}
+
+std::string GetComparedKey(const std::string& in_stage, const std::string& in_metric)
+{
+  return in_stage + " " + (in_metric == LATENCY_CEILING_METRIC ? "latency_p99_ms" : in_metric);
+}
+
+bool CompareWithBaseline(const std::map<std::string, double>& in_summary, const std::string& in_baseline_path,
+                         double in_latency_tolerance, double in_accuracy_tolerance,
+                         std::vector<std::string>& out_regressions)
+{
+  std::ifstream baseline(in_baseline_path.c_str());
+  if (!baseline)
+  {
+    return false;
+  }
+  std::string stage, metric;
+  double reference;
+  while (baseline >> stage >> metric >> reference)
+  {
+    std::string key = GetComparedKey(stage, metric);
+    std::map<std::string, double>::const_iterator current = in_summary.find(key);
+    if (current == in_summary.end())
+      continue;
+    bool regression;
+    if (metric == LATENCY_CEILING_METRIC)
+      regression = current->second > reference;
+    else if (IsLatencyMetric(key))
+      regression =
+          key.find("_p99_") == std::string::npos && current->second > reference * (1. + in_latency_tolerance);
+    else
+      regression = IsAccuracyMetric(key) && current->second < reference - in_accuracy_tolerance;
+    if (regression)
+    {
+      char description[256];
+      std::snprintf(description, sizeof(description), "%s: %.4f, baseline %s %.4f", key.c_str(), current->second,
+                    metric.c_str(), reference);
+      out_regressions.push_back(description);
+    }
+  }
+  return true;
+}
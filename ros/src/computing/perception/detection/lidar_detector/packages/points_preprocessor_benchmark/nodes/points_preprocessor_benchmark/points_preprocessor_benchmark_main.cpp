@@ -0,0 +1,143 @@
+/*
+ * Copyright 2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+
+#include <ros/ros.h>
+
+#include "points_preprocessor_benchmark.h"
+
+static void PrintUsage()
+{
+  std::printf("Usage: points_preprocessor_benchmark [options] [scene, pcap or pcd files...]\n"
+              "  Scenes (.scene) are scanned with a simulated HDL-64, PCAP and PCD files are used as recorded.\n"
+              "  Without files, the bundled corpus given by --corpus is used.\n"
+              "  --corpus DIR                 directory of .scene, .pcap and .pcd files\n"
+              "  --calibration FILE           calibration of the sensor of the PCAP files (velodyne_pointcloud)\n"
+              "  --packets-per-scan N         packets of a revolution in the PCAP files (default 348)\n"
+              "  --max-scans N                revolutions used from each PCAP file (default 10)\n"
+              "  --iterations N               runs of each stage on each cloud (default 20)\n"
+              "  --save-baseline FILE         write the results as a baseline\n"
+              "  --baseline FILE              compare the results with a baseline, fail on regression\n"
+              "  --latency-tolerance R        allowed relative increase of the p50 and p90 latency (default 0.25)\n"
+              "  --accuracy-tolerance D       allowed decrease of the precision, recall and F1 (default 0.005)\n"
+              "  The p99 latency of a stage is also compared with its latency_p99_ceiling_ms in the baseline.\n");
+}
+
+int main(int argc, char **argv)
+{
+  ros::init(argc, argv, "points_preprocessor_benchmark",
+            ros::init_options::AnonymousName | ros::init_options::NoRosout);
+
+  std::string corpus_dir, baseline_path, save_baseline_path;
+  int iterations = 20;
+  double latency_tolerance = 0.25, accuracy_tolerance = 0.005;
+  PcapSource pcap_source;
+  std::vector<std::string> files;
+  for (int i = 1; i < argc; i++)
+  {
+    std::string arg = argv[i];
+    bool has_value = i + 1 < argc;
+    if (arg == "--corpus" && has_value)
+      corpus_dir = argv[++i];
+    else if (arg == "--calibration" && has_value)
+      pcap_source.calibration_file = argv[++i];
+    else if (arg == "--packets-per-scan" && has_value)
+      pcap_source.packets_per_scan = std::max(1, std::atoi(argv[++i]));
+    else if (arg == "--max-scans" && has_value)
+      pcap_source.max_scans = std::max(1, std::atoi(argv[++i]));
+    else if (arg == "--iterations" && has_value)
+      iterations = std::max(1, std::atoi(argv[++i]));
+    else if (arg == "--baseline" && has_value)
+      baseline_path = argv[++i];
+    else if (arg == "--save-baseline" && has_value)
+      save_baseline_path = argv[++i];
+    else if (arg == "--latency-tolerance" && has_value)
+      latency_tolerance = std::atof(argv[++i]);
+    else if (arg == "--accuracy-tolerance" && has_value)
+      accuracy_tolerance = std::atof(argv[++i]);
+    else if (arg.compare(0, 2, "--") == 0)
+    {
+      PrintUsage();
+      return 2;
+    }
+    else
+      files.push_back(arg);
+  }
+  if (files.empty() && !corpus_dir.empty())
+  {
+    files = ReadCorpus(corpus_dir);
+  }
+  if (files.empty())
+  {
+    PrintUsage();
+    return 2;
+  }
+
+  PointsPreprocessorBenchmark benchmark(iterations);
+  std::map<std::string, StageResult> results;
+  for (size_t f = 0; f < files.size(); f++)
+  {
+    std::vector<LabelledCloud> clouds;
+    if (!LoadClouds(files[f], f + 1, benchmark.GetRingHorizontalRes(), pcap_source, clouds))
+    {
+      ROS_ERROR("Cannot read %s", files[f].c_str());
+      return 2;
+    }
+    for (size_t c = 0; c < clouds.size(); c++)
+    {
+      std::printf("%-32s %8zu points%s\n", clouds[c].name.c_str(), clouds[c].cloud->points.size(),
+                  clouds[c].has_labels ? "" : " (no labels)");
+      benchmark.Run(clouds[c], results);
+    }
+  }
+
+  std::map<std::string, double> summary = Summarize(results);
+  std::printf("\n");
+  for (std::map<std::string, double>::const_iterator it = summary.begin(); it != summary.end(); ++it)
+  {
+    std::printf("%-48s %12.4f\n", it->first.c_str(), it->second);
+  }
+
+  if (!save_baseline_path.empty())
+  {
+    std::ofstream baseline(save_baseline_path.c_str());
+    for (std::map<std::string, double>::const_iterator it = summary.begin(); it != summary.end(); ++it)
+    {
+      baseline << it->first << " " << it->second << "\n";
+    }
+  }
+
+  std::vector<std::string> regressions;
+  if (!baseline_path.empty())
+  {
+    if (!CompareWithBaseline(summary, baseline_path, latency_tolerance, accuracy_tolerance, regressions))
+    {
+      ROS_ERROR("Cannot read baseline %s", baseline_path.c_str());
+      return 2;
+    }
+    for (size_t i = 0; i < regressions.size(); i++)
+    {
+      std::printf("REGRESSION %s\n", regressions[i].c_str());
+    }
+    std::printf("%zu regression(s) against %s\n", regressions.size(), baseline_path.c_str());
+  }
+
+  return regressions.empty() ? 0 : 1;
+}
@@ -0,0 +1,151 @@
+#include "gtest/gtest.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+
+#include <unistd.h>
+
+#include <ros/ros.h>
+#include <ros/package.h>
+
+#include "points_preprocessor_benchmark.h"
+
+// runs of each stage on each cloud, few enough for the test to stay short
+static const int ITERATIONS = 3;
+
+// the corpus is scanned with fixed seeds, so the accuracy only changes with the code of the stages
+static const double ACCURACY_TOLERANCE = 0.005;
+
+// corpus of synthetic scenes and the recorded capture downloaded by the build, gated by the measured accuracy and
+// the latency ceilings of the baseline
+TEST(PointsPreprocessorBenchmark, corpusAgainstBaseline)
+{
+  std::vector<std::string> files = ReadCorpus(std::string(BENCHMARK_DIR) + "/corpus");
+  ASSERT_FALSE(files.empty());
+
+  PcapSource pcap_source;
+  pcap_source.calibration_file = ros::package::getPath("velodyne_pointcloud") + "/params/64e_s2.1-sztaki.yaml";
+  pcap_source.max_scans = 3;
+  std::string recorded_capture = std::string(TEST_DATA_DIR) + "/64e_s2.1-300-sztaki.pcap";
+
+  PointsPreprocessorBenchmark benchmark(ITERATIONS);
+  std::map<std::string, StageResult> results;
+  for (size_t f = 0; f < files.size(); f++)
+  {
+    std::vector<LabelledCloud> clouds;
+    ASSERT_TRUE(LoadClouds(files[f], f + 1, benchmark.GetRingHorizontalRes(), pcap_source, clouds)) << files[f];
+    for (size_t c = 0; c < clouds.size(); c++)
+    {
+      ASSERT_TRUE(clouds[c].has_labels);
+      benchmark.Run(clouds[c], results);
+    }
+  }
+
+  std::vector<LabelledCloud> recorded_clouds;
+  if (LoadClouds(recorded_capture, 0, benchmark.GetRingHorizontalRes(), pcap_source, recorded_clouds))
+  {
+    ASSERT_EQ(pcap_source.max_scans, recorded_clouds.size());
+    for (size_t c = 0; c < recorded_clouds.size(); c++)
+    {
+      ASSERT_FALSE(recorded_clouds[c].cloud->points.empty());
+      benchmark.Run(recorded_clouds[c], results);
+    }
+  }
+  else
+  {
+    std::cout << "[ SKIPPED  ] test data " << recorded_capture << " not available" << std::endl;
+  }
+
+  std::map<std::string, double> summary = Summarize(results);
+  for (std::map<std::string, double>::const_iterator it = summary.begin(); it != summary.end(); ++it)
+  {
+    std::cout << "[ BENCH    ] " << it->first << " " << it->second << std::endl;
+  }
+
+  // the baseline lists no p50 and p90 latency, those only compare on the same machine
+  std::vector<std::string> regressions;
+  ASSERT_TRUE(CompareWithBaseline(summary, std::string(BENCHMARK_DIR) + "/baseline.txt", 0.25, ACCURACY_TOLERANCE,
+                                  regressions));
+  for (size_t i = 0; i < regressions.size(); i++)
+  {
+    ADD_FAILURE() << "regression " << regressions[i];
+  }
+}
+
+// the stages gated by the baseline must all report their metrics
+TEST(PointsPreprocessorBenchmark, baselineMetricsReported)
+{
+  Scene scene;
+  ASSERT_TRUE(ReadScene(std::string(BENCHMARK_DIR) + "/corpus/urban_street.scene", scene));
+
+  PointsPreprocessorBenchmark benchmark(1);
+  LabelledCloud cloud;
+  cloud.name = "urban_street.scene";
+  ScanScene(scene, benchmark.GetRingHorizontalRes(), 1, cloud);
+  ASSERT_EQ(cloud.cloud->points.size(), cloud.labels.size());
+
+  std::map<std::string, StageResult> results;
+  benchmark.Run(cloud, results);
+  std::map<std::string, double> summary = Summarize(results);
+
+  std::ifstream baseline((std::string(BENCHMARK_DIR) + "/baseline.txt").c_str());
+  std::string stage, metric;
+  double reference;
+  size_t entries = 0;
+  while (baseline >> stage >> metric >> reference)
+  {
+    EXPECT_TRUE(summary.count(GetComparedKey(stage, metric))) << stage << " " << metric;
+    entries++;
+  }
+  EXPECT_GT(entries, 0u);
+}
+
+// each kind of baseline entry fails on its own kind of regression
+TEST(PointsPreprocessorBenchmark, compareWithBaseline)
+{
+  char baseline_path[] = "/tmp/points_preprocessor_benchmark_baseline_XXXXXX";
+  int baseline_fd = mkstemp(baseline_path);
+  ASSERT_NE(-1, baseline_fd);
+  close(baseline_fd);
+  std::ofstream baseline(baseline_path);
+  baseline << "stage ground_f1 0.9\n"
+           << "stage ground_recall 0.9\n"
+           << "stage latency_p50_ms 10\n"
+           << "stage latency_p90_ms 10\n"
+           << "stage latency_p99_ceiling_ms 20\n"
+           << "stage output_ratio 0.5\n"
+           << "missing_stage ground_f1 0.9\n";
+  baseline.close();
+
+  std::map<std::string, double> summary;
+  summary["stage ground_f1"] = 0.896;      // within the tolerance
+  summary["stage ground_recall"] = 0.894;  // below it
+  summary["stage latency_p50_ms"] = 12;    // within the tolerance
+  summary["stage latency_p90_ms"] = 13;    // above it
+  summary["stage latency_p99_ms"] = 21;    // above the ceiling
+  summary["stage output_ratio"] = 0.1;     // not gated
+  std::vector<std::string> regressions;
+  ASSERT_TRUE(CompareWithBaseline(summary, baseline_path, 0.25, ACCURACY_TOLERANCE, regressions));
+  ASSERT_EQ(3u, regressions.size());
+  EXPECT_EQ(0u, regressions[0].find("stage ground_recall")) << regressions[0];
+  EXPECT_EQ(0u, regressions[1].find("stage latency_p90_ms")) << regressions[1];
+  EXPECT_EQ(0u, regressions[2].find("stage latency_p99_ms")) << regressions[2];
+
+  summary["stage latency_p99_ms"] = 19;
+  regressions.clear();
+  ASSERT_TRUE(CompareWithBaseline(summary, baseline_path, 0.25, ACCURACY_TOLERANCE, regressions));
+  EXPECT_EQ(2u, regressions.size());
+  std::remove(baseline_path);
+
+  EXPECT_FALSE(CompareWithBaseline(summary, baseline_path, 0.25, ACCURACY_TOLERANCE, regressions));
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "test_points_preprocessor_benchmark");
+  return RUN_ALL_TESTS();
+}
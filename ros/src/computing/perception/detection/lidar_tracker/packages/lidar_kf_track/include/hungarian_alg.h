@@ -29,6 +29,28 @@ private:
 	// Computes a suboptimal solution. Good for cases with many forbidden assignments.
 	// --------------------------------------------------------------------------
 	void assignmentsuboptimal2(std::vector<int>& assignment, float& cost, const std::vector<float>& distMatrixIn, size_t nOfRows, size_t nOfColumns);
+	// --------------------------------------------------------------------------
+	// Union-find over rows (0..nOfRows-1) and columns (nOfRows..) for gating.
+	// --------------------------------------------------------------------------
+	size_t findcomponent(size_t node);
+
+	// Workspaces, kept between calls to avoid reallocating them every frame
+	std::vector<float> distMatrix;
+	std::vector<bool> coveredColumns;
+	std::vector<bool> coveredRows;
+	std::vector<bool> starMatrix;
+	std::vector<bool> primeMatrix;
+	std::vector<bool> newStarMatrix;
+	std::vector<int> nOfValidObservations;
+	std::vector<int> nOfValidTracks;
+
+	std::vector<size_t> componentParent;
+	std::vector<size_t> componentNodes;
+	std::vector<size_t> componentRows;
+	std::vector<size_t> componentColumns;
+	std::vector<size_t> blockIndex;
+	std::vector<float> blockMatrix;
+	std::vector<int> blockAssignment;
 
 public:
 	enum TMethod
@@ -41,4 +63,17 @@ public:
 	AssignmentProblemSolver();
 	~AssignmentProblemSolver();
 	float Solve(const std::vector<float>& distMatrixIn, size_t nOfRows, size_t nOfColumns, std::vector<int>& assignment, TMethod Method = optimal);
+	// --------------------------------------------------------------------------
+	// Solves only between pairs with a cost <= maxCost. Such pairs split the
+	// matrix into independent blocks (connected components), each block is
+	// solved on its own. Rows left without a pair within maxCost get -1.
+	// The result is that of Solve() on the whole matrix with every cost above
+	// maxCost replaced by a common forbidden value, after dropping those pairs:
+	// as many pairs within maxCost as possible, and the cheapest such set.
+	// It is not Solve() on the raw costs followed by dropping the pairs above
+	// maxCost. That minimizes the sum over all pairs first, and can pair a row
+	// outside the gate and lose a pair inside it (costs must be >= 0).
+	// --------------------------------------------------------------------------
+	float SolveGated(const std::vector<float>& distMatrixIn, size_t nOfRows, size_t nOfColumns, float maxCost, std::vector<int>& assignment, TMethod Method = optimal);
+	static float ForbiddenCost(float maxCost, size_t nOfRows, size_t nOfColumns);
 };
@@ -99,6 +99,11 @@ class KFLidarTracker {
   size_t maximum_track_id_;
 
   bool pose_estimation_;
+
+  // kept across frames so its workspaces are reused
+  AssignmentProblemSolver assignment_solver_;
+  std::vector<float> cost_matrix_;
+
   void CheckTrackerMerge(size_t in_tracker_id, std::vector<CTrack> &in_trackers,
                          std::vector<bool> &in_out_visited_trackers,
                          std::vector<size_t> &out_merge_indices,
@@ -38,6 +38,135 @@ float AssignmentProblemSolver::Solve(
 
 	return cost;
 }
+
+// --------------------------------------------------------------------------
+// Value given to the pairs outside the gate. Any assignment with more pairs
+// inside the gate is cheaper than one with less, whatever their costs.
+// --------------------------------------------------------------------------
+float AssignmentProblemSolver::ForbiddenCost(float maxCost, size_t nOfRows, size_t nOfColumns)
+{
+	const size_t minDim = (nOfRows <= nOfColumns) ? nOfRows : nOfColumns;
+	return (maxCost > 0 ? maxCost : 0) * (minDim + 1) + 1;
+}
+
+size_t AssignmentProblemSolver::findcomponent(size_t node)
+{
+	while (componentParent[node] != node)
+	{
+		componentParent[node] = componentParent[componentParent[node]];
+		node = componentParent[node];
+	}
+	return node;
+}
+
+float AssignmentProblemSolver::SolveGated(
+	const std::vector<float>& distMatrixIn,
+	size_t nOfRows,
+	size_t nOfColumns,
+	float maxCost,
+	std::vector<int>& assignment,
+	TMethod Method
+	)
+{
+	assignment.assign(nOfRows, -1);
+
+	/* join every row and column with a pair inside the gate */
+	componentParent.resize(nOfRows + nOfColumns);
+	for (size_t n = 0; n < componentParent.size(); n++)
+	{
+		componentParent[n] = n;
+	}
+	for (size_t col = 0; col < nOfColumns; col++)
+	{
+		for (size_t row = 0; row < nOfRows; row++)
+		{
+			if (distMatrixIn[row + nOfRows * col] <= maxCost)
+			{
+				size_t a = findcomponent(row);
+				size_t b = findcomponent(nOfRows + col);
+				if (a != b)
+				{
+					componentParent[a] = b;
+				}
+			}
+		}
+	}
+
+	/* sort rows and columns by component, keeping their order inside it */
+	const size_t nOfNodes = nOfRows + nOfColumns;
+	blockIndex.assign(nOfNodes + 1, 0);
+	for (size_t n = 0; n < nOfNodes; n++)
+	{
+		blockIndex[findcomponent(n) + 1]++;
+	}
+	for (size_t n = 0; n < nOfNodes; n++)
+	{
+		blockIndex[n + 1] += blockIndex[n];
+	}
+	componentNodes.resize(nOfNodes);
+	for (size_t n = 0; n < nOfNodes; n++)
+	{
+		componentNodes[blockIndex[findcomponent(n)]++] = n;
+	}
+	/* blockIndex[root] is now the end of the component, walk them in order */
+
+	const float forbidden = ForbiddenCost(maxCost, nOfRows, nOfColumns);
+	float cost = 0;
+	size_t begin = 0;
+	for (size_t root = 0; root < nOfNodes; root++)
+	{
+		size_t end = blockIndex[root];
+		if (componentParent[root] != root || end == begin)
+		{
+			continue;
+		}
+
+		componentRows.clear();
+		componentColumns.clear();
+		for (size_t n = begin; n < end; n++)
+		{
+			if (componentNodes[n] < nOfRows)
+			{
+				componentRows.push_back(componentNodes[n]);
+			}
+			else
+			{
+				componentColumns.push_back(componentNodes[n] - nOfRows);
+			}
+		}
+		const size_t nOfBlockRows = componentRows.size();
+		const size_t nOfBlockColumns = componentColumns.size();
+
+		if (nOfBlockRows > 0 && nOfBlockColumns > 0)
+		{
+			blockMatrix.resize(nOfBlockRows * nOfBlockColumns);
+			for (size_t col = 0; col < nOfBlockColumns; col++)
+			{
+				for (size_t row = 0; row < nOfBlockRows; row++)
+				{
+					const float value = distMatrixIn[componentRows[row] + nOfRows * componentColumns[col]];
+					blockMatrix[row + nOfBlockRows * col] = (value <= maxCost) ? value : forbidden;
+				}
+			}
+
+			blockAssignment.assign(nOfBlockRows, -1);
+			Solve(blockMatrix, nOfBlockRows, nOfBlockColumns, blockAssignment, Method);
+
+			for (size_t row = 0; row < nOfBlockRows; row++)
+			{
+				const int col = blockAssignment[row];
+				if (col >= 0 && blockMatrix[row + nOfBlockRows * col] <= maxCost)
+				{
+					assignment[componentRows[row]] = static_cast<int>(componentColumns[col]);
+					cost += blockMatrix[row + nOfBlockRows * col];
+				}
+			}
+		}
+		begin = end;
+	}
+
+	return cost;
+}
 // --------------------------------------------------------------------------
 // Computes the optimal assignment (minimum overall costs) using Munkres algorithm.
 // --------------------------------------------------------------------------
@@ -48,24 +177,16 @@ void AssignmentProblemSolver::assignmentoptimal(std::vector<int>& assignment, fl
 
 	// Total elements number
 	size_t nOfElements = nOfRows * nOfColumns;
-	// Memory allocation
-	std::vector<float> distMatrix(nOfElements,0.0);//float* distMatrix = (float *)malloc(nOfElements * sizeof(float));
+	// Reuse the workspaces of previous calls
+	distMatrix.assign(distMatrixIn.begin(), distMatrixIn.begin() + nOfElements);
 	// Pointer to last element
 	float* distMatrixEnd = distMatrix.data() + nOfElements;
 
-	for (size_t row = 0; row < nOfElements; row++)
-	{
-		float value = distMatrixIn[row];
-		//assert(value >= 0);
-		distMatrix[row] = value;
-	}
-
-	// Memory allocation
-	std::vector<bool>coveredColumns(nOfColumns, false);//bool* coveredColumns = (bool*)calloc(nOfColumns, sizeof(bool));
-	std::vector<bool>coveredRows(nOfRows, false);//bool* coveredRows = (bool*)calloc(nOfRows, sizeof(bool));
-	std::vector<bool>starMatrix(nOfElements, false);//bool* starMatrix = (bool*)calloc(nOfElements, sizeof(bool));
-	std::vector<bool>primeMatrix(nOfElements, false);//bool* primeMatrix = (bool*)calloc(nOfElements, sizeof(bool));
-	std::vector<bool>newStarMatrix(nOfElements, false);//bool* newStarMatrix = (bool*)calloc(nOfElements, sizeof(bool)); /* used in step4 */
+	coveredColumns.assign(nOfColumns, false);
+	coveredRows.assign(nOfRows, false);
+	starMatrix.assign(nOfElements, false);
+	primeMatrix.assign(nOfElements, false);
+	newStarMatrix.assign(nOfElements, false); /* used in step4 */
 
 	/* preliminary steps */
 	if (nOfRows <= nOfColumns)
@@ -160,13 +281,6 @@ void AssignmentProblemSolver::assignmentoptimal(std::vector<int>& assignment, fl
 	step2b(assignment, distMatrix, starMatrix, newStarMatrix, primeMatrix, coveredColumns, coveredRows, nOfRows, nOfColumns, (nOfRows <= nOfColumns) ? nOfRows : nOfColumns);
 	/* compute cost and remove invalid assignments */
 	computeassignmentcost(assignment, cost, distMatrixIn, nOfRows);
-	/* free allocated memory */
-	//free(distMatrix);
-	//free(coveredColumns);
-	//free(coveredRows);
-	//free(starMatrix);
-	//free(primeMatrix);
-	//free(newStarMatrix);
 	return;
 }
 // --------------------------------------------------------------------------
@@ -210,11 +324,11 @@ void AssignmentProblemSolver::step2a(std::vector<int>& assignment, std::vector<f
 	/* cover every column containing a starred zero */
 	for (size_t col = 0; col < nOfColumns; col++)
 	{
-		starMatrixTemp = nOfRows*col;///////////////////////////////////////////////////////////
+		starMatrixTemp = nOfRows*col;
 		columnEnd = starMatrixTemp + nOfRows;
-		while (starMatrix[starMatrixTemp] < starMatrix[columnEnd])
+		while (starMatrixTemp < columnEnd)
 		{
-			if (starMatrixTemp++)
+			if (starMatrix[starMatrixTemp++])
 			{
 				coveredColumns[col] = true;
 				break;
@@ -423,11 +537,7 @@ void AssignmentProblemSolver::assignmentsuboptimal2(std::vector<int>& assignment
 {
 	/* make working copy of distance Matrix */
 	const size_t nOfElements = nOfRows * nOfColumns;
-	std::vector<float> distMatrix(nOfElements, 0.0); //= (float*)malloc(nOfElements * sizeof(float));
-	for (size_t n = 0; n < nOfElements; n++)
-	{
-		distMatrix[n] = distMatrixIn[n];
-	}
+	distMatrix.assign(distMatrixIn.begin(), distMatrixIn.begin() + nOfElements);
 
 	/* recursively search for the minimum element and do the assignment */
 	for (;;)
@@ -468,8 +578,6 @@ void AssignmentProblemSolver::assignmentsuboptimal2(std::vector<int>& assignment
 			break;
 		}
 	}
-
-	//free(distMatrix);
 }
 // --------------------------------------------------------------------------
 // Computes a suboptimal solution. Good for cases with many forbidden assignments.
@@ -478,15 +586,11 @@ void AssignmentProblemSolver::assignmentsuboptimal1(std::vector<int>& assignment
 {
 	/* make working copy of distance Matrix */
 	const size_t nOfElements = nOfRows * nOfColumns;
-	std::vector<float> distMatrix(nOfElements, 0.0); //= (float*)malloc(nOfElements * sizeof(float));
-    for (size_t n = 0; n < nOfElements; n++)
-	{
-		distMatrix[n] = distMatrixIn[n];
-	}
+	distMatrix.assign(distMatrixIn.begin(), distMatrixIn.begin() + nOfElements);
 
-	/* allocate memory */
-	std::vector<int> nOfValidObservations(nOfRows, 0);//int* nOfValidObservations = (int *)calloc(nOfRows, sizeof(int));
-	std::vector<int> nOfValidTracks(nOfColumns, 0);//int* nOfValidTracks = (int *)calloc(nOfColumns, sizeof(int));
+	/* reset the validation counters */
+	nOfValidObservations.assign(nOfRows, 0);
+	nOfValidTracks.assign(nOfColumns, 0);
 
 	/* compute number of validations */
 	bool infiniteValueFound = false;
@@ -704,9 +808,4 @@ void AssignmentProblemSolver::assignmentsuboptimal1(std::vector<int>& assignment
 			break;
 		}
 	}
-
-	/* free allocated memory */
-	//free(nOfValidObservations);
-	//free(nOfValidTracks);
-	//free(distMatrix);
 }
@@ -320,7 +320,7 @@ void KFLidarTracker::CheckAllTrackersForMerge(std::vector<CTrack>& out_trackers)
 	if (!tracks_.empty())
 	{
 		std::cout << "Try to match" << std::endl;
-		std::vector<float> cost_matrix(N * M);
+		cost_matrix_.resize(N * M);
 
 		switch (distType)
 		{
@@ -329,7 +329,7 @@ void KFLidarTracker::CheckAllTrackersForMerge(std::vector<CTrack>& out_trackers)
 			{
 				for (size_t j = 0; j < detections_num; j++)
 				{
-					cost_matrix[i + j * N] = tracks_[i].CalculateDistance(cv::Point2f(in_cloud_cluster_array.clusters[j].centroid_point.point.x, in_cloud_cluster_array.clusters[j].centroid_point.point.y));
+					cost_matrix_[i + j * N] = tracks_[i].CalculateDistance(cv::Point2f(in_cloud_cluster_array.clusters[j].centroid_point.point.x, in_cloud_cluster_array.clusters[j].centroid_point.point.y));
 				}
 			}
 			break;
@@ -339,7 +339,7 @@ void KFLidarTracker::CheckAllTrackersForMerge(std::vector<CTrack>& out_trackers)
 			{
 				for (size_t j = 0; j < detections_num; j++)
 				{
-					cost_matrix[i + j * N] = tracks_[i].CalculateDistance( cv::Rect_<float>(in_cloud_cluster_array.clusters[i].centroid_point.point.x - in_cloud_cluster_array.clusters[i].bounding_box.dimensions.x/2,
+					cost_matrix_[i + j * N] = tracks_[i].CalculateDistance( cv::Rect_<float>(in_cloud_cluster_array.clusters[i].centroid_point.point.x - in_cloud_cluster_array.clusters[i].bounding_box.dimensions.x/2,
 																			in_cloud_cluster_array.clusters[i].centroid_point.point.y - in_cloud_cluster_array.clusters[i].bounding_box.dimensions.y/2,
 																			in_cloud_cluster_array.clusters[i].bounding_box.dimensions.x,
 																			in_cloud_cluster_array.clusters[i].bounding_box.dimensions.y
@@ -353,25 +353,14 @@ void KFLidarTracker::CheckAllTrackersForMerge(std::vector<CTrack>& out_trackers)
 		// -----------------------------------
 		// Solving assignment problem (tracks and predictions of Kalman filter)
 		// -----------------------------------
-		AssignmentProblemSolver APS;
+		// Only pairs within distance_threshold_ are considered, tracks without
+		// a detection that close are left unassigned (-1)
 		std::cout << "Hungarian Algorithm Start"<< std::endl;
-		APS.Solve(cost_matrix, N, M, assignment, AssignmentProblemSolver::optimal);
+		assignment_solver_.SolveGated(cost_matrix_, N, M, distance_threshold_, assignment, AssignmentProblemSolver::optimal);
 		std::cout << "Hungarian Algorithm End"<< std::endl;
-		// -----------------------------------
-		// clean assignment from pairs with large distance
-		// -----------------------------------
 		for (size_t i = 0; i < assignment.size(); i++)
 		{
-			if (assignment[i] != -1)
-			{
-				if (cost_matrix[i + assignment[i] * N] > distance_threshold_)
-				{
-					assignment[i] = -1;
-					tracks_[i].skipped_frames = 1;
-					std::cout << "Existing track Not matched " << i << " Distance:" << cost_matrix[i + assignment[i] * N] << std::endl;
-				}
-			}
-			else
+			if (assignment[i] == -1)
 			{
 				// If track have no assigned detect, then increment skipped frames counter.
 				tracks_[i].skipped_frames++;
@@ -0,0 +1,224 @@
+//
+// C++ unit tests for AssignmentProblemSolver, comparing the gated
+// block-wise solve with the full solve it replaces in lidar_kf_track.
+//
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "hungarian_alg.h"
+
+// random centroid distances between nOfRows tracks and nOfColumns detections
+static void make_distance_matrix(size_t nOfRows, size_t nOfColumns, float range, std::vector<float>& out_matrix)
+{
+  std::vector<float> tracks(2 * nOfRows), detections(2 * nOfColumns);
+  for (size_t i = 0; i < tracks.size(); i++)
+    tracks[i] = range * rand() / RAND_MAX;
+  for (size_t i = 0; i < detections.size(); i++)
+    detections[i] = range * rand() / RAND_MAX;
+
+  out_matrix.resize(nOfRows * nOfColumns);
+  for (size_t col = 0; col < nOfColumns; col++)
+    for (size_t row = 0; row < nOfRows; row++)
+      out_matrix[row + nOfRows * col] = std::hypot(tracks[2 * row] - detections[2 * col],
+                                                   tracks[2 * row + 1] - detections[2 * col + 1]);
+}
+
+// solve on the whole matrix, then drop the pairs above the gate (the former lidar_kf_track path)
+static void solve_then_threshold(const std::vector<float>& matrix, size_t nOfRows, size_t nOfColumns, float gate,
+                                 std::vector<int>& out_assignment)
+{
+  AssignmentProblemSolver solver;
+  out_assignment.clear();
+  solver.Solve(matrix, nOfRows, nOfColumns, out_assignment, AssignmentProblemSolver::optimal);
+  for (size_t row = 0; row < nOfRows; row++)
+    if (out_assignment[row] >= 0 && matrix[row + nOfRows * out_assignment[row]] > gate)
+      out_assignment[row] = -1;
+}
+
+// solve on the whole matrix with the costs above the gate saturated, then drop those pairs
+static void solve_saturated(const std::vector<float>& matrix, size_t nOfRows, size_t nOfColumns, float gate,
+                            std::vector<int>& out_assignment)
+{
+  const float forbidden = AssignmentProblemSolver::ForbiddenCost(gate, nOfRows, nOfColumns);
+  std::vector<float> saturated(matrix);
+  for (size_t i = 0; i < saturated.size(); i++)
+    if (saturated[i] > gate)
+      saturated[i] = forbidden;
+
+  AssignmentProblemSolver solver;
+  out_assignment.clear();
+  solver.Solve(saturated, nOfRows, nOfColumns, out_assignment, AssignmentProblemSolver::optimal);
+  for (size_t row = 0; row < nOfRows; row++)
+    if (out_assignment[row] >= 0 && saturated[row + nOfRows * out_assignment[row]] > gate)
+      out_assignment[row] = -1;
+}
+
+static void count_pairs(const std::vector<float>& matrix, size_t nOfRows, const std::vector<int>& assignment,
+                        size_t& out_pairs, float& out_cost)
+{
+  out_pairs = 0;
+  out_cost = 0;
+  for (size_t row = 0; row < assignment.size(); row++)
+  {
+    if (assignment[row] >= 0)
+    {
+      out_pairs++;
+      out_cost += matrix[row + nOfRows * assignment[row]];
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////
+// Test cases
+///////////////////////////////////////////////////////////////
+
+TEST(AssignmentProblemSolver, gatedMatchesSaturatedSolve)
+{
+  srand(1);
+  AssignmentProblemSolver solver;
+  std::vector<float> matrix;
+  std::vector<int> gated, reference;
+  for (int n = 0; n < 500; n++)
+  {
+    const size_t nOfRows = 1 + rand() % 30;
+    const size_t nOfColumns = 1 + rand() % 30;
+    make_distance_matrix(nOfRows, nOfColumns, 20.0f, matrix);
+
+    solver.SolveGated(matrix, nOfRows, nOfColumns, 1.5f, gated, AssignmentProblemSolver::optimal);
+    solve_saturated(matrix, nOfRows, nOfColumns, 1.5f, reference);
+
+    ASSERT_EQ(reference.size(), gated.size());
+    for (size_t row = 0; row < nOfRows; row++)
+      EXPECT_EQ(reference[row], gated[row]) << "case " << n << " row " << row;
+  }
+}
+
+TEST(AssignmentProblemSolver, gatedAgainstSolveThenThreshold)
+{
+  srand(2);
+  AssignmentProblemSolver solver;
+  std::vector<float> matrix;
+  std::vector<int> gated, thresholded;
+  for (int n = 0; n < 500; n++)
+  {
+    const size_t nOfRows = 1 + rand() % 30;
+    const size_t nOfColumns = 1 + rand() % 30;
+    make_distance_matrix(nOfRows, nOfColumns, 20.0f, matrix);
+
+    solver.SolveGated(matrix, nOfRows, nOfColumns, 1.5f, gated, AssignmentProblemSolver::optimal);
+    solve_then_threshold(matrix, nOfRows, nOfColumns, 1.5f, thresholded);
+
+    // every gated pair is inside the gate, and there are at least as many as after thresholding
+    size_t gated_pairs = 0, thresholded_pairs = 0;
+    float gated_cost = 0, thresholded_cost = 0;
+    count_pairs(matrix, nOfRows, gated, gated_pairs, gated_cost);
+    count_pairs(matrix, nOfRows, thresholded, thresholded_pairs, thresholded_cost);
+    for (size_t row = 0; row < nOfRows; row++)
+    {
+      if (gated[row] >= 0)
+      {
+        EXPECT_LE(matrix[row + nOfRows * gated[row]], 1.5f);
+      }
+    }
+
+    // where they differ, thresholding lost a pair inside the gate or kept a more expensive set
+    EXPECT_GE(gated_pairs, thresholded_pairs) << "case " << n;
+    if (gated_pairs == thresholded_pairs)
+    {
+      EXPECT_LE(gated_cost, thresholded_cost + 1e-3f) << "case " << n;
+    }
+  }
+}
+
+TEST(AssignmentProblemSolver, gatedKeepsPairsLostByThreshold)
+{
+  // the full solve prefers (0,0)+(1,1) = 1.6 over (0,1)+(1,0) = 2.8,
+  // but (1,1) is outside the gate, so thresholding leaves track 1 unmatched
+  const size_t nOfRows = 2, nOfColumns = 2;
+  std::vector<float> matrix(nOfRows * nOfColumns);
+  matrix[0 + nOfRows * 0] = 0.0f;
+  matrix[0 + nOfRows * 1] = 1.4f;
+  matrix[1 + nOfRows * 0] = 1.4f;
+  matrix[1 + nOfRows * 1] = 1.6f;
+
+  std::vector<int> thresholded;
+  solve_then_threshold(matrix, nOfRows, nOfColumns, 1.5f, thresholded);
+  EXPECT_EQ(0, thresholded[0]);
+  EXPECT_EQ(-1, thresholded[1]);
+
+  AssignmentProblemSolver solver;
+  std::vector<int> gated;
+  solver.SolveGated(matrix, nOfRows, nOfColumns, 1.5f, gated, AssignmentProblemSolver::optimal);
+  EXPECT_EQ(1, gated[0]);
+  EXPECT_EQ(0, gated[1]);
+}
+
+TEST(AssignmentProblemSolver, gatedSeparatedObjects)
+{
+  // well separated objects: both paths agree, far tracks are left unmatched
+  srand(3);
+  const size_t nOfRows = 12, nOfColumns = 10;
+  std::vector<float> tracks(2 * nOfRows), detections(2 * nOfColumns);
+  for (size_t i = 0; i < nOfRows; i++)
+  {
+    tracks[2 * i] = 10.0f * i;
+    tracks[2 * i + 1] = 0.0f;
+  }
+  for (size_t j = 0; j < nOfColumns; j++)
+  {
+    detections[2 * j] = 10.0f * (nOfColumns - 1 - j) + 0.5f * rand() / RAND_MAX;
+    detections[2 * j + 1] = 0.5f * rand() / RAND_MAX;
+  }
+  std::vector<float> matrix(nOfRows * nOfColumns);
+  for (size_t col = 0; col < nOfColumns; col++)
+    for (size_t row = 0; row < nOfRows; row++)
+      matrix[row + nOfRows * col] = std::hypot(tracks[2 * row] - detections[2 * col],
+                                               tracks[2 * row + 1] - detections[2 * col + 1]);
+
+  AssignmentProblemSolver solver;
+  std::vector<int> gated, thresholded;
+  solver.SolveGated(matrix, nOfRows, nOfColumns, 1.5f, gated, AssignmentProblemSolver::optimal);
+  solve_then_threshold(matrix, nOfRows, nOfColumns, 1.5f, thresholded);
+
+  EXPECT_EQ(thresholded, gated);
+  for (size_t row = 0; row < nOfColumns; row++)
+    EXPECT_EQ(static_cast<int>(nOfColumns - 1 - row), gated[row]);
+  EXPECT_EQ(-1, gated[10]);
+  EXPECT_EQ(-1, gated[11]);
+}
+
+TEST(AssignmentProblemSolver, reusedSolverMatchesFreshSolver)
+{
+  // workspaces kept between calls of different sizes do not change the result
+  srand(4);
+  AssignmentProblemSolver reused;
+  std::vector<float> matrix;
+  for (int n = 0; n < 200; n++)
+  {
+    const size_t nOfRows = 1 + rand() % 25;
+    const size_t nOfColumns = 1 + rand() % 25;
+    make_distance_matrix(nOfRows, nOfColumns, 10.0f, matrix);
+
+    AssignmentProblemSolver fresh;
+    std::vector<int> a, b;
+    const float cost_a = reused.Solve(matrix, nOfRows, nOfColumns, a, AssignmentProblemSolver::optimal);
+    const float cost_b = fresh.Solve(matrix, nOfRows, nOfColumns, b, AssignmentProblemSolver::optimal);
+    EXPECT_EQ(b, a);
+    EXPECT_FLOAT_EQ(cost_b, cost_a);
+
+    reused.SolveGated(matrix, nOfRows, nOfColumns, 2.0f, a, AssignmentProblemSolver::optimal);
+    AssignmentProblemSolver fresh_gated;
+    fresh_gated.SolveGated(matrix, nOfRows, nOfColumns, 2.0f, b, AssignmentProblemSolver::optimal);
+    EXPECT_EQ(b, a);
+  }
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -14,9 +14,7 @@
 #include <tf/transform_listener.h>
 #include <vector_map/vector_map.h>
 #include <vector_map_server/GetLane.h>
-#include <message_filters/subscriber.h>
-#include <message_filters/synchronizer.h>
-#include <message_filters/sync_policies/approximate_time.h>
+#include <time_sync_lib/synchronizer.hpp>
 
 using vector_map::Node;
 using vector_map::Point;
@@ -338,6 +336,11 @@ void fusion_cb(const autoware_msgs::ObjLabel::ConstPtr &obj_label_msg,
   obj_pose_timestamp_pub.publish(time);
 }
 
+static void matched_cb(const std::vector<time_sync::Match> &matches)
+{
+  fusion_cb(matches[1].get<autoware_msgs::ObjLabel>(), matches[0].get<autoware_msgs::CloudClusterArray>());
+}
+
 int main(int argc, char *argv[])
 {
   /* ROS initialization */
@@ -351,14 +354,15 @@ int main(int argc, char *argv[])
   private_n.param("vmap_threshold", vmap_threshold, 5.0);
   vmap_threshold *= vmap_threshold;  // squared
 
-  typedef message_filters::sync_policies::ApproximateTime<autoware_msgs::ObjLabel, autoware_msgs::CloudClusterArray>
-      SyncPolicy;
-  message_filters::Subscriber<autoware_msgs::ObjLabel> obj_label_sub(n, "obj_label", SUBSCRIBE_QUEUE_SIZE);
-  message_filters::Subscriber<autoware_msgs::CloudClusterArray> cluster_centroids_sub(n, "/cloud_clusters",
-                                                                                      SUBSCRIBE_QUEUE_SIZE);
-  message_filters::Synchronizer<SyncPolicy> sync(SyncPolicy(SUBSCRIBE_QUEUE_SIZE), obj_label_sub,
-                                                 cluster_centroids_sub);
-  sync.registerCallback(boost::bind(&fusion_cb, _1, _2));
+  double sync_max_interval, sync_max_delay;
+  private_n.param("sync_max_interval", sync_max_interval, 0.1);
+  private_n.param("sync_max_delay", sync_max_delay, 1.0);
+
+  // the clusters are the pivot, the labels are matched to them by stamp
+  time_sync::Synchronizer sync(2, ros::Duration(sync_max_interval), ros::Duration(sync_max_delay));
+  sync.registerCallback(&matched_cb);
+  sync.subscribe<autoware_msgs::CloudClusterArray>(n, "/cloud_clusters", 0, SUBSCRIBE_QUEUE_SIZE);
+  sync.subscribe<autoware_msgs::ObjLabel>(n, "obj_label", 1, SUBSCRIBE_QUEUE_SIZE);
 
   obj_pose_pub = n.advertise<jsk_recognition_msgs::BoundingBoxArray>("obj_pose", ADVERTISE_QUEUE_SIZE, ADVERTISE_LATCH);
   cluster_class_pub = n.advertise<autoware_msgs::CloudClusterArray>("/cloud_clusters_class", ADVERTISE_QUEUE_SIZE);
@@ -53,7 +53,7 @@
 #include <autoware_msgs/DetectedObjectArray.h>
 
 #include "detection.h"
-#include "hungarian.h"
+#include "vision_beyond_track/hungarian.h"
 
 #define __APP_NAME__ "vision_beyond_track"
 
@@ -0,0 +1,223 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ndt_mapper.h"
+
+#include <cmath>
+
+#include <pcl/common/transforms.h>
+
+NdtMapper::NdtMapper()
+  : method_type_(MethodType::PCL_GENERIC)
+  , local_map_radius_(100.0)
+  , incremental_voxel_update_(false)
+  , map_size_(0)
+  , local_map_(new pcl::PointCloud<pcl::PointXYZI>())
+  , local_map_center_x_(0.0)
+  , local_map_center_y_(0.0)
+  , fitness_score_(0.0)
+  , has_converged_(false)
+  , final_num_iteration_(0)
+  , transformation_probability_(0.0)
+{
+  local_map_->header.frame_id = "map";
+}
+
+void NdtMapper::setMethodType(MethodType method_type)
+{
+  method_type_ = method_type;
+}
+
+void NdtMapper::setParameters(float resolution, double step_size, double trans_eps, int max_iter)
+{
+  if (method_type_ == MethodType::PCL_GENERIC)
+  {
+    ndt_.setTransformationEpsilon(trans_eps);
+    ndt_.setStepSize(step_size);
+    ndt_.setResolution(resolution);
+    ndt_.setMaximumIterations(max_iter);
+  }
+  else if (method_type_ == MethodType::PCL_ANH)
+  {
+    anh_ndt_.setTransformationEpsilon(trans_eps);
+    anh_ndt_.setStepSize(step_size);
+    anh_ndt_.setResolution(resolution);
+    anh_ndt_.setMaximumIterations(max_iter);
+  }
+#ifdef CUDA_FOUND
+  else if (method_type_ == MethodType::PCL_ANH_GPU)
+  {
+    anh_gpu_ndt_.setTransformationEpsilon(trans_eps);
+    anh_gpu_ndt_.setStepSize(step_size);
+    anh_gpu_ndt_.setResolution(resolution);
+    anh_gpu_ndt_.setMaximumIterations(max_iter);
+  }
+#endif
+#ifdef USE_PCL_OPENMP
+  else if (method_type_ == MethodType::PCL_OPENMP)
+  {
+    omp_ndt_.setTransformationEpsilon(trans_eps);
+    omp_ndt_.setStepSize(step_size);
+    omp_ndt_.setResolution(resolution);
+    omp_ndt_.setMaximumIterations(max_iter);
+  }
+#endif
+}
+
+void NdtMapper::setLocalMapRadius(double local_map_radius)
+{
+  local_map_radius_ = local_map_radius;
+}
+
+void NdtMapper::setIncrementalVoxelUpdate(bool incremental_voxel_update)
+{
+  incremental_voxel_update_ = incremental_voxel_update;
+}
+
+Eigen::Matrix4f NdtMapper::align(const pcl::PointCloud<pcl::PointXYZI>::Ptr& filtered_scan,
+                                 const Eigen::Matrix4f& init_guess)
+{
+  Eigen::Matrix4f t_localizer(Eigen::Matrix4f::Identity());
+
+  if (method_type_ == MethodType::PCL_GENERIC)
+  {
+    pcl::PointCloud<pcl::PointXYZI> output_cloud;
+    ndt_.setInputSource(filtered_scan);
+    ndt_.align(output_cloud, init_guess);
+    fitness_score_ = ndt_.getFitnessScore();
+    t_localizer = ndt_.getFinalTransformation();
+    has_converged_ = ndt_.hasConverged();
+    final_num_iteration_ = ndt_.getFinalNumIteration();
+    transformation_probability_ = ndt_.getTransformationProbability();
+  }
+  else if (method_type_ == MethodType::PCL_ANH)
+  {
+    anh_ndt_.setInputSource(filtered_scan);
+    anh_ndt_.align(init_guess);
+    fitness_score_ = anh_ndt_.getFitnessScore();
+    t_localizer = anh_ndt_.getFinalTransformation();
+    has_converged_ = anh_ndt_.hasConverged();
+    final_num_iteration_ = anh_ndt_.getFinalNumIteration();
+  }
+#ifdef CUDA_FOUND
+  else if (method_type_ == MethodType::PCL_ANH_GPU)
+  {
+    anh_gpu_ndt_.setInputSource(filtered_scan);
+    anh_gpu_ndt_.align(init_guess);
+    fitness_score_ = anh_gpu_ndt_.getFitnessScore();
+    t_localizer = anh_gpu_ndt_.getFinalTransformation();
+    has_converged_ = anh_gpu_ndt_.hasConverged();
+    final_num_iteration_ = anh_gpu_ndt_.getFinalNumIteration();
+  }
+#endif
+#ifdef USE_PCL_OPENMP
+  else if (method_type_ == MethodType::PCL_OPENMP)
+  {
+    pcl::PointCloud<pcl::PointXYZI> output_cloud;
+    omp_ndt_.setInputSource(filtered_scan);
+    omp_ndt_.align(output_cloud, init_guess);
+    fitness_score_ = omp_ndt_.getFitnessScore();
+    t_localizer = omp_ndt_.getFinalTransformation();
+    has_converged_ = omp_ndt_.hasConverged();
+    final_num_iteration_ = omp_ndt_.getFinalNumIteration();
+  }
+#endif
+
+  return t_localizer;
+}
+
+void NdtMapper::addScan(const pcl::PointCloud<pcl::PointXYZI>::Ptr& points, const Eigen::Matrix4f& pose)
+{
+  Keyframe keyframe;
+  keyframe.pose = pose;
+  keyframe.points = points;
+  keyframes_.push_back(keyframe);
+  map_size_ += points->size();
+
+  // The local map slides once the scans are added half of its radius away from its center.
+  // In between, the scans are appended to it and only pcl_anh updates the voxels they fall in.
+  double x = pose(0, 3);
+  double y = pose(1, 3);
+  if (local_map_radius_ > 0.0 &&
+      std::hypot(x - local_map_center_x_, y - local_map_center_y_) >= local_map_radius_ / 2.0)
+  {
+    buildLocalMap(x, y);
+    setInputTarget();
+  }
+  else if (method_type_ == MethodType::PCL_ANH && incremental_voxel_update_ == true && keyframes_.size() > 1)
+  {
+    // the voxel grid shares local_map_ and appends the scan to it
+    anh_ndt_.updateVoxelGrid(points);
+  }
+  else
+  {
+    *local_map_ += *points;
+    setInputTarget();
+  }
+}
+
+void NdtMapper::setKeyframePose(size_t index, const Eigen::Matrix4f& pose)
+{
+  Keyframe& keyframe = keyframes_[index];
+  Eigen::Matrix4f correction = pose * keyframe.pose.inverse();
+  pcl::transformPointCloud(*keyframe.points, *keyframe.points, correction);
+  keyframe.pose = pose;
+}
+
+void NdtMapper::getMap(pcl::PointCloud<pcl::PointXYZI>* map) const
+{
+  map->clear();
+  map->header.frame_id = "map";
+  map->points.reserve(map_size_);
+  for (size_t i = 0; i < keyframes_.size(); i++)
+    map->points.insert(map->points.end(), keyframes_[i].points->points.begin(), keyframes_[i].points->points.end());
+  map->width = map->points.size();
+  map->height = 1;
+}
+
+void NdtMapper::buildLocalMap(double center_x, double center_y)
+{
+  local_map_.reset(new pcl::PointCloud<pcl::PointXYZI>());
+  local_map_->header.frame_id = "map";
+  for (size_t i = 0; i < keyframes_.size(); i++)
+  {
+    const Keyframe& keyframe = keyframes_[i];
+    if (local_map_radius_ <= 0.0 ||
+        std::hypot(keyframe.pose(0, 3) - center_x, keyframe.pose(1, 3) - center_y) <= local_map_radius_)
+      local_map_->points.insert(local_map_->points.end(), keyframe.points->points.begin(),
+                                keyframe.points->points.end());
+  }
+  local_map_->width = local_map_->points.size();
+  local_map_->height = 1;
+  local_map_center_x_ = center_x;
+  local_map_center_y_ = center_y;
+}
+
+void NdtMapper::setInputTarget()
+{
+  if (method_type_ == MethodType::PCL_GENERIC)
+    ndt_.setInputTarget(local_map_);
+  else if (method_type_ == MethodType::PCL_ANH)
+    anh_ndt_.setInputTarget(local_map_);
+#ifdef CUDA_FOUND
+  else if (method_type_ == MethodType::PCL_ANH_GPU)
+    anh_gpu_ndt_.setInputTarget(local_map_);
+#endif
+#ifdef USE_PCL_OPENMP
+  else if (method_type_ == MethodType::PCL_OPENMP)
+    omp_ndt_.setInputTarget(local_map_);
+#endif
+}
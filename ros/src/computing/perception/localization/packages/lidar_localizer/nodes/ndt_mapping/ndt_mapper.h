@@ -0,0 +1,143 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NDT_MAPPER_H
+#define NDT_MAPPER_H
+
+#include <vector>
+
+#include <Eigen/Core>
+#include <Eigen/StdVector>
+
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+
+#include <ndt_cpu/NormalDistributionsTransform.h>
+#include <pcl/registration/ndt.h>
+#ifdef CUDA_FOUND
+#include <ndt_gpu/NormalDistributionsTransform.h>
+#endif
+#ifdef USE_PCL_OPENMP
+#include <pcl_omp_registration/ndt.h>
+#endif
+
+enum class MethodType
+{
+  PCL_GENERIC = 0,
+  PCL_ANH = 1,
+  PCL_ANH_GPU = 2,
+  PCL_OPENMP = 3,
+};
+
+// Registration of the scans of ndt_mapping and ndt_mapping_offline against the map built so far.
+// The map is kept as the scans added to it. The target of NDT is the local map made of the scans added
+// within local_map_radius, so registration does not slow down as the map grows.
+class NdtMapper
+{
+public:
+  struct Keyframe
+  {
+    Eigen::Matrix4f pose;                          // localizer pose the scan was added at
+    pcl::PointCloud<pcl::PointXYZI>::Ptr points;  // in the map frame
+
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  };
+
+  NdtMapper();
+
+  void setMethodType(MethodType method_type);
+  MethodType getMethodType() const
+  {
+    return method_type_;
+  }
+  void setParameters(float resolution, double step_size, double trans_eps, int max_iter);
+  void setLocalMapRadius(double local_map_radius);  // 0 uses the whole map as the target
+  void setIncrementalVoxelUpdate(bool incremental_voxel_update);  // only pcl_anh updates its voxels incrementally
+
+  // Registers filtered_scan, in the localizer frame, starting from init_guess. Returns the localizer pose
+  Eigen::Matrix4f align(const pcl::PointCloud<pcl::PointXYZI>::Ptr& filtered_scan, const Eigen::Matrix4f& init_guess);
+  double getFitnessScore() const
+  {
+    return fitness_score_;
+  }
+  bool hasConverged() const
+  {
+    return has_converged_;
+  }
+  int getFinalNumIteration() const
+  {
+    return final_num_iteration_;
+  }
+  double getTransformationProbability() const
+  {
+    return transformation_probability_;
+  }
+
+  // Adds points, already in the map frame, scanned at the localizer pose. points is kept, not copied
+  void addScan(const pcl::PointCloud<pcl::PointXYZI>::Ptr& points, const Eigen::Matrix4f& pose);
+  // Moves the keyframe at index, and its points, to pose. The local map is not rebuilt
+  void setKeyframePose(size_t index, const Eigen::Matrix4f& pose);
+
+  bool isEmpty() const
+  {
+    return keyframes_.empty();
+  }
+  const std::vector<Keyframe, Eigen::aligned_allocator<Keyframe> >& getKeyframes() const
+  {
+    return keyframes_;
+  }
+  size_t getMapSize() const
+  {
+    return map_size_;
+  }
+  void getMap(pcl::PointCloud<pcl::PointXYZI>* map) const;
+  const pcl::PointCloud<pcl::PointXYZI>& getLocalMap() const
+  {
+    return *local_map_;
+  }
+
+private:
+  MethodType method_type_;
+  double local_map_radius_;
+  bool incremental_voxel_update_;
+
+  std::vector<Keyframe, Eigen::aligned_allocator<Keyframe> > keyframes_;
+  size_t map_size_;
+  pcl::PointCloud<pcl::PointXYZI>::Ptr local_map_;
+  double local_map_center_x_, local_map_center_y_;
+
+  double fitness_score_;
+  bool has_converged_;
+  int final_num_iteration_;
+  double transformation_probability_;
+
+  pcl::NormalDistributionsTransform<pcl::PointXYZI, pcl::PointXYZI> ndt_;
+  cpu::NormalDistributionsTransform<pcl::PointXYZI, pcl::PointXYZI> anh_ndt_;
+#ifdef CUDA_FOUND
+  gpu::GNormalDistributionsTransform anh_gpu_ndt_;
+#endif
+#ifdef USE_PCL_OPENMP
+  pcl_omp::NormalDistributionsTransform<pcl::PointXYZI, pcl::PointXYZI> omp_ndt_;
+#endif
+
+  void buildLocalMap(double center_x, double center_y);
+  void setInputTarget();
+
+public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+#endif  // NDT_MAPPER_H
@@ -44,20 +44,13 @@
 #include <pcl/point_types.h>
 #include <pcl_conversions/pcl_conversions.h>
 
-#include <ndt_cpu/NormalDistributionsTransform.h>
-#include <pcl/registration/ndt.h>
-#ifdef CUDA_FOUND
-#include <ndt_gpu/NormalDistributionsTransform.h>
-#endif
-#ifdef USE_PCL_OPENMP
-#include <pcl_omp_registration/ndt.h>
-#endif
-
 #include <autoware_config_msgs/ConfigNDTMapping.h>
 #include <autoware_config_msgs/ConfigNDTMappingOutput.h>
 
 #include <time.h>
 
+#include "ndt_mapper.h"
+
 struct pose
 {
   double x;
@@ -68,13 +61,6 @@ struct pose
   double yaw;
 };
 
-enum class MethodType
-{
-  PCL_GENERIC = 0,
-  PCL_ANH = 1,
-  PCL_ANH_GPU = 2,
-  PCL_OPENMP = 3,
-};
 static MethodType _method_type = MethodType::PCL_GENERIC;
 
 // global variables
@@ -100,16 +86,7 @@ static double current_velocity_imu_x = 0.0;
 static double current_velocity_imu_y = 0.0;
 static double current_velocity_imu_z = 0.0;
 
-static pcl::PointCloud<pcl::PointXYZI> map;
-
-static pcl::NormalDistributionsTransform<pcl::PointXYZI, pcl::PointXYZI> ndt;
-static cpu::NormalDistributionsTransform<pcl::PointXYZI, pcl::PointXYZI> anh_ndt;
-#ifdef CUDA_FOUND
-static gpu::GNormalDistributionsTransform anh_gpu_ndt;
-#endif
-#ifdef USE_PCL_OPENMP
-static pcl_omp::NormalDistributionsTransform<pcl::PointXYZI, pcl::PointXYZI> omp_ndt;
-#endif
+static NdtMapper mapper;
 
 // Default values
 static int max_iter = 30;        // Maximum iterations
@@ -125,6 +102,7 @@ static ros::Time callback_start, callback_end, t1_start, t1_end, t2_start, t2_en
 static ros::Duration d_callback, d1, d2, d3, d4, d5;
 
 static ros::Publisher ndt_map_pub;
+static ros::Publisher ndt_map_delta_pub;
 static ros::Publisher current_pose_pub;
 static ros::Publisher guess_pose_linaer_pub;
 static geometry_msgs::PoseStamped current_pose_msg, guess_pose_msg;
@@ -140,6 +118,11 @@ static double min_scan_range = 5.0;
 static double max_scan_range = 200.0;
 static double min_add_scan_shift = 1.0;
 
+static double local_map_radius = 100.0;     // 0 uses the whole map as the target
+static double map_publish_interval = 10.0;  // seconds of scan time between full maps on ndt_map, 0 disables them
+static ros::Time map_published_time;
+static bool map_changed = false;
+
 static double _tf_x, _tf_y, _tf_z, _tf_roll, _tf_pitch, _tf_yaw;
 static Eigen::Matrix4f tf_btol, tf_ltob;
 
@@ -192,9 +175,9 @@ static void output_callback(const autoware_config_msgs::ConfigNDTMappingOutput::
   std::cout << "filter_res: " << filter_res << std::endl;
   std::cout << "filename: " << filename << std::endl;
 
-  pcl::PointCloud<pcl::PointXYZI>::Ptr map_ptr(new pcl::PointCloud<pcl::PointXYZI>(map));
+  pcl::PointCloud<pcl::PointXYZI>::Ptr map_ptr(new pcl::PointCloud<pcl::PointXYZI>());
   pcl::PointCloud<pcl::PointXYZI>::Ptr map_filtered(new pcl::PointCloud<pcl::PointXYZI>());
-  map_ptr->header.frame_id = "map";
+  mapper.getMap(map_ptr.get());
   map_filtered->header.frame_id = "map";
   sensor_msgs::PointCloud2::Ptr map_msg_ptr(new sensor_msgs::PointCloud2);
 
@@ -230,6 +213,32 @@ static void output_callback(const autoware_config_msgs::ConfigNDTMappingOutput::
   }
 }
 
+static void publish_map()
+{
+  pcl::PointCloud<pcl::PointXYZI> map;
+  mapper.getMap(&map);
+  sensor_msgs::PointCloud2::Ptr map_msg_ptr(new sensor_msgs::PointCloud2);
+  pcl::toROSMsg(map, *map_msg_ptr);
+  map_msg_ptr->header.stamp = current_scan_time;
+  ndt_map_pub.publish(*map_msg_ptr);
+
+  map_published_time = current_scan_time;
+  map_changed = false;
+}
+
+// Add a scan registered at the localizer pose to the map and publish it on ndt_map_delta
+static void add_scan(const pcl::PointCloud<pcl::PointXYZI>::Ptr& transformed_scan_ptr, const Eigen::Matrix4f& pose)
+{
+  mapper.addScan(transformed_scan_ptr, pose);
+  map_changed = true;
+
+  sensor_msgs::PointCloud2::Ptr delta_msg_ptr(new sensor_msgs::PointCloud2);
+  pcl::toROSMsg(*transformed_scan_ptr, *delta_msg_ptr);
+  delta_msg_ptr->header.frame_id = "map";
+  delta_msg_ptr->header.stamp = current_scan_time;
+  ndt_map_delta_pub.publish(*delta_msg_ptr);
+}
+
 static void imu_odom_calc(ros::Time current_time)
 {
   static ros::Time previous_time = current_time;
@@ -484,75 +493,21 @@ static void points_callback(const sensor_msgs::PointCloud2::ConstPtr& input)
 
   pcl::PointCloud<pcl::PointXYZI>::Ptr scan_ptr(new pcl::PointCloud<pcl::PointXYZI>(scan));
 
-  // Add initial point cloud to velodyne_map
-  if (initial_scan_loaded == 0)
-  {
-    pcl::transformPointCloud(*scan_ptr, *transformed_scan_ptr, tf_btol);
-    map += *transformed_scan_ptr;
-    initial_scan_loaded = 1;
-  }
-
   // Apply voxelgrid filter
   pcl::VoxelGrid<pcl::PointXYZI> voxel_grid_filter;
   voxel_grid_filter.setLeafSize(voxel_leaf_size, voxel_leaf_size, voxel_leaf_size);
   voxel_grid_filter.setInputCloud(scan_ptr);
   voxel_grid_filter.filter(*filtered_scan_ptr);
 
-  pcl::PointCloud<pcl::PointXYZI>::Ptr map_ptr(new pcl::PointCloud<pcl::PointXYZI>(map));
+  mapper.setParameters(ndt_res, step_size, trans_eps, max_iter);
 
-  if (_method_type == MethodType::PCL_GENERIC)
-  {
-    ndt.setTransformationEpsilon(trans_eps);
-    ndt.setStepSize(step_size);
-    ndt.setResolution(ndt_res);
-    ndt.setMaximumIterations(max_iter);
-    ndt.setInputSource(filtered_scan_ptr);
-  }
-  else if (_method_type == MethodType::PCL_ANH)
-  {
-    anh_ndt.setTransformationEpsilon(trans_eps);
-    anh_ndt.setStepSize(step_size);
-    anh_ndt.setResolution(ndt_res);
-    anh_ndt.setMaximumIterations(max_iter);
-    anh_ndt.setInputSource(filtered_scan_ptr);
-  }
-#ifdef CUDA_FOUND
-  else if (_method_type == MethodType::PCL_ANH_GPU)
-  {
-    anh_gpu_ndt.setTransformationEpsilon(trans_eps);
-    anh_gpu_ndt.setStepSize(step_size);
-    anh_gpu_ndt.setResolution(ndt_res);
-    anh_gpu_ndt.setMaximumIterations(max_iter);
-    anh_gpu_ndt.setInputSource(filtered_scan_ptr);
-  }
-#endif
-#ifdef USE_PCL_OPENMP
-  else if (_method_type == MethodType::PCL_OPENMP)
-  {
-    omp_ndt.setTransformationEpsilon(trans_eps);
-    omp_ndt.setStepSize(step_size);
-    omp_ndt.setResolution(ndt_res);
-    omp_ndt.setMaximumIterations(max_iter);
-    omp_ndt.setInputSource(filtered_scan_ptr);
-  }
-#endif
-
-  static bool is_first_map = true;
-  if (is_first_map == true)
+  // Add initial point cloud to velodyne_map
+  if (initial_scan_loaded == 0)
   {
-    if (_method_type == MethodType::PCL_GENERIC)
-      ndt.setInputTarget(map_ptr);
-    else if (_method_type == MethodType::PCL_ANH)
-      anh_ndt.setInputTarget(map_ptr);
-#ifdef CUDA_FOUND
-    else if (_method_type == MethodType::PCL_ANH_GPU)
-      anh_gpu_ndt.setInputTarget(map_ptr);
-#endif
-#ifdef USE_PCL_OPENMP
-    else if (_method_type == MethodType::PCL_OPENMP)
-      omp_ndt.setInputTarget(map_ptr);
-#endif
-    is_first_map = false;
+    pcl::PointCloud<pcl::PointXYZI>::Ptr initial_scan_ptr(new pcl::PointCloud<pcl::PointXYZI>());
+    pcl::transformPointCloud(*scan_ptr, *initial_scan_ptr, tf_btol);
+    add_scan(initial_scan_ptr, tf_btol);
+    initial_scan_loaded = 1;
   }
 
   guess_pose.x = previous_pose.x + diff_x;
@@ -593,45 +548,11 @@ static void points_callback(const sensor_msgs::PointCloud2::ConstPtr& input)
 
   t4_start = ros::Time::now();
 
-  pcl::PointCloud<pcl::PointXYZI>::Ptr output_cloud(new pcl::PointCloud<pcl::PointXYZI>);
-
-  if (_method_type == MethodType::PCL_GENERIC)
-  {
-    ndt.align(*output_cloud, init_guess);
-    fitness_score = ndt.getFitnessScore();
-    t_localizer = ndt.getFinalTransformation();
-    has_converged = ndt.hasConverged();
-    final_num_iteration = ndt.getFinalNumIteration();
-    transformation_probability = ndt.getTransformationProbability();
-  }
-  else if (_method_type == MethodType::PCL_ANH)
-  {
-    anh_ndt.align(init_guess);
-    fitness_score = anh_ndt.getFitnessScore();
-    t_localizer = anh_ndt.getFinalTransformation();
-    has_converged = anh_ndt.hasConverged();
-    final_num_iteration = anh_ndt.getFinalNumIteration();
-  }
-#ifdef CUDA_FOUND
-  else if (_method_type == MethodType::PCL_ANH_GPU)
-  {
-    anh_gpu_ndt.align(init_guess);
-    fitness_score = anh_gpu_ndt.getFitnessScore();
-    t_localizer = anh_gpu_ndt.getFinalTransformation();
-    has_converged = anh_gpu_ndt.hasConverged();
-    final_num_iteration = anh_gpu_ndt.getFinalNumIteration();
-  }
-#endif
-#ifdef USE_PCL_OPENMP
-  else if (_method_type == MethodType::PCL_OPENMP)
-  {
-    omp_ndt.align(*output_cloud, init_guess);
-    fitness_score = omp_ndt.getFitnessScore();
-    t_localizer = omp_ndt.getFinalTransformation();
-    has_converged = omp_ndt.hasConverged();
-    final_num_iteration = omp_ndt.getFinalNumIteration();
-  }
-#endif
+  t_localizer = mapper.align(filtered_scan_ptr, init_guess);
+  fitness_score = mapper.getFitnessScore();
+  has_converged = mapper.hasConverged();
+  final_num_iteration = mapper.getFinalNumIteration();
+  transformation_probability = mapper.getTransformationProbability();
 
   t_base_link = t_localizer * tf_ltob;
 
@@ -751,36 +672,19 @@ static void points_callback(const sensor_msgs::PointCloud2::ConstPtr& input)
   double shift = sqrt(pow(current_pose.x - added_pose.x, 2.0) + pow(current_pose.y - added_pose.y, 2.0));
   if (shift >= min_add_scan_shift)
   {
-    map += *transformed_scan_ptr;
+    add_scan(transformed_scan_ptr, t_localizer);
     added_pose.x = current_pose.x;
     added_pose.y = current_pose.y;
     added_pose.z = current_pose.z;
     added_pose.roll = current_pose.roll;
     added_pose.pitch = current_pose.pitch;
     added_pose.yaw = current_pose.yaw;
-
-    if (_method_type == MethodType::PCL_GENERIC)
-      ndt.setInputTarget(map_ptr);
-    else if (_method_type == MethodType::PCL_ANH)
-    {
-      if (_incremental_voxel_update == true)
-        anh_ndt.updateVoxelGrid(transformed_scan_ptr);
-      else
-        anh_ndt.setInputTarget(map_ptr);
-    }
-#ifdef CUDA_FOUND
-    else if (_method_type == MethodType::PCL_ANH_GPU)
-      anh_gpu_ndt.setInputTarget(map_ptr);
-#endif
-#ifdef USE_PCL_OPENMP
-    else if (_method_type == MethodType::PCL_OPENMP)
-      omp_ndt.setInputTarget(map_ptr);
-#endif
   }
 
-  sensor_msgs::PointCloud2::Ptr map_msg_ptr(new sensor_msgs::PointCloud2);
-  pcl::toROSMsg(*map_ptr, *map_msg_ptr);
-  ndt_map_pub.publish(*map_msg_ptr);
+  // The added scans are published on ndt_map_delta as they come, the whole map only every map_publish_interval
+  if (map_publish_interval > 0.0 && map_changed == true &&
+      fabs((current_scan_time - map_published_time).toSec()) >= map_publish_interval)
+    publish_map();
 
   q.setRPY(current_pose.roll, current_pose.pitch, current_pose.yaw);
   current_pose_msg.header.frame_id = "map";
@@ -829,7 +733,8 @@ static void points_callback(const sensor_msgs::PointCloud2::ConstPtr& input)
   std::cout << "Number of scan points: " << scan_ptr->size() << " points." << std::endl;
   std::cout << "Number of filtered scan points: " << filtered_scan_ptr->size() << " points." << std::endl;
   std::cout << "transformed_scan_ptr: " << transformed_scan_ptr->points.size() << " points." << std::endl;
-  std::cout << "map: " << map.points.size() << " points." << std::endl;
+  std::cout << "map: " << mapper.getMapSize() << " points." << std::endl;
+  std::cout << "local map: " << mapper.getLocalMap().size() << " points." << std::endl;
   std::cout << "NDT has converged: " << has_converged << std::endl;
   std::cout << "Fitness score: " << fitness_score << std::endl;
   std::cout << "Number of iteration: " << final_num_iteration << std::endl;
@@ -961,6 +866,8 @@ int main(int argc, char** argv)
   private_nh.getParam("imu_upside_down", _imu_upside_down);
   private_nh.getParam("imu_topic", _imu_topic);
   private_nh.getParam("incremental_voxel_update", _incremental_voxel_update);
+  private_nh.getParam("local_map_radius", local_map_radius);
+  private_nh.getParam("map_publish_interval", map_publish_interval);
 
   std::cout << "method_type: " << static_cast<int>(_method_type) << std::endl;
   std::cout << "use_odom: " << _use_odom << std::endl;
@@ -968,6 +875,8 @@ int main(int argc, char** argv)
   std::cout << "imu_upside_down: " << _imu_upside_down << std::endl;
   std::cout << "imu_topic: " << _imu_topic << std::endl;
   std::cout << "incremental_voxel_update: " << _incremental_voxel_update << std::endl;
+  std::cout << "local_map_radius: " << local_map_radius << std::endl;
+  std::cout << "map_publish_interval: " << map_publish_interval << std::endl;
 
   if (nh.getParam("tf_x", _tf_x) == false)
   {
@@ -1029,9 +938,12 @@ int main(int argc, char** argv)
   tf_btol = (tl_btol * rot_z_btol * rot_y_btol * rot_x_btol).matrix();
   tf_ltob = tf_btol.inverse();
 
-  map.header.frame_id = "map";
+  mapper.setMethodType(_method_type);
+  mapper.setIncrementalVoxelUpdate(_incremental_voxel_update);
+  mapper.setLocalMapRadius(local_map_radius);
 
   ndt_map_pub = nh.advertise<sensor_msgs::PointCloud2>("/ndt_map", 1000);
+  ndt_map_delta_pub = nh.advertise<sensor_msgs::PointCloud2>("/ndt_map_delta", 1000);
   current_pose_pub = nh.advertise<geometry_msgs::PoseStamped>("/current_pose", 1000);
 
   ros::Subscriber param_sub = nh.subscribe("config/ndt_mapping", 10, param_callback);
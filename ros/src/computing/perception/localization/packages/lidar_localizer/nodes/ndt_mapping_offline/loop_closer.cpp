@@ -0,0 +1,251 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "loop_closer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <thread>
+#include <unordered_map>
+
+#include <pcl/common/transforms.h>
+#include <pcl/filters/voxel_grid.h>
+#include <pcl/registration/ndt.h>
+
+namespace
+{
+int64_t cellKey(int x, int y)
+{
+  return (static_cast<int64_t>(x) << 32) | static_cast<uint32_t>(y);
+}
+}  // namespace
+
+LoopCloser::LoopCloser()
+  : search_radius_(10.0)
+  , min_travel_(50.0)
+  , search_interval_(5.0)
+  , submap_size_(10)
+  , max_fitness_score_(1.0)
+  , resolution_(2.0)
+  , step_size_(0.1)
+  , trans_eps_(0.01)
+  , max_iter_(30)
+  , leaf_size_(1.0)
+  , workers_(1)
+{
+}
+
+void LoopCloser::setSearchRadius(double search_radius)
+{
+  search_radius_ = search_radius;
+}
+
+void LoopCloser::setMinTravel(double min_travel)
+{
+  min_travel_ = min_travel;
+}
+
+void LoopCloser::setSearchInterval(double search_interval)
+{
+  search_interval_ = search_interval;
+}
+
+void LoopCloser::setSubmapSize(int submap_size)
+{
+  submap_size_ = submap_size;
+}
+
+void LoopCloser::setMaxFitnessScore(double max_fitness_score)
+{
+  max_fitness_score_ = max_fitness_score;
+}
+
+void LoopCloser::setParameters(float resolution, double step_size, double trans_eps, int max_iter, double leaf_size)
+{
+  resolution_ = resolution;
+  step_size_ = step_size;
+  trans_eps_ = trans_eps;
+  max_iter_ = max_iter;
+  leaf_size_ = leaf_size;
+}
+
+void LoopCloser::setWorkers(int workers)
+{
+  workers_ = std::max(1, workers);
+}
+
+LoopCloser::LoopVector LoopCloser::findLoops(
+    const std::vector<NdtMapper::Keyframe, Eigen::aligned_allocator<NdtMapper::Keyframe> >& keyframes) const
+{
+  LoopVector candidates;
+  if (keyframes.size() < 2 || search_radius_ <= 0.0)
+    return candidates;
+
+  // distance traveled up to each keyframe, and the keyframes in cells of search_radius
+  std::vector<double> travel(keyframes.size(), 0.0);
+  std::unordered_map<int64_t, std::vector<size_t> > grid;
+  for (size_t k = 0; k < keyframes.size(); k++)
+  {
+    if (k > 0)
+      travel[k] = travel[k - 1] + std::hypot(keyframes[k].pose(0, 3) - keyframes[k - 1].pose(0, 3),
+                                             keyframes[k].pose(1, 3) - keyframes[k - 1].pose(1, 3));
+    int x = static_cast<int>(std::floor(keyframes[k].pose(0, 3) / search_radius_));
+    int y = static_cast<int>(std::floor(keyframes[k].pose(1, 3) / search_radius_));
+    grid[cellKey(x, y)].push_back(k);
+  }
+
+  // The closest keyframe at least min_travel behind is the candidate.
+  // Once a candidate is found, the next search_interval of the trajectory is not searched.
+  double last_search = -search_interval_;
+  for (size_t i = 0; i < keyframes.size(); i++)
+  {
+    if (travel[i] - last_search < search_interval_ || travel[i] < min_travel_)
+      continue;
+
+    double px = keyframes[i].pose(0, 3);
+    double py = keyframes[i].pose(1, 3);
+    int x = static_cast<int>(std::floor(px / search_radius_));
+    int y = static_cast<int>(std::floor(py / search_radius_));
+    double min_distance = search_radius_;
+    size_t closest = keyframes.size();
+    for (int dx = -1; dx <= 1; dx++)
+    {
+      for (int dy = -1; dy <= 1; dy++)
+      {
+        std::unordered_map<int64_t, std::vector<size_t> >::const_iterator cell = grid.find(cellKey(x + dx, y + dy));
+        if (cell == grid.end())
+          continue;
+        for (size_t n = 0; n < cell->second.size(); n++)
+        {
+          size_t j = cell->second[n];
+          if (travel[i] - travel[j] < min_travel_)
+            continue;
+          double distance = std::hypot(keyframes[j].pose(0, 3) - px, keyframes[j].pose(1, 3) - py);
+          if (distance <= min_distance)
+          {
+            min_distance = distance;
+            closest = j;
+          }
+        }
+      }
+    }
+    if (closest == keyframes.size())
+      continue;
+
+    Loop loop;
+    loop.from = closest;
+    loop.to = i;
+    loop.relative = Eigen::Matrix4f::Identity();
+    loop.fitness_score = 0.0;
+    candidates.push_back(loop);
+    last_search = travel[i];
+  }
+
+  std::vector<char> accepted(candidates.size(), 0);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < workers_; t++)
+  {
+    size_t begin = candidates.size() * t / workers_;
+    size_t end = candidates.size() * (t + 1) / workers_;
+    threads.push_back(std::thread(&LoopCloser::checkLoops, this, std::cref(keyframes), &candidates, &accepted, begin,
+                                  end));
+  }
+  for (size_t t = 0; t < threads.size(); t++)
+    threads[t].join();
+
+  LoopVector loops;
+  for (size_t c = 0; c < candidates.size(); c++)
+  {
+    if (accepted[c])
+      loops.push_back(candidates[c]);
+  }
+  std::cout << "Checked " << candidates.size() << " loop candidates, accepted " << loops.size() << "." << std::endl;
+  return loops;
+}
+
+void LoopCloser::checkLoops(
+    const std::vector<NdtMapper::Keyframe, Eigen::aligned_allocator<NdtMapper::Keyframe> >& keyframes,
+    LoopVector* candidates, std::vector<char>* accepted, size_t begin, size_t end) const
+{
+  pcl::NormalDistributionsTransform<pcl::PointXYZI, pcl::PointXYZI> ndt;
+  ndt.setTransformationEpsilon(trans_eps_);
+  ndt.setStepSize(step_size_);
+  ndt.setResolution(resolution_);
+  ndt.setMaximumIterations(max_iter_);
+
+  pcl::VoxelGrid<pcl::PointXYZI> voxel_grid_filter;
+  voxel_grid_filter.setLeafSize(leaf_size_, leaf_size_, leaf_size_);
+
+  for (size_t c = begin; c < end; c++)
+  {
+    Loop& loop = (*candidates)[c];
+    const NdtMapper::Keyframe& from = keyframes[loop.from];
+    const NdtMapper::Keyframe& to = keyframes[loop.to];
+
+    // the scan of the newer keyframe, back in its localizer frame
+    pcl::PointCloud<pcl::PointXYZI>::Ptr scan(new pcl::PointCloud<pcl::PointXYZI>());
+    pcl::transformPointCloud(*to.points, *scan, Eigen::Matrix4f(to.pose.inverse()));
+    pcl::PointCloud<pcl::PointXYZI>::Ptr filtered_scan(new pcl::PointCloud<pcl::PointXYZI>());
+    voxel_grid_filter.setInputCloud(scan);
+    voxel_grid_filter.filter(*filtered_scan);
+
+    // the keyframes around the older one, which are consistent with it
+    size_t submap_begin = loop.from > static_cast<size_t>(submap_size_) ? loop.from - submap_size_ : 0;
+    size_t submap_end = std::min(loop.from + submap_size_ + 1, keyframes.size());
+    pcl::PointCloud<pcl::PointXYZI>::Ptr submap(new pcl::PointCloud<pcl::PointXYZI>());
+    for (size_t k = submap_begin; k < submap_end; k++)
+      submap->points.insert(submap->points.end(), keyframes[k].points->points.begin(),
+                            keyframes[k].points->points.end());
+    submap->width = submap->points.size();
+    submap->height = 1;
+
+    if (filtered_scan->points.empty() || submap->points.empty())
+      continue;
+
+    // The drifted pose of the newer keyframe is the initial guess
+    pcl::PointCloud<pcl::PointXYZI> output_cloud;
+    ndt.setInputTarget(submap);
+    ndt.setInputSource(filtered_scan);
+    ndt.align(output_cloud, to.pose);
+
+    loop.fitness_score = ndt.getFitnessScore();
+    if (!ndt.hasConverged() || loop.fitness_score > max_fitness_score_)
+      continue;
+    loop.relative = from.pose.inverse() * ndt.getFinalTransformation();
+    (*accepted)[c] = 1;
+  }
+}
+
+bool LoopCloser::optimize(
+    const std::vector<NdtMapper::Keyframe, Eigen::aligned_allocator<NdtMapper::Keyframe> >& keyframes,
+    const LoopVector& loops, int iterations, PoseVector* poses) const
+{
+  PoseGraphPoseVector keyframe_poses(keyframes.size());
+  for (size_t k = 0; k < keyframes.size(); k++)
+    keyframe_poses[k] = keyframes[k].pose;
+
+  PoseGraphLoopVector graph_loops(loops.size());
+  for (size_t l = 0; l < loops.size(); l++)
+  {
+    graph_loops[l].from = loops[l].from;
+    graph_loops[l].to = loops[l].to;
+    graph_loops[l].relative = loops[l].relative;
+  }
+  return optimizePoseGraph(keyframe_poses, graph_loops, iterations, poses);
+}
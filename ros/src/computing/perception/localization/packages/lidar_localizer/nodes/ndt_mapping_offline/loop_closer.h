@@ -0,0 +1,83 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LOOP_CLOSER_H
+#define LOOP_CLOSER_H
+
+#include <vector>
+
+#include <Eigen/Core>
+#include <Eigen/StdVector>
+
+#include "ndt_mapper.h"
+#include "pose_graph.h"
+
+// Loop closure of the keyframes of NdtMapper.
+// The keyframes are the vertices of a pose graph, linked in order by the relative poses registered between them.
+// Loops are searched among the keyframes close to each other but far apart along the trajectory, checked by
+// registering the scan of one keyframe against the keyframes around the other, and added as edges.
+// The graph is then optimized by optimizePoseGraph(), the first keyframe being fixed.
+class LoopCloser
+{
+public:
+  struct Loop
+  {
+    size_t from;               // older keyframe
+    size_t to;                 // newer keyframe
+    Eigen::Matrix4f relative;  // pose of to in the frame of from
+    double fitness_score;
+
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  };
+  typedef std::vector<Loop, Eigen::aligned_allocator<Loop> > LoopVector;
+  typedef PoseGraphPoseVector PoseVector;
+
+  LoopCloser();
+
+  void setSearchRadius(double search_radius);        // keyframes closer than this in xy are loop candidates
+  void setMinTravel(double min_travel);              // ... if at least this far apart along the trajectory
+  void setSearchInterval(double search_interval);    // distance traveled between two keyframes searched for loops
+  void setSubmapSize(int submap_size);               // keyframes on each side of the candidate registered against
+  void setMaxFitnessScore(double max_fitness_score);  // loops with a higher fitness score are rejected
+  void setParameters(float resolution, double step_size, double trans_eps, int max_iter, double leaf_size);
+  void setWorkers(int workers);
+
+  // Finds and checks the loops of keyframes. The checks run in parallel, the loops are sorted by keyframe
+  LoopVector findLoops(const std::vector<NdtMapper::Keyframe, Eigen::aligned_allocator<NdtMapper::Keyframe> >&
+                           keyframes) const;
+
+  // Optimizes the poses of keyframes with loops. Returns false when the optimization failed
+  bool optimize(const std::vector<NdtMapper::Keyframe, Eigen::aligned_allocator<NdtMapper::Keyframe> >& keyframes,
+                const LoopVector& loops, int iterations, PoseVector* poses) const;
+
+private:
+  double search_radius_;
+  double min_travel_;
+  double search_interval_;
+  int submap_size_;
+  double max_fitness_score_;
+  float resolution_;
+  double step_size_;
+  double trans_eps_;
+  int max_iter_;
+  double leaf_size_;
+  int workers_;
+
+  void checkLoops(const std::vector<NdtMapper::Keyframe, Eigen::aligned_allocator<NdtMapper::Keyframe> >& keyframes,
+                  LoopVector* candidates, std::vector<char>* accepted, size_t begin, size_t end) const;
+};
+
+#endif  // LOOP_CLOSER_H
@@ -0,0 +1,897 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ Offline mapping with the registration of ndt_mapping.
+
+ The scans are read from a bag, with optional IMU and odometry, or from a directory of PCD files, as fast as the
+ CPU allows instead of in real time:
+ - a reader thread reads the bag and integrates the IMU and odometry between the scans,
+ - worker threads convert, range filter and downsample the scans,
+ - the main thread registers the scans in order and adds them to the map,
+ - with --loop_closure, the loops of the trajectory are found and checked in parallel, and the poses of the
+   keyframes added to the map are corrected by a pose graph optimization,
+ - at the end, the map is written as binary PCD tiles named like those of pcd_grid_divider, in parallel.
+ The poses of the scans are written to poses.csv in the output directory, and with --loop_closure the corrected
+ poses of the keyframes to keyframes.csv and the accepted loops to loops.csv.
+*/
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <Eigen/Geometry>
+
+#include <nav_msgs/Odometry.h>
+#include <ros/ros.h>
+#include <rosbag/bag.h>
+#include <rosbag/view.h>
+#include <sensor_msgs/Imu.h>
+#include <sensor_msgs/PointCloud2.h>
+#include <tf/transform_datatypes.h>
+
+#include <pcl/common/transforms.h>
+#include <pcl/filters/voxel_grid.h>
+#include <pcl/io/pcd_io.h>
+#include <pcl/point_types.h>
+#include <pcl_conversions/pcl_conversions.h>
+
+#include "ndt_mapper.h"
+#ifdef USE_G2O
+#include "loop_closer.h"
+#endif
+
+struct options
+{
+  std::string bag_path;
+  std::string pcd_dir;
+  std::string output_dir;
+  std::string points_topic = "/points_raw";
+  std::string imu_topic;
+  std::string odom_topic;
+  bool imu_upside_down = false;
+  double start = 0.0;     // seconds from the beginning of the bag
+  double duration = 0.0;  // 0 reads until the end
+
+  MethodType method_type = MethodType::PCL_GENERIC;
+  float ndt_res = 1.0;
+  double step_size = 0.1;
+  double trans_eps = 0.01;
+  int max_iter = 30;
+  double voxel_leaf_size = 2.0;
+  double min_scan_range = 5.0;
+  double max_scan_range = 200.0;
+  double min_add_scan_shift = 1.0;
+  double local_map_radius = 100.0;
+  bool incremental_voxel_update = false;
+  double tf_x = 0.0, tf_y = 0.0, tf_z = 0.0, tf_roll = 0.0, tf_pitch = 0.0, tf_yaw = 0.0;
+
+  bool loop_closure = false;
+  double loop_search_radius = 10.0;
+  double loop_min_travel = 50.0;
+  double loop_search_interval = 5.0;
+  int loop_submap_size = 10;
+  float loop_resolution = 2.0;
+  double loop_max_fitness_score = 1.0;
+  int loop_iterations = 20;
+
+  int workers = 2;
+  int tile_size = 100;  // meters, 0 writes a single map.pcd
+  double filter_res = 0.0;
+};
+
+// A scan on its way through the pipeline
+struct scan_frame
+{
+  size_t seq;
+  double stamp;
+  sensor_msgs::PointCloud2::ConstPtr msg;  // from the bag
+  std::string pcd_path;                    // or from a PCD file
+
+  // motion of base_link since the previous scan, integrated from the IMU (rotation) and the odometry (translation)
+  Eigen::Matrix4f motion;
+  bool has_rotation;
+  bool has_translation;
+
+  bool valid;
+  pcl::PointCloud<pcl::PointXYZI>::Ptr scan;           // range filtered, in the localizer frame
+  pcl::PointCloud<pcl::PointXYZI>::Ptr filtered_scan;  // downsampled for registration
+
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+typedef boost::shared_ptr<scan_frame> scan_frame_ptr;
+
+// Bounded FIFO between the reader and the workers
+class frame_queue
+{
+public:
+  explicit frame_queue(size_t capacity) : capacity_(capacity), closed_(false)
+  {
+  }
+
+  void push(const scan_frame_ptr& frame)
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    not_full_.wait(lock, [this] { return frames_.size() < capacity_; });
+    frames_.push_back(frame);
+    not_empty_.notify_one();
+  }
+
+  // returns false once the queue is closed and empty
+  bool pop(scan_frame_ptr* frame)
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    not_empty_.wait(lock, [this] { return !frames_.empty() || closed_; });
+    if (frames_.empty())
+      return false;
+    *frame = frames_.front();
+    frames_.pop_front();
+    not_full_.notify_one();
+    return true;
+  }
+
+  void close()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = true;
+    not_empty_.notify_all();
+  }
+
+private:
+  size_t capacity_;
+  bool closed_;
+  std::deque<scan_frame_ptr> frames_;
+  std::mutex mutex_;
+  std::condition_variable not_empty_, not_full_;
+};
+
+// Puts the frames finished by the workers back in order for registration.
+// A worker waits when its frame is more than capacity ahead of the next one to register.
+class reorder_buffer
+{
+public:
+  explicit reorder_buffer(size_t capacity) : capacity_(capacity), next_(0), closed_(false)
+  {
+  }
+
+  void push(const scan_frame_ptr& frame)
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    can_push_.wait(lock, [this, &frame] { return frame->seq < next_ + capacity_; });
+    frames_[frame->seq] = frame;
+    can_pop_.notify_all();
+  }
+
+  // returns false once all the frames have been popped
+  bool pop(scan_frame_ptr* frame)
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    can_pop_.wait(lock, [this] { return frames_.count(next_) > 0 || (closed_ && frames_.empty()); });
+    std::map<size_t, scan_frame_ptr>::iterator item = frames_.find(next_);
+    if (item == frames_.end())
+      return false;
+    *frame = item->second;
+    frames_.erase(item);
+    next_++;
+    can_push_.notify_all();
+    return true;
+  }
+
+  void close()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = true;
+    can_pop_.notify_all();
+  }
+
+private:
+  size_t capacity_;
+  size_t next_;
+  bool closed_;
+  std::map<size_t, scan_frame_ptr> frames_;
+  std::mutex mutex_;
+  std::condition_variable can_pop_, can_push_;
+};
+
+// Integrates the angular velocity of the IMU and the linear velocity of the odometry between two scans
+class motion_integrator
+{
+public:
+  motion_integrator()
+    : motion_(Eigen::Affine3f::Identity())
+    , angular_velocity_(Eigen::Vector3f::Zero())
+    , linear_velocity_(0.0f)
+    , last_stamp_(-1.0)
+    , has_rotation_(false)
+    , has_translation_(false)
+  {
+  }
+
+  void add_imu(const sensor_msgs::Imu& imu, bool upside_down)
+  {
+    integrate(imu.header.stamp.toSec());
+    float sign = upside_down ? -1.0f : 1.0f;
+    angular_velocity_ = sign * Eigen::Vector3f(imu.angular_velocity.x, imu.angular_velocity.y, imu.angular_velocity.z);
+    has_rotation_ = true;
+  }
+
+  void add_odom(const nav_msgs::Odometry& odom, bool use_angular_velocity)
+  {
+    integrate(odom.header.stamp.toSec());
+    linear_velocity_ = odom.twist.twist.linear.x;
+    if (use_angular_velocity)
+    {
+      angular_velocity_ =
+          Eigen::Vector3f(odom.twist.twist.angular.x, odom.twist.twist.angular.y, odom.twist.twist.angular.z);
+      has_rotation_ = true;
+    }
+    has_translation_ = true;
+  }
+
+  // motion since the previous scan, then restarts from the scan
+  void take(double stamp, scan_frame* frame)
+  {
+    integrate(stamp);
+    frame->motion = motion_.matrix();
+    frame->has_rotation = has_rotation_;
+    frame->has_translation = has_translation_;
+    motion_ = Eigen::Affine3f::Identity();
+  }
+
+private:
+  Eigen::Affine3f motion_;
+  Eigen::Vector3f angular_velocity_;
+  float linear_velocity_;
+  double last_stamp_;
+  bool has_rotation_;
+  bool has_translation_;
+
+  void integrate(double stamp)
+  {
+    double dt = last_stamp_ < 0.0 ? 0.0 : stamp - last_stamp_;
+    if (dt < 0.0)  // messages of different topics slightly out of order
+      return;
+    last_stamp_ = stamp;
+    if (dt == 0.0)
+      return;
+
+    float angle = angular_velocity_.norm() * dt;
+    motion_ = motion_ * Eigen::Translation3f(linear_velocity_ * dt, 0.0f, 0.0f);
+    if (angle > 0.0f)
+      motion_ = motion_ * Eigen::AngleAxisf(angle, angular_velocity_.normalized());
+  }
+};
+
+typedef std::vector<Eigen::Vector4f, Eigen::aligned_allocator<Eigen::Vector4f> > bounds_vector;
+
+static options opts;
+static frame_queue* raw_frames;
+static reorder_buffer* ready_frames;
+
+static void read_bag()
+{
+  rosbag::Bag bag;
+  try
+  {
+    bag.open(opts.bag_path, rosbag::bagmode::Read);
+  }
+  catch (rosbag::BagException& e)
+  {
+    std::cerr << "Could not open " << opts.bag_path << ": " << e.what() << std::endl;
+    raw_frames->close();
+    return;
+  }
+
+  std::vector<std::string> topics;
+  topics.push_back(opts.points_topic);
+  if (!opts.imu_topic.empty())
+    topics.push_back(opts.imu_topic);
+  if (!opts.odom_topic.empty())
+    topics.push_back(opts.odom_topic);
+
+  rosbag::View bag_info(bag);
+  ros::Time begin = bag_info.getBeginTime() + ros::Duration(opts.start);
+  ros::Time end = opts.duration > 0.0 ? begin + ros::Duration(opts.duration) : ros::TIME_MAX;
+  rosbag::View view(bag, rosbag::TopicQuery(topics), begin, end);
+
+  motion_integrator integrator;
+  size_t seq = 0;
+  for (rosbag::View::iterator item = view.begin(); item != view.end(); item++)
+  {
+    const rosbag::MessageInstance& m = *item;
+    if (m.getTopic() == opts.points_topic)
+    {
+      sensor_msgs::PointCloud2::ConstPtr msg = m.instantiate<sensor_msgs::PointCloud2>();
+      if (!msg)
+        continue;
+      scan_frame_ptr frame(new scan_frame());
+      frame->seq = seq++;
+      frame->stamp = msg->header.stamp.toSec();
+      frame->msg = msg;
+      integrator.take(frame->stamp, frame.get());
+      raw_frames->push(frame);
+    }
+    else if (m.getTopic() == opts.imu_topic)
+    {
+      sensor_msgs::Imu::ConstPtr imu = m.instantiate<sensor_msgs::Imu>();
+      if (imu)
+        integrator.add_imu(*imu, opts.imu_upside_down);
+    }
+    else if (m.getTopic() == opts.odom_topic)
+    {
+      nav_msgs::Odometry::ConstPtr odom = m.instantiate<nav_msgs::Odometry>();
+      if (odom)
+        integrator.add_odom(*odom, opts.imu_topic.empty());
+    }
+  }
+  bag.close();
+  raw_frames->close();
+}
+
+static void read_pcd_dir()
+{
+  std::vector<std::string> paths;
+  for (boost::filesystem::directory_iterator item(opts.pcd_dir); item != boost::filesystem::directory_iterator();
+       item++)
+  {
+    if (item->path().extension() == ".pcd")
+      paths.push_back(item->path().string());
+  }
+  std::sort(paths.begin(), paths.end());
+
+  for (size_t i = 0; i < paths.size(); i++)
+  {
+    scan_frame_ptr frame(new scan_frame());
+    frame->seq = i;
+    frame->stamp = 0.0;
+    frame->pcd_path = paths[i];
+    frame->motion = Eigen::Matrix4f::Identity();
+    frame->has_rotation = false;
+    frame->has_translation = false;
+    raw_frames->push(frame);
+  }
+  raw_frames->close();
+}
+
+static void preprocess()
+{
+  scan_frame_ptr frame;
+  while (raw_frames->pop(&frame))
+  {
+    pcl::PointCloud<pcl::PointXYZI> tmp;
+    frame->valid = true;
+    if (frame->msg)
+    {
+      pcl::fromROSMsg(*frame->msg, tmp);
+      frame->msg.reset();
+    }
+    else if (pcl::io::loadPCDFile<pcl::PointXYZI>(frame->pcd_path, tmp) == -1)
+    {
+      std::cerr << "Could not load " << frame->pcd_path << "." << std::endl;
+      frame->valid = false;
+    }
+
+    frame->scan.reset(new pcl::PointCloud<pcl::PointXYZI>());
+    frame->scan->points.reserve(tmp.points.size());
+    for (pcl::PointCloud<pcl::PointXYZI>::const_iterator item = tmp.begin(); item != tmp.end(); item++)
+    {
+      double r = sqrt(pow(item->x, 2.0) + pow(item->y, 2.0));
+      if (opts.min_scan_range < r && r < opts.max_scan_range)
+        frame->scan->points.push_back(*item);
+    }
+    frame->scan->width = frame->scan->points.size();
+    frame->scan->height = 1;
+
+    frame->filtered_scan.reset(new pcl::PointCloud<pcl::PointXYZI>());
+    pcl::VoxelGrid<pcl::PointXYZI> voxel_grid_filter;
+    voxel_grid_filter.setLeafSize(opts.voxel_leaf_size, opts.voxel_leaf_size, opts.voxel_leaf_size);
+    voxel_grid_filter.setInputCloud(frame->scan);
+    voxel_grid_filter.filter(*frame->filtered_scan);
+    if (frame->filtered_scan->points.empty())
+      frame->valid = false;
+
+    ready_frames->push(frame);
+  }
+}
+
+static void get_rpy(const Eigen::Matrix4f& t, double* roll, double* pitch, double* yaw)
+{
+  tf::Matrix3x3 mat;
+  mat.setValue(t(0, 0), t(0, 1), t(0, 2), t(1, 0), t(1, 1), t(1, 2), t(2, 0), t(2, 1), t(2, 2));
+  mat.getRPY(*roll, *pitch, *yaw, 1);
+}
+
+// Writes the points of the tiles in [begin, end) of tiles, each gathered from the keyframes that overlap it
+static void write_tiles(const NdtMapper& mapper, const bounds_vector& bounds,
+                        const std::vector<std::pair<int, int> >& tiles, size_t begin, size_t end, size_t* points_num)
+{
+  const std::vector<NdtMapper::Keyframe, Eigen::aligned_allocator<NdtMapper::Keyframe> >& keyframes =
+      mapper.getKeyframes();
+  for (size_t i = begin; i < end; i++)
+  {
+    float min_x = static_cast<float>(tiles[i].first) * opts.tile_size;
+    float min_y = static_cast<float>(tiles[i].second) * opts.tile_size;
+    float max_x = min_x + opts.tile_size;
+    float max_y = min_y + opts.tile_size;
+
+    pcl::PointCloud<pcl::PointXYZI>::Ptr tile(new pcl::PointCloud<pcl::PointXYZI>());
+    for (size_t k = 0; k < keyframes.size(); k++)
+    {
+      if (bounds[k](0) >= max_x || bounds[k](2) < min_x || bounds[k](1) >= max_y || bounds[k](3) < min_y)
+        continue;
+      const pcl::PointCloud<pcl::PointXYZI>& points = *keyframes[k].points;
+      for (size_t p = 0; p < points.size(); p++)
+      {
+        const pcl::PointXYZI& point = points.points[p];
+        if (min_x <= point.x && point.x < max_x && min_y <= point.y && point.y < max_y)
+          tile->points.push_back(point);
+      }
+    }
+    tile->width = tile->points.size();
+    tile->height = 1;
+
+    if (opts.filter_res > 0.0)
+    {
+      pcl::PointCloud<pcl::PointXYZI>::Ptr filtered_tile(new pcl::PointCloud<pcl::PointXYZI>());
+      pcl::VoxelGrid<pcl::PointXYZI> voxel_grid_filter;
+      voxel_grid_filter.setLeafSize(opts.filter_res, opts.filter_res, opts.filter_res);
+      voxel_grid_filter.setInputCloud(tile);
+      voxel_grid_filter.filter(*filtered_tile);
+      tile = filtered_tile;
+    }
+
+    if (tile->points.empty())
+      continue;
+    std::string filename = opts.output_dir + "/" + std::to_string(opts.tile_size) + "_" +
+                           std::to_string(tiles[i].first * opts.tile_size) + "_" +
+                           std::to_string(tiles[i].second * opts.tile_size) + ".pcd";
+    pcl::io::savePCDFileBinary(filename, *tile);
+    *points_num += tile->points.size();
+  }
+}
+
+#ifdef USE_G2O
+// Corrects the keyframes of mapper with the loops found in them. Returns false when no loop was closed
+static bool close_loops(NdtMapper* mapper, const std::vector<size_t>& keyframe_seqs, const Eigen::Matrix4f& tf_ltob)
+{
+  LoopCloser loop_closer;
+  loop_closer.setSearchRadius(opts.loop_search_radius);
+  loop_closer.setMinTravel(opts.loop_min_travel);
+  loop_closer.setSearchInterval(opts.loop_search_interval);
+  loop_closer.setSubmapSize(opts.loop_submap_size);
+  loop_closer.setMaxFitnessScore(opts.loop_max_fitness_score);
+  loop_closer.setParameters(opts.loop_resolution, opts.step_size, opts.trans_eps, opts.max_iter, opts.voxel_leaf_size);
+  loop_closer.setWorkers(std::max(1u, std::thread::hardware_concurrency()));
+
+  std::chrono::steady_clock::time_point wall_start = std::chrono::steady_clock::now();
+  LoopCloser::LoopVector loops = loop_closer.findLoops(mapper->getKeyframes());
+
+  std::string loops_filename = opts.output_dir + "/loops.csv";
+  std::ofstream loops_ofs(loops_filename.c_str());
+  loops_ofs << "from_seq,to_seq,fitness_score" << std::endl;
+  for (size_t l = 0; l < loops.size(); l++)
+    loops_ofs << keyframe_seqs[loops[l].from] << "," << keyframe_seqs[loops[l].to] << "," << std::fixed
+              << std::setprecision(5) << loops[l].fitness_score << std::endl;
+  loops_ofs.close();
+  if (loops.empty())
+    return false;
+
+  LoopCloser::PoseVector poses;
+  if (!loop_closer.optimize(mapper->getKeyframes(), loops, opts.loop_iterations, &poses))
+  {
+    std::cerr << "The pose graph optimization failed, the map is not corrected." << std::endl;
+    return false;
+  }
+
+  // the keyframes are independent, so they are moved in parallel
+  int threads_num = std::max(1u, std::thread::hardware_concurrency());
+  std::vector<std::thread> threads;
+  for (int t = 0; t < threads_num; t++)
+  {
+    size_t begin = poses.size() * t / threads_num;
+    size_t end = poses.size() * (t + 1) / threads_num;
+    threads.push_back(std::thread([mapper, &poses, begin, end] {
+      for (size_t k = begin; k < end; k++)
+        mapper->setKeyframePose(k, poses[k]);
+    }));
+  }
+  for (int t = 0; t < threads_num; t++)
+    threads[t].join();
+
+  std::string keyframes_filename = opts.output_dir + "/keyframes.csv";
+  std::ofstream keyframes_ofs(keyframes_filename.c_str());
+  keyframes_ofs << "seq,x,y,z,roll,pitch,yaw" << std::endl;
+  for (size_t k = 0; k < poses.size(); k++)
+  {
+    Eigen::Matrix4f t_base_link = poses[k] * tf_ltob;
+    double roll, pitch, yaw;
+    get_rpy(t_base_link, &roll, &pitch, &yaw);
+    keyframes_ofs << keyframe_seqs[k] << "," << std::fixed << std::setprecision(5) << t_base_link(0, 3) << ","
+                  << t_base_link(1, 3) << "," << t_base_link(2, 3) << "," << roll << "," << pitch << "," << yaw
+                  << std::endl;
+  }
+  keyframes_ofs.close();
+
+  double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+  std::cout << "Closed " << loops.size() << " loops over " << poses.size() << " keyframes in " << wall << " s."
+            << std::endl;
+  return true;
+}
+#endif
+
+static void write_map(const NdtMapper& mapper)
+{
+  const std::vector<NdtMapper::Keyframe, Eigen::aligned_allocator<NdtMapper::Keyframe> >& keyframes =
+      mapper.getKeyframes();
+
+  if (opts.tile_size <= 0)
+  {
+    pcl::PointCloud<pcl::PointXYZI>::Ptr map(new pcl::PointCloud<pcl::PointXYZI>());
+    mapper.getMap(map.get());
+    if (opts.filter_res > 0.0)
+    {
+      pcl::PointCloud<pcl::PointXYZI>::Ptr map_filtered(new pcl::PointCloud<pcl::PointXYZI>());
+      pcl::VoxelGrid<pcl::PointXYZI> voxel_grid_filter;
+      voxel_grid_filter.setLeafSize(opts.filter_res, opts.filter_res, opts.filter_res);
+      voxel_grid_filter.setInputCloud(map);
+      voxel_grid_filter.filter(*map_filtered);
+      map = map_filtered;
+    }
+    std::string filename = opts.output_dir + "/map.pcd";
+    pcl::io::savePCDFileBinary(filename, *map);
+    std::cout << "Saved " << map->points.size() << " points to " << filename << "." << std::endl;
+    return;
+  }
+
+  // xy bounds of each keyframe (min_x, min_y, max_x, max_y), and the tiles they overlap
+  bounds_vector bounds(keyframes.size());
+  std::set<std::pair<int, int> > tile_set;
+  for (size_t k = 0; k < keyframes.size(); k++)
+  {
+    Eigen::Vector4f& b = bounds[k];
+    b << FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX;
+    const pcl::PointCloud<pcl::PointXYZI>& points = *keyframes[k].points;
+    for (size_t p = 0; p < points.size(); p++)
+    {
+      b(0) = std::min(b(0), points.points[p].x);
+      b(1) = std::min(b(1), points.points[p].y);
+      b(2) = std::max(b(2), points.points[p].x);
+      b(3) = std::max(b(3), points.points[p].y);
+    }
+    if (points.empty())
+      continue;
+    int tile_max_x = static_cast<int>(std::floor(b(2) / opts.tile_size));
+    int tile_max_y = static_cast<int>(std::floor(b(3) / opts.tile_size));
+    for (int x = static_cast<int>(std::floor(b(0) / opts.tile_size)); x <= tile_max_x; x++)
+      for (int y = static_cast<int>(std::floor(b(1) / opts.tile_size)); y <= tile_max_y; y++)
+        tile_set.insert(std::make_pair(x, y));
+  }
+  std::vector<std::pair<int, int> > tiles(tile_set.begin(), tile_set.end());
+
+  int threads_num = std::max(1u, std::thread::hardware_concurrency());
+  std::vector<size_t> points_num(threads_num, 0);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < threads_num; t++)
+  {
+    size_t begin = tiles.size() * t / threads_num;
+    size_t end = tiles.size() * (t + 1) / threads_num;
+    threads.push_back(std::thread(write_tiles, std::cref(mapper), std::cref(bounds), std::cref(tiles), begin, end,
+                                  &points_num[t]));
+  }
+  size_t total = 0;
+  for (int t = 0; t < threads_num; t++)
+  {
+    threads[t].join();
+    total += points_num[t];
+  }
+  std::cout << "Saved " << total << " points to the tiles in " << opts.output_dir << "." << std::endl;
+}
+
+static void print_usage()
+{
+  std::printf("Usage: ndt_mapping_offline (--bag FILE | --pcd_dir DIR) --output_dir DIR [options]\n"
+              "  --bag FILE                    bag with the scans, and optionally the IMU and the odometry\n"
+              "  --pcd_dir DIR                 directory of scans as PCD files, registered in file name order\n"
+              "  --output_dir DIR              where the map tiles and poses.csv are written\n"
+              "  --points_topic TOPIC          (default /points_raw)\n"
+              "  --imu_topic TOPIC             IMU used for the rotation between scans (default none)\n"
+              "  --odom_topic TOPIC            odometry used for the translation between scans (default none)\n"
+              "  --imu_upside_down\n"
+              "  --start S, --duration S       part of the bag to read, in seconds\n"
+              "  --method_type N               pcl_generic=0, pcl_anh=1, pcl_anh_gpu=2, pcl_openmp=3 (default 0)\n"
+              "  --resolution, --step_size, --trans_epsilon, --max_iterations, --leaf_size, --min_scan_range,\n"
+              "  --max_scan_range, --min_add_scan_shift, --local_map_radius, --incremental_voxel_update\n"
+              "                                same as ndt_mapping\n"
+              "  --tf_x, --tf_y, --tf_z, --tf_roll, --tf_pitch, --tf_yaw\n"
+              "                                base_link to localizer transform\n"
+              "  --workers N                   threads converting and downsampling the scans (default 2)\n"
+              "  --tile_size M                 size of the map tiles in meters, 0 writes a single map.pcd (default 100)\n"
+              "  --filter_res R                voxel grid applied to the written map (default 0, none)\n"
+              "  --loop_closure                correct the keyframes with the loops of the trajectory\n"
+              "  --loop_search_radius M        keyframes closer than this are loop candidates (default 10)\n"
+              "  --loop_min_travel M           ... if at least this far apart along the trajectory (default 50)\n"
+              "  --loop_search_interval M      trajectory skipped after each loop candidate (default 5)\n"
+              "  --loop_submap_size N          keyframes on each side of the candidate to register against (default 10)\n"
+              "  --loop_resolution R           NDT resolution of the loop checks (default 2)\n"
+              "  --loop_max_fitness_score S    loops with a higher fitness score are rejected (default 1)\n"
+              "  --loop_iterations N           iterations of the pose graph optimization (default 20)\n");
+}
+
+static bool parse_options(int argc, char** argv)
+{
+  int method_type = 0;
+  for (int i = 1; i < argc; i++)
+  {
+    std::string arg = argv[i];
+    bool has_value = i + 1 < argc;
+    if (arg == "--imu_upside_down")
+      opts.imu_upside_down = true;
+    else if (arg == "--incremental_voxel_update")
+      opts.incremental_voxel_update = true;
+    else if (arg == "--loop_closure")
+      opts.loop_closure = true;
+    else if (!has_value)
+      return false;
+    else if (arg == "--bag")
+      opts.bag_path = argv[++i];
+    else if (arg == "--pcd_dir")
+      opts.pcd_dir = argv[++i];
+    else if (arg == "--output_dir")
+      opts.output_dir = argv[++i];
+    else if (arg == "--points_topic")
+      opts.points_topic = argv[++i];
+    else if (arg == "--imu_topic")
+      opts.imu_topic = argv[++i];
+    else if (arg == "--odom_topic")
+      opts.odom_topic = argv[++i];
+    else if (arg == "--start")
+      opts.start = std::atof(argv[++i]);
+    else if (arg == "--duration")
+      opts.duration = std::atof(argv[++i]);
+    else if (arg == "--method_type")
+      method_type = std::atoi(argv[++i]);
+    else if (arg == "--resolution")
+      opts.ndt_res = std::atof(argv[++i]);
+    else if (arg == "--step_size")
+      opts.step_size = std::atof(argv[++i]);
+    else if (arg == "--trans_epsilon")
+      opts.trans_eps = std::atof(argv[++i]);
+    else if (arg == "--max_iterations")
+      opts.max_iter = std::atoi(argv[++i]);
+    else if (arg == "--leaf_size")
+      opts.voxel_leaf_size = std::atof(argv[++i]);
+    else if (arg == "--min_scan_range")
+      opts.min_scan_range = std::atof(argv[++i]);
+    else if (arg == "--max_scan_range")
+      opts.max_scan_range = std::atof(argv[++i]);
+    else if (arg == "--min_add_scan_shift")
+      opts.min_add_scan_shift = std::atof(argv[++i]);
+    else if (arg == "--local_map_radius")
+      opts.local_map_radius = std::atof(argv[++i]);
+    else if (arg == "--tf_x")
+      opts.tf_x = std::atof(argv[++i]);
+    else if (arg == "--tf_y")
+      opts.tf_y = std::atof(argv[++i]);
+    else if (arg == "--tf_z")
+      opts.tf_z = std::atof(argv[++i]);
+    else if (arg == "--tf_roll")
+      opts.tf_roll = std::atof(argv[++i]);
+    else if (arg == "--tf_pitch")
+      opts.tf_pitch = std::atof(argv[++i]);
+    else if (arg == "--tf_yaw")
+      opts.tf_yaw = std::atof(argv[++i]);
+    else if (arg == "--workers")
+      opts.workers = std::max(1, std::atoi(argv[++i]));
+    else if (arg == "--tile_size")
+      opts.tile_size = std::atoi(argv[++i]);
+    else if (arg == "--filter_res")
+      opts.filter_res = std::atof(argv[++i]);
+    else if (arg == "--loop_search_radius")
+      opts.loop_search_radius = std::atof(argv[++i]);
+    else if (arg == "--loop_min_travel")
+      opts.loop_min_travel = std::atof(argv[++i]);
+    else if (arg == "--loop_search_interval")
+      opts.loop_search_interval = std::atof(argv[++i]);
+    else if (arg == "--loop_submap_size")
+      opts.loop_submap_size = std::max(0, std::atoi(argv[++i]));
+    else if (arg == "--loop_resolution")
+      opts.loop_resolution = std::atof(argv[++i]);
+    else if (arg == "--loop_max_fitness_score")
+      opts.loop_max_fitness_score = std::atof(argv[++i]);
+    else if (arg == "--loop_iterations")
+      opts.loop_iterations = std::atoi(argv[++i]);
+    else
+      return false;
+  }
+  opts.method_type = static_cast<MethodType>(method_type);
+
+  if (opts.bag_path.empty() == opts.pcd_dir.empty() || opts.output_dir.empty())
+    return false;
+#ifndef CUDA_FOUND
+  if (opts.method_type == MethodType::PCL_ANH_GPU)
+  {
+    std::cerr << "[ERROR]PCL_ANH_GPU is not built. Please use other method type." << std::endl;
+    return false;
+  }
+#endif
+#ifndef USE_PCL_OPENMP
+  if (opts.method_type == MethodType::PCL_OPENMP)
+  {
+    std::cerr << "[ERROR]PCL_OPENMP is not built. Please use other method type." << std::endl;
+    return false;
+  }
+#endif
+#ifndef USE_G2O
+  if (opts.loop_closure)
+  {
+    std::cerr << "[ERROR]Loop closure is not built, as g2o was not found." << std::endl;
+    return false;
+  }
+#endif
+  return true;
+}
+
+int main(int argc, char** argv)
+{
+  if (!parse_options(argc, argv))
+  {
+    print_usage();
+    return 2;
+  }
+  ros::Time::init();
+
+  boost::filesystem::create_directories(opts.output_dir);
+  std::string poses_filename = opts.output_dir + "/poses.csv";
+  std::ofstream ofs(poses_filename.c_str());
+  if (!ofs)
+  {
+    std::cerr << "Could not open " << poses_filename << "." << std::endl;
+    return 1;
+  }
+  ofs << "seq,stamp,x,y,z,roll,pitch,yaw,added,final_num_iteration,fitness_score,has_converged" << std::endl;
+
+  Eigen::Translation3f tl_btol(opts.tf_x, opts.tf_y, opts.tf_z);
+  Eigen::AngleAxisf rot_x_btol(opts.tf_roll, Eigen::Vector3f::UnitX());
+  Eigen::AngleAxisf rot_y_btol(opts.tf_pitch, Eigen::Vector3f::UnitY());
+  Eigen::AngleAxisf rot_z_btol(opts.tf_yaw, Eigen::Vector3f::UnitZ());
+  Eigen::Matrix4f tf_btol = (tl_btol * rot_z_btol * rot_y_btol * rot_x_btol).matrix();
+  Eigen::Matrix4f tf_ltob = tf_btol.inverse();
+
+  NdtMapper mapper;
+  mapper.setMethodType(opts.method_type);
+  mapper.setIncrementalVoxelUpdate(opts.incremental_voxel_update);
+  mapper.setLocalMapRadius(opts.local_map_radius);
+  mapper.setParameters(opts.ndt_res, opts.step_size, opts.trans_eps, opts.max_iter);
+
+  // the queues hold a few frames per worker, so reading never runs far ahead of registration
+  frame_queue raw_frame_queue(4 * opts.workers);
+  reorder_buffer ready_frame_buffer(4 * opts.workers);
+  raw_frames = &raw_frame_queue;
+  ready_frames = &ready_frame_buffer;
+
+  std::thread reader(opts.bag_path.empty() ? read_pcd_dir : read_bag);
+  std::vector<std::thread> workers;
+  for (int i = 0; i < opts.workers; i++)
+    workers.push_back(std::thread(preprocess));
+  std::thread closer([&workers] {
+    for (size_t i = 0; i < workers.size(); i++)
+      workers[i].join();
+    ready_frames->close();
+  });
+
+  std::chrono::steady_clock::time_point wall_start = std::chrono::steady_clock::now();
+  Eigen::Matrix4f previous_base_link(Eigen::Matrix4f::Identity());
+  Eigen::Matrix4f current_base_link(Eigen::Matrix4f::Identity());
+  Eigen::Matrix4f added_base_link(Eigen::Matrix4f::Identity());
+  double first_stamp = -1.0, last_stamp = 0.0;
+  size_t registered_num = 0;
+  std::vector<size_t> keyframe_seqs;  // seq of the scan of each keyframe
+
+  scan_frame_ptr frame;
+  while (ready_frames->pop(&frame))
+  {
+    if (!frame->valid)
+      continue;
+
+    if (mapper.isEmpty())
+    {
+      pcl::PointCloud<pcl::PointXYZI>::Ptr initial_scan(new pcl::PointCloud<pcl::PointXYZI>());
+      pcl::transformPointCloud(*frame->scan, *initial_scan, tf_btol);
+      mapper.addScan(initial_scan, tf_btol);
+      keyframe_seqs.push_back(frame->seq);
+    }
+
+    // Without the IMU or the odometry, the motion since the previous scan is assumed to be the same as before
+    Eigen::Matrix4f motion = previous_base_link.inverse() * current_base_link;
+    if (frame->has_rotation)
+      motion.block<3, 3>(0, 0) = frame->motion.block<3, 3>(0, 0);
+    if (frame->has_translation)
+      motion.block<3, 1>(0, 3) = frame->motion.block<3, 1>(0, 3);
+    Eigen::Matrix4f init_guess = current_base_link * motion * tf_btol;
+
+    Eigen::Matrix4f t_localizer = mapper.align(frame->filtered_scan, init_guess);
+    Eigen::Matrix4f t_base_link = t_localizer * tf_ltob;
+    previous_base_link = current_base_link;
+    current_base_link = t_base_link;
+
+    double shift = std::hypot(t_base_link(0, 3) - added_base_link(0, 3), t_base_link(1, 3) - added_base_link(1, 3));
+    bool added = shift >= opts.min_add_scan_shift;
+    if (added)
+    {
+      pcl::PointCloud<pcl::PointXYZI>::Ptr transformed_scan(new pcl::PointCloud<pcl::PointXYZI>());
+      pcl::transformPointCloud(*frame->scan, *transformed_scan, t_localizer);
+      mapper.addScan(transformed_scan, t_localizer);
+      keyframe_seqs.push_back(frame->seq);
+      added_base_link = t_base_link;
+    }
+
+    double roll, pitch, yaw;
+    get_rpy(t_base_link, &roll, &pitch, &yaw);
+    ofs << frame->seq << "," << std::fixed << std::setprecision(6) << frame->stamp << "," << std::setprecision(5)
+        << t_base_link(0, 3) << "," << t_base_link(1, 3) << "," << t_base_link(2, 3) << "," << roll << "," << pitch
+        << "," << yaw << "," << added << "," << mapper.getFinalNumIteration() << "," << mapper.getFitnessScore()
+        << "," << mapper.hasConverged() << std::endl;
+
+    if (first_stamp < 0.0)
+      first_stamp = frame->stamp;
+    last_stamp = frame->stamp;
+    registered_num++;
+    if (registered_num % 100 == 0)
+    {
+      double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+      std::cout << "Registered " << registered_num << " scans (" << registered_num / wall << " scans/s";
+      if (last_stamp > first_stamp)
+        std::cout << ", " << (last_stamp - first_stamp) / wall << "x real time";
+      std::cout << "), map: " << mapper.getMapSize() << " points, local map: " << mapper.getLocalMap().size()
+                << " points." << std::endl;
+    }
+  }
+  reader.join();
+  closer.join();
+  ofs.close();
+
+  double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+  std::cout << "Registered " << registered_num << " scans in " << wall << " s, " << mapper.getKeyframes().size()
+            << " added to the map." << std::endl;
+  std::cout << "Saved the poses to " << poses_filename << "." << std::endl;
+
+#ifdef USE_G2O
+  if (opts.loop_closure && !mapper.isEmpty())
+    close_loops(&mapper, keyframe_seqs, tf_ltob);
+#endif
+
+  if (!mapper.isEmpty())
+    write_map(mapper);
+
+  return 0;
+}
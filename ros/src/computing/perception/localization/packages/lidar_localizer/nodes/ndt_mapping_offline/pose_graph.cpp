@@ -0,0 +1,143 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "pose_graph.h"
+
+#include <cmath>
+#include <memory>
+
+#include <g2o/core/base_binary_edge.h>
+#include <g2o/core/block_solver.h>
+#include <g2o/core/optimization_algorithm_levenberg.h>
+#include <g2o/core/robust_kernel_impl.h>
+#include <g2o/core/sparse_optimizer.h>
+#include <g2o/solvers/eigen/linear_solver_eigen.h>
+#include <g2o/types/sba/types_six_dof_expmap.h>
+
+// Standard deviations of the registered relative poses, in meters and radians
+static const double ODOMETRY_TRANSLATION_STDDEV = 0.05;
+static const double ODOMETRY_ROTATION_STDDEV = 0.005;
+static const double LOOP_TRANSLATION_STDDEV = 0.1;
+static const double LOOP_ROTATION_STDDEV = 0.01;
+// Loops beyond the 95% chi2 bound with 6 degrees of freedom are down weighted
+static const double LOOP_HUBER_DELTA = std::sqrt(12.592);
+
+namespace
+{
+typedef Eigen::Matrix<double, 6, 6> InformationMatrix;
+
+// Relative pose of the second vertex in the frame of the first one.
+// The error is in the tangent space of the SE3 poses, rotation first as in SE3Quat::log().
+class EdgeSE3Relative : public g2o::BaseBinaryEdge<6, g2o::SE3Quat, g2o::VertexSE3Expmap, g2o::VertexSE3Expmap>
+{
+public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  bool read(std::istream& is)
+  {
+    return false;
+  }
+
+  bool write(std::ostream& os) const
+  {
+    return false;
+  }
+
+  void computeError()
+  {
+    const g2o::VertexSE3Expmap* from = static_cast<const g2o::VertexSE3Expmap*>(_vertices[0]);
+    const g2o::VertexSE3Expmap* to = static_cast<const g2o::VertexSE3Expmap*>(_vertices[1]);
+    _error = (_measurement.inverse() * from->estimate().inverse() * to->estimate()).log();
+  }
+};
+
+g2o::SE3Quat toSE3Quat(const Eigen::Matrix4f& pose)
+{
+  Eigen::Matrix4d p = pose.cast<double>();
+  return g2o::SE3Quat(p.block<3, 3>(0, 0), p.block<3, 1>(0, 3));
+}
+
+InformationMatrix information(double translation_stddev, double rotation_stddev)
+{
+  InformationMatrix info = InformationMatrix::Zero();
+  info.diagonal().head<3>().setConstant(1.0 / (rotation_stddev * rotation_stddev));
+  info.diagonal().tail<3>().setConstant(1.0 / (translation_stddev * translation_stddev));
+  return info;
+}
+}  // namespace
+
+bool optimizePoseGraph(const PoseGraphPoseVector& poses, const PoseGraphLoopVector& loops, int iterations,
+                       PoseGraphPoseVector* optimized)
+{
+  if (poses.empty())
+    return false;
+
+  std::unique_ptr<g2o::BlockSolver_6_3::LinearSolverType> linear_solver(
+      new g2o::LinearSolverEigen<g2o::BlockSolver_6_3::PoseMatrixType>());
+  std::unique_ptr<g2o::BlockSolver_6_3> block_solver(new g2o::BlockSolver_6_3(std::move(linear_solver)));
+  g2o::SparseOptimizer optimizer;
+  optimizer.setAlgorithm(new g2o::OptimizationAlgorithmLevenberg(std::move(block_solver)));
+
+  for (size_t k = 0; k < poses.size(); k++)
+  {
+    g2o::VertexSE3Expmap* vertex = new g2o::VertexSE3Expmap();
+    vertex->setEstimate(toSE3Quat(poses[k]));
+    vertex->setId(static_cast<int>(k));
+    vertex->setFixed(k == 0);
+    optimizer.addVertex(vertex);
+  }
+
+  // odometry: the relative poses registered between consecutive poses
+  InformationMatrix odometry_information = information(ODOMETRY_TRANSLATION_STDDEV, ODOMETRY_ROTATION_STDDEV);
+  for (size_t k = 1; k < poses.size(); k++)
+  {
+    EdgeSE3Relative* edge = new EdgeSE3Relative();
+    edge->setVertex(0, optimizer.vertex(static_cast<int>(k - 1)));
+    edge->setVertex(1, optimizer.vertex(static_cast<int>(k)));
+    edge->setMeasurement(toSE3Quat(poses[k - 1].inverse() * poses[k]));
+    edge->setInformation(odometry_information);
+    optimizer.addEdge(edge);
+  }
+
+  InformationMatrix loop_information = information(LOOP_TRANSLATION_STDDEV, LOOP_ROTATION_STDDEV);
+  for (size_t l = 0; l < loops.size(); l++)
+  {
+    if (loops[l].from >= poses.size() || loops[l].to >= poses.size())
+      return false;
+    EdgeSE3Relative* edge = new EdgeSE3Relative();
+    edge->setVertex(0, optimizer.vertex(static_cast<int>(loops[l].from)));
+    edge->setVertex(1, optimizer.vertex(static_cast<int>(loops[l].to)));
+    edge->setMeasurement(toSE3Quat(loops[l].relative));
+    edge->setInformation(loop_information);
+    g2o::RobustKernelHuber* kernel = new g2o::RobustKernelHuber;
+    kernel->setDelta(LOOP_HUBER_DELTA);
+    edge->setRobustKernel(kernel);
+    optimizer.addEdge(edge);
+  }
+
+  optimizer.initializeOptimization();
+  if (optimizer.optimize(iterations) <= 0)
+    return false;
+
+  optimized->resize(poses.size());
+  for (size_t k = 0; k < poses.size(); k++)
+  {
+    const g2o::VertexSE3Expmap* vertex =
+        static_cast<const g2o::VertexSE3Expmap*>(optimizer.vertex(static_cast<int>(k)));
+    (*optimized)[k] = vertex->estimate().to_homogeneous_matrix().cast<float>();
+  }
+  return true;
+}
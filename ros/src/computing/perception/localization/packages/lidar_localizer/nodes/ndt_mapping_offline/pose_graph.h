@@ -0,0 +1,44 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef POSE_GRAPH_H
+#define POSE_GRAPH_H
+
+#include <cstddef>
+#include <vector>
+
+#include <Eigen/Core>
+#include <Eigen/StdVector>
+
+// The pose graph optimization of the loop closure of ndt_mapping_offline, kept apart from PCL so it can be tested.
+
+struct PoseGraphLoop
+{
+  size_t from;               // older pose
+  size_t to;                 // newer pose
+  Eigen::Matrix4f relative;  // pose of to in the frame of from
+
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+typedef std::vector<PoseGraphLoop, Eigen::aligned_allocator<PoseGraphLoop> > PoseGraphLoopVector;
+typedef std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f> > PoseGraphPoseVector;
+
+// Optimizes poses, linked in order by their relative poses and by loops, with g2o. The first pose is fixed and
+// the loops beyond the 95% chi2 bound are down weighted. Returns false when the optimization failed.
+bool optimizePoseGraph(const PoseGraphPoseVector& poses, const PoseGraphLoopVector& loops, int iterations,
+                       PoseGraphPoseVector* optimized);
+
+#endif  // POSE_GRAPH_H
@@ -29,6 +29,7 @@
 #include <std_msgs/Bool.h>
 #include <std_msgs/Float32.h>
 #include <sensor_msgs/PointCloud2.h>
+#include <geometry_msgs/PoseStamped.h>
 
 static int enqueue = 0;
 static int dequeue = 0;
@@ -38,7 +39,8 @@ static void points_callback(const sensor_msgs::PointCloud2::ConstPtr& input)
 	enqueue++;
 }
 
-static void ndt_map_callback(const sensor_msgs::PointCloud2::ConstPtr& input)
+// the mapping nodes publish current_pose once per processed scan
+static void current_pose_callback(const geometry_msgs::PoseStamped::ConstPtr& input)
 {
 	dequeue++;
 
@@ -53,7 +55,7 @@ int main(int argc, char **argv)
     ros::NodeHandle private_nh("~");
 
     ros::Subscriber points_sub = nh.subscribe("points_raw", 100000, points_callback);
-    ros::Subscriber ndt_map_sub = nh.subscribe("ndt_map", 100000, ndt_map_callback);
+    ros::Subscriber current_pose_sub = nh.subscribe("current_pose", 100000, current_pose_callback);
 
     ros::spin();
 
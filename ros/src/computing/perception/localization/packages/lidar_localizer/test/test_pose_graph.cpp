@@ -0,0 +1,151 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include <Eigen/Geometry>
+
+#include "pose_graph.h"
+
+namespace
+{
+const int SIDE_POSES = 50;  // poses 1 m apart on each side of the square
+
+Eigen::Matrix4f makePose(float x, float y, float yaw)
+{
+  Eigen::Matrix4f pose = Eigen::Matrix4f::Identity();
+  pose.block<3, 3>(0, 0) = Eigen::AngleAxisf(yaw, Eigen::Vector3f::UnitZ()).toRotationMatrix();
+  pose(0, 3) = x;
+  pose(1, 3) = y;
+  return pose;
+}
+
+// counterclockwise square of 50 m, back to the start: the last pose is at the first one
+PoseGraphPoseVector makeSquare()
+{
+  PoseGraphPoseVector poses;
+  Eigen::Matrix4f pose = Eigen::Matrix4f::Identity();
+  poses.push_back(pose);
+  for (int side = 0; side < 4; side++)
+  {
+    for (int k = 0; k < SIDE_POSES; k++)
+    {
+      pose = pose * makePose(1.0f, 0.0f, k == SIDE_POSES - 1 ? static_cast<float>(M_PI / 2) : 0.0f);
+      poses.push_back(pose);
+    }
+  }
+  return poses;
+}
+
+// the same relative poses with a yaw drift at each step, as registered by the mapper
+PoseGraphPoseVector addDrift(const PoseGraphPoseVector& truth, float yaw_drift)
+{
+  PoseGraphPoseVector poses(1, truth[0]);
+  for (size_t k = 1; k < truth.size(); k++)
+    poses.push_back(poses.back() * truth[k - 1].inverse() * truth[k] * makePose(0.0f, 0.0f, yaw_drift));
+  return poses;
+}
+
+float maxError(const PoseGraphPoseVector& truth, const PoseGraphPoseVector& poses)
+{
+  float max_error = 0.0f;
+  for (size_t k = 0; k < truth.size(); k++)
+    max_error = std::max(max_error, (truth[k].block<3, 1>(0, 3) - poses[k].block<3, 1>(0, 3)).norm());
+  return max_error;
+}
+
+PoseGraphLoop makeLoop(const PoseGraphPoseVector& truth, size_t from, size_t to)
+{
+  PoseGraphLoop loop;
+  loop.from = from;
+  loop.to = to;
+  loop.relative = truth[from].inverse() * truth[to];
+  return loop;
+}
+}  // namespace
+
+// the loop from the end of the square back to its start takes the drift out
+TEST(PoseGraph, loopCorrectsDrift)
+{
+  PoseGraphPoseVector truth = makeSquare();
+  PoseGraphPoseVector drifted = addDrift(truth, 0.002f);
+  float drift = maxError(truth, drifted);
+  ASSERT_GT(drift, 5.0f);
+
+  PoseGraphLoopVector loops;
+  loops.push_back(makeLoop(truth, 0, truth.size() - 1));
+  loops.push_back(makeLoop(truth, 1, truth.size() - 2));
+  PoseGraphPoseVector optimized;
+  ASSERT_TRUE(optimizePoseGraph(drifted, loops, 20, &optimized));
+  ASSERT_EQ(truth.size(), optimized.size());
+
+  EXPECT_LT(maxError(truth, optimized), 0.1f * drift);
+  // the first pose is fixed
+  EXPECT_TRUE(optimized[0].isApprox(drifted[0]));
+  // and the end of the loop is back at the start
+  EXPECT_LT((optimized.back().block<3, 1>(0, 3) - optimized[0].block<3, 1>(0, 3)).norm(), 0.5f);
+}
+
+// without loops, the poses already agree with their relative poses and are left as they are
+TEST(PoseGraph, noLoopKeepsPoses)
+{
+  PoseGraphPoseVector drifted = addDrift(makeSquare(), 0.002f);
+  PoseGraphPoseVector optimized;
+  ASSERT_TRUE(optimizePoseGraph(drifted, PoseGraphLoopVector(), 10, &optimized));
+  ASSERT_EQ(drifted.size(), optimized.size());
+  EXPECT_LT(maxError(drifted, optimized), 1e-3f);
+}
+
+// a wrong loop next to the right ones is down weighted by the robust kernel
+TEST(PoseGraph, wrongLoopIsDownWeighted)
+{
+  PoseGraphPoseVector truth = makeSquare();
+  PoseGraphPoseVector drifted = addDrift(truth, 0.002f);
+
+  PoseGraphLoopVector loops;
+  for (size_t k = 0; k < 5; k++)
+    loops.push_back(makeLoop(truth, k, truth.size() - 1 - k));
+  PoseGraphPoseVector optimized;
+  ASSERT_TRUE(optimizePoseGraph(drifted, loops, 20, &optimized));
+  float error = maxError(truth, optimized);
+
+  PoseGraphLoop wrong = makeLoop(truth, 10, truth.size() - 10);
+  wrong.relative = wrong.relative * makePose(5.0f, -5.0f, 0.3f);
+  loops.push_back(wrong);
+  ASSERT_TRUE(optimizePoseGraph(drifted, loops, 20, &optimized));
+  // the error grows by about 1 m, and by about 4 m without the kernel
+  EXPECT_LT(maxError(truth, optimized), error + 2.0f);
+}
+
+TEST(PoseGraph, rejectsBadInput)
+{
+  PoseGraphPoseVector optimized;
+  EXPECT_FALSE(optimizePoseGraph(PoseGraphPoseVector(), PoseGraphLoopVector(), 10, &optimized));
+
+  PoseGraphPoseVector truth = makeSquare();
+  PoseGraphLoopVector loops(1, makeLoop(truth, 0, 1));
+  loops[0].to = truth.size();
+  EXPECT_FALSE(optimizePoseGraph(truth, loops, 10, &optimized));
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -18,6 +18,12 @@
 
 #include "object_map_utils.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <opencv2/imgproc/imgproc.hpp>
+
 namespace object_map
 {
 	geometry_msgs::Point TransformPoint(const geometry_msgs::Point &in_point, const tf::Transform &in_tf)
@@ -120,6 +126,16 @@ namespace object_map
 		                      const int in_layer_min_value, const int in_fill_color, const int in_layer_max_value,
 		                      const std::string &in_tf_target_frame, const std::string &in_tf_source_frame,
 		                      const tf::TransformListener &in_tf_listener)
+	{
+		tf::StampedTransform tf = FindTransform(in_tf_target_frame, in_tf_source_frame, in_tf_listener);
+		FillPolygonAreas(out_grid_map, in_area_points, in_grid_layer_name, in_layer_background_value,
+		                 in_layer_min_value, in_fill_color, in_layer_max_value, tf);
+	}
+
+	void FillPolygonAreas(grid_map::GridMap &out_grid_map, const std::vector<std::vector<geometry_msgs::Point>> &in_area_points,
+	                      const std::string &in_grid_layer_name, const int in_layer_background_value,
+	                      const int in_layer_min_value, const int in_fill_color, const int in_layer_max_value,
+	                      const tf::Transform &in_tf)
 	{
 		if(!out_grid_map.exists(in_grid_layer_name))
 		{
@@ -137,8 +153,6 @@ namespace object_map
 
 		cv::Mat filled_image = original_image.clone();
 
-		tf::StampedTransform tf = FindTransform(in_tf_target_frame, in_tf_source_frame, in_tf_listener);
-
 		// calculate out_grid_map position
 		grid_map::Position map_pos = out_grid_map.getPosition();
 		double origin_x_offset = out_grid_map.getLength().x() / 2.0 - map_pos.x();
@@ -151,7 +165,7 @@ namespace object_map
 			for (const auto &p : points)
 			{
 				// transform to GridMap coordinate
-				geometry_msgs::Point tf_point = TransformPoint(p, tf);
+				geometry_msgs::Point tf_point = TransformPoint(p, in_tf);
 
 				// coordinate conversion for cv image
 				double cv_x = (out_grid_map.getLength().y() - origin_y_offset - tf_point.y) / out_grid_map.getResolution();
@@ -170,6 +184,226 @@ namespace object_map
 		                                                                  in_layer_max_value);
 	}
 
+	void RasterizeWayAreas(const std::vector<std::vector<geometry_msgs::Point>> &in_area_points,
+	                       double in_resolution,
+	                       int in_tile_size,
+	                       WayAreaRaster &out_raster)
+	{
+		out_raster = WayAreaRaster();
+		out_raster.resolution = in_resolution;
+		out_raster.tile_size = in_tile_size;
+
+		double min_x = std::numeric_limits<double>::max();
+		double min_y = std::numeric_limits<double>::max();
+		double max_x = -std::numeric_limits<double>::max();
+		double max_y = -std::numeric_limits<double>::max();
+		double height_sum = 0;
+		size_t points_num = 0;
+		for (const auto &points : in_area_points)
+		{
+			for (const auto &p : points)
+			{
+				min_x = std::min(min_x, p.x);
+				min_y = std::min(min_y, p.y);
+				max_x = std::max(max_x, p.x);
+				max_y = std::max(max_y, p.y);
+				height_sum += p.z;
+				points_num++;
+			}
+		}
+		if (points_num == 0 || in_resolution <= 0 || in_tile_size <= 0)
+		{
+			return;
+		}
+
+		// one empty cell around the wayareas
+		out_raster.origin_x = min_x - in_resolution;
+		out_raster.origin_y = min_y - in_resolution;
+		out_raster.height = height_sum / points_num;
+		int cells_x = std::ceil((max_x - out_raster.origin_x) / in_resolution) + 1;
+		int cells_y = std::ceil((max_y - out_raster.origin_y) / in_resolution) + 1;
+		out_raster.tiles_x = (cells_x + in_tile_size - 1) / in_tile_size;
+		out_raster.tiles_y = (cells_y + in_tile_size - 1) / in_tile_size;
+		out_raster.tiles.resize(out_raster.tiles_x * out_raster.tiles_y);
+
+		// vertices are drawn with sub-cell precision, the center of cell (i, j) is at (i, j)
+		const int shift = 4;
+		const double scale = (1 << shift) / in_resolution;
+
+		for (const auto &points : in_area_points)
+		{
+			if (points.empty())
+			{
+				continue;
+			}
+
+			std::vector<cv::Point> cv_points;
+			int min_cell_x = std::numeric_limits<int>::max(), max_cell_x = 0;
+			int min_cell_y = std::numeric_limits<int>::max(), max_cell_y = 0;
+			for (const auto &p : points)
+			{
+				cv::Point cv_point(cvRound((p.x - out_raster.origin_x) * scale - (1 << (shift - 1))),
+				                   cvRound((p.y - out_raster.origin_y) * scale - (1 << (shift - 1))));
+				cv_points.push_back(cv_point);
+				min_cell_x = std::min(min_cell_x, cv_point.x >> shift);
+				min_cell_y = std::min(min_cell_y, cv_point.y >> shift);
+				max_cell_x = std::max(max_cell_x, (cv_point.x >> shift) + 1);
+				max_cell_y = std::max(max_cell_y, (cv_point.y >> shift) + 1);
+			}
+
+			int tile_x_begin = std::max(0, min_cell_x / in_tile_size);
+			int tile_y_begin = std::max(0, min_cell_y / in_tile_size);
+			int tile_x_end = std::min(out_raster.tiles_x - 1, max_cell_x / in_tile_size);
+			int tile_y_end = std::min(out_raster.tiles_y - 1, max_cell_y / in_tile_size);
+			for (int tile_y = tile_y_begin; tile_y <= tile_y_end; tile_y++)
+			{
+				for (int tile_x = tile_x_begin; tile_x <= tile_x_end; tile_x++)
+				{
+					cv::Mat &tile = out_raster.tiles[tile_y * out_raster.tiles_x + tile_x];
+					if (tile.empty())
+					{
+						tile = cv::Mat::zeros(in_tile_size, in_tile_size, CV_8UC1);
+					}
+
+					cv::Point tile_offset(tile_x * in_tile_size << shift, tile_y * in_tile_size << shift);
+					std::vector<cv::Point> tile_points(cv_points.size());
+					for (size_t i = 0; i < cv_points.size(); i++)
+					{
+						tile_points[i] = cv_points[i] - tile_offset;
+					}
+					cv::fillConvexPoly(tile, tile_points.data(), tile_points.size(), cv::Scalar(255), 8, shift);
+				}
+			}
+		}
+	}
+
+	void FillPolygonAreas(grid_map::GridMap &out_grid_map, const WayAreaRaster &in_raster,
+	                      const std::string &in_grid_layer_name, const int in_layer_background_value,
+	                      const int in_layer_min_value, const int in_fill_color, const int in_layer_max_value,
+	                      const std::string &in_tf_target_frame, const std::string &in_tf_source_frame,
+	                      const tf::TransformListener &in_tf_listener)
+	{
+		tf::StampedTransform tf = FindTransform(in_tf_target_frame, in_tf_source_frame, in_tf_listener);
+		FillPolygonAreas(out_grid_map, in_raster, in_grid_layer_name, in_layer_background_value,
+		                 in_layer_min_value, in_fill_color, in_layer_max_value, tf);
+	}
+
+	void FillPolygonAreas(grid_map::GridMap &out_grid_map, const WayAreaRaster &in_raster,
+	                      const std::string &in_grid_layer_name, const int in_layer_background_value,
+	                      const int in_layer_min_value, const int in_fill_color, const int in_layer_max_value,
+	                      const tf::Transform &in_tf)
+	{
+		if(!out_grid_map.exists(in_grid_layer_name))
+		{
+			out_grid_map.add(in_grid_layer_name);
+		}
+		out_grid_map[in_grid_layer_name].setConstant(in_layer_background_value);
+
+		cv::Mat filled_image;
+		grid_map::GridMapCvConverter::toImage<unsigned char, 1>(out_grid_map,
+		                                                        in_grid_layer_name,
+		                                                        CV_8UC1,
+		                                                        in_layer_min_value,
+		                                                        in_layer_max_value,
+		                                                        filled_image);
+
+		// map to grid frame on the plane of the wayareas: grid = A * map + b
+		tf::Matrix3x3 rotation = in_tf.getBasis();
+		tf::Vector3 translation = in_tf.getOrigin();
+		double a11 = rotation[0][0], a12 = rotation[0][1];
+		double a21 = rotation[1][0], a22 = rotation[1][1];
+		double b1 = rotation[0][2] * in_raster.height + translation.x();
+		double b2 = rotation[1][2] * in_raster.height + translation.y();
+		double det = a11 * a22 - a12 * a21;
+
+		if (in_raster.tiles.empty() || std::fabs(det) < 1e-6)
+		{
+			grid_map::GridMapCvConverter::addLayerFromImage<unsigned char, 1>(filled_image, in_grid_layer_name,
+			                                                                  out_grid_map, in_layer_min_value,
+			                                                                  in_layer_max_value);
+			return;
+		}
+
+		// image (col, row) to grid frame, matching the image layout of GridMapCvConverter
+		double resolution = out_grid_map.getResolution();
+		double top_x = out_grid_map.getPosition().x() + out_grid_map.getLength().x() / 2.0 - resolution / 2.0;
+		double top_y = out_grid_map.getPosition().y() + out_grid_map.getLength().y() / 2.0 - resolution / 2.0;
+
+		// image (col, row) to raster cell (u, v), composing the three affine maps
+		cv::Mat image_to_raster(2, 3, CV_64FC1);
+		for (int i = 0; i < 3; i++)
+		{
+			// grid frame offset of a unit step in col, row, and of the origin
+			double grid_x = (i == 1) ? -resolution : 0;
+			double grid_y = (i == 0) ? -resolution : 0;
+			if (i == 2)
+			{
+				grid_x = top_x - b1;
+				grid_y = top_y - b2;
+			}
+			double map_x = (a22 * grid_x - a12 * grid_y) / det;
+			double map_y = (-a21 * grid_x + a11 * grid_y) / det;
+			image_to_raster.at<double>(0, i) = map_x / in_raster.resolution;
+			image_to_raster.at<double>(1, i) = map_y / in_raster.resolution;
+		}
+		image_to_raster.at<double>(0, 2) -= in_raster.origin_x / in_raster.resolution + 0.5;
+		image_to_raster.at<double>(1, 2) -= in_raster.origin_y / in_raster.resolution + 0.5;
+
+		// tiles under the window
+		double min_u = std::numeric_limits<double>::max(), max_u = -std::numeric_limits<double>::max();
+		double min_v = std::numeric_limits<double>::max(), max_v = -std::numeric_limits<double>::max();
+		for (int corner = 0; corner < 4; corner++)
+		{
+			double col = (corner & 1) ? filled_image.cols : -1;
+			double row = (corner & 2) ? filled_image.rows : -1;
+			double u = image_to_raster.at<double>(0, 0) * col + image_to_raster.at<double>(0, 1) * row
+			           + image_to_raster.at<double>(0, 2);
+			double v = image_to_raster.at<double>(1, 0) * col + image_to_raster.at<double>(1, 1) * row
+			           + image_to_raster.at<double>(1, 2);
+			min_u = std::min(min_u, u);
+			max_u = std::max(max_u, u);
+			min_v = std::min(min_v, v);
+			max_v = std::max(max_v, v);
+		}
+		int tile_x_begin = std::max(0.0, std::floor(min_u / in_raster.tile_size));
+		int tile_y_begin = std::max(0.0, std::floor(min_v / in_raster.tile_size));
+		int tile_x_end = std::min<double>(in_raster.tiles_x - 1, std::floor(max_u / in_raster.tile_size));
+		int tile_y_end = std::min<double>(in_raster.tiles_y - 1, std::floor(max_v / in_raster.tile_size));
+
+		if (tile_x_begin <= tile_x_end && tile_y_begin <= tile_y_end)
+		{
+			cv::Mat crop = cv::Mat::zeros((tile_y_end - tile_y_begin + 1) * in_raster.tile_size,
+			                              (tile_x_end - tile_x_begin + 1) * in_raster.tile_size, CV_8UC1);
+			for (int tile_y = tile_y_begin; tile_y <= tile_y_end; tile_y++)
+			{
+				for (int tile_x = tile_x_begin; tile_x <= tile_x_end; tile_x++)
+				{
+					const cv::Mat &tile = in_raster.tiles[tile_y * in_raster.tiles_x + tile_x];
+					if (!tile.empty())
+					{
+						tile.copyTo(crop(cv::Rect((tile_x - tile_x_begin) * in_raster.tile_size,
+						                          (tile_y - tile_y_begin) * in_raster.tile_size,
+						                          in_raster.tile_size, in_raster.tile_size)));
+					}
+				}
+			}
+			image_to_raster.at<double>(0, 2) -= tile_x_begin * in_raster.tile_size;
+			image_to_raster.at<double>(1, 2) -= tile_y_begin * in_raster.tile_size;
+
+			cv::Mat mask;
+			cv::warpAffine(crop, mask, image_to_raster, filled_image.size(), cv::INTER_NEAREST | cv::WARP_INVERSE_MAP,
+			               cv::BORDER_CONSTANT, cv::Scalar(0));
+			filled_image.setTo(cv::Scalar(in_fill_color), mask);
+		}
+
+		// convert to ROS msg
+		grid_map::GridMapCvConverter::addLayerFromImage<unsigned char, 1>(filled_image,
+		                                                                  in_grid_layer_name,
+		                                                                  out_grid_map,
+		                                                                  in_layer_min_value,
+		                                                                  in_layer_max_value);
+	}
+
 	void LoadRoadAreasFromVectorMap(ros::NodeHandle& in_private_node_handle,
 	                                std::vector<std::vector<geometry_msgs::Point>>& out_area_points)
 	{
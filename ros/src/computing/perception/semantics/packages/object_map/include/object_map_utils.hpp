@@ -29,8 +29,28 @@
 #include <grid_map_msgs/GridMap.h>
 #include <grid_map_cv/grid_map_cv.hpp>
 
+#include <opencv2/core/core.hpp>
+
 namespace object_map
 {
+  /*!
+   * Way areas of the whole map rasterized in the map frame. The raster is split in square tiles,
+   * only the tiles touching a way area are allocated.
+   */
+  struct WayAreaRaster
+  {
+    double resolution;            // cell size in meters
+    double origin_x;              // map frame position of the corner of the first cell
+    double origin_y;
+    double height;                // mean height of the way area points
+    int tile_size;                // cells on each side of a tile
+    int tiles_x;                  // tiles along x, the raster columns
+    int tiles_y;                  // tiles along y, the raster rows
+    std::vector<cv::Mat> tiles;   // tiles_y * tiles_x CV_8UC1 tiles, 255 on way areas. Empty if there is no way area
+
+    WayAreaRaster() : resolution(0), origin_x(0), origin_y(0), height(0), tile_size(0), tiles_x(0), tiles_y(0) {}
+  };
+
   /*!
    * Transforms a point using the given transformation
    * @param[in] in_point Point to transform
@@ -111,7 +131,68 @@ namespace object_map
                         const std::string &in_tf_source_frame,
                         const tf::TransformListener &in_tf_listener);
 
+  /*!
+   * Projects the in_area_points forming the road with a known transformation, stores the result in out_grid_map.
+   * @param[in] in_tf Transformation from the frame of the points to the frame of out_grid_map
+   */
+  void FillPolygonAreas(grid_map::GridMap &out_grid_map,
+                        const std::vector<std::vector<geometry_msgs::Point>> &in_area_points,
+                        const std::string &in_grid_layer_name,
+                        const int in_layer_background_value,
+                        const int in_fill_color,
+                        const int in_layer_min_value,
+                        const int in_layer_max_value,
+                        const tf::Transform &in_tf);
+
+  /*!
+   * Rasterizes in_area_points once in the map frame
+   * @param[in] in_area_points Array of points containing the wayareas, in the map frame
+   * @param[in] in_resolution Cell size of the raster
+   * @param[in] in_tile_size Number of cells on each side of a tile
+   * @param[out] out_raster Resulting raster, without tiles if there are no wayareas
+   */
+  void RasterizeWayAreas(const std::vector<std::vector<geometry_msgs::Point>> &in_area_points,
+                         double in_resolution,
+                         int in_tile_size,
+                         WayAreaRaster &out_raster);
+
+  /*!
+   * Crops the window of out_grid_map from a wayarea raster, stores the result in out_grid_map.
+   * Only the tiles under the window are read, and they are resampled with a single warp.
+   * @param[out] out_grid_map GridMap object to add the road grid
+   * @param[in] in_raster Wayareas rasterized with RasterizeWayAreas
+   * @param[in] in_grid_layer_name Name to assign to the layer
+   * @param[in] in_layer_background_value Empty state value
+   * @param[in] in_fill_color Value to fill on wayareas
+   * @param[in] in_layer_min_value Minimum value in the layer
+   * @param[in] in_layer_max_value Maximum value in the later
+   * @param[in] in_tf_target_frame Target frame, the frame of out_grid_map
+   * @param[in] in_tf_source_frame Source frame, where the raster is located
+   * @param[in] in_tf_listener Valid listener to obtain the transformation
+   */
+  void FillPolygonAreas(grid_map::GridMap &out_grid_map,
+                        const WayAreaRaster &in_raster,
+                        const std::string &in_grid_layer_name,
+                        const int in_layer_background_value,
+                        const int in_fill_color,
+                        const int in_layer_min_value,
+                        const int in_layer_max_value,
+                        const std::string &in_tf_target_frame,
+                        const std::string &in_tf_source_frame,
+                        const tf::TransformListener &in_tf_listener);
 
+  /*!
+   * Crops the window of out_grid_map from a wayarea raster with a known transformation.
+   * @param[in] in_tf Transformation from the frame of the raster to the frame of out_grid_map
+   */
+  void FillPolygonAreas(grid_map::GridMap &out_grid_map,
+                        const WayAreaRaster &in_raster,
+                        const std::string &in_grid_layer_name,
+                        const int in_layer_background_value,
+                        const int in_fill_color,
+                        const int in_layer_min_value,
+                        const int in_layer_max_value,
+                        const tf::Transform &in_tf);
 
 } // namespace object_map
 
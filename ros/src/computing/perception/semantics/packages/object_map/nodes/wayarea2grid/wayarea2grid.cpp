@@ -23,7 +23,11 @@ namespace object_map
 			private_node_handle_("~")
 	{
 		InitializeROSIo();
-		LoadRoadAreasFromVectorMap(private_node_handle_, area_points_);
+
+		// the way areas are rasterized once, each tick only crops the grid window
+		std::vector<std::vector<geometry_msgs::Point>> area_points;
+		LoadRoadAreasFromVectorMap(private_node_handle_, area_points);
+		RasterizeWayAreas(area_points, grid_resolution_, wayarea_tile_size_, wayarea_raster_);
 	}
 
 
@@ -62,9 +66,9 @@ namespace object_map
 			// timer start
 			//auto start = std::chrono::system_clock::now();
 
-			if (!area_points_.empty())
+			if (!wayarea_raster_.tiles.empty())
 			{
-				FillPolygonAreas(gridmap_, area_points_, grid_layer_name_, OCCUPANCY_NO_ROAD, OCCUPANCY_ROAD, grid_min_value_,
+				FillPolygonAreas(gridmap_, wayarea_raster_, grid_layer_name_, OCCUPANCY_NO_ROAD, OCCUPANCY_ROAD, grid_min_value_,
 				                 grid_max_value_, sensor_frame_, map_frame_,
 				                 tf_listener_);
 				PublishGridMap(gridmap_, publisher_grid_map_);
@@ -76,7 +76,9 @@ namespace object_map
 		const int               grid_min_value_     = 0;
 		const int               grid_max_value_     = 255;
 
-		std::vector<std::vector<geometry_msgs::Point>> area_points_;
+		const int               wayarea_tile_size_  = 512;
+
+		WayAreaRaster           wayarea_raster_;
 
 		/*!
 		 * Initializes ROS Publisher, Subscribers and sets the configuration parameters
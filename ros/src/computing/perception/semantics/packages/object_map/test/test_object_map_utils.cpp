@@ -0,0 +1,153 @@
+/*
+ * Copyright 2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ********************
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include "object_map_utils.hpp"
+
+namespace
+{
+	// same values as wayarea2grid
+	const int OCCUPANCY_ROAD = 128;
+	const int OCCUPANCY_NO_ROAD = 255;
+	const int GRID_MIN_VALUE = 0;
+	const int GRID_MAX_VALUE = 255;
+	const std::string LAYER = "wayarea";
+
+	geometry_msgs::Point MakePoint(double x, double y)
+	{
+		geometry_msgs::Point point;
+		point.x = x;
+		point.y = y;
+		point.z = 0;
+		return point;
+	}
+
+	std::vector<std::vector<geometry_msgs::Point>> MakeAreas()
+	{
+		std::vector<std::vector<geometry_msgs::Point>> areas(3);
+		// around the sensor, over four tiles of 8 cells
+		areas[0] = {MakePoint(-5, -5), MakePoint(5, -5), MakePoint(5, 5), MakePoint(-5, 5)};
+		// off the axes
+		areas[1] = {MakePoint(8, -10), MakePoint(14, -2), MakePoint(6, 4)};
+		// partly out of the window
+		areas[2] = {MakePoint(10, 8), MakePoint(25, 8), MakePoint(25, 20), MakePoint(10, 20)};
+		return areas;
+	}
+
+	grid_map::GridMap MakeGridMap()
+	{
+		grid_map::GridMap grid_map({LAYER});
+		grid_map.setGeometry(grid_map::Length(30, 30), 0.5, grid_map::Position(2, 1));
+		return grid_map;
+	}
+
+	// 255 on road cells
+	cv::Mat RoadMask(const grid_map::GridMap &in_grid_map)
+	{
+		const grid_map::Matrix &layer = in_grid_map[LAYER];
+		cv::Mat mask = cv::Mat::zeros(layer.rows(), layer.cols(), CV_8UC1);
+		for (int i = 0; i < layer.rows(); i++)
+		{
+			for (int j = 0; j < layer.cols(); j++)
+			{
+				if (layer(i, j) < (OCCUPANCY_ROAD + OCCUPANCY_NO_ROAD) / 2)
+				{
+					mask.at<unsigned char>(i, j) = 255;
+				}
+			}
+		}
+		return mask;
+	}
+
+	// the polygon fill truncates vertices to whole cells, so both fills may differ up to two cells from an edge
+	void ExpectSameFill(const tf::Transform &in_tf)
+	{
+		std::vector<std::vector<geometry_msgs::Point>> areas = MakeAreas();
+
+		grid_map::GridMap polygon_map = MakeGridMap();
+		object_map::FillPolygonAreas(polygon_map, areas, LAYER, OCCUPANCY_NO_ROAD, OCCUPANCY_ROAD, GRID_MIN_VALUE,
+		                             GRID_MAX_VALUE, in_tf);
+
+		object_map::WayAreaRaster raster;
+		object_map::RasterizeWayAreas(areas, polygon_map.getResolution(), 8, raster);
+		grid_map::GridMap raster_map = MakeGridMap();
+		object_map::FillPolygonAreas(raster_map, raster, LAYER, OCCUPANCY_NO_ROAD, OCCUPANCY_ROAD, GRID_MIN_VALUE,
+		                             GRID_MAX_VALUE, in_tf);
+
+		cv::Mat polygon_mask = RoadMask(polygon_map);
+		cv::Mat raster_mask = RoadMask(raster_map);
+		ASSERT_GT(cv::countNonZero(polygon_mask), 400);
+
+		cv::Mat edges;
+		cv::morphologyEx(polygon_mask, edges, cv::MORPH_GRADIENT,
+		                 cv::getStructuringElement(cv::MORPH_RECT, cv::Size(5, 5)));
+		cv::Mat differences = polygon_mask != raster_mask;
+		EXPECT_LT(cv::countNonZero(differences), cv::countNonZero(edges));
+
+		cv::Mat inner_differences = differences & ~edges;
+		EXPECT_EQ(0, cv::countNonZero(inner_differences));
+	}
+}
+
+TEST(WayAreaRaster, allocatesOnlyTouchedTiles)
+{
+	object_map::WayAreaRaster raster;
+	object_map::RasterizeWayAreas(MakeAreas(), 0.5, 8, raster);
+
+	ASSERT_FALSE(raster.tiles.empty());
+	EXPECT_EQ(raster.tiles_x * raster.tiles_y, static_cast<int>(raster.tiles.size()));
+	int allocated = 0;
+	for (const auto &tile : raster.tiles)
+	{
+		if (!tile.empty())
+		{
+			allocated++;
+		}
+	}
+	// the first area alone covers at least four tiles, the empty space between the areas has none
+	EXPECT_GE(allocated, 4);
+	EXPECT_LT(allocated, static_cast<int>(raster.tiles.size()));
+}
+
+TEST(WayAreaRaster, noAreas)
+{
+	object_map::WayAreaRaster raster;
+	object_map::RasterizeWayAreas(std::vector<std::vector<geometry_msgs::Point>>(), 0.5, 8, raster);
+	EXPECT_TRUE(raster.tiles.empty());
+}
+
+TEST(FillPolygonAreas, rasterMatchesPolygonsIdentity)
+{
+	tf::Transform transform;
+	transform.setIdentity();
+	ExpectSameFill(transform);
+}
+
+TEST(FillPolygonAreas, rasterMatchesPolygonsRotated)
+{
+	ExpectSameFill(tf::Transform(tf::createQuaternionFromYaw(0.4), tf::Vector3(1.5, -2.0, 0.0)));
+}
+
+int main(int argc, char **argv)
+{
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -57,49 +57,127 @@ typedef boost::variate_generator<ENG, NormalDIST> VariatGEN;
 
 class TrajectoryTracker;
 
-class Particle
+// Particles of one trajectory. Each state variable is kept in its own contiguous array, so the filter steps run as
+// plain loops over the particles instead of visiting one particle object at a time.
+class ParticleSet
 {
 public:
-	bool bDeleted;
-	BEH_STATE_TYPE beh; //[Stop, Yielding, Forward, Branching]
-	double vel; //[0 -> Stop,1 -> moving]
-	double vel_prev_big;
-	double prev_time_diff;
-	int acc; //[-1 ->Slowing, 0, Stopping, 1 -> accelerating]
-	double acc_raw;
-	int indicator; //[0 -> No, 1 -> Left, 2 -> Right , 3 -> both]
-	WayPoint pose;
-	bool bStopLine;
-	double w;
-	double w_raw;
-	double pose_w;
-	double dir_w;
-	double vel_w;
-	double acl_w;
-	double ind_w;
-	TrajectoryTracker* pTraj;
-	int original_index;
-
-	Particle()
+	std::vector<BEH_STATE_TYPE> beh; //[Stop, Yielding, Forward, Branching]
+	std::vector<double> x;
+	std::vector<double> y;
+	std::vector<double> z;
+	std::vector<double> a;
+	std::vector<double> v; // pose speed
+	std::vector<double> vel; //[0 -> Stop,1 -> moving]
+	std::vector<double> vel_prev_big;
+	std::vector<double> prev_time_diff;
+	std::vector<int> acc; //[-1 ->Slowing, 0, Stopping, 1 -> accelerating]
+	std::vector<double> acc_raw;
+	std::vector<int> indicator; //[0 -> No, 1 -> Left, 2 -> Right , 3 -> both]
+	std::vector<double> w;
+	std::vector<double> w_raw;
+	std::vector<double> pose_w;
+	std::vector<double> dir_w;
+	std::vector<double> vel_w;
+	std::vector<double> acl_w;
+	std::vector<double> ind_w;
+
+	//scratch of the motion step, the target point of the steering and the speed of the trajectory
+	std::vector<double> target_x;
+	std::vector<double> target_y;
+	std::vector<double> path_vel;
+
+	unsigned int size() const
 	{
-		prev_time_diff = 0;
-		vel_prev_big = 0;
-		original_index = 0;
-		bStopLine = false;
-		bDeleted = false;
-		pTraj = nullptr;
-		w = 0;
-		w_raw = 0;
-		pose_w = 0;
-		dir_w = 0;
-		vel_w = 0;
-		acl_w = 0;
-		ind_w = 0;
-		beh = BEH_STOPPING_STATE;
-		vel = 0;
-		acc = 0;
-		acc_raw = 0;
-		indicator = 0;
+		return x.size();
+	}
+
+	void Add(const BEH_STATE_TYPE& _beh, const double& _x, const double& _y, const double& _z, const double& _a, const double& _v, const double& _vel)
+	{
+		beh.push_back(_beh);
+		x.push_back(_x);
+		y.push_back(_y);
+		z.push_back(_z);
+		a.push_back(_a);
+		v.push_back(_v);
+		vel.push_back(_vel);
+		vel_prev_big.push_back(0);
+		prev_time_diff.push_back(0);
+		acc.push_back(0);
+		acc_raw.push_back(0);
+		indicator.push_back(0);
+		w.push_back(0);
+		w_raw.push_back(0);
+		pose_w.push_back(0);
+		dir_w.push_back(0);
+		vel_w.push_back(0);
+		acl_w.push_back(0);
+		ind_w.push_back(0);
+	}
+
+	//removes the particles marked in bRemove, keeping the order of the rest
+	void Remove(const std::vector<bool>& bRemove)
+	{
+		unsigned int n = 0;
+		for(unsigned int i = 0; i < bRemove.size(); i++)
+		{
+			if(bRemove.at(i)) continue;
+
+			if(n != i)
+			{
+				beh[n] = beh[i];
+				x[n] = x[i];
+				y[n] = y[i];
+				z[n] = z[i];
+				a[n] = a[i];
+				v[n] = v[i];
+				vel[n] = vel[i];
+				vel_prev_big[n] = vel_prev_big[i];
+				prev_time_diff[n] = prev_time_diff[i];
+				acc[n] = acc[i];
+				acc_raw[n] = acc_raw[i];
+				indicator[n] = indicator[i];
+				w[n] = w[i];
+				w_raw[n] = w_raw[i];
+				pose_w[n] = pose_w[i];
+				dir_w[n] = dir_w[i];
+				vel_w[n] = vel_w[i];
+				acl_w[n] = acl_w[i];
+				ind_w[n] = ind_w[i];
+			}
+			n++;
+		}
+		Resize(n);
+	}
+
+	void Resize(const unsigned int& n)
+	{
+		beh.resize(n);
+		x.resize(n);
+		y.resize(n);
+		z.resize(n);
+		a.resize(n);
+		v.resize(n);
+		vel.resize(n);
+		vel_prev_big.resize(n);
+		prev_time_diff.resize(n);
+		acc.resize(n);
+		acc_raw.resize(n);
+		indicator.resize(n);
+		w.resize(n);
+		w_raw.resize(n);
+		pose_w.resize(n);
+		dir_w.resize(n);
+		vel_w.resize(n);
+		acl_w.resize(n);
+		ind_w.resize(n);
+	}
+
+	WayPoint GetPose(const unsigned int& i) const
+	{
+		WayPoint p(x.at(i), y.at(i), z.at(i), a.at(i));
+		p.v = v.at(i);
+		return p;
 	}
 };
 
@@ -116,11 +194,7 @@ public:
 	double rms_error;
 	std::vector<WayPoint> trajectory;
 
-	std::vector<Particle> m_ForwardPart;
-	std::vector<Particle> m_StopPart;
-	std::vector<Particle> m_YieldPart;
-	std::vector<Particle> m_LeftPart;
-	std::vector<Particle> m_RightPart;
+	ParticleSet m_Particles;
 	BehaviorState m_CurrBehavior;
 
 	int nAliveStop;
@@ -202,11 +276,7 @@ public:
 		best_p = obj.best_p;
 		m_SinglePathDecisionMaker = obj.m_SinglePathDecisionMaker;
 
-		m_ForwardPart = obj.m_ForwardPart;
-		m_StopPart = obj.m_StopPart;
-		m_YieldPart = obj.m_YieldPart;
-		m_LeftPart = obj.m_LeftPart;
-		m_RightPart = obj.m_RightPart;
+		m_Particles = obj.m_Particles;
 		m_CurrBehavior = obj.m_CurrBehavior;
 
 		w_avg_forward = obj.w_avg_forward;
@@ -365,115 +435,73 @@ public:
 		return totalMatch;
 	}
 
-	void InsertNewParticle(const Particle& p)
+	int& GetAliveCount(const BEH_STATE_TYPE& _beh)
 	{
-		if(p.beh == PlannerHNS::BEH_STOPPING_STATE && nAliveStop < BEH_PARTICLES_NUM)
-		{
-			m_StopPart.push_back(p);
-			m_StopPart.at(m_StopPart.size()-1).pTraj = this;
-			nAliveStop++;
-		}
-		else if(p.beh == PlannerHNS::BEH_YIELDING_STATE && nAliveYield < BEH_PARTICLES_NUM)
-		{
-			m_YieldPart.push_back(p);
-			m_YieldPart.at(m_YieldPart.size()-1).pTraj = this;
-			nAliveYield++;
-		}
-		else if(p.beh == PlannerHNS::BEH_FORWARD_STATE && nAliveForward < BEH_PARTICLES_NUM)
-		{
-			m_ForwardPart.push_back(p);
-			m_ForwardPart.at(m_ForwardPart.size()-1).pTraj = this;
-			nAliveForward++;
-		}
-		else if(p.beh == PlannerHNS::BEH_BRANCH_LEFT_STATE && nAliveLeft < BEH_PARTICLES_NUM)
-		{
-			m_LeftPart.push_back(p);
-			m_LeftPart.at(m_LeftPart.size()-1).pTraj = this;
-			nAliveLeft++;
-		}
-		else if(p.beh == PlannerHNS::BEH_BRANCH_RIGHT_STATE && nAliveRight < BEH_PARTICLES_NUM)
-		{
-			m_RightPart.push_back(p);
-			m_RightPart.at(m_RightPart.size()-1).pTraj = this;
-			nAliveRight++;
-		}
+		if(_beh == PlannerHNS::BEH_YIELDING_STATE)
+			return nAliveYield;
+		else if(_beh == PlannerHNS::BEH_FORWARD_STATE)
+			return nAliveForward;
+		else if(_beh == PlannerHNS::BEH_BRANCH_LEFT_STATE)
+			return nAliveLeft;
+		else if(_beh == PlannerHNS::BEH_BRANCH_RIGHT_STATE)
+			return nAliveRight;
+		else
+			return nAliveStop;
 	}
 
-	void DeleteParticle(const Particle& p, const int& _i)
+	void InsertNewParticle(const BEH_STATE_TYPE& _beh, const double& x, const double& y, const double& z, const double& a, const double& v, const double& vel)
 	{
-		if(p.beh == PlannerHNS::BEH_STOPPING_STATE && nAliveStop > BEH_MIN_PARTICLE_NUM)
-		{
-			m_StopPart.erase(m_StopPart.begin()+_i);
-			nAliveStop--;
-		}
-		else if(p.beh == PlannerHNS::BEH_YIELDING_STATE && nAliveYield > BEH_MIN_PARTICLE_NUM)
-		{
-			m_YieldPart.erase(m_YieldPart.begin()+_i);
-			nAliveYield--;
-		}
-		else if(p.beh == PlannerHNS::BEH_FORWARD_STATE && nAliveForward > BEH_MIN_PARTICLE_NUM)
+		int& nAlive = GetAliveCount(_beh);
+		if(nAlive < BEH_PARTICLES_NUM)
 		{
-			m_ForwardPart.erase(m_ForwardPart.begin()+_i);
-			nAliveForward--;
-		}
-		else if(p.beh == PlannerHNS::BEH_BRANCH_LEFT_STATE && nAliveLeft > BEH_MIN_PARTICLE_NUM)
-		{
-			m_LeftPart.erase(m_LeftPart.begin()+_i);
-			nAliveLeft--;
-		}
-		else if(p.beh == PlannerHNS::BEH_BRANCH_RIGHT_STATE && nAliveRight > BEH_MIN_PARTICLE_NUM)
-		{
-			m_RightPart.erase(m_RightPart.begin()+_i);
-			nAliveRight--;
+			m_Particles.Add(_beh, x, y, z, a, v, vel);
+			nAlive++;
 		}
 	}
 
-	void CalcAverages()
+	void DeleteParticles(std::vector<bool>& bRemove)
 	{
-		w_avg_forward = 0;
-		double avg_sum = 0;
-		for(unsigned int i = 0; i < m_ForwardPart.size(); i++)
+		for(unsigned int i = 0; i < bRemove.size(); i++)
 		{
-			avg_sum += m_ForwardPart.at(i).w;
-		}
-		if(m_ForwardPart.size() > 0)
-			w_avg_forward = avg_sum/(double)m_ForwardPart.size();
+			if(!bRemove.at(i)) continue;
 
-		w_avg_left = 0;
-		avg_sum = 0;
-		for(unsigned int i = 0; i < m_LeftPart.size(); i++)
-		{
-			avg_sum += m_LeftPart.at(i).w;
+			int& nAlive = GetAliveCount(m_Particles.beh.at(i));
+			if(nAlive > BEH_MIN_PARTICLE_NUM)
+				nAlive--;
+			else
+				bRemove.at(i) = false;
 		}
-		if(m_LeftPart.size() > 0)
-			w_avg_left = avg_sum/(double)m_LeftPart.size();
 
-		w_avg_right = 0;
-		avg_sum = 0;
-		for(unsigned int i = 0; i < m_RightPart.size(); i++)
-		{
-			avg_sum += m_RightPart.at(i).w;
-		}
-		if(m_RightPart.size() > 0)
-			w_avg_right = avg_sum/(double)m_RightPart.size();
+		m_Particles.Remove(bRemove);
+	}
 
-		w_avg_stop = 0;
-		avg_sum = 0;
-		for(unsigned int i = 0; i < m_StopPart.size(); i++)
+	void CalcAverages()
+	{
+		double sum_forward = 0, sum_stop = 0, sum_yield = 0, sum_left = 0, sum_right = 0;
+		int n_forward = 0, n_stop = 0, n_yield = 0, n_left = 0, n_right = 0;
+		for(unsigned int i = 0; i < m_Particles.size(); i++)
 		{
-			avg_sum += m_StopPart.at(i).w;
+			double w = m_Particles.w.at(i);
+			switch(m_Particles.beh.at(i))
+			{
+			case PlannerHNS::BEH_FORWARD_STATE:
+				sum_forward += w; n_forward++; break;
+			case PlannerHNS::BEH_YIELDING_STATE:
+				sum_yield += w; n_yield++; break;
+			case PlannerHNS::BEH_BRANCH_LEFT_STATE:
+				sum_left += w; n_left++; break;
+			case PlannerHNS::BEH_BRANCH_RIGHT_STATE:
+				sum_right += w; n_right++; break;
+			default:
+				sum_stop += w; n_stop++; break;
+			}
 		}
-		if(m_StopPart.size() > 0)
-			w_avg_stop = avg_sum/(double)m_StopPart.size();
 
-		w_avg_yield = 0;
-		avg_sum = 0;
-		for(unsigned int i = 0; i < m_YieldPart.size(); i++)
-		{
-			avg_sum += m_YieldPart.at(i).w;
-		}
-		if(m_YieldPart.size() > 0)
-			w_avg_yield = avg_sum/(double)m_YieldPart.size();
+		w_avg_forward = n_forward > 0 ? sum_forward/(double)n_forward : 0;
+		w_avg_stop = n_stop > 0 ? sum_stop/(double)n_stop : 0;
+		w_avg_yield = n_yield > 0 ? sum_yield/(double)n_yield : 0;
+		w_avg_left = n_left > 0 ? sum_left/(double)n_left : 0;
+		w_avg_right = n_right > 0 ? sum_right/(double)n_right : 0;
 	}
 
 	void CalcProbabilities()
@@ -519,8 +547,6 @@ public:
 	std::vector<TrajectoryTracker*> m_TrajectoryTracker;
 	std::vector<TrajectoryTracker*> m_TrajectoryTracker_temp;
 
-	std::vector<Particle*> m_AllParticles;
-
 	TrajectoryTracker* best_beh_track;
 	int i_best_track;
 
@@ -561,6 +587,14 @@ public:
 	double p_left_branch;
 	double p_right_branch;
 
+	bool m_bCanDecide;
+
+	//lane trajectories of the last prediction from the map, reused while the object stays in its lane segment
+	std::vector<std::vector<WayPoint> > m_CachedTrajectories;
+	std::vector<WayPoint*> m_CachedClosestWaypoints;
+	double m_CachedPredictionDistance;
+	bool m_bCachedDirection;
+
 	virtual ~ObjParticles()
 	{
 		DeleteTheRest(m_TrajectoryTracker);
@@ -605,6 +639,10 @@ public:
 		p_yield = 0;
 		p_left_branch = 0;
 		p_right_branch = 0;
+
+		m_bCanDecide = true;
+		m_CachedPredictionDistance = 0;
+		m_bCachedDirection = false;
 	}
 
 //	void CalculateProbabilities()
@@ -785,6 +823,8 @@ public:
 	BehaviorPrediction();
 	virtual ~BehaviorPrediction();
 	void DoOneStep(const std::vector<DetectedObject>& obj_list, const WayPoint& currPose, const double& minSpeed, const double& maxDeceleration, RoadNetwork& map);
+	//drops the lane trajectories and waypoints cached from the map, to be called when the map is loaded again
+	void ClearMapCache();
 
 public:
 	std::vector<PassiveDecisionMaker*> m_d_makers;
@@ -794,6 +834,8 @@ public:
 	bool m_bUseFixedPrediction;
 	bool m_bStepByStep;
 	bool m_bParticleFilter;
+	unsigned int m_nParticleFilterThreads;
+	unsigned int m_SamplingSeed; //0 seeds the particle sampling from the clock
 	//std::vector<DetectedObject> m_PredictedObjects;
 	//std::vector<DetectedObject*> m_PredictedObjectsII;
 
@@ -812,6 +854,8 @@ public:
 
 
 protected:
+	const RoadNetwork* m_pCachedMap;
+
 	//int GetTrajectoryPredictedDirection(const std::vector<WayPoint>& path, const PlannerHNS::WayPoint& pose, const double& pred_distance);
 	int FromIndicatorToNumber(const PlannerHNS::LIGHT_INDICATOR& ind);
 	PlannerHNS::LIGHT_INDICATOR FromNumbertoIndicator(const int& num);
@@ -820,30 +864,22 @@ protected:
 
 	void CalPredictionTimeForObject(ObjParticles* pCarPart);
 	void PredictCurrentTrajectory(RoadNetwork& map, ObjParticles* pCarPart);
+	bool ReuseCachedTrajectories(ObjParticles* pCarPart);
 	void FilterObservations(const std::vector<DetectedObject>& obj_list, RoadNetwork& map, std::vector<DetectedObject>& filtered_list);
 	void ExtractTrajectoriesFromMap(const std::vector<DetectedObject>& obj_list, RoadNetwork& map, std::vector<ObjParticles*>& old_list);
 	void CalculateCollisionTimes(const double& minSpeed);
 
 	void ParticleFilterSteps(std::vector<ObjParticles*>& part_info);
+	void ParticleFilterOneObject(ObjParticles* pParts, const double& dt, const bool& bMove);
 
 	void SamplesFreshParticles(ObjParticles* pParts);
-	void MoveParticles(ObjParticles* parts);
+	void MoveParticles(ObjParticles* parts, const double& dt);
 	void CalculateWeights(ObjParticles* pParts);
 
-	void CalOnePartWeight(ObjParticles* pParts,Particle& p);
-	void NormalizeOnePartWeight(ObjParticles* pParts,Particle& p);
-
-	void CollectParticles(ObjParticles* pParts);
-
 	void RemoveWeakParticles(ObjParticles* pParts);
 	void FindBest(ObjParticles* pParts);
 	void CalculateAveragesAndProbabilities(ObjParticles* pParts);
 
-	static bool sort_weights(const Particle* p1, const Particle* p2)
-	{
-		return p1->w > p2->w;
-	}
-
 	static bool sort_trajectories(const std::pair<int, double>& p1, const std::pair<int, double>& p2)
 	{
 		return p1.second > p2.second;
@@ -0,0 +1,85 @@
+
+/// \file LaneRouter.h
+/// \brief Global route search over a lane level graph precomputed from the RoadNetwork
+/// \date Oct 19, 2026
+
+
+#ifndef LANEROUTER_H_
+#define LANEROUTER_H_
+
+#include <unordered_map>
+#include "RoadNetwork.h"
+
+namespace PlannerHNS
+{
+
+// Route search over lanes instead of waypoints. Each lane keeps the accumulated distance of its waypoints and the
+// points where it can be left, to a following lane or by a lane change. A search state is a lane and the waypoint it is
+// entered from, states are expanded with A* (binary heap, euclidean heuristic). Costs are the same as in
+// BuildPlanningSearchTreeV2 and the route is returned as the same tree of waypoint copies.
+// Action costs are read from the map on every search, planners may change them in place (blocked waypoints, HMI
+// branches) without rebuilding the graph. Changes to the lanes or their links need BuildGraph() again.
+class LaneRouter
+{
+public:
+	LaneRouter();
+	virtual ~LaneRouter();
+
+	// the map must not be modified or moved while the graph is used
+	void BuildGraph(RoadNetwork& map);
+
+	bool IsBuiltFor(const RoadNetwork& map) const;
+
+	// pStart and pGoal are waypoints of the map. Returns the last waypoint of the route tree, NULL if there is no route.
+	// Like BuildPlanningSearchTreeV2, with an empty globalPath the search stops at DistanceLimit and returns a partial route,
+	// otherwise it only drives along the lanes of globalPath, lane changes are allowed out of any lane. A lane change
+	// needs LANE_CHANGE_MIN_DISTANCE driven since the start, LANE_CHANGE_MIN_DISTANCE*4 since the previous change.
+	// BuildPlanningSearchTreeV2 counts that distance over all the expanded waypoints, here it is counted along the route.
+	WayPoint* FindRoute(WayPoint* pStart, WayPoint* pGoal, const std::vector<int>& globalPath, const double& DistanceLimit,
+			const bool& bEnableLaneChange, std::vector<WayPoint*>& all_cells_to_delete) const;
+
+private:
+	enum EXIT_TYPE {EXIT_FORWARD, EXIT_LEFT, EXIT_RIGHT};
+
+	struct LaneExit
+	{
+		int iFrom; // waypoint index in this lane
+		int iLane; // next lane
+		int iTo; // waypoint index in the next lane
+		double distance; // from the waypoint at iFrom to the one at iTo
+		EXIT_TYPE type;
+	};
+
+	struct LaneNode
+	{
+		Lane* pLane;
+		const WayPoint* pFirstPoint; // to detect a reloaded map
+		std::vector<double> accumDistance; // from the first waypoint
+		std::vector<LaneExit> exits; // sorted by iFrom
+	};
+
+	struct SearchState
+	{
+		int iLane;
+		int iEntry;
+		double cost;
+		double changeDistance; // driven since the last lane change, up to the entry waypoint
+		int iParent;
+		EXIT_TYPE entryType;
+		int iParentExit; // waypoint index where the parent lane is left
+		bool bClosed;
+	};
+
+	std::vector<LaneNode> m_Lanes;
+	std::unordered_map<const Lane*, int> m_LaneIndex;
+	std::vector<const Lane*> m_SegmentsLanes; // lanes of each road segment, to detect a reloaded map
+	unsigned int m_nLanes;
+
+	int GetLaneIndex(const WayPoint* pWP, int& iPoint) const;
+	WayPoint* CreateRouteTree(WayPoint* pStart, const std::vector<SearchState>& states, const int& iLast,
+			const int& iLastPoint, std::vector<WayPoint*>& all_cells_to_delete) const;
+};
+
+} /* namespace PlannerHNS */
+
+#endif /* LANEROUTER_H_ */
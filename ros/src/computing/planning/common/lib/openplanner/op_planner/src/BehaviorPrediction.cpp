@@ -10,6 +10,10 @@
 #include "op_planner/MappingHelpers.h"
 #include "op_planner/PlanningHelpers.h"
 #include "op_planner/MatrixOperations.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <unordered_map>
 
 
 namespace PlannerHNS
@@ -24,6 +28,9 @@ BehaviorPrediction::BehaviorPrediction()
 	m_bStepByStep = false;
 	m_bCanDecide = true;
 	m_bParticleFilter = false;
+	m_nParticleFilterThreads = std::max(1u, std::thread::hardware_concurrency());
+	m_SamplingSeed = 0;
+	m_pCachedMap = nullptr;
 	UtilityHNS::UtilityH::GetTickCount(m_GenerationTimer);
 	UtilityHNS::UtilityH::GetTickCount(m_ResamplingTimer);
 	m_bFirstMove = true;
@@ -85,6 +92,12 @@ void BehaviorPrediction::DoOneStep(const std::vector<DetectedObject>& obj_list,
 	if(!m_bUseFixedPrediction && maxDeceleration !=0)
 		m_PredictionDistance = -pow(currPose.v, 2)/(maxDeceleration);
 
+	if(&map != m_pCachedMap)
+	{
+		ClearMapCache();
+		m_pCachedMap = &map;
+	}
+
 	ExtractTrajectoriesFromMap(obj_list, map, m_ParticleInfo_II);
 	CalculateCollisionTimes(minSpeed);
 
@@ -94,6 +107,16 @@ void BehaviorPrediction::DoOneStep(const std::vector<DetectedObject>& obj_list,
 	}
 }
 
+void BehaviorPrediction::ClearMapCache()
+{
+	for(unsigned int i=0; i < m_ParticleInfo_II.size(); i++)
+	{
+		m_ParticleInfo_II.at(i)->m_CachedTrajectories.clear();
+		m_ParticleInfo_II.at(i)->m_CachedClosestWaypoints.clear();
+		m_ParticleInfo_II.at(i)->obj.pClosestWaypoints.clear();
+	}
+}
+
 void BehaviorPrediction::CalculateCollisionTimes(const double& minSpeed)
 {
 	for(unsigned int i=0; i < m_ParticleInfo_II.size(); i++)
@@ -108,43 +131,25 @@ void BehaviorPrediction::CalculateCollisionTimes(const double& minSpeed)
 
 void BehaviorPrediction::ExtractTrajectoriesFromMap(const std::vector<DetectedObject>& curr_obj_list,RoadNetwork& map, std::vector<ObjParticles*>& old_obj_list)
 {
-	PlannerH planner;
 	m_temp_list_ii.clear();
 
-	std::vector<ObjParticles*> delete_me_list = old_obj_list;
+	std::unordered_map<int, ObjParticles*> old_objects;
+	for(unsigned int ip=0; ip < old_obj_list.size(); ip++)
+	{
+		if(!old_objects.insert(std::make_pair(old_obj_list.at(ip)->obj.id, old_obj_list.at(ip))).second)
+			delete old_obj_list.at(ip);
+	}
 
 	for(unsigned int i=0; i < curr_obj_list.size(); i++)
 	{
-		bool bMatch = false;
-		for(unsigned int ip=0; ip < old_obj_list.size(); ip++)
+		std::unordered_map<int, ObjParticles*>::iterator it = old_objects.find(curr_obj_list.at(i).id);
+		if(it != old_objects.end())
 		{
-			if(old_obj_list.at(ip)->obj.id == curr_obj_list.at(i).id)
-			{
-				bool bFound = false;
-				for(unsigned int k=0; k < m_temp_list_ii.size(); k++)
-				{
-					if(m_temp_list_ii.at(k) == old_obj_list.at(ip))
-					{
-						bFound = true;
-						break;
-					}
-				}
-
-				if(!bFound)
-				{
-					old_obj_list.at(ip)->obj = curr_obj_list.at(i);
-					m_temp_list_ii.push_back(old_obj_list.at(ip));
-				}
-
-				DeleteFromList(delete_me_list, old_obj_list.at(ip));
-
-				old_obj_list.erase(old_obj_list.begin()+ip);
-				bMatch = true;
-				break;
-			}
+			it->second->obj = curr_obj_list.at(i);
+			m_temp_list_ii.push_back(it->second);
+			old_objects.erase(it);
 		}
-
-		if(!bMatch)
+		else
 		{
 			ObjParticles* pNewObj = new  ObjParticles();
 			pNewObj->obj = curr_obj_list.at(i);
@@ -152,7 +157,9 @@ void BehaviorPrediction::ExtractTrajectoriesFromMap(const std::vector<DetectedOb
 		}
 	}
 
-	DeleteTheRest(delete_me_list);
+	for(std::unordered_map<int, ObjParticles*>::iterator it = old_objects.begin(); it != old_objects.end(); it++)
+		delete it->second;
+
 	old_obj_list.clear();
 	old_obj_list = m_temp_list_ii;
 
@@ -177,6 +184,9 @@ void BehaviorPrediction::CalPredictionTimeForObject(ObjParticles* pCarPart)
 void BehaviorPrediction::PredictCurrentTrajectory(RoadNetwork& map, ObjParticles* pCarPart)
 {
 	pCarPart->obj.predTrajectories.clear();
+	if(ReuseCachedTrajectories(pCarPart))
+		return;
+
 	PlannerH planner;
 	if(pCarPart->obj.bDirection && pCarPart->obj.bVelocity)
 	{
@@ -208,20 +218,125 @@ void BehaviorPrediction::PredictCurrentTrajectory(RoadNetwork& map, ObjParticles
 		if(pCarPart->obj.predTrajectories.at(t).size() > 0)
 			pCarPart->obj.predTrajectories.at(t).at(0).collisionCost = 0;
 	}
+
+	//manual branches don't follow the lanes, they are generated again every time
+	pCarPart->m_CachedTrajectories.clear();
+	pCarPart->m_CachedClosestWaypoints.clear();
+	if(!(pCarPart->obj.bDirection && pCarPart->obj.bVelocity && m_bGenerateBranches))
+	{
+		pCarPart->m_CachedTrajectories = pCarPart->obj.predTrajectories;
+		pCarPart->m_CachedClosestWaypoints = pCarPart->obj.pClosestWaypoints;
+		pCarPart->m_CachedPredictionDistance = m_PredictionDistance;
+		pCarPart->m_bCachedDirection = pCarPart->obj.bDirection && pCarPart->obj.bVelocity;
+	}
+}
+
+bool BehaviorPrediction::ReuseCachedTrajectories(ObjParticles* pCarPart)
+{
+	if(pCarPart->m_CachedTrajectories.size() == 0 || pCarPart->m_bCachedDirection != (pCarPart->obj.bDirection && pCarPart->obj.bVelocity))
+		return false;
+
+	//the object should still be in the lane segment it was predicted from, and the cached trajectories long enough
+	std::vector<std::vector<WayPoint> > trajectories;
+	double lane_angle = 0;
+	for(unsigned int t = 0; t < pCarPart->m_CachedTrajectories.size(); t++)
+	{
+		const std::vector<WayPoint>& cached = pCarPart->m_CachedTrajectories.at(t);
+		if(cached.size() < 2)
+			return false;
+
+		RelativeInfo info;
+		PlanningHelpers::GetRelativeInfo(cached, pCarPart->obj.center, info);
+		if(info.bAfter || fabs(info.perp_distance) > m_MaxLaneDetectionDistance || cached.at(info.iFront).laneId != cached.at(1).laneId)
+			return false;
+
+		double remaining = pCarPart->m_CachedPredictionDistance - cached.at(info.iBack).cost - info.from_back_distance;
+		if(remaining < m_PredictionDistance*(1.0 - PREDICTION_DISTANCE_PERCENTAGE) || remaining > m_PredictionDistance*(1.0 + PREDICTION_DISTANCE_PERCENTAGE))
+			return false;
+
+		if(t == 0)
+			lane_angle = cached.at(info.iFront).pos.a;
+
+		//same start point as PlannerH::PredictTrajectoriesUsingDP
+		std::vector<WayPoint> path;
+		path.push_back(pCarPart->obj.center);
+		path.insert(path.end(), cached.begin()+info.iFront, cached.end());
+		if(!pCarPart->m_bCachedDirection)
+			path.at(0).pos.a = path.at(1).pos.a;
+		path.at(0).beh_state = path.at(1).beh_state = PlannerHNS::BEH_FORWARD_STATE;
+		path.at(0).laneId = path.at(1).laneId;
+		PlanningHelpers::CalcAngleAndCost(path);
+		path.at(0).collisionCost = 0;
+		trajectories.push_back(path);
+	}
+
+	if(!pCarPart->m_bCachedDirection)
+		pCarPart->obj.center.pos.a = lane_angle;
+
+	pCarPart->obj.predTrajectories = trajectories;
+	pCarPart->obj.pClosestWaypoints = pCarPart->m_CachedClosestWaypoints;
+	return true;
 }
 
 void BehaviorPrediction::ParticleFilterSteps(std::vector<ObjParticles*>& part_info)
 {
-	for(unsigned int i=0; i < part_info.size(); i++)
+	//same time step for all objects, they are moved in parallel
+	double dt = 0.01;
+	bool bMove = true;
+	if(m_bStepByStep)
+	{
+		dt = 0.08;
+	}
+	else
+	{
+		dt = UtilityHNS::UtilityH::GetTimeDiffNow(m_ResamplingTimer);
+		UtilityHNS::UtilityH::GetTickCount(m_ResamplingTimer);
+		if(m_bFirstMove)
+		{
+			m_bFirstMove  = false;
+			bMove = false;
+		}
+	}
+
+	if(UtilityHNS::UtilityH::GetTimeDiffNow(m_GenerationTimer) > 2)
+		UtilityHNS::UtilityH::GetTickCount(m_GenerationTimer);
+
+	unsigned int nThreads = std::min<unsigned int>(std::max(1u, m_nParticleFilterThreads), part_info.size());
+	if(nThreads <= 1 || m_bDebugOut)
 	{
-		SamplesFreshParticles(part_info.at(i));
-		CollectParticles(part_info.at(i));
-		MoveParticles(part_info.at(i));
-		CalculateWeights(part_info.at(i));
-		RemoveWeakParticles(part_info.at(i));
-		CalculateAveragesAndProbabilities(part_info.at(i));
-		FindBest(part_info.at(i));
+		for(unsigned int i=0; i < part_info.size(); i++)
+			ParticleFilterOneObject(part_info.at(i), dt, bMove);
 	}
+	else
+	{
+		std::atomic<unsigned int> next_obj(0);
+		std::vector<std::thread> threads;
+		for(unsigned int it = 0; it < nThreads; it++)
+		{
+			threads.push_back(std::thread([&]()
+			{
+				for(unsigned int i = next_obj++; i < part_info.size(); i = next_obj++)
+					ParticleFilterOneObject(part_info.at(i), dt, bMove);
+			}));
+		}
+
+		for(unsigned int it = 0; it < threads.size(); it++)
+			threads.at(it).join();
+	}
+
+	if(part_info.size() > 0)
+		m_bCanDecide = part_info.back()->m_bCanDecide;
+}
+
+void BehaviorPrediction::ParticleFilterOneObject(ObjParticles* pParts, const double& dt, const bool& bMove)
+{
+	SamplesFreshParticles(pParts);
+	if(bMove)
+		MoveParticles(pParts, dt);
+	CalculateWeights(pParts);
+	RemoveWeakParticles(pParts);
+	CalculateAveragesAndProbabilities(pParts);
+	FindBest(pParts);
 }
 
 int BehaviorPrediction::FromIndicatorToNumber(const PlannerHNS::LIGHT_INDICATOR& indi)
@@ -270,118 +385,6 @@ double BehaviorPrediction::CalcAccelerationWeight(int p_acl, int obj_acl)
 		return 0.01;
 }
 
-void BehaviorPrediction::CalOnePartWeight(ObjParticles* pParts,Particle& p)
-{
-	if(p.bDeleted) return;
-
-	//p.pose_w = exp(-(0.5*pow((p.pose.pos.x - pParts->obj.center.pos.x),2)/(2*MEASURE_POSE_ERROR*MEASURE_POSE_ERROR)+ pow((p.pose.pos.y - pParts->obj.center.pos.y),2)/(2*MEASURE_POSE_ERROR*MEASURE_POSE_ERROR)));
-	p.pose_w = 1.0/hypot(0.5*(p.pose.pos.y - pParts->obj.center.pos.y), 0.5*(p.pose.pos.x - pParts->obj.center.pos.x));
-	//p.dir_w  = exp(-(pow(fabs(UtilityHNS::UtilityH::AngleBetweenTwoAnglesPositive(p.pose.pos.a,  pParts->obj.center.pos.a)),2)/(2*MEASURE_ANGLE_ERROR*MEASURE_ANGLE_ERROR)));
-	p.dir_w  = M_PI_2 - fabs(UtilityHNS::UtilityH::AngleBetweenTwoAnglesPositive(p.pose.pos.a,  pParts->obj.center.pos.a));
-	p.vel_w  = exp(-(pow((p.vel - pParts->obj.center.v),2)/(2*MEASURE_VEL_ERROR*MEASURE_VEL_ERROR)));
-	//p.vel_w = fabs(p.vel - pParts->obj.center.v);
-	p.ind_w  = CalcIndicatorWeight(FromNumbertoIndicator(p.indicator), pParts->obj.indicator_state);
-	p.ind_w  -= p.ind_w*MEASURE_IND_ERROR;
-	p.acl_w = CalcAccelerationWeight(p.acc, pParts->obj.acceleration_desc);
-
-	//std::cout << p.beh << "|" << p.vel_w <<"|" <<p.vel << "|" << pParts->obj.center.v;
-
-	pParts->pose_w_t += p.pose_w;
-	pParts->dir_w_t += p.dir_w;
-	pParts->vel_w_t += p.vel_w;
-	pParts->ind_w_t += p.ind_w;
-	pParts->acl_w_t += p.acl_w;
-
-	if(p.pose_w > pParts->pose_w_max)
-		pParts->pose_w_max = p.pose_w;
-	if(p.dir_w > pParts->dir_w_max)
-		pParts->dir_w_max = p.dir_w;
-	if(p.vel_w > pParts->vel_w_max)
-		pParts->vel_w_max = p.vel_w;
-	if(p.ind_w > pParts->ind_w_max)
-		pParts->ind_w_max = p.ind_w;
-	if(p.acl_w > pParts->acl_w_max)
-		pParts->acl_w_max = p.acl_w;
-
-	if(p.pose_w < pParts->pose_w_min)
-		pParts->pose_w_min = p.pose_w;
-	if(p.dir_w < pParts->dir_w_min)
-		pParts->dir_w_min = p.dir_w;
-	if(p.vel_w < pParts->vel_w_min)
-		pParts->vel_w_min = p.vel_w;
-	if(p.ind_w < pParts->ind_w_min)
-		pParts->ind_w_min = p.ind_w;
-	if(p.acl_w < pParts->acl_w_min)
-		pParts->acl_w_min = p.acl_w;
-
-	p.w_raw = p.pose_w*POSE_FACTOR + p.dir_w*DIRECTION_FACTOR + p.vel_w*VELOCITY_FACTOR + p.ind_w*INDICATOR_FACTOR + p.acl_w*ACCELERATE_FACTOR;
-
-	if(p.w_raw >= pParts->max_w_raw)
-		pParts->max_w_raw = p.w_raw;
-
-	if(p.w_raw <= pParts->min_w_raw)
-		pParts->min_w_raw = p.w_raw;
-}
-
-void BehaviorPrediction::NormalizeOnePartWeight(ObjParticles* pParts,Particle& p)
-{
-	if(p.bDeleted) return;
-
-	double pose_diff  = pParts->pose_w_max-pParts->pose_w_min;
-	double dir_diff = pParts->dir_w_max-pParts->dir_w_min;
-	double vel_diff = pParts->vel_w_max-pParts->vel_w_min;
-	double ind_diff = pParts->ind_w_max-pParts->ind_w_min;
-	double acl_diff = pParts->acl_w_max-pParts->acl_w_min;
-
-	double epsilon = 0.05;
-
-	if(fabs(pose_diff) > epsilon)
-		p.pose_w = p.pose_w/pose_diff;
-	else
-		p.pose_w = 0;
-
-	if(p.pose_w > 1.0 ) p.pose_w = 1.0;
-
-	if(fabs(dir_diff) > epsilon)
-		p.dir_w = (p.dir_w - pParts->dir_w_min)/dir_diff;
-	else
-		p.dir_w = 0;
-
-	if(p.dir_w > 1.0 ) p.dir_w = 1.0;
-
-	if(fabs(vel_diff) > epsilon)
-		p.vel_w = (p.vel_w-pParts->vel_w_min)/vel_diff;
-	else
-		p.vel_w = 0;
-
-	if(p.vel_w > 1.0) p.vel_w = 1.0;
-
-	if(fabs(ind_diff) > epsilon)
-		p.ind_w = (p.ind_w - pParts->ind_w_min)/ind_diff;
-	else
-		p.ind_w = 0;
-
-	if(p.ind_w > 1.0) p.ind_w = 1.0;
-
-	if(fabs(acl_diff) > epsilon)
-		p.acl_w = (p.acl_w - pParts->acl_w_min)/acl_diff;
-	else
-		p.acl_w = 0;
-
-	if(p.acl_w > 1.0) p.acl_w = 1.0;
-
-	p.w = p.pose_w*POSE_FACTOR + p.dir_w*DIRECTION_FACTOR + p.vel_w*VELOCITY_FACTOR + p.ind_w*INDICATOR_FACTOR + p.acl_w*ACCELERATE_FACTOR;
-	//p.w = p.pose_w*0.1 + p.vel_w*0.2 + p.dir_w * 0.2 + p.ind_w + 0.5;
-
-	if(p.w >= pParts->max_w)
-		pParts->max_w = p.w;
-
-	if(p.w <= pParts->min_w)
-		pParts->min_w = p.w;
-
-	  pParts->all_w += p.w;
-}
-
 void BehaviorPrediction::CalculateWeights(ObjParticles* pParts)
 {
 	pParts->all_w = 0;
@@ -403,31 +406,130 @@ void BehaviorPrediction::CalculateWeights(ObjParticles* pParts)
 	pParts->max_w_raw = DBL_MIN;
 	pParts->min_w_raw = DBL_MAX;
 
-	//std::cout << "Acceleration Diff: ";
-	for(unsigned int i = 0 ; i < pParts->m_AllParticles.size(); i++)
+	const double obj_x = pParts->obj.center.pos.x;
+	const double obj_y = pParts->obj.center.pos.y;
+	const double obj_a = pParts->obj.center.pos.a;
+	const double obj_v = pParts->obj.center.v;
+	const int obj_acl = pParts->obj.acceleration_desc;
+
+	//same as CalcIndicatorWeight and CalcAccelerationWeight, as numbers so the loop below has no calls
+	int obj_ind = -1;
+	if(pParts->obj.indicator_state == PlannerHNS::INDICATOR_LEFT || pParts->obj.indicator_state == PlannerHNS::INDICATOR_RIGHT || pParts->obj.indicator_state == PlannerHNS::INDICATOR_NONE)
+		obj_ind = FromIndicatorToNumber(pParts->obj.indicator_state);
+	const double ind_match = 0.99 - 0.99*MEASURE_IND_ERROR;
+	const double ind_miss = 0.01 - 0.01*MEASURE_IND_ERROR;
+
+	//plain arrays without range checks, so the compiler can vectorize the loops over the particles
+	for(unsigned int t = 0; t < pParts->m_TrajectoryTracker.size(); t++)
 	{
-	  //  std::cout << "(" << pParts->m_AllParticles.at(i)->pTraj->index <<",";
-	    CalOnePartWeight(pParts, *pParts->m_AllParticles.at(i));
-	    //std::cout << ")";
-	}
+		ParticleSet& ps = pParts->m_TrajectoryTracker.at(t)->m_Particles;
+		const unsigned int n = ps.size();
+		const double* x = ps.x.data();
+		const double* y = ps.y.data();
+		const double* a = ps.a.data();
+		const double* vel = ps.vel.data();
+		const int* acc = ps.acc.data();
+		const int* ind = ps.indicator.data();
+		double* pose_w = ps.pose_w.data();
+		double* dir_w = ps.dir_w.data();
+		double* vel_w = ps.vel_w.data();
+		double* ind_w = ps.ind_w.data();
+		double* acl_w = ps.acl_w.data();
+		double* w_raw = ps.w_raw.data();
+
+		for(unsigned int i = 0; i < n; i++)
+		{
+			double dx = 0.5*(x[i] - obj_x);
+			double dy = 0.5*(y[i] - obj_y);
+			pose_w[i] = 1.0/sqrt(dx*dx + dy*dy);
+			double a_diff = fabs(a[i] - obj_a);
+			dir_w[i] = M_PI_2 - fabs(a_diff > M_PI ? 2.0*M_PI - a_diff : a_diff);
+			double v_diff = vel[i] - obj_v;
+			vel_w[i] = exp(-(v_diff*v_diff/(2*MEASURE_VEL_ERROR*MEASURE_VEL_ERROR)));
+			ind_w[i] = ind[i] == obj_ind ? ind_match : ind_miss;
+			acl_w[i] = ((acc[i] > 0 && obj_acl > 0) || (acc[i] < 0 && obj_acl < 0)) ? 0.99 : 0.01;
+			w_raw[i] = pose_w[i]*POSE_FACTOR + dir_w[i]*DIRECTION_FACTOR + vel_w[i]*VELOCITY_FACTOR + ind_w[i]*INDICATOR_FACTOR + acl_w[i]*ACCELERATE_FACTOR;
+		}
 
-	//std::cout << "Befor Normalize: Max: " <<  pParts->acl_w_max << ", Min: " << pParts->acl_w_min << std::endl;
-	//std::cout << std::endl;
+		for(unsigned int i = 0; i < n; i++)
+		{
+			pParts->pose_w_t += pose_w[i];
+			pParts->dir_w_t += dir_w[i];
+			pParts->vel_w_t += vel_w[i];
+			pParts->ind_w_t += ind_w[i];
+			pParts->acl_w_t += acl_w[i];
+
+			pParts->pose_w_max = std::max(pParts->pose_w_max, pose_w[i]);
+			pParts->dir_w_max = std::max(pParts->dir_w_max, dir_w[i]);
+			pParts->vel_w_max = std::max(pParts->vel_w_max, vel_w[i]);
+			pParts->ind_w_max = std::max(pParts->ind_w_max, ind_w[i]);
+			pParts->acl_w_max = std::max(pParts->acl_w_max, acl_w[i]);
+
+			pParts->pose_w_min = std::min(pParts->pose_w_min, pose_w[i]);
+			pParts->dir_w_min = std::min(pParts->dir_w_min, dir_w[i]);
+			pParts->vel_w_min = std::min(pParts->vel_w_min, vel_w[i]);
+			pParts->ind_w_min = std::min(pParts->ind_w_min, ind_w[i]);
+			pParts->acl_w_min = std::min(pParts->acl_w_min, acl_w[i]);
+
+			pParts->max_w_raw = std::max(pParts->max_w_raw, w_raw[i]);
+			pParts->min_w_raw = std::min(pParts->min_w_raw, w_raw[i]);
+		}
+	}
 
 	//if((pParts->m_TrajectoryTracker.size() > 1 && pParts->min_w_raw < 0.5) || pParts->max_w_raw == 0 || fabs(pParts->max_w_raw - pParts->min_w_raw) < 0.1 )
 	if((pParts->max_w_raw == 0 || fabs(pParts->max_w_raw - pParts->min_w_raw) < 0.1 || pParts->min_w_raw > 0.5) && pParts->m_TrajectoryTracker.size() > 1)
-		m_bCanDecide = false;
+		pParts->m_bCanDecide = false;
 	else
-		m_bCanDecide = true;
+		pParts->m_bCanDecide = true;
 
 	//Normalize
 	pParts->max_w = -9999999;
 	pParts->min_w = 9999999;
 	pParts->all_w = 0;
 
-	for(unsigned int i = 0 ; i < pParts->m_AllParticles.size(); i++)
+	const double epsilon = 0.05;
+	const double pose_diff = pParts->pose_w_max-pParts->pose_w_min;
+	const double dir_diff = pParts->dir_w_max-pParts->dir_w_min;
+	const double vel_diff = pParts->vel_w_max-pParts->vel_w_min;
+	const double ind_diff = pParts->ind_w_max-pParts->ind_w_min;
+	const double acl_diff = pParts->acl_w_max-pParts->acl_w_min;
+	const bool bPose = fabs(pose_diff) > epsilon;
+	const bool bDir = fabs(dir_diff) > epsilon;
+	const bool bVel = fabs(vel_diff) > epsilon;
+	const bool bInd = fabs(ind_diff) > epsilon;
+	const bool bAcl = fabs(acl_diff) > epsilon;
+	const double dir_min = pParts->dir_w_min;
+	const double vel_min = pParts->vel_w_min;
+	const double ind_min = pParts->ind_w_min;
+	const double acl_min = pParts->acl_w_min;
+
+	for(unsigned int t = 0; t < pParts->m_TrajectoryTracker.size(); t++)
 	{
-		NormalizeOnePartWeight(pParts, *pParts->m_AllParticles.at(i));
+		ParticleSet& ps = pParts->m_TrajectoryTracker.at(t)->m_Particles;
+		const unsigned int n = ps.size();
+		double* pose_w = ps.pose_w.data();
+		double* dir_w = ps.dir_w.data();
+		double* vel_w = ps.vel_w.data();
+		double* ind_w = ps.ind_w.data();
+		double* acl_w = ps.acl_w.data();
+		double* w = ps.w.data();
+
+		for(unsigned int i = 0; i < n; i++)
+		{
+			pose_w[i] = bPose ? std::min(pose_w[i]/pose_diff, 1.0) : 0;
+			dir_w[i] = bDir ? std::min((dir_w[i] - dir_min)/dir_diff, 1.0) : 0;
+			vel_w[i] = bVel ? std::min((vel_w[i] - vel_min)/vel_diff, 1.0) : 0;
+			ind_w[i] = bInd ? std::min((ind_w[i] - ind_min)/ind_diff, 1.0) : 0;
+			acl_w[i] = bAcl ? std::min((acl_w[i] - acl_min)/acl_diff, 1.0) : 0;
+			w[i] = pose_w[i]*POSE_FACTOR + dir_w[i]*DIRECTION_FACTOR + vel_w[i]*VELOCITY_FACTOR + ind_w[i]*INDICATOR_FACTOR + acl_w[i]*ACCELERATE_FACTOR;
+		}
+
+		for(unsigned int i = 0; i < n; i++)
+		{
+			pParts->max_w = std::max(pParts->max_w, w[i]);
+			pParts->min_w = std::min(pParts->min_w, w[i]);
+			pParts->all_w += w[i];
+		}
 	}
 }
 
@@ -442,28 +544,28 @@ void BehaviorPrediction::CalculateAveragesAndProbabilities(ObjParticles* pParts)
 
 void BehaviorPrediction::RemoveWeakParticles(ObjParticles* pParts)
 {
-
+	//a particle survives while its weight is in the top KEEP_PERCENTAGE of the weight range and it is close to the
+	//object, the alive count of each behavior is its probability. One pass over each trajectory's particles.
 	double critical_val = pParts->min_w + (pParts->max_w - pParts->min_w)*KEEP_PERCENTAGE;
-//	std::cout << "Behavior Weights ------------------------------------------------ " << std::endl;
-//	std::cout << "Max Raw: " << pParts->max_w_raw << ", Min Raw: " << pParts->min_w_raw << std::endl;
-//	std::cout << "Keep Percent Value: " << critical_val <<  std::endl;
-//
-//	if(pParts->obj.acceleration > 0 )
-//		std::cout << "Accelerate vrooom vroom : " << std::endl;
-//	else if(pParts->obj.acceleration  < 0 )
-//		std::cout << "Brake Eeeeee Eeeeeeee: " << std::endl;
+	const double obj_x = pParts->obj.center.pos.x;
+	const double obj_y = pParts->obj.center.pos.y;
+	const double max_d_sqr = m_PredictionDistance*m_PredictionDistance;
 
-	for(int i =0 ; i < pParts->m_AllParticles.size(); i++)
+	std::vector<bool> bRemove;
+	for(unsigned int t = 0; t < pParts->m_TrajectoryTracker.size(); t++)
 	{
-		//also delete far particle
-		double d = hypot(pParts->obj.center.pos.y - pParts->m_AllParticles.at(i)->pose.pos.y, pParts->obj.center.pos.x - pParts->m_AllParticles.at(i)->pose.pos.x);
-
-		if(pParts->m_AllParticles.at(i)->w < critical_val || d > m_PredictionDistance)
+		TrajectoryTracker* pTrack = pParts->m_TrajectoryTracker.at(t);
+		const ParticleSet& ps = pTrack->m_Particles;
+		bRemove.resize(ps.size());
+		for(unsigned int i = 0; i < ps.size(); i++)
 		{
-			pParts->m_AllParticles.at(i)->pTraj->DeleteParticle(*(pParts->m_AllParticles.at(i)), pParts->m_AllParticles.at(i)->original_index);
-			pParts->m_AllParticles.erase(pParts->m_AllParticles.begin()+i);
-			i--;
+			//also delete far particle
+			double dx = obj_x - ps.x[i];
+			double dy = obj_y - ps.y[i];
+			bRemove[i] = ps.w[i] < critical_val || dx*dx + dy*dy > max_d_sqr;
 		}
+
+		pTrack->DeleteParticles(bRemove);
 	}
 }
 
@@ -500,7 +602,7 @@ void BehaviorPrediction::FindBest(ObjParticles* pParts)
 		}
 	}
 
-	if(m_bCanDecide && pParts->best_beh_track != nullptr)
+	if(pParts->m_bCanDecide && pParts->best_beh_track != nullptr)
 	{
 		std::string str_beh = "Unknown";
 		if(pParts->best_beh_track->best_beh == BEH_STOPPING_STATE)
@@ -539,9 +641,8 @@ void BehaviorPrediction::SamplesFreshParticles(ObjParticles* pParts)
 {
 	timespec _time;
 	UtilityHNS::UtilityH::GetTickCount(_time);
-	srand(_time.tv_nsec);
 
-	ENG eng(_time.tv_nsec);
+	ENG eng((m_SamplingSeed != 0 ? m_SamplingSeed : _time.tv_nsec) + pParts->obj.id);
 	NormalDIST dist_x(0, MOTION_POSE_ERROR);
 	VariatGEN gen_x(eng, dist_x);
 	NormalDIST vel(MOTION_VEL_ERROR, MOTION_VEL_ERROR);
@@ -551,19 +652,6 @@ void BehaviorPrediction::SamplesFreshParticles(ObjParticles* pParts)
 //	NormalDIST acl(0, MEASURE_ACL_ERROR);
 //	VariatGEN gen_acl(eng, acl);
 
-	Particle p;
-	p.pose = pParts->obj.center;
-	p.vel = 0;
-	p.acc = 0;
-	p.indicator = 0;
-	bool bRegenerate = true;
-
-	if(UtilityHNS::UtilityH::GetTimeDiffNow(m_GenerationTimer) > 2)
-	{
-		UtilityHNS::UtilityH::GetTickCount(m_GenerationTimer);
-		bRegenerate = true;
-	}
-
 //	for(unsigned int t=0; t < pParts->m_TrajectoryTracker.size(); t++)
 //	{
 //		PlanningHelpers::FixPathDensity(pParts->m_TrajectoryTracker.at(t)->trajectory, 0.5);
@@ -572,87 +660,59 @@ void BehaviorPrediction::SamplesFreshParticles(ObjParticles* pParts)
 
 	for(unsigned int t=0; t < pParts->m_TrajectoryTracker.size(); t++)
 	{
+		TrajectoryTracker* pTrack = pParts->m_TrajectoryTracker.at(t);
 		RelativeInfo info;
-		PlanningHelpers::GetRelativeInfo(pParts->m_TrajectoryTracker.at(t)->trajectory, pParts->obj.center, info);
+		PlanningHelpers::GetRelativeInfo(pTrack->trajectory, pParts->obj.center, info);
 		unsigned int point_index = 0;
-		p.pose = PlanningHelpers::GetFollowPointOnTrajectory(pParts->m_TrajectoryTracker.at(t)->trajectory, info, PREDICTION_DISTANCE_PERCENTAGE*m_PredictionDistance, point_index);
+		WayPoint p = PlanningHelpers::GetFollowPointOnTrajectory(pTrack->trajectory, info, PREDICTION_DISTANCE_PERCENTAGE*m_PredictionDistance, point_index);
 
-		if(pParts->m_TrajectoryTracker.at(t)->beh == PlannerHNS::BEH_FORWARD_STATE && pParts->m_TrajectoryTracker.at(t)->nAliveForward < BEH_PARTICLES_NUM)
+		if(pTrack->beh == PlannerHNS::BEH_FORWARD_STATE && pTrack->nAliveForward < BEH_PARTICLES_NUM)
 		{
-			p.beh = PlannerHNS::BEH_FORWARD_STATE;
-			int nPs = BEH_PARTICLES_NUM - pParts->m_TrajectoryTracker.at(t)->nAliveForward;
+			int nPs = BEH_PARTICLES_NUM - pTrack->nAliveForward;
 
 			for(unsigned int i=0; i < nPs; i++)
 			{
-				Particle p_new = p;
-				p_new.pose.pos.x += gen_x();
-				p_new.pose.pos.y += gen_x();
-				p_new.pose.pos.a += gen_a();
-				p_new.vel = pParts->obj.center.v + fabs(gen_v());
-				p_new.pose.v = p_new.vel;
-				pParts->m_TrajectoryTracker.at(t)->InsertNewParticle(p_new);
+				double x = p.pos.x + gen_x();
+				double y = p.pos.y + gen_x();
+				double a = p.pos.a + gen_a();
+				double v = pParts->obj.center.v + fabs(gen_v());
+				pTrack->InsertNewParticle(PlannerHNS::BEH_FORWARD_STATE, x, y, p.pos.z, a, v, v);
 			}
 		}
 
-		if(ENABLE_STOP_BEHAVIOR_GEN == 1 && pParts->m_TrajectoryTracker.at(t)->nAliveStop < 	BEH_PARTICLES_NUM)
+		if(ENABLE_STOP_BEHAVIOR_GEN == 1 && pTrack->nAliveStop < 	BEH_PARTICLES_NUM)
 		{
-			p.beh = PlannerHNS::BEH_STOPPING_STATE;
-			int nPs = BEH_PARTICLES_NUM - pParts->m_TrajectoryTracker.at(t)->nAliveStop;
+			int nPs = BEH_PARTICLES_NUM - pTrack->nAliveStop;
 
 			for(unsigned int i=0; i < nPs; i++)
 			{
-				Particle p_new = p;
-				p_new.pose.pos.x += gen_x();
-				p_new.pose.pos.y += gen_x();
-				p_new.pose.pos.a += gen_a();
-				p_new.vel = 0;
-				p_new.pose.v = pParts->obj.center.v + fabs(gen_v());
-				pParts->m_TrajectoryTracker.at(t)->InsertNewParticle(p_new);
+				double x = p.pos.x + gen_x();
+				double y = p.pos.y + gen_x();
+				double a = p.pos.a + gen_a();
+				double v = pParts->obj.center.v + fabs(gen_v());
+				pTrack->InsertNewParticle(PlannerHNS::BEH_STOPPING_STATE, x, y, p.pos.z, a, v, 0);
 			}
 		}
 	}
 }
 
-void BehaviorPrediction::CollectParticles(ObjParticles* pParts)
+static inline double SplitAngle(double a)
 {
-	pParts->m_AllParticles.clear();
-	for(unsigned int t=0; t < pParts->m_TrajectoryTracker.size(); t++)
-	{
-		for(unsigned int i=0; i < pParts->m_TrajectoryTracker.at(t)->m_ForwardPart.size(); i++)
-		{
-			pParts->m_TrajectoryTracker.at(t)->m_ForwardPart.at(i).original_index = i;
-			pParts->m_AllParticles.push_back(&pParts->m_TrajectoryTracker.at(t)->m_ForwardPart.at(i));
-		}
+	//UtilityH::SplitPositiveAngle, inlined into the motion loop
+	if(a < -2.0*M_PI || a > 2.0*M_PI)
+		a = fmod(a, 2.0*M_PI);
 
-		for(unsigned int i=0; i < pParts->m_TrajectoryTracker.at(t)->m_StopPart.size(); i++)
-		{
-			pParts->m_TrajectoryTracker.at(t)->m_StopPart.at(i).original_index = i;
-			pParts->m_AllParticles.push_back(&pParts->m_TrajectoryTracker.at(t)->m_StopPart.at(i));
-		}
-	}
+	if(a > M_PI)
+		a -= 2.0*M_PI;
+	else if(a < -M_PI)
+		a += 2.0*M_PI;
+
+	return a;
 }
 
-void BehaviorPrediction::MoveParticles(ObjParticles* pParts)
+void BehaviorPrediction::MoveParticles(ObjParticles* pParts, const double& dt)
 {
-	double dt = 0.01;
-	if(m_bStepByStep)
-	{
-		dt = 0.08;
-	}
-	else
-	{
-		dt = UtilityHNS::UtilityH::GetTimeDiffNow(m_ResamplingTimer);
-		UtilityHNS::UtilityH::GetTickCount(m_ResamplingTimer);
-		if(m_bFirstMove)
-		{
-			m_bFirstMove  = false;
-			return;
-		}
-	}
-
 	PlannerHNS::BehaviorState curr_behavior;
-	PlannerHNS::ParticleInfo curr_part_info;
-	PlannerHNS::VehicleState control_u;
 	PassiveDecisionMaker decision_make;
 	PlannerHNS::CAR_BASIC_INFO carInfo;
 	carInfo.width = pParts->obj.w;
@@ -679,82 +739,127 @@ void BehaviorPrediction::MoveParticles(ObjParticles* pParts)
 //	else
 //		std::cout << "Acceleration: " << pParts->obj.acceleration_raw << ", Cruising  : " << pParts->obj.acceleration_desc << std::endl;
 
-	for(unsigned int i=0; i < pParts->m_AllParticles.size(); i++)
+	WayPoint pose;
+	for(unsigned int t=0; t < pParts->m_TrajectoryTracker.size(); t++)
 	{
-		Particle* p = pParts->m_AllParticles.at(i);
+		const std::vector<WayPoint>& path = pParts->m_TrajectoryTracker.at(t)->trajectory;
+		ParticleSet& ps = pParts->m_TrajectoryTracker.at(t)->m_Particles;
+		const unsigned int n = ps.size();
 
 		if(USE_OPEN_PLANNER_MOVE == 0)
-		  {
-			p->pose.v = pParts->obj.center.v;
-			curr_part_info = decision_make.MoveStepSimple(dt, p->pose, p->pTraj->trajectory,carInfo);
-			if(p->prev_time_diff > ACCELERATION_CALC_TIME)
+		{
+			// PassiveDecisionMaker::MoveStepSimple for all the particles of the trajectory at once. The particles move
+			// with the object speed, so the indicator is the same for all of them, and the stop line check is skipped
+			// because its result is not used.
+			const double obj_v = pParts->obj.center.v;
+			int indicator = 0;
+			ps.target_x.resize(n);
+			ps.target_y.resize(n);
+			ps.path_vel.resize(n);
+
+			if(path.size() > 0)
 			{
-				p->acc_raw = (curr_part_info.vel - p->vel_prev_big)/p->prev_time_diff;
-				p->vel_prev_big = curr_part_info.vel;
-				p->prev_time_diff = 0;
+				double average_braking_distance = -pow(obj_v, 2)/(carInfo.max_deceleration) + 15.0;
+				indicator = FromIndicatorToNumber(PlanningHelpers::GetIndicatorsFromPath(path, path.at(0), average_braking_distance));
+
+				//the trajectory lookups, one particle at a time
+				for(unsigned int i=0; i < n; i++)
+				{
+					pose.pos.x = ps.x[i];
+					pose.pos.y = ps.y[i];
+					pose.pos.a = ps.a[i];
+					RelativeInfo info;
+					PlanningHelpers::GetRelativeInfo(path, pose, info);
+					ps.path_vel[i] = info.iFront < path.size() ? path.at(info.iFront).v : 0;
+					unsigned int point_index = 0;
+					WayPoint pursuite_point = PlanningHelpers::GetFollowPointOnTrajectory(path, info, 2, point_index);
+					ps.target_x[i] = pursuite_point.pos.x;
+					ps.target_y[i] = pursuite_point.pos.y;
+				}
+
+				double* x = ps.x.data();
+				double* y = ps.y.data();
+				double* a = ps.a.data();
+				const double* tx = ps.target_x.data();
+				const double* ty = ps.target_y.data();
+				const double d = obj_v * dt;
+				const double wheel_base = carInfo.wheel_base;
+				for(unsigned int i=0; i < n; i++)
+				{
+					double steer = SplitAngle(atan2(ty[i] - y[i], tx[i] - x[i]) - SplitAngle(a[i]));
+					x[i] += d * cos(a[i]);
+					y[i] += d * sin(a[i]);
+					a[i] += d * tan(steer) / wheel_base;
+				}
 			}
 			else
 			{
-				p->prev_time_diff += dt;
+				std::fill(ps.path_vel.begin(), ps.path_vel.end(), 0);
 			}
 
-			if(fabs(p->acc_raw) < ACCELERATION_DECISION_VALUE)
-				p->acc = 0;
-			else if(p->acc_raw > ACCELERATION_DECISION_VALUE)
-				p->acc = 1;
-			else if(p->acc_raw < -ACCELERATION_DECISION_VALUE)
-				p->acc = -1;
-
-			p->indicator = FromIndicatorToNumber(curr_part_info.indicator);
-
-//			if(curr_behavior.state == PlannerHNS::STOPPING_STATE && p->beh == PlannerHNS::BEH_YIELDING_STATE)
-//				p->vel += 1;
-//			else if(p->beh == PlannerHNS::BEH_YIELDING_STATE)
-//				p->vel = p->vel/2.0;
-//			else if(curr_behavior.state != PlannerHNS::STOPPING_STATE && p->beh == PlannerHNS::BEH_STOPPING_STATE)
-//				p->vel += 1;
-//			else if(p->beh == PlannerHNS::BEH_STOPPING_STATE)
-//				p->vel = 0;
-
-//			if(curr_behavior.state != PlannerHNS::STOPPING_STATE && p->beh == PlannerHNS::BEH_STOPPING_STATE)
-//				p->vel += 1;
-			if(p->beh == PlannerHNS::BEH_STOPPING_STATE)
+			const BEH_STATE_TYPE* beh = ps.beh.data();
+			const double* path_vel = ps.path_vel.data();
+			double* v = ps.v.data();
+			double* vel = ps.vel.data();
+			double* vel_prev_big = ps.vel_prev_big.data();
+			double* prev_time_diff = ps.prev_time_diff.data();
+			double* acc_raw = ps.acc_raw.data();
+			int* acc = ps.acc.data();
+			int* ind = ps.indicator.data();
+			for(unsigned int i=0; i < n; i++)
 			{
-				p->vel = 0;
-				if(p->acc == 0)
-					p->acc = -1;
-				else if(p->acc == 1)
-					p->acc = 0;
+				v[i] = obj_v;
+				bool bCalc = prev_time_diff[i] > ACCELERATION_CALC_TIME;
+				acc_raw[i] = bCalc ? (path_vel[i] - vel_prev_big[i])/prev_time_diff[i] : acc_raw[i];
+				vel_prev_big[i] = bCalc ? path_vel[i] : vel_prev_big[i];
+				prev_time_diff[i] = bCalc ? 0 : prev_time_diff[i] + dt;
+
+				int _acc = acc[i];
+				if(fabs(acc_raw[i]) < ACCELERATION_DECISION_VALUE)
+					_acc = 0;
+				else if(acc_raw[i] > ACCELERATION_DECISION_VALUE)
+					_acc = 1;
+				else if(acc_raw[i] < -ACCELERATION_DECISION_VALUE)
+					_acc = -1;
+
+				ind[i] = indicator;
+
+				if(beh[i] == PlannerHNS::BEH_STOPPING_STATE)
+				{
+					vel[i] = 0;
+					_acc = _acc > -1 ? _acc - 1 : -1;
+				}
+				acc[i] = _acc;
 			}
-
-		  }
+		}
 		else
-		  {
-			curr_behavior = decision_make.MoveStep(dt, p->pose, p->pTraj->trajectory,carInfo);
-			p->acc = UtilityHNS::UtilityH::GetSign(curr_behavior.maxVelocity - p->vel_prev_big);
-			p->vel = curr_behavior.maxVelocity;
-			if(fabs(p->vel - p->vel_prev_big) > 0.5)
-				p->vel_prev_big = p->vel;
-			p->indicator = FromIndicatorToNumber(curr_behavior.indicator);
-//			if(p->indicator == 0)
-//			  std::cout << ", Off";
-//			else if(p->indicator == 1)
-//			  std::cout << ", Left";
-//			else if(p->indicator == 2)
-//			  std::cout << ", Right";
-
-			if(curr_behavior.state == PlannerHNS::STOPPING_STATE && p->beh == PlannerHNS::BEH_YIELDING_STATE)
-				p->vel += 1;
-			else if(p->beh == PlannerHNS::BEH_YIELDING_STATE)
-				p->vel = p->vel/2.0;
-			else if(curr_behavior.state != PlannerHNS::STOPPING_STATE && p->beh == PlannerHNS::BEH_STOPPING_STATE)
-				p->vel += 1;
-			else if(p->beh == PlannerHNS::BEH_STOPPING_STATE)
+		{
+			for(unsigned int i=0; i < n; i++)
 			{
-				p->vel = 0;
+				pose = ps.GetPose(i);
+				curr_behavior = decision_make.MoveStep(dt, pose, path, carInfo);
+				ps.x[i] = pose.pos.x;
+				ps.y[i] = pose.pos.y;
+				ps.a[i] = pose.pos.a;
+				ps.v[i] = pose.v;
+				ps.acc[i] = UtilityHNS::UtilityH::GetSign(curr_behavior.maxVelocity - ps.vel_prev_big[i]);
+				ps.vel[i] = curr_behavior.maxVelocity;
+				if(fabs(ps.vel[i] - ps.vel_prev_big[i]) > 0.5)
+					ps.vel_prev_big[i] = ps.vel[i];
+				ps.indicator[i] = FromIndicatorToNumber(curr_behavior.indicator);
+
+				if(curr_behavior.state == PlannerHNS::STOPPING_STATE && ps.beh[i] == PlannerHNS::BEH_YIELDING_STATE)
+					ps.vel[i] += 1;
+				else if(ps.beh[i] == PlannerHNS::BEH_YIELDING_STATE)
+					ps.vel[i] = ps.vel[i]/2.0;
+				else if(curr_behavior.state != PlannerHNS::STOPPING_STATE && ps.beh[i] == PlannerHNS::BEH_STOPPING_STATE)
+					ps.vel[i] += 1;
+				else if(ps.beh[i] == PlannerHNS::BEH_STOPPING_STATE)
+				{
+					ps.vel[i] = 0;
+				}
 			}
-
-		  }
+		}
 	}
 	//std::cout << "End Motion Status ------ " << std::endl;
 }
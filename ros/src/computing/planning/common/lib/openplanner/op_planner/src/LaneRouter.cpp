@@ -0,0 +1,356 @@
+
+/// \file LaneRouter.cpp
+/// \brief Global route search over a lane level graph precomputed from the RoadNetwork
+/// \date Oct 19, 2026
+
+
+#include "op_planner/LaneRouter.h"
+#include "op_planner/PlanningHelpers.h"
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <queue>
+#include <unordered_set>
+#include <float.h>
+
+using namespace std;
+
+namespace PlannerHNS
+{
+
+static double GetActionCost(const WayPoint& wp)
+{
+	double cost = 0;
+	for(unsigned int a = 0; a < wp.actionCost.size(); a++)
+		cost += wp.actionCost.at(a).second;
+	return cost;
+}
+
+LaneRouter::LaneRouter()
+{
+	m_nLanes = 0;
+}
+
+LaneRouter::~LaneRouter()
+{
+}
+
+void LaneRouter::BuildGraph(RoadNetwork& map)
+{
+	m_Lanes.clear();
+	m_LaneIndex.clear();
+	m_SegmentsLanes.clear();
+	m_nLanes = 0;
+
+	for(unsigned int rs = 0; rs < map.roadSegments.size(); rs++)
+	{
+		m_SegmentsLanes.push_back(map.roadSegments.at(rs).Lanes.data());
+		for(unsigned int i = 0; i < map.roadSegments.at(rs).Lanes.size(); i++)
+		{
+			LaneNode node;
+			node.pLane = &map.roadSegments.at(rs).Lanes.at(i);
+			node.pFirstPoint = node.pLane->points.data();
+			m_LaneIndex[node.pLane] = m_Lanes.size();
+			m_Lanes.push_back(node);
+		}
+	}
+	m_nLanes = m_Lanes.size();
+
+	int nExits = 0;
+	for(unsigned int il = 0; il < m_Lanes.size(); il++)
+	{
+		LaneNode& node = m_Lanes.at(il);
+		vector<WayPoint>& points = node.pLane->points;
+		node.accumDistance.resize(points.size(), 0);
+
+		for(unsigned int p = 0; p < points.size(); p++)
+		{
+			if(p > 0)
+			{
+				double d = hypot(points.at(p).pos.y - points.at(p-1).pos.y, points.at(p).pos.x - points.at(p-1).pos.x);
+				node.accumDistance.at(p) = node.accumDistance.at(p-1) + d;
+			}
+
+			const WayPoint& wp = points.at(p);
+			vector<pair<WayPoint*, EXIT_TYPE> > next;
+			for(unsigned int i = 0; i < wp.pFronts.size(); i++)
+			{
+				if(wp.pFronts.at(i) && !(p+1 < points.size() && wp.pFronts.at(i) == &points.at(p+1)))
+					next.push_back(make_pair(wp.pFronts.at(i), EXIT_FORWARD));
+			}
+			if(wp.pLeft)
+				next.push_back(make_pair(wp.pLeft, EXIT_LEFT));
+			if(wp.pRight)
+				next.push_back(make_pair(wp.pRight, EXIT_RIGHT));
+
+			for(unsigned int i = 0; i < next.size(); i++)
+			{
+				LaneExit exit;
+				exit.iLane = GetLaneIndex(next.at(i).first, exit.iTo);
+				if(exit.iLane < 0 || (exit.iLane == (int)il && next.at(i).second != EXIT_FORWARD))
+					continue;
+
+				exit.iFrom = p;
+				exit.type = next.at(i).second;
+				exit.distance = hypot(next.at(i).first->pos.y - wp.pos.y, next.at(i).first->pos.x - wp.pos.x);
+				node.exits.push_back(exit);
+				nExits++;
+			}
+		}
+	}
+
+	cout << "Info: LaneRouter -> Lane graph with " << m_nLanes << " lanes and " << nExits << " exits." << endl;
+}
+
+bool LaneRouter::IsBuiltFor(const RoadNetwork& map) const
+{
+	if(m_SegmentsLanes.size() != map.roadSegments.size())
+		return false;
+
+	unsigned int nLanes = 0;
+	for(unsigned int rs = 0; rs < map.roadSegments.size(); rs++)
+	{
+		if(m_SegmentsLanes.at(rs) != map.roadSegments.at(rs).Lanes.data())
+			return false;
+		nLanes += map.roadSegments.at(rs).Lanes.size();
+	}
+
+	if(nLanes != m_nLanes)
+		return false;
+
+	for(unsigned int il = 0; il < m_Lanes.size(); il++)
+	{
+		if(m_Lanes.at(il).pFirstPoint != m_Lanes.at(il).pLane->points.data() || m_Lanes.at(il).accumDistance.size() != m_Lanes.at(il).pLane->points.size())
+			return false;
+	}
+
+	return true;
+}
+
+int LaneRouter::GetLaneIndex(const WayPoint* pWP, int& iPoint) const
+{
+	if(!pWP || !pWP->pLane)
+		return -1;
+
+	unordered_map<const Lane*, int>::const_iterator it = m_LaneIndex.find(pWP->pLane);
+	if(it == m_LaneIndex.end())
+		return -1;
+
+	const vector<WayPoint>& points = m_Lanes.at(it->second).pLane->points;
+	if(points.size() == 0 || pWP < &points.front() || pWP > &points.back())
+		return -1; // a copy, not a waypoint of the map
+
+	iPoint = pWP - &points.front();
+	return it->second;
+}
+
+WayPoint* LaneRouter::FindRoute(WayPoint* pStart, WayPoint* pGoal, const std::vector<int>& globalPath, const double& DistanceLimit,
+		const bool& bEnableLaneChange, std::vector<WayPoint*>& all_cells_to_delete) const
+{
+	int iStartPoint = 0, iGoalPoint = 0;
+	int iStartLane = GetLaneIndex(pStart, iStartPoint);
+	int iGoalLane = GetLaneIndex(pGoal, iGoalPoint);
+	if(iStartLane < 0 || iGoalLane < 0)
+		return NULL;
+
+	vector<bool> bAllowedLanes;
+	if(globalPath.size() > 0)
+	{
+		unordered_set<int> ids(globalPath.begin(), globalPath.end());
+		bAllowedLanes.resize(m_Lanes.size(), false);
+		for(unsigned int il = 0; il < m_Lanes.size(); il++)
+			bAllowedLanes.at(il) = ids.find(m_Lanes.at(il).pLane->id) != ids.end();
+	}
+
+	// the action costs as they are now, negative ones (HMI preferred branches) make the heuristic inadmissible
+	vector<vector<double> > accumCost(m_Lanes.size());
+	bool bNegativeCost = false;
+	for(unsigned int il = 0; il < m_Lanes.size(); il++)
+	{
+		const vector<WayPoint>& points = m_Lanes.at(il).pLane->points;
+		const vector<double>& accumDistance = m_Lanes.at(il).accumDistance;
+		vector<double>& laneCost = accumCost.at(il);
+		laneCost.resize(points.size(), 0);
+		for(unsigned int p = 1; p < points.size(); p++)
+		{
+			double action_cost = GetActionCost(points.at(p));
+			if(action_cost < 0)
+				bNegativeCost = true;
+			laneCost.at(p) = laneCost.at(p-1) + accumDistance.at(p) - accumDistance.at(p-1) + action_cost;
+		}
+		if(points.size() > 0 && GetActionCost(points.at(0)) < 0)
+			bNegativeCost = true;
+	}
+	const double heuristic_factor = bNegativeCost ? 0 : 1;
+
+	vector<SearchState> states;
+	unordered_map<long long, int> states_index;
+	priority_queue<pair<double, int>, vector<pair<double, int> >, greater<pair<double, int> > > open;
+
+	SearchState start_state;
+	start_state.iLane = iStartLane;
+	start_state.iEntry = iStartPoint;
+	start_state.cost = 0;
+	start_state.changeDistance = 0;
+	start_state.iParent = -1;
+	start_state.entryType = EXIT_FORWARD;
+	start_state.iParentExit = 0;
+	start_state.bClosed = false;
+	states.push_back(start_state);
+	states_index[((long long)iStartLane << 32) | iStartPoint] = 0;
+	open.push(make_pair(heuristic_factor * hypot(pGoal->pos.y - pStart->pos.y, pGoal->pos.x - pStart->pos.x), 0));
+
+	double goal_cost = DBL_MAX;
+	int iLast = -1;
+	int iLastPoint = 0;
+
+	while(open.size() > 0)
+	{
+		double f = open.top().first;
+		int is = open.top().second;
+		open.pop();
+
+		if(f >= goal_cost)
+			break;
+		if(states.at(is).bClosed)
+			continue;
+		states.at(is).bClosed = true;
+
+		SearchState s = states.at(is);
+		const LaneNode& node = m_Lanes.at(s.iLane);
+		const vector<double>& laneCost = accumCost.at(s.iLane);
+		bool bForward = bAllowedLanes.size() == 0 || bAllowedLanes.at(s.iLane);
+
+		if(s.iLane == iGoalLane && s.iEntry <= iGoalPoint && (bForward || s.iEntry == iGoalPoint))
+		{
+			double cost = s.cost + laneCost.at(iGoalPoint) - laneCost.at(s.iEntry);
+			if(cost < goal_cost)
+			{
+				goal_cost = cost;
+				iLast = is;
+				iLastPoint = iGoalPoint;
+			}
+			continue;
+		}
+
+		if(iLast < 0 && globalPath.size() == 0 && s.cost > DistanceLimit)
+		{
+			cout << "Goal Not Found, LaneID: " << node.pLane->id << ", Distance : " << s.cost << endl;
+			iLast = is;
+			iLastPoint = s.iEntry;
+			break;
+		}
+
+		bool bLeftChange = false, bRightChange = false;
+		for(unsigned int i = 0; i < node.exits.size(); i++)
+		{
+			const LaneExit& exit = node.exits.at(i);
+			if(exit.iFrom < s.iEntry)
+				continue;
+			// outside globalPath the lane is not driven along, only changed from at the entry waypoint
+			if(!bForward && (exit.iFrom != s.iEntry || exit.type == EXIT_FORWARD))
+				continue;
+
+			double drive_distance = node.accumDistance.at(exit.iFrom) - node.accumDistance.at(s.iEntry);
+			double change_distance = s.changeDistance + drive_distance + exit.distance;
+			if(exit.type != EXIT_FORWARD)
+			{
+				// only the first lane change allowed on each side, neighbor lanes have about the same length
+				bool& bChanged = exit.type == EXIT_LEFT ? bLeftChange : bRightChange;
+				if(!bEnableLaneChange || bChanged || s.changeDistance + drive_distance <= LANE_CHANGE_MIN_DISTANCE)
+					continue;
+				bChanged = true;
+				change_distance = -LANE_CHANGE_MIN_DISTANCE*3;
+			}
+
+			const WayPoint& entry = m_Lanes.at(exit.iLane).pLane->points.at(exit.iTo);
+			double cost = s.cost + laneCost.at(exit.iFrom) - laneCost.at(s.iEntry) + exit.distance + GetActionCost(entry);
+			long long key = ((long long)exit.iLane << 32) | exit.iTo;
+			unordered_map<long long, int>::iterator it = states_index.find(key);
+			int in = 0;
+			if(it == states_index.end())
+			{
+				SearchState next_state;
+				next_state.iLane = exit.iLane;
+				next_state.iEntry = exit.iTo;
+				next_state.cost = DBL_MAX;
+				next_state.bClosed = false;
+				in = states.size();
+				states.push_back(next_state);
+				states_index[key] = in;
+			}
+			else
+				in = it->second;
+
+			SearchState& next_state = states.at(in);
+			if(next_state.bClosed || cost >= next_state.cost)
+				continue;
+
+			next_state.cost = cost;
+			next_state.changeDistance = change_distance;
+			next_state.iParent = is;
+			next_state.entryType = exit.type;
+			next_state.iParentExit = exit.iFrom;
+			open.push(make_pair(cost + heuristic_factor * hypot(pGoal->pos.y - entry.pos.y, pGoal->pos.x - entry.pos.x), in));
+		}
+	}
+
+	if(iLast < 0)
+		return NULL;
+
+	if(iLastPoint == iGoalPoint && states.at(iLast).iLane == iGoalLane)
+		cout << "Goal Found, LaneID: " << pGoal->laneId << ", Cost : " << goal_cost << ", Search States: " << states.size() << endl;
+
+	return CreateRouteTree(pStart, states, iLast, iLastPoint, all_cells_to_delete);
+}
+
+WayPoint* LaneRouter::CreateRouteTree(WayPoint* pStart, const std::vector<SearchState>& states, const int& iLast,
+		const int& iLastPoint, std::vector<WayPoint*>& all_cells_to_delete) const
+{
+	vector<int> route;
+	for(int is = iLast; is >= 0; is = states.at(is).iParent)
+		route.push_back(is);
+	reverse(route.begin(), route.end());
+
+	WayPoint* pPrev = 0;
+	for(unsigned int i = 0; i < route.size(); i++)
+	{
+		const SearchState& s = states.at(route.at(i));
+		vector<WayPoint>& points = m_Lanes.at(s.iLane).pLane->points;
+		int iEnd = i+1 < route.size() ? states.at(route.at(i+1)).iParentExit : iLastPoint;
+
+		for(int p = s.iEntry; p <= iEnd; p++)
+		{
+			WayPoint* wp = new WayPoint();
+			*wp = points.at(p);
+			if(!pPrev)
+			{
+				wp->cost = pStart->cost;
+			}
+			else
+			{
+				// same links as BuildPlanningSearchTreeV2 creates, for TraversePathTreeBackwards
+				wp->cost = pPrev->cost + hypot(wp->pos.y - pPrev->pos.y, wp->pos.x - pPrev->pos.x) + GetActionCost(*wp);
+				if(p == s.iEntry && s.entryType == EXIT_LEFT)
+				{
+					wp->pRight = pPrev;
+					wp->pLeft = 0;
+				}
+				else if(p == s.iEntry && s.entryType == EXIT_RIGHT)
+				{
+					wp->pLeft = pPrev;
+					wp->pRight = 0;
+				}
+				else
+					wp->pBacks.push_back(pPrev);
+			}
+
+			all_cells_to_delete.push_back(wp);
+			pPrev = wp;
+		}
+	}
+
+	return pPrev;
+}
+
+} /* namespace PlannerHNS */
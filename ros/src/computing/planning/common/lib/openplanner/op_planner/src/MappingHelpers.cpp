@@ -519,6 +519,12 @@ WayPoint* MappingHelpers::FindWaypointV2(const int& id, const int& l_id, RoadNet
 
 void MappingHelpers::ConstructRoadNetworkFromDataFiles(const std::string vectoMapPath, RoadNetwork& map, const bool& bZeroOrigin)
 {
+	if(vectoMapPath.size() > 4 && vectoMapPath.compare(vectoMapPath.size() - 4, 4, ".vmb") == 0)
+	{
+		ConstructRoadNetworkFromBinaryMap(vectoMapPath, map);
+		return;
+	}
+
 	/**
 	 * Exporting the center lines
 	 */
@@ -616,6 +622,42 @@ void MappingHelpers::ConstructRoadNetworkFromDataFiles(const std::string vectoMa
 	cout << origin.pos.ToString() ;
 }
 
+void MappingHelpers::ConstructRoadNetworkFromBinaryMap(const std::string& binaryMapFile, RoadNetwork& map)
+{
+	cout << " >> Loading compiled vector map ... " << endl;
+	MapRaw map_raw;
+	if(!map_raw.LoadFromBinaryMap(binaryMapFile) || map_raw.pPoints->m_data_list.size() == 0)
+	{
+		std::cout << std::endl << "## Alert Can't Read Points Data from compiled vector map: " << binaryMapFile << std::endl;
+		return;
+	}
+
+	vector<AisanDataConnFileReader::DataConn> conn_data;
+
+	if(map_raw.pNodes->m_data_list.size() > 0)
+	{
+		ConstructRoadNetworkFromROSMessageV2(map_raw.pLanes->m_data_list, map_raw.pPoints->m_data_list,
+				map_raw.pCenterLines->m_data_list, map_raw.pIntersections->m_data_list, map_raw.pAreas->m_data_list,
+				map_raw.pLines->m_data_list, map_raw.pStopLines->m_data_list, map_raw.pSignals->m_data_list,
+				map_raw.pVectors->m_data_list, map_raw.pCurbs->m_data_list, map_raw.pRoadedges->m_data_list,
+				map_raw.pWayAreas->m_data_list, map_raw.pCrossWalks->m_data_list, map_raw.pNodes->m_data_list, conn_data,
+				map_raw.pLanes, map_raw.pPoints, map_raw.pNodes, map_raw.pLines,
+				GetTransformationOrigin(0), map, false);
+	}
+	else
+	{
+		ConstructRoadNetworkFromROSMessage(map_raw.pLanes->m_data_list, map_raw.pPoints->m_data_list,
+				map_raw.pCenterLines->m_data_list, map_raw.pIntersections->m_data_list, map_raw.pAreas->m_data_list,
+				map_raw.pLines->m_data_list, map_raw.pStopLines->m_data_list, map_raw.pSignals->m_data_list,
+				map_raw.pVectors->m_data_list, map_raw.pCurbs->m_data_list, map_raw.pRoadedges->m_data_list,
+				map_raw.pWayAreas->m_data_list, map_raw.pCrossWalks->m_data_list, map_raw.pNodes->m_data_list, conn_data,
+				GetTransformationOrigin(0), map);
+	}
+
+	WayPoint origin = GetFirstWaypoint(map);
+	cout << origin.pos.ToString() ;
+}
+
 bool MappingHelpers::GetWayPoint(const int& id, const int& laneID,const double& refVel, const int& did,
 		const std::vector<UtilityHNS::AisanCenterLinesFileReader::AisanCenterLine>& dtpoints,
 		const std::vector<UtilityHNS::AisanPointsFileReader::AisanPoints>& points,
@@ -196,10 +196,13 @@ double PlannerH::PlanUsingDP(const WayPoint& start,
 	WayPoint* pLaneCell = 0;
 	char bPlan = 'A';
 
+	if(!m_Router.IsBuiltFor(map))
+		m_Router.BuildGraph(map);
+
 	if(all_cell_to_delete)
-		pLaneCell =  PlanningHelpers::BuildPlanningSearchTreeV2(pStart, *pGoal, globalPath, maxPlanningDistance,bEnableLaneChange, *all_cell_to_delete);
+		pLaneCell =  m_Router.FindRoute(pStart, pGoal, globalPath, maxPlanningDistance,bEnableLaneChange, *all_cell_to_delete);
 	else
-		pLaneCell =  PlanningHelpers::BuildPlanningSearchTreeV2(pStart, *pGoal, globalPath, maxPlanningDistance,bEnableLaneChange, local_cell_to_delete);
+		pLaneCell =  m_Router.FindRoute(pStart, pGoal, globalPath, maxPlanningDistance,bEnableLaneChange, local_cell_to_delete);
 
 	if(!pLaneCell)
 	{
@@ -0,0 +1,422 @@
+/// \file test_behavior_prediction.cpp
+/// \brief Checks the particle bookkeeping of BehaviorPrediction on hand made particle sets and on a synthetic road
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+#include "op_planner/BehaviorPrediction.h"
+
+using namespace PlannerHNS;
+using namespace std;
+
+//exposes the filter steps under test
+class TestBehaviorPrediction : public BehaviorPrediction
+{
+public:
+	using BehaviorPrediction::RemoveWeakParticles;
+};
+
+static const BEH_STATE_TYPE g_behs[] = {BEH_STOPPING_STATE, BEH_FORWARD_STATE, BEH_YIELDING_STATE, BEH_BRANCH_LEFT_STATE, BEH_BRANCH_RIGHT_STATE};
+
+//every state variable of particle i holds a value derived from i, so a moved particle can be traced back
+static void TraceParticles(ParticleSet& ps)
+{
+	for(unsigned int i = 0; i < ps.size(); i++)
+	{
+		ps.beh.at(i) = g_behs[i%5];
+		ps.x.at(i) = i;
+		ps.y.at(i) = 100+i;
+		ps.z.at(i) = 200+i;
+		ps.a.at(i) = 0.01*i;
+		ps.v.at(i) = 300+i;
+		ps.vel.at(i) = i%2;
+		ps.vel_prev_big.at(i) = 400+i;
+		ps.prev_time_diff.at(i) = 500+i;
+		ps.acc.at(i) = (int)i%3 - 1;
+		ps.acc_raw.at(i) = 600+i;
+		ps.indicator.at(i) = i%4;
+		ps.w.at(i) = 0.001*i;
+		ps.w_raw.at(i) = 700+i;
+		ps.pose_w.at(i) = 800+i;
+		ps.dir_w.at(i) = 900+i;
+		ps.vel_w.at(i) = 1000+i;
+		ps.acl_w.at(i) = 1100+i;
+		ps.ind_w.at(i) = 1200+i;
+	}
+}
+
+static void AddTracedParticles(ParticleSet& ps, const unsigned int& n)
+{
+	for(unsigned int i = 0; i < n; i++)
+		ps.Add(BEH_STOPPING_STATE, 0, 0, 0, 0, 0, 0);
+	TraceParticles(ps);
+}
+
+//particle j of ps is the traced particle i
+static void ExpectTracedParticle(const ParticleSet& ps, const unsigned int& j, const unsigned int& i)
+{
+	EXPECT_EQ(g_behs[i%5], ps.beh.at(j));
+	EXPECT_DOUBLE_EQ(i, ps.x.at(j));
+	EXPECT_DOUBLE_EQ(100+i, ps.y.at(j));
+	EXPECT_DOUBLE_EQ(200+i, ps.z.at(j));
+	EXPECT_DOUBLE_EQ(0.01*i, ps.a.at(j));
+	EXPECT_DOUBLE_EQ(300+i, ps.v.at(j));
+	EXPECT_DOUBLE_EQ(i%2, ps.vel.at(j));
+	EXPECT_DOUBLE_EQ(400+i, ps.vel_prev_big.at(j));
+	EXPECT_DOUBLE_EQ(500+i, ps.prev_time_diff.at(j));
+	EXPECT_EQ((int)i%3 - 1, ps.acc.at(j));
+	EXPECT_DOUBLE_EQ(600+i, ps.acc_raw.at(j));
+	EXPECT_EQ((int)i%4, ps.indicator.at(j));
+	EXPECT_DOUBLE_EQ(0.001*i, ps.w.at(j));
+	EXPECT_DOUBLE_EQ(700+i, ps.w_raw.at(j));
+	EXPECT_DOUBLE_EQ(800+i, ps.pose_w.at(j));
+	EXPECT_DOUBLE_EQ(900+i, ps.dir_w.at(j));
+	EXPECT_DOUBLE_EQ(1000+i, ps.vel_w.at(j));
+	EXPECT_DOUBLE_EQ(1100+i, ps.acl_w.at(j));
+	EXPECT_DOUBLE_EQ(1200+i, ps.ind_w.at(j));
+}
+
+static void ExpectConsistentSize(const ParticleSet& ps, const unsigned int& n)
+{
+	EXPECT_EQ(n, ps.size());
+	EXPECT_EQ(n, ps.beh.size());
+	EXPECT_EQ(n, ps.acc.size());
+	EXPECT_EQ(n, ps.indicator.size());
+	EXPECT_EQ(n, ps.w.size());
+	EXPECT_EQ(n, ps.ind_w.size());
+}
+
+TEST(ParticleSet, removeKeepsOrderAndState)
+{
+	ParticleSet ps;
+	AddTracedParticles(ps, 10);
+
+	vector<bool> bRemove = {false, true, false, false, true, true, false, true, false, true};
+	ps.Remove(bRemove);
+
+	const unsigned int kept[] = {0, 2, 3, 6, 8};
+	ExpectConsistentSize(ps, 5);
+	for(unsigned int j = 0; j < 5; j++)
+		ExpectTracedParticle(ps, j, kept[j]);
+}
+
+TEST(ParticleSet, removeNoneOrAll)
+{
+	ParticleSet ps;
+	AddTracedParticles(ps, 7);
+
+	ps.Remove(vector<bool>(7, false));
+	ExpectConsistentSize(ps, 7);
+	for(unsigned int j = 0; j < 7; j++)
+		ExpectTracedParticle(ps, j, j);
+
+	//the first particles removed, every one left moves
+	vector<bool> bRemove(7, false);
+	bRemove.at(0) = bRemove.at(1) = true;
+	ps.Remove(bRemove);
+	ExpectConsistentSize(ps, 5);
+	for(unsigned int j = 0; j < 5; j++)
+		ExpectTracedParticle(ps, j, j+2);
+
+	ps.Remove(vector<bool>(5, true));
+	ExpectConsistentSize(ps, 0);
+}
+
+//the alive count of each behavior follows the removed particles
+TEST(ParticleSet, deleteParticlesUpdatesAliveCounts)
+{
+	TrajectoryTracker track;
+	for(unsigned int i = 0; i < 10; i++)
+		track.InsertNewParticle(g_behs[i%5], i, 0, 0, 0, 0, 0);
+	ASSERT_EQ(10u, track.m_Particles.size());
+	EXPECT_EQ(2, track.nAliveStop);
+	EXPECT_EQ(2, track.nAliveForward);
+
+	vector<bool> bRemove = {true, true, false, false, false, true, false, false, false, false};
+	track.DeleteParticles(bRemove);
+
+	EXPECT_EQ(7u, track.m_Particles.size());
+	EXPECT_EQ(0, track.nAliveStop);
+	EXPECT_EQ(1, track.nAliveForward);
+	EXPECT_EQ(2, track.nAliveYield);
+	EXPECT_EQ(2, track.nAliveLeft);
+	EXPECT_EQ(2, track.nAliveRight);
+	const double xs[] = {2, 3, 4, 6, 7, 8, 9};
+	for(unsigned int j = 0; j < 7; j++)
+		EXPECT_DOUBLE_EQ(xs[j], track.m_Particles.x.at(j));
+}
+
+//the weak and the far particles of every trajectory are dropped, the rest keep their weights
+TEST(BehaviorPrediction, removeWeakParticles)
+{
+	TestBehaviorPrediction bp;
+	bp.m_PredictionDistance = 25;
+
+	ObjParticles parts;
+	//particles 3 to 37 are close enough, 34 and above are strong enough
+	parts.obj.center.pos.x = 20;
+	parts.obj.center.pos.y = 120;
+	parts.min_w = 0;
+	parts.max_w = 0.04;
+	const double critical_val = parts.min_w + (parts.max_w - parts.min_w)*KEEP_PERCENTAGE;
+
+	for(unsigned int t = 0; t < 3; t++)
+	{
+		parts.m_TrajectoryTracker.push_back(new TrajectoryTracker());
+		TrajectoryTracker* pTrack = parts.m_TrajectoryTracker.at(t);
+		for(unsigned int i = 0; i < 40 + t; i++)
+			pTrack->InsertNewParticle(g_behs[i%5], 0, 0, 0, 0, 0, 0);
+		TraceParticles(pTrack->m_Particles);
+	}
+
+	vector<vector<unsigned int> > expected(3);
+	vector<vector<int> > expected_alive(3, vector<int>(5, 0));
+	for(unsigned int t = 0; t < 3; t++)
+	{
+		const ParticleSet& ps = parts.m_TrajectoryTracker.at(t)->m_Particles;
+		for(unsigned int i = 0; i < ps.size(); i++)
+		{
+			double dx = ps.x.at(i) - parts.obj.center.pos.x;
+			double dy = ps.y.at(i) - parts.obj.center.pos.y;
+			if(ps.w.at(i) >= critical_val && dx*dx + dy*dy <= bp.m_PredictionDistance*bp.m_PredictionDistance)
+			{
+				expected.at(t).push_back(i);
+				expected_alive.at(t).at(i%5)++;
+			}
+		}
+		ASSERT_FALSE(expected.at(t).empty());
+		ASSERT_LT(expected.at(t).size(), ps.size());
+	}
+
+	bp.RemoveWeakParticles(&parts);
+
+	for(unsigned int t = 0; t < 3; t++)
+	{
+		TrajectoryTracker* pTrack = parts.m_TrajectoryTracker.at(t);
+		ExpectConsistentSize(pTrack->m_Particles, expected.at(t).size());
+		for(unsigned int j = 0; j < expected.at(t).size(); j++)
+			ExpectTracedParticle(pTrack->m_Particles, j, expected.at(t).at(j));
+
+		EXPECT_EQ(expected_alive.at(t).at(0), pTrack->nAliveStop);
+		EXPECT_EQ(expected_alive.at(t).at(1), pTrack->nAliveForward);
+		EXPECT_EQ(expected_alive.at(t).at(2), pTrack->nAliveYield);
+		EXPECT_EQ(expected_alive.at(t).at(3), pTrack->nAliveLeft);
+		EXPECT_EQ(expected_alive.at(t).at(4), pTrack->nAliveRight);
+	}
+}
+
+//rows of two straight lanes along x, 4 m apart, one waypoint every meter
+static void BuildMap(RoadNetwork& map, const int& nRows, const double& y_offset)
+{
+	map.roadSegments.clear();
+	map.roadSegments.resize(1);
+	vector<Lane>& lanes = map.roadSegments.at(0).Lanes;
+	lanes.resize(nRows*2);
+	int wp_id = 0;
+	for(int r = 0; r < nRows; r++)
+	{
+		for(int k = 0; k < 2; k++)
+		{
+			Lane& l = lanes.at(r*2+k);
+			l.id = r*2+k+1;
+			for(int i = 0; i < 100; i++)
+			{
+				WayPoint wp(k*100 + i, r*4.0 + y_offset, 0, 0);
+				wp.id = ++wp_id;
+				wp.laneId = l.id;
+				wp.v = 10;
+				wp.actionCost.push_back(make_pair(FORWARD_ACTION, 0.0));
+				l.points.push_back(wp);
+			}
+		}
+		lanes.at(r*2).toLanes.push_back(&lanes.at(r*2+1));
+	}
+
+	for(unsigned int il = 0; il < lanes.size(); il++)
+	{
+		Lane& l = lanes.at(il);
+		for(unsigned int ip = 0; ip < l.points.size(); ip++)
+		{
+			l.points.at(ip).pLane = &l;
+			if(ip+1 < l.points.size())
+				l.points.at(ip).pFronts.push_back(&l.points.at(ip+1));
+			else if(l.toLanes.size() > 0)
+				l.points.at(ip).pFronts.push_back(&l.toLanes.at(0)->points.at(0));
+		}
+	}
+}
+
+static vector<DetectedObject> MakeObjects(const int& nObjects, const int& nRows, const double& x_shift)
+{
+	vector<DetectedObject> objs;
+	for(int i = 0; i < nObjects; i++)
+	{
+		DetectedObject o;
+		o.id = i + 1;
+		o.t = CAR;
+		o.center = WayPoint(5 + (i%6)*10 + x_shift, (i%nRows)*4.0 + 0.1, 0, 0);
+		o.center.v = 10;
+		o.w = 2;
+		o.l = 4;
+		o.bDirection = (i%2) == 0;
+		o.bVelocity = true;
+		objs.push_back(o);
+	}
+	return objs;
+}
+
+static void SetupPredictor(BehaviorPrediction& pred)
+{
+	pred.m_PredictionDistance = 20;
+	pred.m_MaxLaneDetectionDistance = 0.5;
+	pred.m_bStepByStep = true;
+}
+
+static bool IsInMap(const WayPoint* pWP, const RoadNetwork& map)
+{
+	for(unsigned int il = 0; il < map.roadSegments.at(0).Lanes.size(); il++)
+	{
+		const vector<WayPoint>& points = map.roadSegments.at(0).Lanes.at(il).points;
+		if(points.size() > 0 && pWP >= &points.front() && pWP <= &points.back())
+			return true;
+	}
+	return false;
+}
+
+static void ExpectSameTrajectories(const BehaviorPrediction& pred, const BehaviorPrediction& fresh)
+{
+	ASSERT_EQ(fresh.m_ParticleInfo_II.size(), pred.m_ParticleInfo_II.size());
+	for(unsigned int i = 0; i < pred.m_ParticleInfo_II.size(); i++)
+	{
+		const vector<vector<WayPoint> >& trajs = pred.m_ParticleInfo_II.at(i)->obj.predTrajectories;
+		const vector<vector<WayPoint> >& fresh_trajs = fresh.m_ParticleInfo_II.at(i)->obj.predTrajectories;
+		ASSERT_EQ(fresh_trajs.size(), trajs.size()) << "object " << i;
+		for(unsigned int t = 0; t < trajs.size(); t++)
+		{
+			ASSERT_GT(trajs.at(t).size(), 1u);
+			ASSERT_GT(fresh_trajs.at(t).size(), 1u);
+			//the first lane point may be one waypoint apart, with the object right on a waypoint
+			EXPECT_NEAR(fresh_trajs.at(t).at(1).pos.x, trajs.at(t).at(1).pos.x, 1.01) << "object " << i;
+			EXPECT_DOUBLE_EQ(fresh_trajs.at(t).at(1).pos.y, trajs.at(t).at(1).pos.y) << "object " << i;
+			EXPECT_EQ(fresh_trajs.at(t).at(1).laneId, trajs.at(t).at(1).laneId) << "object " << i;
+		}
+	}
+}
+
+//the closest waypoints are reused while the objects stay in their lanes, and never outlive the map they point into
+TEST(BehaviorPrediction, closestWaypointsCacheFollowsTheMap)
+{
+	const int nRows = 4;
+	const int nObjects = 12;
+	RoadNetwork map;
+	BuildMap(map, nRows, 0);
+
+	BehaviorPrediction pred;
+	SetupPredictor(pred);
+	pred.DoOneStep(MakeObjects(nObjects, nRows, 0), WayPoint(), 0, 0, map);
+	ASSERT_EQ((unsigned int)nObjects, pred.m_ParticleInfo_II.size());
+	vector<vector<WayPoint*> > first_waypoints;
+	for(unsigned int i = 0; i < pred.m_ParticleInfo_II.size(); i++)
+	{
+		const vector<WayPoint*>& waypoints = pred.m_ParticleInfo_II.at(i)->obj.pClosestWaypoints;
+		ASSERT_GT(waypoints.size(), 0u) << "object " << i;
+		first_waypoints.push_back(waypoints);
+	}
+
+	//one meter further, the waypoints found the first time are kept
+	vector<DetectedObject> objs = MakeObjects(nObjects, nRows, 1);
+	pred.DoOneStep(objs, WayPoint(), 0, 0, map);
+	for(unsigned int i = 0; i < pred.m_ParticleInfo_II.size(); i++)
+		EXPECT_EQ(first_waypoints.at(i), pred.m_ParticleInfo_II.at(i)->obj.pClosestWaypoints) << "object " << i;
+
+	BehaviorPrediction fresh;
+	SetupPredictor(fresh);
+	fresh.DoOneStep(objs, WayPoint(), 0, 0, map);
+	ExpectSameTrajectories(pred, fresh);
+
+	//another map, nothing found in the first one is used
+	RoadNetwork other_map;
+	BuildMap(other_map, nRows, 0.2);
+	pred.DoOneStep(objs, WayPoint(), 0, 0, other_map);
+	for(unsigned int i = 0; i < pred.m_ParticleInfo_II.size(); i++)
+	{
+		const vector<WayPoint*>& waypoints = pred.m_ParticleInfo_II.at(i)->obj.pClosestWaypoints;
+		ASSERT_GT(waypoints.size(), 0u) << "object " << i;
+		for(unsigned int j = 0; j < waypoints.size(); j++)
+			EXPECT_TRUE(IsInMap(waypoints.at(j), other_map)) << "object " << i;
+	}
+
+	//the same map object loaded again, the cache is cleared by the caller
+	BuildMap(other_map, nRows, -0.2);
+	pred.ClearMapCache();
+	pred.DoOneStep(objs, WayPoint(), 0, 0, other_map);
+	BehaviorPrediction fresh_other;
+	SetupPredictor(fresh_other);
+	fresh_other.DoOneStep(objs, WayPoint(), 0, 0, other_map);
+	ExpectSameTrajectories(pred, fresh_other);
+	for(unsigned int i = 0; i < pred.m_ParticleInfo_II.size(); i++)
+	{
+		const vector<WayPoint*>& waypoints = pred.m_ParticleInfo_II.at(i)->obj.pClosestWaypoints;
+		for(unsigned int j = 0; j < waypoints.size(); j++)
+			EXPECT_TRUE(IsInMap(waypoints.at(j), other_map)) << "object " << i;
+	}
+}
+
+//with the same seed, the objects filtered on several threads end up with the particles of the serial filter
+TEST(BehaviorPrediction, parallelParticleFilterMatchesSerial)
+{
+	const int nRows = 4;
+	const int nObjects = 24;
+	RoadNetwork map;
+	BuildMap(map, nRows, 0);
+
+	BehaviorPrediction serial, parallel;
+	SetupPredictor(serial);
+	SetupPredictor(parallel);
+	serial.m_bParticleFilter = parallel.m_bParticleFilter = true;
+	serial.m_SamplingSeed = parallel.m_SamplingSeed = 7;
+	serial.m_nParticleFilterThreads = 1;
+	parallel.m_nParticleFilterThreads = 4;
+
+	for(int c = 0; c < 10; c++)
+	{
+		vector<DetectedObject> objs = MakeObjects(nObjects, nRows, c*0.8);
+		serial.DoOneStep(objs, WayPoint(), 0, 0, map);
+		parallel.DoOneStep(objs, WayPoint(), 0, 0, map);
+
+		ASSERT_EQ((unsigned int)nObjects, parallel.m_ParticleInfo_II.size());
+		for(unsigned int i = 0; i < serial.m_ParticleInfo_II.size(); i++)
+		{
+			const ObjParticles* pS = serial.m_ParticleInfo_II.at(i);
+			const ObjParticles* pP = parallel.m_ParticleInfo_II.at(i);
+			ASSERT_EQ(pS->m_TrajectoryTracker.size(), pP->m_TrajectoryTracker.size());
+			EXPECT_EQ(pS->i_best_track, pP->i_best_track) << "cycle " << c << " object " << i;
+			for(unsigned int t = 0; t < pS->m_TrajectoryTracker.size(); t++)
+			{
+				const TrajectoryTracker* pTS = pS->m_TrajectoryTracker.at(t);
+				const TrajectoryTracker* pTP = pP->m_TrajectoryTracker.at(t);
+				ASSERT_GT(pTS->m_Particles.size(), 0u);
+				ASSERT_EQ(pTS->m_Particles.size(), pTP->m_Particles.size()) << "cycle " << c << " object " << i;
+				EXPECT_EQ(pTS->m_Particles.beh, pTP->m_Particles.beh);
+				EXPECT_EQ(pTS->m_Particles.x, pTP->m_Particles.x);
+				EXPECT_EQ(pTS->m_Particles.y, pTP->m_Particles.y);
+				EXPECT_EQ(pTS->m_Particles.v, pTP->m_Particles.v);
+				EXPECT_EQ(pTS->m_Particles.w, pTP->m_Particles.w);
+				EXPECT_EQ(pTS->nAliveStop, pTP->nAliveStop);
+				EXPECT_EQ(pTS->nAliveForward, pTP->nAliveForward);
+				EXPECT_EQ(pTS->nAliveYield, pTP->nAliveYield);
+				EXPECT_EQ(pTS->nAliveLeft, pTP->nAliveLeft);
+				EXPECT_EQ(pTS->nAliveRight, pTP->nAliveRight);
+				EXPECT_EQ(pTS->best_beh, pTP->best_beh);
+				EXPECT_DOUBLE_EQ(pTS->best_p, pTP->best_p);
+			}
+		}
+	}
+}
+
+int main(int argc, char **argv)
+{
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,227 @@
+/// \file test_lane_router.cpp
+/// \brief Compares LaneRouter routes with BuildPlanningSearchTreeV2 on small synthetic maps
+
+#include <gtest/gtest.h>
+
+#include "op_planner/LaneRouter.h"
+#include "op_planner/PlanningHelpers.h"
+
+using namespace PlannerHNS;
+using namespace std;
+
+static int g_max_wp_id = 0;
+
+// one waypoint every meter along the polyline
+static void AddLane(RoadNetwork& map, const int& id, const vector<GPSPoint>& polyline)
+{
+	Lane l;
+	l.id = id;
+	for(unsigned int i = 1; i < polyline.size(); i++)
+	{
+		const GPSPoint& p0 = polyline.at(i-1);
+		const GPSPoint& p1 = polyline.at(i);
+		double d = hypot(p1.y - p0.y, p1.x - p0.x);
+		double a = atan2(p1.y - p0.y, p1.x - p0.x);
+		int n = round(d);
+		for(int k = (i == 1 ? 0 : 1); k <= n; k++)
+		{
+			WayPoint wp(p0.x + (p1.x - p0.x)*k/n, p0.y + (p1.y - p0.y)*k/n, 0, a);
+			wp.id = ++g_max_wp_id;
+			wp.laneId = id;
+			wp.actionCost.push_back(make_pair(FORWARD_ACTION, 0.0));
+			l.points.push_back(wp);
+		}
+	}
+	map.roadSegments.at(0).Lanes.push_back(l);
+}
+
+static Lane* GetLane(RoadNetwork& map, const int& id)
+{
+	for(unsigned int i = 0; i < map.roadSegments.at(0).Lanes.size(); i++)
+	{
+		if(map.roadSegments.at(0).Lanes.at(i).id == id)
+			return &map.roadSegments.at(0).Lanes.at(i);
+	}
+	return 0;
+}
+
+// after all the lanes are added, the lane vector does not move anymore. Like the maps MappingHelpers loads, only the
+// front links are set, the search trees link back through their own copies.
+static void LinkLanes(RoadNetwork& map, const vector<pair<int, int> >& connections)
+{
+	vector<Lane>& lanes = map.roadSegments.at(0).Lanes;
+	for(unsigned int il = 0; il < lanes.size(); il++)
+	{
+		for(unsigned int p = 0; p < lanes.at(il).points.size(); p++)
+		{
+			lanes.at(il).points.at(p).pLane = &lanes.at(il);
+			if(p+1 < lanes.at(il).points.size())
+				lanes.at(il).points.at(p).pFronts.push_back(&lanes.at(il).points.at(p+1));
+		}
+	}
+
+	for(unsigned int i = 0; i < connections.size(); i++)
+	{
+		Lane* pFrom = GetLane(map, connections.at(i).first);
+		Lane* pTo = GetLane(map, connections.at(i).second);
+		pFrom->toLanes.push_back(pTo);
+		pTo->fromLanes.push_back(pFrom);
+		pFrom->points.back().pFronts.push_back(&pTo->points.front());
+	}
+}
+
+// parallel lanes with the same number of waypoints, left is at the left of right
+static void LinkParallelLanes(RoadNetwork& map, const int& left_id, const int& right_id)
+{
+	Lane* pLeft = GetLane(map, left_id);
+	Lane* pRight = GetLane(map, right_id);
+	for(unsigned int p = 0; p < pLeft->points.size() && p < pRight->points.size(); p++)
+	{
+		pLeft->points.at(p).pRight = &pRight->points.at(p);
+		pRight->points.at(p).pLeft = &pLeft->points.at(p);
+	}
+}
+
+static vector<int> PlanWithTree(WayPoint* pStart, WayPoint* pGoal, const vector<int>& globalPath)
+{
+	vector<WayPoint*> cells;
+	vector<WayPoint> path;
+	vector<vector<WayPoint> > paths;
+	WayPoint* pHead = PlanningHelpers::BuildPlanningSearchTreeV2(pStart, *pGoal, globalPath, 1000, true, cells);
+	if(pHead)
+		PlanningHelpers::TraversePathTreeBackwards(pHead, pStart, globalPath, path, paths);
+
+	vector<int> ids;
+	for(unsigned int i = 0; i < path.size(); i++)
+		ids.push_back(path.at(i).id);
+	for(unsigned int i = 0; i < cells.size(); i++)
+		delete cells.at(i);
+	return ids;
+}
+
+static vector<int> PlanWithRouter(const LaneRouter& router, WayPoint* pStart, WayPoint* pGoal, const vector<int>& globalPath)
+{
+	vector<WayPoint*> cells;
+	vector<WayPoint> path;
+	vector<vector<WayPoint> > paths;
+	WayPoint* pHead = router.FindRoute(pStart, pGoal, globalPath, 1000, true, cells);
+	if(pHead)
+		PlanningHelpers::TraversePathTreeBackwards(pHead, pStart, globalPath, path, paths);
+
+	vector<int> ids;
+	for(unsigned int i = 0; i < path.size(); i++)
+		ids.push_back(path.at(i).id);
+	for(unsigned int i = 0; i < cells.size(); i++)
+		delete cells.at(i);
+	return ids;
+}
+
+static bool RouteUsesLane(const RoadNetwork& map, const vector<int>& ids, const int& lane_id)
+{
+	for(unsigned int il = 0; il < map.roadSegments.at(0).Lanes.size(); il++)
+	{
+		const Lane& l = map.roadSegments.at(0).Lanes.at(il);
+		if(l.id != lane_id)
+			continue;
+		for(unsigned int i = 0; i < ids.size(); i++)
+		{
+			for(unsigned int p = 0; p < l.points.size(); p++)
+			{
+				if(l.points.at(p).id == ids.at(i))
+					return true;
+			}
+		}
+	}
+	return false;
+}
+
+// start lane 1, straight lane 2 and a longer detour 3 to the goal lane 4
+static void MakeDetourMap(RoadNetwork& map)
+{
+	map.roadSegments.resize(1);
+	AddLane(map, 1, {GPSPoint(0, 0, 0, 0), GPSPoint(20, 0, 0, 0)});
+	AddLane(map, 2, {GPSPoint(21, 0, 0, 0), GPSPoint(60, 0, 0, 0)});
+	AddLane(map, 3, {GPSPoint(21, 0.5, 0, 0), GPSPoint(40, 8, 0, 0), GPSPoint(60, 0.5, 0, 0)});
+	AddLane(map, 4, {GPSPoint(61, 0, 0, 0), GPSPoint(80, 0, 0, 0)});
+	LinkLanes(map, {make_pair(1, 2), make_pair(1, 3), make_pair(2, 4), make_pair(3, 4)});
+}
+
+TEST(LaneRouter, sameRouteAsSearchTree)
+{
+	RoadNetwork map;
+	MakeDetourMap(map);
+	WayPoint* pStart = &GetLane(map, 1)->points.at(2);
+	WayPoint* pGoal = &GetLane(map, 4)->points.at(15);
+
+	LaneRouter router;
+	router.BuildGraph(map);
+	ASSERT_TRUE(router.IsBuiltFor(map));
+
+	vector<int> tree_route = PlanWithTree(pStart, pGoal, vector<int>());
+	vector<int> router_route = PlanWithRouter(router, pStart, pGoal, vector<int>());
+	ASSERT_GT(tree_route.size(), 0u);
+	EXPECT_EQ(tree_route, router_route);
+	EXPECT_TRUE(RouteUsesLane(map, router_route, 2));
+}
+
+TEST(LaneRouter, actionCostChangedAfterBuild)
+{
+	RoadNetwork map;
+	MakeDetourMap(map);
+	WayPoint* pStart = &GetLane(map, 1)->points.at(2);
+	WayPoint* pGoal = &GetLane(map, 4)->points.at(15);
+
+	LaneRouter router;
+	router.BuildGraph(map);
+	vector<int> first_route = PlanWithRouter(router, pStart, pGoal, vector<int>());
+	EXPECT_TRUE(RouteUsesLane(map, first_route, 2));
+
+	// what MappingHelpers::UpdateMapWithOccupancyGrid does to a blocked waypoint
+	GetLane(map, 2)->points.at(20).actionCost.at(0).second = 100;
+	ASSERT_TRUE(router.IsBuiltFor(map));
+
+	vector<int> tree_route = PlanWithTree(pStart, pGoal, vector<int>());
+	vector<int> router_route = PlanWithRouter(router, pStart, pGoal, vector<int>());
+	ASSERT_GT(tree_route.size(), 0u);
+	EXPECT_EQ(tree_route, router_route);
+	EXPECT_TRUE(RouteUsesLane(map, router_route, 3));
+	EXPECT_FALSE(RouteUsesLane(map, router_route, 2));
+
+	// and back, like way_planner resetting the branch costs
+	GetLane(map, 2)->points.at(20).actionCost.at(0).second = 0;
+	EXPECT_EQ(first_route, PlanWithRouter(router, pStart, pGoal, vector<int>()));
+}
+
+TEST(LaneRouter, laneChangeOutOfLaneNotInGlobalPath)
+{
+	// lane 1 leads into the junction lane 2, which is not in the global path, lane 3 runs at its left.
+	// The route can only continue by changing from the first waypoint of lane 2 to lane 3.
+	RoadNetwork map;
+	map.roadSegments.resize(1);
+	AddLane(map, 1, {GPSPoint(0, 0, 0, 0), GPSPoint(30, 0, 0, 0)});
+	AddLane(map, 2, {GPSPoint(31, 0, 0, 0), GPSPoint(60, 0, 0, 0)});
+	AddLane(map, 3, {GPSPoint(31, 3.5, 0, 0), GPSPoint(60, 3.5, 0, 0)});
+	LinkLanes(map, {make_pair(1, 2)});
+	LinkParallelLanes(map, 3, 2);
+
+	WayPoint* pStart = &GetLane(map, 1)->points.at(0);
+	WayPoint* pGoal = &GetLane(map, 3)->points.at(20);
+	vector<int> globalPath = {1, 3};
+
+	LaneRouter router;
+	router.BuildGraph(map);
+
+	vector<int> tree_route = PlanWithTree(pStart, pGoal, globalPath);
+	vector<int> router_route = PlanWithRouter(router, pStart, pGoal, globalPath);
+	ASSERT_GT(tree_route.size(), 0u);
+	EXPECT_EQ(tree_route, router_route);
+	EXPECT_EQ(pGoal->id, router_route.back());
+	EXPECT_EQ(GetLane(map, 2)->points.at(0).id, router_route.at(30));
+	EXPECT_EQ(GetLane(map, 3)->points.at(0).id, router_route.at(31));
+}
+
+int main(int argc, char** argv)
+{
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
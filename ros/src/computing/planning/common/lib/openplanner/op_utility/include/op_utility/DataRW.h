@@ -30,6 +30,7 @@
 #include "vector_map_msgs/CurbArray.h"
 #include "vector_map_msgs/RoadEdgeArray.h"
 #include "vector_map_msgs/CrossWalkArray.h"
+#include "vector_map/vector_map.h"
 
 #include "UtilityH.h"
 
@@ -61,7 +62,9 @@ public:
 class SimpleReaderBase
 {
 private:
-	std::ifstream* m_pFile;
+	std::string m_Buffer; // whole file, read at once
+	size_t m_iPos;
+	bool m_bOpen;
 	std::vector<std::string> m_RawHeaders;
 	std::vector<std::string> m_DataTitlesHeader;
 	std::vector<std::vector<std::vector<std::string> > > m_AllData;
@@ -74,6 +77,7 @@ private:
 
 	void ReadHeaders();
 	void ParseDataTitles(const std::string& header);
+	bool NextLine(const char*& begin, const char*& end);
 
 public:
 	/**
@@ -181,10 +185,7 @@ public:
 		int MCODE3;
 	};
 
-	AisanPointsFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1)
-	{
-		m_min_id = std::numeric_limits<int>::max();
-	}
+	AisanPointsFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1){}
 
 	AisanPointsFileReader(const vector_map_msgs::PointArray& _points);
 	~AisanPointsFileReader(){}
@@ -196,8 +197,7 @@ public:
 	std::vector<AisanPoints> m_data_list;
 
 private:
-	int m_min_id;
-	std::vector<AisanPoints*> m_data_map;
+	vector_map::IdIndex<AisanPoints> m_data_map;
 };
 
 class AisanNodesFileReader : public SimpleReaderBase
@@ -210,10 +210,7 @@ public:
 		int PID;
 	};
 
-	AisanNodesFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1)
-	{
-		m_min_id = std::numeric_limits<int>::max();
-	}
+	AisanNodesFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1){}
 
 	AisanNodesFileReader(const vector_map_msgs::NodeArray& _nodes);
 	~AisanNodesFileReader(){}
@@ -225,8 +222,7 @@ public:
 	std::vector<AisanNode> m_data_list;
 
 private:
-	int m_min_id;
-	std::vector<AisanNode*> m_data_map;
+	vector_map::IdIndex<AisanNode> m_data_map;
 };
 
 class AisanLinesFileReader : public SimpleReaderBase
@@ -242,10 +238,7 @@ public:
 		int FLID;
 	};
 
-	AisanLinesFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1)
-	{
-		m_min_id = std::numeric_limits<int>::max();
-	}
+	AisanLinesFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1){}
 	AisanLinesFileReader(const vector_map_msgs::LineArray & _lines);
 	~AisanLinesFileReader(){}
 
@@ -256,8 +249,7 @@ public:
 	std::vector<AisanLine> m_data_list;
 
 private:
-	int m_min_id;
-	std::vector<AisanLine*> m_data_map;
+	vector_map::IdIndex<AisanLine> m_data_map;
 };
 
 class AisanCenterLinesFileReader : public SimpleReaderBase
@@ -278,10 +270,7 @@ public:
 		double 	RW;
 	};
 
-	AisanCenterLinesFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1)
-	{
-		m_min_id = std::numeric_limits<int>::max();
-	}
+	AisanCenterLinesFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1){}
 	AisanCenterLinesFileReader(const vector_map_msgs::DTLaneArray& _dtLanes);
 	~AisanCenterLinesFileReader(){}
 
@@ -292,8 +281,7 @@ public:
 	std::vector<AisanCenterLine> m_data_list;
 
 private:
-	int m_min_id;
-	std::vector<AisanCenterLine*> m_data_map;
+	vector_map::IdIndex<AisanCenterLine> m_data_map;
 };
 
 class AisanAreasFileReader : public SimpleReaderBase
@@ -307,10 +295,7 @@ public:
 		int 	ELID;
 	};
 
-	AisanAreasFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1)
-	{
-		m_min_id = std::numeric_limits<int>::max();
-	}
+	AisanAreasFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1){}
 	AisanAreasFileReader(const vector_map_msgs::AreaArray& _areas);
 	~AisanAreasFileReader(){}
 
@@ -321,8 +306,7 @@ public:
 	std::vector<AisanArea> m_data_list;
 
 private:
-	int m_min_id;
-	std::vector<AisanArea*> m_data_map;
+	vector_map::IdIndex<AisanArea> m_data_map;
 };
 
 class AisanIntersectionFileReader : public SimpleReaderBase
@@ -336,10 +320,7 @@ public:
 		int 	LinkID;
 	};
 
-	AisanIntersectionFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1)
-	{
-		m_min_id = std::numeric_limits<int>::max();
-	}
+	AisanIntersectionFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1){}
 	AisanIntersectionFileReader(const vector_map_msgs::CrossRoadArray& _inters);
 	~AisanIntersectionFileReader(){}
 
@@ -350,8 +331,7 @@ public:
 	std::vector<AisanIntersection> m_data_list;
 
 private:
-	int m_min_id;
-	std::vector<AisanIntersection*> m_data_map;
+	vector_map::IdIndex<AisanIntersection> m_data_map;
 };
 
 class AisanLanesFileReader : public SimpleReaderBase
@@ -390,10 +370,7 @@ public:
 		int originalMapID;
 	};
 
-	AisanLanesFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1)
-	{
-		m_min_id = std::numeric_limits<int>::max();
-	}
+	AisanLanesFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1){}
 	AisanLanesFileReader(const vector_map_msgs::LaneArray& _lanes);
 	~AisanLanesFileReader(){}
 
@@ -404,8 +381,7 @@ public:
 	std::vector<AisanLane> m_data_list;
 
 private:
-	int m_min_id;
-	std::vector<AisanLane*> m_data_map;
+	vector_map::IdIndex<AisanLane> m_data_map;
 };
 
 class AisanStopLineFileReader : public SimpleReaderBase
@@ -421,10 +397,7 @@ public:
 		int 	LinkID;
 	};
 
-	AisanStopLineFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1)
-	{
-		m_min_id = std::numeric_limits<int>::max();
-	}
+	AisanStopLineFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1){}
 	AisanStopLineFileReader(const vector_map_msgs::StopLineArray& _stopLines);
 	~AisanStopLineFileReader(){}
 
@@ -435,8 +408,7 @@ public:
 	std::vector<AisanStopLine> m_data_list;
 
 private:
-	int m_min_id;
-	std::vector<AisanStopLine*> m_data_map;
+	vector_map::IdIndex<AisanStopLine> m_data_map;
 };
 
 class AisanRoadSignFileReader : public SimpleReaderBase
@@ -452,10 +424,7 @@ public:
 		int 	LinkID;
 	};
 
-	AisanRoadSignFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1)
-	{
-		m_min_id = std::numeric_limits<int>::max();
-	}
+	AisanRoadSignFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1){}
 	AisanRoadSignFileReader(const vector_map_msgs::RoadSignArray& _signs);
 	~AisanRoadSignFileReader(){}
 
@@ -466,8 +435,7 @@ public:
 	std::vector<AisanRoadSign> m_data_list;
 
 private:
-	int m_min_id;
-	std::vector<AisanRoadSign*> m_data_map;
+	vector_map::IdIndex<AisanRoadSign> m_data_map;
 };
 
 class AisanSignalFileReader : public SimpleReaderBase
@@ -483,10 +451,7 @@ public:
 		int 	LinkID;
 	};
 
-	AisanSignalFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1)
-	{
-		m_min_id = std::numeric_limits<int>::max();
-	}
+	AisanSignalFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1){}
 	AisanSignalFileReader(const vector_map_msgs::SignalArray& _signals);
 	~AisanSignalFileReader(){}
 
@@ -497,8 +462,7 @@ public:
 	std::vector<AisanSignal> m_data_list;
 
 private:
-	int m_min_id;
-	std::vector<AisanSignal*> m_data_map;
+	vector_map::IdIndex<AisanSignal> m_data_map;
 };
 
 class AisanVectorFileReader : public SimpleReaderBase
@@ -513,10 +477,7 @@ public:
 		double 	Vang;
 	};
 
-	AisanVectorFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1)
-	{
-		m_min_id = std::numeric_limits<int>::max();
-	}
+	AisanVectorFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1){}
 	AisanVectorFileReader(const vector_map_msgs::VectorArray& _vectors);
 	~AisanVectorFileReader(){}
 
@@ -527,8 +488,7 @@ public:
 	std::vector<AisanVector> m_data_list;
 
 private:
-	int m_min_id;
-	std::vector<AisanVector*> m_data_map;
+	vector_map::IdIndex<AisanVector> m_data_map;
 };
 
 class AisanCurbFileReader : public SimpleReaderBase
@@ -545,10 +505,7 @@ public:
 		int 	LinkID;
 	};
 
-	AisanCurbFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1)
-	{
-		m_min_id = std::numeric_limits<int>::max();
-	}
+	AisanCurbFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1){}
 	AisanCurbFileReader(const vector_map_msgs::CurbArray& _curbs);
 	~AisanCurbFileReader(){}
 
@@ -559,8 +516,7 @@ public:
 	std::vector<AisanCurb> m_data_list;
 
 private:
-	int m_min_id;
-	std::vector<AisanCurb*> m_data_map;
+	vector_map::IdIndex<AisanCurb> m_data_map;
 };
 
 class AisanRoadEdgeFileReader : public SimpleReaderBase
@@ -574,10 +530,7 @@ public:
 		int 	LinkID;
 	};
 
-	AisanRoadEdgeFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1)
-	{
-		m_min_id = std::numeric_limits<int>::max();
-	}
+	AisanRoadEdgeFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1){}
 	AisanRoadEdgeFileReader(const vector_map_msgs::RoadEdgeArray& _roadEdges);
 	~AisanRoadEdgeFileReader(){}
 
@@ -588,8 +541,7 @@ public:
 	std::vector<AisanRoadEdge> m_data_list;
 
 private:
-	int m_min_id;
-	std::vector<AisanRoadEdge*> m_data_map;
+	vector_map::IdIndex<AisanRoadEdge> m_data_map;
 };
 
 class AisanCrossWalkFileReader : public SimpleReaderBase
@@ -605,10 +557,7 @@ public:
 		int 	LinkID;
 	};
 
-	AisanCrossWalkFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1)
-	{
-		m_min_id = std::numeric_limits<int>::max();
-	}
+	AisanCrossWalkFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1){}
 	AisanCrossWalkFileReader(const vector_map_msgs::CrossWalkArray& _crossWalks);
 	~AisanCrossWalkFileReader(){}
 
@@ -619,8 +568,7 @@ public:
 	std::vector<AisanCrossWalk> m_data_list;
 
 private:
-	int m_min_id;
-	std::vector<AisanCrossWalk*> m_data_map;
+	vector_map::IdIndex<AisanCrossWalk> m_data_map;
 };
 
 class AisanWayareaFileReader : public SimpleReaderBase
@@ -634,10 +582,7 @@ public:
 		int 	LinkID;
 	};
 
-	AisanWayareaFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1)
-	{
-		m_min_id = std::numeric_limits<int>::max();
-	}
+	AisanWayareaFileReader(const std::string& fileName) : SimpleReaderBase(fileName, 1){}
 	AisanWayareaFileReader(const vector_map_msgs::WayAreaArray& _wayArea);
 	~AisanWayareaFileReader(){}
 
@@ -648,8 +593,7 @@ public:
 	std::vector<AisanWayarea> m_data_list;
 
 private:
-	int m_min_id;
-	std::vector<AisanWayarea*> m_data_map;
+	vector_map::IdIndex<AisanWayarea> m_data_map;
 };
 
 class AisanDataConnFileReader : public SimpleReaderBase
@@ -798,6 +742,13 @@ public:
 		}
 	}
 
+	/**
+	 * Creates the readers from a compiled vector map (.vmb), the readers already created are kept
+	 * @param fileName compiled vector map made by vector_map_compiler
+	 * @return false if the file can't be loaded
+	 */
+	bool LoadFromBinaryMap(const std::string& fileName);
+
 	int GetVersion()
 	{
 		bool bTimeOut = UtilityH::GetTimeDiffNow(_time_out) > 2.0;
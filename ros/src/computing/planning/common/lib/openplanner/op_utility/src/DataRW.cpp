@@ -6,9 +6,11 @@
 
 #include "op_utility/DataRW.h"
 #include <stdlib.h>
+#include <string.h>
 #include <tinyxml.h>
 #include <sys/stat.h>
 #include "op_utility/UtilityH.h"
+#include <vector_map/binary_map.h>
 
 
 using namespace std;
@@ -214,23 +216,30 @@ void DataRW::WriteKMLFile(const string& fileName, const vector<vector<string> >&
 SimpleReaderBase::SimpleReaderBase(const string& fileName, const int& nHeaders,const char& separator,
 		  const int& iDataTitles, const int& nVariablesForOneObject ,
 		  const int& nLineHeaders, const string& headerRepeatKey)
+	: m_iPos(0), m_bOpen(false), m_nHeders(nHeaders), m_iDataTitles(iDataTitles),
+	  m_nVarPerObj(nVariablesForOneObject), m_nLineHeaders(nLineHeaders),
+	  m_HeaderRepeatKey(headerRepeatKey), m_Separator(separator)
 {
 	if(fileName.compare("d") != 0)
 	{
-	  m_pFile = new ifstream(fileName.c_str(), ios::in);
-	  if(!m_pFile->is_open())
+	  ifstream file(fileName.c_str(), ios::in | ios::binary);
+	  if(!file.is_open())
 	  {
 		  printf("\n Can't Open Map File !, %s", fileName.c_str());
 		  return;
 	  }
 
-	m_nHeders = nHeaders;
-	m_iDataTitles = iDataTitles;
-	m_nVarPerObj = nVariablesForOneObject;
-	m_HeaderRepeatKey = headerRepeatKey;
-	m_nLineHeaders = nLineHeaders;
-	m_Separator = separator;
-	m_pFile->precision(16);
+	// read the whole file at once, the lines are then split in memory
+	file.seekg(0, ios::end);
+	streamoff size = file.tellg();
+	file.seekg(0, ios::beg);
+	if(size > 0)
+	{
+		m_Buffer.resize(size);
+		file.read(&m_Buffer[0], size);
+		m_Buffer.resize(file.gcount());
+	}
+	m_bOpen = true;
 
 	ReadHeaders();
 	}
@@ -238,58 +247,69 @@ SimpleReaderBase::SimpleReaderBase(const string& fileName, const int& nHeaders,c
 
 SimpleReaderBase::~SimpleReaderBase()
 {
-	if(m_pFile->is_open())
-		m_pFile->close();
+}
+
+bool SimpleReaderBase::NextLine(const char*& begin, const char*& end)
+{
+	if(!m_bOpen || m_iPos >= m_Buffer.size()) return false;
+
+	const char* buffer_end = m_Buffer.data() + m_Buffer.size();
+	begin = m_Buffer.data() + m_iPos;
+	end = static_cast<const char*>(memchr(begin, '\n', buffer_end - begin));
+	if(end == nullptr)
+		end = buffer_end;
+
+	m_iPos = end - m_Buffer.data() + 1;
+	if(end > begin && *(end-1) == '\r')
+		end--;
+
+	return true;
 }
 
 bool SimpleReaderBase::ReadSingleLine(vector<vector<string> >& line)
 {
-	if(!m_pFile->is_open() || m_pFile->eof()) return false;
+	const char* begin = nullptr;
+	const char* end = nullptr;
+	if(!NextLine(begin, end)) return false;
 
-	string strLine, innerToken;
 	line.clear();
-	getline(*m_pFile, strLine);
-	istringstream str_stream(strLine);
-
-	vector<string> header;
-	vector<string> obj_part;
+	vector<string> tokens;
+	const char* token = begin;
+	while(token < end)
+	{
+		const char* sep = static_cast<const char*>(memchr(token, m_Separator, end - token));
+		if(sep == nullptr)
+			sep = end;
+		tokens.push_back(string(token, sep));
+		token = sep + 1;
+	}
 
 	if(m_nVarPerObj == 0)
 	{
-		while(getline(str_stream, innerToken, m_Separator))
-		{
-			obj_part.push_back(innerToken);
-		}
-
-		line.push_back(obj_part);
+		line.push_back(tokens);
 		return true;
 	}
-	else
-	{
-		int iCounter = 0;
-		while(iCounter < m_nLineHeaders && getline(str_stream, innerToken, m_Separator))
-		{
-			header.push_back(innerToken);
-			iCounter++;
-		}
-		obj_part.insert(obj_part.begin(), header.begin(), header.end());
 
-		iCounter = 1;
+	unsigned int iToken = 0;
+	vector<string> header;
+	while(iToken < tokens.size() && (int)header.size() < m_nLineHeaders)
+	{
+		header.push_back(tokens.at(iToken));
+		iToken++;
+	}
 
-		while(getline(str_stream, innerToken, m_Separator))
+	vector<string> obj_part(header);
+	int iCounter = 1;
+	for(; iToken < tokens.size(); iToken++)
+	{
+		obj_part.push_back(tokens.at(iToken));
+		if(iCounter == m_nVarPerObj)
 		{
-			obj_part.push_back(innerToken);
-			if(iCounter == m_nVarPerObj)
-			{
-				line.push_back(obj_part);
-				obj_part.clear();
-
-				iCounter = 0;
-				obj_part.insert(obj_part.begin(), header.begin(), header.end());
-
-			}
-			iCounter++;
+			line.push_back(obj_part);
+			obj_part = header;
+			iCounter = 0;
 		}
+		iCounter++;
 	}
 
 	return true;
@@ -297,13 +317,12 @@ bool SimpleReaderBase::ReadSingleLine(vector<vector<string> >& line)
 
 int SimpleReaderBase::ReadAllData()
 {
-	if(!m_pFile->is_open()) return 0;
+	if(!m_bOpen) return 0;
 
 	m_AllData.clear();
 	vector<vector<string> > singleLine;
-	while(!m_pFile->eof())
+	while(ReadSingleLine(singleLine))
 	{
-		ReadSingleLine(singleLine);
 		m_AllData.push_back(singleLine);
 	}
 
@@ -312,14 +331,15 @@ int SimpleReaderBase::ReadAllData()
 
 void SimpleReaderBase::ReadHeaders()
 {
-	if(!m_pFile->is_open()) return;
+	if(!m_bOpen) return;
 
-	string strLine;
+	const char* begin = nullptr;
+	const char* end = nullptr;
 	int iCounter = 0;
 	m_RawHeaders.clear();
-	while(!m_pFile->eof() && iCounter < m_nHeders)
+	while(iCounter < m_nHeders && NextLine(begin, end))
 	{
-		getline(*m_pFile, strLine);
+		string strLine(begin, end);
 		m_RawHeaders.push_back(strLine);
 		if(iCounter == m_iDataTitles)
 			ParseDataTitles(strLine);
@@ -460,31 +480,19 @@ AisanNodesFileReader::AisanNodesFileReader(const vector_map_msgs::NodeArray& _no
 {
 	if(_nodes.data.size()==0) return;
 
-	m_min_id = std::numeric_limits<int>::max();
-
 	//TODO Fix PID and NID problem
 
 	m_data_list.clear();
 	AisanNode data;
-	int max_id = std::numeric_limits<int>::min();
 
 	for(unsigned int i=0; i < _nodes.data.size(); i++)
 	{
 		ParseNextLine(_nodes.data.at(i), data);
 
 		m_data_list.push_back(data);
-		if(data.NID < m_min_id)
-			m_min_id = data.NID;
-
-		if(data.NID > max_id)
-			max_id = data.NID;
 	}
 
-	m_data_map.resize(max_id-m_min_id+2);
-	for(unsigned int i=0; i < m_data_list.size(); i++)
-	{
-		m_data_map.at(m_data_list.at(i).NID-m_min_id) = &m_data_list.at(i);
-	}
+	m_data_map.build(m_data_list, &AisanNodesFileReader::AisanNode::NID);
 }
 
 void AisanNodesFileReader::ParseNextLine(const vector_map_msgs::Node& _rec, AisanNode& data)
@@ -495,25 +503,7 @@ void AisanNodesFileReader::ParseNextLine(const vector_map_msgs::Node& _rec, Aisa
 
 AisanNodesFileReader::AisanNode* AisanNodesFileReader::GetDataRowById(int _nid)
 {
-	if(m_data_map.size()==0) return nullptr;
-
-	int index = _nid-m_min_id;
-	if(index >= 0 && index < m_data_map.size())
-	{
-		return m_data_map.at(index);
-	}
-	else
-	{
-		for(unsigned int i=0; i < m_data_list.size(); i++)
-		{
-			if(m_data_list.at(i).NID == _nid)
-			{
-				return &m_data_list.at(i);
-			}
-		}
-	}
-
-	return nullptr;
+	return m_data_map.find(_nid);
 }
 
 bool AisanNodesFileReader::ReadNextLine(AisanNode& data)
@@ -539,22 +529,12 @@ int AisanNodesFileReader::ReadAllData(vector<AisanNode>& data_list)
 	m_data_list.clear();
 	AisanNode data;
 	//double logTime = 0;
-	int max_id = std::numeric_limits<int>::min();
 	while(ReadNextLine(data))
 	{
 		m_data_list.push_back(data);
-		if(data.NID < m_min_id)
-			m_min_id = data.NID;
-
-		if(data.NID > max_id)
-			max_id = data.NID;
 	}
 
-	m_data_map.resize(max_id - m_min_id + 2);
-	for(unsigned int i=0; i < m_data_list.size(); i++)
-	{
-		m_data_map.at(m_data_list.at(i).NID-m_min_id) = &m_data_list.at(i);
-	}
+	m_data_map.build(m_data_list, &AisanNodesFileReader::AisanNode::NID);
 
 	data_list = m_data_list;
 	return m_data_list.size();
@@ -566,29 +546,17 @@ AisanPointsFileReader::AisanPointsFileReader(const vector_map_msgs::PointArray&
 {
 	if(_points.data.size()==0) return;
 
-	m_min_id = std::numeric_limits<int>::max();
-
 	m_data_list.clear();
 	AisanPoints data;
-	int max_id = std::numeric_limits<int>::min();
 
 	for(unsigned int i=0; i < _points.data.size(); i++)
 	{
 		ParseNextLine(_points.data.at(i), data);
 
 		m_data_list.push_back(data);
-		if(data.PID < m_min_id)
-			m_min_id = data.PID;
-
-		if(data.PID > max_id)
-			max_id = data.PID;
 	}
 
-	m_data_map.resize(max_id-m_min_id+2);
-	for(unsigned int i=0; i < m_data_list.size(); i++)
-	{
-		m_data_map.at(m_data_list.at(i).PID-m_min_id) = &m_data_list.at(i);
-	}
+	m_data_map.build(m_data_list, &AisanPointsFileReader::AisanPoints::PID);
 }
 
 void AisanPointsFileReader::ParseNextLine(const vector_map_msgs::Point& _rec, AisanPoints& data)
@@ -607,25 +575,7 @@ void AisanPointsFileReader::ParseNextLine(const vector_map_msgs::Point& _rec, Ai
 
 AisanPointsFileReader::AisanPoints* AisanPointsFileReader::GetDataRowById(int _pid)
 {
-	if(m_data_map.size()==0) return nullptr;
-
-	int index = _pid-m_min_id;
-	if(index >= 0 && index < m_data_map.size())
-	{
-		return m_data_map.at(index);
-	}
-	else
-	{
-		for(unsigned int i=0; i < m_data_list.size(); i++)
-		{
-			if(m_data_list.at(i).PID == _pid)
-			{
-				return &m_data_list.at(i);
-			}
-		}
-	}
-
-	return nullptr;
+	return m_data_map.find(_pid);
 }
 
 bool AisanPointsFileReader::ReadNextLine(AisanPoints& data)
@@ -660,22 +610,12 @@ int AisanPointsFileReader::ReadAllData(vector<AisanPoints>& data_list)
 	m_data_list.clear();
 	AisanPoints data;
 	//double logTime = 0;
-	int max_id = std::numeric_limits<int>::min();
 	while(ReadNextLine(data))
 	{
 		m_data_list.push_back(data);
-		if(data.PID < m_min_id)
-			m_min_id = data.PID;
-
-		if(data.PID > max_id)
-			max_id = data.PID;
 	}
 
-	m_data_map.resize(max_id-m_min_id+2);
-	for(unsigned int i=0; i < m_data_list.size(); i++)
-	{
-		m_data_map.at(m_data_list.at(i).PID-m_min_id) = &m_data_list.at(i);
-	}
+	m_data_map.build(m_data_list, &AisanPointsFileReader::AisanPoints::PID);
 
 	data_list = m_data_list;
 	return m_data_list.size();
@@ -687,29 +627,17 @@ AisanLinesFileReader::AisanLinesFileReader(const vector_map_msgs::LineArray& _no
 {
 	if(_nodes.data.size()==0) return;
 
-	m_min_id = std::numeric_limits<int>::max();
-
 	m_data_list.clear();
 	AisanLine data;
-	int max_id = std::numeric_limits<int>::min();
 
 	for(unsigned int i=0; i < _nodes.data.size(); i++)
 	{
 		ParseNextLine(_nodes.data.at(i), data);
 
 		m_data_list.push_back(data);
-		if(data.LID < m_min_id)
-			m_min_id = data.LID;
-
-		if(data.LID > max_id)
-			max_id = data.LID;
 	}
 
-	m_data_map.resize(max_id-m_min_id+2);
-	for(unsigned int i=0; i < m_data_list.size(); i++)
-	{
-		m_data_map.at(m_data_list.at(i).LID-m_min_id) = &m_data_list.at(i);
-	}
+	m_data_map.build(m_data_list, &AisanLinesFileReader::AisanLine::LID);
 }
 
 void AisanLinesFileReader::ParseNextLine(const vector_map_msgs::Line& _rec, AisanLine& data)
@@ -723,25 +651,7 @@ void AisanLinesFileReader::ParseNextLine(const vector_map_msgs::Line& _rec, Aisa
 
 AisanLinesFileReader::AisanLine* AisanLinesFileReader::GetDataRowById(int _lid)
 {
-	if(m_data_map.size()==0) return nullptr;
-
-	int index = _lid-m_min_id;
-	if(index >= 0 && index < m_data_map.size())
-	{
-		return m_data_map.at(index);
-	}
-	else
-	{
-		for(unsigned int i=0; i < m_data_list.size(); i++)
-		{
-			if(m_data_list.at(i).LID == _lid)
-			{
-				return &m_data_list.at(i);
-			}
-		}
-	}
-
-	return nullptr;
+	return m_data_map.find(_lid);
 }
 
 bool AisanLinesFileReader::ReadNextLine(AisanLine& data)
@@ -770,22 +680,12 @@ int AisanLinesFileReader::ReadAllData(vector<AisanLine>& data_list)
 	AisanLine data;
 	//double logTime = 0;
 
-	int max_id = std::numeric_limits<int>::min();
 	while(ReadNextLine(data))
 	{
 		m_data_list.push_back(data);
-		if(data.LID < m_min_id)
-			m_min_id = data.LID;
-
-		if(data.LID > max_id)
-			max_id = data.LID;
 	}
 
-	m_data_map.resize(max_id - m_min_id + 2);
-	for(unsigned int i=0; i < m_data_list.size(); i++)
-	{
-		m_data_map.at(m_data_list.at(i).LID-m_min_id) = &m_data_list.at(i);
-	}
+	m_data_map.build(m_data_list, &AisanLinesFileReader::AisanLine::LID);
 
 	data_list = m_data_list;
 	return m_data_list.size();
@@ -797,29 +697,17 @@ AisanCenterLinesFileReader::AisanCenterLinesFileReader(const vector_map_msgs::DT
 {
 	if(_Lines.data.size()==0) return;
 
-	m_min_id = std::numeric_limits<int>::max();
-
 	m_data_list.clear();
 	AisanCenterLine data;
-	int max_id = std::numeric_limits<int>::min();
 
 	for(unsigned int i=0; i < _Lines.data.size(); i++)
 	{
 		ParseNextLine(_Lines.data.at(i), data);
 
 		m_data_list.push_back(data);
-		if(data.DID < m_min_id)
-			m_min_id = data.DID;
-
-		if(data.DID > max_id)
-			max_id = data.DID;
 	}
 
-	m_data_map.resize(max_id-m_min_id+2);
-	for(unsigned int i=0; i < m_data_list.size(); i++)
-	{
-		m_data_map.at(m_data_list.at(i).DID-m_min_id) = &m_data_list.at(i);
-	}
+	m_data_map.build(m_data_list, &AisanCenterLinesFileReader::AisanCenterLine::DID);
 }
 
 void AisanCenterLinesFileReader::ParseNextLine(const vector_map_msgs::DTLane& _rec, AisanCenterLine& data)
@@ -838,25 +726,7 @@ void AisanCenterLinesFileReader::ParseNextLine(const vector_map_msgs::DTLane& _r
 
 AisanCenterLinesFileReader::AisanCenterLine* AisanCenterLinesFileReader::GetDataRowById(int _did)
 {
-	if(m_data_map.size()==0) return nullptr;
-
-	int index = _did-m_min_id;
-	if(index >= 0 && index < m_data_map.size())
-	{
-		return m_data_map.at(index);
-	}
-	else
-	{
-		for(unsigned int i=0; i < m_data_list.size(); i++)
-		{
-			if(m_data_list.at(i).DID == _did)
-			{
-				return &m_data_list.at(i);
-			}
-		}
-	}
-
-	return nullptr;
+	return m_data_map.find(_did);
 }
 
 bool AisanCenterLinesFileReader::ReadNextLine(AisanCenterLine& data)
@@ -905,29 +775,17 @@ AisanLanesFileReader::AisanLanesFileReader(const vector_map_msgs::LaneArray& _la
 {
 	if(_lanes.data.size()==0) return;
 
-	m_min_id = std::numeric_limits<int>::max();
-
 	m_data_list.clear();
 	AisanLane data;
-	int max_id = std::numeric_limits<int>::min();
 
 	for(unsigned int i=0; i < _lanes.data.size(); i++)
 	{
 		ParseNextLine(_lanes.data.at(i), data);
 
 		m_data_list.push_back(data);
-		if(data.LnID < m_min_id)
-			m_min_id = data.LnID;
-
-		if(data.LnID > max_id)
-			max_id = data.LnID;
 	}
 
-	m_data_map.resize(max_id-m_min_id+2);
-	for(unsigned int i=0; i < m_data_list.size(); i++)
-	{
-		m_data_map.at(m_data_list.at(i).LnID-m_min_id) = &m_data_list.at(i);
-	}
+	m_data_map.build(m_data_list, &AisanLanesFileReader::AisanLane::LnID);
 }
 
 void AisanLanesFileReader::ParseNextLine(const vector_map_msgs::Lane& _rec, AisanLane& data)
@@ -965,25 +823,7 @@ void AisanLanesFileReader::ParseNextLine(const vector_map_msgs::Lane& _rec, Aisa
 
 AisanLanesFileReader::AisanLane* AisanLanesFileReader::GetDataRowById(int _lnid)
 {
-	if(m_data_map.size()==0) return nullptr;
-
-	int index = _lnid-m_min_id;
-	if(index >= 0 && index < m_data_map.size())
-	{
-		return m_data_map.at(index);
-	}
-	else
-	{
-		for(unsigned int i=0; i < m_data_list.size(); i++)
-		{
-			if(m_data_list.at(i).LnID == _lnid)
-			{
-				return &m_data_list.at(i);
-			}
-		}
-	}
-
-	return nullptr;
+	return m_data_map.find(_lnid);
 }
 
 bool AisanLanesFileReader::ReadNextLine(AisanLane& data)
@@ -1049,23 +889,13 @@ int AisanLanesFileReader::ReadAllData(vector<AisanLane>& data_list)
 	data_list.clear();
 	AisanLane data;
 	//double logTime = 0;
-	int max_id = std::numeric_limits<int>::min();
 
 	while(ReadNextLine(data))
 	{
 		m_data_list.push_back(data);
-		if(data.LnID < m_min_id)
-			m_min_id = data.LnID;
-
-		if(data.LnID > max_id)
-			max_id = data.LnID;
 	}
 
-	m_data_map.resize(max_id-m_min_id+2);
-	for(unsigned int i=0; i < m_data_list.size(); i++)
-	{
-		m_data_map.at(m_data_list.at(i).LnID-m_min_id) = &m_data_list.at(i);
-	}
+	m_data_map.build(m_data_list, &AisanLanesFileReader::AisanLane::LnID);
 
 	data_list = m_data_list;
 
@@ -1078,29 +908,17 @@ AisanAreasFileReader::AisanAreasFileReader(const vector_map_msgs::AreaArray& _ar
 {
 	if(_areas.data.size()==0) return;
 
-	m_min_id = std::numeric_limits<int>::max();
-
 	m_data_list.clear();
 	AisanArea data;
-	int max_id = std::numeric_limits<int>::min();
 
 	for(unsigned int i=0; i < _areas.data.size(); i++)
 	{
 		ParseNextLine(_areas.data.at(i), data);
 
 		m_data_list.push_back(data);
-		if(data.AID < m_min_id)
-			m_min_id = data.AID;
-
-		if(data.AID > max_id)
-			max_id = data.AID;
 	}
 
-	m_data_map.resize(max_id-m_min_id+2);
-	for(unsigned int i=0; i < m_data_list.size(); i++)
-	{
-		m_data_map.at(m_data_list.at(i).AID-m_min_id) = &m_data_list.at(i);
-	}
+	m_data_map.build(m_data_list, &AisanAreasFileReader::AisanArea::AID);
 }
 
 void AisanAreasFileReader::ParseNextLine(const vector_map_msgs::Area& _rec, AisanArea& data)
@@ -1112,25 +930,7 @@ void AisanAreasFileReader::ParseNextLine(const vector_map_msgs::Area& _rec, Aisa
 
 AisanAreasFileReader::AisanArea* AisanAreasFileReader::GetDataRowById(int _aid)
 {
-	if(m_data_map.size()==0) return nullptr;
-
-	int index = _aid-m_min_id;
-	if(index >= 0 && index < m_data_map.size())
-	{
-		return m_data_map.at(index);
-	}
-	else
-	{
-		for(unsigned int i=0; i < m_data_list.size(); i++)
-		{
-			if(m_data_list.at(i).AID == _aid)
-			{
-				return &m_data_list.at(i);
-			}
-		}
-	}
-
-	return nullptr;
+	return m_data_map.find(_aid);
 }
 
 bool AisanAreasFileReader::ReadNextLine(AisanArea& data)
@@ -1172,29 +972,17 @@ AisanIntersectionFileReader::AisanIntersectionFileReader(const vector_map_msgs::
 {
 	if(_inters.data.size()==0) return;
 
-	m_min_id = std::numeric_limits<int>::max();
-
 	m_data_list.clear();
 	AisanIntersection data;
-	int max_id = std::numeric_limits<int>::min();
 
 	for(unsigned int i=0; i < _inters.data.size(); i++)
 	{
 		ParseNextLine(_inters.data.at(i), data);
 
 		m_data_list.push_back(data);
-		if(data.ID < m_min_id)
-			m_min_id = data.ID;
-
-		if(data.ID > max_id)
-			max_id = data.ID;
 	}
 
-	m_data_map.resize(max_id-m_min_id+2);
-	for(unsigned int i=0; i < m_data_list.size(); i++)
-	{
-		m_data_map.at(m_data_list.at(i).ID-m_min_id) = &m_data_list.at(i);
-	}
+	m_data_map.build(m_data_list, &AisanIntersectionFileReader::AisanIntersection::ID);
 }
 
 void AisanIntersectionFileReader::ParseNextLine(const vector_map_msgs::CrossRoad& _rec, AisanIntersection& data)
@@ -1206,25 +994,7 @@ void AisanIntersectionFileReader::ParseNextLine(const vector_map_msgs::CrossRoad
 
 AisanIntersectionFileReader::AisanIntersection* AisanIntersectionFileReader::GetDataRowById(int _id)
 {
-	if(m_data_map.size()==0) return nullptr;
-
-	int index = _id-m_min_id;
-	if(index >= 0 && index < m_data_map.size())
-	{
-		return m_data_map.at(index);
-	}
-	else
-	{
-		for(unsigned int i=0; i < m_data_list.size(); i++)
-		{
-			if(m_data_list.at(i).ID == _id)
-			{
-				return &m_data_list.at(i);
-			}
-		}
-	}
-
-	return nullptr;
+	return m_data_map.find(_id);
 }
 
 bool AisanIntersectionFileReader::ReadNextLine(AisanIntersection& data)
@@ -1266,29 +1036,17 @@ AisanStopLineFileReader::AisanStopLineFileReader(const vector_map_msgs::StopLine
 {
 	if(_stopLines.data.size()==0) return;
 
-	m_min_id = std::numeric_limits<int>::max();
-
 	m_data_list.clear();
 	AisanStopLine data;
-	int max_id = std::numeric_limits<int>::min();
 
 	for(unsigned int i=0; i < _stopLines.data.size(); i++)
 	{
 		ParseNextLine(_stopLines.data.at(i), data);
 
 		m_data_list.push_back(data);
-		if(data.ID < m_min_id)
-			m_min_id = data.ID;
-
-		if(data.ID > max_id)
-			max_id = data.ID;
 	}
 
-	m_data_map.resize(max_id-m_min_id+2);
-	for(unsigned int i=0; i < m_data_list.size(); i++)
-	{
-		m_data_map.at(m_data_list.at(i).ID-m_min_id) = &m_data_list.at(i);
-	}
+	m_data_map.build(m_data_list, &AisanStopLineFileReader::AisanStopLine::ID);
 }
 
 void AisanStopLineFileReader::ParseNextLine(const vector_map_msgs::StopLine& _rec, AisanStopLine& data)
@@ -1302,25 +1060,7 @@ void AisanStopLineFileReader::ParseNextLine(const vector_map_msgs::StopLine& _re
 
 AisanStopLineFileReader::AisanStopLine* AisanStopLineFileReader::GetDataRowById(int _id)
 {
-	if(m_data_map.size()==0) return nullptr;
-
-	int index = _id-m_min_id;
-	if(index >= 0 && index < m_data_map.size())
-	{
-		return m_data_map.at(index);
-	}
-	else
-	{
-		for(unsigned int i=0; i < m_data_list.size(); i++)
-		{
-			if(m_data_list.at(i).ID == _id)
-			{
-				return &m_data_list.at(i);
-			}
-		}
-	}
-
-	return nullptr;
+	return m_data_map.find(_id);
 }
 
 bool AisanStopLineFileReader::ReadNextLine(AisanStopLine& data)
@@ -1364,29 +1104,17 @@ AisanRoadSignFileReader::AisanRoadSignFileReader(const vector_map_msgs::RoadSign
 {
 	if(_signs.data.size()==0) return;
 
-	m_min_id = std::numeric_limits<int>::max();
-
 	m_data_list.clear();
 	AisanRoadSign data;
-	int max_id = std::numeric_limits<int>::min();
 
 	for(unsigned int i=0; i < _signs.data.size(); i++)
 	{
 		ParseNextLine(_signs.data.at(i), data);
 
 		m_data_list.push_back(data);
-		if(data.ID < m_min_id)
-			m_min_id = data.ID;
-
-		if(data.ID > max_id)
-			max_id = data.ID;
 	}
 
-	m_data_map.resize(max_id-m_min_id+2);
-	for(unsigned int i=0; i < m_data_list.size(); i++)
-	{
-		m_data_map.at(m_data_list.at(i).ID-m_min_id) = &m_data_list.at(i);
-	}
+	m_data_map.build(m_data_list, &AisanRoadSignFileReader::AisanRoadSign::ID);
 }
 
 void AisanRoadSignFileReader::ParseNextLine(const vector_map_msgs::RoadSign& _rec, AisanRoadSign& data)
@@ -1400,25 +1128,7 @@ void AisanRoadSignFileReader::ParseNextLine(const vector_map_msgs::RoadSign& _re
 
 AisanRoadSignFileReader::AisanRoadSign* AisanRoadSignFileReader::GetDataRowById(int _id)
 {
-	if(m_data_map.size()==0) return nullptr;
-
-	int index = _id-m_min_id;
-	if(index >= 0 && index < m_data_map.size())
-	{
-		return m_data_map.at(index);
-	}
-	else
-	{
-		for(unsigned int i=0; i < m_data_list.size(); i++)
-		{
-			if(m_data_list.at(i).ID == _id)
-			{
-				return &m_data_list.at(i);
-			}
-		}
-	}
-
-	return nullptr;
+	return m_data_map.find(_id);
 }
 
 bool AisanRoadSignFileReader::ReadNextLine(AisanRoadSign& data)
@@ -1462,29 +1172,17 @@ AisanSignalFileReader::AisanSignalFileReader(const vector_map_msgs::SignalArray&
 {
 	if(_signal.data.size()==0) return;
 
-	m_min_id = std::numeric_limits<int>::max();
-
 	m_data_list.clear();
 	AisanSignal data;
-	int max_id = std::numeric_limits<int>::min();
 
 	for(unsigned int i=0; i < _signal.data.size(); i++)
 	{
 		ParseNextLine(_signal.data.at(i), data);
 
 		m_data_list.push_back(data);
-		if(data.ID < m_min_id)
-			m_min_id = data.ID;
-
-		if(data.ID > max_id)
-			max_id = data.ID;
 	}
 
-	m_data_map.resize(max_id-m_min_id+2);
-	for(unsigned int i=0; i < m_data_list.size(); i++)
-	{
-		m_data_map.at(m_data_list.at(i).ID-m_min_id) = &m_data_list.at(i);
-	}
+	m_data_map.build(m_data_list, &AisanSignalFileReader::AisanSignal::ID);
 }
 
 void AisanSignalFileReader::ParseNextLine(const vector_map_msgs::Signal& _rec, AisanSignal& data)
@@ -1498,25 +1196,7 @@ void AisanSignalFileReader::ParseNextLine(const vector_map_msgs::Signal& _rec, A
 
 AisanSignalFileReader::AisanSignal* AisanSignalFileReader::GetDataRowById(int _id)
 {
-	if(m_data_map.size()==0) return nullptr;
-
-	int index = _id-m_min_id;
-	if(index >= 0 && index < m_data_map.size())
-	{
-		return m_data_map.at(index);
-	}
-	else
-	{
-		for(unsigned int i=0; i < m_data_list.size(); i++)
-		{
-			if(m_data_list.at(i).ID == _id)
-			{
-				return &m_data_list.at(i);
-			}
-		}
-	}
-
-	return nullptr;
+	return m_data_map.find(_id);
 }
 
 bool AisanSignalFileReader::ReadNextLine(AisanSignal& data)
@@ -1561,29 +1241,17 @@ AisanVectorFileReader::AisanVectorFileReader(const vector_map_msgs::VectorArray&
 {
 	if(_vectors.data.size()==0) return;
 
-	m_min_id = std::numeric_limits<int>::max();
-
 	m_data_list.clear();
 	AisanVector data;
-	int max_id = std::numeric_limits<int>::min();
 
 	for(unsigned int i=0; i < _vectors.data.size(); i++)
 	{
 		ParseNextLine(_vectors.data.at(i), data);
 
 		m_data_list.push_back(data);
-		if(data.VID < m_min_id)
-			m_min_id = data.VID;
-
-		if(data.VID > max_id)
-			max_id = data.VID;
 	}
 
-	m_data_map.resize(max_id-m_min_id+2);
-	for(unsigned int i=0; i < m_data_list.size(); i++)
-	{
-		m_data_map.at(m_data_list.at(i).VID-m_min_id) = &m_data_list.at(i);
-	}
+	m_data_map.build(m_data_list, &AisanVectorFileReader::AisanVector::VID);
 }
 
 void AisanVectorFileReader::ParseNextLine(const vector_map_msgs::Vector& _rec, AisanVector& data)
@@ -1596,25 +1264,7 @@ void AisanVectorFileReader::ParseNextLine(const vector_map_msgs::Vector& _rec, A
 
 AisanVectorFileReader::AisanVector* AisanVectorFileReader::GetDataRowById(int _id)
 {
-	if(m_data_map.size()==0) return nullptr;
-
-	int index = _id-m_min_id;
-	if(index >= 0 && index < m_data_map.size())
-	{
-		return m_data_map.at(index);
-	}
-	else
-	{
-		for(unsigned int i=0; i < m_data_list.size(); i++)
-		{
-			if(m_data_list.at(i).VID == _id)
-			{
-				return &m_data_list.at(i);
-			}
-		}
-	}
-
-	return nullptr;
+	return m_data_map.find(_id);
 }
 
 bool AisanVectorFileReader::ReadNextLine(AisanVector& data)
@@ -1657,29 +1307,17 @@ AisanCurbFileReader::AisanCurbFileReader(const vector_map_msgs::CurbArray& _curb
 {
 	if(_curbs.data.size()==0) return;
 
-	m_min_id = std::numeric_limits<int>::max();
-
 	m_data_list.clear();
 	AisanCurb data;
-	int max_id = std::numeric_limits<int>::min();
 
 	for(unsigned int i=0; i < _curbs.data.size(); i++)
 	{
 		ParseNextLine(_curbs.data.at(i), data);
 
 		m_data_list.push_back(data);
-		if(data.ID < m_min_id)
-			m_min_id = data.ID;
-
-		if(data.ID > max_id)
-			max_id = data.ID;
 	}
 
-	m_data_map.resize(max_id-m_min_id+2);
-	for(unsigned int i=0; i < m_data_list.size(); i++)
-	{
-		m_data_map.at(m_data_list.at(i).ID-m_min_id) = &m_data_list.at(i);
-	}
+	m_data_map.build(m_data_list, &AisanCurbFileReader::AisanCurb::ID);
 }
 
 void AisanCurbFileReader::ParseNextLine(const vector_map_msgs::Curb& _rec, AisanCurb& data)
@@ -1694,25 +1332,7 @@ void AisanCurbFileReader::ParseNextLine(const vector_map_msgs::Curb& _rec, Aisan
 
 AisanCurbFileReader::AisanCurb* AisanCurbFileReader::GetDataRowById(int _id)
 {
-	if(m_data_map.size()==0) return nullptr;
-
-	int index = _id-m_min_id;
-	if(index >= 0 && index < m_data_map.size())
-	{
-		return m_data_map.at(index);
-	}
-	else
-	{
-		for(unsigned int i=0; i < m_data_list.size(); i++)
-		{
-			if(m_data_list.at(i).ID == _id)
-			{
-				return &m_data_list.at(i);
-			}
-		}
-	}
-
-	return nullptr;
+	return m_data_map.find(_id);
 }
 
 bool AisanCurbFileReader::ReadNextLine(AisanCurb& data)
@@ -1757,29 +1377,17 @@ AisanRoadEdgeFileReader::AisanRoadEdgeFileReader(const vector_map_msgs::RoadEdge
 {
 	if(_edges.data.size()==0) return;
 
-	m_min_id = std::numeric_limits<int>::max();
-
 	m_data_list.clear();
 	AisanRoadEdge data;
-	int max_id = std::numeric_limits<int>::min();
 
 	for(unsigned int i=0; i < _edges.data.size(); i++)
 	{
 		ParseNextLine(_edges.data.at(i), data);
 
 		m_data_list.push_back(data);
-		if(data.ID < m_min_id)
-			m_min_id = data.ID;
-
-		if(data.ID > max_id)
-			max_id = data.ID;
 	}
 
-	m_data_map.resize(max_id-m_min_id+2);
-	for(unsigned int i=0; i < m_data_list.size(); i++)
-	{
-		m_data_map.at(m_data_list.at(i).ID-m_min_id) = &m_data_list.at(i);
-	}
+	m_data_map.build(m_data_list, &AisanRoadEdgeFileReader::AisanRoadEdge::ID);
 }
 
 void AisanRoadEdgeFileReader::ParseNextLine(const vector_map_msgs::RoadEdge& _rec, AisanRoadEdge& data)
@@ -1791,25 +1399,7 @@ void AisanRoadEdgeFileReader::ParseNextLine(const vector_map_msgs::RoadEdge& _re
 
 AisanRoadEdgeFileReader::AisanRoadEdge* AisanRoadEdgeFileReader::GetDataRowById(int _id)
 {
-	if(m_data_map.size()==0) return nullptr;
-
-	int index = _id-m_min_id;
-	if(index >= 0 && index < m_data_map.size())
-	{
-		return m_data_map.at(index);
-	}
-	else
-	{
-		for(unsigned int i=0; i < m_data_list.size(); i++)
-		{
-			if(m_data_list.at(i).ID == _id)
-			{
-				return &m_data_list.at(i);
-			}
-		}
-	}
-
-	return nullptr;
+	return m_data_map.find(_id);
 }
 
 bool AisanRoadEdgeFileReader::ReadNextLine(AisanRoadEdge& data)
@@ -1851,29 +1441,17 @@ AisanCrossWalkFileReader::AisanCrossWalkFileReader(const vector_map_msgs::CrossW
 {
 	if(_crossWalks.data.size()==0) return;
 
-	m_min_id = std::numeric_limits<int>::max();
-
 	m_data_list.clear();
 	AisanCrossWalk data;
-	int max_id = std::numeric_limits<int>::min();
 
 	for(unsigned int i=0; i < _crossWalks.data.size(); i++)
 	{
 		ParseNextLine(_crossWalks.data.at(i), data);
 
 		m_data_list.push_back(data);
-		if(data.ID < m_min_id)
-			m_min_id = data.ID;
-
-		if(data.ID > max_id)
-			max_id = data.ID;
 	}
 
-	m_data_map.resize(max_id-m_min_id+2);
-	for(unsigned int i=0; i < m_data_list.size(); i++)
-	{
-		m_data_map.at(m_data_list.at(i).ID-m_min_id) = &m_data_list.at(i);
-	}
+	m_data_map.build(m_data_list, &AisanCrossWalkFileReader::AisanCrossWalk::ID);
 }
 
 void AisanCrossWalkFileReader::ParseNextLine(const vector_map_msgs::CrossWalk& _rec, AisanCrossWalk& data)
@@ -1887,25 +1465,7 @@ void AisanCrossWalkFileReader::ParseNextLine(const vector_map_msgs::CrossWalk& _
 
 AisanCrossWalkFileReader::AisanCrossWalk* AisanCrossWalkFileReader::GetDataRowById(int _id)
 {
-	if(m_data_map.size()==0) return nullptr;
-
-	int index = _id-m_min_id;
-	if(index >= 0 && index < m_data_map.size())
-	{
-		return m_data_map.at(index);
-	}
-	else
-	{
-		for(unsigned int i=0; i < m_data_list.size(); i++)
-		{
-			if(m_data_list.at(i).ID == _id)
-			{
-				return &m_data_list.at(i);
-			}
-		}
-	}
-
-	return nullptr;
+	return m_data_map.find(_id);
 }
 
 bool AisanCrossWalkFileReader::ReadNextLine(AisanCrossWalk& data)
@@ -1949,29 +1509,17 @@ AisanWayareaFileReader::AisanWayareaFileReader(const vector_map_msgs::WayAreaArr
 {
 	if(_wayAreas.data.size()==0) return;
 
-	m_min_id = std::numeric_limits<int>::max();
-
 	m_data_list.clear();
 	AisanWayarea data;
-	int max_id = std::numeric_limits<int>::min();
 
 	for(unsigned int i=0; i < _wayAreas.data.size(); i++)
 	{
 		ParseNextLine(_wayAreas.data.at(i), data);
 
 		m_data_list.push_back(data);
-		if(data.ID < m_min_id)
-			m_min_id = data.ID;
-
-		if(data.ID > max_id)
-			max_id = data.ID;
 	}
 
-	m_data_map.resize(max_id-m_min_id+2);
-	for(unsigned int i=0; i < m_data_list.size(); i++)
-	{
-		m_data_map.at(m_data_list.at(i).ID-m_min_id) = &m_data_list.at(i);
-	}
+	m_data_map.build(m_data_list, &AisanWayareaFileReader::AisanWayarea::ID);
 }
 
 void AisanWayareaFileReader::ParseNextLine(const vector_map_msgs::WayArea& _rec, AisanWayarea& data)
@@ -1983,25 +1531,7 @@ void AisanWayareaFileReader::ParseNextLine(const vector_map_msgs::WayArea& _rec,
 
 AisanWayareaFileReader::AisanWayarea* AisanWayareaFileReader::GetDataRowById(int _id)
 {
-	if(m_data_map.size()==0) return nullptr;
-
-	int index = _id-m_min_id;
-	if(index >= 0 && index < m_data_map.size())
-	{
-		return m_data_map.at(index);
-	}
-	else
-	{
-		for(unsigned int i=0; i < m_data_list.size(); i++)
-		{
-			if(m_data_list.at(i).ID == _id)
-			{
-				return &m_data_list.at(i);
-			}
-		}
-	}
-
-	return nullptr;
+	return m_data_map.find(_id);
 }
 
 bool AisanWayareaFileReader::ReadNextLine(AisanWayarea& data)
@@ -2072,4 +1602,43 @@ int AisanDataConnFileReader::ReadAllData(vector<DataConn>& data_list)
 	return count;
 }
 
+//Compiled vector map
+
+template <class T, class U>
+void LoadBinaryMapTable(const vector_map::BinaryMap& bmap, vector_map::category_t category, T*& pReader)
+{
+	if(pReader != nullptr) return;
+
+	U msg;
+	bmap.get(category, msg);
+	pReader = new T(msg);
+}
+
+bool MapRaw::LoadFromBinaryMap(const std::string& fileName)
+{
+	vector_map::BinaryMap bmap;
+	if(!bmap.load(fileName))
+	{
+		printf("\n Can't Open Compiled Map File !, %s", fileName.c_str());
+		return false;
+	}
+
+	LoadBinaryMapTable<AisanLanesFileReader, vector_map_msgs::LaneArray>(bmap, vector_map::LANE, pLanes);
+	LoadBinaryMapTable<AisanPointsFileReader, vector_map_msgs::PointArray>(bmap, vector_map::POINT, pPoints);
+	LoadBinaryMapTable<AisanCenterLinesFileReader, vector_map_msgs::DTLaneArray>(bmap, vector_map::DTLANE, pCenterLines);
+	LoadBinaryMapTable<AisanIntersectionFileReader, vector_map_msgs::CrossRoadArray>(bmap, vector_map::CROSS_ROAD, pIntersections);
+	LoadBinaryMapTable<AisanAreasFileReader, vector_map_msgs::AreaArray>(bmap, vector_map::AREA, pAreas);
+	LoadBinaryMapTable<AisanLinesFileReader, vector_map_msgs::LineArray>(bmap, vector_map::LINE, pLines);
+	LoadBinaryMapTable<AisanStopLineFileReader, vector_map_msgs::StopLineArray>(bmap, vector_map::STOP_LINE, pStopLines);
+	LoadBinaryMapTable<AisanSignalFileReader, vector_map_msgs::SignalArray>(bmap, vector_map::SIGNAL, pSignals);
+	LoadBinaryMapTable<AisanVectorFileReader, vector_map_msgs::VectorArray>(bmap, vector_map::VECTOR, pVectors);
+	LoadBinaryMapTable<AisanCurbFileReader, vector_map_msgs::CurbArray>(bmap, vector_map::CURB, pCurbs);
+	LoadBinaryMapTable<AisanRoadEdgeFileReader, vector_map_msgs::RoadEdgeArray>(bmap, vector_map::ROAD_EDGE, pRoadedges);
+	LoadBinaryMapTable<AisanWayareaFileReader, vector_map_msgs::WayAreaArray>(bmap, vector_map::WAY_AREA, pWayAreas);
+	LoadBinaryMapTable<AisanCrossWalkFileReader, vector_map_msgs::CrossWalkArray>(bmap, vector_map::CROSS_WALK, pCrossWalks);
+	LoadBinaryMapTable<AisanNodesFileReader, vector_map_msgs::NodeArray>(bmap, vector_map::NODE, pNodes);
+
+	return true;
+}
+
 } /* namespace UtilityHNS */
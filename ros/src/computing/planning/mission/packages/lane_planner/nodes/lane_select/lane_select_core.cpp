@@ -163,7 +163,7 @@ void LaneSelectNode::processing()
     {
       changeLane();
       std::get<1>(lane_for_change_) =
-          getClosestWaypointNumber(std::get<0>(lane_for_change_), current_pose_.pose, current_velocity_.twist,
+          getClosestWaypointNumber(lane_for_change_index_, current_pose_.pose, current_velocity_.twist,
                                    std::get<1>(lane_for_change_), distance_threshold_);
       std::get<2>(lane_for_change_) = static_cast<ChangeFlag>(
           std::get<0>(lane_for_change_).waypoints.at(std::get<1>(lane_for_change_)).change_flag);
@@ -210,6 +210,7 @@ void LaneSelectNode::createLaneForChange()
   std::get<0>(lane_for_change_).waypoints.clear();
   std::get<0>(lane_for_change_).waypoints.shrink_to_fit();
   std::get<1>(lane_for_change_) = -1;
+  lane_for_change_index_.clear();
 
   const autoware_msgs::Lane &cur_lane = std::get<0>(tuple_vec_.at(current_lane_idx_));
   const int32_t &clst_wp = std::get<1>(tuple_vec_.at(current_lane_idx_));
@@ -282,6 +283,7 @@ void LaneSelectNode::createLaneForChange()
       break;
   }
   std::copy(itr, nghbr_lane.waypoints.end(), std::back_inserter(std::get<0>(lane_for_change_).waypoints));
+  lane_for_change_index_.setPath(std::get<0>(lane_for_change_));
 }
 
 void LaneSelectNode::updateChangeFlag()
@@ -320,9 +322,10 @@ void LaneSelectNode::changeLane()
 
 bool LaneSelectNode::getClosestWaypointNumberForEachLanes()
 {
-  for (auto &el : tuple_vec_)
+  for (uint32_t i = 0; i < tuple_vec_.size(); i++)
   {
-    std::get<1>(el) = getClosestWaypointNumber(std::get<0>(el), current_pose_.pose, current_velocity_.twist,
+    auto &el = tuple_vec_.at(i);
+    std::get<1>(el) = getClosestWaypointNumber(lane_indices_.at(i), current_pose_.pose, current_velocity_.twist,
                                                std::get<1>(el), distance_threshold_);
     ROS_INFO("closest: %d", std::get<1>(el));
   }
@@ -629,6 +632,12 @@ void LaneSelectNode::callbackFromLaneArray(const autoware_msgs::LaneArrayConstPt
     tuple_vec_.push_back(t);
   }
 
+  // the closest waypoints are searched at every pose, index the lanes once here
+  lane_indices_.clear();
+  lane_indices_.resize(msg->lanes.size());
+  for (uint32_t i = 0; i < msg->lanes.size(); i++)
+    lane_indices_.at(i).setPath(msg->lanes.at(i));
+
   current_lane_idx_ = -1;
   right_lane_idx_ = -1;
   left_lane_idx_ = -1;
@@ -763,66 +772,31 @@ double getRelativeAngle(const geometry_msgs::Pose &waypoint_pose, const geometry
 }
 
 // get closest waypoint from current pose
-int32_t getClosestWaypointNumber(const autoware_msgs::Lane &current_lane, const geometry_msgs::Pose &current_pose,
+int32_t getClosestWaypointNumber(const WaypointIndex &current_lane, const geometry_msgs::Pose &current_pose,
                                  const geometry_msgs::Twist &current_velocity, const int32_t previous_number,
                                  const double distance_threshold)
 {
-  if (current_lane.waypoints.empty())
+  if (current_lane.isEmpty())
     return -1;
 
-  std::vector<uint32_t> idx_vec;
   // if previous number is -1, search closest waypoint from waypoints in front of current pose
   if (previous_number == -1)
-  {
-    idx_vec.reserve(current_lane.waypoints.size());
-    for (uint32_t i = 0; i < current_lane.waypoints.size(); i++)
-    {
-      geometry_msgs::Point converted_p =
-          convertPointIntoRelativeCoordinate(current_lane.waypoints.at(i).pose.pose.position, current_pose);
-      double angle = getRelativeAngle(current_lane.waypoints.at(i).pose.pose, current_pose);
-      if (converted_p.x > 0 && angle < 90)
-        idx_vec.push_back(i);
-    }
-  }
-  else
-  {
-    if (distance_threshold <
-        getTwoDimensionalDistance(current_lane.waypoints.at(previous_number).pose.pose.position, current_pose.position))
-    {
-      ROS_WARN("Current_pose is far away from previous closest waypoint. Initilized...");
-      return -1;
-    }
+    return current_lane.findClosestWaypoint(current_pose, 0, current_lane.getSize(), -1, false);
 
-    double ratio = 3;
-    double minimum_dt = 2.0;
-    double dt = current_velocity.linear.x * ratio > minimum_dt ? current_velocity.linear.x * ratio : minimum_dt;
-
-    auto range_max = static_cast<uint32_t>(previous_number + dt) < current_lane.waypoints.size() ?
-                         static_cast<uint32_t>(previous_number + dt) :
-                         current_lane.waypoints.size();
-    for (uint32_t i = static_cast<uint32_t>(previous_number); i < range_max; i++)
-    {
-      geometry_msgs::Point converted_p =
-          convertPointIntoRelativeCoordinate(current_lane.waypoints.at(i).pose.pose.position, current_pose);
-      double angle = getRelativeAngle(current_lane.waypoints.at(i).pose.pose, current_pose);
-      if (converted_p.x > 0 && angle < 90)
-        idx_vec.push_back(i);
-    }
+  if (distance_threshold < current_lane.getPlaneDistance(previous_number, current_pose.position))
+  {
+    ROS_WARN("Current_pose is far away from previous closest waypoint. Initilized...");
+    return -1;
   }
 
-  if (idx_vec.empty())
-    return -1;
+  double ratio = 3;
+  double minimum_dt = 2.0;
+  double dt = current_velocity.linear.x * ratio > minimum_dt ? current_velocity.linear.x * ratio : minimum_dt;
 
-  std::vector<double> dist_vec;
-  dist_vec.reserve(idx_vec.size());
-  for (const auto &el : idx_vec)
-  {
-    double dt = getTwoDimensionalDistance(current_pose.position, current_lane.waypoints.at(el).pose.pose.position);
-    dist_vec.push_back(dt);
-  }
-  std::vector<double>::iterator itr = std::min_element(dist_vec.begin(), dist_vec.end());
-  int32_t found_number = idx_vec.at(static_cast<uint32_t>(std::distance(dist_vec.begin(), itr)));
-  return found_number;
+  auto range_max = static_cast<int32_t>(previous_number + dt) < current_lane.getSize() ?
+                       static_cast<int32_t>(previous_number + dt) :
+                       current_lane.getSize();
+  return current_lane.findClosestWaypoint(current_pose, previous_number, range_max, -1, false);
 }
 
 // let the linear equation be "ax + by + c = 0"
@@ -80,6 +80,8 @@ private:
   std::vector<std::tuple<autoware_msgs::Lane, int32_t, ChangeFlag>> tuple_vec_;  // lane, closest_waypoint,
                                                                                  // change_flag
   std::tuple<autoware_msgs::Lane, int32_t, ChangeFlag> lane_for_change_;
+  std::vector<WaypointIndex> lane_indices_;  // same order as tuple_vec_
+  WaypointIndex lane_for_change_index_;
   bool is_lane_array_subscribed_, is_current_pose_subscribed_, is_current_velocity_subscribed_,
       is_current_state_subscribed_, is_config_subscribed_;
 
@@ -131,7 +133,7 @@ private:
   int32_t getClosestLaneChangeWaypointNumber(const std::vector<autoware_msgs::Waypoint> &wps, int32_t cl_wp);
 };
 
-int32_t getClosestWaypointNumber(const autoware_msgs::Lane &current_lane, const geometry_msgs::Pose &current_pose,
+int32_t getClosestWaypointNumber(const WaypointIndex &current_lane, const geometry_msgs::Pose &current_pose,
                                  const geometry_msgs::Twist &current_velocity, const int32_t previous_number,
                                  const double distance_threshold);
 
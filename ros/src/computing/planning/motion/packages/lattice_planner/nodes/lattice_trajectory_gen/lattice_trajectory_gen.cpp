@@ -101,6 +101,9 @@ static double g_look_ahead_threshold_calc_ratio = 2.0;
 static double g_minimum_look_ahead_threshold = 6.0; // the next waypoint must be outside of this threshold.
 
 static WayPoints g_current_waypoints;
+static WaypointIndex g_waypoint_index;
+static bool g_waypoint_index_updated = false;
+static int g_closest_waypoint = -1;
 
 static void ConfigCallback(const autoware_config_msgs::ConfigWaypointFollowerConstPtr &config)
 {
@@ -127,6 +130,8 @@ static void currentVelCallback(const geometry_msgs::TwistStampedConstPtr &msg)
 static void WayPointCallback(const autoware_msgs::LaneConstPtr &msg)
 {
   g_current_waypoints.setPath(*msg);
+  g_waypoint_index.setPath(*msg);
+  g_waypoint_index_updated = true;
   g_waypoint_set = true;
   ROS_INFO_STREAM("waypoint subscribed");
 }
@@ -596,7 +601,10 @@ int main(int argc, char **argv)
     }
 
     // Get the closest waypoinmt
-    int closest_waypoint = getClosestWaypoint(g_current_waypoints.getCurrentWaypoints(), g_current_pose.pose);
+    g_closest_waypoint = g_waypoint_index.trackClosestWaypoint(g_current_pose.pose,
+                                                               g_waypoint_index_updated ? -1 : g_closest_waypoint);
+    g_waypoint_index_updated = false;
+    int closest_waypoint = g_closest_waypoint;
     ROS_INFO_STREAM("closest waypoint = " << closest_waypoint);
 
       // If the current  waypoint has a valid index
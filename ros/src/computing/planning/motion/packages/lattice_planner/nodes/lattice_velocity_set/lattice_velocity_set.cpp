@@ -98,6 +98,8 @@ public:
   }
 };
 PathVset g_path_change;
+WaypointIndex g_waypoint_index;
+bool g_waypoint_index_updated = false;
 
 //===============================
 //       class function
@@ -320,6 +322,8 @@ void baseWaypointCallback(const autoware_msgs::LaneConstPtr &msg)
 {
   g_path_dk.setPath(*msg);
   g_path_change.setPath(*msg);
+  g_waypoint_index.setPath(*msg);
+  g_waypoint_index_updated = true;
   if (g_path_flag == false)
   {
     g_path_flag = true;
@@ -843,7 +847,10 @@ int main(int argc, char **argv)
       continue;
     }
 
-    g_closest_waypoint = getClosestWaypoint(g_path_change.getCurrentWaypoints(), g_control_pose.pose);
+    // the waypoints only move when a new path arrives, track the closest one until then
+    g_closest_waypoint = g_waypoint_index.trackClosestWaypoint(g_control_pose.pose,
+                                                               g_waypoint_index_updated ? -1 : g_closest_waypoint);
+    g_waypoint_index_updated = false;
 
     std_msgs::Int32 closest_waypoint;
     closest_waypoint.data = g_closest_waypoint;
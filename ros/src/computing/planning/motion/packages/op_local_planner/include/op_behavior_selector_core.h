@@ -49,6 +49,7 @@
 #include "op_planner/PlannerCommonDef.h"
 #include "op_planner/DecisionMaker.h"
 #include "op_utility/DataRW.h"
+#include "op_pipeline_stage.h"
 
 
 namespace BehaviorGeneratorNS
@@ -101,6 +102,11 @@ protected: //Planning Related variables
 	geometry_msgs::TwistStamped m_Twist_cmd;
 	autoware_msgs::ControlCommand m_Ctrl_cmd;
 
+	timespec m_PlanningTimer;
+
+	LocalPlannerPipelineNS::PipelineStage* m_pStage;
+	LocalPlannerPipelineNS::StageHandoff<PlannerHNS::BehaviorState>* m_pBehaviorHandoff;
+
 	//ROS messages (topics)
 	ros::NodeHandle nh;
 
@@ -148,11 +154,19 @@ protected: //Planning Related variables
   void SendLocalPlanningTopics();
   void VisualizeLocalPlanner();
   void LogLocalPlanningInfo(double dt);
+  void SynchronizeRollOuts();
 
 public:
-  BehaviorGen();
+  BehaviorGen(LocalPlannerPipelineNS::PipelineStage* pStage = nullptr);
   ~BehaviorGen();
   void MainLoop();
+  void DoOneStep();
+
+	//Pipeline Section, callbacks run in the thread of pStage and the inputs and outputs between the local planning
+	//nodes are handed off instead of sent
+
+	void SetWeightedRollOuts(LocalPlannerPipelineNS::WeightedRollOuts& weightedRollOuts);
+	void SetBehaviorHandoff(LocalPlannerPipelineNS::StageHandoff<PlannerHNS::BehaviorState>* pHandoff);
 
 	//Mapping Section
 
@@ -0,0 +1,65 @@
+/*
+ * Copyright 2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef OP_LOCAL_PLANNER_PIPELINE_CORE
+#define OP_LOCAL_PLANNER_PIPELINE_CORE
+
+#include <ros/ros.h>
+
+#include "op_pipeline_stage.h"
+#include "op_motion_predictor_core.h"
+#include "op_trajectory_generator_core.h"
+#include "op_trajectory_evaluator_core.h"
+#include "op_behavior_selector_core.h"
+
+namespace LocalPlannerPipelineNS
+{
+
+// op_motion_predictor, op_trajectory_generator, op_trajectory_evaluator and op_behavior_selector in one process, each
+// one in its own stage thread. Roll outs, weighted roll outs, predicted objects and the current behavior are handed
+// off between the stages instead of sent as messages.
+class LocalPlannerPipeline
+{
+protected:
+	PipelineStage* m_pPredictorStage;
+	PipelineStage* m_pGeneratorStage;
+	PipelineStage* m_pEvaluatorStage;
+	PipelineStage* m_pSelectorStage;
+
+	MotionPredictorNS::MotionPrediction* m_pPredictor;
+	TrajectoryGeneratorNS::TrajectoryGen* m_pGenerator;
+	TrajectoryEvaluatorNS::TrajectoryEval* m_pEvaluator;
+	BehaviorGeneratorNS::BehaviorGen* m_pSelector;
+
+	StageHandoff<std::vector<PlannerHNS::DetectedObject> >* m_pPredictedObjectsHandoff;
+	StageHandoff<RollOuts>* m_pRollOutsHandoff;
+	StageHandoff<WeightedRollOuts>* m_pWeightedRollOutsHandoff;
+	StageHandoff<PlannerHNS::BehaviorState>* m_pBehaviorHandoff;
+
+	double m_ReportInterval;
+	timespec m_ReportTimer;
+
+	void ReportLatencies();
+
+public:
+	LocalPlannerPipeline();
+	virtual ~LocalPlannerPipeline();
+	void MainLoop();
+};
+
+}
+
+#endif  // OP_LOCAL_PLANNER_PIPELINE_CORE
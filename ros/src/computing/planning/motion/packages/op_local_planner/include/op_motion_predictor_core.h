@@ -45,6 +45,7 @@
 #include "op_planner/PlannerCommonDef.h"
 #include "op_planner/BehaviorPrediction.h"
 #include "op_utility/DataRW.h"
+#include "op_pipeline_stage.h"
 
 namespace MotionPredictorNS
 {
@@ -96,6 +97,9 @@ protected:
 
 	timespec m_SensingTimer;
 
+	LocalPlannerPipelineNS::PipelineStage* m_pStage;
+	LocalPlannerPipelineNS::StageHandoff<std::vector<PlannerHNS::DetectedObject> >* m_pPredictedObjectsHandoff;
+
 
 	ros::NodeHandle nh;
 	ros::Publisher pub_predicted_objects_trajectories;
@@ -125,9 +129,14 @@ protected:
 	void GenerateCurbsObstacles(std::vector<PlannerHNS::DetectedObject>& curb_obstacles);
 
 public:
-	MotionPrediction();
+	MotionPrediction(LocalPlannerPipelineNS::PipelineStage* pStage = nullptr);
 	virtual ~MotionPrediction();
 	void MainLoop();
+	void DoOneStep();
+
+	//Pipeline Section, callbacks run in the thread of pStage and the predicted objects are handed off instead of sent
+
+	void SetPredictedObjectsHandoff(LocalPlannerPipelineNS::StageHandoff<std::vector<PlannerHNS::DetectedObject> >* pHandoff);
 
 	//Mapping Section
 
@@ -0,0 +1,227 @@
+/*
+ * Copyright 2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef OP_PIPELINE_STAGE
+#define OP_PIPELINE_STAGE
+
+#include <ros/ros.h>
+#include <ros/callback_queue.h>
+#include <boost/function.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "op_planner/RoadNetwork.h"
+#include "op_utility/UtilityH.h"
+
+namespace LocalPlannerPipelineNS
+{
+
+typedef std::vector<std::vector<PlannerHNS::WayPoint> > RollOuts;
+
+// What op_trajectory_evaluator sends on local_weighted_trajectories and local_trajectory_cost
+struct WeightedRollOuts
+{
+	RollOuts rollOuts;
+	PlannerHNS::TrajectoryCost bestCost;
+	bool bBestCost;
+
+	WeightedRollOuts()
+	{
+		bBestCost = false;
+	}
+};
+
+// Histogram of latencies in milliseconds with power of two buckets from 0.25 ms to 1 s, the last bucket counts the
+// rest. It is lock free, the stage thread adds to it while the main thread reports it.
+class LatencyHistogram
+{
+public:
+	static const int BUCKETS_NUMBER = 14;
+
+	LatencyHistogram();
+	void Add(const double& ms);
+	unsigned long GetCount() const;
+	double GetMean() const;
+	double GetMax() const;
+	// upper bound of the bucket the percentile falls in
+	double GetPercentile(const double& percent) const;
+	std::string ToString() const;
+
+	static double GetBucketBound(const int& i);
+
+private:
+	std::atomic<unsigned long> m_Buckets[BUCKETS_NUMBER];
+	std::atomic<unsigned long> m_Count;
+	std::atomic<unsigned long> m_TotalMicroSec;
+	std::atomic<unsigned long> m_MaxMicroSec;
+};
+
+class StageInput
+{
+public:
+	virtual ~StageInput(){}
+	// Called from the consumer stage, takes the latest buffer if there is a new one
+	virtual bool Consume(timespec& tChainStart, timespec& tPublish) = 0;
+};
+
+class PipelineStage;
+
+// Callback queue of one stage, it wakes the stage up when a message arrives for it
+class StageCallbackQueue : public ros::CallbackQueue
+{
+public:
+	StageCallbackQueue(PipelineStage* pStage);
+	virtual void addCallback(const ros::CallbackInterfacePtr& callback, uint64_t owner_id = 0);
+
+private:
+	PipelineStage* m_pStage;
+};
+
+// One thread of the local planner pipeline. The node object of the stage subscribes through GetCallbackQueue(), the
+// thread sleeps until a message or a handoff arrives, runs the callbacks, takes the new inputs and calls the step of
+// the node once. Without events the step still runs every maxIdleTime. Steps start at least minStepTime apart, the
+// events that arrive in between are handled together, so the stage never runs faster than its standalone node.
+// The chain start is the time the source stage started the step which the current inputs come from, sink stages
+// measure the end to end latency from it.
+class PipelineStage
+{
+public:
+	LatencyHistogram m_StepTime; // callbacks, inputs and step
+	LatencyHistogram m_WaitTime; // from the handoff of an input to its consumption
+	LatencyHistogram m_EndToEnd;
+
+	PipelineStage(const std::string& name, const double& deadline, const double& minStepTime, const double& maxIdleTime, const bool& bSink);
+	virtual ~PipelineStage();
+
+	ros::CallbackQueue* GetCallbackQueue();
+	void AddInput(StageInput* pInput, const bool& bChain);
+	void Start(const boost::function<void()>& step);
+	void Stop();
+	void Notify();
+
+	// stage thread only
+	const timespec& GetChainStart() const;
+	// true once every maxIdleTime, for what the nodes poll every cycle when they run alone
+	bool IsPollingCycle();
+
+	const std::string& GetName() const;
+	unsigned long GetDeadlineMisses() const;
+	std::string GetReport() const;
+
+	// MappingHelpers keeps global counters while it constructs a map, the stages load their maps one at a time
+	static std::mutex& GetMapMutex();
+
+private:
+	std::string m_Name;
+	double m_Deadline;
+	double m_MinStepTime;
+	double m_MaxIdleTime;
+	bool m_bSink;
+	bool m_bChainInput;
+
+	StageCallbackQueue m_Queue;
+	std::vector<std::pair<StageInput*, bool> > m_Inputs;
+	boost::function<void()> m_Step;
+	std::thread m_Thread;
+	std::atomic<bool> m_bStop;
+	std::atomic<unsigned long> m_DeadlineMisses;
+
+	std::mutex m_WakeUpMutex;
+	std::condition_variable m_WakeUp;
+	bool m_bEvent;
+
+	timespec m_ChainStart;
+	timespec m_PollingTimer;
+	timespec m_StepTimer;
+
+	void ThreadMain();
+};
+
+// Lock free handoff of the latest buffer from a producer stage to a consumer stage (triple buffer). The producer fills
+// GetWriteBuffer() and publishes it, the consumer gets the latest published buffer at its next step, older ones are
+// dropped like messages of a topic with queue size one. The consumer is woken up by the handoff only if bWakeUp is
+// set, an input that goes back up the chain must not wake its consumer or the two stages would wake each other up
+// forever. The three buffers are reused, the consumer may swap the content out and the producer assigns into the
+// memory that comes back.
+template <class T>
+class StageHandoff : public StageInput
+{
+public:
+	StageHandoff(PipelineStage* pProducer, PipelineStage* pConsumer, const boost::function<void(T&)>& consume, const bool& bChain,
+			const bool& bWakeUp)
+	: m_pProducer(pProducer), m_pConsumer(pConsumer), m_Consume(consume), m_bWakeUp(bWakeUp), m_Middle(1), m_iWrite(0), m_iRead(2)
+	{
+		m_pConsumer->AddInput(this, bChain);
+	}
+
+	// producer stage only
+	T& GetWriteBuffer()
+	{
+		return m_Buffers[m_iWrite].data;
+	}
+
+	// producer stage only
+	void Publish()
+	{
+		Slot& slot = m_Buffers[m_iWrite];
+		slot.tChainStart = m_pProducer->GetChainStart();
+		UtilityHNS::UtilityH::GetTickCount(slot.tPublish);
+		m_iWrite = m_Middle.exchange(m_iWrite | NEW_BUFFER, std::memory_order_acq_rel) & INDEX_MASK;
+		if(m_bWakeUp)
+			m_pConsumer->Notify();
+	}
+
+	virtual bool Consume(timespec& tChainStart, timespec& tPublish)
+	{
+		if(!(m_Middle.load(std::memory_order_acquire) & NEW_BUFFER))
+			return false;
+
+		m_iRead = m_Middle.exchange(m_iRead, std::memory_order_acq_rel) & INDEX_MASK;
+		Slot& slot = m_Buffers[m_iRead];
+		tChainStart = slot.tChainStart;
+		tPublish = slot.tPublish;
+		m_Consume(slot.data);
+		return true;
+	}
+
+private:
+	enum {INDEX_MASK = 3, NEW_BUFFER = 4};
+
+	struct Slot
+	{
+		T data;
+		timespec tChainStart;
+		timespec tPublish;
+	};
+
+	PipelineStage* m_pProducer;
+	PipelineStage* m_pConsumer;
+	boost::function<void(T&)> m_Consume;
+	bool m_bWakeUp;
+	Slot m_Buffers[3];
+	std::atomic<int> m_Middle; // index of the buffer between producer and consumer, NEW_BUFFER if not consumed yet
+	int m_iWrite;
+	int m_iRead;
+};
+
+}
+
+#endif  // OP_PIPELINE_STAGE
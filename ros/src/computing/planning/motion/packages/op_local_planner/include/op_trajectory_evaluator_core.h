@@ -31,6 +31,7 @@
 
 #include "op_planner/PlannerCommonDef.h"
 #include "op_planner/TrajectoryDynamicCosts.h"
+#include "op_pipeline_stage.h"
 
 namespace TrajectoryEvaluatorNS
 {
@@ -76,6 +77,9 @@ protected:
   	visualization_msgs::MarkerArray m_CollisionsDummy;
 	visualization_msgs::MarkerArray m_CollisionsActual;
 
+	LocalPlannerPipelineNS::PipelineStage* m_pStage;
+	LocalPlannerPipelineNS::StageHandoff<LocalPlannerPipelineNS::WeightedRollOuts>* m_pWeightedRollOutsHandoff;
+
 	//ROS messages (topics)
 	ros::NodeHandle nh;
 
@@ -110,11 +114,21 @@ protected:
 
 	//Helper Functions
   void UpdatePlanningParams(ros::NodeHandle& _nh);
+  void SynchronizeRollOuts();
 
 public:
-  TrajectoryEval();
+  TrajectoryEval(LocalPlannerPipelineNS::PipelineStage* pStage = nullptr);
   ~TrajectoryEval();
   void MainLoop();
+  void DoOneStep();
+
+	//Pipeline Section, callbacks run in the thread of pStage and the inputs and outputs between the local planning
+	//nodes are handed off instead of sent
+
+	void SetRollOuts(LocalPlannerPipelineNS::RollOuts& rollOuts);
+	void SetPredictedObjects(std::vector<PlannerHNS::DetectedObject>& objects);
+	void SetBehaviorState(PlannerHNS::BehaviorState& behavior);
+	void SetWeightedRollOutsHandoff(LocalPlannerPipelineNS::StageHandoff<LocalPlannerPipelineNS::WeightedRollOuts>* pHandoff);
 };
 
 }
@@ -29,6 +29,7 @@
 
 #include "op_planner/PlannerH.h"
 #include "op_planner/PlannerCommonDef.h"
+#include "op_pipeline_stage.h"
 
 namespace TrajectoryGeneratorNS
 {
@@ -58,6 +59,9 @@ protected:
   	PlannerHNS::PlanningParams m_PlanningParams;
   	PlannerHNS::CAR_BASIC_INFO m_CarInfo;
 
+	LocalPlannerPipelineNS::PipelineStage* m_pStage;
+	LocalPlannerPipelineNS::StageHandoff<LocalPlannerPipelineNS::RollOuts>* m_pRollOutsHandoff;
+
 
   	//ROS messages (topics)
 	ros::NodeHandle nh;
@@ -87,9 +91,14 @@ protected:
   void UpdatePlanningParams(ros::NodeHandle& _nh);
 
 public:
-	TrajectoryGen();
+	TrajectoryGen(LocalPlannerPipelineNS::PipelineStage* pStage = nullptr);
   ~TrajectoryGen();
   void MainLoop();
+  void DoOneStep();
+
+	//Pipeline Section, callbacks run in the thread of pStage and the roll outs are handed off instead of sent
+
+	void SetRollOutsHandoff(LocalPlannerPipelineNS::StageHandoff<LocalPlannerPipelineNS::RollOuts>* pHandoff);
 };
 
 }
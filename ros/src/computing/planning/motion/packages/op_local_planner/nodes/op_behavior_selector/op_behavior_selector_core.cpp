@@ -21,8 +21,13 @@
 namespace BehaviorGeneratorNS
 {
 
-BehaviorGen::BehaviorGen()
+BehaviorGen::BehaviorGen(LocalPlannerPipelineNS::PipelineStage* pStage)
 {
+	m_pStage = pStage;
+	m_pBehaviorHandoff = nullptr;
+	if(m_pStage)
+		nh.setCallbackQueue(m_pStage->GetCallbackQueue());
+
 	bNewCurrentPos = false;
 	bVehicleStatus = false;
 	bWayGlobalPath = false;
@@ -62,10 +67,13 @@ BehaviorGen::BehaviorGen()
 		sub_can_info = nh.subscribe("/can_info", 10, &BehaviorGen::callbackGetCANInfo, this);
 
 	sub_GlobalPlannerPaths = nh.subscribe("/lane_waypoints_array", 1, &BehaviorGen::callbackGetGlobalPlannerPath, this);
-	sub_LocalPlannerPaths = nh.subscribe("/local_weighted_trajectories", 1, &BehaviorGen::callbackGetLocalPlannerPath, this);
+	if(!m_pStage)
+	{
+		sub_LocalPlannerPaths = nh.subscribe("/local_weighted_trajectories", 1, &BehaviorGen::callbackGetLocalPlannerPath, this);
+		sub_Trajectory_Cost = nh.subscribe("/local_trajectory_cost", 1, &BehaviorGen::callbackGetLocalTrajectoryCost, this);
+	}
 	sub_TrafficLightStatus = nh.subscribe("/light_color", 1, &BehaviorGen::callbackGetTrafficLightStatus, this);
 	sub_TrafficLightSignals	= nh.subscribe("/roi_signal", 1, &BehaviorGen::callbackGetTrafficLightSignals, this);
-	sub_Trajectory_Cost = nh.subscribe("/local_trajectory_cost", 1, &BehaviorGen::callbackGetLocalTrajectoryCost, this);
 
 	sub_twist_raw = nh.subscribe("/twist_raw", 1, &BehaviorGen::callbackGetTwistRaw, this);
 	sub_twist_cmd = nh.subscribe("/twist_cmd", 1, &BehaviorGen::callbackGetTwistCMD, this);
@@ -86,6 +94,8 @@ BehaviorGen::BehaviorGen()
 	sub_way_areas = nh.subscribe("/vector_map_info/way_area", 1, &BehaviorGen::callbackGetVMWayAreas,  this);
 	sub_cross_walk = nh.subscribe("/vector_map_info/cross_walk", 1, &BehaviorGen::callbackGetVMCrossWalks,  this);
 	sub_nodes = nh.subscribe("/vector_map_info/node", 1, &BehaviorGen::callbackGetVMNodes,  this);
+
+	UtilityHNS::UtilityH::GetTickCount(m_PlanningTimer);
 }
 
 BehaviorGen::~BehaviorGen()
@@ -308,40 +318,73 @@ void BehaviorGen::callbackGetLocalPlannerPath(const autoware_msgs::LaneArrayCons
 	if(msg->lanes.size() > 0)
 	{
 		m_RollOuts.clear();
-		int globalPathId_roll_outs = -1;
 
 		for(unsigned int i = 0 ; i < msg->lanes.size(); i++)
 		{
 			std::vector<PlannerHNS::WayPoint> path;
 			PlannerHNS::ROSHelpers::ConvertFromAutowareLaneToLocalLane(msg->lanes.at(i), path);
 			m_RollOuts.push_back(path);
-
-			if(path.size() > 0)
-				globalPathId_roll_outs = path.at(0).gid;
 		}
 
-		if(bWayGlobalPath && m_GlobalPaths.size() > 0)
+		SynchronizeRollOuts();
+	}
+}
+
+void BehaviorGen::SynchronizeRollOuts()
+{
+	int globalPathId_roll_outs = -1;
+	for(unsigned int i = 0 ; i < m_RollOuts.size(); i++)
+	{
+		if(m_RollOuts.at(i).size() > 0)
+			globalPathId_roll_outs = m_RollOuts.at(i).at(0).gid;
+	}
+
+	if(bWayGlobalPath && m_GlobalPaths.size() > 0)
+	{
+		if(m_GlobalPaths.at(0).size() > 0)
 		{
-			if(m_GlobalPaths.at(0).size() > 0)
-			{
-				int globalPathId = m_GlobalPaths.at(0).at(0).gid;
-				std::cout << "Before Synchronization At Behavior Selector: GlobalID: " <<  globalPathId << ", LocalID: " << globalPathId_roll_outs << std::endl;
+			int globalPathId = m_GlobalPaths.at(0).at(0).gid;
+			std::cout << "Before Synchronization At Behavior Selector: GlobalID: " <<  globalPathId << ", LocalID: " << globalPathId_roll_outs << std::endl;
 
-				if(globalPathId_roll_outs == globalPathId)
-				{
-					bWayGlobalPath = false;
-					m_GlobalPathsToUse = m_GlobalPaths;
-					m_BehaviorGenerator.SetNewGlobalPath(m_GlobalPathsToUse);
-					std::cout << "Synchronization At Behavior Selector: GlobalID: " <<  globalPathId << ", LocalID: " << globalPathId_roll_outs << std::endl;
-				}
+			if(globalPathId_roll_outs == globalPathId)
+			{
+				bWayGlobalPath = false;
+				m_GlobalPathsToUse = m_GlobalPaths;
+				m_BehaviorGenerator.SetNewGlobalPath(m_GlobalPathsToUse);
+				std::cout << "Synchronization At Behavior Selector: GlobalID: " <<  globalPathId << ", LocalID: " << globalPathId_roll_outs << std::endl;
 			}
 		}
+	}
 
-		m_BehaviorGenerator.m_RollOuts = m_RollOuts;
-		bRollOuts = true;
+	m_BehaviorGenerator.m_RollOuts = m_RollOuts;
+	bRollOuts = true;
+}
+
+void BehaviorGen::SetWeightedRollOuts(LocalPlannerPipelineNS::WeightedRollOuts& weightedRollOuts)
+{
+	if(weightedRollOuts.bBestCost)
+	{
+		//only what local_trajectory_cost carries
+		bBestCost = true;
+		m_TrajectoryBestCost.bBlocked = weightedRollOuts.bestCost.bBlocked;
+		m_TrajectoryBestCost.index = weightedRollOuts.bestCost.index;
+		m_TrajectoryBestCost.cost = weightedRollOuts.bestCost.cost;
+		m_TrajectoryBestCost.closest_obj_distance = weightedRollOuts.bestCost.closest_obj_distance;
+		m_TrajectoryBestCost.closest_obj_velocity = weightedRollOuts.bestCost.closest_obj_velocity;
+	}
+
+	if(weightedRollOuts.rollOuts.size() > 0)
+	{
+		m_RollOuts.swap(weightedRollOuts.rollOuts);
+		SynchronizeRollOuts();
 	}
 }
 
+void BehaviorGen::SetBehaviorHandoff(LocalPlannerPipelineNS::StageHandoff<PlannerHNS::BehaviorState>* pHandoff)
+{
+	m_pBehaviorHandoff = pHandoff;
+}
+
 void BehaviorGen::callbackGetTrafficLightStatus(const autoware_msgs::TrafficLight& msg)
 {
 	std::cout << "Received Traffic Light Status : " << msg.traffic_light << std::endl;
@@ -523,91 +566,106 @@ void BehaviorGen::LogLocalPlanningInfo(double dt)
 	}
 }
 
-void BehaviorGen::MainLoop()
+void BehaviorGen::DoOneStep()
 {
-	ros::Rate loop_rate(100);
-
+	double dt  = UtilityHNS::UtilityH::GetTimeDiffNow(m_PlanningTimer);
+	UtilityHNS::UtilityH::GetTickCount(m_PlanningTimer);
 
-	timespec planningTimer;
-	UtilityHNS::UtilityH::GetTickCount(planningTimer);
+	//op_motion_predictor may load its map at the same time in the pipeline
+	std::unique_lock<std::mutex> map_lock(LocalPlannerPipelineNS::PipelineStage::GetMapMutex(), std::defer_lock);
+	if(!bMap)
+		map_lock.lock();
 
-	while (ros::ok())
+	if(m_MapType == PlannerHNS::MAP_KML_FILE && !bMap)
 	{
-		ros::spinOnce();
+		bMap = true;
+		PlannerHNS::MappingHelpers::LoadKML(m_MapPath, m_Map);
+	}
+	else if (m_MapType == PlannerHNS::MAP_FOLDER && !bMap)
+	{
+		bMap = true;
+		PlannerHNS::MappingHelpers::ConstructRoadNetworkFromDataFiles(m_MapPath, m_Map, true);
 
-		double dt  = UtilityHNS::UtilityH::GetTimeDiffNow(planningTimer);
-		UtilityHNS::UtilityH::GetTickCount(planningTimer);
+	}
+	else if (m_MapType == PlannerHNS::MAP_AUTOWARE && !bMap)
+	{
+		std::vector<UtilityHNS::AisanDataConnFileReader::DataConn> conn_data;;
 
-		if(m_MapType == PlannerHNS::MAP_KML_FILE && !bMap)
+		if(m_MapRaw.GetVersion()==2)
 		{
-			bMap = true;
-			PlannerHNS::MappingHelpers::LoadKML(m_MapPath, m_Map);
-		}
-		else if (m_MapType == PlannerHNS::MAP_FOLDER && !bMap)
-		{
-			bMap = true;
-			PlannerHNS::MappingHelpers::ConstructRoadNetworkFromDataFiles(m_MapPath, m_Map, true);
-
+			PlannerHNS::MappingHelpers::ConstructRoadNetworkFromROSMessageV2(m_MapRaw.pLanes->m_data_list, m_MapRaw.pPoints->m_data_list,
+					m_MapRaw.pCenterLines->m_data_list, m_MapRaw.pIntersections->m_data_list,m_MapRaw.pAreas->m_data_list,
+					m_MapRaw.pLines->m_data_list, m_MapRaw.pStopLines->m_data_list,	m_MapRaw.pSignals->m_data_list,
+					m_MapRaw.pVectors->m_data_list, m_MapRaw.pCurbs->m_data_list, m_MapRaw.pRoadedges->m_data_list, m_MapRaw.pWayAreas->m_data_list,
+					m_MapRaw.pCrossWalks->m_data_list, m_MapRaw.pNodes->m_data_list, conn_data,
+					m_MapRaw.pLanes, m_MapRaw.pPoints, m_MapRaw.pNodes, m_MapRaw.pLines, PlannerHNS::GPSPoint(), m_Map, true, m_PlanningParams.enableLaneChange, false);
+
+			if(m_Map.roadSegments.size() > 0)
+			{
+				bMap = true;
+				std::cout << " ******* Map V2 Is Loaded successfully from the Behavior Selector !! " << std::endl;
+			}
 		}
-		else if (m_MapType == PlannerHNS::MAP_AUTOWARE && !bMap)
+		else if(m_MapRaw.GetVersion()==1)
 		{
-			std::vector<UtilityHNS::AisanDataConnFileReader::DataConn> conn_data;;
+			PlannerHNS::MappingHelpers::ConstructRoadNetworkFromROSMessage(m_MapRaw.pLanes->m_data_list, m_MapRaw.pPoints->m_data_list,
+					m_MapRaw.pCenterLines->m_data_list, m_MapRaw.pIntersections->m_data_list,m_MapRaw.pAreas->m_data_list,
+					m_MapRaw.pLines->m_data_list, m_MapRaw.pStopLines->m_data_list,	m_MapRaw.pSignals->m_data_list,
+					m_MapRaw.pVectors->m_data_list, m_MapRaw.pCurbs->m_data_list, m_MapRaw.pRoadedges->m_data_list, m_MapRaw.pWayAreas->m_data_list,
+					m_MapRaw.pCrossWalks->m_data_list, m_MapRaw.pNodes->m_data_list, conn_data,  PlannerHNS::GPSPoint(), m_Map, true, m_PlanningParams.enableLaneChange, false);
 
-			if(m_MapRaw.GetVersion()==2)
+			if(m_Map.roadSegments.size() > 0)
 			{
-				PlannerHNS::MappingHelpers::ConstructRoadNetworkFromROSMessageV2(m_MapRaw.pLanes->m_data_list, m_MapRaw.pPoints->m_data_list,
-						m_MapRaw.pCenterLines->m_data_list, m_MapRaw.pIntersections->m_data_list,m_MapRaw.pAreas->m_data_list,
-						m_MapRaw.pLines->m_data_list, m_MapRaw.pStopLines->m_data_list,	m_MapRaw.pSignals->m_data_list,
-						m_MapRaw.pVectors->m_data_list, m_MapRaw.pCurbs->m_data_list, m_MapRaw.pRoadedges->m_data_list, m_MapRaw.pWayAreas->m_data_list,
-						m_MapRaw.pCrossWalks->m_data_list, m_MapRaw.pNodes->m_data_list, conn_data,
-						m_MapRaw.pLanes, m_MapRaw.pPoints, m_MapRaw.pNodes, m_MapRaw.pLines, PlannerHNS::GPSPoint(), m_Map, true, m_PlanningParams.enableLaneChange, false);
-
-				if(m_Map.roadSegments.size() > 0)
-				{
-					bMap = true;
-					std::cout << " ******* Map V2 Is Loaded successfully from the Behavior Selector !! " << std::endl;
-				}
+				bMap = true;
+				std::cout << " ******* Map V1 Is Loaded successfully from the Behavior Selector !! " << std::endl;
 			}
-			else if(m_MapRaw.GetVersion()==1)
-			{
-				PlannerHNS::MappingHelpers::ConstructRoadNetworkFromROSMessage(m_MapRaw.pLanes->m_data_list, m_MapRaw.pPoints->m_data_list,
-						m_MapRaw.pCenterLines->m_data_list, m_MapRaw.pIntersections->m_data_list,m_MapRaw.pAreas->m_data_list,
-						m_MapRaw.pLines->m_data_list, m_MapRaw.pStopLines->m_data_list,	m_MapRaw.pSignals->m_data_list,
-						m_MapRaw.pVectors->m_data_list, m_MapRaw.pCurbs->m_data_list, m_MapRaw.pRoadedges->m_data_list, m_MapRaw.pWayAreas->m_data_list,
-						m_MapRaw.pCrossWalks->m_data_list, m_MapRaw.pNodes->m_data_list, conn_data,  PlannerHNS::GPSPoint(), m_Map, true, m_PlanningParams.enableLaneChange, false);
+		}
+	}
 
-				if(m_Map.roadSegments.size() > 0)
-				{
-					bMap = true;
-					std::cout << " ******* Map V1 Is Loaded successfully from the Behavior Selector !! " << std::endl;
-				}
-			}
+	if(map_lock.owns_lock())
+		map_lock.unlock();
+
+	if(bNewCurrentPos && m_GlobalPaths.size()>0)
+	{
+		if(bNewLightSignal)
+		{
+			m_PrevTrafficLight = m_CurrTrafficLight;
+			bNewLightSignal = false;
 		}
 
-		if(bNewCurrentPos && m_GlobalPaths.size()>0)
+		if(bNewLightStatus)
 		{
-			if(bNewLightSignal)
-			{
-				m_PrevTrafficLight = m_CurrTrafficLight;
-				bNewLightSignal = false;
-			}
+			bNewLightStatus = false;
+			for(unsigned int itls = 0 ; itls < m_PrevTrafficLight.size() ; itls++)
+				m_PrevTrafficLight.at(itls).lightState = m_CurrLightStatus;
+		}
 
-			if(bNewLightStatus)
-			{
-				bNewLightStatus = false;
-				for(unsigned int itls = 0 ; itls < m_PrevTrafficLight.size() ; itls++)
-					m_PrevTrafficLight.at(itls).lightState = m_CurrLightStatus;
-			}
+		m_CurrentBehavior = m_BehaviorGenerator.DoOneStep(dt, m_CurrentPos, m_VehicleStatus, 1, m_CurrTrafficLight, m_TrajectoryBestCost, 0 );
 
-			m_CurrentBehavior = m_BehaviorGenerator.DoOneStep(dt, m_CurrentPos, m_VehicleStatus, 1, m_CurrTrafficLight, m_TrajectoryBestCost, 0 );
+		SendLocalPlanningTopics();
+		VisualizeLocalPlanner();
+		LogLocalPlanningInfo(dt);
 
-			SendLocalPlanningTopics();
-			VisualizeLocalPlanner();
-			LogLocalPlanningInfo(dt);
+		if(m_pBehaviorHandoff)
+		{
+			m_pBehaviorHandoff->GetWriteBuffer() = m_CurrentBehavior;
+			m_pBehaviorHandoff->Publish();
 		}
-		else
-			sub_GlobalPlannerPaths = nh.subscribe("/lane_waypoints_array", 	1,		&BehaviorGen::callbackGetGlobalPlannerPath, 	this);
+	}
+	else if(!m_pStage || m_pStage->IsPollingCycle())
+		sub_GlobalPlannerPaths = nh.subscribe("/lane_waypoints_array", 	1,		&BehaviorGen::callbackGetGlobalPlannerPath, 	this);
+}
 
+void BehaviorGen::MainLoop()
+{
+	ros::Rate loop_rate(100);
+
+	UtilityHNS::UtilityH::GetTickCount(m_PlanningTimer);
+
+	while (ros::ok())
+	{
+		ros::spinOnce();
+		DoOneStep();
 		loop_rate.sleep();
 	}
 }
@@ -0,0 +1,129 @@
+/*
+ * Copyright 2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "op_local_planner_pipeline_core.h"
+#include <boost/bind.hpp>
+
+namespace LocalPlannerPipelineNS
+{
+
+LocalPlannerPipeline::LocalPlannerPipeline()
+{
+	ros::NodeHandle _nh;
+	double predictorDeadline = 0.04, generatorDeadline = 0.1, evaluatorDeadline = 0.1, selectorDeadline = 0.1;
+	//the loop periods of the standalone nodes
+	double predictorMinStepTime = 0.04, generatorMinStepTime = 0.01, evaluatorMinStepTime = 0.01, selectorMinStepTime = 0.01;
+	double maxIdleTime = 0.1;
+	m_ReportInterval = 10.0;
+
+	_nh.getParam("/op_local_planner_pipeline/predictorDeadline", predictorDeadline);
+	_nh.getParam("/op_local_planner_pipeline/generatorDeadline", generatorDeadline);
+	_nh.getParam("/op_local_planner_pipeline/evaluatorDeadline", evaluatorDeadline);
+	_nh.getParam("/op_local_planner_pipeline/selectorDeadline", selectorDeadline);
+	_nh.getParam("/op_local_planner_pipeline/predictorMinStepTime", predictorMinStepTime);
+	_nh.getParam("/op_local_planner_pipeline/generatorMinStepTime", generatorMinStepTime);
+	_nh.getParam("/op_local_planner_pipeline/evaluatorMinStepTime", evaluatorMinStepTime);
+	_nh.getParam("/op_local_planner_pipeline/selectorMinStepTime", selectorMinStepTime);
+	_nh.getParam("/op_local_planner_pipeline/maxIdleTime", maxIdleTime);
+	_nh.getParam("/op_local_planner_pipeline/reportInterval", m_ReportInterval);
+
+	m_pPredictorStage = new PipelineStage("op_motion_predictor", predictorDeadline, predictorMinStepTime, maxIdleTime, false);
+	m_pGeneratorStage = new PipelineStage("op_trajectory_generator", generatorDeadline, generatorMinStepTime, maxIdleTime, false);
+	m_pEvaluatorStage = new PipelineStage("op_trajectory_evaluator", evaluatorDeadline, evaluatorMinStepTime, maxIdleTime, false);
+	m_pSelectorStage = new PipelineStage("op_behavior_selector", selectorDeadline, selectorMinStepTime, maxIdleTime, true);
+
+	m_pPredictor = new MotionPredictorNS::MotionPrediction(m_pPredictorStage);
+	m_pGenerator = new TrajectoryGeneratorNS::TrajectoryGen(m_pGeneratorStage);
+	m_pEvaluator = new TrajectoryEvaluatorNS::TrajectoryEval(m_pEvaluatorStage);
+	m_pSelector = new BehaviorGeneratorNS::BehaviorGen(m_pSelectorStage);
+
+	// generator -> evaluator -> selector is the chain the end to end latency is measured on
+	m_pRollOutsHandoff = new StageHandoff<RollOuts>(m_pGeneratorStage, m_pEvaluatorStage,
+			boost::bind(&TrajectoryEvaluatorNS::TrajectoryEval::SetRollOuts, m_pEvaluator, _1), true, true);
+	m_pPredictedObjectsHandoff = new StageHandoff<std::vector<PlannerHNS::DetectedObject> >(m_pPredictorStage, m_pEvaluatorStage,
+			boost::bind(&TrajectoryEvaluatorNS::TrajectoryEval::SetPredictedObjects, m_pEvaluator, _1), false, true);
+	m_pWeightedRollOutsHandoff = new StageHandoff<WeightedRollOuts>(m_pEvaluatorStage, m_pSelectorStage,
+			boost::bind(&BehaviorGeneratorNS::BehaviorGen::SetWeightedRollOuts, m_pSelector, _1), true, true);
+	//the behavior goes back to the evaluator, it is taken at the next step of the evaluator without waking it up
+	m_pBehaviorHandoff = new StageHandoff<PlannerHNS::BehaviorState>(m_pSelectorStage, m_pEvaluatorStage,
+			boost::bind(&TrajectoryEvaluatorNS::TrajectoryEval::SetBehaviorState, m_pEvaluator, _1), false, false);
+
+	m_pGenerator->SetRollOutsHandoff(m_pRollOutsHandoff);
+	m_pPredictor->SetPredictedObjectsHandoff(m_pPredictedObjectsHandoff);
+	m_pEvaluator->SetWeightedRollOutsHandoff(m_pWeightedRollOutsHandoff);
+	m_pSelector->SetBehaviorHandoff(m_pBehaviorHandoff);
+
+	UtilityHNS::UtilityH::GetTickCount(m_ReportTimer);
+}
+
+LocalPlannerPipeline::~LocalPlannerPipeline()
+{
+	m_pPredictorStage->Stop();
+	m_pGeneratorStage->Stop();
+	m_pEvaluatorStage->Stop();
+	m_pSelectorStage->Stop();
+
+	delete m_pPredictor;
+	delete m_pGenerator;
+	delete m_pEvaluator;
+	delete m_pSelector;
+
+	delete m_pRollOutsHandoff;
+	delete m_pPredictedObjectsHandoff;
+	delete m_pWeightedRollOutsHandoff;
+	delete m_pBehaviorHandoff;
+
+	delete m_pPredictorStage;
+	delete m_pGeneratorStage;
+	delete m_pEvaluatorStage;
+	delete m_pSelectorStage;
+}
+
+void LocalPlannerPipeline::ReportLatencies()
+{
+	ROS_INFO("Local planner pipeline latencies:\n%s\n%s\n%s\n%s", m_pPredictorStage->GetReport().c_str(),
+			m_pGeneratorStage->GetReport().c_str(), m_pEvaluatorStage->GetReport().c_str(), m_pSelectorStage->GetReport().c_str());
+}
+
+void LocalPlannerPipeline::MainLoop()
+{
+	m_pPredictorStage->Start(boost::bind(&MotionPredictorNS::MotionPrediction::DoOneStep, m_pPredictor));
+	m_pGeneratorStage->Start(boost::bind(&TrajectoryGeneratorNS::TrajectoryGen::DoOneStep, m_pGenerator));
+	m_pEvaluatorStage->Start(boost::bind(&TrajectoryEvaluatorNS::TrajectoryEval::DoOneStep, m_pEvaluator));
+	m_pSelectorStage->Start(boost::bind(&BehaviorGeneratorNS::BehaviorGen::DoOneStep, m_pSelector));
+
+	ros::Rate loop_rate(10);
+	while (ros::ok())
+	{
+		ros::spinOnce();
+
+		if(m_ReportInterval > 0 && UtilityHNS::UtilityH::GetTimeDiffNow(m_ReportTimer) > m_ReportInterval)
+		{
+			UtilityHNS::UtilityH::GetTickCount(m_ReportTimer);
+			ReportLatencies();
+		}
+
+		loop_rate.sleep();
+	}
+
+	m_pPredictorStage->Stop();
+	m_pGeneratorStage->Stop();
+	m_pEvaluatorStage->Stop();
+	m_pSelectorStage->Stop();
+	ReportLatencies();
+}
+
+}
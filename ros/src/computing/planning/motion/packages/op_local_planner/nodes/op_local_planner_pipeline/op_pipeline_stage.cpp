@@ -0,0 +1,269 @@
+/*
+ * Copyright 2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "op_pipeline_stage.h"
+#include <chrono>
+#include <sstream>
+
+namespace LocalPlannerPipelineNS
+{
+
+LatencyHistogram::LatencyHistogram()
+{
+	for(int i = 0; i < BUCKETS_NUMBER; i++)
+		m_Buckets[i] = 0;
+	m_Count = 0;
+	m_TotalMicroSec = 0;
+	m_MaxMicroSec = 0;
+}
+
+double LatencyHistogram::GetBucketBound(const int& i)
+{
+	return 0.25 * (1 << i);
+}
+
+void LatencyHistogram::Add(const double& ms)
+{
+	int i = 0;
+	while(i < BUCKETS_NUMBER-1 && ms >= GetBucketBound(i))
+		i++;
+
+	unsigned long micro_sec = ms > 0 ? ms*1000.0 : 0;
+	m_Buckets[i].fetch_add(1, std::memory_order_relaxed);
+	m_Count.fetch_add(1, std::memory_order_relaxed);
+	m_TotalMicroSec.fetch_add(micro_sec, std::memory_order_relaxed);
+
+	unsigned long max_micro_sec = m_MaxMicroSec.load(std::memory_order_relaxed);
+	while(micro_sec > max_micro_sec && !m_MaxMicroSec.compare_exchange_weak(max_micro_sec, micro_sec, std::memory_order_relaxed));
+}
+
+unsigned long LatencyHistogram::GetCount() const
+{
+	return m_Count.load(std::memory_order_relaxed);
+}
+
+double LatencyHistogram::GetMean() const
+{
+	unsigned long count = GetCount();
+	if(count == 0)
+		return 0;
+	return m_TotalMicroSec.load(std::memory_order_relaxed) / 1000.0 / count;
+}
+
+double LatencyHistogram::GetMax() const
+{
+	return m_MaxMicroSec.load(std::memory_order_relaxed) / 1000.0;
+}
+
+double LatencyHistogram::GetPercentile(const double& percent) const
+{
+	unsigned long count = GetCount();
+	if(count == 0)
+		return 0;
+
+	unsigned long sum = 0;
+	for(int i = 0; i < BUCKETS_NUMBER-1; i++)
+	{
+		sum += m_Buckets[i].load(std::memory_order_relaxed);
+		if(sum >= percent / 100.0 * count)
+			return GetBucketBound(i);
+	}
+	return GetMax();
+}
+
+std::string LatencyHistogram::ToString() const
+{
+	std::ostringstream str_out;
+	//4 digits, so the bounds up to 1024 ms are printed whole
+	str_out.precision(4);
+	str_out << "n: " << GetCount() << ", mean: " << GetMean() << " ms, p50 < " << GetPercentile(50) << " ms, p99 < " << GetPercentile(99) << " ms, max: " << GetMax() << " ms [";
+	for(int i = 0; i < BUCKETS_NUMBER; i++)
+	{
+		unsigned long n = m_Buckets[i].load(std::memory_order_relaxed);
+		if(n == 0)
+			continue;
+		if(i < BUCKETS_NUMBER-1)
+			str_out << " <" << GetBucketBound(i) << ":" << n;
+		else
+			str_out << " >=" << GetBucketBound(i-1) << ":" << n;
+	}
+	str_out << " ]";
+	return str_out.str();
+}
+
+StageCallbackQueue::StageCallbackQueue(PipelineStage* pStage) : m_pStage(pStage)
+{
+}
+
+void StageCallbackQueue::addCallback(const ros::CallbackInterfacePtr& callback, uint64_t owner_id)
+{
+	ros::CallbackQueue::addCallback(callback, owner_id);
+	m_pStage->Notify();
+}
+
+PipelineStage::PipelineStage(const std::string& name, const double& deadline, const double& minStepTime, const double& maxIdleTime, const bool& bSink)
+: m_Name(name), m_Deadline(deadline), m_MinStepTime(minStepTime), m_MaxIdleTime(maxIdleTime), m_bSink(bSink), m_bChainInput(false),
+  m_Queue(this), m_bStop(false), m_DeadlineMisses(0), m_bEvent(false)
+{
+	UtilityHNS::UtilityH::GetTickCount(m_ChainStart);
+	UtilityHNS::UtilityH::GetTickCount(m_PollingTimer);
+	UtilityHNS::UtilityH::GetTickCount(m_StepTimer);
+}
+
+PipelineStage::~PipelineStage()
+{
+	Stop();
+}
+
+ros::CallbackQueue* PipelineStage::GetCallbackQueue()
+{
+	return &m_Queue;
+}
+
+void PipelineStage::AddInput(StageInput* pInput, const bool& bChain)
+{
+	m_Inputs.push_back(std::make_pair(pInput, bChain));
+	if(bChain)
+		m_bChainInput = true;
+}
+
+void PipelineStage::Start(const boost::function<void()>& step)
+{
+	m_Step = step;
+	m_bStop = false;
+	m_Thread = std::thread(&PipelineStage::ThreadMain, this);
+}
+
+void PipelineStage::Stop()
+{
+	m_bStop = true;
+	Notify();
+	if(m_Thread.joinable())
+		m_Thread.join();
+}
+
+void PipelineStage::Notify()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_WakeUpMutex);
+		m_bEvent = true;
+	}
+	m_WakeUp.notify_one();
+}
+
+const timespec& PipelineStage::GetChainStart() const
+{
+	return m_ChainStart;
+}
+
+bool PipelineStage::IsPollingCycle()
+{
+	if(UtilityHNS::UtilityH::GetTimeDiffNow(m_PollingTimer) < m_MaxIdleTime)
+		return false;
+
+	UtilityHNS::UtilityH::GetTickCount(m_PollingTimer);
+	return true;
+}
+
+const std::string& PipelineStage::GetName() const
+{
+	return m_Name;
+}
+
+unsigned long PipelineStage::GetDeadlineMisses() const
+{
+	return m_DeadlineMisses.load(std::memory_order_relaxed);
+}
+
+std::string PipelineStage::GetReport() const
+{
+	std::ostringstream str_out;
+	str_out << m_Name << ": deadline misses: " << GetDeadlineMisses() << " of " << m_StepTime.GetCount() << std::endl;
+	str_out << "  step     " << m_StepTime.ToString() << std::endl;
+	str_out << "  wait     " << m_WaitTime.ToString();
+	if(m_bSink)
+		str_out << std::endl << "  end2end  " << m_EndToEnd.ToString();
+	return str_out.str();
+}
+
+std::mutex& PipelineStage::GetMapMutex()
+{
+	static std::mutex map_mutex;
+	return map_mutex;
+}
+
+void PipelineStage::ThreadMain()
+{
+	while(!m_bStop && ros::ok())
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_WakeUpMutex);
+			if(!m_bEvent)
+				m_WakeUp.wait_for(lock, std::chrono::duration<double>(m_MaxIdleTime));
+		}
+
+		//the events of the rest of minStepTime are handled by this step too
+		double time_to_step = m_MinStepTime - UtilityHNS::UtilityH::GetTimeDiffNow(m_StepTimer);
+		if(time_to_step > 0 && !m_bStop)
+			std::this_thread::sleep_for(std::chrono::duration<double>(time_to_step));
+
+		{
+			std::lock_guard<std::mutex> lock(m_WakeUpMutex);
+			m_bEvent = false;
+		}
+
+		if(m_bStop)
+			break;
+
+		timespec tStart;
+		UtilityHNS::UtilityH::GetTickCount(tStart);
+		m_StepTimer = tStart;
+		if(!m_bChainInput)
+			m_ChainStart = tStart;
+
+		m_Queue.callAvailable();
+
+		bool bNewChain = false;
+		timespec tChainStart, tPublish;
+		for(unsigned int i = 0; i < m_Inputs.size(); i++)
+		{
+			if(m_Inputs.at(i).first->Consume(tChainStart, tPublish))
+			{
+				m_WaitTime.Add(UtilityHNS::UtilityH::GetTimeDiffNow(tPublish)*1000.0);
+				if(m_Inputs.at(i).second)
+				{
+					m_ChainStart = tChainStart;
+					bNewChain = true;
+				}
+			}
+		}
+
+		m_Step();
+
+		double step_time = UtilityHNS::UtilityH::GetTimeDiffNow(tStart);
+		m_StepTime.Add(step_time*1000.0);
+		if(step_time > m_Deadline)
+		{
+			m_DeadlineMisses.fetch_add(1, std::memory_order_relaxed);
+			ROS_WARN_THROTTLE(1, "%s stage missed its deadline, step took %.2f ms, deadline %.2f ms", m_Name.c_str(), step_time*1000.0, m_Deadline*1000.0);
+		}
+
+		if(m_bSink && bNewChain)
+			m_EndToEnd.Add(UtilityHNS::UtilityH::GetTimeDiffNow(m_ChainStart)*1000.0);
+	}
+}
+
+}
@@ -21,8 +21,13 @@
 namespace MotionPredictorNS
 {
 
-MotionPrediction::MotionPrediction()
+MotionPrediction::MotionPrediction(LocalPlannerPipelineNS::PipelineStage* pStage)
 {
+	m_pStage = pStage;
+	m_pPredictedObjectsHandoff = nullptr;
+	if(m_pStage)
+		nh.setCallbackQueue(m_pStage->GetCallbackQueue());
+
 	bMap = false;
 	bNewCurrentPos = false;
 	bVehicleStatus = false;
@@ -231,6 +236,22 @@ void MotionPrediction::callbackGetTrackedObjects(const autoware_msgs::DetectedOb
 			m_PredictBeh.DoOneStep(m_TrackedObjects, m_CurrentPos, m_PlanningParams.minSpeed, m_CarInfo.max_deceleration,  m_Map);
 		}
 
+		if(m_pPredictedObjectsHandoff)
+		{
+			//the objects op_trajectory_evaluator keeps from predicted_objects, curbs have no id
+			std::vector<PlannerHNS::DetectedObject>& pred_objects = m_pPredictedObjectsHandoff->GetWriteBuffer();
+			pred_objects.clear();
+			for(unsigned int i = 0 ; i <m_PredictBeh.m_ParticleInfo_II.size(); i++)
+			{
+				if(m_PredictBeh.m_ParticleInfo_II.at(i)->obj.id > 0)
+					pred_objects.push_back(m_PredictBeh.m_ParticleInfo_II.at(i)->obj);
+			}
+			m_pPredictedObjectsHandoff->Publish();
+
+			//In the pipeline the predicted objects are converted to messages only for other subscribers
+			if(pub_predicted_objects_trajectories.getNumSubscribers() == 0)
+				return;
+		}
 
 		m_PredictedResultsResults.objects.clear();
 		autoware_msgs::DetectedObject pred_obj;
@@ -320,55 +341,27 @@ void MotionPrediction::VisualizePrediction()
 
 		for(unsigned int t=0; t < m_PredictBeh.m_ParticleInfo_II.at(i)->m_TrajectoryTracker.size(); t++)
 		{
+			PlannerHNS::TrajectoryTracker* pTrack = m_PredictBeh.m_ParticleInfo_II.at(i)->m_TrajectoryTracker.at(t);
 			PlannerHNS::WayPoint p_wp;
-			for(unsigned int j=0; j < m_PredictBeh.m_ParticleInfo_II.at(i)->m_TrajectoryTracker.at(t)->m_StopPart.size(); j++)
-			{
-				p_wp = m_PredictBeh.m_ParticleInfo_II.at(i)->m_TrajectoryTracker.at(t)->m_StopPart.at(j).pose;
-				p_wp.bDir = PlannerHNS::STANDSTILL_DIR;
-				m_particles_points.push_back(p_wp);
-				number_of_particles++;
-			}
-
-			for(unsigned int j=0; j < m_PredictBeh.m_ParticleInfo_II.at(i)->m_TrajectoryTracker.at(t)->m_YieldPart.size(); j++)
-			{
-				p_wp = m_PredictBeh.m_ParticleInfo_II.at(i)->m_TrajectoryTracker.at(t)->m_YieldPart.at(j).pose;
-				p_wp.bDir = PlannerHNS::BACKWARD_DIR;
-				m_particles_points.push_back(p_wp);
-				number_of_particles++;
-			}
-
-			if(m_PredictBeh.m_ParticleInfo_II.at(i)->m_TrajectoryTracker.at(t)->beh == PlannerHNS::BEH_FORWARD_STATE)
+			for(unsigned int j=0; j < pTrack->m_Particles.size(); j++)
 			{
-				for(unsigned int j=0; j < m_PredictBeh.m_ParticleInfo_II.at(i)->m_TrajectoryTracker.at(t)->m_ForwardPart.size(); j++)
-				{
-					p_wp = m_PredictBeh.m_ParticleInfo_II.at(i)->m_TrajectoryTracker.at(t)->m_ForwardPart.at(j).pose;
+				PlannerHNS::BEH_STATE_TYPE beh = pTrack->m_Particles.beh.at(j);
+				p_wp = pTrack->m_Particles.GetPose(j);
+				if(beh == PlannerHNS::BEH_STOPPING_STATE)
+					p_wp.bDir = PlannerHNS::STANDSTILL_DIR;
+				else if(beh == PlannerHNS::BEH_YIELDING_STATE)
+					p_wp.bDir = PlannerHNS::BACKWARD_DIR;
+				else if(beh == PlannerHNS::BEH_FORWARD_STATE && pTrack->beh == PlannerHNS::BEH_FORWARD_STATE)
 					p_wp.bDir = PlannerHNS::FORWARD_DIR;
-					m_particles_points.push_back(p_wp);
-					number_of_particles++;
-				}
-			}
-
-			if(m_PredictBeh.m_ParticleInfo_II.at(i)->m_TrajectoryTracker.at(t)->beh == PlannerHNS::BEH_BRANCH_LEFT_STATE)
-			{
-				//std::cout << "Left Particles : " << m_PredictBeh.m_ParticleInfo_II.at(i)->m_TrajectoryTracker.at(t)->m_LeftPart.size() << std::endl;
-				for(unsigned int j=0; j < m_PredictBeh.m_ParticleInfo_II.at(i)->m_TrajectoryTracker.at(t)->m_LeftPart.size(); j++)
-				{
-					p_wp = m_PredictBeh.m_ParticleInfo_II.at(i)->m_TrajectoryTracker.at(t)->m_LeftPart.at(j).pose;
+				else if(beh == PlannerHNS::BEH_BRANCH_LEFT_STATE && pTrack->beh == PlannerHNS::BEH_BRANCH_LEFT_STATE)
 					p_wp.bDir = PlannerHNS::FORWARD_LEFT_DIR;
-					m_particles_points.push_back(p_wp);
-					number_of_particles++;
-				}
-			}
-
-			if(m_PredictBeh.m_ParticleInfo_II.at(i)->m_TrajectoryTracker.at(t)->beh == PlannerHNS::BEH_BRANCH_RIGHT_STATE)
-			{
-				for(unsigned int j=0; j < m_PredictBeh.m_ParticleInfo_II.at(i)->m_TrajectoryTracker.at(t)->m_RightPart.size(); j++)
-				{
-					p_wp = m_PredictBeh.m_ParticleInfo_II.at(i)->m_TrajectoryTracker.at(t)->m_RightPart.at(j).pose;
+				else if(beh == PlannerHNS::BEH_BRANCH_RIGHT_STATE && pTrack->beh == PlannerHNS::BEH_BRANCH_RIGHT_STATE)
 					p_wp.bDir = PlannerHNS::FORWARD_RIGHT_DIR;
-					m_particles_points.push_back(p_wp);
-					number_of_particles++;
-				}
+				else
+					continue;
+
+				m_particles_points.push_back(p_wp);
+				number_of_particles++;
 			}
 		}
 
@@ -394,74 +387,95 @@ void MotionPrediction::VisualizePrediction()
 	UtilityHNS::UtilityH::GetTickCount(m_VisualizationTimer);
 }
 
-void MotionPrediction::MainLoop()
+void MotionPrediction::SetPredictedObjectsHandoff(LocalPlannerPipelineNS::StageHandoff<std::vector<PlannerHNS::DetectedObject> >* pHandoff)
 {
+	m_pPredictedObjectsHandoff = pHandoff;
+}
 
-	ros::Rate loop_rate(25);
+void MotionPrediction::DoOneStep()
+{
+	//op_behavior_selector may load its map at the same time in the pipeline
+	std::unique_lock<std::mutex> map_lock(LocalPlannerPipelineNS::PipelineStage::GetMapMutex(), std::defer_lock);
+	if(!bMap)
+		map_lock.lock();
 
-	while (ros::ok())
+	if(m_MapType == PlannerHNS::MAP_KML_FILE && !bMap)
 	{
-		ros::spinOnce();
+		bMap = true;
+		PlannerHNS::MappingHelpers::LoadKML(m_MapPath, m_Map);
+	}
+	else if (m_MapType == PlannerHNS::MAP_FOLDER && !bMap)
+	{
+		bMap = true;
+		PlannerHNS::MappingHelpers::ConstructRoadNetworkFromDataFiles(m_MapPath, m_Map, true);
+	}
+	else if (m_MapType == PlannerHNS::MAP_AUTOWARE && !bMap)
+	{
+		std::vector<UtilityHNS::AisanDataConnFileReader::DataConn> conn_data;;
 
-		if(m_MapType == PlannerHNS::MAP_KML_FILE && !bMap)
-		{
-			bMap = true;
-			PlannerHNS::MappingHelpers::LoadKML(m_MapPath, m_Map);
-		}
-		else if (m_MapType == PlannerHNS::MAP_FOLDER && !bMap)
+		if(m_MapRaw.GetVersion()==2)
 		{
-			bMap = true;
-			PlannerHNS::MappingHelpers::ConstructRoadNetworkFromDataFiles(m_MapPath, m_Map, true);
+			PlannerHNS::MappingHelpers::ConstructRoadNetworkFromROSMessageV2(m_MapRaw.pLanes->m_data_list, m_MapRaw.pPoints->m_data_list,
+					m_MapRaw.pCenterLines->m_data_list, m_MapRaw.pIntersections->m_data_list,m_MapRaw.pAreas->m_data_list,
+					m_MapRaw.pLines->m_data_list, m_MapRaw.pStopLines->m_data_list,	m_MapRaw.pSignals->m_data_list,
+					m_MapRaw.pVectors->m_data_list, m_MapRaw.pCurbs->m_data_list, m_MapRaw.pRoadedges->m_data_list, m_MapRaw.pWayAreas->m_data_list,
+					m_MapRaw.pCrossWalks->m_data_list, m_MapRaw.pNodes->m_data_list, conn_data,
+					m_MapRaw.pLanes, m_MapRaw.pPoints, m_MapRaw.pNodes, m_MapRaw.pLines, PlannerHNS::GPSPoint(), m_Map, true, m_PlanningParams.enableLaneChange, true);
+
+			if(m_Map.roadSegments.size() > 0)
+			{
+				bMap = true;
+				std::cout << " ******* Map V2 Is Loaded successfully from the Motion Predictor !! " << std::endl;
+			}
 		}
-		else if (m_MapType == PlannerHNS::MAP_AUTOWARE && !bMap)
+		else if(m_MapRaw.GetVersion()==1)
 		{
-			std::vector<UtilityHNS::AisanDataConnFileReader::DataConn> conn_data;;
+			PlannerHNS::MappingHelpers::ConstructRoadNetworkFromROSMessage(m_MapRaw.pLanes->m_data_list, m_MapRaw.pPoints->m_data_list,
+					m_MapRaw.pCenterLines->m_data_list, m_MapRaw.pIntersections->m_data_list,m_MapRaw.pAreas->m_data_list,
+					m_MapRaw.pLines->m_data_list, m_MapRaw.pStopLines->m_data_list,	m_MapRaw.pSignals->m_data_list,
+					m_MapRaw.pVectors->m_data_list, m_MapRaw.pCurbs->m_data_list, m_MapRaw.pRoadedges->m_data_list, m_MapRaw.pWayAreas->m_data_list,
+					m_MapRaw.pCrossWalks->m_data_list, m_MapRaw.pNodes->m_data_list, conn_data,  PlannerHNS::GPSPoint(), m_Map, true);
 
-			if(m_MapRaw.GetVersion()==2)
-			{
-				PlannerHNS::MappingHelpers::ConstructRoadNetworkFromROSMessageV2(m_MapRaw.pLanes->m_data_list, m_MapRaw.pPoints->m_data_list,
-						m_MapRaw.pCenterLines->m_data_list, m_MapRaw.pIntersections->m_data_list,m_MapRaw.pAreas->m_data_list,
-						m_MapRaw.pLines->m_data_list, m_MapRaw.pStopLines->m_data_list,	m_MapRaw.pSignals->m_data_list,
-						m_MapRaw.pVectors->m_data_list, m_MapRaw.pCurbs->m_data_list, m_MapRaw.pRoadedges->m_data_list, m_MapRaw.pWayAreas->m_data_list,
-						m_MapRaw.pCrossWalks->m_data_list, m_MapRaw.pNodes->m_data_list, conn_data,
-						m_MapRaw.pLanes, m_MapRaw.pPoints, m_MapRaw.pNodes, m_MapRaw.pLines, PlannerHNS::GPSPoint(), m_Map, true, m_PlanningParams.enableLaneChange, true);
-
-				if(m_Map.roadSegments.size() > 0)
-				{
-					bMap = true;
-					std::cout << " ******* Map V2 Is Loaded successfully from the Motion Predictor !! " << std::endl;
-				}
-			}
-			else if(m_MapRaw.GetVersion()==1)
+			if(m_Map.roadSegments.size() > 0)
 			{
-				PlannerHNS::MappingHelpers::ConstructRoadNetworkFromROSMessage(m_MapRaw.pLanes->m_data_list, m_MapRaw.pPoints->m_data_list,
-						m_MapRaw.pCenterLines->m_data_list, m_MapRaw.pIntersections->m_data_list,m_MapRaw.pAreas->m_data_list,
-						m_MapRaw.pLines->m_data_list, m_MapRaw.pStopLines->m_data_list,	m_MapRaw.pSignals->m_data_list,
-						m_MapRaw.pVectors->m_data_list, m_MapRaw.pCurbs->m_data_list, m_MapRaw.pRoadedges->m_data_list, m_MapRaw.pWayAreas->m_data_list,
-						m_MapRaw.pCrossWalks->m_data_list, m_MapRaw.pNodes->m_data_list, conn_data,  PlannerHNS::GPSPoint(), m_Map, true);
-
-				if(m_Map.roadSegments.size() > 0)
-				{
-					bMap = true;
-					std::cout << " ******* Map V1 Is Loaded successfully from the Motion Predictor !! " << std::endl;
-				}
+				bMap = true;
+				std::cout << " ******* Map V1 Is Loaded successfully from the Motion Predictor !! " << std::endl;
 			}
 		}
+	}
 
-		if(UtilityHNS::UtilityH::GetTimeDiffNow(m_VisualizationTimer) > m_VisualizationTime)
-		{
-			VisualizePrediction();
-			UtilityHNS::UtilityH::GetTickCount(m_VisualizationTimer);
-		}
+	if(map_lock.owns_lock())
+	{
+		//the predictions of the objects point into the previous map
+		if(bMap)
+			m_PredictBeh.ClearMapCache();
+		map_lock.unlock();
+	}
 
-		//For the debugging of prediction
+	if(UtilityHNS::UtilityH::GetTimeDiffNow(m_VisualizationTimer) > m_VisualizationTime)
+	{
+		VisualizePrediction();
+		UtilityHNS::UtilityH::GetTickCount(m_VisualizationTimer);
+	}
+
+	//For the debugging of prediction
 //		if(UtilityHNS::UtilityH::GetTimeDiffNow(m_SensingTimer) > 5)
 //		{
 //			ROS_INFO("op_motion_prediction sensing timeout, can't receive tracked object data ! Reset .. Reset");
 //			m_PredictedResultsResults.objects.clear();
 //			pub_predicted_objects_trajectories.publish(m_PredictedResultsResults);
 //		}
+}
+
+void MotionPrediction::MainLoop()
+{
+
+	ros::Rate loop_rate(25);
 
+	while (ros::ok())
+	{
+		ros::spinOnce();
+		DoOneStep();
 		loop_rate.sleep();
 	}
 }
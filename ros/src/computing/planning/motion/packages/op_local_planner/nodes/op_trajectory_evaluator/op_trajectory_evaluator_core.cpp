@@ -21,8 +21,13 @@
 namespace TrajectoryEvaluatorNS
 {
 
-TrajectoryEval::TrajectoryEval()
+TrajectoryEval::TrajectoryEval(LocalPlannerPipelineNS::PipelineStage* pStage)
 {
+	m_pStage = pStage;
+	m_pWeightedRollOutsHandoff = nullptr;
+	if(m_pStage)
+		nh.setCallbackQueue(m_pStage->GetCallbackQueue());
+
 	bNewCurrentPos = false;
 	bVehicleStatus = false;
 	bWayGlobalPath = false;
@@ -56,9 +61,12 @@ TrajectoryEval::TrajectoryEval()
 		sub_can_info = nh.subscribe("/can_info", 10, &TrajectoryEval::callbackGetCANInfo, this);
 
 	sub_GlobalPlannerPaths = nh.subscribe("/lane_waypoints_array", 1, &TrajectoryEval::callbackGetGlobalPlannerPath, this);
-	sub_LocalPlannerPaths = nh.subscribe("/local_trajectories", 1, &TrajectoryEval::callbackGetLocalPlannerPath, this);
-	sub_predicted_objects = nh.subscribe("/predicted_objects", 1, &TrajectoryEval::callbackGetPredictedObjects, this);
-	sub_current_behavior = nh.subscribe("/current_behavior", 1, &TrajectoryEval::callbackGetBehaviorState, this);
+	if(!m_pStage)
+	{
+		sub_LocalPlannerPaths = nh.subscribe("/local_trajectories", 1, &TrajectoryEval::callbackGetLocalPlannerPath, this);
+		sub_predicted_objects = nh.subscribe("/predicted_objects", 1, &TrajectoryEval::callbackGetPredictedObjects, this);
+		sub_current_behavior = nh.subscribe("/current_behavior", 1, &TrajectoryEval::callbackGetBehaviorState, this);
+	}
 
 	PlannerHNS::ROSHelpers::InitCollisionPointsMarkers(50, m_CollisionsDummy);
 }
@@ -190,32 +198,41 @@ void TrajectoryEval::callbackGetLocalPlannerPath(const autoware_msgs::LaneArrayC
 	if(msg->lanes.size() > 0)
 	{
 		m_GeneratedRollOuts.clear();
-		int globalPathId_roll_outs = -1;
 
 		for(unsigned int i = 0 ; i < msg->lanes.size(); i++)
 		{
 			std::vector<PlannerHNS::WayPoint> path;
 			PlannerHNS::ROSHelpers::ConvertFromAutowareLaneToLocalLane(msg->lanes.at(i), path);
 			m_GeneratedRollOuts.push_back(path);
-			if(path.size() > 0)
-				globalPathId_roll_outs = path.at(0).gid;
 		}
 
-		if(bWayGlobalPath && m_GlobalPaths.size() > 0 && m_GlobalPaths.at(0).size() > 0)
-		{
-			int globalPathId = m_GlobalPaths.at(0).at(0).gid;
-			std::cout << "Before Synchronization At Trajectory Evaluator: GlobalID: " <<  globalPathId << ", LocalID: " << globalPathId_roll_outs << std::endl;
+		SynchronizeRollOuts();
+	}
+}
 
-			if(globalPathId_roll_outs == globalPathId)
-			{
-				bWayGlobalPath = false;
-				m_GlobalPathsToUse = m_GlobalPaths;
-				std::cout << "Synchronization At Trajectory Evaluator: GlobalID: " <<  globalPathId << ", LocalID: " << globalPathId_roll_outs << std::endl;
-			}
-		}
+void TrajectoryEval::SynchronizeRollOuts()
+{
+	int globalPathId_roll_outs = -1;
+	for(unsigned int i = 0 ; i < m_GeneratedRollOuts.size(); i++)
+	{
+		if(m_GeneratedRollOuts.at(i).size() > 0)
+			globalPathId_roll_outs = m_GeneratedRollOuts.at(i).at(0).gid;
+	}
+
+	if(bWayGlobalPath && m_GlobalPaths.size() > 0 && m_GlobalPaths.at(0).size() > 0)
+	{
+		int globalPathId = m_GlobalPaths.at(0).at(0).gid;
+		std::cout << "Before Synchronization At Trajectory Evaluator: GlobalID: " <<  globalPathId << ", LocalID: " << globalPathId_roll_outs << std::endl;
 
-		bRollOuts = true;
+		if(globalPathId_roll_outs == globalPathId)
+		{
+			bWayGlobalPath = false;
+			m_GlobalPathsToUse = m_GlobalPaths;
+			std::cout << "Synchronization At Trajectory Evaluator: GlobalID: " <<  globalPathId << ", LocalID: " << globalPathId_roll_outs << std::endl;
+		}
 	}
+
+	bRollOuts = true;
 }
 
 void TrajectoryEval::callbackGetPredictedObjects(const autoware_msgs::DetectedObjectArrayConstPtr& msg)
@@ -243,35 +260,60 @@ void TrajectoryEval::callbackGetBehaviorState(const geometry_msgs::TwistStampedC
 	m_CurrentBehavior.iTrajectory = msg->twist.angular.z;
 }
 
-void TrajectoryEval::MainLoop()
+void TrajectoryEval::SetRollOuts(LocalPlannerPipelineNS::RollOuts& rollOuts)
 {
-	ros::Rate loop_rate(100);
+	if(rollOuts.size() > 0)
+	{
+		m_GeneratedRollOuts.swap(rollOuts);
+		SynchronizeRollOuts();
+	}
+}
+
+void TrajectoryEval::SetPredictedObjects(std::vector<PlannerHNS::DetectedObject>& objects)
+{
+	m_PredictedObjects.swap(objects);
+	bPredictedObjects = true;
+}
 
-	PlannerHNS::WayPoint prevState, state_change;
+void TrajectoryEval::SetBehaviorState(PlannerHNS::BehaviorState& behavior)
+{
+	m_CurrentBehavior.iTrajectory = behavior.iTrajectory;
+}
 
-	while (ros::ok())
+void TrajectoryEval::SetWeightedRollOutsHandoff(LocalPlannerPipelineNS::StageHandoff<LocalPlannerPipelineNS::WeightedRollOuts>* pHandoff)
+{
+	m_pWeightedRollOutsHandoff = pHandoff;
+}
+
+void TrajectoryEval::DoOneStep()
+{
+	PlannerHNS::TrajectoryCost tc;
+	bool bBestCost = false;
+	//In the pipeline the results are converted to messages only for other subscribers
+	bool bSendCost = !m_pWeightedRollOutsHandoff || pub_TrajectoryCost.getNumSubscribers() > 0;
+	bool bSendLanes = !m_pWeightedRollOutsHandoff || pub_LocalWeightedTrajectories.getNumSubscribers() > 0;
+
+	if(bNewCurrentPos && m_GlobalPaths.size()>0)
 	{
-		ros::spinOnce();
-		PlannerHNS::TrajectoryCost tc;
+		m_GlobalPathSections.clear();
 
-		if(bNewCurrentPos && m_GlobalPaths.size()>0)
+		for(unsigned int i = 0; i < m_GlobalPathsToUse.size(); i++)
 		{
-			m_GlobalPathSections.clear();
+			t_centerTrajectorySmoothed.clear();
+			PlannerHNS::PlanningHelpers::ExtractPartFromPointToDistanceDirectionFast(m_GlobalPathsToUse.at(i), m_CurrentPos, m_PlanningParams.horizonDistance , m_PlanningParams.pathDensity ,t_centerTrajectorySmoothed);
+			m_GlobalPathSections.push_back(t_centerTrajectorySmoothed);
+		}
 
-			for(unsigned int i = 0; i < m_GlobalPathsToUse.size(); i++)
-			{
-				t_centerTrajectorySmoothed.clear();
-				PlannerHNS::PlanningHelpers::ExtractPartFromPointToDistanceDirectionFast(m_GlobalPathsToUse.at(i), m_CurrentPos, m_PlanningParams.horizonDistance , m_PlanningParams.pathDensity ,t_centerTrajectorySmoothed);
-				m_GlobalPathSections.push_back(t_centerTrajectorySmoothed);
-			}
+		if(m_GlobalPathSections.size()>0)
+		{
+			if(m_bUseMoveingObjectsPrediction)
+				tc = m_TrajectoryCostsCalculator.DoOneStepDynamic(m_GeneratedRollOuts, m_GlobalPathSections.at(0), m_CurrentPos,m_PlanningParams,	m_CarInfo,m_VehicleStatus, m_PredictedObjects, m_CurrentBehavior.iTrajectory);
+			else
+				tc = m_TrajectoryCostsCalculator.DoOneStepStatic(m_GeneratedRollOuts, m_GlobalPathSections.at(0), m_CurrentPos,	m_PlanningParams,	m_CarInfo,m_VehicleStatus, m_PredictedObjects);
+			bBestCost = true;
 
-			if(m_GlobalPathSections.size()>0)
+			if(bSendCost)
 			{
-				if(m_bUseMoveingObjectsPrediction)
-					tc = m_TrajectoryCostsCalculator.DoOneStepDynamic(m_GeneratedRollOuts, m_GlobalPathSections.at(0), m_CurrentPos,m_PlanningParams,	m_CarInfo,m_VehicleStatus, m_PredictedObjects, m_CurrentBehavior.iTrajectory);
-				else
-					tc = m_TrajectoryCostsCalculator.DoOneStepStatic(m_GeneratedRollOuts, m_GlobalPathSections.at(0), m_CurrentPos,	m_PlanningParams,	m_CarInfo,m_VehicleStatus, m_PredictedObjects);
-
 				autoware_msgs::Lane l;
 				l.closest_object_distance = tc.closest_obj_distance;
 				l.closest_object_velocity = tc.closest_obj_velocity;
@@ -280,8 +322,20 @@ void TrajectoryEval::MainLoop()
 				l.lane_index = tc.index;
 				pub_TrajectoryCost.publish(l);
 			}
+		}
 
-			if(m_TrajectoryCostsCalculator.m_TrajectoryCosts.size() == m_GeneratedRollOuts.size())
+		if(m_TrajectoryCostsCalculator.m_TrajectoryCosts.size() == m_GeneratedRollOuts.size())
+		{
+			if(m_pWeightedRollOutsHandoff)
+			{
+				LocalPlannerPipelineNS::WeightedRollOuts& weighted = m_pWeightedRollOutsHandoff->GetWriteBuffer();
+				weighted.rollOuts = m_GeneratedRollOuts;
+				weighted.bestCost = tc;
+				weighted.bBestCost = bBestCost;
+				m_pWeightedRollOutsHandoff->Publish();
+			}
+
+			if(bSendLanes)
 			{
 				autoware_msgs::LaneArray local_lanes;
 				for(unsigned int i=0; i < m_GeneratedRollOuts.size(); i++)
@@ -298,29 +352,39 @@ void TrajectoryEval::MainLoop()
 
 				pub_LocalWeightedTrajectories.publish(local_lanes);
 			}
-			else
-			{
-				ROS_ERROR("m_TrajectoryCosts.size() Not Equal m_GeneratedRollOuts.size()");
-			}
+		}
+		else
+		{
+			ROS_ERROR("m_TrajectoryCosts.size() Not Equal m_GeneratedRollOuts.size()");
+		}
 
-			if(m_TrajectoryCostsCalculator.m_TrajectoryCosts.size()>0)
-			{
-				visualization_msgs::MarkerArray all_rollOuts;
-				PlannerHNS::ROSHelpers::TrajectoriesToColoredMarkers(m_GeneratedRollOuts, m_TrajectoryCostsCalculator.m_TrajectoryCosts, m_CurrentBehavior.iTrajectory, all_rollOuts);
-				pub_LocalWeightedTrajectoriesRviz.publish(all_rollOuts);
+		if(m_TrajectoryCostsCalculator.m_TrajectoryCosts.size()>0)
+		{
+			visualization_msgs::MarkerArray all_rollOuts;
+			PlannerHNS::ROSHelpers::TrajectoriesToColoredMarkers(m_GeneratedRollOuts, m_TrajectoryCostsCalculator.m_TrajectoryCosts, m_CurrentBehavior.iTrajectory, all_rollOuts);
+			pub_LocalWeightedTrajectoriesRviz.publish(all_rollOuts);
 
-				PlannerHNS::ROSHelpers::ConvertCollisionPointsMarkers(m_TrajectoryCostsCalculator.m_CollisionPoints, m_CollisionsActual, m_CollisionsDummy);
-				pub_CollisionPointsRviz.publish(m_CollisionsActual);
+			PlannerHNS::ROSHelpers::ConvertCollisionPointsMarkers(m_TrajectoryCostsCalculator.m_CollisionPoints, m_CollisionsActual, m_CollisionsDummy);
+			pub_CollisionPointsRviz.publish(m_CollisionsActual);
 
-				//Visualize Safety Box
-				visualization_msgs::Marker safety_box;
-				PlannerHNS::ROSHelpers::ConvertFromPlannerHRectangleToAutowareRviz(m_TrajectoryCostsCalculator.m_SafetyBorder.points, safety_box);
-				pub_SafetyBorderRviz.publish(safety_box);
-			}
+			//Visualize Safety Box
+			visualization_msgs::Marker safety_box;
+			PlannerHNS::ROSHelpers::ConvertFromPlannerHRectangleToAutowareRviz(m_TrajectoryCostsCalculator.m_SafetyBorder.points, safety_box);
+			pub_SafetyBorderRviz.publish(safety_box);
 		}
-		else
-			sub_GlobalPlannerPaths = nh.subscribe("/lane_waypoints_array", 	1,		&TrajectoryEval::callbackGetGlobalPlannerPath, 	this);
+	}
+	else if(!m_pStage || m_pStage->IsPollingCycle())
+		sub_GlobalPlannerPaths = nh.subscribe("/lane_waypoints_array", 	1,		&TrajectoryEval::callbackGetGlobalPlannerPath, 	this);
+}
+
+void TrajectoryEval::MainLoop()
+{
+	ros::Rate loop_rate(100);
 
+	while (ros::ok())
+	{
+		ros::spinOnce();
+		DoOneStep();
 		loop_rate.sleep();
 	}
 }
@@ -21,8 +21,13 @@
 namespace TrajectoryGeneratorNS
 {
 
-TrajectoryGen::TrajectoryGen()
+TrajectoryGen::TrajectoryGen(LocalPlannerPipelineNS::PipelineStage* pStage)
 {
+	m_pStage = pStage;
+	m_pRollOutsHandoff = nullptr;
+	if(m_pStage)
+		nh.setCallbackQueue(m_pStage->GetCallbackQueue());
+
 	bInitPos = false;
 	bNewCurrentPos = false;
 	bVehicleStatus = false;
@@ -193,57 +198,72 @@ void TrajectoryGen::callbackGetGlobalPlannerPath(const autoware_msgs::LaneArrayC
 	}
 }
 
-void TrajectoryGen::MainLoop()
+void TrajectoryGen::SetRollOutsHandoff(LocalPlannerPipelineNS::StageHandoff<LocalPlannerPipelineNS::RollOuts>* pHandoff)
 {
-	ros::Rate loop_rate(100);
-
-	PlannerHNS::WayPoint prevState, state_change;
+	m_pRollOutsHandoff = pHandoff;
+}
 
-	while (ros::ok())
+void TrajectoryGen::DoOneStep()
+{
+	if(bInitPos && m_GlobalPaths.size()>0)
 	{
-		ros::spinOnce();
+		m_GlobalPathSections.clear();
 
-		if(bInitPos && m_GlobalPaths.size()>0)
+		for(unsigned int i = 0; i < m_GlobalPaths.size(); i++)
 		{
-			m_GlobalPathSections.clear();
+			t_centerTrajectorySmoothed.clear();
+			PlannerHNS::PlanningHelpers::ExtractPartFromPointToDistanceDirectionFast(m_GlobalPaths.at(i), m_CurrentPos, m_PlanningParams.horizonDistance ,
+					m_PlanningParams.pathDensity ,t_centerTrajectorySmoothed);
 
-			for(unsigned int i = 0; i < m_GlobalPaths.size(); i++)
-			{
-				t_centerTrajectorySmoothed.clear();
-				PlannerHNS::PlanningHelpers::ExtractPartFromPointToDistanceDirectionFast(m_GlobalPaths.at(i), m_CurrentPos, m_PlanningParams.horizonDistance ,
-						m_PlanningParams.pathDensity ,t_centerTrajectorySmoothed);
-
-				m_GlobalPathSections.push_back(t_centerTrajectorySmoothed);
-			}
+			m_GlobalPathSections.push_back(t_centerTrajectorySmoothed);
+		}
 
-			std::vector<PlannerHNS::WayPoint> sampledPoints_debug;
-			m_Planner.GenerateRunoffTrajectory(m_GlobalPathSections, m_CurrentPos,
-								m_PlanningParams.enableLaneChange,
-								m_VehicleStatus.speed,
-								m_PlanningParams.microPlanDistance,
-								m_PlanningParams.maxSpeed,
-								m_PlanningParams.minSpeed,
-								m_PlanningParams.carTipMargin,
-								m_PlanningParams.rollInMargin,
-								m_PlanningParams.rollInSpeedFactor,
-								m_PlanningParams.pathDensity,
-								m_PlanningParams.rollOutDensity,
-								m_PlanningParams.rollOutNumber,
-								m_PlanningParams.smoothingDataWeight,
-								m_PlanningParams.smoothingSmoothWeight,
-								m_PlanningParams.smoothingToleranceError,
-								m_PlanningParams.speedProfileFactor,
-								m_PlanningParams.enableHeadingSmoothing,
-								-1 , -1,
-								m_RollOuts, sampledPoints_debug);
-
-			autoware_msgs::LaneArray local_lanes;
+		std::vector<PlannerHNS::WayPoint> sampledPoints_debug;
+		m_Planner.GenerateRunoffTrajectory(m_GlobalPathSections, m_CurrentPos,
+							m_PlanningParams.enableLaneChange,
+							m_VehicleStatus.speed,
+							m_PlanningParams.microPlanDistance,
+							m_PlanningParams.maxSpeed,
+							m_PlanningParams.minSpeed,
+							m_PlanningParams.carTipMargin,
+							m_PlanningParams.rollInMargin,
+							m_PlanningParams.rollInSpeedFactor,
+							m_PlanningParams.pathDensity,
+							m_PlanningParams.rollOutDensity,
+							m_PlanningParams.rollOutNumber,
+							m_PlanningParams.smoothingDataWeight,
+							m_PlanningParams.smoothingSmoothWeight,
+							m_PlanningParams.smoothingToleranceError,
+							m_PlanningParams.speedProfileFactor,
+							m_PlanningParams.enableHeadingSmoothing,
+							-1 , -1,
+							m_RollOuts, sampledPoints_debug);
+
+		//In the pipeline the roll outs are converted to messages only for other subscribers
+		bool bSendLanes = !m_pRollOutsHandoff || pub_LocalTrajectories.getNumSubscribers() > 0;
+		LocalPlannerPipelineNS::RollOuts* pRollOuts = nullptr;
+		if(m_pRollOutsHandoff)
+		{
+			unsigned int nRollOuts = 0;
 			for(unsigned int i=0; i < m_RollOuts.size(); i++)
+				nRollOuts += m_RollOuts.at(i).size();
+			pRollOuts = &m_pRollOutsHandoff->GetWriteBuffer();
+			pRollOuts->resize(nRollOuts);
+		}
+
+		autoware_msgs::LaneArray local_lanes;
+		unsigned int iRollOut = 0;
+		for(unsigned int i=0; i < m_RollOuts.size(); i++)
+		{
+			for(unsigned int j=0; j < m_RollOuts.at(i).size(); j++)
 			{
-				for(unsigned int j=0; j < m_RollOuts.at(i).size(); j++)
+				PlannerHNS::PlanningHelpers::PredictConstantTimeCostForTrajectory(m_RollOuts.at(i).at(j), m_CurrentPos, m_PlanningParams.minSpeed, m_PlanningParams.microPlanDistance);
+				if(pRollOuts)
+					pRollOuts->at(iRollOut++) = m_RollOuts.at(i).at(j);
+
+				if(bSendLanes)
 				{
 					autoware_msgs::Lane lane;
-					PlannerHNS::PlanningHelpers::PredictConstantTimeCostForTrajectory(m_RollOuts.at(i).at(j), m_CurrentPos, m_PlanningParams.minSpeed, m_PlanningParams.microPlanDistance);
 					PlannerHNS::ROSHelpers::ConvertFromLocalLaneToAutowareLane(m_RollOuts.at(i).at(j), lane);
 					lane.closest_object_distance = 0;
 					lane.closest_object_velocity = 0;
@@ -253,15 +273,29 @@ void TrajectoryGen::MainLoop()
 					local_lanes.lanes.push_back(lane);
 				}
 			}
-			pub_LocalTrajectories.publish(local_lanes);
 		}
-		else
-			sub_GlobalPlannerPaths = nh.subscribe("/lane_waypoints_array", 	1,		&TrajectoryGen::callbackGetGlobalPlannerPath, 	this);
 
-		visualization_msgs::MarkerArray all_rollOuts;
-		PlannerHNS::ROSHelpers::TrajectoriesToMarkers(m_RollOuts, all_rollOuts);
-		pub_LocalTrajectoriesRviz.publish(all_rollOuts);
+		if(pRollOuts)
+			m_pRollOutsHandoff->Publish();
+		if(bSendLanes)
+			pub_LocalTrajectories.publish(local_lanes);
+	}
+	else if(!m_pStage || m_pStage->IsPollingCycle())
+		sub_GlobalPlannerPaths = nh.subscribe("/lane_waypoints_array", 	1,		&TrajectoryGen::callbackGetGlobalPlannerPath, 	this);
+
+	visualization_msgs::MarkerArray all_rollOuts;
+	PlannerHNS::ROSHelpers::TrajectoriesToMarkers(m_RollOuts, all_rollOuts);
+	pub_LocalTrajectoriesRviz.publish(all_rollOuts);
+}
 
+void TrajectoryGen::MainLoop()
+{
+	ros::Rate loop_rate(100);
+
+	while (ros::ok())
+	{
+		ros::spinOnce();
+		DoOneStep();
 		loop_rate.sleep();
 	}
 }
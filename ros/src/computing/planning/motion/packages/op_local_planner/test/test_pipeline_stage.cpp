@@ -0,0 +1,272 @@
+/*
+ * Copyright 2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <boost/bind.hpp>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "op_pipeline_stage.h"
+
+using namespace LocalPlannerPipelineNS;
+
+//records what the consumer stage gets from a handoff
+struct TestConsumer
+{
+	std::vector<int> values;
+	const std::vector<int>* pLastBuffer;
+
+	TestConsumer() : pLastBuffer(nullptr)
+	{
+	}
+
+	void Consume(std::vector<int>& buffer)
+	{
+		values.insert(values.end(), buffer.begin(), buffer.end());
+		pLastBuffer = &buffer;
+	}
+};
+
+//the stage threads are not started, the handoff is driven by hand from the test
+class StageHandoffTest : public testing::Test
+{
+protected:
+	PipelineStage m_Producer;
+	PipelineStage m_Consumer;
+	TestConsumer m_Received;
+	StageHandoff<std::vector<int> > m_Handoff;
+
+	StageHandoffTest()
+	: m_Producer("producer", 1, 0, 1, false), m_Consumer("consumer", 1, 0, 1, true),
+	  m_Handoff(&m_Producer, &m_Consumer, boost::bind(&TestConsumer::Consume, &m_Received, _1), true, true)
+	{
+	}
+
+	void Publish(const int& value)
+	{
+		m_Handoff.GetWriteBuffer().assign(1, value);
+		m_Handoff.Publish();
+	}
+
+	bool Consume()
+	{
+		timespec tChainStart, tPublish;
+		return m_Handoff.Consume(tChainStart, tPublish);
+	}
+};
+
+TEST_F(StageHandoffTest, nothingBeforeFirstPublish)
+{
+	EXPECT_FALSE(Consume());
+	EXPECT_TRUE(m_Received.values.empty());
+}
+
+TEST_F(StageHandoffTest, eachBufferIsConsumedOnce)
+{
+	Publish(1);
+	EXPECT_TRUE(Consume());
+	EXPECT_FALSE(Consume());
+	Publish(2);
+	EXPECT_TRUE(Consume());
+	EXPECT_FALSE(Consume());
+	ASSERT_EQ(2u, m_Received.values.size());
+	EXPECT_EQ(1, m_Received.values.at(0));
+	EXPECT_EQ(2, m_Received.values.at(1));
+}
+
+//like a topic with queue size one, the buffers published between two consumptions are dropped but the latest
+TEST_F(StageHandoffTest, consumerGetsLatestBuffer)
+{
+	for(int i = 0; i < 5; i++)
+		Publish(i);
+	EXPECT_TRUE(Consume());
+	EXPECT_FALSE(Consume());
+	ASSERT_EQ(1u, m_Received.values.size());
+	EXPECT_EQ(4, m_Received.values.at(0));
+}
+
+//any sequence of publishes and consumptions: the producer never writes into the buffer the consumer holds, the
+//three buffers are reused and the consumer always gets the latest published buffer
+TEST_F(StageHandoffTest, indexExchange)
+{
+	std::vector<const std::vector<int>*> buffers;
+	int published = -1;
+	bool bNew = false;
+	for(int i = 0; i < 1000; i++)
+	{
+		if((i * 7919) % 3 != 0)
+		{
+			const std::vector<int>* pWrite = &m_Handoff.GetWriteBuffer();
+			ASSERT_NE(m_Received.pLastBuffer, pWrite) << "step " << i;
+			if(std::find(buffers.begin(), buffers.end(), pWrite) == buffers.end())
+				buffers.push_back(pWrite);
+			Publish(++published);
+			bNew = true;
+		}
+		if((i * 104729) % 5 < 2)
+		{
+			ASSERT_EQ(bNew, Consume()) << "step " << i;
+			if(bNew)
+				ASSERT_EQ(published, m_Received.values.back()) << "step " << i;
+			bNew = false;
+		}
+	}
+	EXPECT_EQ(3u, buffers.size());
+}
+
+TEST_F(StageHandoffTest, chainStartFollowsTheBuffer)
+{
+	Publish(1);
+	timespec tChainStart, tPublish;
+	ASSERT_TRUE(m_Handoff.Consume(tChainStart, tPublish));
+	EXPECT_EQ(m_Producer.GetChainStart().tv_sec, tChainStart.tv_sec);
+	EXPECT_EQ(m_Producer.GetChainStart().tv_nsec, tChainStart.tv_nsec);
+	EXPECT_GE(UtilityHNS::UtilityH::GetTimeDiff(tChainStart, tPublish), 0);
+}
+
+//a producer and a consumer thread, every consumed buffer is whole and newer than the one before
+TEST(StageHandoff, concurrentProducerAndConsumer)
+{
+	PipelineStage producer("producer", 1, 0, 1, false);
+	PipelineStage consumer("consumer", 1, 0, 1, true);
+	TestConsumer received;
+	StageHandoff<std::vector<int> > handoff(&producer, &consumer, boost::bind(&TestConsumer::Consume, &received, _1), true,
+			true);
+
+	const int n = 100000;
+	std::atomic<bool> bDone(false);
+	std::thread publisher([&handoff, &bDone, n]()
+	{
+		for(int i = 1; i <= n; i++)
+		{
+			handoff.GetWriteBuffer().assign(16, i);
+			handoff.Publish();
+		}
+		bDone = true;
+	});
+
+	timespec tChainStart, tPublish;
+	int last = 0, consumed = 0;
+	bool bValid = true;
+	while(bValid)
+	{
+		bool bFinal = bDone;
+		received.values.clear();
+		if(handoff.Consume(tChainStart, tPublish))
+		{
+			consumed++;
+			bValid = received.values.size() == 16 && received.values.front() > last;
+			for(unsigned int i = 1; i < received.values.size() && bValid; i++)
+				bValid = received.values.at(i) == received.values.front();
+			if(bValid)
+				last = received.values.front();
+		}
+		if(bFinal)
+			break;
+	}
+	publisher.join();
+
+	EXPECT_TRUE(bValid) << "after " << last;
+	EXPECT_EQ(n, last);
+	EXPECT_GT(consumed, 0);
+}
+
+TEST(LatencyHistogram, bucketBounds)
+{
+	EXPECT_DOUBLE_EQ(0.25, LatencyHistogram::GetBucketBound(0));
+	EXPECT_DOUBLE_EQ(0.5, LatencyHistogram::GetBucketBound(1));
+	EXPECT_DOUBLE_EQ(1024, LatencyHistogram::GetBucketBound(LatencyHistogram::BUCKETS_NUMBER-2));
+}
+
+TEST(LatencyHistogram, empty)
+{
+	LatencyHistogram histogram;
+	EXPECT_EQ(0u, histogram.GetCount());
+	EXPECT_DOUBLE_EQ(0, histogram.GetMean());
+	EXPECT_DOUBLE_EQ(0, histogram.GetMax());
+	EXPECT_DOUBLE_EQ(0, histogram.GetPercentile(50));
+}
+
+TEST(LatencyHistogram, countMeanAndMax)
+{
+	LatencyHistogram histogram;
+	histogram.Add(1.5);
+	histogram.Add(2.5);
+	histogram.Add(-1);
+	EXPECT_EQ(3u, histogram.GetCount());
+	EXPECT_NEAR(4.0/3, histogram.GetMean(), 1e-9);
+	EXPECT_DOUBLE_EQ(2.5, histogram.GetMax());
+}
+
+//the percentile is the upper bound of its bucket, a value on a bound counts in the bucket above it
+TEST(LatencyHistogram, percentiles)
+{
+	LatencyHistogram histogram;
+	for(int i = 0; i < 50; i++)
+		histogram.Add(0.1);
+	for(int i = 0; i < 49; i++)
+		histogram.Add(3.0);
+	histogram.Add(0.25);
+
+	EXPECT_DOUBLE_EQ(0.25, histogram.GetPercentile(50));
+	EXPECT_DOUBLE_EQ(0.5, histogram.GetPercentile(51));
+	EXPECT_DOUBLE_EQ(4.0, histogram.GetPercentile(52));
+	EXPECT_DOUBLE_EQ(4.0, histogram.GetPercentile(100));
+}
+
+//above the last bound the percentile is the maximum
+TEST(LatencyHistogram, overflowBucket)
+{
+	LatencyHistogram histogram;
+	histogram.Add(1.0);
+	histogram.Add(5000.0);
+	EXPECT_DOUBLE_EQ(2.0, histogram.GetPercentile(50));
+	EXPECT_DOUBLE_EQ(5000.0, histogram.GetPercentile(99));
+
+	std::string report = histogram.ToString();
+	EXPECT_NE(std::string::npos, report.find("n: 2")) << report;
+	EXPECT_NE(std::string::npos, report.find(" <2:1")) << report;
+	EXPECT_NE(std::string::npos, report.find(" >=1024:1")) << report;
+}
+
+TEST(LatencyHistogram, concurrentAdds)
+{
+	LatencyHistogram histogram;
+	std::vector<std::thread> threads;
+	for(int t = 0; t < 4; t++)
+	{
+		threads.push_back(std::thread([&histogram, t]()
+		{
+			for(int i = 0; i < 10000; i++)
+				histogram.Add(t + 1);
+		}));
+	}
+	for(unsigned int t = 0; t < threads.size(); t++)
+		threads.at(t).join();
+
+	EXPECT_EQ(40000u, histogram.GetCount());
+	EXPECT_NEAR(2.5, histogram.GetMean(), 1e-9);
+	EXPECT_DOUBLE_EQ(4, histogram.GetMax());
+}
+
+int main(int argc, char **argv)
+{
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
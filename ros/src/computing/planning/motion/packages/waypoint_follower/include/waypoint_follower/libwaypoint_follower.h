@@ -26,6 +26,7 @@
 #include <tf/transform_broadcaster.h>
 #include <tf/transform_listener.h>
 #include "autoware_msgs/Lane.h"
+#include "waypoint_follower/waypoint_index.h"
 
 class WayPoints
 {
@@ -47,7 +48,7 @@ public:
   geometry_msgs::Quaternion getWaypointOrientation(int waypoint) const;
   geometry_msgs::Pose getWaypointPose(int waypoint) const;
   double getWaypointVelocityMPS(int waypoint) const;
-  autoware_msgs::Lane getCurrentWaypoints() const
+  const autoware_msgs::Lane &getCurrentWaypoints() const
   {
     return current_waypoints_;
   }
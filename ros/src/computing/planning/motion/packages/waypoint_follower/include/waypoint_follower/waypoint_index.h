@@ -0,0 +1,79 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _WAYPOINT_INDEX_H_
+#define _WAYPOINT_INDEX_H_
+
+// C++ header
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// ROS header
+#include <geometry_msgs/Pose.h>
+#include "autoware_msgs/Lane.h"
+
+// Closest waypoint queries on a lane.
+// Positions, headings and arc length are computed once in setPath, and the waypoints are hashed
+// into a grid on the xy plane, so a query does not copy the lane nor use any trigonometry.
+class WaypointIndex
+{
+public:
+  explicit WaypointIndex(double cell_size = 5.0);
+
+  void setPath(const autoware_msgs::Lane &lane);
+  void clear();
+  bool isEmpty() const
+  {
+    return x_.empty();
+  }
+  int getSize() const
+  {
+    return x_.size();
+  }
+
+  double getArcLength(int waypoint) const;  // distance along the lane from waypoint 0, on the xy plane
+  double getYaw(int waypoint) const;
+  double getPlaneDistance(int waypoint, const geometry_msgs::Point &point) const;
+
+  // closest waypoint in [begin, end) in front of current_pose and heading less than 90 degrees away from it,
+  // waypoints farther than max_distance are ignored unless max_distance is negative. Returns -1 if none.
+  // include_boundary keeps waypoints right abeam or heading exactly 90 degrees away
+  int findClosestWaypoint(const geometry_msgs::Pose &current_pose, int begin, int end, double max_distance,
+                          bool include_boundary = true) const;
+
+  // same result as getClosestWaypoint() of libwaypoint_follower
+  int getClosestWaypoint(const geometry_msgs::Pose &current_pose, double search_distance = 5.0) const;
+
+  // warm-started getClosestWaypoint(): only the waypoints reachable from previous are searched,
+  // which is constant time while the vehicle follows the lane. Where the lane crosses itself
+  // the vehicle stays on the part it was following instead of jumping to the other one
+  int trackClosestWaypoint(const geometry_msgs::Pose &current_pose, int previous,
+                           double search_distance = 5.0) const;
+
+private:
+  double cell_size_;
+  std::vector<double> x_, y_, z_;
+  std::vector<double> heading_x_, heading_y_, heading_z_;  // x axis of each waypoint orientation
+  std::vector<double> arc_length_;
+  std::vector<std::pair<int64_t, int> > cells_;  // (cell, waypoint) sorted by cell
+
+  int64_t cellIndex(double coordinate) const;
+  static int64_t cellKey(int64_t cell_x, int64_t cell_y);
+  static void getXAxis(const geometry_msgs::Quaternion &q, double *x, double *y, double *z);
+};
+
+#endif
@@ -160,70 +160,10 @@ double getRelativeAngle(geometry_msgs::Pose waypoint_pose, geometry_msgs::Pose v
 // get closest waypoint from current pose
 int getClosestWaypoint(const autoware_msgs::Lane &current_path, geometry_msgs::Pose current_pose)
 {
-  WayPoints wp;
-  wp.setPath(current_path);
-
-  if (wp.isEmpty())
-    return -1;
-
-  // search closest candidate within a certain meter
-  double search_distance = 5.0;
-  std::vector<int> waypoint_candidates;
-  for (int i = 1; i < wp.getSize(); i++)
-  {
-    if (getPlaneDistance(wp.getWaypointPosition(i), current_pose.position) > search_distance)
-      continue;
-
-    if (!wp.isFront(i, current_pose))
-      continue;
-
-    double angle_threshold = 90;
-    if (getRelativeAngle(wp.getWaypointPose(i), current_pose) > angle_threshold)
-      continue;
-
-    waypoint_candidates.push_back(i);
-  }
-
-  // get closest waypoint from candidates
-  if (!waypoint_candidates.empty())
-  {
-    int waypoint_min = -1;
-    double distance_min = DBL_MAX;
-    for (auto el : waypoint_candidates)
-    {
-      // ROS_INFO("closest_candidates : %d",el);
-      double d = getPlaneDistance(wp.getWaypointPosition(el), current_pose.position);
-      if (d < distance_min)
-      {
-        waypoint_min = el;
-        distance_min = d;
-      }
-    }
-    return waypoint_min;
-  }
-  else
-  {
-    ROS_INFO("no candidate. search closest waypoint from all waypoints...");
-    // if there is no candidate...
-    int waypoint_min = -1;
-    double distance_min = DBL_MAX;
-    for (int i = 1; i < wp.getSize(); i++)
-    {
-      if (!wp.isFront(i, current_pose))
-        continue;
-
-      // if (!wp.isValid(i, current_pose))
-      //  continue;
-
-      double d = getPlaneDistance(wp.getWaypointPosition(i), current_pose.position);
-      if (d < distance_min)
-      {
-        waypoint_min = i;
-        distance_min = d;
-      }
-    }
-    return waypoint_min;
-  }
+  // nodes querying the same path repeatedly should keep their own WaypointIndex
+  WaypointIndex index;
+  index.setPath(current_path);
+  return index.getClosestWaypoint(current_pose);
 }
 
 // let the linear equation be "ax + by + c = 0"
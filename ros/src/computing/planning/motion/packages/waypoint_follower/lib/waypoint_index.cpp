@@ -0,0 +1,226 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "waypoint_follower/waypoint_index.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <ros/ros.h>
+
+WaypointIndex::WaypointIndex(double cell_size) : cell_size_(cell_size)
+{
+}
+
+int64_t WaypointIndex::cellIndex(double coordinate) const
+{
+  return static_cast<int64_t>(std::floor(coordinate / cell_size_));
+}
+
+int64_t WaypointIndex::cellKey(int64_t cell_x, int64_t cell_y)
+{
+  return ((cell_x + 0x80000000LL) << 32) | (cell_y + 0x80000000LL);
+}
+
+void WaypointIndex::getXAxis(const geometry_msgs::Quaternion &q, double *x, double *y, double *z)
+{
+  // first column of the rotation matrix, the quaternion does not need to be normalized
+  double norm = q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w;
+  double s = norm > 0 ? 2.0 / norm : 0;
+  *x = 1.0 - s * (q.y * q.y + q.z * q.z);
+  *y = s * (q.x * q.y + q.w * q.z);
+  *z = s * (q.x * q.z - q.w * q.y);
+}
+
+void WaypointIndex::clear()
+{
+  x_.clear();
+  y_.clear();
+  z_.clear();
+  heading_x_.clear();
+  heading_y_.clear();
+  heading_z_.clear();
+  arc_length_.clear();
+  cells_.clear();
+}
+
+void WaypointIndex::setPath(const autoware_msgs::Lane &lane)
+{
+  clear();
+  const size_t size = lane.waypoints.size();
+  x_.reserve(size);
+  y_.reserve(size);
+  z_.reserve(size);
+  heading_x_.reserve(size);
+  heading_y_.reserve(size);
+  heading_z_.reserve(size);
+  arc_length_.reserve(size);
+  cells_.reserve(size);
+
+  for (size_t i = 0; i < size; i++)
+  {
+    const geometry_msgs::Pose &pose = lane.waypoints[i].pose.pose;
+    x_.push_back(pose.position.x);
+    y_.push_back(pose.position.y);
+    z_.push_back(pose.position.z);
+
+    double heading_x, heading_y, heading_z;
+    getXAxis(pose.orientation, &heading_x, &heading_y, &heading_z);
+    heading_x_.push_back(heading_x);
+    heading_y_.push_back(heading_y);
+    heading_z_.push_back(heading_z);
+
+    arc_length_.push_back(i == 0 ? 0 : arc_length_[i - 1] + std::hypot(x_[i] - x_[i - 1], y_[i] - y_[i - 1]));
+    cells_.push_back(std::make_pair(cellKey(cellIndex(x_[i]), cellIndex(y_[i])), static_cast<int>(i)));
+  }
+  std::sort(cells_.begin(), cells_.end());
+}
+
+double WaypointIndex::getArcLength(int waypoint) const
+{
+  if (waypoint < 0 || waypoint >= getSize())
+    return 0;
+  return arc_length_[waypoint];
+}
+
+double WaypointIndex::getYaw(int waypoint) const
+{
+  if (waypoint < 0 || waypoint >= getSize())
+    return 0;
+  return std::atan2(heading_y_[waypoint], heading_x_[waypoint]);
+}
+
+double WaypointIndex::getPlaneDistance(int waypoint, const geometry_msgs::Point &point) const
+{
+  if (waypoint < 0 || waypoint >= getSize())
+    return 0;
+  return std::hypot(x_[waypoint] - point.x, y_[waypoint] - point.y);
+}
+
+int WaypointIndex::findClosestWaypoint(const geometry_msgs::Pose &current_pose, int begin, int end,
+                                       double max_distance, bool include_boundary) const
+{
+  begin = std::max(begin, 0);
+  end = std::min(end, getSize());
+  if (begin >= end)
+    return -1;
+
+  // x axis of the vehicle: a waypoint is in front if its relative position projects positively on it,
+  // and heads the same way if its own x axis does
+  double axis_x, axis_y, axis_z;
+  getXAxis(current_pose.orientation, &axis_x, &axis_y, &axis_z);
+  const geometry_msgs::Point &p = current_pose.position;
+  const double max_distance_sq = max_distance * max_distance;
+
+  int waypoint_min = -1;
+  double distance_sq_min = 0;
+  auto check = [&](int i) {
+    double dx = x_[i] - p.x;
+    double dy = y_[i] - p.y;
+    double distance_sq = dx * dx + dy * dy;
+    if (max_distance >= 0 && distance_sq > max_distance_sq)
+      return;
+    if (waypoint_min >= 0 && (distance_sq > distance_sq_min || (distance_sq == distance_sq_min && i > waypoint_min)))
+      return;
+
+    double front = axis_x * dx + axis_y * dy + axis_z * (z_[i] - p.z);
+    double heading = axis_x * heading_x_[i] + axis_y * heading_y_[i] + axis_z * heading_z_[i];
+    if (include_boundary ? (front < 0 || heading < 0) : (front <= 0 || heading <= 0))
+      return;
+
+    waypoint_min = i;
+    distance_sq_min = distance_sq;
+  };
+
+  // the grid only pays off when it holds fewer waypoints than the range
+  int64_t cells_num = max_distance >= 0 ? static_cast<int64_t>(std::ceil(max_distance / cell_size_)) * 2 + 2 : 0;
+  if (max_distance < 0 || cells_num * cells_num >= end - begin)
+  {
+    for (int i = begin; i < end; i++)
+      check(i);
+    return waypoint_min;
+  }
+
+  const int64_t cell_x_end = cellIndex(p.x + max_distance);
+  const int64_t cell_y_begin = cellIndex(p.y - max_distance);
+  const int64_t cell_y_end = cellIndex(p.y + max_distance);
+  for (int64_t cell_x = cellIndex(p.x - max_distance); cell_x <= cell_x_end; cell_x++)
+  {
+    // the cells of a column are contiguous in cells_
+    int64_t key_begin = cellKey(cell_x, cell_y_begin);
+    int64_t key_end = cellKey(cell_x, cell_y_end);
+    auto it = std::lower_bound(cells_.begin(), cells_.end(), std::make_pair(key_begin, 0));
+    for (; it != cells_.end() && it->first <= key_end; ++it)
+    {
+      if (it->second >= begin && it->second < end)
+        check(it->second);
+    }
+  }
+  return waypoint_min;
+}
+
+int WaypointIndex::getClosestWaypoint(const geometry_msgs::Pose &current_pose, double search_distance) const
+{
+  if (isEmpty())
+    return -1;
+
+  // search closest candidate within a certain meter
+  int waypoint_min = findClosestWaypoint(current_pose, 1, getSize(), search_distance);
+  if (waypoint_min < 0)
+  {
+    ROS_INFO("no candidate. search closest waypoint from all waypoints...");
+    // if there is no candidate, the heading is not checked either
+    double axis_x, axis_y, axis_z;
+    getXAxis(current_pose.orientation, &axis_x, &axis_y, &axis_z);
+    const geometry_msgs::Point &p = current_pose.position;
+    double distance_sq_min = 0;
+    for (int i = 1; i < getSize(); i++)
+    {
+      double dx = x_[i] - p.x;
+      double dy = y_[i] - p.y;
+      double distance_sq = dx * dx + dy * dy;
+      if (waypoint_min >= 0 && distance_sq >= distance_sq_min)
+        continue;
+      if (axis_x * dx + axis_y * dy + axis_z * (z_[i] - p.z) < 0)
+        continue;
+      waypoint_min = i;
+      distance_sq_min = distance_sq;
+    }
+  }
+  return waypoint_min;
+}
+
+int WaypointIndex::trackClosestWaypoint(const geometry_msgs::Pose &current_pose, int previous,
+                                        double search_distance) const
+{
+  if (previous >= 0 && previous < getSize())
+  {
+    double distance = getPlaneDistance(previous, current_pose.position);
+    if (distance <= search_distance)
+    {
+      // only the part of the lane the vehicle can have reached since previous is searched
+      double reach = arc_length_[previous] + distance + search_distance;
+      int end = previous + 1;
+      while (end < getSize() && arc_length_[end] <= reach)
+        end++;
+
+      int waypoint_min = findClosestWaypoint(current_pose, std::max(previous, 1), end, search_distance);
+      if (waypoint_min >= 0)
+        return waypoint_min;
+    }
+  }
+  return getClosestWaypoint(current_pose, search_distance);
+}
@@ -0,0 +1,215 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+#include "waypoint_follower/waypoint_index.h"
+
+namespace
+{
+geometry_msgs::Pose makePose(double x, double y, double yaw)
+{
+  geometry_msgs::Pose pose;
+  pose.position.x = x;
+  pose.position.y = y;
+  pose.position.z = 0;
+  pose.orientation.z = std::sin(yaw / 2);
+  pose.orientation.w = std::cos(yaw / 2);
+  return pose;
+}
+
+// closed loop of radius 20 m, counterclockwise, one waypoint every 1 m
+autoware_msgs::Lane makeLoop()
+{
+  const double radius = 20.0;
+  const int size = static_cast<int>(2 * M_PI * radius);
+  autoware_msgs::Lane lane;
+  for (int i = 0; i < size; i++)
+  {
+    double angle = 2 * M_PI * i / size;
+    autoware_msgs::Waypoint waypoint;
+    waypoint.pose.pose = makePose(radius * std::cos(angle), radius * std::sin(angle), angle + M_PI / 2);
+    lane.waypoints.push_back(waypoint);
+  }
+  return lane;
+}
+
+// the linear search getClosestWaypoint() of libwaypoint_follower did before WaypointIndex:
+// the closest waypoint within search_distance in front and heading at most 90 degrees away,
+// else the closest waypoint in front. Waypoint 0 is never returned.
+int linearClosestWaypoint(const autoware_msgs::Lane &lane, const geometry_msgs::Pose &pose,
+                          double search_distance = 5.0)
+{
+  const double yaw = 2 * std::atan2(pose.orientation.z, pose.orientation.w);
+  int candidate = -1, fallback = -1;
+  double candidate_distance = 0, fallback_distance = 0;
+  for (int i = 1; i < static_cast<int>(lane.waypoints.size()); i++)
+  {
+    const geometry_msgs::Pose &waypoint = lane.waypoints[i].pose.pose;
+    double dx = waypoint.position.x - pose.position.x;
+    double dy = waypoint.position.y - pose.position.y;
+    if (std::cos(yaw) * dx + std::sin(yaw) * dy < 0)
+      continue;
+    double distance = dx * dx + dy * dy;  // squared, as ties are broken by the lower index on both sides
+    if (fallback < 0 || distance < fallback_distance)
+    {
+      fallback = i;
+      fallback_distance = distance;
+    }
+
+    double waypoint_yaw = 2 * std::atan2(waypoint.orientation.z, waypoint.orientation.w);
+    if (distance > search_distance * search_distance || std::cos(waypoint_yaw - yaw) < 0)
+      continue;
+    if (candidate < 0 || distance < candidate_distance)
+    {
+      candidate = i;
+      candidate_distance = distance;
+    }
+  }
+  return candidate >= 0 ? candidate : fallback;
+}
+}  // namespace
+
+// vehicle poses all around the loop, off the lane and heading along or across it
+TEST(WaypointIndex, matchesLinearSearchOnLoop)
+{
+  autoware_msgs::Lane lane = makeLoop();
+  WaypointIndex index;
+  index.setPath(lane);
+  ASSERT_EQ(static_cast<int>(lane.waypoints.size()), index.getSize());
+
+  for (double angle = 0; angle < 2 * M_PI; angle += 0.013)
+  {
+    for (double radius = 16.5; radius <= 23.5; radius += 0.7)
+    {
+      for (double yaw_offset = -1.3; yaw_offset <= 1.3; yaw_offset += 0.65)
+      {
+        geometry_msgs::Pose pose =
+            makePose(radius * std::cos(angle), radius * std::sin(angle), angle + M_PI / 2 + yaw_offset);
+        ASSERT_EQ(linearClosestWaypoint(lane, pose), index.getClosestWaypoint(pose))
+            << "angle " << angle << " radius " << radius << " yaw offset " << yaw_offset;
+      }
+    }
+  }
+
+  // far from the lane, only the waypoints in front are left
+  geometry_msgs::Pose pose = makePose(100, 3, M_PI);
+  EXPECT_EQ(linearClosestWaypoint(lane, pose), index.getClosestWaypoint(pose));
+}
+
+// poses on a waypoint, halfway between two waypoints and on the grid cell lines
+TEST(WaypointIndex, matchesLinearSearchAtBoundaries)
+{
+  autoware_msgs::Lane lane = makeLoop();
+  WaypointIndex index(5.0);
+  index.setPath(lane);
+
+  for (size_t i = 0; i < lane.waypoints.size(); i++)
+  {
+    const geometry_msgs::Pose &waypoint = lane.waypoints[i].pose.pose;
+    const geometry_msgs::Pose &next = lane.waypoints[(i + 1) % lane.waypoints.size()].pose.pose;
+    double yaw = 2 * std::atan2(waypoint.orientation.z, waypoint.orientation.w);
+
+    geometry_msgs::Pose pose = makePose(waypoint.position.x, waypoint.position.y, yaw);
+    ASSERT_EQ(linearClosestWaypoint(lane, pose), index.getClosestWaypoint(pose)) << "on waypoint " << i;
+
+    // both neighbours are at the same distance, the first one wins
+    pose = makePose((waypoint.position.x + next.position.x) / 2, (waypoint.position.y + next.position.y) / 2, yaw);
+    ASSERT_EQ(linearClosestWaypoint(lane, pose), index.getClosestWaypoint(pose)) << "after waypoint " << i;
+  }
+
+  for (double x = -25; x <= 25; x += 5)
+  {
+    for (double y = -25; y <= 25; y += 5)
+    {
+      for (double yaw = 0; yaw < 2 * M_PI; yaw += M_PI / 3)
+      {
+        geometry_msgs::Pose pose = makePose(x, y, yaw);
+        ASSERT_EQ(linearClosestWaypoint(lane, pose), index.getClosestWaypoint(pose))
+            << "x " << x << " y " << y << " yaw " << yaw;
+      }
+    }
+  }
+}
+
+// search windows that end exactly on the search distance or on the range limits
+TEST(WaypointIndex, findClosestWaypointInRange)
+{
+  autoware_msgs::Lane lane;
+  for (int i = 0; i < 20; i++)
+  {
+    autoware_msgs::Waypoint waypoint;
+    waypoint.pose.pose = makePose(i, 0, 0);
+    lane.waypoints.push_back(waypoint);
+  }
+  WaypointIndex index(2.0);
+  index.setPath(lane);
+
+  geometry_msgs::Pose pose = makePose(4.5, 0, 0);
+  EXPECT_EQ(5, index.findClosestWaypoint(pose, 0, 20, 0.5));
+  EXPECT_EQ(8, index.findClosestWaypoint(pose, 8, 20, 3.5));
+  EXPECT_EQ(-1, index.findClosestWaypoint(pose, 9, 20, 3.5));
+  EXPECT_EQ(-1, index.findClosestWaypoint(pose, 0, 5, 10.0));
+  EXPECT_EQ(-1, index.findClosestWaypoint(pose, 20, 30, -1));
+
+  // right abeam only counts with include_boundary
+  pose = makePose(5, 1, 0);
+  EXPECT_EQ(5, index.findClosestWaypoint(pose, 0, 20, 2.0));
+  EXPECT_EQ(6, index.findClosestWaypoint(pose, 0, 20, 2.0, false));
+
+  EXPECT_DOUBLE_EQ(19.0, index.getArcLength(19));
+  EXPECT_DOUBLE_EQ(0.0, index.getArcLength(20));
+}
+
+// driving two laps, the tracked waypoint stays the one of the full search, across the end of the loop too
+TEST(WaypointIndex, trackMatchesLinearSearch)
+{
+  autoware_msgs::Lane lane = makeLoop();
+  WaypointIndex index;
+  index.setPath(lane);
+
+  int tracked = -1;
+  for (double angle = 0; angle < 4 * M_PI; angle += 0.021)
+  {
+    double radius = 20.0 + 0.8 * std::sin(3 * angle);
+    geometry_msgs::Pose pose = makePose(radius * std::cos(angle), radius * std::sin(angle), angle + M_PI / 2 + 0.2);
+    tracked = index.trackClosestWaypoint(pose, tracked);
+    ASSERT_EQ(linearClosestWaypoint(lane, pose), tracked) << "angle " << angle;
+  }
+
+  // a stale previous waypoint falls back to the full search
+  geometry_msgs::Pose pose = makePose(-20, 0.5, -M_PI / 2);
+  EXPECT_EQ(linearClosestWaypoint(lane, pose), index.trackClosestWaypoint(pose, 3));
+  EXPECT_EQ(linearClosestWaypoint(lane, pose), index.trackClosestWaypoint(pose, 1000));
+}
+
+TEST(WaypointIndex, emptyPath)
+{
+  WaypointIndex index;
+  index.setPath(autoware_msgs::Lane());
+  EXPECT_TRUE(index.isEmpty());
+  EXPECT_EQ(-1, index.getClosestWaypoint(makePose(0, 0, 0)));
+  EXPECT_EQ(-1, index.trackClosestWaypoint(makePose(0, 0, 0), 0));
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <libgen.h>
+
+#include <chrono>
+
+#include <ros/console.h>
+#include <vector_map/binary_map.h>
+
+namespace
+{
+void printUsage()
+{
+  ROS_ERROR_STREAM("Usage:");
+  ROS_ERROR_STREAM("rosrun map_file vector_map_compiler [VMB] [CSV]...");
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+  if (argc < 3)
+  {
+    printUsage();
+    return EXIT_FAILURE;
+  }
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+  std::string output_path(argv[1]);
+  vector_map::BinaryMap bmap;
+  for (int i = 2; i < argc; ++i)
+  {
+    std::string file_path(argv[i]);
+    if (bmap.addCsv(file_path) != vector_map::Category::NONE)
+      continue;
+    std::string file_name(basename(argv[i]));
+    if (file_name != "idx.csv")  // XXX: This version of Autoware don't support index csv file now.
+      ROS_ERROR_STREAM("unknown csv file: " << file_path);
+  }
+
+  if (bmap.getCategory() == vector_map::Category::NONE)
+  {
+    ROS_ERROR_STREAM("no vector map table in the csv files");
+    return EXIT_FAILURE;
+  }
+
+  if (!bmap.save(output_path))
+  {
+    ROS_ERROR_STREAM("failed to write " << output_path);
+    return EXIT_FAILURE;
+  }
+
+  for (vector_map::category_t category = 1; category <= vector_map::Category::RAIL_CROSSING; category <<= 1)
+  {
+    if (bmap.getCategory() & category)
+      ROS_INFO_STREAM(vector_map::getCsvFileName(category) << ": " << bmap.getRows(category) << " rows");
+  }
+  double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  ROS_INFO_STREAM("compiled " << output_path << " in " << elapsed << " s");
+
+  return EXIT_SUCCESS;
+}
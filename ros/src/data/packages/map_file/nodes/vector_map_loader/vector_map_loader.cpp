@@ -17,6 +17,7 @@
 #include <ros/console.h>
 #include <std_msgs/Bool.h>
 #include <visualization_msgs/MarkerArray.h>
+#include <vector_map/binary_map.h>
 #include <vector_map/vector_map.h>
 #include <map_file/get_file.h>
 #include <sys/stat.h>
@@ -103,6 +104,7 @@ void printUsage()
 {
   ROS_ERROR_STREAM("Usage:");
   ROS_ERROR_STREAM("rosrun map_file vector_map_loader [CSV]...");
+  ROS_ERROR_STREAM("rosrun map_file vector_map_loader [VMB]");
   ROS_ERROR_STREAM("rosrun map_file vector_map_loader download [X] [Y]");
 }
 
@@ -124,6 +126,18 @@ U createObjectArray(const std::string& file_path)
   return obj_array;
 }
 
+template <class U>
+vector_map::category_t publishObjectArray(const vector_map::BinaryMap& bmap, vector_map::category_t category,
+                                          const ros::Publisher& pub)
+{
+  U obj_array;
+  if (!bmap.get(category, obj_array))
+    return Category::NONE;
+  obj_array.header.frame_id = "map";
+  pub.publish(obj_array);
+  return category;
+}
+
 visualization_msgs::Marker createLinkedLineMarker(const std::string& ns, int id, Color color, const VectorMap& vmap,
                                                   const Line& line)
 {
@@ -1065,6 +1079,47 @@ int main(int argc, char **argv)
     {
       ; // XXX: This version of Autoware don't support index csv file now.
     }
+    else if (file_name.size() > 4 && file_name.compare(file_name.size() - 4, 4, ".vmb") == 0)
+    {
+      vector_map::BinaryMap bmap;
+      if (!bmap.load(file_path))
+      {
+        ROS_ERROR_STREAM("failed to load compiled vector map: " << file_path);
+        continue;
+      }
+      category |= publishObjectArray<PointArray>(bmap, Category::POINT, point_pub);
+      category |= publishObjectArray<VectorArray>(bmap, Category::VECTOR, vector_pub);
+      category |= publishObjectArray<LineArray>(bmap, Category::LINE, line_pub);
+      category |= publishObjectArray<AreaArray>(bmap, Category::AREA, area_pub);
+      category |= publishObjectArray<PoleArray>(bmap, Category::POLE, pole_pub);
+      category |= publishObjectArray<BoxArray>(bmap, Category::BOX, box_pub);
+      category |= publishObjectArray<DTLaneArray>(bmap, Category::DTLANE, dtlane_pub);
+      category |= publishObjectArray<NodeArray>(bmap, Category::NODE, node_pub);
+      category |= publishObjectArray<LaneArray>(bmap, Category::LANE, lane_pub);
+      category |= publishObjectArray<WayAreaArray>(bmap, Category::WAY_AREA, way_area_pub);
+      category |= publishObjectArray<RoadEdgeArray>(bmap, Category::ROAD_EDGE, road_edge_pub);
+      category |= publishObjectArray<GutterArray>(bmap, Category::GUTTER, gutter_pub);
+      category |= publishObjectArray<CurbArray>(bmap, Category::CURB, curb_pub);
+      category |= publishObjectArray<WhiteLineArray>(bmap, Category::WHITE_LINE, white_line_pub);
+      category |= publishObjectArray<StopLineArray>(bmap, Category::STOP_LINE, stop_line_pub);
+      category |= publishObjectArray<ZebraZoneArray>(bmap, Category::ZEBRA_ZONE, zebra_zone_pub);
+      category |= publishObjectArray<CrossWalkArray>(bmap, Category::CROSS_WALK, cross_walk_pub);
+      category |= publishObjectArray<RoadMarkArray>(bmap, Category::ROAD_MARK, road_mark_pub);
+      category |= publishObjectArray<RoadPoleArray>(bmap, Category::ROAD_POLE, road_pole_pub);
+      category |= publishObjectArray<RoadSignArray>(bmap, Category::ROAD_SIGN, road_sign_pub);
+      category |= publishObjectArray<SignalArray>(bmap, Category::SIGNAL, signal_pub);
+      category |= publishObjectArray<StreetLightArray>(bmap, Category::STREET_LIGHT, street_light_pub);
+      category |= publishObjectArray<UtilityPoleArray>(bmap, Category::UTILITY_POLE, utility_pole_pub);
+      category |= publishObjectArray<GuardRailArray>(bmap, Category::GUARD_RAIL, guard_rail_pub);
+      category |= publishObjectArray<SideWalkArray>(bmap, Category::SIDE_WALK, side_walk_pub);
+      category |= publishObjectArray<DriveOnPortionArray>(bmap, Category::DRIVE_ON_PORTION, drive_on_portion_pub);
+      category |= publishObjectArray<CrossRoadArray>(bmap, Category::CROSS_ROAD, cross_road_pub);
+      category |= publishObjectArray<SideStripArray>(bmap, Category::SIDE_STRIP, side_strip_pub);
+      category |= publishObjectArray<CurveMirrorArray>(bmap, Category::CURVE_MIRROR, curve_mirror_pub);
+      category |= publishObjectArray<WallArray>(bmap, Category::WALL, wall_pub);
+      category |= publishObjectArray<FenceArray>(bmap, Category::FENCE, fence_pub);
+      category |= publishObjectArray<RailCrossingArray>(bmap, Category::RAIL_CROSSING, rail_crossing_pub);
+    }
     else if (file_name == "point.csv")
     {
       point_pub.publish(createObjectArray<Point, PointArray>(file_path));
@@ -0,0 +1,91 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef VECTOR_MAP_BINARY_MAP_H
+#define VECTOR_MAP_BINARY_MAP_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <ros/serialization.h>
+#include <vector_map/vector_map.h>
+
+namespace vector_map
+{
+// Compiled vector map: all the tables of a vector map in one file, loaded with a single read instead of parsing tens
+// of csv files. The file is a header, a directory of the tables and the tables, each serialized as its
+// vector_map_msgs array. The directory gives the position of every table, which is deserialized only when asked for.
+class BinaryMap
+{
+private:
+  struct Table
+  {
+    uint32_t rows;
+    uint64_t offset;  // in data_
+    uint64_t size;
+  };
+
+  std::map<category_t, Table> tables_;
+  std::vector<uint8_t> data_;
+
+public:
+  static const char MAGIC[8];
+  static const uint32_t VERSION;
+
+  // Reads a compiled vector map. Returns false if the file can not be read or is not a compiled vector map
+  bool load(const std::string& file_path);
+  bool save(const std::string& file_path) const;
+
+  // Parses a csv file of a vector map into its table, the table is chosen by the file name as vector_map_loader does.
+  // Returns the category of the table, NONE if the file is not a table of a vector map
+  category_t addCsv(const std::string& csv_file);
+
+  // Categories of the tables in the map
+  category_t getCategory() const;
+  size_t getRows(category_t category) const;
+
+  template <class U>
+  void add(category_t category, const U& obj_array)
+  {
+    Table table;
+    table.rows = obj_array.data.size();
+    table.offset = data_.size();
+    table.size = ros::serialization::serializationLength(obj_array);
+    data_.resize(table.offset + table.size);
+    ros::serialization::OStream stream(data_.data() + table.offset, table.size);
+    ros::serialization::serialize(stream, obj_array);
+    tables_[category] = table;
+  }
+
+  template <class U>
+  bool get(category_t category, U& obj_array) const
+  {
+    auto it = tables_.find(category);
+    if (it == tables_.end())
+      return false;
+    ros::serialization::IStream stream(const_cast<uint8_t*>(data_.data()) + it->second.offset, it->second.size);
+    ros::serialization::deserialize(stream, obj_array);
+    return true;
+  }
+};
+
+// Name of the csv file of the table of category, empty if unknown
+std::string getCsvFileName(category_t category);
+} // namespace vector_map
+
+#endif // VECTOR_MAP_BINARY_MAP_H
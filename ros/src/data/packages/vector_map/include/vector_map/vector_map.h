@@ -17,7 +17,12 @@
 #ifndef VECTOR_MAP_VECTOR_MAP_H
 #define VECTOR_MAP_VECTOR_MAP_H
 
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
+#include <unordered_map>
+#include <utility>
 #include <ros/ros.h>
 #include <geometry_msgs/Point.h>
 #include <geometry_msgs/Quaternion.h>
@@ -222,6 +227,91 @@ public:
   }
 };
 
+// Index of objects by id with O(1) lookups: a table of slots when the ids are dense enough, a hash table otherwise.
+// The objects are not owned and must not move while they are indexed.
+template <class T>
+class IdIndex
+{
+private:
+  int min_id_;
+  std::vector<T*> slots_;
+  std::unordered_map<int, T*> hash_;
+
+public:
+  IdIndex()
+    : min_id_(0)
+  {
+  }
+
+  void build(const std::vector<std::pair<int, T*>>& items)
+  {
+    clear();
+    if (items.empty())
+      return;
+
+    int min_id = items.front().first;
+    int max_id = items.front().first;
+    for (const auto& item : items)
+    {
+      min_id = std::min(min_id, item.first);
+      max_id = std::max(max_id, item.first);
+    }
+
+    // a slot is smaller than a hash node, a few empty slots per object are still cheaper
+    long long span = static_cast<long long>(max_id) - min_id + 1;
+    if (span <= 4 * static_cast<long long>(items.size()) + 64)
+    {
+      min_id_ = min_id;
+      slots_.assign(static_cast<size_t>(span), nullptr);
+      for (const auto& item : items)
+        slots_[item.first - min_id] = item.second;
+    }
+    else
+    {
+      hash_.reserve(items.size());
+      for (const auto& item : items)
+        hash_[item.first] = item.second;
+    }
+  }
+
+  template <class U>
+  void build(std::vector<U>& objs, int U::*id)
+  {
+    std::vector<std::pair<int, T*>> items;
+    items.reserve(objs.size());
+    for (auto& obj : objs)
+      items.push_back(std::make_pair(obj.*id, &obj));
+    build(items);
+  }
+
+  T* find(int id) const
+  {
+    if (!slots_.empty())
+    {
+      long long index = static_cast<long long>(id) - min_id_;
+      if (index < 0 || index >= static_cast<long long>(slots_.size()))
+        return nullptr;
+      return slots_[index];
+    }
+    auto it = hash_.find(id);
+    if (it == hash_.end())
+      return nullptr;
+    return it->second;
+  }
+
+  bool empty() const
+  {
+    return slots_.empty() && hash_.empty();
+  }
+
+  void clear()
+  {
+    min_id_ = 0;
+    slots_.clear();
+    hash_.clear();
+  }
+};
+
 template <class T, class U>
 using Updater = std::function<void(std::map<Key<T>, T>&, const U&)>;
 
@@ -239,10 +329,16 @@ private:
   Updater<T, U> update_;
   std::vector<Callback<U>> cbs_;
   std::map<Key<T>, T> map_;
+  IdIndex<const T> index_;
 
   void subscribe(const U& msg)
   {
     update_(map_, msg);
+    std::vector<std::pair<int, const T*>> items;
+    items.reserve(map_.size());
+    for (const auto& pair : map_)
+      items.push_back(std::make_pair(pair.first.getId(), &pair.second));
+    index_.build(items);
     for (const auto& cb : cbs_)
       cb(msg);
   }
@@ -267,12 +363,18 @@ public:
     cbs_.push_back(cb);
   }
 
+  // Updates the objects as if msg had been received
+  void load(const U& msg)
+  {
+    subscribe(msg);
+  }
+
   T findByKey(const Key<T>& key) const
   {
-    auto it = map_.find(key);
-    if (it == map_.end())
+    const T* obj = index_.find(key.getId());
+    if (obj == nullptr)
       return T();
-    return it->second;
+    return *obj;
   }
 
   std::vector<T> findByFilter(const Filter<T>& filter) const
@@ -292,19 +394,99 @@ public:
   }
 };
 
+// One row of a vector map csv file, split in place into its columns
+class CsvRow
+{
+private:
+  std::vector<const char*> columns_;
+
+public:
+  // Splits the null-terminated line at its commas, which are overwritten, and drops the quotes around columns
+  void split(char* line);
+
+  size_t size() const
+  {
+    return columns_.size();
+  }
+
+  int toInt(size_t i) const
+  {
+    return i < columns_.size() ? static_cast<int>(std::strtol(columns_[i], nullptr, 10)) : 0;
+  }
+
+  double toDouble(size_t i) const
+  {
+    return i < columns_.size() ? std::strtod(columns_[i], nullptr) : 0.0;
+  }
+
+  char toChar(size_t i) const
+  {
+    return i < columns_.size() ? columns_[i][0] : '\0';
+  }
+};
+
+// Reads a whole file in one go, buffer always ends with a newline
+bool readCsvFile(const std::string& csv_file, std::string& buffer);
+
+void parseRow(const CsvRow& row, Point& obj);
+void parseRow(const CsvRow& row, Vector& obj);
+void parseRow(const CsvRow& row, Line& obj);
+void parseRow(const CsvRow& row, Area& obj);
+void parseRow(const CsvRow& row, Pole& obj);
+void parseRow(const CsvRow& row, Box& obj);
+void parseRow(const CsvRow& row, DTLane& obj);
+void parseRow(const CsvRow& row, Node& obj);
+void parseRow(const CsvRow& row, Lane& obj);
+void parseRow(const CsvRow& row, WayArea& obj);
+void parseRow(const CsvRow& row, RoadEdge& obj);
+void parseRow(const CsvRow& row, Gutter& obj);
+void parseRow(const CsvRow& row, Curb& obj);
+void parseRow(const CsvRow& row, WhiteLine& obj);
+void parseRow(const CsvRow& row, StopLine& obj);
+void parseRow(const CsvRow& row, ZebraZone& obj);
+void parseRow(const CsvRow& row, CrossWalk& obj);
+void parseRow(const CsvRow& row, RoadMark& obj);
+void parseRow(const CsvRow& row, RoadPole& obj);
+void parseRow(const CsvRow& row, RoadSign& obj);
+void parseRow(const CsvRow& row, Signal& obj);
+void parseRow(const CsvRow& row, StreetLight& obj);
+void parseRow(const CsvRow& row, UtilityPole& obj);
+void parseRow(const CsvRow& row, GuardRail& obj);
+void parseRow(const CsvRow& row, SideWalk& obj);
+void parseRow(const CsvRow& row, DriveOnPortion& obj);
+void parseRow(const CsvRow& row, CrossRoad& obj);
+void parseRow(const CsvRow& row, SideStrip& obj);
+void parseRow(const CsvRow& row, CurveMirror& obj);
+void parseRow(const CsvRow& row, Wall& obj);
+void parseRow(const CsvRow& row, Fence& obj);
+void parseRow(const CsvRow& row, RailCrossing& obj);
+
 template <class T>
 std::vector<T> parse(const std::string& csv_file)
 {
-  std::ifstream ifs(csv_file.c_str());
-  std::string line;
-  std::getline(ifs, line); // remove first line
   std::vector<T> objs;
-  while (std::getline(ifs, line))
+  std::string buffer;
+  if (!readCsvFile(csv_file, buffer))
+    return objs;
+  objs.reserve(std::count(buffer.begin(), buffer.end(), '\n'));
+
+  CsvRow row;
+  char* end = &buffer[0] + buffer.size();
+  char* line = static_cast<char*>(std::memchr(&buffer[0], '\n', buffer.size())) + 1; // remove first line
+  while (line < end)
   {
-    T obj;
-    std::istringstream iss(line);
-    iss >> obj;
-    objs.push_back(obj);
+    char* eol = static_cast<char*>(std::memchr(line, '\n', end - line));
+    *eol = '\0';
+    if (eol > line && eol[-1] == '\r')
+      eol[-1] = '\0';
+    row.split(line);
+    if (row.size() > 0)
+    {
+      T obj;
+      parseRow(row, obj);
+      objs.push_back(obj);
+    }
+    line = eol + 1;
   }
   return objs;
 }
@@ -345,6 +527,8 @@ std::vector<T> parse(const std::string& csv_file)
 /* void updateRailCrossing(std::map<Key<RailCrossing>, RailCrossing>& map, const RailCrossingArray& msg); */
 /* } // namespace */
 
+class BinaryMap;
+
 class VectorMap
 {
 private:
@@ -391,6 +575,10 @@ public:
   void subscribe(ros::NodeHandle& nh, category_t category, const ros::Duration& timeout);
   void subscribe(ros::NodeHandle& nh, category_t category, const size_t max_retries);
 
+  // Loads the tables of category from a compiled vector map instead of subscribing to them.
+  // Returns the categories found in bmap
+  category_t load(const BinaryMap& bmap, category_t category);
+
   Point findByKey(const Key<Point>& key) const;
   Vector findByKey(const Key<Vector>& key) const;
   Line findByKey(const Key<Line>& key) const;
@@ -0,0 +1,215 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <libgen.h>
+
+#include <cstring>
+#include <fstream>
+
+#include <vector_map/binary_map.h>
+
+namespace vector_map
+{
+namespace
+{
+template <class T, class U>
+void addCsvTable(BinaryMap& bmap, category_t category, const std::string& csv_file)
+{
+  U obj_array;
+  obj_array.header.frame_id = "map";
+  obj_array.data = parse<T>(csv_file);
+  bmap.add(category, obj_array);
+}
+
+struct CsvTable
+{
+  const char* file_name;
+  category_t category;
+  void (*add)(BinaryMap&, category_t, const std::string&);
+};
+
+const CsvTable CSV_TABLES[] =
+{
+  { "point.csv", POINT, addCsvTable<Point, PointArray> },
+  { "vector.csv", VECTOR, addCsvTable<Vector, VectorArray> },
+  { "line.csv", LINE, addCsvTable<Line, LineArray> },
+  { "area.csv", AREA, addCsvTable<Area, AreaArray> },
+  { "pole.csv", POLE, addCsvTable<Pole, PoleArray> },
+  { "box.csv", BOX, addCsvTable<Box, BoxArray> },
+  { "dtlane.csv", DTLANE, addCsvTable<DTLane, DTLaneArray> },
+  { "node.csv", NODE, addCsvTable<Node, NodeArray> },
+  { "lane.csv", LANE, addCsvTable<Lane, LaneArray> },
+  { "wayarea.csv", WAY_AREA, addCsvTable<WayArea, WayAreaArray> },
+  { "roadedge.csv", ROAD_EDGE, addCsvTable<RoadEdge, RoadEdgeArray> },
+  { "gutter.csv", GUTTER, addCsvTable<Gutter, GutterArray> },
+  { "curb.csv", CURB, addCsvTable<Curb, CurbArray> },
+  { "whiteline.csv", WHITE_LINE, addCsvTable<WhiteLine, WhiteLineArray> },
+  { "stopline.csv", STOP_LINE, addCsvTable<StopLine, StopLineArray> },
+  { "zebrazone.csv", ZEBRA_ZONE, addCsvTable<ZebraZone, ZebraZoneArray> },
+  { "crosswalk.csv", CROSS_WALK, addCsvTable<CrossWalk, CrossWalkArray> },
+  { "road_surface_mark.csv", ROAD_MARK, addCsvTable<RoadMark, RoadMarkArray> },
+  { "poledata.csv", ROAD_POLE, addCsvTable<RoadPole, RoadPoleArray> },
+  { "roadsign.csv", ROAD_SIGN, addCsvTable<RoadSign, RoadSignArray> },
+  { "signaldata.csv", SIGNAL, addCsvTable<Signal, SignalArray> },
+  { "streetlight.csv", STREET_LIGHT, addCsvTable<StreetLight, StreetLightArray> },
+  { "utilitypole.csv", UTILITY_POLE, addCsvTable<UtilityPole, UtilityPoleArray> },
+  { "guardrail.csv", GUARD_RAIL, addCsvTable<GuardRail, GuardRailArray> },
+  { "sidewalk.csv", SIDE_WALK, addCsvTable<SideWalk, SideWalkArray> },
+  { "driveon_portion.csv", DRIVE_ON_PORTION, addCsvTable<DriveOnPortion, DriveOnPortionArray> },
+  { "intersection.csv", CROSS_ROAD, addCsvTable<CrossRoad, CrossRoadArray> },
+  { "sidestrip.csv", SIDE_STRIP, addCsvTable<SideStrip, SideStripArray> },
+  { "curvemirror.csv", CURVE_MIRROR, addCsvTable<CurveMirror, CurveMirrorArray> },
+  { "wall.csv", WALL, addCsvTable<Wall, WallArray> },
+  { "fence.csv", FENCE, addCsvTable<Fence, FenceArray> },
+  { "railroad_crossing.csv", RAIL_CROSSING, addCsvTable<RailCrossing, RailCrossingArray> }
+};
+
+template <class T>
+void write(std::ofstream& ofs, const T& value)
+{
+  ofs.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <class T>
+bool read(std::ifstream& ifs, T& value)
+{
+  return static_cast<bool>(ifs.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+} // namespace
+
+const char BinaryMap::MAGIC[8] = { 'V', 'M', 'A', 'P', 'B', 'I', 'N', '\0' };
+const uint32_t BinaryMap::VERSION = 1;
+
+bool BinaryMap::load(const std::string& file_path)
+{
+  tables_.clear();
+  data_.clear();
+
+  std::ifstream ifs(file_path.c_str(), std::ios::binary);
+  if (!ifs)
+    return false;
+
+  char magic[sizeof(MAGIC)];
+  uint32_t version;
+  uint32_t table_count;
+  if (!ifs.read(magic, sizeof(magic)) || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 || !read(ifs, version) ||
+      version != VERSION || !read(ifs, table_count))
+    return false;
+
+  std::map<category_t, Table> tables;
+  for (uint32_t i = 0; i < table_count; ++i)
+  {
+    category_t category;
+    Table table;
+    if (!read(ifs, category) || !read(ifs, table.rows) || !read(ifs, table.offset) || !read(ifs, table.size))
+      return false;
+    tables[category] = table;
+  }
+
+  // the tables follow the directory up to the end of the file
+  std::streamoff begin = ifs.tellg();
+  ifs.seekg(0, std::ios::end);
+  std::streamoff end = ifs.tellg();
+  ifs.seekg(begin, std::ios::beg);
+  if (begin < 0 || end < begin)
+    return false;
+  data_.resize(static_cast<size_t>(end - begin));
+  if (!data_.empty() && !ifs.read(reinterpret_cast<char*>(data_.data()), data_.size()))
+  {
+    data_.clear();
+    return false;
+  }
+
+  for (const auto& pair : tables)
+  {
+    if (pair.second.offset > data_.size() || pair.second.size > data_.size() - pair.second.offset)
+    {
+      data_.clear();
+      return false;
+    }
+  }
+  tables_.swap(tables);
+  return true;
+}
+
+bool BinaryMap::save(const std::string& file_path) const
+{
+  std::ofstream ofs(file_path.c_str(), std::ios::binary | std::ios::trunc);
+  if (!ofs)
+    return false;
+
+  ofs.write(MAGIC, sizeof(MAGIC));
+  write(ofs, VERSION);
+  write(ofs, static_cast<uint32_t>(tables_.size()));
+
+  // tables replaced by add() leave holes in data_, which are not written
+  uint64_t offset = 0;
+  for (const auto& pair : tables_)
+  {
+    write(ofs, pair.first);
+    write(ofs, pair.second.rows);
+    write(ofs, offset);
+    write(ofs, pair.second.size);
+    offset += pair.second.size;
+  }
+  for (const auto& pair : tables_)
+    ofs.write(reinterpret_cast<const char*>(data_.data() + pair.second.offset), pair.second.size);
+
+  return static_cast<bool>(ofs);
+}
+
+category_t BinaryMap::addCsv(const std::string& csv_file)
+{
+  std::vector<char> path(csv_file.begin(), csv_file.end());
+  path.push_back('\0');
+  std::string file_name(basename(path.data()));
+  for (const auto& table : CSV_TABLES)
+  {
+    if (file_name == table.file_name)
+    {
+      table.add(*this, table.category, csv_file);
+      return table.category;
+    }
+  }
+  return Category::NONE;
+}
+
+category_t BinaryMap::getCategory() const
+{
+  category_t category = Category::NONE;
+  for (const auto& pair : tables_)
+    category |= pair.first;
+  return category;
+}
+
+size_t BinaryMap::getRows(category_t category) const
+{
+  auto it = tables_.find(category);
+  if (it == tables_.end())
+    return 0;
+  return it->second.rows;
+}
+
+std::string getCsvFileName(category_t category)
+{
+  for (const auto& table : CSV_TABLES)
+  {
+    if (table.category == category)
+      return table.file_name;
+  }
+  return std::string();
+}
+} // namespace vector_map
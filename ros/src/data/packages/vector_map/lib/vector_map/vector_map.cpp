@@ -15,6 +15,7 @@
  */
 
 #include <tf/transform_datatypes.h>
+#include <vector_map/binary_map.h>
 #include <vector_map/vector_map.h>
 
 namespace vector_map
@@ -372,6 +373,18 @@ void updateRailCrossing(std::map<Key<RailCrossing>, RailCrossing>& map, const Ra
     map.insert(std::make_pair(Key<RailCrossing>(item.id), item));
   }
 }
+
+template <class T, class U>
+category_t loadTable(const BinaryMap& bmap, category_t category, Handle<T, U>& handle,
+                     void (*update)(std::map<Key<T>, T>&, const U&))
+{
+  U msg;
+  if (!bmap.get(category, msg))
+    return Category::NONE;
+  handle.registerUpdater(update);
+  handle.load(msg);
+  return category;
+}
 } // namespace
 
 bool VectorMap::hasSubscribed(category_t category) const
@@ -742,6 +755,76 @@ void VectorMap::subscribe(ros::NodeHandle& nh, category_t category, const size_t
   }
 }
 
+category_t VectorMap::load(const BinaryMap& bmap, category_t category)
+{
+  category_t loaded = Category::NONE;
+  if (category & POINT)
+    loaded |= loadTable(bmap, POINT, point_, updatePoint);
+  if (category & VECTOR)
+    loaded |= loadTable(bmap, VECTOR, vector_, updateVector);
+  if (category & LINE)
+    loaded |= loadTable(bmap, LINE, line_, updateLine);
+  if (category & AREA)
+    loaded |= loadTable(bmap, AREA, area_, updateArea);
+  if (category & POLE)
+    loaded |= loadTable(bmap, POLE, pole_, updatePole);
+  if (category & BOX)
+    loaded |= loadTable(bmap, BOX, box_, updateBox);
+  if (category & DTLANE)
+    loaded |= loadTable(bmap, DTLANE, dtlane_, updateDTLane);
+  if (category & NODE)
+    loaded |= loadTable(bmap, NODE, node_, updateNode);
+  if (category & LANE)
+    loaded |= loadTable(bmap, LANE, lane_, updateLane);
+  if (category & WAY_AREA)
+    loaded |= loadTable(bmap, WAY_AREA, way_area_, updateWayArea);
+  if (category & ROAD_EDGE)
+    loaded |= loadTable(bmap, ROAD_EDGE, road_edge_, updateRoadEdge);
+  if (category & GUTTER)
+    loaded |= loadTable(bmap, GUTTER, gutter_, updateGutter);
+  if (category & CURB)
+    loaded |= loadTable(bmap, CURB, curb_, updateCurb);
+  if (category & WHITE_LINE)
+    loaded |= loadTable(bmap, WHITE_LINE, white_line_, updateWhiteLine);
+  if (category & STOP_LINE)
+    loaded |= loadTable(bmap, STOP_LINE, stop_line_, updateStopLine);
+  if (category & ZEBRA_ZONE)
+    loaded |= loadTable(bmap, ZEBRA_ZONE, zebra_zone_, updateZebraZone);
+  if (category & CROSS_WALK)
+    loaded |= loadTable(bmap, CROSS_WALK, cross_walk_, updateCrossWalk);
+  if (category & ROAD_MARK)
+    loaded |= loadTable(bmap, ROAD_MARK, road_mark_, updateRoadMark);
+  if (category & ROAD_POLE)
+    loaded |= loadTable(bmap, ROAD_POLE, road_pole_, updateRoadPole);
+  if (category & ROAD_SIGN)
+    loaded |= loadTable(bmap, ROAD_SIGN, road_sign_, updateRoadSign);
+  if (category & SIGNAL)
+    loaded |= loadTable(bmap, SIGNAL, signal_, updateSignal);
+  if (category & STREET_LIGHT)
+    loaded |= loadTable(bmap, STREET_LIGHT, street_light_, updateStreetLight);
+  if (category & UTILITY_POLE)
+    loaded |= loadTable(bmap, UTILITY_POLE, utility_pole_, updateUtilityPole);
+  if (category & GUARD_RAIL)
+    loaded |= loadTable(bmap, GUARD_RAIL, guard_rail_, updateGuardRail);
+  if (category & SIDE_WALK)
+    loaded |= loadTable(bmap, SIDE_WALK, side_walk_, updateSideWalk);
+  if (category & DRIVE_ON_PORTION)
+    loaded |= loadTable(bmap, DRIVE_ON_PORTION, drive_on_portion_, updateDriveOnPortion);
+  if (category & CROSS_ROAD)
+    loaded |= loadTable(bmap, CROSS_ROAD, cross_road_, updateCrossRoad);
+  if (category & SIDE_STRIP)
+    loaded |= loadTable(bmap, SIDE_STRIP, side_strip_, updateSideStrip);
+  if (category & CURVE_MIRROR)
+    loaded |= loadTable(bmap, CURVE_MIRROR, curve_mirror_, updateCurveMirror);
+  if (category & WALL)
+    loaded |= loadTable(bmap, WALL, wall_, updateWall);
+  if (category & FENCE)
+    loaded |= loadTable(bmap, FENCE, fence_, updateFence);
+  if (category & RAIL_CROSSING)
+    loaded |= loadTable(bmap, RAIL_CROSSING, rail_crossing_, updateRailCrossing);
+  return loaded;
+}
+
 Point VectorMap::findByKey(const Key<Point>& key) const
 {
   return point_.findByKey(key);
@@ -1943,166 +2026,149 @@ std::ostream& operator<<(std::ostream& os, const vector_map::RailCrossing& obj)
   return os;
 }
 
-std::istream& operator>>(std::istream& is, vector_map::Point& obj)
+namespace vector_map
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.pid = std::stoi(columns[0]);
-  obj.b = std::stod(columns[1]);
-  obj.l = std::stod(columns[2]);
-  obj.h = std::stod(columns[3]);
-  obj.bx = std::stod(columns[4]);
-  obj.ly = std::stod(columns[5]);
-  obj.ref = std::stoi(columns[6]);
-  obj.mcode1 = std::stoi(columns[7]);
-  obj.mcode2 = std::stoi(columns[8]);
-  obj.mcode3 = std::stoi(columns[9]);
-  return is;
+void CsvRow::split(char* line)
+{
+  columns_.clear();
+  if (*line == '\0')
+    return;
+  for (char* c = line;;)
+  {
+    // the quotes around a column are dropped, a separator between them is part of the column
+    char* quote = *c == '"' ? std::strchr(c + 1, '"') : nullptr;
+    if (quote != nullptr)
+    {
+      columns_.push_back(c + 1);
+      *quote = '\0';
+      c = quote + 1;
+    }
+    else
+      columns_.push_back(c);
+    c += std::strcspn(c, ",");
+    if (*c == '\0')
+      return;
+    *c++ = '\0';
+    // like std::getline, a trailing separator does not start a column
+    if (*c == '\0')
+      return;
+  }
+}
+
+bool readCsvFile(const std::string& csv_file, std::string& buffer)
+{
+  std::ifstream ifs(csv_file.c_str(), std::ios::binary);
+  if (!ifs)
+    return false;
+  ifs.seekg(0, std::ios::end);
+  std::streamoff size = ifs.tellg();
+  ifs.seekg(0, std::ios::beg);
+  if (size < 0)
+    return false;
+  buffer.resize(static_cast<size_t>(size));
+  if (size > 0 && !ifs.read(&buffer[0], size))
+    return false;
+  if (buffer.empty() || buffer.back() != '\n')
+    buffer.push_back('\n');
+  return true;
 }
 
-std::istream& operator>>(std::istream& is, vector_map::Vector& obj)
+void parseRow(const CsvRow& row, Point& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.vid = std::stoi(columns[0]);
-  obj.pid = std::stoi(columns[1]);
-  obj.hang = std::stod(columns[2]);
-  obj.vang = std::stod(columns[3]);
-  return is;
+  obj.pid = row.toInt(0);
+  obj.b = row.toDouble(1);
+  obj.l = row.toDouble(2);
+  obj.h = row.toDouble(3);
+  obj.bx = row.toDouble(4);
+  obj.ly = row.toDouble(5);
+  obj.ref = row.toInt(6);
+  obj.mcode1 = row.toInt(7);
+  obj.mcode2 = row.toInt(8);
+  obj.mcode3 = row.toInt(9);
 }
 
-std::istream& operator>>(std::istream& is, vector_map::Line& obj)
+void parseRow(const CsvRow& row, Vector& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.lid = std::stoi(columns[0]);
-  obj.bpid = std::stoi(columns[1]);
-  obj.fpid = std::stoi(columns[2]);
-  obj.blid = std::stoi(columns[3]);
-  obj.flid = std::stoi(columns[4]);
-  return is;
+  obj.vid = row.toInt(0);
+  obj.pid = row.toInt(1);
+  obj.hang = row.toDouble(2);
+  obj.vang = row.toDouble(3);
 }
 
-std::istream& operator>>(std::istream& is, vector_map::Area& obj)
+void parseRow(const CsvRow& row, Line& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.aid = std::stoi(columns[0]);
-  obj.slid = std::stoi(columns[1]);
-  obj.elid = std::stoi(columns[2]);
-  return is;
+  obj.lid = row.toInt(0);
+  obj.bpid = row.toInt(1);
+  obj.fpid = row.toInt(2);
+  obj.blid = row.toInt(3);
+  obj.flid = row.toInt(4);
 }
 
-std::istream& operator>>(std::istream& is, vector_map::Pole& obj)
+void parseRow(const CsvRow& row, Area& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.plid = std::stoi(columns[0]);
-  obj.vid = std::stoi(columns[1]);
-  obj.length = std::stod(columns[2]);
-  obj.dim = std::stod(columns[3]);
-  return is;
+  obj.aid = row.toInt(0);
+  obj.slid = row.toInt(1);
+  obj.elid = row.toInt(2);
 }
 
-std::istream& operator>>(std::istream& is, vector_map::Box& obj)
+void parseRow(const CsvRow& row, Pole& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.bid = std::stoi(columns[0]);
-  obj.pid1 = std::stoi(columns[1]);
-  obj.pid2 = std::stoi(columns[2]);
-  obj.pid3 = std::stoi(columns[3]);
-  obj.pid4 = std::stoi(columns[4]);
-  obj.height = std::stod(columns[5]);
-  return is;
+  obj.plid = row.toInt(0);
+  obj.vid = row.toInt(1);
+  obj.length = row.toDouble(2);
+  obj.dim = row.toDouble(3);
 }
 
-std::istream& operator>>(std::istream& is, vector_map::DTLane& obj)
+void parseRow(const CsvRow& row, Box& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.did = std::stoi(columns[0]);
-  obj.dist = std::stod(columns[1]);
-  obj.pid = std::stoi(columns[2]);
-  obj.dir = std::stod(columns[3]);
-  obj.apara = std::stod(columns[4]);
-  obj.r = std::stod(columns[5]);
-  obj.slope = std::stod(columns[6]);
-  obj.cant = std::stod(columns[7]);
-  obj.lw = std::stod(columns[8]);
-  obj.rw = std::stod(columns[9]);
-  return is;
+  obj.bid = row.toInt(0);
+  obj.pid1 = row.toInt(1);
+  obj.pid2 = row.toInt(2);
+  obj.pid3 = row.toInt(3);
+  obj.pid4 = row.toInt(4);
+  obj.height = row.toDouble(5);
 }
 
-std::istream& operator>>(std::istream& is, vector_map::Node& obj)
+void parseRow(const CsvRow& row, DTLane& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.nid = std::stoi(columns[0]);
-  obj.pid = std::stoi(columns[1]);
-  return is;
+  obj.did = row.toInt(0);
+  obj.dist = row.toDouble(1);
+  obj.pid = row.toInt(2);
+  obj.dir = row.toDouble(3);
+  obj.apara = row.toDouble(4);
+  obj.r = row.toDouble(5);
+  obj.slope = row.toDouble(6);
+  obj.cant = row.toDouble(7);
+  obj.lw = row.toDouble(8);
+  obj.rw = row.toDouble(9);
 }
 
-std::istream& operator>>(std::istream& is, vector_map::Lane& obj)
+void parseRow(const CsvRow& row, Node& obj)
+{
+  obj.nid = row.toInt(0);
+  obj.pid = row.toInt(1);
+}
+
+void parseRow(const CsvRow& row, Lane& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  int n = 0;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-    ++n;
-  }
-  obj.lnid = std::stoi(columns[0]);
-  obj.did = std::stoi(columns[1]);
-  obj.blid = std::stoi(columns[2]);
-  obj.flid = std::stoi(columns[3]);
-  obj.bnid = std::stoi(columns[4]);
-  obj.fnid = std::stoi(columns[5]);
-  obj.jct = std::stoi(columns[6]);
-  obj.blid2 = std::stoi(columns[7]);
-  obj.blid3 = std::stoi(columns[8]);
-  obj.blid4 = std::stoi(columns[9]);
-  obj.flid2 = std::stoi(columns[10]);
-  obj.flid3 = std::stoi(columns[11]);
-  obj.flid4 = std::stoi(columns[12]);
-  obj.clossid = std::stoi(columns[13]);
-  obj.span = std::stod(columns[14]);
-  obj.lcnt = std::stoi(columns[15]);
-  obj.lno = std::stoi(columns[16]);
-  if (n == 17)
+  obj.lnid = row.toInt(0);
+  obj.did = row.toInt(1);
+  obj.blid = row.toInt(2);
+  obj.flid = row.toInt(3);
+  obj.bnid = row.toInt(4);
+  obj.fnid = row.toInt(5);
+  obj.jct = row.toInt(6);
+  obj.blid2 = row.toInt(7);
+  obj.blid3 = row.toInt(8);
+  obj.blid4 = row.toInt(9);
+  obj.flid2 = row.toInt(10);
+  obj.flid3 = row.toInt(11);
+  obj.flid4 = row.toInt(12);
+  obj.clossid = row.toInt(13);
+  obj.span = row.toDouble(14);
+  obj.lcnt = row.toInt(15);
+  obj.lno = row.toInt(16);
+  if (row.size() == 17)
   {
     obj.lanetype = 0;
     obj.limitvel = 0;
@@ -2110,359 +2176,374 @@ std::istream& operator>>(std::istream& is, vector_map::Lane& obj)
     obj.roadsecid = 0;
     obj.lanecfgfg = 0;
     obj.linkwaid = 0;
-    return is;
+    return;
   }
-  obj.lanetype = std::stoi(columns[17]);
-  obj.limitvel = std::stoi(columns[18]);
-  obj.refvel = std::stoi(columns[19]);
-  obj.roadsecid = std::stoi(columns[20]);
-  obj.lanecfgfg = std::stoi(columns[21]);
-  if (n == 22)
+  obj.lanetype = row.toInt(17);
+  obj.limitvel = row.toInt(18);
+  obj.refvel = row.toInt(19);
+  obj.roadsecid = row.toInt(20);
+  obj.lanecfgfg = row.toInt(21);
+  if (row.size() == 22)
   {
     obj.linkwaid = 0;
-    return is;
+    return;
   }
-  obj.linkwaid = std::stoi(columns[22]);
+  obj.linkwaid = row.toInt(22);
+}
+
+void parseRow(const CsvRow& row, WayArea& obj)
+{
+  obj.waid = row.toInt(0);
+  obj.aid = row.toInt(1);
+}
+
+void parseRow(const CsvRow& row, RoadEdge& obj)
+{
+  obj.id = row.toInt(0);
+  obj.lid = row.toInt(1);
+  obj.linkid = row.toInt(2);
+}
+
+void parseRow(const CsvRow& row, Gutter& obj)
+{
+  obj.id = row.toInt(0);
+  obj.aid = row.toInt(1);
+  obj.type = row.toInt(2);
+  obj.linkid = row.toInt(3);
+}
+
+void parseRow(const CsvRow& row, Curb& obj)
+{
+  obj.id = row.toInt(0);
+  obj.lid = row.toInt(1);
+  obj.height = row.toDouble(2);
+  obj.width = row.toDouble(3);
+  obj.dir = row.toInt(4);
+  obj.linkid = row.toInt(5);
+}
+
+void parseRow(const CsvRow& row, WhiteLine& obj)
+{
+  obj.id = row.toInt(0);
+  obj.lid = row.toInt(1);
+  obj.width = row.toDouble(2);
+  obj.color = row.toChar(3);
+  obj.type = row.toInt(4);
+  obj.linkid = row.toInt(5);
+}
+
+void parseRow(const CsvRow& row, StopLine& obj)
+{
+  obj.id = row.toInt(0);
+  obj.lid = row.toInt(1);
+  obj.tlid = row.toInt(2);
+  obj.signid = row.toInt(3);
+  obj.linkid = row.toInt(4);
+}
+
+void parseRow(const CsvRow& row, ZebraZone& obj)
+{
+  obj.id = row.toInt(0);
+  obj.aid = row.toInt(1);
+  obj.linkid = row.toInt(2);
+}
+
+void parseRow(const CsvRow& row, CrossWalk& obj)
+{
+  obj.id = row.toInt(0);
+  obj.aid = row.toInt(1);
+  obj.type = row.toInt(2);
+  obj.bdid = row.toInt(3);
+  obj.linkid = row.toInt(4);
+}
+
+void parseRow(const CsvRow& row, RoadMark& obj)
+{
+  obj.id = row.toInt(0);
+  obj.aid = row.toInt(1);
+  obj.type = row.toInt(2);
+  obj.linkid = row.toInt(3);
+}
+
+void parseRow(const CsvRow& row, RoadPole& obj)
+{
+  obj.id = row.toInt(0);
+  obj.plid = row.toInt(1);
+  obj.linkid = row.toInt(2);
+}
+
+void parseRow(const CsvRow& row, RoadSign& obj)
+{
+  obj.id = row.toInt(0);
+  obj.vid = row.toInt(1);
+  obj.plid = row.toInt(2);
+  obj.type = row.toInt(3);
+  obj.linkid = row.toInt(4);
+}
+
+void parseRow(const CsvRow& row, Signal& obj)
+{
+  obj.id = row.toInt(0);
+  obj.vid = row.toInt(1);
+  obj.plid = row.toInt(2);
+  obj.type = row.toInt(3);
+  obj.linkid = row.toInt(4);
+}
+
+void parseRow(const CsvRow& row, StreetLight& obj)
+{
+  obj.id = row.toInt(0);
+  obj.lid = row.toInt(1);
+  obj.plid = row.toInt(2);
+  obj.linkid = row.toInt(3);
+}
+
+void parseRow(const CsvRow& row, UtilityPole& obj)
+{
+  obj.id = row.toInt(0);
+  obj.plid = row.toInt(1);
+  obj.linkid = row.toInt(2);
+}
+
+void parseRow(const CsvRow& row, GuardRail& obj)
+{
+  obj.id = row.toInt(0);
+  obj.aid = row.toInt(1);
+  obj.type = row.toInt(2);
+  obj.linkid = row.toInt(3);
+}
+
+void parseRow(const CsvRow& row, SideWalk& obj)
+{
+  obj.id = row.toInt(0);
+  obj.aid = row.toInt(1);
+  obj.linkid = row.toInt(2);
+}
+
+void parseRow(const CsvRow& row, DriveOnPortion& obj)
+{
+  obj.id = row.toInt(0);
+  obj.aid = row.toInt(1);
+  obj.linkid = row.toInt(2);
+}
+
+void parseRow(const CsvRow& row, CrossRoad& obj)
+{
+  obj.id = row.toInt(0);
+  obj.aid = row.toInt(1);
+  obj.linkid = row.toInt(2);
+}
+
+void parseRow(const CsvRow& row, SideStrip& obj)
+{
+  obj.id = row.toInt(0);
+  obj.lid = row.toInt(1);
+  obj.linkid = row.toInt(2);
+}
+
+void parseRow(const CsvRow& row, CurveMirror& obj)
+{
+  obj.id = row.toInt(0);
+  obj.vid = row.toInt(1);
+  obj.plid = row.toInt(2);
+  obj.type = row.toInt(3);
+  obj.linkid = row.toInt(4);
+}
+
+void parseRow(const CsvRow& row, Wall& obj)
+{
+  obj.id = row.toInt(0);
+  obj.aid = row.toInt(1);
+  obj.linkid = row.toInt(2);
+}
+
+void parseRow(const CsvRow& row, Fence& obj)
+{
+  obj.id = row.toInt(0);
+  obj.aid = row.toInt(1);
+  obj.linkid = row.toInt(2);
+}
+
+void parseRow(const CsvRow& row, RailCrossing& obj)
+{
+  obj.id = row.toInt(0);
+  obj.aid = row.toInt(1);
+  obj.linkid = row.toInt(2);
+}
+} // namespace vector_map
+
+namespace
+{
+template <class T>
+std::istream& parseStream(std::istream& is, T& obj)
+{
+  std::string line;
+  std::getline(is, line);
+  std::vector<char> chars(line.begin(), line.end());
+  chars.push_back('\0');
+  vector_map::CsvRow row;
+  row.split(chars.data());
+  vector_map::parseRow(row, obj);
   return is;
 }
+} // namespace
+
+std::istream& operator>>(std::istream& is, vector_map::Point& obj)
+{
+  return parseStream(is, obj);
+}
+
+std::istream& operator>>(std::istream& is, vector_map::Vector& obj)
+{
+  return parseStream(is, obj);
+}
+
+std::istream& operator>>(std::istream& is, vector_map::Line& obj)
+{
+  return parseStream(is, obj);
+}
+
+std::istream& operator>>(std::istream& is, vector_map::Area& obj)
+{
+  return parseStream(is, obj);
+}
+
+std::istream& operator>>(std::istream& is, vector_map::Pole& obj)
+{
+  return parseStream(is, obj);
+}
+
+std::istream& operator>>(std::istream& is, vector_map::Box& obj)
+{
+  return parseStream(is, obj);
+}
+
+std::istream& operator>>(std::istream& is, vector_map::DTLane& obj)
+{
+  return parseStream(is, obj);
+}
+
+std::istream& operator>>(std::istream& is, vector_map::Node& obj)
+{
+  return parseStream(is, obj);
+}
+
+std::istream& operator>>(std::istream& is, vector_map::Lane& obj)
+{
+  return parseStream(is, obj);
+}
 
 std::istream& operator>>(std::istream& is, vector_map::WayArea& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.waid = std::stoi(columns[0]);
-  obj.aid = std::stoi(columns[1]);
-  return is;
+  return parseStream(is, obj);
 }
 
 std::istream& operator>>(std::istream& is, vector_map::RoadEdge& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.id = std::stoi(columns[0]);
-  obj.lid = std::stoi(columns[1]);
-  obj.linkid = std::stoi(columns[2]);
-  return is;
+  return parseStream(is, obj);
 }
 
 std::istream& operator>>(std::istream& is, vector_map::Gutter& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.id = std::stoi(columns[0]);
-  obj.aid = std::stoi(columns[1]);
-  obj.type = std::stoi(columns[2]);
-  obj.linkid = std::stoi(columns[3]);
-  return is;
+  return parseStream(is, obj);
 }
 
 std::istream& operator>>(std::istream& is, vector_map::Curb& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.id = std::stoi(columns[0]);
-  obj.lid = std::stoi(columns[1]);
-  obj.height = std::stod(columns[2]);
-  obj.width = std::stod(columns[3]);
-  obj.dir = std::stoi(columns[4]);
-  obj.linkid = std::stoi(columns[5]);
-  return is;
+  return parseStream(is, obj);
 }
 
 std::istream& operator>>(std::istream& is, vector_map::WhiteLine& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.id = std::stoi(columns[0]);
-  obj.lid = std::stoi(columns[1]);
-  obj.width = std::stod(columns[2]);
-  obj.color = columns[3].c_str()[0];
-  obj.type = std::stoi(columns[4]);
-  obj.linkid = std::stoi(columns[5]);
-  return is;
+  return parseStream(is, obj);
 }
 
 std::istream& operator>>(std::istream& is, vector_map::StopLine& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.id = std::stoi(columns[0]);
-  obj.lid = std::stoi(columns[1]);
-  obj.tlid = std::stoi(columns[2]);
-  obj.signid = std::stoi(columns[3]);
-  obj.linkid = std::stoi(columns[4]);
-  return is;
+  return parseStream(is, obj);
 }
 
 std::istream& operator>>(std::istream& is, vector_map::ZebraZone& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.id = std::stoi(columns[0]);
-  obj.aid = std::stoi(columns[1]);
-  obj.linkid = std::stoi(columns[2]);
-  return is;
+  return parseStream(is, obj);
 }
 
 std::istream& operator>>(std::istream& is, vector_map::CrossWalk& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.id = std::stoi(columns[0]);
-  obj.aid = std::stoi(columns[1]);
-  obj.type = std::stoi(columns[2]);
-  obj.bdid = std::stoi(columns[3]);
-  obj.linkid = std::stoi(columns[4]);
-  return is;
+  return parseStream(is, obj);
 }
 
 std::istream& operator>>(std::istream& is, vector_map::RoadMark& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.id = std::stoi(columns[0]);
-  obj.aid = std::stoi(columns[1]);
-  obj.type = std::stoi(columns[2]);
-  obj.linkid = std::stoi(columns[3]);
-  return is;
+  return parseStream(is, obj);
 }
 
 std::istream& operator>>(std::istream& is, vector_map::RoadPole& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.id = std::stoi(columns[0]);
-  obj.plid = std::stoi(columns[1]);
-  obj.linkid = std::stoi(columns[2]);
-  return is;
+  return parseStream(is, obj);
 }
 
 std::istream& operator>>(std::istream& is, vector_map::RoadSign& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.id = std::stoi(columns[0]);
-  obj.vid = std::stoi(columns[1]);
-  obj.plid = std::stoi(columns[2]);
-  obj.type = std::stoi(columns[3]);
-  obj.linkid = std::stoi(columns[4]);
-  return is;
+  return parseStream(is, obj);
 }
 
 std::istream& operator>>(std::istream& is, vector_map::Signal& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.id = std::stoi(columns[0]);
-  obj.vid = std::stoi(columns[1]);
-  obj.plid = std::stoi(columns[2]);
-  obj.type = std::stoi(columns[3]);
-  obj.linkid = std::stoi(columns[4]);
-  return is;
+  return parseStream(is, obj);
 }
 
 std::istream& operator>>(std::istream& is, vector_map::StreetLight& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.id = std::stoi(columns[0]);
-  obj.lid = std::stoi(columns[1]);
-  obj.plid = std::stoi(columns[2]);
-  obj.linkid = std::stoi(columns[3]);
-  return is;
+  return parseStream(is, obj);
 }
 
 std::istream& operator>>(std::istream& is, vector_map::UtilityPole& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.id = std::stoi(columns[0]);
-  obj.plid = std::stoi(columns[1]);
-  obj.linkid = std::stoi(columns[2]);
-  return is;
+  return parseStream(is, obj);
 }
 
 std::istream& operator>>(std::istream& is, vector_map::GuardRail& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.id = std::stoi(columns[0]);
-  obj.aid = std::stoi(columns[1]);
-  obj.type = std::stoi(columns[2]);
-  obj.linkid = std::stoi(columns[3]);
-  return is;
+  return parseStream(is, obj);
 }
 
 std::istream& operator>>(std::istream& is, vector_map::SideWalk& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.id = std::stoi(columns[0]);
-  obj.aid = std::stoi(columns[1]);
-  obj.linkid = std::stoi(columns[2]);
-  return is;
+  return parseStream(is, obj);
 }
 
 std::istream& operator>>(std::istream& is, vector_map::DriveOnPortion& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.id = std::stoi(columns[0]);
-  obj.aid = std::stoi(columns[1]);
-  obj.linkid = std::stoi(columns[2]);
-  return is;
+  return parseStream(is, obj);
 }
 
 std::istream& operator>>(std::istream& is, vector_map::CrossRoad& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.id = std::stoi(columns[0]);
-  obj.aid = std::stoi(columns[1]);
-  obj.linkid = std::stoi(columns[2]);
-  return is;
+  return parseStream(is, obj);
 }
 
 std::istream& operator>>(std::istream& is, vector_map::SideStrip& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.id = std::stoi(columns[0]);
-  obj.lid = std::stoi(columns[1]);
-  obj.linkid = std::stoi(columns[2]);
-  return is;
+  return parseStream(is, obj);
 }
 
 std::istream& operator>>(std::istream& is, vector_map::CurveMirror& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.id = std::stoi(columns[0]);
-  obj.vid = std::stoi(columns[1]);
-  obj.plid = std::stoi(columns[2]);
-  obj.type = std::stoi(columns[3]);
-  obj.linkid = std::stoi(columns[4]);
-  return is;
+  return parseStream(is, obj);
 }
 
 std::istream& operator>>(std::istream& is, vector_map::Wall& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.id = std::stoi(columns[0]);
-  obj.aid = std::stoi(columns[1]);
-  obj.linkid = std::stoi(columns[2]);
-  return is;
+  return parseStream(is, obj);
 }
 
 std::istream& operator>>(std::istream& is, vector_map::Fence& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.id = std::stoi(columns[0]);
-  obj.aid = std::stoi(columns[1]);
-  obj.linkid = std::stoi(columns[2]);
-  return is;
+  return parseStream(is, obj);
 }
 
 std::istream& operator>>(std::istream& is, vector_map::RailCrossing& obj)
 {
-  std::vector<std::string> columns;
-  std::string column;
-  while (std::getline(is, column, ','))
-  {
-    columns.push_back(column);
-  }
-  obj.id = std::stoi(columns[0]);
-  obj.aid = std::stoi(columns[1]);
-  obj.linkid = std::stoi(columns[2]);
-  return is;
+  return parseStream(is, obj);
 }
@@ -0,0 +1,547 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <climits>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <vector_map/binary_map.h>
+#include <vector_map/vector_map.h>
+
+using vector_map::BinaryMap;
+using vector_map::IdIndex;
+
+namespace
+{
+// Directory removed with its files at the end of a test
+class TempDir
+{
+private:
+  std::string path_;
+  std::vector<std::string> files_;
+
+public:
+  TempDir()
+  {
+    char path[] = "/tmp/test_vector_mapXXXXXX";
+    path_ = mkdtemp(path);
+  }
+
+  ~TempDir()
+  {
+    for (const auto& file : files_)
+      unlink(file.c_str());
+    rmdir(path_.c_str());
+  }
+
+  std::string write(const std::string& name, const std::string& content)
+  {
+    std::string file = path_ + "/" + name;
+    std::ofstream ofs(file.c_str(), std::ios::binary);
+    ofs << content;
+    files_.push_back(file);
+    return file;
+  }
+
+  std::string file(const std::string& name)
+  {
+    files_.push_back(path_ + "/" + name);
+    return files_.back();
+  }
+};
+
+// The readers of vector_map before parse() split rows in place: getline at every comma, then stoi and stod
+std::vector<std::string> oldColumns(const std::string& line)
+{
+  std::istringstream iss(line);
+  std::vector<std::string> columns;
+  std::string column;
+  while (std::getline(iss, column, ','))
+    columns.push_back(column);
+  return columns;
+}
+
+vector_map::Point oldPoint(const std::string& line)
+{
+  std::vector<std::string> columns = oldColumns(line);
+  vector_map::Point obj;
+  obj.pid = std::stoi(columns[0]);
+  obj.b = std::stod(columns[1]);
+  obj.l = std::stod(columns[2]);
+  obj.h = std::stod(columns[3]);
+  obj.bx = std::stod(columns[4]);
+  obj.ly = std::stod(columns[5]);
+  obj.ref = std::stoi(columns[6]);
+  obj.mcode1 = std::stoi(columns[7]);
+  obj.mcode2 = std::stoi(columns[8]);
+  obj.mcode3 = std::stoi(columns[9]);
+  return obj;
+}
+
+vector_map::Lane oldLane(const std::string& line)
+{
+  std::vector<std::string> columns = oldColumns(line);
+  vector_map::Lane obj;
+  obj.lnid = std::stoi(columns[0]);
+  obj.did = std::stoi(columns[1]);
+  obj.blid = std::stoi(columns[2]);
+  obj.flid = std::stoi(columns[3]);
+  obj.bnid = std::stoi(columns[4]);
+  obj.fnid = std::stoi(columns[5]);
+  obj.jct = std::stoi(columns[6]);
+  obj.blid2 = std::stoi(columns[7]);
+  obj.blid3 = std::stoi(columns[8]);
+  obj.blid4 = std::stoi(columns[9]);
+  obj.flid2 = std::stoi(columns[10]);
+  obj.flid3 = std::stoi(columns[11]);
+  obj.flid4 = std::stoi(columns[12]);
+  obj.clossid = std::stoi(columns[13]);
+  obj.span = std::stod(columns[14]);
+  obj.lcnt = std::stoi(columns[15]);
+  obj.lno = std::stoi(columns[16]);
+  obj.lanetype = obj.limitvel = obj.refvel = obj.roadsecid = obj.lanecfgfg = obj.linkwaid = 0;
+  if (columns.size() == 17)
+    return obj;
+  obj.lanetype = std::stoi(columns[17]);
+  obj.limitvel = std::stoi(columns[18]);
+  obj.refvel = std::stoi(columns[19]);
+  obj.roadsecid = std::stoi(columns[20]);
+  obj.lanecfgfg = std::stoi(columns[21]);
+  if (columns.size() == 22)
+    return obj;
+  obj.linkwaid = std::stoi(columns[22]);
+  return obj;
+}
+
+vector_map::WhiteLine oldWhiteLine(const std::string& line)
+{
+  std::vector<std::string> columns = oldColumns(line);
+  vector_map::WhiteLine obj;
+  obj.id = std::stoi(columns[0]);
+  obj.lid = std::stoi(columns[1]);
+  obj.width = std::stod(columns[2]);
+  obj.color = columns[3].c_str()[0];
+  obj.type = std::stoi(columns[4]);
+  obj.linkid = std::stoi(columns[5]);
+  return obj;
+}
+
+std::string makeCsv(const std::string& header, const std::vector<std::string>& rows, const std::string& eol = "\n")
+{
+  std::string csv = header + eol;
+  for (const auto& row : rows)
+    csv += row + eol;
+  return csv;
+}
+
+std::vector<vector_map::Point> makePoints(int n)
+{
+  std::vector<vector_map::Point> points;
+  for (int i = 0; i < n; ++i)
+  {
+    vector_map::Point point;
+    point.pid = 3 * i + 1;
+    point.b = 35.0 + i * 1e-6;
+    point.l = 139.0 - i * 1e-6;
+    point.h = 40.5 + 0.25 * i;
+    point.bx = -12345.678 + i;
+    point.ly = 9876.5 - i;
+    point.ref = 7;
+    point.mcode1 = i % 3;
+    point.mcode2 = -i;
+    point.mcode3 = 0;
+    points.push_back(point);
+  }
+  return points;
+}
+
+void expectSamePoint(const vector_map::Point& expected, const vector_map::Point& point)
+{
+  EXPECT_EQ(expected.pid, point.pid);
+  EXPECT_EQ(expected.b, point.b);
+  EXPECT_EQ(expected.l, point.l);
+  EXPECT_EQ(expected.h, point.h);
+  EXPECT_EQ(expected.bx, point.bx);
+  EXPECT_EQ(expected.ly, point.ly);
+  EXPECT_EQ(expected.ref, point.ref);
+  EXPECT_EQ(expected.mcode1, point.mcode1);
+  EXPECT_EQ(expected.mcode2, point.mcode2);
+  EXPECT_EQ(expected.mcode3, point.mcode3);
+}
+
+void expectSameLane(const vector_map::Lane& expected, const vector_map::Lane& lane)
+{
+  EXPECT_EQ(expected.lnid, lane.lnid);
+  EXPECT_EQ(expected.did, lane.did);
+  EXPECT_EQ(expected.blid, lane.blid);
+  EXPECT_EQ(expected.flid, lane.flid);
+  EXPECT_EQ(expected.bnid, lane.bnid);
+  EXPECT_EQ(expected.fnid, lane.fnid);
+  EXPECT_EQ(expected.jct, lane.jct);
+  EXPECT_EQ(expected.blid2, lane.blid2);
+  EXPECT_EQ(expected.blid3, lane.blid3);
+  EXPECT_EQ(expected.blid4, lane.blid4);
+  EXPECT_EQ(expected.flid2, lane.flid2);
+  EXPECT_EQ(expected.flid3, lane.flid3);
+  EXPECT_EQ(expected.flid4, lane.flid4);
+  EXPECT_EQ(expected.clossid, lane.clossid);
+  EXPECT_EQ(expected.span, lane.span);
+  EXPECT_EQ(expected.lcnt, lane.lcnt);
+  EXPECT_EQ(expected.lno, lane.lno);
+  EXPECT_EQ(expected.lanetype, lane.lanetype);
+  EXPECT_EQ(expected.limitvel, lane.limitvel);
+  EXPECT_EQ(expected.refvel, lane.refvel);
+  EXPECT_EQ(expected.roadsecid, lane.roadsecid);
+  EXPECT_EQ(expected.lanecfgfg, lane.lanecfgfg);
+  EXPECT_EQ(expected.linkwaid, lane.linkwaid);
+}
+
+void expectSameWhiteLine(const vector_map::WhiteLine& expected, const vector_map::WhiteLine& white_line)
+{
+  EXPECT_EQ(expected.id, white_line.id);
+  EXPECT_EQ(expected.lid, white_line.lid);
+  EXPECT_EQ(expected.width, white_line.width);
+  EXPECT_EQ(expected.color, white_line.color);
+  EXPECT_EQ(expected.type, white_line.type);
+  EXPECT_EQ(expected.linkid, white_line.linkid);
+}
+
+// Every id of ids is found, ids around them only when they are indexed too
+void expectSameAsMap(const std::vector<int>& ids)
+{
+  std::vector<int> values(ids.size());
+  std::vector<std::pair<int, int*>> items;
+  std::map<int, int*> expected;
+  for (size_t i = 0; i < ids.size(); ++i)
+  {
+    values[i] = static_cast<int>(i);
+    items.push_back(std::make_pair(ids[i], &values[i]));
+    expected[ids[i]] = &values[i];
+  }
+  IdIndex<int> index;
+  index.build(items);
+  EXPECT_FALSE(index.empty());
+
+  std::vector<int> probes = { INT_MIN, INT_MIN + 1, -1, 0, 1, INT_MAX - 1, INT_MAX };
+  for (int id : ids)
+  {
+    probes.push_back(id);
+    if (id > INT_MIN)
+      probes.push_back(id - 1);
+    if (id < INT_MAX)
+      probes.push_back(id + 1);
+  }
+  for (int id : probes)
+  {
+    auto it = expected.find(id);
+    EXPECT_EQ(it == expected.end() ? nullptr : it->second, index.find(id)) << "id " << id;
+  }
+}
+}  // namespace
+
+// Tables added to a compiled map come back unchanged after a save and a load
+TEST(BinaryMap, saveLoadRoundTrip)
+{
+  TempDir dir;
+  BinaryMap bmap;
+
+  vector_map::PointArray points;
+  points.header.frame_id = "map";
+  points.data = makePoints(1000);
+  bmap.add(vector_map::POINT, points);
+
+  vector_map::LaneArray lanes;
+  for (int i = 0; i < 3; ++i)
+  {
+    vector_map::Lane lane;
+    lane.lnid = i + 1;
+    lane.bnid = i;
+    lane.fnid = i + 1;
+    lane.span = 1.5 * i;
+    lane.linkwaid = -i;
+    lanes.data.push_back(lane);
+  }
+  bmap.add(vector_map::LANE, lanes);
+
+  // a table added again replaces the first one
+  vector_map::WhiteLineArray white_lines;
+  white_lines.data.resize(5);
+  bmap.add(vector_map::WHITE_LINE, white_lines);
+  white_lines.data.resize(2);
+  white_lines.data[1].id = 9;
+  white_lines.data[1].color = 'Y';
+  white_lines.data[1].width = 0.15;
+  bmap.add(vector_map::WHITE_LINE, white_lines);
+
+  std::string file = dir.file("map.vmb");
+  ASSERT_TRUE(bmap.save(file));
+
+  BinaryMap loaded;
+  ASSERT_TRUE(loaded.load(file));
+  EXPECT_EQ(vector_map::POINT | vector_map::LANE | vector_map::WHITE_LINE, loaded.getCategory());
+  EXPECT_EQ(1000u, loaded.getRows(vector_map::POINT));
+  EXPECT_EQ(3u, loaded.getRows(vector_map::LANE));
+  EXPECT_EQ(2u, loaded.getRows(vector_map::WHITE_LINE));
+  EXPECT_EQ(0u, loaded.getRows(vector_map::NODE));
+
+  vector_map::PointArray loaded_points;
+  ASSERT_TRUE(loaded.get(vector_map::POINT, loaded_points));
+  EXPECT_EQ("map", loaded_points.header.frame_id);
+  ASSERT_EQ(points.data.size(), loaded_points.data.size());
+  for (size_t i = 0; i < points.data.size(); ++i)
+    expectSamePoint(points.data[i], loaded_points.data[i]);
+
+  vector_map::LaneArray loaded_lanes;
+  ASSERT_TRUE(loaded.get(vector_map::LANE, loaded_lanes));
+  ASSERT_EQ(lanes.data.size(), loaded_lanes.data.size());
+  for (size_t i = 0; i < lanes.data.size(); ++i)
+    expectSameLane(lanes.data[i], loaded_lanes.data[i]);
+
+  vector_map::WhiteLineArray loaded_white_lines;
+  ASSERT_TRUE(loaded.get(vector_map::WHITE_LINE, loaded_white_lines));
+  ASSERT_EQ(2u, loaded_white_lines.data.size());
+  expectSameWhiteLine(white_lines.data[1], loaded_white_lines.data[1]);
+
+  vector_map::NodeArray nodes;
+  EXPECT_FALSE(loaded.get(vector_map::NODE, nodes));
+}
+
+// A csv file compiled into a map reads back as parse() reads it
+TEST(BinaryMap, addCsv)
+{
+  TempDir dir;
+  std::string csv = dir.write("point.csv", makeCsv("PID,B,L,H,Bx,Ly,ReF,FHNo,L1,L2",
+                                                   { "1,35.5,139.5,40.25,-100.5,200.75,7,0,1,2",
+                                                     "2,35.6,139.6,40.5,-101.5,201.75,7,0,1,2" }));
+  std::string unknown = dir.write("idx.csv", "a,b\n1,2\n");
+
+  BinaryMap bmap;
+  EXPECT_EQ(vector_map::POINT, bmap.addCsv(csv));
+  EXPECT_EQ(vector_map::Category::NONE, bmap.addCsv(unknown));
+  EXPECT_EQ("point.csv", vector_map::getCsvFileName(vector_map::POINT));
+
+  std::string file = dir.file("map.vmb");
+  ASSERT_TRUE(bmap.save(file));
+  BinaryMap loaded;
+  ASSERT_TRUE(loaded.load(file));
+  vector_map::PointArray points;
+  ASSERT_TRUE(loaded.get(vector_map::POINT, points));
+  std::vector<vector_map::Point> expected = vector_map::parse<vector_map::Point>(csv);
+  ASSERT_EQ(2u, points.data.size());
+  ASSERT_EQ(expected.size(), points.data.size());
+  for (size_t i = 0; i < expected.size(); ++i)
+    expectSamePoint(expected[i], points.data[i]);
+}
+
+TEST(BinaryMap, rejectsBadFiles)
+{
+  TempDir dir;
+  BinaryMap bmap;
+  EXPECT_FALSE(bmap.load(dir.file("missing.vmb")));
+  EXPECT_FALSE(bmap.load(dir.write("point.csv", "PID,B\n1,2\n")));
+  EXPECT_FALSE(bmap.load(dir.write("short.vmb", std::string(BinaryMap::MAGIC, sizeof(BinaryMap::MAGIC)))));
+
+  // cut in the middle of the last table
+  vector_map::PointArray points;
+  points.data = makePoints(10);
+  bmap.add(vector_map::POINT, points);
+  std::string file = dir.file("map.vmb");
+  ASSERT_TRUE(bmap.save(file));
+  std::ifstream ifs(file.c_str(), std::ios::binary);
+  std::string content((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+  ASSERT_GT(content.size(), 10u);
+
+  BinaryMap loaded;
+  EXPECT_FALSE(loaded.load(dir.write("truncated.vmb", content.substr(0, content.size() - 10))));
+  EXPECT_EQ(vector_map::Category::NONE, loaded.getCategory());
+}
+
+// Dense ids are kept in slots, sparse ids in a hash table: both find what a std::map finds
+TEST(IdIndex, denseIds)
+{
+  std::vector<int> ids;
+  for (int id = 1; id <= 500; ++id)
+  {
+    if (id % 7 != 0)
+      ids.push_back(id);
+  }
+  expectSameAsMap(ids);
+
+  // negative ids and a gap of a few objects
+  ids.clear();
+  for (int id = -40; id <= 40; id += 2)
+    ids.push_back(id);
+  ids.push_back(150);
+  expectSameAsMap(ids);
+}
+
+TEST(IdIndex, sparseIds)
+{
+  expectSameAsMap({ 1, 1000000 });
+  expectSameAsMap({ -2000000000, -7, 0, 5, 2000000000 });
+  expectSameAsMap({ INT_MIN, INT_MAX });
+  expectSameAsMap({ INT_MAX });
+}
+
+TEST(IdIndex, emptyAndRebuilt)
+{
+  IdIndex<int> index;
+  EXPECT_TRUE(index.empty());
+  EXPECT_EQ(nullptr, index.find(0));
+
+  int a = 1, b = 2;
+  index.build({ { 5, &a }, { 1000000, &b } });
+  EXPECT_EQ(&b, index.find(1000000));
+
+  // a dense build drops the hashed ids
+  index.build({ { 3, &a }, { 4, &b } });
+  EXPECT_EQ(&a, index.find(3));
+  EXPECT_EQ(&b, index.find(4));
+  EXPECT_EQ(nullptr, index.find(1000000));
+  EXPECT_EQ(nullptr, index.find(5));
+
+  index.build(std::vector<std::pair<int, int*>>());
+  EXPECT_TRUE(index.empty());
+  EXPECT_EQ(nullptr, index.find(3));
+}
+
+TEST(IdIndex, buildFromObjects)
+{
+  std::vector<vector_map::Point> points = makePoints(20);
+  IdIndex<vector_map::Point> index;
+  index.build(points, &vector_map::Point::pid);
+  for (const auto& point : points)
+    EXPECT_EQ(&point, index.find(point.pid));
+  EXPECT_EQ(nullptr, index.find(2));
+}
+
+// Rows the old reader reads are read the same, windows and unix line ends alike
+TEST(CsvParse, matchesOldReader)
+{
+  TempDir dir;
+  std::vector<std::string> point_rows;
+  std::ostringstream os;
+  os.precision(17);
+  for (const auto& point : makePoints(300))
+  {
+    os.str("");
+    os << point.pid << "," << point.b << "," << point.l << "," << point.h << "," << point.bx << "," << point.ly << ","
+       << point.ref << "," << point.mcode1 << "," << point.mcode2 << "," << point.mcode3;
+    point_rows.push_back(os.str());
+  }
+  point_rows.push_back(" 12, 1e-3,-0.5E+2 ,0x10,.5,-0,+3,007,1,2");
+
+  const std::vector<std::string> lane_rows = {
+    "1,2,0,3,4,5,0,0,0,0,0,0,0,0,1.25,1,1",
+    "2,3,1,0,5,6,1,0,0,0,0,0,0,0,2.5,2,1,0,40,30,7,0",
+    "3,4,2,0,6,7,2,1,0,0,4,0,0,0,3.75,2,2,1,60,50,8,1,-9",
+  };
+  const std::vector<std::string> white_line_rows = { "1,10,0.15,W,0,3", "2,11,0.3,Y,1,-1" };
+
+  for (const std::string eol : { "\n", "\r\n" })
+  {
+    std::string point_csv = dir.write("point.csv", makeCsv("PID,B,L,H,Bx,Ly,ReF,FHNo,L1,L2", point_rows, eol));
+    std::vector<vector_map::Point> points = vector_map::parse<vector_map::Point>(point_csv);
+    ASSERT_EQ(point_rows.size(), points.size());
+    for (size_t i = 0; i < point_rows.size(); ++i)
+      expectSamePoint(oldPoint(point_rows[i] + (eol[0] == '\r' ? "\r" : "")), points[i]);
+
+    std::string lane_csv = dir.write("lane.csv", makeCsv("LnID,DID,BLID,FLID,BNID,FNID", lane_rows, eol));
+    std::vector<vector_map::Lane> lanes = vector_map::parse<vector_map::Lane>(lane_csv);
+    ASSERT_EQ(lane_rows.size(), lanes.size());
+    for (size_t i = 0; i < lane_rows.size(); ++i)
+      expectSameLane(oldLane(lane_rows[i]), lanes[i]);
+
+    std::string white_line_csv =
+        dir.write("whiteline.csv", makeCsv("ID,LID,Width,Color,type,LinkID", white_line_rows, eol));
+    std::vector<vector_map::WhiteLine> white_lines = vector_map::parse<vector_map::WhiteLine>(white_line_csv);
+    ASSERT_EQ(white_line_rows.size(), white_lines.size());
+    for (size_t i = 0; i < white_line_rows.size(); ++i)
+      expectSameWhiteLine(oldWhiteLine(white_line_rows[i]), white_lines[i]);
+  }
+
+  // the stream operators read a row as parse() does
+  for (const auto& row : lane_rows)
+  {
+    std::istringstream iss(row);
+    vector_map::Lane lane;
+    iss >> lane;
+    expectSameLane(oldLane(row), lane);
+  }
+}
+
+// Quoted columns are read without their quotes, where the old reader threw or kept the quote
+TEST(CsvParse, quotedColumns)
+{
+  TempDir dir;
+  EXPECT_THROW(oldPoint("\"1\",35.5,139.5,40.25,-100.5,200.75,7,0,1,2"), std::invalid_argument);
+
+  std::string point_csv = dir.write("point.csv", makeCsv("\"PID\",\"B\",\"L\"",
+                                                         { "\"1\",35.5,\"139.5\",40.25,-100.5,200.75,7,0,1,\"2\"",
+                                                           "\"\",\"1,5\",\"\",40.25,-100.5,200.75,7,0,1,2" }));
+  std::vector<vector_map::Point> points = vector_map::parse<vector_map::Point>(point_csv);
+  ASSERT_EQ(2u, points.size());
+  expectSamePoint(oldPoint("1,35.5,139.5,40.25,-100.5,200.75,7,0,1,2"), points[0]);
+  // an empty quoted column is 0, a comma in quotes does not split the column
+  expectSamePoint(oldPoint("0,1,0,40.25,-100.5,200.75,7,0,1,2"), points[1]);
+
+  std::string white_line_csv =
+      dir.write("whiteline.csv", makeCsv("ID,LID,Width,Color,type,LinkID", { "1,10,0.15,\"Y\",0,3" }));
+  std::vector<vector_map::WhiteLine> white_lines = vector_map::parse<vector_map::WhiteLine>(white_line_csv);
+  ASSERT_EQ(1u, white_lines.size());
+  EXPECT_EQ('"', oldWhiteLine("1,10,0.15,\"Y\",0,3").color);
+  EXPECT_EQ('Y', white_lines[0].color);
+}
+
+// Empty columns are read as 0 and missing ones at the end as 0 too, where the old reader threw or read past the
+// columns. An empty line is not a row.
+TEST(CsvParse, emptyColumns)
+{
+  TempDir dir;
+  EXPECT_THROW(oldPoint("1,,139.5,40.25,-100.5,200.75,7,0,1,2"), std::invalid_argument);
+
+  std::string point_csv = dir.write("point.csv", makeCsv("PID,B,L,H,Bx,Ly,ReF,FHNo,L1,L2",
+                                                         { "1,,139.5,40.25,-100.5,200.75,7,0,1,2",
+                                                           ",35.5,139.5,40.25,-100.5,200.75,7,,,",
+                                                           "",
+                                                           "3,35.5,139.5" }));
+  std::vector<vector_map::Point> points = vector_map::parse<vector_map::Point>(point_csv);
+  ASSERT_EQ(3u, points.size());
+  expectSamePoint(oldPoint("1,0,139.5,40.25,-100.5,200.75,7,0,1,2"), points[0]);
+  expectSamePoint(oldPoint("0,35.5,139.5,40.25,-100.5,200.75,7,0,0,0"), points[1]);
+  expectSamePoint(oldPoint("3,35.5,139.5,0,0,0,0,0,0,0"), points[2]);
+
+  // a file of a header only or of nothing has no rows
+  EXPECT_TRUE(vector_map::parse<vector_map::Point>(dir.write("header.csv", "PID,B,L")).empty());
+  EXPECT_TRUE(vector_map::parse<vector_map::Point>(dir.write("empty.csv", "")).empty());
+  EXPECT_TRUE(vector_map::parse<vector_map::Point>(dir.file("missing.csv")).empty());
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
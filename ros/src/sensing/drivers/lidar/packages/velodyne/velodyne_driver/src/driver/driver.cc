@@ -83,7 +83,19 @@ VelodyneDriver::VelodyneDriver(ros::NodeHandle node,
   // (fractions rounded up)
   config_.npackets = (int) ceil(packet_rate / frequency);
   private_nh.getParam("npackets", config_.npackets);
-  ROS_INFO_STREAM("publishing " << config_.npackets << " packets per scan");
+
+  // optionally split each revolution into azimuth sectors, which are
+  // published as soon as they are complete (low-latency streaming)
+  private_nh.param("sectors", config_.sectors, 1);
+  if (config_.sectors < 1)
+  {
+    ROS_ERROR_STREAM("sectors parameter must be positive, using 1");
+    config_.sectors = 1;
+  }
+  config_.sector_npackets =
+    (int) ceil(config_.npackets / (double) config_.sectors);
+  ROS_INFO_STREAM("publishing " << config_.sector_npackets << " packets per scan"
+                  << " (" << config_.sectors << " sectors per revolution)");
 
   std::string dump_file;
   private_nh.param("pcap", dump_file, std::string(""));
@@ -123,7 +135,7 @@ VelodyneDriver::VelodyneDriver(ros::NodeHandle node,
 
   // initialize diagnostics
   diagnostics_.setHardwareID(deviceName);
-  const double diag_freq = packet_rate/config_.npackets;
+  const double diag_freq = packet_rate/config_.sector_npackets;
   diag_max_freq_ = diag_freq;
   diag_min_freq_ = diag_freq;
   ROS_INFO("expected frequency: %.3f (Hz)", diag_freq);
@@ -164,7 +176,7 @@ bool VelodyneDriver::poll(void)
 
   if( config_.cut_angle >= 0) //Cut at specific angle feature enabled
   {
-    scan->packets.reserve(config_.npackets);
+    scan->packets.reserve(config_.sector_npackets);
     velodyne_msgs::VelodynePacket tmp_packet;
     while(true)
     {
@@ -184,23 +196,29 @@ bool VelodyneDriver::poll(void)
       // Handle overflow 35999->0
       if(azimuth<last_azimuth)
         last_azimuth-=36000;
-      // Check if currently passing cut angle
-      if(   last_azimuth != -1
-         && last_azimuth < config_.cut_angle
-         && azimuth >= config_.cut_angle )
+      // Check if currently passing cut angle, or one of the sector
+      // boundaries following it
+      bool cut = false;
+      if (last_azimuth != -1)
       {
-        last_azimuth = azimuth;
-        break; // Cut angle passed, one full revolution collected
+        for (int sector = 0; sector < config_.sectors && !cut; ++sector)
+        {
+          int boundary = (config_.cut_angle + sector * 36000 / config_.sectors) % 36000;
+          cut = (last_azimuth < boundary && azimuth >= boundary)
+             || (last_azimuth < boundary - 36000 && azimuth >= boundary - 36000);
+        }
       }
       last_azimuth = azimuth;
+      if (cut)
+        break; // Cut angle passed, one full revolution (or sector) collected
     }
   }
   else // standard behaviour
   {
   // Since the velodyne delivers data at a very high rate, keep
   // reading and publishing scans as fast as possible.
-    scan->packets.resize(config_.npackets);
-    for (int i = 0; i < config_.npackets; ++i)
+    scan->packets.resize(config_.sector_npackets);
+    for (int i = 0; i < config_.sector_npackets; ++i)
     {
       while (true)
         {
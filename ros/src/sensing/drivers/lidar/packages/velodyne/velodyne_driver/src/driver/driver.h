@@ -52,7 +52,9 @@ private:
   {
     std::string frame_id;            ///< tf frame ID
     std::string model;               ///< device model name
-    int    npackets;                 ///< number of packets to collect
+    int    npackets;                 ///< number of packets per revolution
+    int    sectors;                  ///< number of sectors per revolution
+    int    sector_npackets;          ///< number of packets to collect
     double rpm;                      ///< device rotation rate (RPMs)
     int cut_angle;                   ///< cutting angle in 1/100°
     double time_offset;              ///< time in seconds added to each velodyne time stamp
@@ -32,6 +32,17 @@ namespace velodyne_pointcloud
     EIGEN_MAKE_ALIGNED_OPERATOR_NEW     // ensure proper alignment
   } EIGEN_ALIGN16;
 
+  /** Velodyne coordinate with ring number and per-point time offset
+   *  (seconds, relative to the header stamp of the containing cloud). */
+  struct PointXYZIRT
+  {
+    PCL_ADD_POINT4D;                    // quad-word XYZ
+    float    intensity;                 ///< laser intensity reading
+    uint16_t ring;                      ///< laser ring number
+    float    time;                      ///< time offset from header stamp [s]
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW     // ensure proper alignment
+  } EIGEN_ALIGN16;
+
 }; // namespace velodyne_pointcloud
 
 
@@ -42,5 +53,13 @@ POINT_CLOUD_REGISTER_POINT_STRUCT(velodyne_pointcloud::PointXYZIR,
                                   (float, intensity, intensity)
                                   (uint16_t, ring, ring))
 
+POINT_CLOUD_REGISTER_POINT_STRUCT(velodyne_pointcloud::PointXYZIRT,
+                                  (float, x, x)
+                                  (float, y, y)
+                                  (float, z, z)
+                                  (float, intensity, intensity)
+                                  (uint16_t, ring, ring)
+                                  (float, time, time))
+
 #endif // __VELODYNE_POINTCLOUD_POINT_TYPES_H
 
@@ -37,6 +37,8 @@ namespace velodyne_rawdata
   // Shorthand typedefs for point cloud representations
   typedef velodyne_pointcloud::PointXYZIR VPoint;
   typedef pcl::PointCloud<VPoint> VPointCloud;
+  typedef velodyne_pointcloud::PointXYZIRT VPointT;
+  typedef pcl::PointCloud<VPointT> VPointCloudT;
 
   /**
    * Raw Velodyne packet constants and structures.
@@ -61,7 +63,34 @@ namespace velodyne_rawdata
   static const float  VLP16_BLOCK_TDURATION   = 110.592f;   // [µs]
   static const float  VLP16_DSR_TOFFSET       =   2.304f;   // [µs]
   static const float  VLP16_FIRING_TOFFSET    =  55.296f;   // [µs]
-  
+
+  /** Largest number of lasers supported by the correction tables */
+  static const int MAX_LASERS = 64;
+
+  /** \brief Per-laser corrections in structure-of-arrays layout.
+   *
+   *  Built from the calibration once at setup, so that the returns
+   *  of a whole firing block can be converted in tight loops over
+   *  contiguous arrays, which the compiler vectorizes.
+   */
+  typedef struct laser_correction_table
+  {
+    float dist_correction[MAX_LASERS];
+    float dist_correction_x[MAX_LASERS];
+    float dist_correction_y[MAX_LASERS];
+    float two_pt_correction[MAX_LASERS];   ///< 1.0 if available, else 0.0
+    float cos_vert_correction[MAX_LASERS];
+    float sin_vert_correction[MAX_LASERS];
+    float cos_rot_correction[MAX_LASERS];
+    float sin_rot_correction[MAX_LASERS];
+    float horiz_offset_correction[MAX_LASERS];
+    float vert_offset_correction[MAX_LASERS];
+    float min_intensity[MAX_LASERS];
+    float max_intensity[MAX_LASERS];
+    float focal_offset[MAX_LASERS];
+    float focal_slope[MAX_LASERS];
+    uint16_t laser_ring[MAX_LASERS];
+  } laser_correction_table_t;
 
   /** \brief Raw Velodyne data block.
    *
@@ -147,6 +176,13 @@ namespace velodyne_rawdata
     int setupOffline(std::string calibration_file, double max_range_, double min_range_);
 
     void unpack(const velodyne_msgs::VelodynePacket &pkt, VPointCloud &pc, int packets_num);
+
+    /** \brief Reference implementation of unpack().
+     *
+     *  Converts one laser return at a time.  Kept for validating and
+     *  benchmarking the block-wise conversion used by unpack().
+     */
+    void unpack_scalar(const velodyne_msgs::VelodynePacket &pkt, VPointCloud &pc, int packets_num);
     
     void setParameters(double min_range, double max_range, double view_direction,
                        double view_width);
@@ -172,9 +208,31 @@ namespace velodyne_rawdata
     velodyne_pointcloud::Calibration calibration_;
     float sin_rot_table_[ROTATION_MAX_UNITS];
     float cos_rot_table_[ROTATION_MAX_UNITS];
-    
+    laser_correction_table_t corrections_;
+
+    /** build corrections_ from the calibration */
+    void setupCorrectionTable();
+
     /** add private function to handle the VLP16 **/ 
     void unpack_vlp16(const velodyne_msgs::VelodynePacket &pkt, VPointCloud &pc);
+    void unpack_vlp16_scalar(const velodyne_msgs::VelodynePacket &pkt, VPointCloud &pc);
+
+    /** convert the returns of consecutive lasers in one firing */
+    void unpackFiring(const uint8_t *data, int count, int laser_origin,
+                      const float *cos_azimuth, const float *sin_azimuth,
+                      const bool *in_view, float distance_resolution,
+                      bool vlp16, VPointCloud &pc);
+
+    /** in-line test whether an azimuth is in the configured view */
+    bool azimuthInView(int azimuth)
+    {
+      return ((azimuth >= config_.min_angle
+               && azimuth <= config_.max_angle
+               && config_.min_angle < config_.max_angle)
+              || (config_.min_angle > config_.max_angle
+                  && (azimuth <= config_.max_angle
+                      || azimuth >= config_.min_angle)));
+    }
 
     /** in-line test whether a point is in range */
     bool pointInRange(float range)
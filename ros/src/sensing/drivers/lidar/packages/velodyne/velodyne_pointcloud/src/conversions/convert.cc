@@ -21,14 +21,36 @@ namespace velodyne_pointcloud
 {
   /** @brief Constructor. */
   Convert::Convert(ros::NodeHandle node, ros::NodeHandle private_nh):
-    data_(new velodyne_rawdata::RawData())
+    data_(new velodyne_rawdata::RawData()),
+    last_azimuth_(-1)
   {
     data_->setup(private_nh);
 
+    // In sector mode the driver publishes partial revolutions, so the
+    // packet count of a revolution must be given explicitly (0: use
+    // the number of packets of each received message).
+    private_nh.param("npackets", config_.npackets, 0);
+    private_nh.param("sector_mode", config_.sector_mode, false);
+    // full scans carry per-point time (relative to the header stamp,
+    // i.e. the last packet) if requested, as needed for deskewing;
+    // sectors always do
+    private_nh.param("point_time", config_.point_time, false);
+    double cut_angle;
+    private_nh.param("cut_angle", cut_angle, -0.01);
+    config_.cut_angle = (cut_angle < 0.0) ? 0 : int((cut_angle*360/(2*M_PI))*100);
 
     // advertise output point cloud (before subscribing to input data)
-    output_ =
-      node.advertise<sensor_msgs::PointCloud2>("velodyne_points", 10);
+    if (config_.sector_mode)
+      {
+        ROS_INFO_STREAM("Publishing azimuth sectors on velodyne_sectors");
+        output_ =
+          node.advertise<sensor_msgs::PointCloud2>("velodyne_sectors", 10);
+      }
+    else
+      {
+        output_ =
+          node.advertise<sensor_msgs::PointCloud2>("velodyne_points", 10);
+      }
       
     srv_ = boost::make_shared <dynamic_reconfigure::Server<velodyne_pointcloud::
       CloudNodeConfig> > (private_nh);
@@ -38,10 +60,16 @@ namespace velodyne_pointcloud
     srv_->setCallback (f);
 
     // subscribe to VelodyneScan packets
-    velodyne_scan_ =
-      node.subscribe("velodyne_packets", 10,
-                     &Convert::processScan, (Convert *) this,
-                     ros::TransportHints().tcpNoDelay(true));
+    if (config_.sector_mode)
+      velodyne_scan_ =
+        node.subscribe("velodyne_packets", 10,
+                       &Convert::processSectors, (Convert *) this,
+                       ros::TransportHints().tcpNoDelay(true));
+    else
+      velodyne_scan_ =
+        node.subscribe("velodyne_packets", 10,
+                       &Convert::processScan, (Convert *) this,
+                       ros::TransportHints().tcpNoDelay(true));
   }
   
   void Convert::callback(velodyne_pointcloud::CloudNodeConfig &config,
@@ -58,6 +86,32 @@ namespace velodyne_pointcloud
     if (output_.getNumSubscribers() == 0)         // no one listening?
       return;                                     // avoid much work
 
+    int packets_num = (config_.npackets > 0) ?
+      config_.npackets : scanMsg->packets.size();
+
+    if (config_.point_time)
+      {
+        velodyne_rawdata::VPointCloudT::Ptr
+          outMsg(new velodyne_rawdata::VPointCloudT());
+        outMsg->header.stamp = pcl_conversions::toPCL(scanMsg->header).stamp;
+        outMsg->header.frame_id = scanMsg->header.frame_id;
+        outMsg->height = 1;
+        outMsg->points.reserve(scanMsg->packets.size()
+                               * velodyne_rawdata::SCANS_PER_PACKET);
+
+        for (size_t i = 0; i < scanMsg->packets.size(); ++i)
+          {
+            appendPacket(scanMsg->packets[i], packets_num,
+                         scanMsg->header.stamp, *outMsg);
+          }
+        outMsg->width = outMsg->points.size();
+
+        ROS_DEBUG_STREAM("Publishing " << outMsg->height * outMsg->width
+                         << " Velodyne points, time: " << outMsg->header.stamp);
+        output_.publish(outMsg);
+        return;
+      }
+
     // allocate a point cloud with same time and frame ID as raw data
     velodyne_rawdata::VPointCloud::Ptr
       outMsg(new velodyne_rawdata::VPointCloud());
@@ -65,11 +119,13 @@ namespace velodyne_pointcloud
     outMsg->header.stamp = pcl_conversions::toPCL(scanMsg->header).stamp;
     outMsg->header.frame_id = scanMsg->header.frame_id;
     outMsg->height = 1;
+    outMsg->points.reserve(scanMsg->packets.size()
+                           * velodyne_rawdata::SCANS_PER_PACKET);
 
     // process each packet provided by the driver
     for (size_t i = 0; i < scanMsg->packets.size(); ++i)
       {
-        data_->unpack(scanMsg->packets[i], *outMsg, scanMsg->packets.size());
+        data_->unpack(scanMsg->packets[i], *outMsg, packets_num);
       }
 
     // publish the accumulated cloud message
@@ -78,4 +134,94 @@ namespace velodyne_pointcloud
     output_.publish(outMsg);
   }
 
+  /** @brief Callback for raw sector messages (sector streaming mode).
+   *
+   *  Every packet is unpacked as soon as it arrives and its points are
+   *  stamped with their time offset from the start of the revolution.
+   *  All sectors of one revolution carry the same header stamp, so
+   *  consumers (see SectorAssembler) can rebuild full scans.  A sector
+   *  is split when the azimuth passes the cut angle, so a published
+   *  sector never spans two revolutions.
+   */
+  void Convert::processSectors(const velodyne_msgs::VelodyneScan::ConstPtr &scanMsg)
+  {
+    if (output_.getNumSubscribers() == 0)         // no one listening?
+      {
+        last_azimuth_ = -1;
+        return;                                   // avoid much work
+      }
+
+    int packets_num = (config_.npackets > 0) ?
+      config_.npackets : scanMsg->packets.size();
+
+    for (size_t i = 0; i < scanMsg->packets.size(); ++i)
+      {
+        const velodyne_msgs::VelodynePacket &pkt = scanMsg->packets[i];
+        const velodyne_rawdata::raw_packet_t *raw =
+          (const velodyne_rawdata::raw_packet_t *) &pkt.data[0];
+
+        // azimuth of the first block, relative to the cut angle
+        int azimuth = (raw->blocks[0].rotation + 36000 - config_.cut_angle) % 36000;
+        if (last_azimuth_ < 0 || azimuth < last_azimuth_)
+          {
+            // a new revolution starts with this packet
+            publishSector();
+            revolution_stamp_ = pkt.stamp;
+          }
+        last_azimuth_ = azimuth;
+
+        if (!sectorPc_)
+          {
+            sectorPc_.reset(new velodyne_rawdata::VPointCloudT());
+            sectorPc_->header.stamp = pcl_conversions::toPCL(revolution_stamp_);
+            sectorPc_->header.frame_id = scanMsg->header.frame_id;
+            sectorPc_->height = 1;
+            sectorPc_->points.reserve(scanMsg->packets.size()
+                                      * velodyne_rawdata::SCANS_PER_PACKET);
+          }
+
+        appendPacket(pkt, packets_num, revolution_stamp_, *sectorPc_);
+      }
+
+    publishSector();
+  }
+
+  /** @brief Unpack a packet, stamping its points relative to @a stamp. */
+  void Convert::appendPacket(const velodyne_msgs::VelodynePacket &pkt,
+                             int packets_num, const ros::Time &stamp,
+                             velodyne_rawdata::VPointCloudT &pc)
+  {
+    packetPc_.points.clear();
+    packetPc_.width = 0;
+    data_->unpack(pkt, packetPc_, packets_num);
+
+    float time = (pkt.stamp - stamp).toSec();
+    for (size_t j = 0; j < packetPc_.points.size(); ++j)
+      {
+        const velodyne_rawdata::VPoint &in = packetPc_.points[j];
+        velodyne_rawdata::VPointT point;
+        point.x = in.x;
+        point.y = in.y;
+        point.z = in.z;
+        point.intensity = in.intensity;
+        point.ring = in.ring;
+        point.time = time;
+        pc.points.push_back(point);
+      }
+  }
+
+  /** @brief Publish the points accumulated since the last sector. */
+  void Convert::publishSector()
+  {
+    if (!sectorPc_ || sectorPc_->points.empty())
+      return;
+
+    sectorPc_->width = sectorPc_->points.size();
+    ROS_DEBUG_STREAM("Publishing " << sectorPc_->width
+                     << " Velodyne sector points, time: "
+                     << sectorPc_->header.stamp);
+    output_.publish(sectorPc_);
+    sectorPc_.reset();
+  }
+
 } // namespace velodyne_pointcloud
@@ -39,6 +39,11 @@ namespace velodyne_pointcloud
     void callback(velodyne_pointcloud::CloudNodeConfig &config,
                 uint32_t level);
     void processScan(const velodyne_msgs::VelodyneScan::ConstPtr &scanMsg);
+    void processSectors(const velodyne_msgs::VelodyneScan::ConstPtr &scanMsg);
+    void publishSector();
+    void appendPacket(const velodyne_msgs::VelodynePacket &pkt,
+                      int packets_num, const ros::Time &stamp,
+                      velodyne_rawdata::VPointCloudT &pc);
 
     ///Pointer to dynamic reconfigure service srv_
     boost::shared_ptr<dynamic_reconfigure::Server<velodyne_pointcloud::
@@ -50,9 +55,20 @@ namespace velodyne_pointcloud
 
     /// configuration parameters
     typedef struct {
-      int npackets;                    ///< number of packets to combine
+      int npackets;                    ///< number of packets per revolution
+      bool sector_mode;                ///< publish azimuth sectors
+      bool point_time;                 ///< publish per-point time
+      int cut_angle;                   ///< revolution start in 1/100 deg
     } Config;
     Config config_;
+
+    // State for sector streaming: points of the current revolution
+    // which have not been published yet, and the stamp of the first
+    // packet of that revolution (shared by all of its sectors).
+    velodyne_rawdata::VPointCloud packetPc_;
+    velodyne_rawdata::VPointCloudT::Ptr sectorPc_;
+    ros::Time revolution_stamp_;
+    int last_azimuth_;
   };
 
 } // namespace velodyne_pointcloud
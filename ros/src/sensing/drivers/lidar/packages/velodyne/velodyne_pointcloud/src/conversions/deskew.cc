@@ -0,0 +1,366 @@
+/*
+ *  License: Modified BSD Software License Agreement
+ *
+ *  $Id$
+ */
+
+/** @file
+
+    This class removes the motion skew of a rotating LIDAR scan.
+
+    Points are processed in batches of (nearly) equal time, typically
+    one azimuth block or packet.  The motion from the time of a batch
+    to the end of the scan is integrated once from the twist buffer,
+    then applied to the whole batch in a loop over contiguous x, y, z
+    arrays, which the compiler vectorizes.
+
+*/
+
+#include "deskew.h"
+
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+
+namespace velodyne_pointcloud
+{
+  /** maximum number of points transformed in one batch */
+  static const size_t MAX_BATCH = 4096;
+
+  /** @brief Rotation by the rotation vector @a w. */
+  static Eigen::Matrix3f rotationFromVector(const Eigen::Vector3f &w)
+  {
+    float angle = w.norm();
+    if (angle < 1e-9f)
+      return Eigen::Matrix3f::Identity();
+    return Eigen::AngleAxisf(angle, w / angle).toRotationMatrix();
+  }
+
+  /** @brief Offset of a field in a PointCloud2, or -1 if missing. */
+  static int fieldOffset(const sensor_msgs::PointCloud2 &cloud,
+                         const std::string &name, uint8_t &datatype)
+  {
+    for (size_t i = 0; i < cloud.fields.size(); ++i)
+      {
+        if (cloud.fields[i].name == name)
+          {
+            datatype = cloud.fields[i].datatype;
+            return cloud.fields[i].offset;
+          }
+      }
+    return -1;
+  }
+
+  /** @brief Read a FLOAT32 or FLOAT64 field of a point. */
+  static double readTime(const uint8_t *point, int offset, uint8_t datatype)
+  {
+    if (datatype == sensor_msgs::PointField::FLOAT64)
+      {
+        double value;
+        memcpy(&value, point + offset, sizeof(value));
+        return value;
+      }
+    float value;
+    memcpy(&value, point + offset, sizeof(value));
+    return value;
+  }
+
+  /** @brief Write a FLOAT32 or FLOAT64 field of a point. */
+  static void writeTime(uint8_t *point, int offset, uint8_t datatype,
+                        double time)
+  {
+    if (datatype == sensor_msgs::PointField::FLOAT64)
+      {
+        memcpy(point + offset, &time, sizeof(time));
+        return;
+      }
+    float value = time;
+    memcpy(point + offset, &value, sizeof(value));
+  }
+
+  /** @brief Constructor. */
+  Deskew::Deskew(ros::NodeHandle node, ros::NodeHandle private_nh)
+  {
+    private_nh.param("time_field", config_.time_field, std::string("time"));
+    private_nh.param("time_resolution", config_.time_resolution, 0.0005);
+    private_nh.param("twist_buffer", config_.twist_buffer, 2.0);
+    private_nh.param("max_twist_gap", config_.max_twist_gap, 0.2);
+
+    x_.resize(MAX_BATCH);
+    y_.resize(MAX_BATCH);
+    z_.resize(MAX_BATCH);
+
+    // advertise output point cloud (before subscribing to input data)
+    output_ =
+      node.advertise<sensor_msgs::PointCloud2>("velodyne_points_deskewed", 10);
+
+    twist_ = node.subscribe("current_velocity", 100,
+                            &Deskew::processTwist, (Deskew *) this,
+                            ros::TransportHints().tcpNoDelay(true));
+    velodyne_points_ = node.subscribe("velodyne_points", 10,
+                                      &Deskew::processScan, (Deskew *) this,
+                                      ros::TransportHints().tcpNoDelay(true));
+  }
+
+  /** @brief Callback for twist messages: buffer them. */
+  void Deskew::processTwist(const geometry_msgs::TwistStamped::ConstPtr &twistMsg)
+  {
+    boost::mutex::scoped_lock lock(twists_mutex_);
+
+    // restart the buffer if time jumped back (e.g. bag looped)
+    if (!twists_.empty() && twistMsg->header.stamp < twists_.back()->header.stamp)
+      twists_.clear();
+
+    twists_.push_back(twistMsg);
+    while (!twists_.empty()
+           && (twistMsg->header.stamp - twists_.front()->header.stamp).toSec()
+              > config_.twist_buffer)
+      twists_.pop_front();
+  }
+
+  /** @brief Copy the twists covering [begin, end] into the cloud frame.
+   *
+   *  @returns false if the buffer does not cover the scan.
+   */
+  bool Deskew::twistWindow(const sensor_msgs::PointCloud2 &scan,
+                           double begin, double end,
+                           std::vector<TwistSample> &window)
+  {
+    std::vector<geometry_msgs::TwistStamped::ConstPtr> twists;
+    {
+      boost::mutex::scoped_lock lock(twists_mutex_);
+      for (size_t i = 0; i < twists_.size(); ++i)
+        {
+          double stamp = twists_[i]->header.stamp.toSec();
+          if (stamp > end)
+            break;
+          // keep the latest twist before the scan, it holds at begin
+          if (stamp <= begin && !twists.empty())
+            twists.clear();
+          twists.push_back(twists_[i]);
+        }
+    }
+
+    if (twists.empty()
+        || twists.back()->header.stamp.toSec() < begin - config_.max_twist_gap)
+      return false;
+
+    // rotation and translation from the twist frame to the cloud frame
+    tf::Matrix3x3 rotation(tf::Matrix3x3::getIdentity());
+    tf::Vector3 translation(0, 0, 0);
+    const std::string &twist_frame = twists.back()->header.frame_id;
+    if (!twist_frame.empty() && twist_frame != scan.header.frame_id)
+      {
+        tf::StampedTransform transform;
+        try
+          {
+            listener_.lookupTransform(scan.header.frame_id, twist_frame,
+                                      ros::Time(0), transform);
+          }
+        catch (tf::TransformException &ex)
+          {
+            ROS_WARN_STREAM_THROTTLE(10, "Deskew: " << ex.what());
+            return false;
+          }
+        rotation = transform.getBasis();
+        translation = transform.getOrigin();
+      }
+    // origin of the cloud frame, expressed in the twist frame
+    tf::Vector3 sensor_origin = -(rotation.transpose() * translation);
+
+    window.resize(twists.size());
+    for (size_t i = 0; i < twists.size(); ++i)
+      {
+        const geometry_msgs::Twist &twist = twists[i]->twist;
+        tf::Vector3 linear(twist.linear.x, twist.linear.y, twist.linear.z);
+        tf::Vector3 angular(twist.angular.x, twist.angular.y, twist.angular.z);
+
+        // velocity of the sensor origin, rotated into the cloud frame
+        linear = rotation * (linear + angular.cross(sensor_origin));
+        angular = rotation * angular;
+
+        window[i].stamp = twists[i]->header.stamp.toSec();
+        window[i].linear = Eigen::Vector3f(linear.x(), linear.y(), linear.z());
+        window[i].angular = Eigen::Vector3f(angular.x(), angular.y(), angular.z());
+      }
+    return true;
+  }
+
+  /** @brief Integrate the motion of the sensor from @a from to @a to.
+   *
+   *  Each twist holds until the next one is received.
+   *
+   *  @param rotation orientation of the sensor at @a to, in the
+   *                  sensor frame at @a from
+   *  @param translation position of the sensor at @a to, in the
+   *                     sensor frame at @a from
+   */
+  void Deskew::integrate(const std::vector<TwistSample> &window,
+                         double from, double to,
+                         Eigen::Matrix3f &rotation, Eigen::Vector3f &translation)
+  {
+    rotation.setIdentity();
+    translation.setZero();
+
+    size_t k = 0;
+    while (k + 1 < window.size() && window[k + 1].stamp <= from)
+      ++k;
+
+    double s = from;
+    while (s < to)
+      {
+        double next = to;
+        if (k + 1 < window.size() && window[k + 1].stamp < to)
+          next = window[k + 1].stamp;
+        float dt = next - s;
+
+        // midpoint rule for the translation
+        const TwistSample &twist = window[k];
+        translation += rotation
+          * (rotationFromVector(twist.angular * (0.5f * dt)) * twist.linear) * dt;
+        rotation = rotation * rotationFromVector(twist.angular * dt);
+
+        s = next;
+        if (k + 1 < window.size() && window[k + 1].stamp <= s)
+          ++k;
+      }
+  }
+
+  /** @brief Apply p' = rotation * p + translation to @a count points. */
+  void Deskew::transformBatch(uint8_t *data, uint32_t point_step, size_t count,
+                              const int *xyz_offsets,
+                              const Eigen::Matrix3f &rotation,
+                              const Eigen::Vector3f &translation)
+  {
+    float *x = &x_[0];
+    float *y = &y_[0];
+    float *z = &z_[0];
+
+    // gather into contiguous arrays
+    for (size_t i = 0; i < count; ++i)
+      {
+        const uint8_t *point = data + i * point_step;
+        memcpy(&x[i], point + xyz_offsets[0], sizeof(float));
+        memcpy(&y[i], point + xyz_offsets[1], sizeof(float));
+        memcpy(&z[i], point + xyz_offsets[2], sizeof(float));
+      }
+
+    const float r00 = rotation(0, 0), r01 = rotation(0, 1), r02 = rotation(0, 2);
+    const float r10 = rotation(1, 0), r11 = rotation(1, 1), r12 = rotation(1, 2);
+    const float r20 = rotation(2, 0), r21 = rotation(2, 1), r22 = rotation(2, 2);
+    const float t0 = translation(0), t1 = translation(1), t2 = translation(2);
+    for (size_t i = 0; i < count; ++i)
+      {
+        float px = x[i], py = y[i], pz = z[i];
+        x[i] = r00 * px + r01 * py + r02 * pz + t0;
+        y[i] = r10 * px + r11 * py + r12 * pz + t1;
+        z[i] = r20 * px + r21 * py + r22 * pz + t2;
+      }
+
+    // scatter back into the point records
+    for (size_t i = 0; i < count; ++i)
+      {
+        uint8_t *point = data + i * point_step;
+        memcpy(point + xyz_offsets[0], &x[i], sizeof(float));
+        memcpy(point + xyz_offsets[1], &y[i], sizeof(float));
+        memcpy(point + xyz_offsets[2], &z[i], sizeof(float));
+      }
+  }
+
+  /** @brief Callback for point clouds with per-point time. */
+  void Deskew::processScan(const sensor_msgs::PointCloud2::ConstPtr &scanMsg)
+  {
+    if (output_.getNumSubscribers() == 0)         // no one listening?
+      return;                                     // avoid much work
+
+    uint8_t x_type = 0, y_type = 0, z_type = 0, time_type = 0;
+    int xyz_offsets[3];
+    xyz_offsets[0] = fieldOffset(*scanMsg, "x", x_type);
+    xyz_offsets[1] = fieldOffset(*scanMsg, "y", y_type);
+    xyz_offsets[2] = fieldOffset(*scanMsg, "z", z_type);
+    int time_offset = fieldOffset(*scanMsg, config_.time_field, time_type);
+
+    if (xyz_offsets[0] < 0 || xyz_offsets[1] < 0 || xyz_offsets[2] < 0
+        || x_type != sensor_msgs::PointField::FLOAT32
+        || y_type != sensor_msgs::PointField::FLOAT32
+        || z_type != sensor_msgs::PointField::FLOAT32
+        || time_offset < 0
+        || (time_type != sensor_msgs::PointField::FLOAT32
+            && time_type != sensor_msgs::PointField::FLOAT64))
+      {
+        ROS_WARN_STREAM_THROTTLE(10, "Deskew: cloud needs FLOAT32 x, y, z and a "
+                                 "FLOAT32/FLOAT64 '" << config_.time_field
+                                 << "' field, publishing it unchanged");
+        output_.publish(scanMsg);
+        return;
+      }
+
+    const size_t n = scanMsg->width * scanMsg->height;
+    const uint32_t step = scanMsg->point_step;
+    if (n == 0)
+      {
+        output_.publish(scanMsg);
+        return;
+      }
+
+    // time span of the scan
+    double min_time = readTime(&scanMsg->data[0], time_offset, time_type);
+    double max_time = min_time;
+    for (size_t i = 1; i < n; ++i)
+      {
+        double time = readTime(&scanMsg->data[i * step], time_offset, time_type);
+        min_time = std::min(min_time, time);
+        max_time = std::max(max_time, time);
+      }
+    const double stamp = scanMsg->header.stamp.toSec();
+    const double end = stamp + max_time;
+
+    std::vector<TwistSample> window;
+    if (!twistWindow(*scanMsg, stamp + min_time, end, window))
+      {
+        ROS_WARN_STREAM_THROTTLE(10, "Deskew: no twist available for the scan at "
+                                 << scanMsg->header.stamp
+                                 << ", publishing it unchanged");
+        output_.publish(scanMsg);
+        return;
+      }
+
+    sensor_msgs::PointCloud2::Ptr outMsg(new sensor_msgs::PointCloud2(*scanMsg));
+    uint8_t *data = &outMsg->data[0];
+
+    Eigen::Matrix3f rotation;
+    Eigen::Vector3f translation;
+    size_t begin = 0;
+    while (begin < n)
+      {
+        // batch of consecutive points of (nearly) the same time
+        double batch_time = readTime(data + begin * step, time_offset, time_type);
+        size_t end_index = begin + 1;
+        while (end_index < n && end_index - begin < MAX_BATCH
+               && fabs(readTime(data + end_index * step, time_offset, time_type)
+                       - batch_time) <= config_.time_resolution)
+          ++end_index;
+
+        // p_end = R^T (p - t), with (R, t) the sensor pose at the end of
+        // the scan in the sensor frame at batch_time
+        integrate(window, stamp + batch_time, end, rotation, translation);
+        Eigen::Matrix3f inverse = rotation.transpose();
+        transformBatch(data + begin * step, step, end_index - begin,
+                       xyz_offsets, inverse, -(inverse * translation));
+
+        begin = end_index;
+      }
+
+    // all points are now relative to the end of the scan
+    for (size_t i = 0; i < n; ++i)
+      {
+        uint8_t *point = data + i * step;
+        writeTime(point, time_offset, time_type,
+                  readTime(point, time_offset, time_type) - max_time);
+      }
+    outMsg->header.stamp = ros::Time(end);
+
+    output_.publish(outMsg);
+  }
+
+} // namespace velodyne_pointcloud
@@ -0,0 +1,94 @@
+/* -*- mode: C++ -*- */
+/*
+ *  License: Modified BSD Software License Agreement
+ *
+ *  $Id$
+ */
+
+/** @file
+
+    This class removes the motion skew of a rotating LIDAR scan.
+
+    Any PointCloud2 carrying a per-point time field (seconds relative
+    to the header stamp) can be deskewed.  Every point is transformed
+    into the sensor frame at the time of the latest point of the
+    scan, using the vehicle twist received during the scan.
+
+*/
+
+#ifndef _VELODYNE_POINTCLOUD_DESKEW_H_
+#define _VELODYNE_POINTCLOUD_DESKEW_H_ 1
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include <boost/thread/mutex.hpp>
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+
+#include <ros/ros.h>
+#include <tf/transform_listener.h>
+#include <geometry_msgs/TwistStamped.h>
+#include <sensor_msgs/PointCloud2.h>
+
+namespace velodyne_pointcloud
+{
+  class Deskew
+  {
+  public:
+
+    Deskew(ros::NodeHandle node, ros::NodeHandle private_nh);
+    ~Deskew() {}
+
+  private:
+
+    /** twist sample, expressed in the frame of the point cloud */
+    struct TwistSample
+    {
+      double stamp;                    ///< [s]
+      Eigen::Vector3f linear;          ///< [m/s]
+      Eigen::Vector3f angular;         ///< [rad/s]
+    };
+
+    void processTwist(const geometry_msgs::TwistStamped::ConstPtr &twistMsg);
+    void processScan(const sensor_msgs::PointCloud2::ConstPtr &scanMsg);
+
+    bool twistWindow(const sensor_msgs::PointCloud2 &scan,
+                     double begin, double end,
+                     std::vector<TwistSample> &window);
+    void integrate(const std::vector<TwistSample> &window,
+                   double from, double to,
+                   Eigen::Matrix3f &rotation, Eigen::Vector3f &translation);
+    void transformBatch(uint8_t *data, uint32_t point_step, size_t count,
+                        const int *xyz_offsets,
+                        const Eigen::Matrix3f &rotation,
+                        const Eigen::Vector3f &translation);
+
+    ros::Subscriber velodyne_points_;
+    ros::Subscriber twist_;
+    ros::Publisher output_;
+    tf::TransformListener listener_;
+
+    boost::mutex twists_mutex_;
+    std::deque<geometry_msgs::TwistStamped::ConstPtr> twists_;
+
+    /// configuration parameters
+    typedef struct {
+      std::string time_field;          ///< name of the per-point time field
+      double time_resolution;          ///< max time span of a batch [s]
+      double twist_buffer;             ///< length of the twist buffer [s]
+      double max_twist_gap;            ///< max extrapolation of twist [s]
+    } Config;
+    Config config_;
+
+    // SoA buffers for one batch of points, class members only to
+    // avoid reallocation on every message
+    std::vector<float> x_;
+    std::vector<float> y_;
+    std::vector<float> z_;
+  };
+
+} // namespace velodyne_pointcloud
+
+#endif // _VELODYNE_POINTCLOUD_DESKEW_H_
@@ -0,0 +1,31 @@
+/*
+ *  License: Modified BSD Software License Agreement
+ *
+ *  $Id$
+ */
+
+/** @file
+
+    This ROS node removes the motion skew of point clouds carrying a
+    per-point time field, using the vehicle twist.
+
+*/
+
+#include <ros/ros.h>
+#include "deskew.h"
+
+/** Main node entry point. */
+int main(int argc, char **argv)
+{
+  ros::init(argc, argv, "deskew_node");
+  ros::NodeHandle node;
+  ros::NodeHandle priv_nh("~");
+
+  // create deskew class, which subscribes to point clouds and twist
+  velodyne_pointcloud::Deskew deskew(node, priv_nh);
+
+  // handle callbacks until shut down
+  ros::spin();
+
+  return 0;
+}
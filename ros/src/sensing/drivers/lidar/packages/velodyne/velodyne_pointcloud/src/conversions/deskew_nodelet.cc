@@ -0,0 +1,47 @@
+/*
+ *  License: Modified BSD Software License Agreement
+ *
+ *  $Id$
+ */
+
+/** @file
+
+    This ROS nodelet removes the motion skew of point clouds carrying a
+    per-point time field, using the vehicle twist.
+
+*/
+
+#include <ros/ros.h>
+#include <pluginlib/class_list_macros.h>
+#include <nodelet/nodelet.h>
+
+#include "deskew.h"
+
+namespace velodyne_pointcloud
+{
+  class DeskewNodelet: public nodelet::Nodelet
+  {
+  public:
+
+    DeskewNodelet() {}
+    ~DeskewNodelet() {}
+
+  private:
+
+    virtual void onInit();
+    boost::shared_ptr<Deskew> deskew_;
+  };
+
+  /** @brief Nodelet initialization. */
+  void DeskewNodelet::onInit()
+  {
+    deskew_.reset(new Deskew(getNodeHandle(), getPrivateNodeHandle()));
+  }
+
+} // namespace velodyne_pointcloud
+
+
+// Register this plugin with pluginlib.  Names must match nodelets.xml.
+//
+// parameters: class type, base class type
+PLUGINLIB_EXPORT_CLASS(velodyne_pointcloud::DeskewNodelet, nodelet::Nodelet)
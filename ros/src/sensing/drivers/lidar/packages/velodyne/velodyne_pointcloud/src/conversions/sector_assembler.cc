@@ -0,0 +1,65 @@
+/*
+ *  License: Modified BSD Software License Agreement
+ *
+ *  $Id$
+ */
+
+/** @file
+
+    Reassembles full Velodyne revolutions from azimuth sectors.
+
+    A revolution is complete as soon as the first sector of the next
+    one arrives, which is the same point in time at which the driver
+    would have published the whole revolution without sector mode.
+
+*/
+
+#include "sector_assembler.h"
+
+namespace velodyne_pointcloud
+{
+  /** @brief Constructor. */
+  SectorAssembler::SectorAssembler(ros::NodeHandle node,
+                                   ros::NodeHandle private_nh):
+    expected_points_(0)
+  {
+    // advertise output point cloud (before subscribing to input data)
+    output_ = node.advertise<sensor_msgs::PointCloud2>("velodyne_points", 10);
+
+    input_ = node.subscribe("velodyne_sectors", 10,
+                            &SectorAssembler::processSector,
+                            (SectorAssembler *) this,
+                            ros::TransportHints().tcpNoDelay(true));
+  }
+
+  /** @brief Callback for sector messages. */
+  void SectorAssembler::processSector(const VPointCloudT::ConstPtr &sectorMsg)
+  {
+    if (scan_ && scan_->header.stamp != sectorMsg->header.stamp)
+      publishScan();
+
+    if (!scan_)
+      {
+        scan_.reset(new VPointCloudT());
+        scan_->header = sectorMsg->header;
+        scan_->height = 1;
+        scan_->points.reserve(expected_points_);
+      }
+
+    scan_->points.insert(scan_->points.end(),
+                         sectorMsg->points.begin(), sectorMsg->points.end());
+  }
+
+  /** @brief Publish the assembled revolution. */
+  void SectorAssembler::publishScan()
+  {
+    scan_->width = scan_->points.size();
+    expected_points_ = std::max(expected_points_, scan_->points.size());
+
+    ROS_DEBUG_STREAM("Publishing " << scan_->width
+                     << " Velodyne points, time: " << scan_->header.stamp);
+    output_.publish(scan_);
+    scan_.reset();
+  }
+
+} // namespace velodyne_pointcloud
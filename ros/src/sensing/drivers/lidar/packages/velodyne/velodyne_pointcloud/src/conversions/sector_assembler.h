@@ -0,0 +1,52 @@
+/* -*- mode: C++ -*- */
+/*
+ *  License: Modified BSD Software License Agreement
+ *
+ *  $Id$
+ */
+
+/** @file
+
+    Interface for reassembling full Velodyne revolutions from the
+    azimuth sectors published by the cloud nodelet in sector mode.
+
+*/
+
+#ifndef _VELODYNE_POINTCLOUD_SECTOR_ASSEMBLER_H_
+#define _VELODYNE_POINTCLOUD_SECTOR_ASSEMBLER_H_
+
+#include <ros/ros.h>
+#include <pcl_ros/point_cloud.h>
+#include <velodyne_pointcloud/point_types.h>
+
+namespace velodyne_pointcloud
+{
+  // shorter names for point cloud types in this namespace
+  typedef velodyne_pointcloud::PointXYZIRT VPointT;
+  typedef pcl::PointCloud<VPointT> VPointCloudT;
+
+  /** Collects the sectors of one revolution and publishes the full
+   *  scan.  Sectors of a revolution share the header stamp, and each
+   *  point keeps its ring and time offset from that stamp. */
+  class SectorAssembler
+  {
+  public:
+
+    SectorAssembler(ros::NodeHandle node, ros::NodeHandle private_nh);
+    ~SectorAssembler() {}
+
+  private:
+
+    void processSector(const VPointCloudT::ConstPtr &sectorMsg);
+    void publishScan();
+
+    ros::Subscriber input_;
+    ros::Publisher output_;
+
+    VPointCloudT::Ptr scan_;          ///< revolution being assembled
+    size_t expected_points_;          ///< size of the last full scan
+  };
+
+} // namespace velodyne_pointcloud
+
+#endif // _VELODYNE_POINTCLOUD_SECTOR_ASSEMBLER_H_
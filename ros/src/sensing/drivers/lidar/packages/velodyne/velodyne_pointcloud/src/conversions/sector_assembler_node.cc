@@ -0,0 +1,31 @@
+/*
+ *  License: Modified BSD Software License Agreement
+ *
+ *  $Id$
+ */
+
+/** @file
+
+    This ROS node reassembles full Velodyne revolutions from the
+    azimuth sectors published by the cloud node in sector mode.
+
+*/
+
+#include <ros/ros.h>
+#include "sector_assembler.h"
+
+/** Main node entry point. */
+int main(int argc, char **argv)
+{
+  ros::init(argc, argv, "sector_assembler_node");
+  ros::NodeHandle node;
+  ros::NodeHandle priv_nh("~");
+
+  // create assembler class, which subscribes to sector messages
+  velodyne_pointcloud::SectorAssembler assembler(node, priv_nh);
+
+  // handle callbacks until shut down
+  ros::spin();
+
+  return 0;
+}
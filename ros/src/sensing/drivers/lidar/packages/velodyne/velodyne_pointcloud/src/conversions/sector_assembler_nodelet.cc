@@ -0,0 +1,48 @@
+/*
+ *  License: Modified BSD Software License Agreement
+ *
+ *  $Id$
+ */
+
+/** @file
+
+    This ROS nodelet reassembles full Velodyne revolutions from the
+    azimuth sectors published by the cloud nodelet in sector mode.
+
+*/
+
+#include <ros/ros.h>
+#include <pluginlib/class_list_macros.h>
+#include <nodelet/nodelet.h>
+
+#include "sector_assembler.h"
+
+namespace velodyne_pointcloud
+{
+  class SectorAssemblerNodelet: public nodelet::Nodelet
+  {
+  public:
+
+    SectorAssemblerNodelet() {}
+    ~SectorAssemblerNodelet() {}
+
+  private:
+
+    virtual void onInit();
+    boost::shared_ptr<SectorAssembler> assembler_;
+  };
+
+  /** @brief Nodelet initialization. */
+  void SectorAssemblerNodelet::onInit()
+  {
+    assembler_.reset(new SectorAssembler(getNodeHandle(),
+                                         getPrivateNodeHandle()));
+  }
+
+} // namespace velodyne_pointcloud
+
+
+// Register this plugin with pluginlib.  Names must match nodelets.xml.
+//
+// parameters: class type, base class type
+PLUGINLIB_EXPORT_CLASS(velodyne_pointcloud::SectorAssemblerNodelet, nodelet::Nodelet)
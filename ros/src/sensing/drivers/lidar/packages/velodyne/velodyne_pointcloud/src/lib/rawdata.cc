@@ -27,6 +27,7 @@
 
 #include <fstream>
 #include <math.h>
+#include <string.h>
 
 #include <ros/ros.h>
 #include <ros/package.h>
@@ -103,6 +104,7 @@ namespace velodyne_rawdata
       cos_rot_table_[rot_index] = cosf(rotation);
       sin_rot_table_[rot_index] = sinf(rotation);
     }
+    setupCorrectionTable();
    return 0;
   }
 
@@ -134,11 +136,49 @@ namespace velodyne_rawdata
 	  cos_rot_table_[rot_index] = cosf(rotation);
 	  sin_rot_table_[rot_index] = sinf(rotation);
       }
+      setupCorrectionTable();
       return 0;
   }
 
+  /** Copy the per-laser calibration into contiguous arrays */
+  void RawData::setupCorrectionTable()
+  {
+    memset(&corrections_, 0, sizeof(corrections_));
+    for (int laser = 0; laser < MAX_LASERS; ++laser)
+      {
+        std::map<int, velodyne_pointcloud::LaserCorrection>::const_iterator it =
+          calibration_.laser_corrections.find(laser);
+        if (it == calibration_.laser_corrections.end())
+          continue;
+        const velodyne_pointcloud::LaserCorrection &c = it->second;
+
+        corrections_.dist_correction[laser] = c.dist_correction;
+        corrections_.dist_correction_x[laser] = c.dist_correction_x;
+        corrections_.dist_correction_y[laser] = c.dist_correction_y;
+        corrections_.two_pt_correction[laser] =
+          c.two_pt_correction_available ? 1.0f : 0.0f;
+        corrections_.cos_vert_correction[laser] = c.cos_vert_correction;
+        corrections_.sin_vert_correction[laser] = c.sin_vert_correction;
+        corrections_.cos_rot_correction[laser] = c.cos_rot_correction;
+        corrections_.sin_rot_correction[laser] = c.sin_rot_correction;
+        corrections_.horiz_offset_correction[laser] = c.horiz_offset_correction;
+        corrections_.vert_offset_correction[laser] = c.vert_offset_correction;
+        corrections_.min_intensity[laser] = c.min_intensity;
+        corrections_.max_intensity[laser] = c.max_intensity;
+        corrections_.focal_offset[laser] = 256
+                                         * (1 - c.focal_distance / 13100)
+                                         * (1 - c.focal_distance / 13100);
+        corrections_.focal_slope[laser] = c.focal_slope;
+        corrections_.laser_ring[laser] = c.laser_ring;
+      }
+  }
 
   /** @brief convert raw packet to point cloud
+   *
+   *  Same result as unpack_scalar(), but each firing block is
+   *  converted as a whole from the structure-of-arrays correction
+   *  table.  Reserve the points of the whole scan in @a pc before
+   *  calling this for every packet to avoid reallocations.
    *
    *  @param pkt raw packet to unpack
    *  @param pc shared pointer to point cloud (points are appended)
@@ -147,13 +187,246 @@ namespace velodyne_rawdata
                        VPointCloud &pc, int packets_num)
   {
     ROS_DEBUG_STREAM("Received packet, time: " << pkt.stamp);
-    
+
     /** special parsing for the VLP16 **/
     if (calibration_.num_lasers == 16)
     {
       unpack_vlp16(pkt, pc);
       return;
     }
+
+    const raw_packet_t *raw = (const raw_packet_t *) &pkt.data[0];
+
+    float distance_resolution = DISTANCE_RESOLUTION;
+    if (packets_num==(int) ceil(1507.0 / 10))
+      distance_resolution = DISTANCE_RESOLUTION * 2;
+
+    float cos_azimuth[SCANS_PER_BLOCK];
+    float sin_azimuth[SCANS_PER_BLOCK];
+    bool in_view[SCANS_PER_BLOCK];
+
+    for (int i = 0; i < BLOCKS_PER_PACKET; i++) {
+
+      /*condition added to avoid calculating points which are not
+        in the interesting defined area (min_angle < area < max_angle)*/
+      uint16_t rotation = raw->blocks[i].rotation;
+      if (!azimuthInView(rotation))
+        continue;
+
+      // upper bank lasers are numbered [0..31], lower bank [32..63]
+      int bank_origin = (raw->blocks[i].header == LOWER_BANK) ? 32 : 0;
+
+      for (int j = 0; j < SCANS_PER_BLOCK; j++) {
+        cos_azimuth[j] = cos_rot_table_[rotation];
+        sin_azimuth[j] = sin_rot_table_[rotation];
+        in_view[j] = true;
+      }
+
+      unpackFiring(raw->blocks[i].data, SCANS_PER_BLOCK, bank_origin,
+                   cos_azimuth, sin_azimuth, in_view, distance_resolution,
+                   false, pc);
+    }
+  }
+
+  /** @brief convert raw VLP16 packet to point cloud
+   *
+   *  Block-wise counterpart of unpack_vlp16_scalar().
+   *
+   *  @param pkt raw packet to unpack
+   *  @param pc shared pointer to point cloud (points are appended)
+   */
+  void RawData::unpack_vlp16(const velodyne_msgs::VelodynePacket &pkt,
+                             VPointCloud &pc)
+  {
+    float azimuth;
+    float azimuth_diff;
+    float last_azimuth_diff=0;
+
+    float cos_azimuth[VLP16_SCANS_PER_FIRING];
+    float sin_azimuth[VLP16_SCANS_PER_FIRING];
+    bool in_view[VLP16_SCANS_PER_FIRING];
+
+    const raw_packet_t *raw = (const raw_packet_t *) &pkt.data[0];
+
+    for (int block = 0; block < BLOCKS_PER_PACKET; block++) {
+
+      // ignore packets with mangled or otherwise different contents
+      if (UPPER_BANK != raw->blocks[block].header) {
+        // Do not flood the log with messages, only issue at most one
+        // of these warnings per minute.
+        ROS_WARN_STREAM_THROTTLE(60, "skipping invalid VLP-16 packet: block "
+                                 << block << " header value is "
+                                 << raw->blocks[block].header);
+        return;                         // bad packet: skip the rest
+      }
+
+      // Calculate difference between current and next block's azimuth angle.
+      azimuth = (float)(raw->blocks[block].rotation);
+      if (block < (BLOCKS_PER_PACKET-1)){
+        azimuth_diff = (float)((36000 + raw->blocks[block+1].rotation - raw->blocks[block].rotation)%36000);
+        last_azimuth_diff = azimuth_diff;
+      }else{
+        azimuth_diff = last_azimuth_diff;
+      }
+
+      for (int firing=0; firing < VLP16_FIRINGS_PER_BLOCK; firing++){
+        for (int dsr=0; dsr < VLP16_SCANS_PER_FIRING; dsr++){
+          /** correct for the laser rotation as a function of timing during the firings **/
+          float azimuth_corrected_f = azimuth + (azimuth_diff * ((dsr*VLP16_DSR_TOFFSET) + (firing*VLP16_FIRING_TOFFSET)) / VLP16_BLOCK_TDURATION);
+          int azimuth_corrected = ((int)round(azimuth_corrected_f)) % 36000;
+          cos_azimuth[dsr] = cos_rot_table_[azimuth_corrected];
+          sin_azimuth[dsr] = sin_rot_table_[azimuth_corrected];
+          in_view[dsr] = azimuthInView(azimuth_corrected);
+        }
+
+        unpackFiring(raw->blocks[block].data
+                     + firing * VLP16_SCANS_PER_FIRING * RAW_SCAN_SIZE,
+                     VLP16_SCANS_PER_FIRING, 0, cos_azimuth, sin_azimuth,
+                     in_view, DISTANCE_RESOLUTION, true, pc);
+      }
+    }
+  }
+
+  /** @brief convert the returns of one firing to points
+   *
+   *  Return j of @a data belongs to laser (laser_origin + j).  The
+   *  first loop runs over contiguous arrays only, without branches,
+   *  so it is vectorized; the second loop appends the valid points.
+   *
+   *  @param data raw returns (RAW_SCAN_SIZE bytes each)
+   *  @param count number of returns, at most SCANS_PER_BLOCK
+   *  @param laser_origin laser number of the first return
+   *  @param cos_azimuth cosine of the azimuth of each return
+   *  @param sin_azimuth sine of the azimuth of each return
+   *  @param in_view whether the azimuth of each return is in view
+   *  @param distance_resolution [m] per raw distance unit
+   *  @param vlp16 use the VLP-16 intensity calculation
+   *  @param pc point cloud (points are appended)
+   */
+  void RawData::unpackFiring(const uint8_t *data, int count, int laser_origin,
+                             const float *cos_azimuth, const float *sin_azimuth,
+                             const bool *in_view, float distance_resolution,
+                             bool vlp16, VPointCloud &pc)
+  {
+    const laser_correction_table_t &c = corrections_;
+    const int l0 = laser_origin;
+
+    float raw_distance[SCANS_PER_BLOCK];
+    float raw_intensity[SCANS_PER_BLOCK];
+    float distance[SCANS_PER_BLOCK];
+    float x[SCANS_PER_BLOCK];
+    float y[SCANS_PER_BLOCK];
+    float z[SCANS_PER_BLOCK];
+    float intensity[SCANS_PER_BLOCK];
+
+    for (int j = 0, k = 0; j < count; j++, k += RAW_SCAN_SIZE) {
+      union two_bytes tmp;
+      tmp.bytes[0] = data[k];
+      tmp.bytes[1] = data[k+1];
+      raw_distance[j] = tmp.uint;
+      raw_intensity[j] = data[k+2];
+    }
+
+    for (int j = 0; j < count; j++) {
+      const int l = l0 + j;
+
+      float d = raw_distance[j] * distance_resolution;
+      d += c.dist_correction[l];
+      distance[j] = d;
+
+      float cos_vert_angle = c.cos_vert_correction[l];
+      float sin_vert_angle = c.sin_vert_correction[l];
+
+      // cos(a-b) = cos(a)*cos(b) + sin(a)*sin(b)
+      // sin(a-b) = sin(a)*cos(b) - cos(a)*sin(b)
+      float cos_rot_angle = cos_azimuth[j] * c.cos_rot_correction[l]
+                          + sin_azimuth[j] * c.sin_rot_correction[l];
+      float sin_rot_angle = sin_azimuth[j] * c.cos_rot_correction[l]
+                          - cos_azimuth[j] * c.sin_rot_correction[l];
+
+      float horiz_offset = c.horiz_offset_correction[l];
+      float vert_offset = c.vert_offset_correction[l];
+
+      // Compute the distance in the xy plane (w/o accounting for rotation)
+      float xy_distance = d * cos_vert_angle - vert_offset * sin_vert_angle;
+
+      // Calculate temporal X and Y, use absolute value.
+      float xx = fabsf(xy_distance * sin_rot_angle - horiz_offset * cos_rot_angle);
+      float yy = fabsf(xy_distance * cos_rot_angle + horiz_offset * sin_rot_angle);
+
+      // Two points calibration: linear interpolation of the distance
+      // correction for X and Y, masked out for lasers without it
+      float distance_corr_x =
+        ((c.dist_correction[l] - c.dist_correction_x[l])
+           * (xx - 2.4f) / (25.04f - 2.4f)
+         + c.dist_correction_x[l] - c.dist_correction[l]) * c.two_pt_correction[l];
+      float distance_corr_y =
+        ((c.dist_correction[l] - c.dist_correction_y[l])
+           * (yy - 1.93f) / (25.04f - 1.93f)
+         + c.dist_correction_y[l] - c.dist_correction[l]) * c.two_pt_correction[l];
+
+      float distance_x = d + distance_corr_x;
+      xy_distance = distance_x * cos_vert_angle - vert_offset * sin_vert_angle;
+      float px = xy_distance * sin_rot_angle - horiz_offset * cos_rot_angle;
+
+      float distance_y = d + distance_corr_y;
+      xy_distance = distance_y * cos_vert_angle - vert_offset * sin_vert_angle;
+      float py = xy_distance * cos_rot_angle + horiz_offset * sin_rot_angle;
+
+      // Using distance_y is not symmetric, but the velodyne manual
+      // does this.
+      float pz = distance_y * sin_vert_angle + vert_offset * cos_vert_angle;
+
+      /** Use standard ROS coordinate system (right-hand rule) */
+      x[j] = py;
+      y[j] = -px;
+      z[j] = pz;
+
+      /** Intensity Calculation */
+      // the VLP-16 reference implementation uses integer division here,
+      // (1 - raw/65535) is 1 for every raw distance except 65535
+      float range_term = vlp16 ? ((raw_distance[j] < 65535) ? 1.0f : 0.0f)
+                               : (1 - raw_distance[j] / 65535);
+      float value = raw_intensity[j] + c.focal_slope[l]
+        * fabsf(c.focal_offset[l] - 256 * range_term * range_term);
+      value = (value < c.min_intensity[l]) ? c.min_intensity[l] : value;
+      value = (value > c.max_intensity[l]) ? c.max_intensity[l] : value;
+      intensity[j] = value;
+    }
+
+    for (int j = 0; j < count; j++) {
+      if (in_view[j] && pointInRange(distance[j])) {
+        VPoint point;
+        point.ring = c.laser_ring[l0 + j];
+        point.x = x[j];
+        point.y = y[j];
+        point.z = z[j];
+        point.intensity = intensity[j];
+
+        // append this point to the cloud
+        pc.points.push_back(point);
+        ++pc.width;
+      }
+    }
+  }
+
+
+  /** @brief convert raw packet to point cloud, one return at a time
+   *
+   *  @param pkt raw packet to unpack
+   *  @param pc shared pointer to point cloud (points are appended)
+   */
+  void RawData::unpack_scalar(const velodyne_msgs::VelodynePacket &pkt,
+                              VPointCloud &pc, int packets_num)
+  {
+    ROS_DEBUG_STREAM("Received packet, time: " << pkt.stamp);
+    
+    /** special parsing for the VLP16 **/
+    if (calibration_.num_lasers == 16)
+    {
+      unpack_vlp16_scalar(pkt, pc);
+      return;
+    }
     
     const raw_packet_t *raw = (const raw_packet_t *) &pkt.data[0];
 
@@ -313,13 +586,13 @@ namespace velodyne_rawdata
     }
   }
   
-  /** @brief convert raw VLP16 packet to point cloud
+  /** @brief convert raw VLP16 packet to point cloud, one return at a time
    *
    *  @param pkt raw packet to unpack
    *  @param pc shared pointer to point cloud (points are appended)
    */
-  void RawData::unpack_vlp16(const velodyne_msgs::VelodynePacket &pkt,
-                             VPointCloud &pc)
+  void RawData::unpack_vlp16_scalar(const velodyne_msgs::VelodynePacket &pkt,
+                                    VPointCloud &pc)
   {
     float azimuth;
     float azimuth_diff;
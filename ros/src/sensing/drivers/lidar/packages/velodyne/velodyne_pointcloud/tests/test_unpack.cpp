@@ -0,0 +1,141 @@
+//
+// C++ unit tests and micro-benchmark for the block-wise packet
+// unpacking, compared with the scalar reference implementation on
+// the recorded packets downloaded for the rostests.
+//
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <vector>
+
+#include <ros/package.h>
+#include <ros/time.h>
+#include <ros/console.h>
+#include <velodyne_pointcloud/rawdata.h>
+using namespace velodyne_rawdata;
+
+// global test data
+std::string g_package_name("velodyne_pointcloud");
+std::string g_package_path;
+
+void init_global_data(void)
+{
+  g_package_path = ros::package::getPath(g_package_name);
+}
+
+// size of the Ethernet, IPv4 and UDP headers preceding the payload
+static const size_t UDP_HEADERS_SIZE = 42;
+
+/** Read all data packets of a PCAP file (position packets and other
+ *  traffic have a different size and are skipped). */
+static std::vector<velodyne_msgs::VelodynePacket>
+readPackets(const std::string &pcap_file)
+{
+  std::vector<velodyne_msgs::VelodynePacket> packets;
+  std::ifstream in(pcap_file.c_str(), std::ios::binary);
+  if (!in)
+    return packets;
+
+  char global_header[24];
+  in.read(global_header, sizeof(global_header));
+
+  uint32_t record_header[4];            // ts_sec, ts_usec, incl_len, orig_len
+  while (in.read((char *) record_header, sizeof(record_header)))
+    {
+      std::vector<char> record(record_header[2]);
+      if (!in.read(&record[0], record.size()))
+        break;
+      if (record.size() != UDP_HEADERS_SIZE + PACKET_SIZE)
+        continue;
+
+      velodyne_msgs::VelodynePacket pkt;
+      pkt.stamp = ros::Time(record_header[0], record_header[1] * 1000);
+      std::copy(record.begin() + UDP_HEADERS_SIZE, record.end(),
+                pkt.data.begin());
+      packets.push_back(pkt);
+    }
+  return packets;
+}
+
+/** Unpack all packets with both implementations, check that the
+ *  clouds agree and report the time taken by each. */
+static void compareUnpack(const std::string &pcap, const std::string &calibration,
+                          int packets_per_scan)
+{
+  std::vector<velodyne_msgs::VelodynePacket> packets =
+    readPackets(g_package_path + "/tests/" + pcap);
+  if (packets.empty())
+    {
+      std::cout << "[ SKIPPED  ] test data " << pcap << " not available" << std::endl;
+      return;
+    }
+
+  RawData data;
+  ASSERT_EQ(data.setupOffline(g_package_path + "/params/" + calibration, 130.0, 0.9), 0);
+  data.setParameters(0.9, 130.0, 0.0, 2 * M_PI);
+
+  VPointCloud scalar;
+  VPointCloud vectorized;
+  vectorized.points.reserve(packets.size() * SCANS_PER_PACKET);
+
+  ros::WallTime start = ros::WallTime::now();
+  for (size_t i = 0; i < packets.size(); ++i)
+    data.unpack_scalar(packets[i], scalar, packets_per_scan);
+  ros::WallDuration scalar_time = ros::WallTime::now() - start;
+
+  start = ros::WallTime::now();
+  for (size_t i = 0; i < packets.size(); ++i)
+    data.unpack(packets[i], vectorized, packets_per_scan);
+  ros::WallDuration vectorized_time = ros::WallTime::now() - start;
+
+  std::cout << "[ BENCH    ] " << pcap << ": " << packets.size() << " packets, "
+            << scalar.points.size() << " points, scalar "
+            << scalar_time.toSec() * 1e3 << " ms, vectorized "
+            << vectorized_time.toSec() * 1e3 << " ms" << std::endl;
+
+  ASSERT_EQ(scalar.width, vectorized.width);
+  ASSERT_EQ(scalar.points.size(), vectorized.points.size());
+  for (size_t i = 0; i < scalar.points.size(); ++i)
+    {
+      const VPoint &a = scalar.points[i];
+      const VPoint &b = vectorized.points[i];
+      ASSERT_EQ(a.ring, b.ring);
+      ASSERT_NEAR(a.x, b.x, 1e-4);
+      ASSERT_NEAR(a.y, b.y, 1e-4);
+      ASSERT_NEAR(a.z, b.z, 1e-4);
+      ASSERT_NEAR(a.intensity, b.intensity, 1e-3);
+    }
+}
+
+///////////////////////////////////////////////////////////////
+// Test cases
+///////////////////////////////////////////////////////////////
+
+TEST(Unpack, hdl64e)
+{
+  compareUnpack("class.pcap", "64e_utexas.yaml", 260);
+}
+
+TEST(Unpack, hdl64e_s21)
+{
+  compareUnpack("64e_s2.1-300-sztaki.pcap", "64e_s2.1-sztaki.yaml", 348);
+}
+
+TEST(Unpack, hdl32e)
+{
+  compareUnpack("32e.pcap", "32db.yaml", 181);
+}
+
+TEST(Unpack, vlp16)
+{
+  compareUnpack("vlp16.pcap", "VLP16db.yaml", 76);
+}
+
+// Run all the tests that were declared with TEST()
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  init_global_data();
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,19 @@
+#ifndef VOXEL_GRID_FILTER_H
+#define VOXEL_GRID_FILTER_H
+
+#include <pcl/point_types.h>
+#include <pcl/point_cloud.h>
+
+// Leaves smaller than this cannot be down sampled (It is specification in PCL)
+#define VOXEL_GRID_MIN_LEAF_SIZE 0.1
+
+/*!
+ * Downsamples the cloud with a VoxelGrid filter, as the voxel_grid_filter node does
+ * @param in_cloud_ptr Cloud to downsample
+ * @param in_leaf_size Size of the voxels, the cloud is copied as it is below VOXEL_GRID_MIN_LEAF_SIZE
+ * @param out_cloud_ptr Downsampled cloud
+ */
+void voxelGridFilter(const pcl::PointCloud<pcl::PointXYZI>::Ptr in_cloud_ptr, double in_leaf_size,
+                     pcl::PointCloud<pcl::PointXYZI>::Ptr out_cloud_ptr);
+
+#endif // VOXEL_GRID_FILTER_H
@@ -19,7 +19,6 @@
 
 #include <pcl/point_types.h>
 #include <pcl_conversions/pcl_conversions.h>
-#include <pcl/filters/voxel_grid.h>
 
 #include "autoware_config_msgs/ConfigVoxelGridFilter.h"
 
@@ -28,6 +27,7 @@
 #include <chrono>
 
 #include "points_downsampler.h"
+#include "voxel_grid_filter.h"
 
 #define MAX_MEASUREMENT_RANGE 200.0
 
@@ -70,20 +70,8 @@ static void scan_callback(const sensor_msgs::PointCloud2::ConstPtr& input)
 
   filter_start = std::chrono::system_clock::now();
 
-  // if voxel_leaf_size < 0.1 voxel_grid_filter cannot down sample (It is specification in PCL)
-  if (voxel_leaf_size >= 0.1)
-  {
-    // Downsampling the velodyne scan using VoxelGrid filter
-    pcl::VoxelGrid<pcl::PointXYZI> voxel_grid_filter;
-    voxel_grid_filter.setLeafSize(voxel_leaf_size, voxel_leaf_size, voxel_leaf_size);
-    voxel_grid_filter.setInputCloud(scan_ptr);
-    voxel_grid_filter.filter(*filtered_scan_ptr);
-    pcl::toROSMsg(*filtered_scan_ptr, filtered_msg);
-  }
-  else
-  {
-    pcl::toROSMsg(*scan_ptr, filtered_msg);
-  }
+  voxelGridFilter(scan_ptr, voxel_leaf_size, filtered_scan_ptr);
+  pcl::toROSMsg(*filtered_scan_ptr, filtered_msg);
 
   filter_end = std::chrono::system_clock::now();
 
@@ -94,14 +82,7 @@ static void scan_callback(const sensor_msgs::PointCloud2::ConstPtr& input)
   points_downsampler_info_msg.filter_name = "voxel_grid_filter";
   points_downsampler_info_msg.measurement_range = measurement_range;
   points_downsampler_info_msg.original_points_size = scan.size();
-  if (voxel_leaf_size >= 0.1)
-  {
-    points_downsampler_info_msg.filtered_points_size = filtered_scan_ptr->size();
-  }
-  else
-  {
-    points_downsampler_info_msg.filtered_points_size = scan_ptr->size();
-  }
+  points_downsampler_info_msg.filtered_points_size = filtered_scan_ptr->size();
   points_downsampler_info_msg.original_ring_size = 0;
   points_downsampler_info_msg.filtered_ring_size = 0;
   points_downsampler_info_msg.exe_time = std::chrono::duration_cast<std::chrono::microseconds>(filter_end - filter_start).count() / 1000.0;
@@ -0,0 +1,36 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <pcl/filters/voxel_grid.h>
+
+#include "voxel_grid_filter.h"
+
+void voxelGridFilter(const pcl::PointCloud<pcl::PointXYZI>::Ptr in_cloud_ptr, double in_leaf_size,
+                     pcl::PointCloud<pcl::PointXYZI>::Ptr out_cloud_ptr)
+{
+  if (in_leaf_size >= VOXEL_GRID_MIN_LEAF_SIZE)
+  {
+    // Downsampling the velodyne scan using VoxelGrid filter
+    pcl::VoxelGrid<pcl::PointXYZI> voxel_grid_filter;
+    voxel_grid_filter.setLeafSize(in_leaf_size, in_leaf_size, in_leaf_size);
+    voxel_grid_filter.setInputCloud(in_cloud_ptr);
+    voxel_grid_filter.filter(*out_cloud_ptr);
+  }
+  else
+  {
+    *out_cloud_ptr = *in_cloud_ptr;
+  }
+}
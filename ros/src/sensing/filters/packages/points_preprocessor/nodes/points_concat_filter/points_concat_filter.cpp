@@ -14,9 +14,6 @@
  * limitations under the License.
  */
 
-#include <message_filters/subscriber.h>
-#include <message_filters/sync_policies/approximate_time.h>
-#include <message_filters/synchronizer.h>
 #include <pcl/point_types.h>
 #include <pcl_conversions/pcl_conversions.h>
 #include <pcl_ros/point_cloud.h>
@@ -25,6 +22,7 @@
 #include <sensor_msgs/PointCloud2.h>
 #include <tf/tf.h>
 #include <tf/transform_listener.h>
+#include <time_sync_lib/synchronizer.hpp>
 #include <velodyne_pointcloud/point_types.h>
 #include <yaml-cpp/yaml.h>
 
@@ -37,14 +35,9 @@ private:
   typedef pcl::PointXYZI PointT;
   typedef pcl::PointCloud<PointT> PointCloudT;
   typedef sensor_msgs::PointCloud2 PointCloudMsgT;
-  typedef message_filters::sync_policies::ApproximateTime<PointCloudMsgT, PointCloudMsgT, PointCloudMsgT,
-                                                          PointCloudMsgT, PointCloudMsgT, PointCloudMsgT,
-                                                          PointCloudMsgT, PointCloudMsgT>
-      SyncPolicyT;
 
   ros::NodeHandle node_handle_, private_node_handle_;
-  message_filters::Subscriber<PointCloudMsgT> *cloud_subscribers_[8];
-  message_filters::Synchronizer<SyncPolicyT> *cloud_synchronizer_;
+  boost::shared_ptr<time_sync::Synchronizer> cloud_synchronizer_;
   ros::Subscriber config_subscriber_;
   ros::Publisher cloud_publisher_;
   tf::TransformListener tf_listener_;
@@ -52,55 +45,45 @@ private:
   size_t input_topics_size_;
   std::string input_topics_;
   std::string output_frame_id_;
+  double max_interval_;
+  double max_delay_;
 
-  void pointcloud_callback(const PointCloudMsgT::ConstPtr &msg1, const PointCloudMsgT::ConstPtr &msg2,
-                           const PointCloudMsgT::ConstPtr &msg3, const PointCloudMsgT::ConstPtr &msg4,
-                           const PointCloudMsgT::ConstPtr &msg5, const PointCloudMsgT::ConstPtr &msg6,
-                           const PointCloudMsgT::ConstPtr &msg7, const PointCloudMsgT::ConstPtr &msg8);
+  void pointcloud_callback(const std::vector<time_sync::Match> &matches);
 };
 
 PointsConcatFilter::PointsConcatFilter() : node_handle_(), private_node_handle_("~"), tf_listener_()
 {
   private_node_handle_.param("input_topics", input_topics_, std::string("[/points_alpha, /points_beta]"));
   private_node_handle_.param("output_frame_id", output_frame_id_, std::string("velodyne"));
+  private_node_handle_.param("max_interval", max_interval_, 0.1);
+  private_node_handle_.param("max_delay", max_delay_, 0.2);
 
   YAML::Node topics = YAML::Load(input_topics_);
   input_topics_size_ = topics.size();
-  if (input_topics_size_ < 2 || 8 < input_topics_size_)
+  if (input_topics_size_ < 2)
   {
-    ROS_ERROR("The size of input_topics must be between 2 and 8");
+    ROS_ERROR("The size of input_topics must be at least 2");
     ros::shutdown();
+    return;
   }
-  for (size_t i = 0; i < 8; ++i)
+
+  // the first topic is the pivot, the output carries its stamp
+  cloud_synchronizer_.reset(new time_sync::Synchronizer(input_topics_size_, ros::Duration(max_interval_),
+                                                        ros::Duration(max_delay_)));
+  cloud_synchronizer_->registerCallback(boost::bind(&PointsConcatFilter::pointcloud_callback, this, _1));
+  for (size_t i = 0; i < input_topics_size_; ++i)
   {
-    if (i < input_topics_size_)
-    {
-      cloud_subscribers_[i] =
-          new message_filters::Subscriber<PointCloudMsgT>(node_handle_, topics[i].as<std::string>(), 1);
-    }
-    else
-    {
-      cloud_subscribers_[i] =
-          new message_filters::Subscriber<PointCloudMsgT>(node_handle_, topics[0].as<std::string>(), 1);
-    }
+    cloud_synchronizer_->subscribe<PointCloudMsgT>(node_handle_, topics[i].as<std::string>(), i, 1);
   }
-  cloud_synchronizer_ = new message_filters::Synchronizer<SyncPolicyT>(
-      SyncPolicyT(10), *cloud_subscribers_[0], *cloud_subscribers_[1], *cloud_subscribers_[2], *cloud_subscribers_[3],
-      *cloud_subscribers_[4], *cloud_subscribers_[5], *cloud_subscribers_[6], *cloud_subscribers_[7]);
-  cloud_synchronizer_->registerCallback(
-      boost::bind(&PointsConcatFilter::pointcloud_callback, this, _1, _2, _3, _4, _5, _6, _7, _8));
   cloud_publisher_ = node_handle_.advertise<PointCloudMsgT>("/points_concat", 1);
 }
 
-void PointsConcatFilter::pointcloud_callback(const PointCloudMsgT::ConstPtr &msg1, const PointCloudMsgT::ConstPtr &msg2,
-                                             const PointCloudMsgT::ConstPtr &msg3, const PointCloudMsgT::ConstPtr &msg4,
-                                             const PointCloudMsgT::ConstPtr &msg5, const PointCloudMsgT::ConstPtr &msg6,
-                                             const PointCloudMsgT::ConstPtr &msg7, const PointCloudMsgT::ConstPtr &msg8)
+void PointsConcatFilter::pointcloud_callback(const std::vector<time_sync::Match> &matches)
 {
-  assert(2 <= input_topics_size_ && input_topics_size_ <= 8);
+  assert(matches.size() == input_topics_size_);
 
-  PointCloudMsgT::ConstPtr msgs[8] = { msg1, msg2, msg3, msg4, msg5, msg6, msg7, msg8 };
-  PointCloudT::Ptr cloud_sources[8];
+  std::vector<PointCloudMsgT::ConstPtr> msgs(input_topics_size_);
+  std::vector<PointCloudT::Ptr> cloud_sources(input_topics_size_);
   PointCloudT::Ptr cloud_concatenated(new PointCloudT);
 
   // transform points
@@ -110,6 +93,7 @@ void PointsConcatFilter::pointcloud_callback(const PointCloudMsgT::ConstPtr &msg
     {
       // Note: If you use kinetic, you can directly receive messages as
       // PointCloutT.
+      msgs[i] = matches[i].get<PointCloudMsgT>();
       cloud_sources[i] = PointCloudT().makeShared();
       pcl::fromROSMsg(*msgs[i], *cloud_sources[i]);
       tf_listener_.waitForTransform(output_frame_id_, msgs[i]->header.frame_id, ros::Time(0), ros::Duration(1.0));
@@ -123,6 +107,12 @@ void PointsConcatFilter::pointcloud_callback(const PointCloudMsgT::ConstPtr &msg
   }
 
   // merge points
+  size_t total = 0;
+  for (size_t i = 0; i < input_topics_size_; ++i)
+  {
+    total += cloud_sources[i]->size();
+  }
+  cloud_concatenated->reserve(total);
   for (size_t i = 0; i < input_topics_size_; ++i)
   {
     *cloud_concatenated += *cloud_sources[i];
@@ -132,6 +122,12 @@ void PointsConcatFilter::pointcloud_callback(const PointCloudMsgT::ConstPtr &msg
   cloud_concatenated->header = pcl_conversions::toPCL(msgs[0]->header);
   cloud_concatenated->header.frame_id = output_frame_id_;
   cloud_publisher_.publish(cloud_concatenated);
+
+  time_sync::Statistics stats = cloud_synchronizer_->getStatistics();
+  ROS_DEBUG_THROTTLE(5.0, "points_concat_filter: matched %lu, dropped %lu, latency mean %.4f max %.4f [s], "
+                          "offset max %.4f [s]",
+                     static_cast<unsigned long>(stats.matched), static_cast<unsigned long>(stats.dropped_pivots),
+                     stats.latency_mean, stats.latency_max, stats.offset_max);
 }
 
 int main(int argc, char **argv)
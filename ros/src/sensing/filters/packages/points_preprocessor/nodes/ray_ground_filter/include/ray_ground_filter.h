@@ -91,26 +91,41 @@ private:
 	                         const pcl::PointCloud<pcl::PointXYZI>::Ptr in_cloud_to_publish_ptr,
 	                         const std_msgs::Header& in_header);
 	
+	//buffers reused between callbacks, to avoid reallocating them for every cloud
+	std::vector<float>    point_radius_;
+	std::vector<float>    point_theta_;
+	std::vector<size_t>   point_radial_div_;
+	std::vector<size_t>   point_concentric_div_;
+	std::vector<size_t>   point_concentric_bucket_;//concentric division clamped to the counting sort buckets
+	PointCloudXYZIRTColor radial_ordered_points_;
+	std::vector<size_t>   radial_offsets_;
+	std::vector<size_t>   sort_counts_;
+	std::vector<size_t>   sort_order_;
+	std::vector<size_t>   concentric_order_;
+	std::vector<char>     ground_flags_;
+
 	/*!
-	 *
+	 * Organizes the points in radial divisions, using two counting sort passes (by concentric division, then by radial
+	 * division) instead of sorting each division. The points end up in a single buffer, division after division.
 	 * @param[in] in_cloud Input Point Cloud to be organized in radial segments
-	 * @param[out] out_organized_points Custom Point Cloud filled with XYZRTZColor data
-	 * @param[out] out_radial_divided_indices Indices of the points in the original cloud for each radial segment
-	 * @param[out] out_radial_ordered_clouds Vector of Points Clouds, each element will contain the points ordered
+	 * @param[out] out_radial_ordered_points Custom Point Cloud filled with XYZRTZColor data, ordered by radial division
+	 * and by radius inside each division
+	 * @param[out] out_radial_offsets Points of the radial division i are in [out_radial_offsets[i], out_radial_offsets[i+1])
 	 */
 	void ConvertXYZIToRTZColor(const pcl::PointCloud<pcl::PointXYZI>::Ptr in_cloud,
-	                           PointCloudXYZIRTColor& out_organized_points,
-	                           std::vector<pcl::PointIndices>& out_radial_divided_indices,
-	                           std::vector<PointCloudXYZIRTColor>& out_radial_ordered_clouds);
+	                           PointCloudXYZIRTColor& out_radial_ordered_points,
+	                           std::vector<size_t>& out_radial_offsets);
 
 
 	/*!
-	 * Classifies Points in the PointCoud as Ground and Not Ground
-	 * @param in_radial_ordered_clouds Vector of an Ordered PointsCloud ordered by radial distance from the origin
+	 * Classifies Points in the PointCoud as Ground and Not Ground, the radial divisions are swept in parallel
+	 * @param in_radial_ordered_points PointCloud ordered by radial division and by radial distance from the origin
+	 * @param in_radial_offsets Offsets of each radial division in in_radial_ordered_points
 	 * @param out_ground_indices Returns the indices of the points classified as ground in the original PointCloud
 	 * @param out_no_ground_indices Returns the indices of the points classified as not ground in the original PointCloud
 	 */
-	void ClassifyPointCloud(std::vector<PointCloudXYZIRTColor>& in_radial_ordered_clouds,
+	void ClassifyPointCloud(const PointCloudXYZIRTColor& in_radial_ordered_points,
+	                        const std::vector<size_t>& in_radial_offsets,
 	                        pcl::PointIndices& out_ground_indices,
 	                        pcl::PointIndices& out_no_ground_indices);
 	
@@ -152,6 +167,10 @@ private:
 	void CloudCallback(const sensor_msgs::PointCloud2ConstPtr &in_sensor_cloud);
 	
 friend class RayGroundFilter_clipCloud_Test;
+friend class RayGroundFilter_radialOrder_Test;
+friend class RayGroundFilter_farConcentricDiv_Test;
+friend class RayGroundFilter_segmentationTime_Test;
+friend class PointsPreprocessorBenchmark;
 public:
 	RayGroundFilter();
   void Run();
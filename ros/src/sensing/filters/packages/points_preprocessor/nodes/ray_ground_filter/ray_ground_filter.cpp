@@ -62,25 +62,27 @@ void RayGroundFilter::publish_cloud(const ros::Publisher& in_publisher,
 }
 
 /*!
- *
+ * Organizes the points in radial divisions, using two counting sort passes (by concentric division, then by radial
+ * division) instead of sorting each division. The points end up in a single buffer, division after division.
  * @param[in] in_cloud Input Point Cloud to be organized in radial segments
- * @param[out] out_organized_points Custom Point Cloud filled with XYZRTZColor data
- * @param[out] out_radial_divided_indices Indices of the points in the original cloud for each radial segment
- * @param[out] out_radial_ordered_clouds Vector of Points Clouds, each element will contain the points ordered
+ * @param[out] out_radial_ordered_points Custom Point Cloud filled with XYZRTZColor data, ordered by radial division
+ * and by radius inside each division
+ * @param[out] out_radial_offsets Points of the radial division i are in [out_radial_offsets[i], out_radial_offsets[i+1])
  */
 void RayGroundFilter::ConvertXYZIToRTZColor(const pcl::PointCloud<pcl::PointXYZI>::Ptr in_cloud,
-    PointCloudXYZIRTColor& out_organized_points,
-    std::vector<pcl::PointIndices>& out_radial_divided_indices,
-    std::vector<PointCloudXYZIRTColor>& out_radial_ordered_clouds)
+    PointCloudXYZIRTColor& out_radial_ordered_points,
+    std::vector<size_t>& out_radial_offsets)
 {
-  out_organized_points.resize(in_cloud->points.size());
-  out_radial_divided_indices.clear();
-  out_radial_divided_indices.resize(radial_dividers_num_);
-  out_radial_ordered_clouds.resize(radial_dividers_num_);
-
-  for(size_t i=0; i< in_cloud->points.size(); i++)
+  const size_t points_num = in_cloud->points.size();
+  point_radius_.resize(points_num);
+  point_theta_.resize(points_num);
+  point_radial_div_.resize(points_num);
+  point_concentric_div_.resize(points_num);
+  point_concentric_bucket_.resize(points_num);
+
+#pragma omp parallel for
+  for(size_t i=0; i< points_num; i++)
   {
-    PointXYZIRTColor new_point;
     auto radius         = (float) sqrt(
         in_cloud->points[i].x*in_cloud->points[i].x
         + in_cloud->points[i].y*in_cloud->points[i].y
@@ -91,59 +93,129 @@ void RayGroundFilter::ConvertXYZIToRTZColor(const pcl::PointCloud<pcl::PointXYZI
     auto radial_div     = (size_t) floor(theta/radial_divider_angle_);
     auto concentric_div = (size_t) floor(fabs(radius/concentric_divider_distance_));
 
-    new_point.point    = in_cloud->points[i];
-    new_point.radius   = radius;
-    new_point.theta    = theta;
-    new_point.radial_div = radial_div;
-    new_point.concentric_div = concentric_div;
-    new_point.red      = (size_t) colors_[new_point.radial_div % color_num_].val[0];
-    new_point.green    = (size_t) colors_[new_point.radial_div % color_num_].val[1];
-    new_point.blue     = (size_t) colors_[new_point.radial_div % color_num_].val[2];
-    new_point.original_index = i;
+    //theta may round up to 360 for tiny negative angles
+    if (radial_div >= radial_dividers_num_) { radial_div = 0; }
 
-    out_organized_points[i] = new_point;
+    point_radius_[i] = radius;
+    point_theta_[i] = theta;
+    point_radial_div_[i] = radial_div;
+    point_concentric_div_[i] = concentric_div;
+  }//end for
 
-    //radial divisions
-    out_radial_divided_indices[radial_div].indices.push_back(i);
+  //far away points share the last concentric bucket, so the counting sort stays linear in the number of points
+  size_t concentric_buckets_num = 1;
+  for(size_t i=0; i< points_num; i++)
+  {
+    concentric_buckets_num = std::max(concentric_buckets_num, point_concentric_div_[i] + 1);
+  }
+  concentric_buckets_num = std::min(concentric_buckets_num, points_num + 1);
 
-    out_radial_ordered_clouds[radial_div].push_back(new_point);
+  //first pass, stable counting sort by concentric division
+  sort_counts_.assign(concentric_buckets_num + 1, 0);
+  for(size_t i=0; i< points_num; i++)
+  {
+    point_concentric_bucket_[i] = std::min(point_concentric_div_[i], concentric_buckets_num - 1);
+    sort_counts_[point_concentric_bucket_[i] + 1]++;
+  }
+  for(size_t i=1; i< sort_counts_.size(); i++)
+  {
+    sort_counts_[i] += sort_counts_[i - 1];
+  }
+  concentric_order_.resize(points_num);
+  for(size_t i=0; i< points_num; i++)
+  {
+    concentric_order_[sort_counts_[point_concentric_bucket_[i]]++] = i;
+  }
 
-  }//end for
+  //second pass, stable counting sort by radial division keeps the concentric order inside each division
+  out_radial_offsets.assign(radial_dividers_num_ + 1, 0);
+  for(size_t i=0; i< points_num; i++)
+  {
+    out_radial_offsets[point_radial_div_[i] + 1]++;
+  }
+  for(size_t i=1; i< out_radial_offsets.size(); i++)
+  {
+    out_radial_offsets[i] += out_radial_offsets[i - 1];
+  }
+  sort_counts_.assign(out_radial_offsets.begin(), out_radial_offsets.end() - 1);
+  sort_order_.resize(points_num);
+  for(size_t i=0; i< points_num; i++)
+  {
+    size_t index = concentric_order_[i];
+    sort_order_[sort_counts_[point_radial_div_[index]]++] = index;
+  }
 
-  //order radial points on each division
-#pragma omp for
+  //points sharing a concentric bucket are not ordered by radius yet, these runs are short
+#pragma omp parallel for schedule(dynamic, 16)
   for(size_t i=0; i< radial_dividers_num_; i++)
   {
-    std::sort(out_radial_ordered_clouds[i].begin(), out_radial_ordered_clouds[i].end(),
-        [](const PointXYZIRTColor& a, const PointXYZIRTColor& b){ return a.radius < b.radius; });
+    size_t run_start = out_radial_offsets[i];
+    for(size_t j=run_start + 1; j<= out_radial_offsets[i + 1]; j++)
+    {
+      if (j == out_radial_offsets[i + 1]
+          || point_concentric_bucket_[sort_order_[j]] != point_concentric_bucket_[sort_order_[run_start]])
+      {
+        if (j - run_start > 1)
+        {
+          std::stable_sort(sort_order_.begin() + run_start, sort_order_.begin() + j,
+              [this](size_t a, size_t b){ return point_radius_[a] < point_radius_[b]; });
+        }
+        run_start = j;
+      }
+    }
+  }
+
+  out_radial_ordered_points.resize(points_num);
+#pragma omp parallel for
+  for(size_t i=0; i< points_num; i++)
+  {
+    size_t index = sort_order_[i];
+    PointXYZIRTColor& new_point = out_radial_ordered_points[i];
+
+    new_point.point    = in_cloud->points[index];
+    new_point.radius   = point_radius_[index];
+    new_point.theta    = point_theta_[index];
+    new_point.radial_div = point_radial_div_[index];
+    new_point.concentric_div = point_concentric_div_[index];
+    new_point.red      = (size_t) colors_[new_point.radial_div % color_num_].val[0];
+    new_point.green    = (size_t) colors_[new_point.radial_div % color_num_].val[1];
+    new_point.blue     = (size_t) colors_[new_point.radial_div % color_num_].val[2];
+    new_point.original_index = index;
   }
 }
 
 /*!
- * Classifies Points in the PointCoud as Ground and Not Ground
- * @param in_radial_ordered_clouds Vector of an Ordered PointsCloud ordered by radial distance from the origin
+ * Classifies Points in the PointCoud as Ground and Not Ground, the radial divisions are swept in parallel
+ * @param in_radial_ordered_points PointCloud ordered by radial division and by radial distance from the origin
+ * @param in_radial_offsets Offsets of each radial division in in_radial_ordered_points
  * @param out_ground_indices Returns the indices of the points classified as ground in the original PointCloud
  * @param out_no_ground_indices Returns the indices of the points classified as not ground in the original PointCloud
  */
-void RayGroundFilter::ClassifyPointCloud(std::vector<PointCloudXYZIRTColor>& in_radial_ordered_clouds,
+void RayGroundFilter::ClassifyPointCloud(const PointCloudXYZIRTColor& in_radial_ordered_points,
+    const std::vector<size_t>& in_radial_offsets,
     pcl::PointIndices& out_ground_indices,
     pcl::PointIndices& out_no_ground_indices)
 {
-  out_ground_indices.indices.clear();
-  out_no_ground_indices.indices.clear();
-#pragma omp for
-  for (size_t i=0; i < in_radial_ordered_clouds.size(); i++)//sweep through each radial division
+  const size_t points_num = in_radial_ordered_points.size();
+  const size_t radial_num = in_radial_offsets.empty() ? 0 : in_radial_offsets.size() - 1;
+  const double local_slope_tan = tan(DEG2RAD(local_max_slope_));
+  const double general_slope_tan = tan(DEG2RAD(general_max_slope_));
+  ground_flags_.resize(points_num);
+
+#pragma omp parallel for schedule(dynamic, 16)
+  for (size_t i=0; i < radial_num; i++)//sweep through each radial division
   {
     float prev_radius = 0.f;
     float prev_height = - sensor_height_;
     bool prev_ground = false;
     bool current_ground = false;
-    for (size_t j=0; j < in_radial_ordered_clouds[i].size(); j++)//loop through each point in the radial div
+    for (size_t j=in_radial_offsets[i]; j < in_radial_offsets[i + 1]; j++)//loop through each point in the radial div
     {
-      float points_distance = in_radial_ordered_clouds[i][j].radius - prev_radius;
-      float height_threshold = tan(DEG2RAD(local_max_slope_)) * points_distance;
-      float current_height = in_radial_ordered_clouds[i][j].point.z;
-      float general_height_threshold = tan(DEG2RAD(general_max_slope_)) * in_radial_ordered_clouds[i][j].radius;
+      const PointXYZIRTColor& current_point = in_radial_ordered_points[j];
+      float points_distance = current_point.radius - prev_radius;
+      float height_threshold = local_slope_tan * points_distance;
+      float current_height = current_point.point.z;
+      float general_height_threshold = general_slope_tan * current_point.radius;
 
       //for points which are very close causing the height threshold to be tiny, set a minimum value
       if (points_distance > concentric_divider_distance_ && height_threshold < min_height_threshold_)
@@ -184,19 +256,27 @@ void RayGroundFilter::ClassifyPointCloud(std::vector<PointCloudXYZIRTColor>& in_
         {current_ground = false;}
       }
 
-      if (current_ground)
-      {
-        out_ground_indices.indices.push_back(in_radial_ordered_clouds[i][j].original_index);
-        prev_ground=true;
-      }
-      else
-      {
-        out_no_ground_indices.indices.push_back(in_radial_ordered_clouds[i][j].original_index);
-        prev_ground = false;
-      }
+      ground_flags_[j] = current_ground;
+      prev_ground = current_ground;
+      prev_radius = current_point.radius;
+      prev_height = current_point.point.z;
+    }
+  }
 
-      prev_radius = in_radial_ordered_clouds[i][j].radius;
-      prev_height = in_radial_ordered_clouds[i][j].point.z;
+  //gather serially so the indices keep the division order
+  out_ground_indices.indices.clear();
+  out_no_ground_indices.indices.clear();
+  out_ground_indices.indices.reserve(points_num);
+  out_no_ground_indices.indices.reserve(points_num);
+  for (size_t j=0; j < points_num; j++)
+  {
+    if (ground_flags_[j])
+    {
+      out_ground_indices.indices.push_back(in_radial_ordered_points[j].original_index);
+    }
+    else
+    {
+      out_no_ground_indices.indices.push_back(in_radial_ordered_points[j].original_index);
     }
   }
 }
@@ -299,21 +379,15 @@ void RayGroundFilter::CloudCallback(const sensor_msgs::PointCloud2ConstPtr &in_s
   //pcl::PointCloud<pcl::PointXYZINormal>::Ptr cloud_with_normals_ptr (new pcl::PointCloud<pcl::PointXYZINormal>);
   //GetCloudNormals(current_sensor_cloud_ptr, cloud_with_normals_ptr, 5.0);
 
-  PointCloudXYZIRTColor organized_points;
-  std::vector<pcl::PointIndices> radial_division_indices;
-  std::vector<pcl::PointIndices> closest_indices;
-  std::vector<PointCloudXYZIRTColor> radial_ordered_clouds;
-
   radial_dividers_num_ = ceil(360 / radial_divider_angle_);
 
   ConvertXYZIToRTZColor(filtered_cloud_ptr,
-      organized_points,
-      radial_division_indices,
-      radial_ordered_clouds);
+      radial_ordered_points_,
+      radial_offsets_);
 
   pcl::PointIndices ground_indices, no_ground_indices;
 
-  ClassifyPointCloud(radial_ordered_clouds, ground_indices, no_ground_indices);
+  ClassifyPointCloud(radial_ordered_points_, radial_offsets_, ground_indices, no_ground_indices);
 
   pcl::PointCloud<pcl::PointXYZI>::Ptr ground_cloud_ptr(new pcl::PointCloud<pcl::PointXYZI>);
   pcl::PointCloud<pcl::PointXYZI>::Ptr no_ground_cloud_ptr(new pcl::PointCloud<pcl::PointXYZI>);
@@ -0,0 +1,75 @@
+/*
+ * ring_ground_filter.h
+ *
+ * Created on	: June 5, 2018
+ * Author	: Patiphon Narksri
+ *
+ */
+#ifndef RING_GROUND_FILTER_H_
+#define RING_GROUND_FILTER_H_
+
+#include <ros/ros.h>
+#include <sensor_msgs/PointCloud2.h>
+#include <pcl_ros/point_cloud.h>
+#include <pcl_conversions/pcl_conversions.h>
+#include <pcl/point_types.h>
+#include <pcl/PointIndices.h>
+#include <velodyne_pointcloud/point_types.h>
+#include <opencv/cv.h>
+
+enum Label
+{
+	GROUND,
+	VERTICAL,
+	UNKNOWN //Initial state, not classified
+};
+
+class GroundFilter
+{
+public:
+
+	GroundFilter();
+	void Run();
+
+private:
+
+	ros::NodeHandle node_handle_;
+	ros::Subscriber points_node_sub_;
+	ros::Publisher groundless_points_pub_;
+	ros::Publisher ground_points_pub_;
+
+	std::string point_topic_;
+	std::string no_ground_topic, ground_topic;
+	int 		sensor_model_;
+	double 		sensor_height_;
+	double 		max_slope_;
+	double vertical_thres_;
+	bool		floor_removal_;
+
+	int 		vertical_res_;
+	int 		horizontal_res_;
+	cv::Mat 	index_map_;
+	Label 		class_label_[64];
+	double	radius_table_[64];
+
+	//boost::chrono::high_resolution_clock::time_point t1_;
+	//boost::chrono::high_resolution_clock::time_point t2_;
+	//boost::chrono::nanoseconds elap_time_;
+	ros::Time t1_;
+	ros::Time t2_;
+	ros::Duration elap_time_;
+
+	const int 	DEFAULT_HOR_RES = 2000;
+
+	void InitLabelArray(int in_model);
+	void InitRadiusTable(int in_model);
+	void InitDepthMap(int in_width);
+	void VelodyneCallback(const pcl::PointCloud<velodyne_pointcloud::PointXYZIR>::ConstPtr &in_cloud_msg);
+	void FilterGround(const pcl::PointCloud<velodyne_pointcloud::PointXYZIR>::ConstPtr &in_cloud_msg,
+				pcl::PointIndices &out_groundless_indices,
+				pcl::PointIndices &out_ground_indices);
+
+friend class PointsPreprocessorBenchmark;
+};
+
+#endif  // RING_GROUND_FILTER_H_
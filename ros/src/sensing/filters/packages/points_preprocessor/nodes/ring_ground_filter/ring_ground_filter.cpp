@@ -5,66 +5,9 @@
  * Author	: Patiphon Narksri
  *
  */
-#include <ros/ros.h>
-#include <sensor_msgs/PointCloud2.h>
-#include <pcl_ros/point_cloud.h>
-#include <pcl_conversions/pcl_conversions.h>
-#include <pcl/point_types.h>
-#include <velodyne_pointcloud/point_types.h>
-#include <opencv/cv.h>
+#include "ring_ground_filter.h"
 
-enum Label
-{
-	GROUND,
-	VERTICAL,
-	UNKNOWN //Initial state, not classified
-};
-
-class GroundFilter
-{
-public:
-
-	GroundFilter();
-
-private:
-
-	ros::NodeHandle node_handle_;
-	ros::Subscriber points_node_sub_;
-	ros::Publisher groundless_points_pub_;
-	ros::Publisher ground_points_pub_;
-
-	std::string point_topic_;
-	std::string no_ground_topic, ground_topic;
-	int 		sensor_model_;
-	double 		sensor_height_;
-	double 		max_slope_;
-	double vertical_thres_;
-	bool		floor_removal_;
-
-	int 		vertical_res_;
-	int 		horizontal_res_;
-	cv::Mat 	index_map_;
-	Label 		class_label_[64];
-	double	radius_table_[64];
-
-	//boost::chrono::high_resolution_clock::time_point t1_;
-	//boost::chrono::high_resolution_clock::time_point t2_;
-	//boost::chrono::nanoseconds elap_time_;
-	ros::Time t1_;
-	ros::Time t2_;
-	ros::Duration elap_time_;
-
-	const int 	DEFAULT_HOR_RES = 2000;
-
-	void InitLabelArray(int in_model);
-	void InitRadiusTable(int in_model);
-	void InitDepthMap(int in_width);
-	void VelodyneCallback(const pcl::PointCloud<velodyne_pointcloud::PointXYZIR>::ConstPtr &in_cloud_msg);
-	void FilterGround(const pcl::PointCloud<velodyne_pointcloud::PointXYZIR>::ConstPtr &in_cloud_msg,
-				pcl::PointCloud<velodyne_pointcloud::PointXYZIR> &out_groundless_points,
-				pcl::PointCloud<velodyne_pointcloud::PointXYZIR> &out_ground_points);
-
-};
+#include <pcl/common/io.h>
 
 GroundFilter::GroundFilter() : node_handle_("~")
 {
@@ -106,13 +49,18 @@ GroundFilter::GroundFilter() : node_handle_("~")
 	}
 	node_handle_.param("horizontal_res", horizontal_res_, default_horizontal_res);
 
+	vertical_res_ = sensor_model_;
+	InitLabelArray(sensor_model_);
+	InitRadiusTable(sensor_model_);
+}
+
+void GroundFilter::Run()
+{
 	points_node_sub_ = node_handle_.subscribe(point_topic_, 10000, &GroundFilter::VelodyneCallback, this);
 	groundless_points_pub_ = node_handle_.advertise<sensor_msgs::PointCloud2>(no_ground_topic, 10000);
 	ground_points_pub_ = node_handle_.advertise<sensor_msgs::PointCloud2>(ground_topic, 10000);
 
-	vertical_res_ = sensor_model_;
-	InitLabelArray(sensor_model_);
-	InitRadiusTable(sensor_model_);
+	ros::spin();
 }
 
 void GroundFilter::InitLabelArray(int in_model)
@@ -196,11 +144,10 @@ void GroundFilter::InitDepthMap(int in_width)
 }
 
 void GroundFilter::FilterGround(const pcl::PointCloud<velodyne_pointcloud::PointXYZIR>::ConstPtr &in_cloud_msg,
-			pcl::PointCloud<velodyne_pointcloud::PointXYZIR> &out_groundless_points,
-			pcl::PointCloud<velodyne_pointcloud::PointXYZIR> &out_ground_points)
+			pcl::PointIndices &out_groundless_indices,
+			pcl::PointIndices &out_ground_indices)
 {
 
-	velodyne_pointcloud::PointXYZIR point;
 	InitDepthMap(horizontal_res_);
 
 	for (size_t i = 0; i < in_cloud_msg->points.size(); i++)
@@ -244,13 +191,7 @@ void GroundFilter::FilterGround(const pcl::PointCloud<velodyne_pointcloud::Point
 					{
 						for (int m = 0; m < point_index_size; m++)
 						{
-							int index = index_map_.at<int>(point_index[m],i);
-							point.x = in_cloud_msg->points[index].x;
-							point.y = in_cloud_msg->points[index].y;
-							point.z = in_cloud_msg->points[index].z;
-							point.intensity = in_cloud_msg->points[index].intensity;
-							point.ring = in_cloud_msg->points[index].ring;
-							out_groundless_points.push_back(point);
+							out_groundless_indices.indices.push_back(index_map_.at<int>(point_index[m],i));
 							point_class[point_index[m]] = VERTICAL;
 						}
 						point_index_size = 0;
@@ -259,13 +200,7 @@ void GroundFilter::FilterGround(const pcl::PointCloud<velodyne_pointcloud::Point
 					{
 						for (int m = 0; m < point_index_size; m++)
 						{
-							int index = index_map_.at<int>(point_index[m],i);
-							point.x = in_cloud_msg->points[index].x;
-							point.y = in_cloud_msg->points[index].y;
-							point.z = in_cloud_msg->points[index].z;
-							point.intensity = in_cloud_msg->points[index].intensity;
-							point.ring = in_cloud_msg->points[index].ring;
-							out_ground_points.push_back(point);
+							out_ground_indices.indices.push_back(index_map_.at<int>(point_index[m],i));
 							point_class[point_index[m]] = GROUND;
 						}
 						point_index_size = 0;
@@ -283,13 +218,7 @@ void GroundFilter::FilterGround(const pcl::PointCloud<velodyne_pointcloud::Point
 					{
 						for (int m = 0; m < point_index_size; m++)
 						{
-							int index = index_map_.at<int>(point_index[m],i);
-							point.x = in_cloud_msg->points[index].x;
-							point.y = in_cloud_msg->points[index].y;
-							point.z = in_cloud_msg->points[index].z;
-							point.intensity = in_cloud_msg->points[index].intensity;
-							point.ring = in_cloud_msg->points[index].ring;
-							out_groundless_points.push_back(point);
+							out_groundless_indices.indices.push_back(index_map_.at<int>(point_index[m],i));
 							point_class[point_index[m]] = VERTICAL;
 						}
 						point_index_size = 0;
@@ -298,13 +227,7 @@ void GroundFilter::FilterGround(const pcl::PointCloud<velodyne_pointcloud::Point
 					{
 						for (int m = 0; m < point_index_size; m++)
 						{
-							int index = index_map_.at<int>(point_index[m],i);
-							point.x = in_cloud_msg->points[index].x;
-							point.y = in_cloud_msg->points[index].y;
-							point.z = in_cloud_msg->points[index].z;
-							point.intensity = in_cloud_msg->points[index].intensity;
-							point.ring = in_cloud_msg->points[index].ring;
-							out_ground_points.push_back(point);
+							out_ground_indices.indices.push_back(index_map_.at<int>(point_index[m],i));
 							point_class[point_index[m]] = GROUND;
 						}
 						point_index_size = 0;
@@ -325,7 +248,10 @@ void GroundFilter::VelodyneCallback(const pcl::PointCloud<velodyne_pointcloud::P
 	vertical_points.clear();
 	ground_points.clear();
 
-	FilterGround(in_cloud_msg, vertical_points, ground_points);
+	pcl::PointIndices vertical_indices, ground_indices;
+	FilterGround(in_cloud_msg, vertical_indices, ground_indices);
+	pcl::copyPointCloud(*in_cloud_msg, vertical_indices, vertical_points);
+	pcl::copyPointCloud(*in_cloud_msg, ground_indices, ground_points);
 
 	if (!floor_removal_)
 	{
@@ -339,14 +265,3 @@ void GroundFilter::VelodyneCallback(const pcl::PointCloud<velodyne_pointcloud::P
 	//elap_time_ = t2_ - t1_;//boost::chrono::duration_cast<boost::chrono::nanoseconds>(t2_-t1_);
 	//std::cout << "Computational Time for one frame: " << elap_time_ << '\n';
 }
-
-int main(int argc, char **argv)
-{
-
-	ros::init(argc, argv, "ring_ground_filter");
-	GroundFilter node;
-	ros::spin();
-
-	return 0;
-
-}
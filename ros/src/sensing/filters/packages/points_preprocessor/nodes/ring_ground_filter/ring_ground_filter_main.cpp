@@ -0,0 +1,20 @@
+/*
+ * ring_ground_filter_main.cpp
+ *
+ * Created on	: June 5, 2018
+ * Author	: Patiphon Narksri
+ *
+ */
+#include <ros/ros.h>
+#include "ring_ground_filter.h"
+
+int main(int argc, char **argv)
+{
+
+	ros::init(argc, argv, "ring_ground_filter");
+	GroundFilter node;
+	node.Run();
+
+	return 0;
+
+}
@@ -0,0 +1,53 @@
+/*
+ * space_filter.h
+ *
+ *  Created on: Nov 4, 2016
+ *      Author: ne0
+ */
+#ifndef SPACE_FILTER_H_
+#define SPACE_FILTER_H_
+
+#include <ros/ros.h>
+#include <pcl_conversions/pcl_conversions.h>
+#include <pcl/filters/extract_indices.h>
+#include <sensor_msgs/point_cloud_conversion.h>
+#include <sensor_msgs/PointCloud.h>
+#include <sensor_msgs/PointCloud2.h>
+
+
+class SpaceFilter
+{
+public:
+	SpaceFilter();
+	void Run();
+
+private:
+
+	ros::NodeHandle node_handle_;
+	ros::Subscriber cloud_sub_;
+	ros::Publisher 	cloud_pub_;
+
+	std::string 	subscribe_topic_;
+
+	bool			lateral_removal_;
+	bool			vertical_removal_;
+
+	double 			left_distance_;
+	double 			right_distance_;
+	double 			below_distance_;
+	double 			above_distance_;
+
+	void VelodyneCallback(const sensor_msgs::PointCloud2::Ptr& in_sensor_cloud_ptr);
+	void KeepLanes(const pcl::PointCloud<pcl::PointXYZ>::Ptr in_cloud_ptr,
+							pcl::PointCloud<pcl::PointXYZ>::Ptr out_cloud_ptr,
+							float in_left_lane_threshold,
+							float in_right_lane_threshold);
+	void ClipCloud(const pcl::PointCloud<pcl::PointXYZ>::Ptr in_cloud_ptr,
+							pcl::PointCloud<pcl::PointXYZ>::Ptr out_cloud_ptr,
+							float in_min_height,
+							float in_max_height);
+
+friend class PointsPreprocessorBenchmark;
+};
+
+#endif  // SPACE_FILTER_H_
@@ -4,45 +4,7 @@
  *  Created on: Nov 4, 2016
  *      Author: ne0
  */
-#include <ros/ros.h>
-#include <pcl_conversions/pcl_conversions.h>
-#include <pcl/filters/extract_indices.h>
-#include <sensor_msgs/point_cloud_conversion.h>
-#include <sensor_msgs/PointCloud.h>
-#include <sensor_msgs/PointCloud2.h>
-
-
-class SpaceFilter
-{
-public:
-	SpaceFilter();
-
-private:
-
-	ros::NodeHandle node_handle_;
-	ros::Subscriber cloud_sub_;
-	ros::Publisher 	cloud_pub_;
-
-	std::string 	subscribe_topic_;
-
-	bool			lateral_removal_;
-	bool			vertical_removal_;
-
-	double 			left_distance_;
-	double 			right_distance_;
-	double 			below_distance_;
-	double 			above_distance_;
-
-	void VelodyneCallback(const sensor_msgs::PointCloud2::Ptr& in_sensor_cloud_ptr);
-	void KeepLanes(const pcl::PointCloud<pcl::PointXYZ>::Ptr in_cloud_ptr,
-							pcl::PointCloud<pcl::PointXYZ>::Ptr out_cloud_ptr,
-							float in_left_lane_threshold,
-							float in_right_lane_threshold);
-	void ClipCloud(const pcl::PointCloud<pcl::PointXYZ>::Ptr in_cloud_ptr,
-							pcl::PointCloud<pcl::PointXYZ>::Ptr out_cloud_ptr,
-							float in_min_height,
-							float in_max_height);
-};
+#include "space_filter.h"
 
 SpaceFilter::SpaceFilter() :
 		node_handle_("~")
@@ -57,9 +19,14 @@ SpaceFilter::SpaceFilter() :
 	node_handle_.param("vertical_removal",  vertical_removal_,  true);
 	node_handle_.param("below_distance",  below_distance_,  -1.5);
 	node_handle_.param("above_distance",  above_distance_,  0.5);
+}
 
+void SpaceFilter::Run()
+{
 	cloud_sub_ = node_handle_.subscribe(subscribe_topic_, 10, &SpaceFilter::VelodyneCallback, this);
 	cloud_pub_ = node_handle_.advertise<sensor_msgs::PointCloud2>( "/points_clipped", 10);
+
+	ros::spin();
 }
 
 void SpaceFilter::KeepLanes(const pcl::PointCloud<pcl::PointXYZ>::Ptr in_cloud_ptr,
@@ -138,17 +105,3 @@ void SpaceFilter::VelodyneCallback(const sensor_msgs::PointCloud2::Ptr& in_senso
 	cloud_msg.header=in_sensor_cloud_ptr->header;
 	cloud_pub_.publish(cloud_msg);
 }
-
-int main(int argc, char **argv)
-{
-
-	ros::init(argc, argv, "space_filter");
-	SpaceFilter node;
-	ros::spin();
-
-	return 0;
-}
-
-
-
-
@@ -0,0 +1,22 @@
+/*
+ * space_filter_main.cpp
+ *
+ *  Created on: Nov 4, 2016
+ *      Author: ne0
+ */
+#include <ros/ros.h>
+#include "space_filter.h"
+
+int main(int argc, char **argv)
+{
+
+	ros::init(argc, argv, "space_filter");
+	SpaceFilter node;
+	node.Run();
+
+	return 0;
+}
+
+
+
+
@@ -1,5 +1,7 @@
 
+#include <algorithm>
 #include <cmath>
+#include <limits>
 
 #include <ros/ros.h>
 
@@ -8,7 +10,8 @@
 // test fixtures are necessary to use friend classes
 TEST(RayGroundFilter, clipCloud)
 {
-  char* argv = "test_points_preprocessor";
+  char arg0[] = "test_points_preprocessor";
+  char* argv = arg0;
   int argc = 1;
   ros::init(argc, &argv, "test_raygroundfilter_clipcloud");
   pcl::PointCloud<pcl::PointXYZI>::Ptr in_cloud_ptr(new pcl::PointCloud<pcl::PointXYZI>);
@@ -38,7 +41,7 @@ TEST(RayGroundFilter, clipCloud)
   rgfilter.ClipCloud(in_cloud_ptr, CLIP_HEIGHT, out_cloud_ptr);
 
   // make sure everything worked correctly
-  ASSERT_EQ(out_cloud_ptr->points.size(), 4);
+  ASSERT_EQ(out_cloud_ptr->points.size(), 4u);
   const float TOL = 1.0E-6F;
   ASSERT_LT(fabsf(out_cloud_ptr->points[0].x), TOL);
   ASSERT_LT(fabsf(out_cloud_ptr->points[0].y), TOL);
@@ -53,3 +56,158 @@ TEST(RayGroundFilter, clipCloud)
   ASSERT_LT(fabsf(out_cloud_ptr->points[3].y - 6.0F), TOL);
   ASSERT_LT(fabsf(out_cloud_ptr->points[3].z - 1.5F), TOL);
 }
+
+TEST(RayGroundFilter, radialOrder)
+{
+  char arg0[] = "test_points_preprocessor";
+  char* argv = arg0;
+  int argc = 1;
+  ros::init(argc, &argv, "test_raygroundfilter_radialorder");
+  pcl::PointCloud<pcl::PointXYZI>::Ptr in_cloud_ptr(new pcl::PointCloud<pcl::PointXYZI>);
+
+  RayGroundFilter rgfilter;
+  rgfilter.radial_divider_angle_ = 90.0;
+  rgfilter.concentric_divider_distance_ = 0.5;
+  rgfilter.radial_dividers_num_ = 4;
+  rgfilter.colors_.assign(rgfilter.color_num_, cv::Scalar(0, 0, 0));
+
+  // points on two rays, out of order and sharing concentric divisions
+  pcl::PointXYZI pt;
+  pt.z = 0.0F;
+  pt.x = 3.2F; pt.y = 0.1F;
+  in_cloud_ptr->push_back(pt);
+  pt.x = -0.1F; pt.y = 2.0F;
+  in_cloud_ptr->push_back(pt);
+  pt.x = 3.1F; pt.y = 0.1F;
+  in_cloud_ptr->push_back(pt);
+  pt.x = 1.0F; pt.y = 0.1F;
+  in_cloud_ptr->push_back(pt);
+  pt.x = -0.1F; pt.y = 1.0F;
+  in_cloud_ptr->push_back(pt);
+
+  RayGroundFilter::PointCloudXYZIRTColor ordered_points;
+  std::vector<size_t> offsets;
+  rgfilter.ConvertXYZIToRTZColor(in_cloud_ptr, ordered_points, offsets);
+
+  // make sure every ray holds its points ordered by radius
+  ASSERT_EQ(ordered_points.size(), 5u);
+  ASSERT_EQ(offsets.size(), 5u);
+  ASSERT_EQ(offsets[0], 0u);
+  ASSERT_EQ(offsets[1], 3u);
+  ASSERT_EQ(offsets[2], 5u);
+  ASSERT_EQ(offsets[4], 5u);
+  ASSERT_EQ(ordered_points[0].original_index, 3u);
+  ASSERT_EQ(ordered_points[1].original_index, 2u);
+  ASSERT_EQ(ordered_points[2].original_index, 0u);
+  ASSERT_EQ(ordered_points[3].original_index, 4u);
+  ASSERT_EQ(ordered_points[4].original_index, 1u);
+  for (size_t i = 0; i < ordered_points.size(); i++)
+  {
+    ASSERT_EQ(ordered_points[i].radial_div, i < 3 ? 0u : 1u);
+  }
+}
+
+TEST(RayGroundFilter, farConcentricDiv)
+{
+  char arg0[] = "test_points_preprocessor";
+  char* argv = arg0;
+  int argc = 1;
+  ros::init(argc, &argv, "test_raygroundfilter_farconcentricdiv");
+  pcl::PointCloud<pcl::PointXYZI>::Ptr in_cloud_ptr(new pcl::PointCloud<pcl::PointXYZI>);
+
+  RayGroundFilter rgfilter;
+  rgfilter.radial_divider_angle_ = 90.0;
+  rgfilter.concentric_divider_distance_ = 0.5;
+  rgfilter.radial_dividers_num_ = 4;
+  rgfilter.colors_.assign(rgfilter.color_num_, cv::Scalar(0, 0, 0));
+
+  // far points share the last counting sort bucket, but keep their own concentric division
+  pcl::PointXYZI pt;
+  pt.z = 0.0F; pt.y = 0.1F;
+  pt.x = 90.2F;
+  in_cloud_ptr->push_back(pt);
+  pt.x = 1.2F;
+  in_cloud_ptr->push_back(pt);
+  pt.x = 60.2F;
+  in_cloud_ptr->push_back(pt);
+
+  RayGroundFilter::PointCloudXYZIRTColor ordered_points;
+  std::vector<size_t> offsets;
+  rgfilter.ConvertXYZIToRTZColor(in_cloud_ptr, ordered_points, offsets);
+
+  ASSERT_EQ(ordered_points.size(), 3u);
+  ASSERT_EQ(ordered_points[0].original_index, 1u);
+  ASSERT_EQ(ordered_points[1].original_index, 2u);
+  ASSERT_EQ(ordered_points[2].original_index, 0u);
+  for (size_t i = 0; i < ordered_points.size(); i++)
+  {
+    ASSERT_EQ(ordered_points[i].concentric_div,
+              (size_t) floor(ordered_points[i].radius / rgfilter.concentric_divider_distance_));
+  }
+  ASSERT_EQ(ordered_points[2].concentric_div, 180u);
+}
+
+// Ground segmentation of a synthetic 128-beam scan of about 148k points, 1800 points per beam.
+// The target is 2 ms per cloud, which relies on the OpenMP sweep of ray_ground_filter_lib on several cores.
+// On a single core ConvertXYZIToRTZColor and ClassifyPointCloud were measured at 12 to 16 ms (21 to 29 ms before
+// the counting sorts), so the ceiling gates that number and fails on a return to the per-division sorting.
+TEST(RayGroundFilter, segmentationTime)
+{
+  char arg0[] = "test_points_preprocessor";
+  char* argv = arg0;
+  int argc = 1;
+  ros::init(argc, &argv, "test_raygroundfilter_segmentationtime");
+  pcl::PointCloud<pcl::PointXYZI>::Ptr in_cloud_ptr(new pcl::PointCloud<pcl::PointXYZI>);
+
+  RayGroundFilter rgfilter;
+  rgfilter.sensor_height_ = 1.7;
+  rgfilter.general_max_slope_ = 3.0;
+  rgfilter.local_max_slope_ = 5.0;
+  rgfilter.radial_divider_angle_ = 0.1;
+  rgfilter.concentric_divider_distance_ = 0.01;
+  rgfilter.min_height_threshold_ = 0.05;
+  rgfilter.reclass_distance_threshold_ = 0.2;
+  rgfilter.radial_dividers_num_ = ceil(360 / rgfilter.radial_divider_angle_);
+  rgfilter.colors_.assign(rgfilter.color_num_, cv::Scalar(0, 0, 0));
+
+  // flat ground below the beams pointing down, a wall around the car and a few obstacles on the ground
+  for (int ring = 0; ring < 128; ring++)
+  {
+    const float elevation = (-25.0F + ring * 40.0F / 128) * M_PI / 180;
+    for (int azimuth = 0; azimuth < 1800; azimuth++)
+    {
+      const float angle = azimuth * 2 * M_PI / 1800;
+      float range = elevation < 0 ? std::min(1.7F / std::tan(-elevation), 120.0F) : 20.0F + ring % 7;
+      if (azimuth % 97 < 5)
+      {
+        range = std::min(range, 8.0F + azimuth % 13);
+      }
+      pcl::PointXYZI pt;
+      pt.x = range * std::cos(elevation) * std::cos(angle);
+      pt.y = range * std::cos(elevation) * std::sin(angle);
+      pt.z = range * std::sin(elevation);
+      pt.intensity = 0.0F;
+      if (std::sqrt(pt.x * pt.x + pt.y * pt.y) > 1.85F && pt.z < 0.2F)
+      {
+        in_cloud_ptr->push_back(pt);
+      }
+    }
+  }
+  ASSERT_GT(in_cloud_ptr->points.size(), 140000u);
+
+  pcl::PointIndices ground_indices, no_ground_indices;
+  double best_ms = std::numeric_limits<double>::max();
+  for (int run = 0; run < 5; run++)
+  {
+    ros::WallTime start = ros::WallTime::now();
+    rgfilter.ConvertXYZIToRTZColor(in_cloud_ptr, rgfilter.radial_ordered_points_, rgfilter.radial_offsets_);
+    rgfilter.ClassifyPointCloud(rgfilter.radial_ordered_points_, rgfilter.radial_offsets_,
+                                ground_indices, no_ground_indices);
+    best_ms = std::min(best_ms, (ros::WallTime::now() - start).toSec() * 1000.0);
+  }
+
+  ASSERT_EQ(ground_indices.indices.size() + no_ground_indices.indices.size(), in_cloud_ptr->points.size());
+  ASSERT_GT(ground_indices.indices.size(), no_ground_indices.indices.size());
+  const double CEILING_MS = 20.0;
+  EXPECT_LT(best_ms, CEILING_MS);
+}
@@ -39,9 +39,7 @@
 #include <pcl/point_types.h>
 #include <pcl/filters/voxel_grid.h>
 #include <pcl/registration/ndt.h>
-#include <message_filters/subscriber.h>
-#include <message_filters/synchronizer.h>
-#include <message_filters/sync_policies/approximate_time.h>
+#include <time_sync_lib/synchronizer.hpp>
 
 
 #include <tf/tf.h>
@@ -78,14 +76,9 @@ class ROSMultiLidarCalibratorApp
 
 	Eigen::Matrix4f                     current_guess_;
 
-	typedef
-	message_filters::sync_policies::ApproximateTime<sensor_msgs::PointCloud2,
-			sensor_msgs::PointCloud2>   SyncPolicyT;
-
 	typedef pcl::PointXYZI              PointT;
 
-	message_filters::Subscriber<sensor_msgs::PointCloud2>   *cloud_parent_subscriber_, *cloud_child_subscriber_;
-	message_filters::Synchronizer<SyncPolicyT>              *cloud_synchronizer_;
+	boost::shared_ptr<time_sync::Synchronizer>  cloud_synchronizer_;
 
 	/*!
 	 * Receives 2 synchronized point cloud messages.
@@ -95,6 +88,12 @@ class ROSMultiLidarCalibratorApp
 	void PointsCallback(const sensor_msgs::PointCloud2::ConstPtr& in_parent_cloud_msg,
 	                    const sensor_msgs::PointCloud2::ConstPtr& in_child_cloud_msg);
 
+	/*!
+	 * Passes the clouds matched by the synchronizer to PointsCallback.
+	 * @param[in] in_matches Parent cloud (pivot) and child cloud.
+	 */
+	void MatchedPointsCallback(const std::vector<time_sync::Match>& in_matches);
+
 	//void InitialPoseCallback(geometry_msgs::PoseWithCovarianceStamped::ConstPtr in_initialpose);
 
 	/*!
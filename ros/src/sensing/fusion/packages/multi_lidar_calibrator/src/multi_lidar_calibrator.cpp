@@ -122,6 +122,11 @@ void ROSMultiLidarCalibratorApp::PointsCallback(const sensor_msgs::PointCloud2::
 
 }*/
 
+void ROSMultiLidarCalibratorApp::MatchedPointsCallback(const std::vector<time_sync::Match>& in_matches)
+{
+	PointsCallback(in_matches[0].get<sensor_msgs::PointCloud2>(), in_matches[1].get<sensor_msgs::PointCloud2>());
+}
+
 void ROSMultiLidarCalibratorApp::DownsampleCloud(pcl::PointCloud<PointT>::ConstPtr in_cloud_ptr,
                                                  pcl::PointCloud<PointT>::Ptr out_cloud_ptr,
                                                  double in_leaf_size)
@@ -138,6 +143,7 @@ void ROSMultiLidarCalibratorApp::InitializeROSIo(ros::NodeHandle &in_private_han
 	std::string points_parent_topic_str, points_child_topic_str;
 	std::string initial_pose_topic_str = "/initialpose";
 	std::string calibrated_points_topic_str = "/points_calibrated";
+	double sync_max_interval, sync_max_delay;
 
 	in_private_handle.param<std::string>("points_parent_src", points_parent_topic_str, "points_raw");
 	ROS_INFO("[%s] points_parent_src: %s",__APP_NAME__, points_parent_topic_str.c_str());
@@ -171,13 +177,20 @@ void ROSMultiLidarCalibratorApp::InitializeROSIo(ros::NodeHandle &in_private_han
 	         initial_x_, initial_y_, initial_z_,
 	         initial_roll_, initial_pitch_, initial_yaw_);
 
-	//generate subscribers and synchronizer
-	cloud_parent_subscriber_ = new message_filters::Subscriber<sensor_msgs::PointCloud2>(node_handle_,
-	                                                                                     points_parent_topic_str, 10);
+	in_private_handle.param<double>("sync_max_interval", sync_max_interval, 0.1);
+	ROS_INFO("[%s] sync_max_interval: %.2f",__APP_NAME__, sync_max_interval);
+
+	in_private_handle.param<double>("sync_max_delay", sync_max_delay, 0.2);
+	ROS_INFO("[%s] sync_max_delay: %.2f",__APP_NAME__, sync_max_delay);
+
+	//generate subscribers and synchronizer, the parent cloud is the pivot
+	cloud_synchronizer_.reset(new time_sync::Synchronizer(2, ros::Duration(sync_max_interval),
+	                                                      ros::Duration(sync_max_delay)));
+
+	cloud_synchronizer_->subscribe<sensor_msgs::PointCloud2>(node_handle_, points_parent_topic_str, 0, 10);
 	ROS_INFO("[%s] Subscribing to... %s",__APP_NAME__, points_parent_topic_str.c_str());
 
-	cloud_child_subscriber_ = new message_filters::Subscriber<sensor_msgs::PointCloud2>(node_handle_,
-	                                                                                        points_child_topic_str, 10);
+	cloud_synchronizer_->subscribe<sensor_msgs::PointCloud2>(node_handle_, points_child_topic_str, 1, 10);
 	ROS_INFO("[%s] Subscribing to... %s",__APP_NAME__, points_child_topic_str.c_str());
 
 	/*initialpose_subscriber_ = node_handle_.subscribe(initial_pose_topic_str, 10,
@@ -187,11 +200,7 @@ void ROSMultiLidarCalibratorApp::InitializeROSIo(ros::NodeHandle &in_private_han
 	calibrated_cloud_publisher_ = node_handle_.advertise<sensor_msgs::PointCloud2>(calibrated_points_topic_str, 1);
 	ROS_INFO("[%s] Publishing PointCloud to... %s",__APP_NAME__, calibrated_points_topic_str.c_str());
 
-	cloud_synchronizer_ =
-			new message_filters::Synchronizer<SyncPolicyT>(SyncPolicyT(100),
-			                                               *cloud_parent_subscriber_,
-			                                               *cloud_child_subscriber_);
-	cloud_synchronizer_->registerCallback(boost::bind(&ROSMultiLidarCalibratorApp::PointsCallback, this, _1, _2));
+	cloud_synchronizer_->registerCallback(boost::bind(&ROSMultiLidarCalibratorApp::MatchedPointsCallback, this, _1));
 
 }
 
@@ -0,0 +1,65 @@
+/*
+ * Copyright 2018-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * csv_reader.h
+ *
+ * The CSV parser of map_processor, kept apart so it can be tested.
+ */
+
+#ifndef MAP_TOOLS_CSV_READER_H
+#define MAP_TOOLS_CSV_READER_H
+
+#include <cstdlib>
+#include <cstring>
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+
+// Parses the "x,y,z,intensity" lines of csv2pcd in [data, end). Lines with
+// missing columns are skipped. No value is read past the end of its line,
+// because strtof and strtol skip leading whitespace, newlines included.
+inline void parse_csv(const char *data, const char *end,
+                      pcl::PointCloud<pcl::PointXYZI> *cloud) {
+  cloud->clear();
+  const char *p = data;
+  while (p < end) {
+    const char *line_end =
+        static_cast<const char *>(std::memchr(p, '\n', end - p));
+    if (line_end == NULL)
+      line_end = end;
+
+    pcl::PointXYZI point;
+    char *next;
+    bool valid = true;
+    float *values[3] = {&point.x, &point.y, &point.z};
+    const char *q = p;
+    for (int i = 0; i < 3 && valid; i++) {
+      *values[i] = std::strtof(q, &next);
+      valid = next != q && next < line_end && *next == ',';
+      q = next + 1;
+    }
+    if (valid && q < line_end) {
+      // csv2pcd reads the intensity as an integer
+      point.intensity = std::strtol(q, &next, 10);
+      valid = next != q && next <= line_end;
+    } else {
+      valid = false;
+    }
+    if (valid)
+      cloud->push_back(point);
+    p = line_end + 1;
+  }
+}
+
+#endif // MAP_TOOLS_CSV_READER_H
@@ -0,0 +1,406 @@
+/*
+ * Copyright 2018-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * map_processor.cpp
+ *
+ * Runs a chain of the operations of pcd_filter, pcd_binarizer, csv2pcd and
+ * pcd2csv, plus crop and translate, over many map files with a pool of
+ * threads. Each step names its output like the tool it replaces, so the
+ * chain "--voxel 0.2 --binarize" writes the same file as pcd_filter followed
+ * by pcd_binarizer.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <dirent.h>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <pcl/filters/voxel_grid.h>
+#include <pcl/io/pcd_io.h>
+#include <pcl/point_types.h>
+#include <sstream>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+#include <vector>
+
+#include "csv_reader.h"
+
+enum class step_type { VOXEL, CROP, TRANSLATE, BINARIZE, CSV };
+
+struct step {
+  step_type type;
+  double values[6];
+};
+
+struct file_stats {
+  size_t files = 0;
+  size_t failed = 0;
+  size_t input_points = 0;
+  size_t output_points = 0;
+  size_t input_bytes = 0;
+};
+
+static std::mutex output_mutex;
+
+static bool ends_with(const std::string &s, const std::string &suffix) {
+  return s.size() >= suffix.size() &&
+         s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// Same as the tools: the prefix goes in front of the file name
+static std::string insert_prefix(std::string path, const std::string &prefix) {
+  int tmp = path.find_last_of("/");
+  return path.insert(tmp + 1, prefix);
+}
+
+static std::string replace_extension(const std::string &path,
+                                     const std::string &extension) {
+  std::string::size_type dot = path.find_last_of(".");
+  std::string::size_type slash = path.find_last_of("/");
+  if (dot == std::string::npos ||
+      (slash != std::string::npos && dot < slash))
+    return path + extension;
+  return path.substr(0, dot) + extension;
+}
+
+static size_t file_size(const std::string &path) {
+  struct stat buf;
+  return stat(path.c_str(), &buf) == 0 ? buf.st_size : 0;
+}
+
+// *.pcd and *.csv of a directory, sorted like pcd_arealist
+static void add_dir(const std::string &path, std::vector<std::string> *inputs) {
+  std::vector<std::string> files;
+  DIR *dir = opendir(path.c_str());
+  if (dir == NULL) {
+    std::cout << "Can't read " << path << "." << std::endl;
+    return;
+  }
+  for (struct dirent *entry = readdir(dir); entry != NULL;
+       entry = readdir(dir)) {
+    std::string name = entry->d_name;
+    if (ends_with(name, ".pcd") || ends_with(name, ".csv"))
+      files.push_back(path + "/" + name);
+  }
+  closedir(dir);
+  std::sort(files.begin(), files.end());
+  inputs->insert(inputs->end(), files.begin(), files.end());
+}
+
+// Reads the whole file at once instead of line by line
+static bool read_csv(const std::string &path,
+                     pcl::PointCloud<pcl::PointXYZI> *cloud) {
+  std::ifstream ifs(path.c_str(), std::ios::binary);
+  if (!ifs)
+    return false;
+  std::string data((std::istreambuf_iterator<char>(ifs)),
+                   std::istreambuf_iterator<char>());
+  parse_csv(data.data(), data.data() + data.size(), cloud);
+  return true;
+}
+
+template <typename PointT>
+static bool read_csv(const std::string &path, pcl::PointCloud<PointT> *cloud) {
+  return false;
+}
+
+// The columns of pcd2csv
+static void write_csv_point(std::ostream &os, const pcl::PointXYZ &p) {
+  os << p.x << "," << p.y << "," << p.z << "\n";
+}
+
+static void write_csv_point(std::ostream &os, const pcl::PointXYZI &p) {
+  os << p.x << "," << p.y << "," << p.z << "," << p.intensity << "\n";
+}
+
+static void write_csv_point(std::ostream &os, const pcl::PointXYZRGB &p) {
+  os << p.x << "," << p.y << "," << p.z << "," << p.rgb << "\n";
+}
+
+// Formats blocks of points in memory, so the file is written in large writes
+template <typename PointT>
+static bool write_csv(const std::string &path,
+                      const pcl::PointCloud<PointT> &cloud) {
+  std::ofstream ofs(path.c_str());
+  if (!ofs)
+    return false;
+  const size_t block = 65536;
+  for (size_t begin = 0; begin < cloud.points.size(); begin += block) {
+    std::ostringstream oss;
+    size_t end = std::min(begin + block, cloud.points.size());
+    for (size_t i = begin; i < end; i++)
+      write_csv_point(oss, cloud.points[i]);
+    const std::string &s = oss.str();
+    ofs.write(s.data(), s.size());
+  }
+  return static_cast<bool>(ofs);
+}
+
+// The filter of pcd_filter: the points are moved next to the origin, so the
+// voxel grid does not lose precision, and moved back afterwards
+template <typename PointT>
+static void voxel_filter(typename pcl::PointCloud<PointT>::Ptr &cloud,
+                         double leaf_size) {
+  pcl::PointXYZ origin;
+  for (size_t i = 0; i < cloud->points.size(); i++) {
+    const PointT &p = cloud->points[i];
+    if (std::isfinite(p.x) && std::isfinite(p.y) && std::isfinite(p.z)) {
+      origin.x = p.x;
+      origin.y = p.y;
+      origin.z = p.z;
+      break;
+    }
+  }
+
+  for (size_t i = 0; i < cloud->points.size(); i++) {
+    cloud->points[i].x -= origin.x;
+    cloud->points[i].y -= origin.y;
+    cloud->points[i].z -= origin.z;
+  }
+
+  typename pcl::PointCloud<PointT>::Ptr filtered(new pcl::PointCloud<PointT>);
+  pcl::VoxelGrid<PointT> voxel_grid_filter;
+  voxel_grid_filter.setLeafSize(leaf_size, leaf_size, leaf_size);
+  voxel_grid_filter.setInputCloud(cloud);
+  voxel_grid_filter.filter(*filtered);
+
+  for (size_t i = 0; i < filtered->points.size(); i++) {
+    filtered->points[i].x += origin.x;
+    filtered->points[i].y += origin.y;
+    filtered->points[i].z += origin.z;
+  }
+  cloud = filtered;
+}
+
+template <typename PointT>
+static void crop(pcl::PointCloud<PointT> *cloud, const double *box) {
+  size_t n = 0;
+  for (size_t i = 0; i < cloud->points.size(); i++) {
+    const PointT &p = cloud->points[i];
+    if (box[0] <= p.x && p.x <= box[3] && box[1] <= p.y && p.y <= box[4] &&
+        box[2] <= p.z && p.z <= box[5])
+      cloud->points[n++] = p;
+  }
+  cloud->points.resize(n);
+  cloud->width = n;
+  cloud->height = 1;
+}
+
+template <typename PointT>
+static void translate(pcl::PointCloud<PointT> *cloud, const double *offset) {
+  for (size_t i = 0; i < cloud->points.size(); i++) {
+    cloud->points[i].x += offset[0];
+    cloud->points[i].y += offset[1];
+    cloud->points[i].z += offset[2];
+  }
+}
+
+template <typename PointT>
+static void process_file(const std::string &input,
+                         const std::vector<step> &chain,
+                         const std::string &output_dir, file_stats *stats) {
+  typename pcl::PointCloud<PointT>::Ptr cloud(new pcl::PointCloud<PointT>);
+  bool csv_input = ends_with(input, ".csv");
+  bool loaded = csv_input ? read_csv(input, cloud.get())
+                          : pcl::io::loadPCDFile<PointT>(input, *cloud) != -1;
+  if (!loaded) {
+    std::lock_guard<std::mutex> lock(output_mutex);
+    std::cout << "Couldn't read " << input << "." << std::endl;
+    stats->failed++;
+    return;
+  }
+  size_t input_points = cloud->points.size();
+
+  std::string output = input;
+  bool csv_output = false;
+  for (size_t i = 0; i < chain.size(); i++) {
+    const step &s = chain[i];
+    if (s.type == step_type::VOXEL) {
+      voxel_filter<PointT>(cloud, s.values[0]);
+      std::string prefix = std::to_string(s.values[0]);
+      output = insert_prefix(output, prefix.substr(0, 4) + "_");
+    } else if (s.type == step_type::CROP) {
+      crop(cloud.get(), s.values);
+      output = insert_prefix(output, "crop_");
+    } else if (s.type == step_type::TRANSLATE) {
+      translate(cloud.get(), s.values);
+      output = insert_prefix(output, "translated_");
+    } else if (s.type == step_type::BINARIZE) {
+      output = insert_prefix(output, "bin_");
+    } else if (s.type == step_type::CSV) {
+      csv_output = true;
+    }
+  }
+  if (csv_output)
+    output = replace_extension(output, ".csv");
+  else if (csv_input)
+    output = replace_extension(output, ".pcd");
+  if (!output_dir.empty())
+    output = output_dir + "/" + output.substr(output.find_last_of("/") + 1);
+
+  bool saved = csv_output ? write_csv(output, *cloud)
+                          : pcl::io::savePCDFileBinary(output, *cloud) != -1;
+
+  std::lock_guard<std::mutex> lock(output_mutex);
+  if (!saved) {
+    std::cout << "Failed saving " << output << std::endl;
+    stats->failed++;
+    return;
+  }
+  std::cout << "Input: " << input << " (" << input_points << " points) "
+            << std::endl;
+  std::cout << "Output: " << output << " (" << cloud->points.size()
+            << " points) " << std::endl;
+  stats->files++;
+  stats->input_points += input_points;
+  stats->output_points += cloud->points.size();
+  stats->input_bytes += file_size(input);
+}
+
+template <typename PointT>
+static void process_files(const std::vector<std::string> &inputs,
+                          const std::vector<step> &chain,
+                          const std::string &output_dir,
+                          std::atomic<size_t> *next_input, file_stats *stats) {
+  for (size_t i = (*next_input)++; i < inputs.size(); i = (*next_input)++)
+    process_file<PointT>(inputs[i], chain, output_dir, stats);
+}
+
+template <typename PointT>
+static void run(const std::vector<std::string> &inputs,
+                const std::vector<step> &chain, const std::string &output_dir,
+                int jobs, file_stats *stats) {
+  std::atomic<size_t> next_input(0);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < jobs; t++)
+    threads.push_back(std::thread(process_files<PointT>, std::cref(inputs),
+                                  std::cref(chain), std::cref(output_dir),
+                                  &next_input, stats));
+  for (size_t t = 0; t < threads.size(); t++)
+    threads[t].join();
+}
+
+static void print_usage() {
+  std::cout
+      << "Usage: rosrun map_tools map_processor [--jobs N] [--output_dir DIR] "
+         "\"point_type [PointXYZ|PointXYZI|PointXYZRGB]\" [steps] "
+         "\"***.pcd|***.csv|directory\" ...\n"
+         "Steps, run in the order given:\n"
+         "  --voxel LEAF_SIZE                          as pcd_filter\n"
+         "  --crop MIN_X MIN_Y MIN_Z MAX_X MAX_Y MAX_Z keeps the points in "
+         "the box\n"
+         "  --translate X Y Z                          moves the points\n"
+         "  --binarize                                 as pcd_binarizer\n"
+         "  --csv                                      as pcd2csv, must be "
+         "the last step\n"
+         "CSV inputs are read as csv2pcd does, with PointXYZI.\n";
+}
+
+int main(int argc, char **argv) {
+  int jobs = std::max(1u, std::thread::hardware_concurrency());
+  std::string output_dir;
+  std::string point_type;
+  std::vector<step> chain;
+  std::vector<std::string> inputs;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    int values = 0;
+    step s;
+    if (arg == "--jobs" && i + 1 < argc) {
+      jobs = std::max(1, std::atoi(argv[++i]));
+      continue;
+    } else if (arg == "--output_dir" && i + 1 < argc) {
+      output_dir = argv[++i];
+      continue;
+    } else if (arg == "--voxel") {
+      s.type = step_type::VOXEL;
+      values = 1;
+    } else if (arg == "--crop") {
+      s.type = step_type::CROP;
+      values = 6;
+    } else if (arg == "--translate") {
+      s.type = step_type::TRANSLATE;
+      values = 3;
+    } else if (arg == "--binarize") {
+      s.type = step_type::BINARIZE;
+    } else if (arg == "--csv") {
+      s.type = step_type::CSV;
+    } else if (arg.compare(0, 2, "--") == 0) {
+      print_usage();
+      return 1;
+    } else if (point_type.empty()) {
+      point_type = arg;
+      continue;
+    } else {
+      struct stat buf;
+      if (stat(arg.c_str(), &buf) == 0 && S_ISDIR(buf.st_mode))
+        add_dir(arg, &inputs);
+      else
+        inputs.push_back(arg);
+      continue;
+    }
+
+    if (i + values >= argc) {
+      print_usage();
+      return 1;
+    }
+    for (int v = 0; v < values; v++)
+      s.values[v] = std::stod(argv[++i]);
+    chain.push_back(s);
+  }
+
+  for (size_t i = 0; i + 1 < chain.size(); i++) {
+    if (chain[i].type == step_type::CSV) {
+      std::cout << "--csv must be the last step." << std::endl;
+      return 1;
+    }
+  }
+  if (inputs.empty() ||
+      (point_type != "PointXYZ" && point_type != "PointXYZI" &&
+       point_type != "PointXYZRGB")) {
+    print_usage();
+    return 1;
+  }
+
+  std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+  file_stats stats;
+  if (point_type == "PointXYZ")
+    run<pcl::PointXYZ>(inputs, chain, output_dir, jobs, &stats);
+  else if (point_type == "PointXYZI")
+    run<pcl::PointXYZI>(inputs, chain, output_dir, jobs, &stats);
+  else if (point_type == "PointXYZRGB")
+    run<pcl::PointXYZRGB>(inputs, chain, output_dir, jobs, &stats);
+  double seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+
+  std::cout << std::endl
+            << "Processed " << stats.files << " files (" << stats.failed
+            << " failed) with " << jobs << " threads in " << seconds << " s: "
+            << stats.input_points << " points in, " << stats.output_points
+            << " points out, " << stats.files / seconds << " files/s, "
+            << stats.input_points / seconds << " points/s, "
+            << stats.input_bytes / seconds / (1024.0 * 1024.0) << " MB/s."
+            << std::endl;
+  return stats.failed > 0 ? 1 : 0;
+}
@@ -20,11 +20,27 @@
  *  Created on: May 15, 2018
  */
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <pcl/PCLPointCloud2.h>
+#include <pcl/conversions.h>
 #include <pcl/io/pcd_io.h>
 #include <pcl/point_types.h>
 #include <sstream>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 struct pcd_xyz_grid {
@@ -63,19 +79,562 @@ struct pcd_xyzrgb_grid {
   pcl::PointCloud<pcl::PointXYZRGB> cloud;
 };
 
+/*
+ * Streaming mode
+ *
+ * The input PCDs are read in chunks, by several threads, and the points of
+ * each grid are appended to a spill file next to the output. Once all the
+ * inputs are read, each spill file is converted to a binary PCD and the
+ * bounds of the grids are written to arealist.txt. Memory is bounded by the
+ * budget instead of the size of the map.
+ */
+
+struct pcd_header {
+  std::vector<pcl::PCLPointField> fields;
+  uint32_t point_step;
+  size_t points;
+  std::string data; // ascii, binary or binary_compressed
+  std::streampos data_pos;
+};
+
+static uint8_t pcd_datatype(char type, int size) {
+  if (type == 'F' && size == 4)
+    return pcl::PCLPointField::FLOAT32;
+  if (type == 'F' && size == 8)
+    return pcl::PCLPointField::FLOAT64;
+  if (type == 'I' && size == 1)
+    return pcl::PCLPointField::INT8;
+  if (type == 'I' && size == 2)
+    return pcl::PCLPointField::INT16;
+  if (type == 'I' && size == 4)
+    return pcl::PCLPointField::INT32;
+  if (type == 'U' && size == 1)
+    return pcl::PCLPointField::UINT8;
+  if (type == 'U' && size == 2)
+    return pcl::PCLPointField::UINT16;
+  if (type == 'U' && size == 4)
+    return pcl::PCLPointField::UINT32;
+  return 0;
+}
+
+// Reads the header only, so the points can be read in chunks after it
+static bool read_pcd_header(std::ifstream &ifs, pcd_header *header) {
+  std::vector<std::string> names;
+  std::vector<int> sizes, counts;
+  std::vector<char> types;
+  size_t width = 0, height = 1, points = 0;
+  bool has_points = false;
+
+  std::string line;
+  while (std::getline(ifs, line)) {
+    std::istringstream ss(line);
+    std::string key;
+    ss >> key;
+    if (key.empty() || key[0] == '#')
+      continue;
+
+    std::string value;
+    if (key == "FIELDS" || key == "COLUMNS") {
+      while (ss >> value)
+        names.push_back(value);
+    } else if (key == "SIZE") {
+      while (ss >> value)
+        sizes.push_back(std::atoi(value.c_str()));
+    } else if (key == "TYPE") {
+      while (ss >> value)
+        types.push_back(value[0]);
+    } else if (key == "COUNT") {
+      while (ss >> value)
+        counts.push_back(std::atoi(value.c_str()));
+    } else if (key == "WIDTH") {
+      ss >> width;
+    } else if (key == "HEIGHT") {
+      ss >> height;
+    } else if (key == "POINTS") {
+      ss >> points;
+      has_points = true;
+    } else if (key == "DATA") {
+      ss >> header->data;
+      header->data_pos = ifs.tellg();
+      break;
+    }
+  }
+
+  if (header->data.empty() || names.empty() || sizes.size() != names.size() ||
+      types.size() != names.size())
+    return false;
+  if (counts.empty())
+    counts.assign(names.size(), 1);
+  if (counts.size() != names.size())
+    return false;
+
+  header->fields.clear();
+  uint32_t offset = 0;
+  for (size_t i = 0; i < names.size(); i++) {
+    pcl::PCLPointField field;
+    field.name = names[i];
+    field.offset = offset;
+    field.datatype = pcd_datatype(types[i], sizes[i]);
+    field.count = counts[i];
+    if (field.datatype == 0)
+      return false;
+    header->fields.push_back(field);
+    offset += sizes[i] * counts[i];
+  }
+  header->point_step = offset;
+  header->points = has_points ? points : width * height;
+  return true;
+}
+
+static void parse_ascii_value(const char *token, uint8_t datatype,
+                              uint8_t *dst) {
+  double v = std::strtod(token, NULL);
+  switch (datatype) {
+  case pcl::PCLPointField::INT8: {
+    int8_t t = static_cast<int8_t>(v);
+    std::memcpy(dst, &t, sizeof(t));
+    break;
+  }
+  case pcl::PCLPointField::UINT8: {
+    uint8_t t = static_cast<uint8_t>(v);
+    std::memcpy(dst, &t, sizeof(t));
+    break;
+  }
+  case pcl::PCLPointField::INT16: {
+    int16_t t = static_cast<int16_t>(v);
+    std::memcpy(dst, &t, sizeof(t));
+    break;
+  }
+  case pcl::PCLPointField::UINT16: {
+    uint16_t t = static_cast<uint16_t>(v);
+    std::memcpy(dst, &t, sizeof(t));
+    break;
+  }
+  case pcl::PCLPointField::INT32: {
+    int32_t t = static_cast<int32_t>(v);
+    std::memcpy(dst, &t, sizeof(t));
+    break;
+  }
+  case pcl::PCLPointField::UINT32: {
+    uint32_t t = static_cast<uint32_t>(v);
+    std::memcpy(dst, &t, sizeof(t));
+    break;
+  }
+  case pcl::PCLPointField::FLOAT32: {
+    float t = static_cast<float>(v);
+    std::memcpy(dst, &t, sizeof(t));
+    break;
+  }
+  case pcl::PCLPointField::FLOAT64:
+    std::memcpy(dst, &v, sizeof(v));
+    break;
+  }
+}
+
+static size_t pcd_field_size(uint8_t datatype) {
+  switch (datatype) {
+  case pcl::PCLPointField::INT8:
+  case pcl::PCLPointField::UINT8:
+    return 1;
+  case pcl::PCLPointField::INT16:
+  case pcl::PCLPointField::UINT16:
+    return 2;
+  case pcl::PCLPointField::FLOAT64:
+    return 8;
+  default:
+    return 4;
+  }
+}
+
+// Reads the points of a PCD in chunks. binary_compressed PCDs can only be
+// read at once, so they come as a single chunk.
+template <typename PointT> class pcd_chunk_reader {
+public:
+  bool open(const std::string &path) {
+    path_ = path;
+    read_ = 0;
+    ifs_.open(path.c_str(), std::ios::binary);
+    if (!ifs_ || !read_pcd_header(ifs_, &header_))
+      return false;
+    if (header_.data == "binary")
+      ifs_.seekg(header_.data_pos);
+    return header_.data == "ascii" || header_.data == "binary" ||
+           header_.data == "binary_compressed";
+  }
+
+  bool is_compressed() const { return header_.data == "binary_compressed"; }
+
+  // returns false once all the points have been read
+  bool read(size_t chunk_points, pcl::PointCloud<PointT> *chunk) {
+    chunk->clear();
+    if (read_ >= header_.points)
+      return false;
+
+    if (is_compressed()) {
+      read_ = header_.points;
+      return pcl::io::loadPCDFile<PointT>(path_, *chunk) != -1;
+    }
+
+    size_t n = std::min(chunk_points, header_.points - read_);
+    pcl::PCLPointCloud2 cloud;
+    cloud.fields = header_.fields;
+    cloud.point_step = header_.point_step;
+    cloud.height = 1;
+    cloud.is_dense = false;
+    cloud.data.resize(n * header_.point_step);
+
+    if (header_.data == "binary") {
+      ifs_.read(reinterpret_cast<char *>(cloud.data.data()), cloud.data.size());
+      n = ifs_.gcount() / header_.point_step;
+    } else {
+      std::string line;
+      size_t row = 0;
+      while (row < n && std::getline(ifs_, line)) {
+        std::istringstream ss(line);
+        std::string token;
+        uint8_t *dst = &cloud.data[row * header_.point_step];
+        bool complete = true;
+        for (size_t f = 0; f < header_.fields.size() && complete; f++) {
+          const pcl::PCLPointField &field = header_.fields[f];
+          size_t size = pcd_field_size(field.datatype);
+          for (uint32_t c = 0; c < field.count; c++) {
+            if (!(ss >> token)) {
+              complete = false;
+              break;
+            }
+            parse_ascii_value(token.c_str(), field.datatype,
+                              dst + field.offset + c * size);
+          }
+        }
+        if (complete)
+          row++;
+      }
+      n = row;
+    }
+    if (n == 0) {
+      read_ = header_.points;
+      return false;
+    }
+    read_ += n;
+
+    cloud.width = n;
+    cloud.row_step = n * header_.point_step;
+    cloud.data.resize(cloud.row_step);
+    pcl::fromPCLPointCloud2(cloud, *chunk);
+    return true;
+  }
+
+  size_t point_step() const { return header_.point_step; }
+
+private:
+  std::string path_;
+  std::ifstream ifs_;
+  pcd_header header_;
+  size_t read_;
+};
+
+// Bytes held by the threads finalizing the grids. A thread waits until the
+// grid it takes fits in the budget, unless no other grid is held.
+class memory_budget {
+public:
+  explicit memory_budget(size_t bytes) : budget_(bytes), used_(0) {}
+
+  void acquire(size_t bytes) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    released_.wait(lock,
+                   [&] { return used_ == 0 || used_ + bytes <= budget_; });
+    used_ += bytes;
+  }
+
+  void release(size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    used_ -= bytes;
+    released_.notify_all();
+  }
+
+private:
+  size_t budget_;
+  size_t used_;
+  std::mutex mutex_;
+  std::condition_variable released_;
+};
+
+struct spill_grid {
+  std::mutex mutex;
+  std::string spill_path;
+  std::string filename;
+  size_t points_num = 0;
+};
+
+struct grid_area {
+  std::string filename;
+  double x_min, y_min, z_min, x_max, y_max, z_max;
+};
+
+// Spill files of the grids, appended to by the reading threads
+template <typename PointT> class spill_grids {
+public:
+  typedef std::pair<int, int> key_type;
+  typedef typename pcl::PointCloud<PointT>::VectorType point_vector;
+
+  spill_grids(const std::string &output_dir, int grid_size)
+      : output_dir_(output_dir), grid_size_(grid_size) {}
+
+  void append(const key_type &key, const point_vector &points) {
+    spill_grid *grid;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      std::unique_ptr<spill_grid> &item = grids_[key];
+      if (!item) {
+        item.reset(new spill_grid());
+        std::string name = std::to_string(grid_size_) + "_" +
+                           std::to_string(key.first * grid_size_) + "_" +
+                           std::to_string(key.second * grid_size_);
+        item->filename = output_dir_ + name + ".pcd";
+        item->spill_path = output_dir_ + name + ".spill";
+        // truncates the spill file left by an interrupted run
+        FILE *fp = std::fopen(item->spill_path.c_str(), "wb");
+        if (fp != NULL)
+          std::fclose(fp);
+      }
+      grid = item.get();
+    }
+
+    std::lock_guard<std::mutex> lock(grid->mutex);
+    FILE *fp = std::fopen(grid->spill_path.c_str(), "ab");
+    if (fp == NULL) {
+      std::cout << "Failed to open " << grid->spill_path << "." << std::endl;
+      return;
+    }
+    size_t written = std::fwrite(points.data(), sizeof(PointT), points.size(), fp);
+    std::fclose(fp);
+    grid->points_num += written;
+  }
+
+  std::vector<spill_grid *> grids() {
+    std::vector<spill_grid *> grids;
+    for (typename std::map<key_type, std::unique_ptr<spill_grid> >::iterator
+             item = grids_.begin();
+         item != grids_.end(); item++)
+      grids.push_back(item->second.get());
+    return grids;
+  }
+
+private:
+  std::string output_dir_;
+  int grid_size_;
+  std::mutex mutex_;
+  std::map<key_type, std::unique_ptr<spill_grid> > grids_;
+};
+
+template <typename PointT>
+static void stream_pcds(const std::vector<std::string> &inputs,
+                        std::atomic<size_t> *next_input, int grid_size,
+                        size_t worker_budget, spill_grids<PointT> *grids) {
+  typedef typename spill_grids<PointT>::key_type key_type;
+  typedef typename spill_grids<PointT>::point_vector point_vector;
+
+  // half of the budget buffers the points of the grids, the rest holds a
+  // chunk both as read and as converted
+  size_t flush_points = std::max<size_t>(1024, worker_budget / 2 / sizeof(PointT));
+  std::map<key_type, point_vector> buffers;
+  size_t buffered = 0;
+
+  for (size_t i = (*next_input)++; i < inputs.size(); i = (*next_input)++) {
+    pcd_chunk_reader<PointT> reader;
+    if (!reader.open(inputs[i])) {
+      std::cout << "Failed to load " << inputs[i] << "." << std::endl;
+      continue;
+    }
+    if (reader.is_compressed())
+      std::cout << inputs[i] << " is binary_compressed and is loaded at once."
+                << std::endl;
+    size_t chunk_points = std::max<size_t>(
+        1024, worker_budget / 4 / (reader.point_step() + sizeof(PointT)));
+
+    pcl::PointCloud<PointT> chunk;
+    size_t points_num = 0;
+    while (reader.read(chunk_points, &chunk)) {
+      for (typename pcl::PointCloud<PointT>::const_iterator p = chunk.begin();
+           p != chunk.end(); p++) {
+        if (!std::isfinite(p->x) || !std::isfinite(p->y))
+          continue;
+        key_type key(static_cast<int>(floor(p->x / grid_size)),
+                     static_cast<int>(floor(p->y / grid_size)));
+        buffers[key].push_back(*p);
+        buffered++;
+      }
+      points_num += chunk.size();
+
+      if (buffered >= flush_points) {
+        for (typename std::map<key_type, point_vector>::iterator item =
+                 buffers.begin();
+             item != buffers.end(); item++)
+          grids->append(item->first, item->second);
+        buffers.clear();
+        buffered = 0;
+      }
+    }
+    std::cout << "Finished to load " << inputs[i] << ": " << points_num
+              << " points." << std::endl;
+  }
+
+  for (typename std::map<key_type, point_vector>::iterator item =
+           buffers.begin();
+       item != buffers.end(); item++)
+    grids->append(item->first, item->second);
+}
+
+template <typename PointT>
+static void finalize_grids(const std::vector<spill_grid *> &grids,
+                           std::atomic<size_t> *next_grid,
+                           memory_budget *budget,
+                           std::vector<grid_area> *areas) {
+  for (size_t i = (*next_grid)++; i < grids.size(); i = (*next_grid)++) {
+    spill_grid &grid = *grids[i];
+    grid_area &area = (*areas)[i];
+    area.filename.clear();
+
+    // the points, and the copy made by the PCD writer
+    size_t bytes = 2 * grid.points_num * sizeof(PointT);
+    budget->acquire(bytes);
+
+    pcl::PointCloud<PointT> cloud;
+    cloud.points.resize(grid.points_num);
+    FILE *fp = std::fopen(grid.spill_path.c_str(), "rb");
+    size_t read = 0;
+    if (fp != NULL) {
+      read = std::fread(cloud.points.data(), sizeof(PointT), grid.points_num, fp);
+      std::fclose(fp);
+    }
+    std::remove(grid.spill_path.c_str());
+    cloud.points.resize(read);
+    cloud.width = cloud.points.size();
+    cloud.height = 1;
+
+    if (!cloud.points.empty()) {
+      area.filename = grid.filename;
+      area.x_min = area.x_max = cloud.points[0].x;
+      area.y_min = area.y_max = cloud.points[0].y;
+      area.z_min = area.z_max = cloud.points[0].z;
+      for (typename pcl::PointCloud<PointT>::const_iterator p = cloud.begin();
+           p != cloud.end(); p++) {
+        area.x_min = std::min<double>(area.x_min, p->x);
+        area.y_min = std::min<double>(area.y_min, p->y);
+        area.z_min = std::min<double>(area.z_min, p->z);
+        area.x_max = std::max<double>(area.x_max, p->x);
+        area.y_max = std::max<double>(area.y_max, p->y);
+        area.z_max = std::max<double>(area.z_max, p->z);
+      }
+      pcl::io::savePCDFileBinary(grid.filename, cloud);
+      std::cout << "Wrote " << cloud.points.size() << " points to "
+                << grid.filename << "." << std::endl;
+    }
+
+    budget->release(bytes);
+  }
+}
+
+// Writes the bounds of the grids in the format of pcd_arealist
+static void write_arealist(const std::string &path,
+                           const std::vector<grid_area> &areas) {
+  std::ofstream ofs(path.c_str());
+  char bounds[256];
+  for (size_t i = 0; i < areas.size(); i++) {
+    const grid_area &a = areas[i];
+    if (a.filename.empty())
+      continue;
+    std::snprintf(bounds, sizeof(bounds), ",%.3f,%.3f,%.3f,%.3f,%.3f,%.3f",
+                  a.x_min, a.y_min, a.z_min, a.x_max, a.y_max, a.z_max);
+    ofs << a.filename << bounds << std::endl;
+  }
+}
+
+template <typename PointT>
+static void stream_grid_divider(const std::vector<std::string> &inputs,
+                                int grid_size, const std::string &output_dir,
+                                size_t memory_budget_bytes, int jobs) {
+  spill_grids<PointT> grids(output_dir, grid_size);
+
+  std::atomic<size_t> next_input(0);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < jobs; t++)
+    threads.push_back(std::thread(stream_pcds<PointT>, std::cref(inputs),
+                                  &next_input, grid_size,
+                                  memory_budget_bytes / jobs, &grids));
+  for (size_t t = 0; t < threads.size(); t++)
+    threads[t].join();
+  threads.clear();
+
+  std::vector<spill_grid *> spilled = grids.grids();
+  std::vector<grid_area> areas(spilled.size());
+  memory_budget budget(memory_budget_bytes);
+  std::atomic<size_t> next_grid(0);
+  for (int t = 0; t < jobs; t++)
+    threads.push_back(std::thread(finalize_grids<PointT>, std::cref(spilled),
+                                  &next_grid, &budget, &areas));
+  for (size_t t = 0; t < threads.size(); t++)
+    threads[t].join();
+
+  size_t points_num = 0;
+  for (size_t i = 0; i < spilled.size(); i++)
+    points_num += spilled[i]->points_num;
+  std::string arealist = output_dir + "arealist.txt";
+  write_arealist(arealist, areas);
+  std::cout << "Total points num: " << points_num << " points." << std::endl;
+  std::cout << "Wrote " << arealist << "." << std::endl;
+}
+
 int main(int argc, char **argv) {
 
+  // options of the streaming mode come before the positional arguments
+  bool stream = false;
+  size_t memory_mb = 1024;
+  int jobs = std::max(1u, std::thread::hardware_concurrency());
+  int first_arg = 1;
+  for (; first_arg + 1 < argc; first_arg++) {
+    std::string arg = argv[first_arg];
+    if (arg == "--stream") {
+      stream = true;
+    } else if (arg == "--memory_mb") {
+      memory_mb = std::max(1, std::atoi(argv[++first_arg]));
+    } else if (arg == "--jobs") {
+      jobs = std::max(1, std::atoi(argv[++first_arg]));
+    } else {
+      break;
+    }
+  }
+  argc -= first_arg - 1;
+  argv += first_arg - 1;
+
   if (argc < 4) {
-    std::cout << "Usage: rosrun map_tools pcd_grid_divider \"point_type "
+    std::cout << "Usage: rosrun map_tools pcd_grid_divider [--stream "
+                 "[--memory_mb MB] [--jobs N]] \"point_type "
                  "[PointXYZ|PointXYZI|PointXYZRGB]\" \"grid_size\" \"output "
                  "directory\" \"***.pcd\" "
               << std::endl;
+    return (1);
   }
 
   std::string point_type = argv[1];
   int grid_size = std::stoi(argv[2]);
   std::string output_dir = argv[3];
 
+  if (stream) {
+    std::vector<std::string> inputs(argv + 4, argv + argc);
+    size_t budget = memory_mb * 1024 * 1024;
+    if (point_type == "PointXYZ")
+      stream_grid_divider<pcl::PointXYZ>(inputs, grid_size, output_dir, budget,
+                                         jobs);
+    else if (point_type == "PointXYZI")
+      stream_grid_divider<pcl::PointXYZI>(inputs, grid_size, output_dir,
+                                          budget, jobs);
+    else if (point_type == "PointXYZRGB")
+      stream_grid_divider<pcl::PointXYZRGB>(inputs, grid_size, output_dir,
+                                            budget, jobs);
+    return (0);
+  }
+
   if (point_type == "PointXYZ") {
     pcl::PointCloud<pcl::PointXYZ> map;
 
@@ -0,0 +1,129 @@
+/*
+ * Copyright 2018-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "csv_reader.h"
+
+namespace {
+
+// The reader of csv2pcd
+std::vector<std::string> split(std::string &input, char delimiter) {
+  std::istringstream stream(input);
+  std::string field;
+  std::vector<std::string> result;
+  while (std::getline(stream, field, delimiter)) {
+    result.push_back(field);
+  }
+  return result;
+}
+
+void csv2pcd_read(const std::string &data,
+                  pcl::PointCloud<pcl::PointXYZI> *cloud) {
+  std::istringstream ifs(data);
+  pcl::PointXYZI p;
+  std::string line;
+  while (std::getline(ifs, line)) {
+    std::vector<std::string> str_vec = split(line, ',');
+    p.x = std::stof(str_vec.at(0));
+    p.y = std::stof(str_vec.at(1));
+    p.z = std::stof(str_vec.at(2));
+    p.intensity = std::stoi(str_vec.at(3));
+    cloud->push_back(p);
+  }
+}
+
+void parse(const std::string &data, pcl::PointCloud<pcl::PointXYZI> *cloud) {
+  parse_csv(data.data(), data.data() + data.size(), cloud);
+}
+
+void expect_same(const pcl::PointCloud<pcl::PointXYZI> &expected,
+                 const pcl::PointCloud<pcl::PointXYZI> &cloud) {
+  ASSERT_EQ(expected.points.size(), cloud.points.size());
+  for (size_t i = 0; i < cloud.points.size(); i++) {
+    EXPECT_EQ(expected.points[i].x, cloud.points[i].x) << "point " << i;
+    EXPECT_EQ(expected.points[i].y, cloud.points[i].y) << "point " << i;
+    EXPECT_EQ(expected.points[i].z, cloud.points[i].z) << "point " << i;
+    EXPECT_EQ(expected.points[i].intensity, cloud.points[i].intensity)
+        << "point " << i;
+  }
+}
+
+} // namespace
+
+// Lines written like pcd2csv does, read back by both readers
+TEST(CsvReader, matchesCsv2pcdOnPcd2csvOutput) {
+  std::ostringstream os;
+  for (int i = 0; i < 5000; i++) {
+    float x = -74123.456f + i * 0.173f;
+    float y = 15000.0f / (i + 1);
+    float z = (i % 7 - 3) * 1.0e-3f;
+    float intensity = (i * 37) % 256 + (i % 3) * 0.25f;
+    os << x << "," << y << "," << z << "," << intensity << "\n";
+  }
+  const std::string data = os.str();
+
+  pcl::PointCloud<pcl::PointXYZI> expected, cloud;
+  csv2pcd_read(data, &expected);
+  parse(data, &cloud);
+  expect_same(expected, cloud);
+}
+
+TEST(CsvReader, matchesCsv2pcdOnVariants) {
+  const std::string data = "1.5,-2.25,3e2,7\n"
+                           " 0.1, 0.2, 0.3, 8\r\n"
+                           "-0,1e-3,-1.5E+1,-12\n"
+                           "4,5,6,9,extra\n"
+                           "10,11,12,13";
+  pcl::PointCloud<pcl::PointXYZI> expected, cloud;
+  csv2pcd_read(data, &expected);
+  parse(data, &cloud);
+  ASSERT_EQ(5u, cloud.points.size());
+  expect_same(expected, cloud);
+}
+
+// csv2pcd aborts on these lines, they are skipped without reading the next
+// line into them
+TEST(CsvReader, skipsIncompleteLines) {
+  const std::string data = "1,2,3,\n"
+                           "4,5,6,7\n"
+                           "1,2,3\n"
+                           "8,9,10,11\n"
+                           "\n"
+                           "1,2,3, \n"
+                           "12,13,14,15\n"
+                           "1,2,\n"
+                           "16,17,18,19\n"
+                           "1,2,3,";
+  pcl::PointCloud<pcl::PointXYZI> cloud;
+  parse(data, &cloud);
+  ASSERT_EQ(4u, cloud.points.size());
+  for (size_t i = 0; i < cloud.points.size(); i++) {
+    EXPECT_EQ(4.0f * i + 4, cloud.points[i].x);
+    EXPECT_EQ(4.0f * i + 5, cloud.points[i].y);
+    EXPECT_EQ(4.0f * i + 6, cloud.points[i].z);
+    EXPECT_EQ(4.0f * i + 7, cloud.points[i].intensity);
+  }
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}